@@ -0,0 +1,173 @@
+// In-memory stand-in for a connected RTCDataChannel pair.
+//
+// Each direction is one ordered, reliable link with a serial transmitter:
+// a message leaves the send buffer once the link has clocked it out at
+// `bandwidth` bytes per second, and reaches the peer `latencyMs` later. A lost
+// transmission is sent again after `rtoMs`, which holds back everything queued
+// behind it, the way SCTP's ordered delivery does. `bufferedAmount`,
+// `bufferedAmountLowThreshold`, `onbufferedamountlow` and the send-buffer
+// limit (`bufferLimit`, past which send() throws like a browser's) behave as
+// handleSendMessage.ts expects of the real channel. Message events also carry
+// `sentOn`, the performance.now() of the matching send().
+
+const defaults = {
+  bandwidth: Infinity,
+  latencyMs: 0,
+  loss: 0,
+  rtoMs: 200,
+  bufferLimit: 16 * 1024 * 1024,
+  random: Math.random,
+};
+
+class Link {
+  constructor(options) {
+    this.options = options;
+    this.queue = [];
+    this.head = 0;
+    this.wireFreeAt = 0;
+    this.timer = null;
+    this.immediate = false;
+  }
+
+  // Times for one message of `size` bytes sent at `now`: when it has left the
+  // send buffer, and when the peer receives it.
+  schedule(size, now) {
+    const { bandwidth, latencyMs, loss, rtoMs, random } = this.options;
+    const wireMs = Number.isFinite(bandwidth) ? (size * 1000) / bandwidth : 0;
+    let sentAt = Math.max(now, this.wireFreeAt) + wireMs;
+    while (loss > 0 && random() < loss) sentAt += rtoMs + wireMs;
+    this.wireFreeAt = sentAt;
+
+    return { sentAt, deliverAt: sentAt + latencyMs };
+  }
+
+  push(entry) {
+    this.queue.push(entry);
+    this.arm();
+  }
+
+  arm() {
+    if (this.timer !== null || this.immediate || this.head >= this.queue.length)
+      return;
+
+    const next = this.queue[this.head];
+    const delay = Math.min(next.sentAt, next.deliverAt) - performance.now();
+    if (delay <= 0) {
+      // Unthrottled links still deliver asynchronously, as a real channel
+      // does, but without a timer's 1 ms floor.
+      this.immediate = true;
+      setImmediate(() => {
+        this.immediate = false;
+        this.pump();
+      });
+    } else {
+      this.timer = setTimeout(() => {
+        this.timer = null;
+        this.pump();
+      }, delay);
+    }
+  }
+
+  // One timer per link keeps delivery in send order.
+  pump() {
+    const now = performance.now();
+    while (this.head < this.queue.length) {
+      const entry = this.queue[this.head];
+      if (!entry.sent && entry.sentAt <= now) {
+        entry.sent = true;
+        entry.onSent();
+      }
+      if (!entry.sent || entry.deliverAt > now) break;
+
+      this.queue[this.head++] = undefined;
+      entry.onDeliver();
+    }
+    if (this.head > 1024 && this.head * 2 > this.queue.length) {
+      this.queue = this.queue.slice(this.head);
+      this.head = 0;
+    }
+
+    this.arm();
+  }
+
+  close() {
+    if (this.timer !== null) clearTimeout(this.timer);
+    this.timer = null;
+    this.queue = [];
+    this.head = 0;
+  }
+}
+
+export class LoopbackDataChannel {
+  constructor(label, link) {
+    this.label = label;
+    this.readyState = "open";
+    this.binaryType = "arraybuffer";
+    this.bufferedAmount = 0;
+    this.bufferedAmountLowThreshold = 0;
+    this.onmessage = null;
+    this.onbufferedamountlow = null;
+    this.onclose = null;
+    this.link = link;
+    this.peer = null;
+  }
+
+  send(data) {
+    if (this.readyState !== "open")
+      throw new DOMException("Channel is not open", "InvalidStateError");
+
+    // The browser copies the payload into its send buffer.
+    const bytes = ArrayBuffer.isView(data)
+      ? new Uint8Array(data.buffer, data.byteOffset, data.byteLength).slice()
+      : new Uint8Array(data).slice();
+    if (this.bufferedAmount + bytes.byteLength > this.link.options.bufferLimit)
+      throw new DOMException("Send buffer is full", "OperationError");
+
+    const sentOn = performance.now();
+    this.bufferedAmount += bytes.byteLength;
+    this.link.push({
+      ...this.link.schedule(bytes.byteLength, sentOn),
+      sent: false,
+      onSent: () => {
+        const before = this.bufferedAmount;
+        this.bufferedAmount -= bytes.byteLength;
+        if (
+          before > this.bufferedAmountLowThreshold &&
+          this.bufferedAmount <= this.bufferedAmountLowThreshold
+        )
+          this.onbufferedamountlow?.(new Event("bufferedamountlow"));
+      },
+      onDeliver: () => {
+        if (this.peer?.readyState !== "open") return;
+        this.peer.onmessage?.({ data: bytes.buffer, sentOn });
+      },
+    });
+  }
+
+  close() {
+    if (this.readyState === "closed") return;
+    for (const channel of [this, this.peer]) {
+      if (!channel || channel.readyState === "closed") continue;
+      channel.readyState = "closed";
+      channel.bufferedAmount = 0;
+      channel.link.close();
+      channel.onclose?.(new Event("close"));
+    }
+  }
+}
+
+/**
+ * Two connected channel ends. Both directions get the same link options:
+ * `bandwidth` (bytes per second), `latencyMs`, `loss` (probability a
+ * transmission is lost), `rtoMs`, `bufferLimit` and `random` (a [0, 1)
+ * source, for reproducible loss).
+ */
+export const createChannelPair = (label, options = {}) => {
+  const linkOptions = { ...defaults, ...options };
+  const a = new LoopbackDataChannel(label, new Link(linkOptions));
+  const b = new LoopbackDataChannel(label, new Link(linkOptions));
+  a.peer = b;
+  b.peer = a;
+
+  return [a, b];
+};
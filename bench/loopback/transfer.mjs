@@ -0,0 +1,578 @@
+// End-to-end transfer benchmark over in-process loopback data channels.
+//
+// One sender fans a payload out to every other peer through the store-free
+// session API (p2party/session): a handshake per edge over the loopback
+// channel, then the payload as a sequence of session messages, each sent as
+// a header record (Merkle root, frame count) followed by its chunk frames. The
+// sender throttles on bufferedAmount the way handleSendMessage.ts does; each
+// receiver decrypts every message and stores its chunks through the built DB
+// worker on fake-indexeddb, as the browser receive path does.
+//
+// Run `npm run build` first; the benchmark loads lib/session.mjs and
+// lib/db.worker.js (or --session, e.g. an installed release's entry point).
+//
+//   npm run bench:transfer -- --sizes 1MiB,100MiB --peers 4 --bandwidth 200
+//
+// The report is one JSON document (schemaVersion 1) on stdout or in --output;
+// progress goes to stderr. With --expose-gc (as the npm script runs it) every
+// size starts from a collected heap, so heap peaks compare across sizes.
+import { execFileSync } from "node:child_process";
+import { randomFillSync } from "node:crypto";
+import { existsSync, readFileSync, writeFileSync } from "node:fs";
+import os from "node:os";
+import { pathToFileURL } from "node:url";
+import { parseArgs } from "node:util";
+
+import { createChannelPair } from "./channel.mjs";
+
+const repositoryUrl = new URL("../../", import.meta.url);
+
+// src/utils/constants.ts: CHUNK_PLAINTEXT_LEN - (METADATA_LEN + PROOF_LEN).
+const CHUNK_LEN = 61_912;
+// src/utils/constants.ts: MAX_BUFFERED_AMOUNT and CHANNEL_OPEN_POLL_MS.
+const MAX_BUFFERED_AMOUNT = 16 * 64 * 1024;
+const CHANNEL_OPEN_POLL_MS = 25;
+// Session messages only; the store-free sessions tag every chunk Unknown.
+const MESSAGE_TYPE_UNKNOWN = 64;
+// Root (64 bytes) and big-endian frame count ahead of each message's frames.
+const HEADER_LEN = 64 + 4;
+
+const usage = `Usage: node bench/loopback/transfer.mjs [options]
+
+  --sizes LIST        payload sizes, e.g. 1MiB,100MiB,1GiB (default)
+  --peers N           peers including the sender (2)
+  --message MIB       session message size in MiB (16)
+  --bandwidth MBIT    link bandwidth in Mbit/s (unlimited)
+  --latency MS        one-way link latency (0)
+  --loss RATE         probability a transmission is lost, 0 to 1 (0)
+  --rto MS            retransmission delay after a loss (200)
+  --high-water BYTES  sender bufferedAmount ceiling (${MAX_BUFFERED_AMOUNT})
+  --buffer-limit B    channel send buffer, send() throws past it (16 MiB)
+  --wasm KIND         scalar or simd libcrypto (scalar)
+  --session PATH      session entry point (lib/session.mjs)
+  --no-store          skip the DB worker on the receive side
+  --seed N            loss PRNG seed (1)
+  --output FILE       write the JSON report to FILE
+`;
+
+const { values } = parseArgs({
+  options: {
+    sizes: { type: "string", default: "1MiB,100MiB,1GiB" },
+    peers: { type: "string", default: "2" },
+    message: { type: "string", default: "16" },
+    bandwidth: { type: "string" },
+    latency: { type: "string", default: "0" },
+    loss: { type: "string", default: "0" },
+    rto: { type: "string", default: "200" },
+    "high-water": { type: "string", default: String(MAX_BUFFERED_AMOUNT) },
+    "buffer-limit": { type: "string", default: String(16 * 1024 * 1024) },
+    wasm: { type: "string", default: "scalar" },
+    session: { type: "string" },
+    "no-store": { type: "boolean", default: false },
+    seed: { type: "string", default: "1" },
+    output: { type: "string" },
+    help: { type: "boolean", default: false },
+  },
+});
+
+if (values.help) {
+  process.stdout.write(usage);
+  process.exit(0);
+}
+
+const fail = (message) => {
+  process.stderr.write(`${message}\n${usage}`);
+  process.exit(2);
+};
+
+const missing = (path) => {
+  process.stderr.write(`Missing ${path}; run \`npm run build\` first.\n`);
+  process.exit(1);
+};
+
+const units = { b: 1, kib: 1024, mib: 1024 ** 2, gib: 1024 ** 3 };
+const parseSize = (text) => {
+  const match = /^(\d+(?:\.\d+)?)\s*(b|kib|mib|gib)?$/i.exec(text.trim());
+  if (!match) fail(`Invalid size: ${text}`);
+  const unit = units[(match[2] ?? "b").toLowerCase()];
+  const bytes = Math.round(Number(match[1]) * unit);
+  if (bytes < 1024) fail(`Sizes start at 1KiB: ${text}`);
+  return bytes;
+};
+
+const parseNumber = (name, min, max = Infinity) => {
+  const value = Number(values[name]);
+  if (!Number.isFinite(value) || value < min || value > max)
+    fail(`Invalid --${name}: ${values[name]}`);
+  return value;
+};
+
+const sizes = values.sizes.split(",").map(parseSize);
+const peers = parseNumber("peers", 2, 64);
+if (!Number.isInteger(peers)) fail(`Invalid --peers: ${values.peers}`);
+// A session message's Merkle tree lives in the session's fixed 2 MiB of WASM
+// memory, so large payloads go out as many messages.
+const messageSize = Math.round(parseNumber("message", 1 / 16, 64) * 1024 ** 2);
+const link = {
+  bandwidth:
+    values.bandwidth === undefined
+      ? Infinity
+      : parseNumber("bandwidth", 0.001) * 125_000,
+  latencyMs: parseNumber("latency", 0),
+  loss: parseNumber("loss", 0, 0.9),
+  rtoMs: parseNumber("rto", 0),
+  bufferLimit: parseNumber("buffer-limit", 65_536),
+};
+const highWater = parseNumber("high-water", 0);
+const seed = parseNumber("seed", 0) >>> 0;
+const store = !values["no-store"];
+if (values.wasm !== "scalar" && values.wasm !== "simd")
+  fail(`Invalid --wasm: ${values.wasm}`);
+
+// Deterministic loss: mulberry32.
+const seededRandom = (state) => () => {
+  state = (state + 0x6d2b79f5) >>> 0;
+  let t = Math.imul(state ^ (state >>> 15), state | 1);
+  t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+  return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+};
+
+// Session WASM memories, so the report can give their combined high-water
+// mark. The session API creates one fixed-size memory per session.
+const NativeMemory = WebAssembly.Memory;
+let liveMemories = new Set();
+WebAssembly.Memory = class extends NativeMemory {
+  constructor(descriptor) {
+    super(descriptor);
+    liveMemories.add(new WeakRef(this));
+  }
+};
+
+const wasmMemoryBytes = () => {
+  let bytes = 0;
+  for (const ref of liveMemories) {
+    const memory = ref.deref();
+    if (memory) bytes += memory.buffer.byteLength;
+    else liveMemories.delete(ref);
+  }
+  return bytes;
+};
+
+const peak = { heapUsed: 0, arrayBuffers: 0, rss: 0, wasmMemory: 0 };
+const sampleMemory = () => {
+  const usage = process.memoryUsage();
+  peak.heapUsed = Math.max(peak.heapUsed, usage.heapUsed);
+  peak.arrayBuffers = Math.max(peak.arrayBuffers, usage.arrayBuffers);
+  peak.rss = Math.max(peak.rss, usage.rss);
+  peak.wasmMemory = Math.max(peak.wasmMemory, wasmMemoryBytes());
+};
+
+const sessionUrl = values.session
+  ? pathToFileURL(values.session)
+  : new URL("lib/session.mjs", repositoryUrl);
+if (!existsSync(sessionUrl))
+  missing(sessionUrl.pathname);
+const { createSession, generateSessionIdentity } = await import(
+  sessionUrl.href
+);
+
+const wasmName =
+  values.wasm === "simd" ? "libcrypto.simd.wasm" : "libcrypto.wasm";
+const wasmUrl = [
+  new URL(`src/cryptography/${wasmName}`, repositoryUrl),
+  new URL(`lib/${wasmName}`, repositoryUrl),
+].find((url) => existsSync(url));
+if (!wasmUrl) missing(wasmName);
+const wasmFile = readFileSync(wasmUrl);
+const cryptoOptions = {
+  wasmBinary: wasmFile.buffer.slice(
+    wasmFile.byteOffset,
+    wasmFile.byteOffset + wasmFile.byteLength,
+  ),
+};
+
+// The DB worker runs in-process, as in tests/db/db.worker.test.ts: its global
+// onmessage handler gets structured clones, and replies through postMessage.
+let callWorker = null;
+if (store) {
+  const workerUrl = new URL("lib/db.worker.js", repositoryUrl);
+  if (!existsSync(workerUrl))
+    missing(workerUrl.pathname);
+
+  await import("fake-indexeddb/auto");
+  const pending = new Map();
+  let nextId = 1;
+  globalThis.onmessage = null;
+  globalThis.postMessage = ({ id, result, error }) => {
+    const call = pending.get(id);
+    pending.delete(id);
+    if (error !== undefined) call.reject(new Error(error));
+    else call.resolve(result);
+  };
+  await import(workerUrl.href);
+
+  const handler = globalThis.onmessage;
+  callWorker = (method, args) =>
+    new Promise((resolve, reject) => {
+      const id = nextId++;
+      pending.set(id, { resolve, reject });
+      handler({ data: structuredClone({ id, method, args }) });
+    });
+}
+
+const toHex = (bytes) => Buffer.from(bytes).toString("hex");
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+// HandshakeTransport over one end of a channel pair.
+const handshakeTransport = (channel) => {
+  const queued = [];
+  const waiters = [];
+  channel.onmessage = ({ data }) => {
+    const bytes = new Uint8Array(data);
+    const waiter = waiters.shift();
+    if (waiter) waiter(bytes);
+    else queued.push(bytes);
+  };
+
+  return {
+    send: (bytes) => channel.send(bytes),
+    recv: () =>
+      queued.length > 0
+        ? Promise.resolve(queued.shift())
+        : new Promise((resolve) => waiters.push(resolve)),
+  };
+};
+
+const messagesFor = (size) => {
+  const lengths = [];
+  for (let offset = 0; offset < size; offset += messageSize)
+    lengths.push(Math.min(messageSize, size - offset));
+  return lengths;
+};
+
+const connect = async (sender, receiver, index, random) => {
+  const [senderChannel, receiverChannel] = createChannelPair(`edge-${index}`, {
+    ...link,
+    random,
+  });
+  const channelId = crypto.getRandomValues(new Uint8Array(16));
+  const senderFingerprint = crypto.getRandomValues(new Uint8Array(32));
+  const receiverFingerprint = crypto.getRandomValues(new Uint8Array(32));
+  const [senderSession, receiverSession] = await Promise.all([
+    createSession({
+      role: "initiator",
+      identity: sender,
+      peerIdentityEd25519PublicKey: receiver.ed25519PublicKey,
+      channel: {
+        channelId,
+        localFingerprint: senderFingerprint,
+        remoteFingerprint: receiverFingerprint,
+      },
+      transport: handshakeTransport(senderChannel),
+      mode: "nopin",
+      crypto: cryptoOptions,
+    }),
+    createSession({
+      role: "responder",
+      identity: receiver,
+      peerIdentityEd25519PublicKey: sender.ed25519PublicKey,
+      channel: {
+        channelId,
+        localFingerprint: receiverFingerprint,
+        remoteFingerprint: senderFingerprint,
+      },
+      transport: handshakeTransport(receiverChannel),
+      mode: "nopin",
+      crypto: cryptoOptions,
+    }),
+  ]);
+  senderChannel.onmessage = null;
+
+  return {
+    index,
+    senderChannel,
+    receiverChannel,
+    senderSession,
+    receiverSession,
+  };
+};
+
+// Writes one record once bufferedAmount is under the high-water mark, polling
+// like handleSendMessage.ts.
+const sendRecord = async (edge, stages, bytes) => {
+  const channel = edge.senderChannel;
+  if (channel.bufferedAmount >= highWater) {
+    const start = performance.now();
+    while (channel.readyState === "open" && channel.bufferedAmount >= highWater)
+      await sleep(CHANNEL_OPEN_POLL_MS);
+    stages.backpressureMs += performance.now() - start;
+  }
+  channel.send(bytes);
+};
+
+const sendAll = async (edge, payload, lengths, stages) => {
+  const view = new DataView(payload.buffer);
+  for (let index = 0; index < lengths.length; index++) {
+    // Distinct plaintexts, so every message gets its own root. encrypt()
+    // copies its input before its first await.
+    view.setUint32(0, index);
+    const start = performance.now();
+    const message = await edge.senderSession.encrypt(
+      payload.subarray(0, lengths[index]),
+    );
+    stages.encryptMs += performance.now() - start;
+
+    const header = new Uint8Array(HEADER_LEN);
+    header.set(message.root, 0);
+    new DataView(header.buffer).setUint32(64, message.frames.length);
+    await sendRecord(edge, stages, header);
+    for (const frame of message.frames) await sendRecord(edge, stages, frame);
+  }
+};
+
+const storeMessage = async (edge, root, plaintext) => {
+  const merkleRoot = toHex(root);
+  const timestamp = Date.now();
+  for (let offset = 0; offset < plaintext.length; offset += CHUNK_LEN) {
+    const realLen = Math.min(CHUNK_LEN, plaintext.length - offset);
+    await callWorker("storeReceiveChunk", [
+      {
+        schemaVersion: 1,
+        roomId: "loopback",
+        fromPeerId: "peer-0",
+        channelLabel: edge.receiverChannel.label,
+        timestamp,
+        merkleRoot,
+        // Session messages carry no content hash or per-chunk receipt; the
+        // root stands in for both at their stored length.
+        hash: merkleRoot,
+        filename: "",
+        messageType: MESSAGE_TYPE_UNKNOWN,
+        chunkIndex: offset / CHUNK_LEN,
+        mimeType: "application/octet-stream",
+        leafHash: merkleRoot,
+        realLen,
+        totalSize: plaintext.length,
+        data: plaintext.buffer.slice(
+          plaintext.byteOffset + offset,
+          plaintext.byteOffset + offset + realLen,
+        ),
+        storage: "indexeddb",
+      },
+    ]);
+  }
+
+  return merkleRoot;
+};
+
+// Resolves once every message has been decrypted (and stored); records arrive
+// in send order, so a message is its header plus the next frameCount records.
+const receiveAll = (edge, lengths, stages) =>
+  new Promise((resolve, reject) => {
+    let message = null;
+    let received = 0;
+    let tail = Promise.resolve();
+
+    const handle = async ({ root, frames }, index) => {
+      let start = performance.now();
+      const plaintext = await edge.receiverSession.decrypt({
+        protocolVersion: 4,
+        root,
+        frames,
+      });
+      stages.decryptMs += performance.now() - start;
+      if (
+        plaintext.length !== lengths[index] ||
+        (plaintext.length >= 4 &&
+          new DataView(plaintext.buffer, plaintext.byteOffset).getUint32(0) !==
+            index)
+      )
+        throw new Error(`edge ${edge.index}: message ${index} mismatch`);
+
+      if (callWorker) {
+        start = performance.now();
+        const merkleRoot = await storeMessage(edge, root, plaintext);
+        stages.storeMs += performance.now() - start;
+        // Cleanup is untimed; it keeps fake-indexeddb from holding the
+        // whole payload.
+        await callWorker("deleteReceiveTransfer", [merkleRoot]);
+      }
+      if (index === lengths.length - 1) resolve();
+    };
+
+    edge.receiverChannel.onmessage = ({ data, sentOn }) => {
+      stages.transitMs += performance.now() - sentOn;
+      stages.records++;
+      const bytes = new Uint8Array(data);
+      if (message === null) {
+        if (bytes.length !== HEADER_LEN) {
+          reject(new Error(`edge ${edge.index}: expected a message header`));
+          return;
+        }
+        message = {
+          root: bytes.slice(0, 64),
+          frameCount: new DataView(data).getUint32(64),
+          frames: [],
+        };
+        return;
+      }
+
+      stages.cells++;
+      message.frames.push(bytes);
+      if (message.frames.length < message.frameCount) return;
+
+      const complete = message;
+      const index = received++;
+      message = null;
+      tail = tail.then(() => handle(complete, index)).catch(reject);
+    };
+  });
+
+const runSize = async (size, identities) => {
+  liveMemories = new Set();
+  globalThis.gc?.();
+  Object.assign(peak, { heapUsed: 0, arrayBuffers: 0, rss: 0, wasmMemory: 0 });
+  sampleMemory();
+  const sampler = setInterval(sampleMemory, 50);
+
+  const random = seededRandom(seed);
+  const [sender, ...receivers] = identities;
+  const stages = {
+    handshakeMs: 0,
+    encryptMs: 0,
+    backpressureMs: 0,
+    transitMs: 0,
+    decryptMs: 0,
+    storeMs: 0,
+    records: 0,
+    cells: 0,
+  };
+  const lengths = messagesFor(size);
+  const payload = randomFillSync(new Uint8Array(Math.min(size, messageSize)));
+
+  let edges = [];
+  try {
+    let start = performance.now();
+    edges = await Promise.all(
+      receivers.map((receiver, index) =>
+        connect(sender, receiver, index + 1, random),
+      ),
+    );
+    stages.handshakeMs = performance.now() - start;
+    sampleMemory();
+
+    start = performance.now();
+    await Promise.all(
+      edges.flatMap((edge) => [
+        sendAll(edge, payload, lengths, stages),
+        receiveAll(edge, lengths, stages),
+      ]),
+    );
+    const wallMs = performance.now() - start;
+    sampleMemory();
+
+    const bytes = size * edges.length;
+    return {
+      size,
+      peers,
+      messages: lengths.length,
+      wallMs,
+      stages: {
+        handshakeMs: stages.handshakeMs,
+        encryptMs: stages.encryptMs,
+        backpressureMs: stages.backpressureMs,
+        // send() to delivery, including time queued in the send buffer.
+        meanTransitMs: stages.transitMs / stages.records,
+        decryptMs: stages.decryptMs,
+        storeMs: store ? stages.storeMs : null,
+      },
+      cells: stages.cells,
+      cellsPerSec: (stages.cells * 1000) / wallMs,
+      mbPerSec: bytes / 1e6 / (wallMs / 1000),
+      peak: { ...peak },
+    };
+  } finally {
+    clearInterval(sampler);
+    for (const edge of edges) {
+      edge.senderChannel.close();
+      await Promise.all([
+        edge.senderSession.destroy(),
+        edge.receiverSession.destroy(),
+      ]);
+    }
+  }
+};
+
+const gitCommit = () => {
+  try {
+    return execFileSync("git", ["rev-parse", "HEAD"], {
+      cwd: repositoryUrl,
+      stdio: ["ignore", "pipe", "ignore"],
+      encoding: "utf8",
+    }).trim();
+  } catch {
+    return "";
+  }
+};
+
+const mib = (bytes) => `${(bytes / 1024 ** 2).toFixed(1)} MiB`;
+
+const identities = await Promise.all(
+  Array.from({ length: peers }, () => generateSessionIdentity(cryptoOptions)),
+);
+const results = [];
+try {
+  for (const size of sizes) {
+    process.stderr.write(`${mib(size)} to ${peers - 1} peer(s)... `);
+    const result = await runSize(size, identities);
+    results.push(result);
+    process.stderr.write(
+      `${result.wallMs.toFixed(0)} ms, ` +
+        `${result.cellsPerSec.toFixed(0)} cells/s, ` +
+        `${result.mbPerSec.toFixed(1)} MB/s, ` +
+        `peak heap ${mib(result.peak.heapUsed)}, ` +
+        `WASM ${mib(result.peak.wasmMemory)}\n`,
+    );
+  }
+} finally {
+  for (const identity of identities) {
+    identity.ed25519SecretKey.fill(0);
+    identity.x25519SecretKey.fill(0);
+  }
+}
+
+const { version } = JSON.parse(
+  readFileSync(new URL("package.json", repositoryUrl), "utf8"),
+);
+const report = JSON.stringify(
+  {
+    schemaVersion: 1,
+    release: version,
+    commit: gitCommit(),
+    host: {
+      system: os.type(),
+      kernel: os.release(),
+      machine: os.machine(),
+      node: process.version,
+    },
+    wasm: values.wasm,
+    store,
+    link: {
+      bandwidthBytesPerSec: Number.isFinite(link.bandwidth)
+        ? link.bandwidth
+        : null,
+      latencyMs: link.latencyMs,
+      loss: link.loss,
+      rtoMs: link.rtoMs,
+      bufferLimit: link.bufferLimit,
+      highWater,
+      seed,
+    },
+    messageSize,
+    results,
+  },
+  null,
+  2,
+);
+if (values.output) writeFileSync(values.output, `${report}\n`);
+else process.stdout.write(`${report}\n`);
@@ -0,0 +1,820 @@
+/* Host micro-benchmarks for libcrypto, built by scripts/native.js.
+ *
+ * The sources are the WASM build's: this file includes libcrypto.c, so every
+ * function below is the one emcc compiles, and links the three ML-KEM units
+ * next to it. Native x86-64 and arm64 take the SSE2/NEON paths of the
+ * four-lane SHA-512 and ChaCha20-Poly1305 kernels, like libcrypto.simd.wasm;
+ * pool.c has no workers off the threaded WASM build, so every row is one
+ * thread. Comparing a row with the same call from JS gives the WASM overhead.
+ *
+ * Each benchmark is calibrated until one sample takes --sample-ms, then timed
+ * for --samples samples. Rows report the median, fastest and slowest ns per
+ * call, and MB/s over the bytes one call processes where that is meaningful.
+ * The report is one JSON document (schemaVersion 1) on stdout or in
+ * --output, progress goes to stderr. A benchmark whose call fails stops the
+ * run with exit status 1: a failing path is not the one being measured. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <time.h>
+
+#include "libcrypto.c"
+
+#include "mlkem1024.h"
+#include "mlkem512.h"
+#include "mlkem768.h"
+
+#define BENCH_SCHEMA_VERSION 1
+#define BENCH_MAX_SAMPLES 101U
+#define BENCH_MAX_ITERATIONS (1ULL << 32)
+
+/* Leaves of the transfer tree the receive benchmarks' frame proves against:
+ * a 64 MiB file, ten proof artifacts. */
+#define BENCH_RECEIVE_LEAVES 1024U
+
+typedef struct bench bench;
+
+struct bench
+{
+  const char *name;
+  /* A JSON object, copied into the report as is. */
+  const char *params;
+  /* Size parameter handed to prepare: leaves, bytes or a cost profile. */
+  const unsigned int n;
+  /* Bytes one call processes, for MB/s; 0 reports null. */
+  size_t bytes;
+  /* Untimed: once before calibration, and before every call. */
+  int (*prepare)(bench *b);
+  int (*reset)(bench *b);
+  int (*op)(bench *b);
+  void (*release)(bench *b);
+  void *state;
+};
+
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ---------------- Chunk frames ---------------- */
+
+typedef struct
+{
+  uint8_t key[crypto_aead_chacha20poly1305_ietf_KEYBYTES];
+  uint8_t root[crypto_hash_sha512_BYTES];
+  uint8_t header[CHUNK_AAD_HEADER_LEN];
+  uint8_t *metadata;
+  uint8_t *proof;
+  uint8_t *chunk;
+  uint8_t *message;
+  uint8_t *decrypted;
+} frame_state;
+
+static void
+frame_release(bench *b)
+{
+  frame_state *s = b->state;
+
+  if (!s) return;
+  free(s->metadata);
+  free(s->proof);
+  free(s->chunk);
+  free(s->message);
+  free(s->decrypted);
+  free(s);
+  b->state = NULL;
+}
+
+/* One sealed chunk of a BENCH_RECEIVE_LEAVES-leaf transfer, the first leaf,
+ * with its real proof, so the receive benchmarks verify it end to end. */
+static int
+frame_prepare(bench *b)
+{
+  frame_state *s = calloc(1, sizeof *s);
+  uint8_t *leaves = malloc(BENCH_RECEIVE_LEAVES * crypto_hash_sha512_BYTES);
+  merkle_tree *tree = malloc(merkle_tree_bytes(BENCH_RECEIVE_LEAVES));
+  int res = -1, proof_len;
+
+  b->state = s;
+  if (!s || !leaves || !tree) goto done;
+  s->metadata = calloc(1, METADATA_LEN);
+  s->proof = calloc(1, PROOF_LEN);
+  s->chunk = malloc(CHUNK_LEN);
+  s->message = calloc(1, MESSAGE_LEN);
+  s->decrypted = malloc(DECRYPTED_LEN);
+  if (!s->metadata || !s->proof || !s->chunk || !s->message || !s->decrypted)
+    goto done;
+
+  randombytes_buf(s->key, sizeof s->key);
+  randombytes_buf(s->header, sizeof s->header);
+  s->header[0] = FRAME_TYPE_CHUNK;
+  randombytes_buf(s->chunk, CHUNK_LEN);
+  randombytes_buf(leaves, BENCH_RECEIVE_LEAVES * crypto_hash_sha512_BYTES);
+  if (merkle_leaf_hash_batch(1, CHUNK_LEN, s->chunk, leaves) != 0
+      || merkle_tree_build(tree, BENCH_RECEIVE_LEAVES, leaves) != 0
+      || merkle_tree_root(tree, s->root) != 0)
+    goto done;
+
+  proof_len = merkle_tree_proof(tree, 0, s->proof + 4);
+  if (proof_len < 0) goto done;
+  s->proof[0] = (uint8_t)(proof_len >> 24);
+  s->proof[1] = (uint8_t)(proof_len >> 16);
+  s->proof[2] = (uint8_t)(proof_len >> 8);
+  s->proof[3] = (uint8_t)proof_len;
+
+  if (seal_message_chunk(s->message, s->header, s->root, s->metadata,
+                         s->proof, s->chunk, s->key)
+      != 0)
+    goto done;
+  res = receive_message_with_key(s->decrypted, s->message, s->root, s->key);
+
+done:
+  free(tree);
+  free(leaves);
+  return res;
+}
+
+static int
+seal_op(bench *b)
+{
+  frame_state *s = b->state;
+
+  return seal_message_chunk(s->message, s->header, s->root, s->metadata,
+                            s->proof, s->chunk, s->key);
+}
+
+static int
+receive_op(bench *b)
+{
+  frame_state *s = b->state;
+
+  return receive_message_with_key(s->decrypted, s->message, s->root, s->key);
+}
+
+static int
+receive_fused_op(bench *b)
+{
+  frame_state *s = b->state;
+
+  return receive_message_with_key_fused(s->decrypted, s->message, s->root,
+                                        s->key);
+}
+
+/* ---------------- Symmetric AEAD ---------------- */
+
+typedef struct
+{
+  uint8_t key[crypto_aead_chacha20poly1305_ietf_KEYBYTES];
+  uint8_t nonce[crypto_aead_chacha20poly1305_ietf_NPUBBYTES];
+  uint8_t aad[crypto_hash_sha512_BYTES];
+  uint8_t *data;
+  uint8_t *out;
+} aead_state;
+
+static void
+aead_release(bench *b)
+{
+  aead_state *s = b->state;
+
+  if (!s) return;
+  free(s->data);
+  free(s->out);
+  free(s);
+  b->state = NULL;
+}
+
+static int
+aead_prepare(bench *b)
+{
+  aead_state *s = calloc(1, sizeof *s);
+
+  b->state = s;
+  if (!s) return -1;
+  s->data = malloc(b->n);
+  s->out = malloc(b->n + crypto_aead_chacha20poly1305_ietf_ABYTES);
+  if (!s->data || !s->out) return -1;
+
+  randombytes_buf(s->key, sizeof s->key);
+  randombytes_buf(s->nonce, sizeof s->nonce);
+  randombytes_buf(s->aad, sizeof s->aad);
+  randombytes_buf(s->data, b->n);
+
+  return 0;
+}
+
+static int
+encrypt_op(bench *b)
+{
+  aead_state *s = b->state;
+
+  return encrypt_chachapoly_symmetric(s->out, s->data, b->n, s->key, s->nonce,
+                                      s->aad, sizeof s->aad);
+}
+
+/* ---------------- Merkle trees ---------------- */
+
+typedef struct
+{
+  uint8_t root[crypto_hash_sha512_BYTES];
+  uint8_t element[crypto_hash_sha512_BYTES];
+  uint8_t *leaves;
+  uint8_t *work;
+  uint8_t *proof;
+  merkle_tree *tree;
+} merkle_state;
+
+static void
+merkle_release(bench *b)
+{
+  merkle_state *s = b->state;
+
+  if (!s) return;
+  free(s->leaves);
+  free(s->work);
+  free(s->proof);
+  free(s->tree);
+  free(s);
+  b->state = NULL;
+}
+
+/* b->n random leaf hashes; the element proved is the middle one, which
+ * get_merkle_proof finds after scanning half of them. */
+static int
+merkle_prepare(bench *b)
+{
+  const size_t LEAVES_BYTES = (size_t)b->n * crypto_hash_sha512_BYTES;
+  merkle_state *s = calloc(1, sizeof *s);
+
+  b->state = s;
+  if (!s) return -1;
+  s->leaves = malloc(LEAVES_BYTES);
+  s->work = malloc(LEAVES_BYTES);
+  s->proof = malloc((size_t)b->n * (crypto_hash_sha512_BYTES + 1));
+  s->tree = malloc(merkle_tree_bytes(b->n));
+  if (!s->leaves || !s->work || !s->proof || !s->tree) return -1;
+
+  randombytes_buf(s->leaves, LEAVES_BYTES);
+  memcpy(s->element, &s->leaves[(b->n / 2) * crypto_hash_sha512_BYTES],
+         crypto_hash_sha512_BYTES);
+
+  return merkle_tree_build(s->tree, b->n, s->leaves);
+}
+
+/* get_merkle_root and get_merkle_proof fold the leaves in place. */
+static int
+merkle_reset(bench *b)
+{
+  merkle_state *s = b->state;
+
+  memcpy(s->work, s->leaves, (size_t)b->n * crypto_hash_sha512_BYTES);
+  return 0;
+}
+
+static int
+merkle_root_op(bench *b)
+{
+  merkle_state *s = b->state;
+
+  return get_merkle_root(b->n, s->work, s->root);
+}
+
+static int
+merkle_proof_op(bench *b)
+{
+  merkle_state *s = b->state;
+
+  return get_merkle_proof(b->n, s->work, s->element, s->proof) < 0 ? -1 : 0;
+}
+
+static int
+merkle_tree_build_op(bench *b)
+{
+  merkle_state *s = b->state;
+
+  return merkle_tree_build(s->tree, b->n, s->leaves);
+}
+
+static int
+merkle_tree_proof_op(bench *b)
+{
+  merkle_state *s = b->state;
+
+  return merkle_tree_proof(s->tree, b->n / 2, s->proof) < 0 ? -1 : 0;
+}
+
+/* ---------------- ML-KEM ---------------- */
+
+/* Room for the largest parameter set; each benchmark uses its own sizes. */
+typedef struct
+{
+  uint8_t pk[P2PARTY_MLKEM1024_PUBLICKEYBYTES];
+  uint8_t sk[P2PARTY_MLKEM1024_SECRETKEYBYTES];
+  uint8_t ct[P2PARTY_MLKEM1024_CIPHERTEXTBYTES];
+  uint8_t ss[P2PARTY_MLKEM1024_BYTES];
+  uint8_t keypair_coins[P2PARTY_MLKEM1024_KEYPAIRCOINBYTES];
+  uint8_t encaps_coins[P2PARTY_MLKEM1024_ENCAPSCOINBYTES];
+} mlkem_state;
+
+static void
+mlkem_release(bench *b)
+{
+  if (!b->state) return;
+  sodium_memzero(b->state, sizeof(mlkem_state));
+  free(b->state);
+  b->state = NULL;
+}
+
+#define MLKEM_BENCH_OPS(N)                                                     \
+  static int mlkem##N##_prepare(bench *b)                                      \
+  {                                                                            \
+    mlkem_state *s = calloc(1, sizeof *s);                                     \
+                                                                               \
+    b->state = s;                                                              \
+    if (!s) return -1;                                                         \
+    randombytes_buf(s->keypair_coins, sizeof s->keypair_coins);                \
+    randombytes_buf(s->encaps_coins, sizeof s->encaps_coins);                  \
+    if (mlkem##N##_keypair(s->pk, s->sk, s->keypair_coins) != 0) return -1;    \
+    return mlkem##N##_encaps(s->ct, s->ss, s->pk, s->encaps_coins);            \
+  }                                                                            \
+                                                                               \
+  static int mlkem##N##_keypair_op(bench *b)                                   \
+  {                                                                            \
+    mlkem_state *s = b->state;                                                 \
+    return mlkem##N##_keypair(s->pk, s->sk, s->keypair_coins);                 \
+  }                                                                            \
+                                                                               \
+  static int mlkem##N##_encaps_op(bench *b)                                    \
+  {                                                                            \
+    mlkem_state *s = b->state;                                                 \
+    return mlkem##N##_encaps(s->ct, s->ss, s->pk, s->encaps_coins);            \
+  }                                                                            \
+                                                                               \
+  static int mlkem##N##_decaps_op(bench *b)                                    \
+  {                                                                            \
+    mlkem_state *s = b->state;                                                 \
+    return mlkem##N##_decaps(s->ss, s->ct, s->sk);                             \
+  }
+
+MLKEM_BENCH_OPS(512)
+MLKEM_BENCH_OPS(768)
+MLKEM_BENCH_OPS(1024)
+
+/* ---------------- HKDF-SHA512 and X25519 ---------------- */
+
+typedef struct
+{
+  uint8_t salt[crypto_hash_sha512_BYTES];
+  uint8_t ikm[crypto_scalarmult_curve25519_BYTES];
+  uint8_t info[32];
+  uint8_t prk[crypto_auth_hmacsha512_BYTES];
+  uint8_t okm[crypto_hash_sha512_BYTES];
+  uint8_t sk[crypto_scalarmult_curve25519_SCALARBYTES];
+  uint8_t pk[crypto_scalarmult_curve25519_BYTES];
+  uint8_t peer_sk[crypto_scalarmult_curve25519_SCALARBYTES];
+  uint8_t peer_pk[crypto_scalarmult_curve25519_BYTES];
+  uint8_t shared[crypto_scalarmult_curve25519_BYTES];
+} kdf_state;
+
+static void
+kdf_release(bench *b)
+{
+  if (!b->state) return;
+  sodium_memzero(b->state, sizeof(kdf_state));
+  free(b->state);
+  b->state = NULL;
+}
+
+static int
+kdf_prepare(bench *b)
+{
+  kdf_state *s = calloc(1, sizeof *s);
+
+  b->state = s;
+  if (!s) return -1;
+  randombytes_buf(s->salt, sizeof s->salt);
+  randombytes_buf(s->ikm, sizeof s->ikm);
+  randombytes_buf(s->info, sizeof s->info);
+  randombytes_buf(s->prk, sizeof s->prk);
+  if (x25519_keypair(s->pk, s->sk) != 0) return -1;
+
+  return x25519_keypair(s->peer_pk, s->peer_sk);
+}
+
+static int
+hkdf_extract_op(bench *b)
+{
+  kdf_state *s = b->state;
+
+  return hkdf_sha512_extract(s->prk, s->salt, sizeof s->salt, s->ikm,
+                             sizeof s->ikm);
+}
+
+static int
+hkdf_expand_op(bench *b)
+{
+  kdf_state *s = b->state;
+
+  return hkdf_sha512_expand(s->okm, sizeof s->okm, s->prk, s->info,
+                            sizeof s->info);
+}
+
+static int
+x25519_dh_op(bench *b)
+{
+  kdf_state *s = b->state;
+
+  return x25519_dh(s->shared, s->sk, s->peer_pk);
+}
+
+/* ---------------- Argon2id ---------------- */
+
+/* The two profiles of mnemonic.ts, ARGON2_PROFILE_INTERACTIVE and
+ * ARGON2_PROFILE_BACKUP. */
+static const struct
+{
+  unsigned int t_cost;
+  unsigned int m_kib;
+  unsigned int lanes;
+} argon2_profiles[] = { { 2, 64U * 1024U, 1 }, { 3, 256U * 1024U, 4 } };
+
+typedef struct
+{
+  uint8_t seed[crypto_sign_ed25519_SEEDBYTES];
+  uint8_t salt[crypto_pwhash_argon2id_SALTBYTES];
+  char mnemonic[96];
+  uint8_t *memory;
+} argon2_state;
+
+static void
+argon2_release(bench *b)
+{
+  argon2_state *s = b->state;
+
+  if (!s) return;
+  free(s->memory);
+  sodium_memzero(s, sizeof *s);
+  free(s);
+  b->state = NULL;
+}
+
+static int
+argon2_op(bench *b)
+{
+  argon2_state *s = b->state;
+
+  return argon2(sizeof s->mnemonic, s->seed, s->mnemonic, s->salt);
+}
+
+static int
+argon2id_hash_op(bench *b)
+{
+  argon2_state *s = b->state;
+
+  return argon2id_hash(s->seed, sizeof s->seed, (const uint8_t *)s->mnemonic,
+                       sizeof s->mnemonic, s->salt, sizeof s->salt, NULL, 0,
+                       NULL, 0, argon2_profiles[b->n].t_cost,
+                       argon2_profiles[b->n].m_kib,
+                       argon2_profiles[b->n].lanes, s->memory);
+}
+
+static int
+argon2_prepare(bench *b)
+{
+  argon2_state *s = calloc(1, sizeof *s);
+
+  b->state = s;
+  if (!s) return -1;
+  randombytes_buf(s->salt, sizeof s->salt);
+  memset(s->mnemonic, 'a', sizeof s->mnemonic);
+  // argon2 is libsodium's, which allocates its own.
+  if (b->op != argon2id_hash_op) return 0;
+
+  const size_t MEMORY_BYTES = argon2id_memory_bytes(
+      argon2_profiles[b->n].m_kib, argon2_profiles[b->n].lanes);
+  if (MEMORY_BYTES == 0) return -1;
+  s->memory = malloc(MEMORY_BYTES);
+
+  return s->memory ? 0 : -1;
+}
+
+/* ---------------- Suite ---------------- */
+
+/* Frame rows process one plaintext cell (DECRYPTED_LEN) per call. */
+#define FRAME_BENCH(NAME, OP)                                                  \
+  { NAME, "{\"treeLeaves\":1024}", 0, CHUNK_PLAINTEXT_LEN, frame_prepare,      \
+    NULL, OP, frame_release, NULL }
+#define AEAD_BENCH(N)                                                          \
+  { "encrypt_chachapoly_symmetric", "{\"bytes\":" #N "}", N, N, aead_prepare,  \
+    NULL, encrypt_op, aead_release, NULL }
+#define MERKLE_BENCH(NAME, N, RESET, OP)                                       \
+  { NAME, "{\"leaves\":" #N "}", N, (size_t)N * crypto_hash_sha512_BYTES,      \
+    merkle_prepare, RESET, OP, merkle_release, NULL }
+/* A proof from the persistent tree only copies O(log n) nodes. */
+#define TREE_PROOF_BENCH(N)                                                    \
+  { "merkle_tree_proof", "{\"leaves\":" #N "}", N, 0, merkle_prepare, NULL,    \
+    merkle_tree_proof_op, merkle_release, NULL }
+#define MLKEM_BENCH(N, OP)                                                     \
+  { "mlkem" #N "_" #OP, "{}", 0, 0, mlkem##N##_prepare, NULL,                  \
+    mlkem##N##_##OP##_op, mlkem_release, NULL }
+#define KDF_BENCH(NAME, OP)                                                    \
+  { NAME, "{}", 0, 0, kdf_prepare, NULL, OP, kdf_release, NULL }
+#define ARGON2_BENCH(NAME, PARAMS, PROFILE, OP)                                \
+  { NAME, PARAMS, PROFILE, 0, argon2_prepare, NULL, OP, argon2_release, NULL }
+
+static bench suite[] = {
+  FRAME_BENCH("seal_message_chunk", seal_op),
+  FRAME_BENCH("receive_message_with_key", receive_op),
+  FRAME_BENCH("receive_message_with_key_fused", receive_fused_op),
+  AEAD_BENCH(1024),
+  /* One cell's plaintext. */
+  AEAD_BENCH(65405),
+  MERKLE_BENCH("get_merkle_root", 1000, merkle_reset, merkle_root_op),
+  MERKLE_BENCH("get_merkle_root", 10000, merkle_reset, merkle_root_op),
+  MERKLE_BENCH("get_merkle_root", 180000, merkle_reset, merkle_root_op),
+  MERKLE_BENCH("get_merkle_proof", 1000, merkle_reset, merkle_proof_op),
+  MERKLE_BENCH("get_merkle_proof", 10000, merkle_reset, merkle_proof_op),
+  MERKLE_BENCH("get_merkle_proof", 180000, merkle_reset, merkle_proof_op),
+  MERKLE_BENCH("merkle_tree_build", 1000, NULL, merkle_tree_build_op),
+  MERKLE_BENCH("merkle_tree_build", 10000, NULL, merkle_tree_build_op),
+  MERKLE_BENCH("merkle_tree_build", 180000, NULL, merkle_tree_build_op),
+  TREE_PROOF_BENCH(1000),
+  TREE_PROOF_BENCH(10000),
+  TREE_PROOF_BENCH(180000),
+  MLKEM_BENCH(512, keypair),
+  MLKEM_BENCH(512, encaps),
+  MLKEM_BENCH(512, decaps),
+  MLKEM_BENCH(768, keypair),
+  MLKEM_BENCH(768, encaps),
+  MLKEM_BENCH(768, decaps),
+  MLKEM_BENCH(1024, keypair),
+  MLKEM_BENCH(1024, encaps),
+  MLKEM_BENCH(1024, decaps),
+  KDF_BENCH("hkdf_sha512_extract", hkdf_extract_op),
+  KDF_BENCH("hkdf_sha512_expand", hkdf_expand_op),
+  KDF_BENCH("x25519_dh", x25519_dh_op),
+  ARGON2_BENCH("argon2", "{\"tCost\":2,\"mKiB\":65536,\"lanes\":1}", 0,
+               argon2_op),
+  ARGON2_BENCH("argon2id_hash", "{\"tCost\":2,\"mKiB\":65536,\"lanes\":1}",
+               0, argon2id_hash_op),
+  ARGON2_BENCH("argon2id_hash", "{\"tCost\":3,\"mKiB\":262144,\"lanes\":4}",
+               1, argon2id_hash_op),
+};
+
+/* Elapsed ns of ITERATIONS calls. With a reset, only the calls themselves are
+ * timed, one by one; the benchmarks that need one take microseconds or more
+ * per call, far above the clock's own cost. */
+static int
+bench_sample(bench *b, const uint64_t ITERATIONS, uint64_t *elapsed)
+{
+  uint64_t i, start, total = 0;
+
+  if (!b->reset)
+  {
+    start = now_ns();
+    for (i = 0; i < ITERATIONS; i++)
+      if (b->op(b) != 0) return -1;
+    *elapsed = now_ns() - start;
+
+    return 0;
+  }
+
+  for (i = 0; i < ITERATIONS; i++)
+  {
+    if (b->reset(b) != 0) return -1;
+    start = now_ns();
+    if (b->op(b) != 0) return -1;
+    total += now_ns() - start;
+  }
+  *elapsed = total;
+
+  return 0;
+}
+
+static int
+compare_double(const void *a, const void *b)
+{
+  const double x = *(const double *)a, y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+static void
+json_string(FILE *out, const char *s)
+{
+  fputc('"', out);
+  for (; *s; s++)
+  {
+    const unsigned char c = (unsigned char)*s;
+
+    if (c == '"' || c == '\\')
+      fprintf(out, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(out, "\\u%04x", c);
+    else
+      fputc(c, out);
+  }
+  fputc('"', out);
+}
+
+typedef struct
+{
+  uint64_t iterations;
+  double median;
+  double fastest;
+  double slowest;
+} bench_result;
+
+/* Calibrates (which doubles as the warm-up) until a sample takes about
+ * SAMPLE_NS, then takes SAMPLES samples of that many calls. */
+static int
+bench_run(bench *b, const unsigned int SAMPLES, const uint64_t SAMPLE_NS,
+          bench_result *result)
+{
+  double ns_per_op[BENCH_MAX_SAMPLES];
+  uint64_t iterations = 1, elapsed = 0;
+  unsigned int i;
+
+  for (;;)
+  {
+    if (bench_sample(b, iterations, &elapsed) != 0) return -1;
+    if (elapsed >= SAMPLE_NS / 10 || iterations >= BENCH_MAX_ITERATIONS)
+      break;
+    iterations *= 10;
+  }
+  if (elapsed < SAMPLE_NS)
+    iterations = iterations * SAMPLE_NS / (elapsed ? elapsed : 1);
+  if (iterations > BENCH_MAX_ITERATIONS) iterations = BENCH_MAX_ITERATIONS;
+
+  for (i = 0; i < SAMPLES; i++)
+  {
+    if (bench_sample(b, iterations, &elapsed) != 0) return -1;
+    ns_per_op[i] = (double)elapsed / (double)iterations;
+  }
+  qsort(ns_per_op, SAMPLES, sizeof ns_per_op[0], compare_double);
+
+  result->iterations = iterations;
+  result->median = SAMPLES % 2 != 0 ? ns_per_op[SAMPLES / 2]
+                                    : (ns_per_op[SAMPLES / 2 - 1]
+                                       + ns_per_op[SAMPLES / 2])
+                                          / 2;
+  result->fastest = ns_per_op[0];
+  result->slowest = ns_per_op[SAMPLES - 1];
+
+  return 0;
+}
+
+static void
+usage(FILE *out)
+{
+  fputs("usage: libcrypto_bench [--filter NAME] [--samples N] "
+        "[--sample-ms MS]\n"
+        "                       [--release VERSION] [--commit SHA] "
+        "[--output FILE] [--list]\n",
+        out);
+}
+
+int
+main(int argc, char **argv)
+{
+  const char *filter = NULL, *release = "", *commit = "", *output = NULL;
+  unsigned long samples = 5, sample_ms = 200;
+  int list = 0, first = 1, i;
+  size_t k;
+  struct utsname host;
+  FILE *out = stdout;
+
+  for (i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+    if (strcmp(arg, "--list") == 0)
+    {
+      list = 1;
+      continue;
+    }
+    if (strcmp(arg, "--help") == 0)
+    {
+      usage(stdout);
+      return 0;
+    }
+    if (!value)
+    {
+      usage(stderr);
+      return 2;
+    }
+    i++;
+    if (strcmp(arg, "--filter") == 0)
+      filter = value;
+    else if (strcmp(arg, "--samples") == 0)
+      samples = strtoul(value, NULL, 10);
+    else if (strcmp(arg, "--sample-ms") == 0)
+      sample_ms = strtoul(value, NULL, 10);
+    else if (strcmp(arg, "--release") == 0)
+      release = value;
+    else if (strcmp(arg, "--commit") == 0)
+      commit = value;
+    else if (strcmp(arg, "--output") == 0)
+      output = value;
+    else
+    {
+      usage(stderr);
+      return 2;
+    }
+  }
+  if (samples == 0 || samples > BENCH_MAX_SAMPLES || sample_ms == 0)
+  {
+    usage(stderr);
+    return 2;
+  }
+
+  if (list)
+  {
+    for (k = 0; k < sizeof suite / sizeof suite[0]; k++)
+      printf("%s %s\n", suite[k].name, suite[k].params);
+    return 0;
+  }
+
+  if (output && !(out = fopen(output, "w")))
+  {
+    perror(output);
+    return 1;
+  }
+  if (uname(&host) != 0) memset(&host, 0, sizeof host);
+
+  fprintf(out, "{\n  \"schemaVersion\": %d,\n  \"release\": ",
+          BENCH_SCHEMA_VERSION);
+  json_string(out, release);
+  fputs(",\n  \"commit\": ", out);
+  json_string(out, commit);
+  fputs(",\n  \"host\": { \"system\": ", out);
+  json_string(out, host.sysname);
+  fputs(", \"kernel\": ", out);
+  json_string(out, host.release);
+  fputs(", \"machine\": ", out);
+  json_string(out, host.machine);
+  fputs(" },\n  \"compiler\": ", out);
+  json_string(out, __VERSION__);
+  fputs(",\n  \"libsodium\": ", out);
+  json_string(out, sodium_version_string());
+  fprintf(out,
+          ",\n  \"simd\": { \"sha512x4\": %s, \"chacha20poly1305x4\": %s },"
+          "\n  \"threads\": %u,\n  \"samples\": %lu,\n  \"sampleMs\": %lu,"
+          "\n  \"results\": [",
+          SHA512X4_SIMD ? "true" : "false",
+          CHACHA20POLY1305X4_SIMD ? "true" : "false", pool_threads(),
+          samples, sample_ms);
+
+  for (k = 0; k < sizeof suite / sizeof suite[0]; k++)
+  {
+    bench *b = &suite[k];
+    bench_result result;
+    int res;
+
+    if (filter && !strstr(b->name, filter)) continue;
+
+    res = b->prepare(b);
+    if (res == 0)
+      res = bench_run(b, (unsigned int)samples, sample_ms * 1000000ULL,
+                      &result);
+    b->release(b);
+    if (res != 0)
+    {
+      fprintf(stderr, "%s %s: failed\n", b->name, b->params);
+      if (out != stdout) fclose(out);
+      return 1;
+    }
+
+    const size_t BYTES = b->bytes;
+
+    fprintf(stderr, "%-32s %-40s %14.1f ns/op\n", b->name, b->params,
+            result.median);
+    fprintf(out,
+            "%s\n    { \"name\": \"%s\", \"params\": %s, \"iterations\": %llu,"
+            " \"nsPerOp\": %.1f, \"nsPerOpMin\": %.1f, \"nsPerOpMax\": %.1f,"
+            " \"bytesPerOp\": %zu, \"mbPerSec\": ",
+            first ? "" : ",", b->name, b->params,
+            (unsigned long long)result.iterations, result.median,
+            result.fastest, result.slowest, BYTES);
+    if (BYTES)
+      fprintf(out, "%.2f }", (double)BYTES * 1000.0 / result.median);
+    else
+      fputs("null }", out);
+    first = 0;
+  }
+  fputs("\n  ]\n}\n", out);
+
+  if (out != stdout && fclose(out) != 0)
+  {
+    perror(output);
+    return 1;
+  }
+
+  return 0;
+}
@@ -31,7 +31,7 @@ export default [
   pluginJs.configs.recommended,
   ...tseslint.configs.recommended,
   {
-    files: ["scripts/**/*.{js,mjs}"],
+    files: ["scripts/**/*.{js,mjs}", "bench/**/*.{js,mjs}"],
     ...tseslint.configs.disableTypeChecked,
     languageOptions: { globals: globals.node },
     rules: {
@@ -162,7 +162,7 @@ const validateWasmGlue = async (wasmBytes) => {
     fail("configured libsodium runtime did not initialize");
 };
 
-const validateCryptoProvenance = (provenance, wasmBytes) => {
+const validateCryptoProvenance = (provenance, wasmBytes, simdWasmBytes) => {
   if (provenance.schemaVersion !== 1)
     fail("crypto provenance has an unsupported schema version");
   if (provenance.sources?.libsodium?.commit !== expectedLibsodiumCommit)
@@ -201,6 +201,10 @@ const validateCryptoProvenance = (provenance, wasmBytes) => {
     fail("crypto provenance does not attest that LTO is disabled");
   if (provenance.build?.publicSodiumApi !== true)
     fail("crypto provenance does not attest public libsodium API use");
+  if (provenance.build?.simd128 !== false)
+    fail("crypto provenance does not attest a scalar baseline artifact");
+  if (provenance.build?.stats === true)
+    fail("crypto provenance is for a P2PARTY_WASM_STATS build");
   // Exact equality, not a loose match. The old pattern also accepted
   // "6.0.3-git" and anything else containing the version, so a provenance file
   // generated by a differently-installed compiler passed here and only failed
@@ -215,6 +219,14 @@ const validateCryptoProvenance = (provenance, wasmBytes) => {
     fail("crypto provenance has an incorrect WASM SHA-256");
   if (provenance.artifact?.sri !== sri(wasmBytes))
     fail("crypto provenance has an incorrect WASM SRI");
+  if (provenance.simdArtifact?.file !== "libcrypto.simd.wasm")
+    fail("crypto provenance does not attest the SIMD WASM");
+  if (provenance.simdArtifact?.bytes !== simdWasmBytes.byteLength)
+    fail("crypto provenance has an incorrect SIMD WASM byte length");
+  if (provenance.simdArtifact?.sha256 !== sha("sha256", simdWasmBytes))
+    fail("crypto provenance has an incorrect SIMD WASM SHA-256");
+  if (provenance.simdArtifact?.sri !== sri(simdWasmBytes))
+    fail("crypto provenance has an incorrect SIMD WASM SRI");
 };
 
 /**
@@ -329,7 +341,7 @@ const syncDocumentedIntegrity = () => {
 
 const validateBundle = (
   relativePath,
-  expectedIntegrity,
+  expectedIntegrities,
   expectedPublicNames = [],
 ) => {
   const source = readFileSync(requireFile(relativePath), "utf8");
@@ -337,8 +349,9 @@ const validateBundle = (
     fail(
       `${relativePath} does not embed package version ${packageJson.version}`,
     );
-  if (!source.includes(expectedIntegrity))
-    fail(`${relativePath} does not embed the current WASM SRI`);
+  for (const expectedIntegrity of expectedIntegrities)
+    if (!source.includes(expectedIntegrity))
+      fail(`${relativePath} does not embed the current WASM SRI`);
   // The bundle builds its CDN URL by interpolating the version constant, so a
   // hardcoded version should never appear. Reject any CDN reference that names
   // a literal version other than this release's — a denylist of known-old
@@ -458,6 +471,7 @@ const validatePackList = (packResult) => {
     "lib/session.d.ts",
     "lib/db.worker.js",
     "lib/libcrypto.wasm",
+    "lib/libcrypto.simd.wasm",
     "lib/libcrypto.provenance.json",
   ];
   for (const requiredPath of required)
@@ -479,6 +493,7 @@ const runtimeArtifacts = [
   "session.js",
   "session.mjs",
   "libcrypto.wasm",
+  "libcrypto.simd.wasm",
   "libcrypto.provenance.json",
 ];
 
@@ -554,7 +569,7 @@ try {
     env: releaseBuildEnvironment,
   });
 
-  console.log("[4/7] Copy and validate the exact WASM artifact");
+  console.log("[4/7] Copy and validate the exact WASM artifacts");
   const sourceWasmPath = path.join(
     projectRoot,
     "src",
@@ -562,6 +577,13 @@ try {
     "libcrypto.wasm",
   );
   const packagedWasmPath = path.join(stageLib, "libcrypto.wasm");
+  const sourceSimdWasmPath = path.join(
+    projectRoot,
+    "src",
+    "cryptography",
+    "libcrypto.simd.wasm",
+  );
+  const packagedSimdWasmPath = path.join(stageLib, "libcrypto.simd.wasm");
   const sourceProvenancePath = path.join(
     projectRoot,
     "src",
@@ -573,22 +595,29 @@ try {
     "libcrypto.provenance.json",
   );
   const sourceWasm = readFileSync(sourceWasmPath);
+  const sourceSimdWasm = readFileSync(sourceSimdWasmPath);
   const sourceProvenanceBytes = readFileSync(sourceProvenancePath);
   const sourceProvenance = JSON.parse(sourceProvenanceBytes.toString("utf8"));
-  validateCryptoProvenance(sourceProvenance, sourceWasm);
+  validateCryptoProvenance(sourceProvenance, sourceWasm, sourceSimdWasm);
   copyFileSync(sourceWasmPath, packagedWasmPath);
+  copyFileSync(sourceSimdWasmPath, packagedSimdWasmPath);
   copyFileSync(sourceProvenancePath, packagedProvenancePath);
   const packagedWasm = readFileSync(packagedWasmPath);
   if (!sourceWasm.equals(packagedWasm))
     fail("packaged WASM differs from the just-compiled source artifact");
+  if (!sourceSimdWasm.equals(readFileSync(packagedSimdWasmPath)))
+    fail("packaged SIMD WASM differs from the just-compiled source artifact");
 
   const expectedIntegrity = sri(sourceWasm);
+  const expectedSimdIntegrity = sri(sourceSimdWasm);
   const loaderSource = readFileSync(
     path.join(projectRoot, "src", "cryptography", "wasmLoader.ts"),
     "utf8",
   );
   if (!loaderSource.includes(expectedIntegrity))
     fail("wasmLoader.ts SRI does not match the just-compiled WASM");
+  if (!loaderSource.includes(expectedSimdIntegrity))
+    fail("wasmLoader.ts SRI does not match the just-compiled SIMD WASM");
   if (
     !loaderSource.includes(
       `process.env.P2PARTY_VERSION ?? "${packageJson.version}"`,
@@ -596,7 +625,10 @@ try {
   )
     fail("wasmLoader.ts fallback version does not match package.json");
 
+  // The one shipped glue drives both builds; Node 24 runs SIMD, so the SIMD
+  // artifact is instantiated here too, not just hashed.
   await validateWasmGlue(sourceWasm);
+  await validateWasmGlue(sourceSimdWasm);
 
   for (const fileName of [
     "package.json",
@@ -639,9 +671,13 @@ try {
   }
 
   for (const bundle of ["lib/index.js", "lib/index.mjs", "lib/index.min.js"])
-    validateBundle(bundle, expectedIntegrity, ["setWasmSourceUrl"]);
+    validateBundle(
+      bundle,
+      [expectedIntegrity, expectedSimdIntegrity],
+      ["setWasmSourceUrl"],
+    );
   for (const bundle of ["lib/session.js", "lib/session.mjs"])
-    validateBundle(bundle, expectedIntegrity);
+    validateBundle(bundle, [expectedIntegrity, expectedSimdIntegrity]);
   await validateSessionSurface();
   syncDocumentedIntegrity();
 
@@ -679,6 +715,13 @@ try {
   );
   if (!sourceWasm.equals(archivedWasm))
     fail("WASM bytes changed while packing the tarball");
+  const archivedSimdWasm = execFileSync(
+    "tar",
+    ["-xOf", stagedTarball, "package/lib/libcrypto.simd.wasm"],
+    { maxBuffer: 8 * 1024 * 1024 },
+  );
+  if (!sourceSimdWasm.equals(archivedSimdWasm))
+    fail("SIMD WASM bytes changed while packing the tarball");
   const archivedProvenance = execFileSync(
     "tar",
     ["-xOf", stagedTarball, "package/lib/libcrypto.provenance.json"],
@@ -705,6 +748,8 @@ try {
   console.log(`WASM bytes: ${sourceWasm.byteLength}`);
   console.log(`WASM SHA-256: ${sha("sha256", sourceWasm)}`);
   console.log(`WASM SRI: ${expectedIntegrity}`);
+  console.log(`SIMD WASM bytes: ${sourceSimdWasm.byteLength}`);
+  console.log(`SIMD WASM SRI: ${expectedSimdIntegrity}`);
   console.log(`libsodium commit: ${expectedLibsodiumCommit}`);
   console.log(`libsodium tree: ${expectedLibsodiumTree}`);
   console.log(`Tarball SHA-256: ${sha("sha256", tarballBytes)}`);
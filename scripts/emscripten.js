@@ -4,19 +4,28 @@ const os = require("os");
 const path = require("path");
 const { execFileSync } = require("child_process");
 
-const { methodsPath, libsodiumRepositoryPath } = require("./paths");
+const { methodsPath } = require("./paths");
+const {
+  LIBSODIUM_COMMIT,
+  LIBSODIUM_TREE,
+  libsodiumArchive,
+  extractLibsodium,
+} = require("./libsodium");
 
-const LIBSODIUM_COMMIT = "2ce4d906a68eae82b27b4867f3d4172ec508cb27";
-const LIBSODIUM_TREE = "2dabe17c708edd7334e3316b5094b753859395d9";
 const MLKEM_NATIVE_COMMIT = "0ba906cb14b1c241476134d7403a811b382ca498";
 const MLKEM_NATIVE_SOURCE_TREE_SHA256 =
   "a2e15382a8dc0207752b3f5cdfc907886505fe304948183b4b61e99e7cb92ac6";
 const MLKEM_WRAPPER_SHA256 =
-  "181160a16f22e30eafc85d7be7a3be47be41026da14b0488f120ededc36ea072";
+  "6c6c8caaf090060622570af5c6a2f8572e406bd90b663d4a4e162dfdded4c5ca";
+const MLKEM_SIMD_BACKEND_SHA256 =
+  "6d8d5c27ea286cdfc59af8f848c357d6c96325e6346c5dac8ef11fdb7883a303";
 
 const buildPath = path.join(process.cwd(), "src", "cryptography");
 const finalJsPath = path.join(buildPath, "libcrypto.js");
 const finalWasmPath = path.join(buildPath, "libcrypto.wasm");
+const finalSimdWasmPath = path.join(buildPath, "libcrypto.simd.wasm");
+const finalPthreadJsPath = path.join(buildPath, "libcrypto.pthread.js");
+const finalPthreadWasmPath = path.join(buildPath, "libcrypto.pthread.wasm");
 const finalTypesPath = path.join(buildPath, "libcrypto.d.ts");
 const finalProvenancePath = path.join(buildPath, "libcrypto.provenance.json");
 const stagingPath = fs.mkdtempSync(
@@ -24,6 +33,11 @@ const stagingPath = fs.mkdtempSync(
 );
 const stagedJsPath = path.join(stagingPath, "libcrypto.js");
 const stagedWasmPath = path.join(stagingPath, "libcrypto.wasm");
+const stagedSimdPath = path.join(stagingPath, "simd");
+const stagedSimdJsPath = path.join(stagedSimdPath, "libcrypto.js");
+const stagedSimdWasmPath = path.join(stagedSimdPath, "libcrypto.wasm");
+const stagedPthreadJsPath = path.join(stagingPath, "libcrypto.pthread.js");
+const stagedPthreadWasmPath = path.join(stagingPath, "libcrypto.pthread.wasm");
 const stagedTypesPath = path.join(stagingPath, "libcrypto.d.ts");
 const stagedProvenancePath = path.join(
   stagingPath,
@@ -31,11 +45,13 @@ const stagedProvenancePath = path.join(
 );
 const libsodiumSourcePath = path.join(stagingPath, "libsodium-source");
 const libsodiumInstallPath = path.join(stagingPath, "libsodium-install");
-const libsodiumIncludePath = path.join(libsodiumInstallPath, "include");
-const libsodiumArchivePath = path.join(
-  libsodiumInstallPath,
-  "lib",
-  "libsodium.a",
+const libsodiumThreadsSourcePath = path.join(
+  stagingPath,
+  "libsodium-threads-source",
+);
+const libsodiumThreadsInstallPath = path.join(
+  stagingPath,
+  "libsodium-threads-install",
 );
 const mlkemPaths = [512, 768, 1024].map((parameterSet) =>
   path.join(buildPath, `mlkem${parameterSet}.c`),
@@ -51,11 +67,25 @@ const mlkemWrapperFiles = [512, 768, 1024]
     `mlkem${parameterSet}.c`,
     `mlkem${parameterSet}.h`,
   ])
+  .concat(["mlkem_batch.h", "mlkem_expanded.h"])
   .sort();
+// The SIMD128 arithmetic and x4 Keccak backends for mlkem-native. They live
+// outside the vendored tree so that digest stays upstream's, and are pinned on
+// their own.
+const mlkemSimdBackendFiles = ["mlkem_keccakx4.h", "mlkem_simd.h"];
 const typesPath = path.join(process.cwd(), "scripts", "libcrypto.d.ts");
 const types = fs.readFileSync(typesPath);
 const buildMode =
   process.env.NODE_ENV === "production" ? "production" : "development";
+// Opt-in: also build libcrypto.pthread.{js,wasm}, which wasmLoader.ts loads on
+// cross-origin isolated pages. It needs its own libsodium (shared memory
+// requires every object to be compiled with atomics) and its own JS glue.
+const threadsBuild = process.env.P2PARTY_WASM_THREADS === "1";
+// Per-export call counters and latency histograms (stats.c). Development
+// builds always carry them; a production build only with P2PARTY_WASM_STATS=1,
+// so the shipped artifacts compile them out unless asked for.
+const statsBuild =
+  buildMode === "development" || process.env.P2PARTY_WASM_STATS === "1";
 
 const run = (command, args, options = {}) =>
   execFileSync(command, args, {
@@ -115,13 +145,35 @@ const exportedFunctions = [
   "_crypto_init",
   "_sign",
   "_verify",
+  "_verify_batch",
   "_get_merkle_proof",
   "_get_merkle_root",
   "_get_merkle_root_from_proof",
   "_verify_merkle_proof",
+  "_merkle_leaf_hash_batch",
+  "_merkle_tree_bytes",
+  "_merkle_tree_build",
+  "_merkle_tree_root",
+  "_merkle_tree_proof",
+  "_merkle_range_proof_bytes",
+  "_merkle_tree_range_proof",
+  "_verify_merkle_range_proof",
+  "_merkle_accumulator_init",
+  "_merkle_accumulator_append",
+  "_merkle_accumulator_root",
+  "_merkle_proof_cache_init",
+  "_merkle_proof_cache_verify",
+  "_chunk_receipt_token_batch",
+  "_chunk_range_receipt_token",
+  "_merkle_tree_verify_range_receipt",
+  "_chunker_init",
+  "_chunker_layout",
+  "_chunker_final",
   "_keypair_from_seed",
   "_keypair_from_secret_key",
   "_argon2",
+  "_argon2id_memory_bytes",
+  "_argon2id_hash",
   "_sha512_init",
   "_sha512_update",
   "_sha512_final",
@@ -132,9 +184,48 @@ const exportedFunctions = [
   "_x25519_dh",
   "_hkdf_sha512_extract",
   "_hkdf_sha512_expand",
+  "_skipped_keys_init",
+  "_skipped_keys_rehash",
+  "_skipped_keys_count",
+  "_skipped_keys_put",
+  "_skipped_keys_get",
+  "_skipped_keys_take",
+  "_skipped_keys_export",
+  "_skipped_keys_import",
+  "_ratchet_state_import",
+  "_ratchet_state_export",
+  "_ratchet_init",
+  "_ratchet_prime_responder",
+  "_ratchet_encrypt_step",
+  "_ratchet_decrypt_step",
+  "_handshake_key_schedule",
+  "_arena_bytes",
+  "_arena_init",
+  "_arena_push",
+  "_arena_alloc",
+  "_arena_pop",
+  "_slab_bytes",
+  "_slab_init",
+  "_slab_alloc",
+  "_slab_free",
+  "_slab_stats",
+  "_pool_init",
+  "_pool_threads",
+  "_libcrypto_stats_bytes",
+  "_libcrypto_stats_snapshot",
   "_encrypt_chachapoly_symmetric",
   "_decrypt_chachapoly_symmetric",
+  "_seal_message_chunk",
   "_receive_message_with_key",
+  "_receive_message_with_key_fused",
+  "_receive_message_with_proof_cache",
+  "_receive_message_batch",
+  "_ingress_ring_bytes",
+  "_ingress_ring_init",
+  "_ingress_ring_claim",
+  "_ingress_ring_slot",
+  "_ingress_ring_release",
+  "_receive_message_in_slot",
   "_mlkem512_keypair",
   "_mlkem512_encaps",
   "_mlkem512_decaps",
@@ -144,9 +235,27 @@ const exportedFunctions = [
   "_mlkem1024_keypair",
   "_mlkem1024_encaps",
   "_mlkem1024_decaps",
+  "_mlkem512_keypair_batch",
+  "_mlkem512_encaps_batch",
+  "_mlkem768_keypair_batch",
+  "_mlkem768_encaps_batch",
+  "_mlkem1024_keypair_batch",
+  "_mlkem1024_encaps_batch",
+  "_mlkem512_expanded_bytes",
+  "_mlkem512_expand",
+  "_mlkem512_encaps_expanded",
+  "_mlkem768_expanded_bytes",
+  "_mlkem768_expand",
+  "_mlkem768_encaps_expanded",
+  "_mlkem1024_expanded_bytes",
+  "_mlkem1024_expand",
+  "_mlkem1024_encaps_expanded",
 ];
 
-const emccArgs = [
+const libsodiumInstall = (threads) =>
+  threads ? libsodiumThreadsInstallPath : libsodiumInstallPath;
+
+const emccArgs = (simd128, outputPath, threads = false) => [
   "--no-entry",
   "-fno-exceptions",
   "-fno-PIC",
@@ -199,7 +308,9 @@ const emccArgs = [
   "-s",
   "MODULARIZE=1",
   "-s",
-  'INCOMING_MODULE_JS_API=["wasmBinary","wasmMemory"]',
+  threads
+    ? 'INCOMING_MODULE_JS_API=["wasmBinary","wasmMemory","pthreadPoolSize","mainScriptUrlOrBlob"]'
+    : 'INCOMING_MODULE_JS_API=["wasmBinary","wasmMemory"]',
   "-s",
   "POLYFILL=0",
   "-s",
@@ -226,6 +337,29 @@ const emccArgs = [
   "GL_WORKAROUND_SAFARI_GETCONTEXT_BUG=0",
   "-s",
   "SUPPORT_LONGJMP=0",
+  // WebAssembly SIMD128: the four-lane SHA-512 (sha512x4.c) and ChaCha20-
+  // Poly1305 (chacha20poly1305x4.c) kernels compile to v128 operations only
+  // with this, and the ML-KEM units switch to the mlkem_simd.h arithmetic and
+  // mlkem_keccakx4.h Keccak backends. It is a second artifact, not the only
+  // one: engines without SIMD reject a module that uses it, so the scalar
+  // build, where both kernels fall back to libsodium and ML-KEM runs portable
+  // C, stays the baseline that wasmLoader.ts falls back to.
+  ...(simd128 ? ["-msimd128"] : []),
+  ...(statsBuild ? ["-DP2PARTY_STATS"] : []),
+  // The threaded artifact: shared memory and Web Worker pthreads for the task
+  // pool in pool.c. The loader passes how many workers to start, so a module
+  // that stays single-threaded does not pay for them, and pool_init then never
+  // waits on a worker booting. Its glue is an ES module, imported from the
+  // same SRI-checked bytes the workers start from.
+  ...(threads
+    ? [
+        "-pthread",
+        "-s",
+        "PTHREAD_POOL_SIZE=Module.pthreadPoolSize",
+        "-s",
+        "EXPORT_ES6=1",
+      ]
+    : []),
   ...(buildMode === "production"
     ? ["-O3", "-s", "ASSERTIONS=0"]
     : [
@@ -246,13 +380,13 @@ const emccArgs = [
   `EXPORTED_FUNCTIONS=${JSON.stringify(exportedFunctions)}`,
   "-s",
   "EXPORT_NAME=libcrypto",
-  `-I${libsodiumIncludePath}`,
+  `-I${path.join(libsodiumInstall(threads), "include")}`,
   `-I${mlkemIncludePath}`,
   "-o",
-  stagedJsPath,
+  outputPath,
   methodsPath,
   ...mlkemPaths,
-  libsodiumArchivePath,
+  path.join(libsodiumInstall(threads), "lib", "libsodium.a"),
 ];
 
 try {
@@ -261,6 +395,7 @@ try {
     listFiles(mlkemIncludePath),
   );
   const mlkemWrapperSha256 = digestFiles(buildPath, mlkemWrapperFiles);
+  const mlkemSimdBackendSha256 = digestFiles(buildPath, mlkemSimdBackendFiles);
   assertEqual(
     mlkemSourceTreeSha256,
     MLKEM_NATIVE_SOURCE_TREE_SHA256,
@@ -271,96 +406,96 @@ try {
     MLKEM_WRAPPER_SHA256,
     "p2party ML-KEM wrapper SHA-256",
   );
+  assertEqual(
+    mlkemSimdBackendSha256,
+    MLKEM_SIMD_BACKEND_SHA256,
+    "p2party ML-KEM SIMD backend SHA-256",
+  );
 
-  const resolvedCommit = capture("git", [
-    "-C",
-    libsodiumRepositoryPath,
-    "rev-parse",
-    `${LIBSODIUM_COMMIT}^{commit}`,
-  ]);
-  const resolvedTree = capture("git", [
-    "-C",
-    libsodiumRepositoryPath,
-    "rev-parse",
-    `${LIBSODIUM_COMMIT}^{tree}`,
-  ]);
-  assertEqual(resolvedCommit, LIBSODIUM_COMMIT, "libsodium commit");
-  assertEqual(resolvedTree, LIBSODIUM_TREE, "libsodium tree");
+  const sourceArchive = libsodiumArchive();
 
-  fs.mkdirSync(libsodiumSourcePath);
-  const sourceArchive = execFileSync(
-    "git",
-    [
-      "-C",
-      libsodiumRepositoryPath,
-      "archive",
-      "--format=tar",
-      LIBSODIUM_COMMIT,
-    ],
-    { maxBuffer: 64 * 1024 * 1024 },
-  );
-  run("tar", ["-xf", "-", "-C", libsodiumSourcePath], {
-    input: sourceArchive,
-  });
+  // Same pinned source and configuration for both builds; the threaded one
+  // only adds -pthread, which wasm-ld requires of every object it links into
+  // a shared memory. libsodium itself still runs without locks: sodium_init
+  // happens once, on the main thread, before any worker runs a task.
+  const buildLibsodium = (sourcePath, installPath, cflags) => {
+    extractLibsodium(sourceArchive, sourcePath);
 
-  const commonHeader = fs.readFileSync(
-    path.join(
-      libsodiumSourcePath,
-      "src",
-      "libsodium",
-      "include",
-      "sodium",
-      "private",
-      "common.h",
-    ),
-    "utf8",
-  );
-  if (!commonHeader.includes("!defined(DEV_MODE) && 0"))
-    throw new Error("pinned libsodium export is not a stable source tree");
+    const libsodiumBuildEnv = {
+      ...process.env,
+      CFLAGS: cflags,
+      CPPFLAGS: "",
+      LDFLAGS: "",
+    };
+    run(
+      "emconfigure",
+      [
+        "./configure",
+        "--disable-shared",
+        "--enable-static",
+        "--disable-dependency-tracking",
+        "--without-pthreads",
+        "--disable-ssp",
+        "--disable-asm",
+        "--disable-pie",
+        `--prefix=${installPath}`,
+      ],
+      { cwd: sourcePath, env: libsodiumBuildEnv },
+    );
+    run("emmake", ["make", "-j4", "install"], {
+      cwd: sourcePath,
+      env: libsodiumBuildEnv,
+    });
 
-  const libsodiumBuildEnv = {
-    ...process.env,
-    CFLAGS: "-O3",
-    CPPFLAGS: "",
-    LDFLAGS: "",
+    for (const configuredOutput of [
+      path.join(installPath, "lib", "libsodium.a"),
+      path.join(installPath, "include", "sodium.h"),
+    ])
+      if (!fs.existsSync(configuredOutput))
+        throw new Error(
+          `Missing configured libsodium output: ${configuredOutput}`,
+        );
   };
-  run(
-    "emconfigure",
-    [
-      "./configure",
-      "--disable-shared",
-      "--enable-static",
-      "--disable-dependency-tracking",
-      "--without-pthreads",
-      "--disable-ssp",
-      "--disable-asm",
-      "--disable-pie",
-      `--prefix=${libsodiumInstallPath}`,
-    ],
-    { cwd: libsodiumSourcePath, env: libsodiumBuildEnv },
-  );
-  run("emmake", ["make", "-j4", "install"], {
-    cwd: libsodiumSourcePath,
-    env: libsodiumBuildEnv,
-  });
 
-  for (const configuredOutput of [
-    libsodiumArchivePath,
-    path.join(libsodiumIncludePath, "sodium.h"),
-  ])
-    if (!fs.existsSync(configuredOutput))
-      throw new Error(
-        `Missing configured libsodium output: ${configuredOutput}`,
-      );
+  buildLibsodium(libsodiumSourcePath, libsodiumInstallPath, "-O3");
+  if (threadsBuild)
+    buildLibsodium(
+      libsodiumThreadsSourcePath,
+      libsodiumThreadsInstallPath,
+      "-O3 -pthread",
+    );
 
   fs.writeFileSync(stagedTypesPath, types);
-  run("emcc", emccArgs);
+  fs.mkdirSync(stagedSimdPath);
+  run("emcc", emccArgs(false, stagedJsPath));
+  run("emcc", emccArgs(true, stagedSimdJsPath));
+  // SIMD as well: every engine with shared-memory threads also has SIMD128.
+  if (threadsBuild) run("emcc", emccArgs(true, stagedPthreadJsPath, true));
 
-  for (const generatedPath of [stagedJsPath, stagedWasmPath, stagedTypesPath])
+  for (const generatedPath of [
+    stagedJsPath,
+    stagedWasmPath,
+    stagedTypesPath,
+    stagedSimdJsPath,
+    stagedSimdWasmPath,
+    ...(threadsBuild ? [stagedPthreadJsPath, stagedPthreadWasmPath] : []),
+  ])
     if (!fs.existsSync(generatedPath))
       throw new Error(`Missing generated artifact: ${generatedPath}`);
 
+  // Only the scalar build's glue is shipped, so it has to drive the SIMD
+  // module too: same exports, same imports, same memory contract.
+  if (!fs.readFileSync(stagedSimdJsPath).equals(fs.readFileSync(stagedJsPath)))
+    throw new Error("SIMD and scalar builds generated different JS glue");
+
   const wasmBytes = fs.readFileSync(stagedWasmPath);
+  const simdWasmBytes = fs.readFileSync(stagedSimdWasmPath);
+  const pthreadWasmBytes = threadsBuild
+    ? fs.readFileSync(stagedPthreadWasmPath)
+    : null;
+  const pthreadJsBytes = threadsBuild
+    ? fs.readFileSync(stagedPthreadJsPath)
+    : null;
 
   // Record the semantic version, not emcc's banner line.
   //
@@ -396,7 +531,12 @@ try {
         commit: MLKEM_NATIVE_COMMIT,
         sourceTreeSha256: mlkemSourceTreeSha256,
         wrapperSha256: mlkemWrapperSha256,
+        // libcrypto.wasm; libcrypto.simd.wasm runs simdBackend instead.
         backend: "portable-c",
+        simdBackend: {
+          files: mlkemSimdBackendFiles,
+          sha256: mlkemSimdBackendSha256,
+        },
         parameterSets: [512, 768, 1024],
         multilevel: {
           shared: 768,
@@ -410,6 +550,8 @@ try {
     build: {
       mode: buildMode,
       linkTimeOptimization: false,
+      simd128: false,
+      stats: statsBuild,
       publicSodiumApi: true,
     },
     artifact: {
@@ -418,6 +560,32 @@ try {
       sha256: sha("sha256", wasmBytes),
       sri: `sha384-${sha("sha384", wasmBytes, "base64")}`,
     },
+    // Same sources and flags as `artifact` plus -msimd128; loaded instead of
+    // it on engines that validate WebAssembly SIMD.
+    simdArtifact: {
+      file: "libcrypto.simd.wasm",
+      bytes: simdWasmBytes.byteLength,
+      sha256: sha("sha256", simdWasmBytes),
+      sri: `sha384-${sha("sha384", simdWasmBytes, "base64")}`,
+    },
+    // Only with P2PARTY_WASM_THREADS=1: the SIMD build with -pthread, and
+    // the glue it needs, which the scalar glue cannot drive.
+    ...(threadsBuild
+      ? {
+          pthreadArtifact: {
+            file: "libcrypto.pthread.wasm",
+            bytes: pthreadWasmBytes.byteLength,
+            sha256: sha("sha256", pthreadWasmBytes),
+            sri: `sha384-${sha("sha384", pthreadWasmBytes, "base64")}`,
+            glue: {
+              file: "libcrypto.pthread.js",
+              bytes: pthreadJsBytes.byteLength,
+              sha256: sha("sha256", pthreadJsBytes),
+              sri: `sha384-${sha("sha384", pthreadJsBytes, "base64")}`,
+            },
+          },
+        }
+      : {}),
   };
   fs.writeFileSync(
     stagedProvenancePath,
@@ -426,9 +594,16 @@ try {
 
   const outputs = [
     [stagedWasmPath, finalWasmPath],
+    [stagedSimdWasmPath, finalSimdWasmPath],
     [stagedJsPath, finalJsPath],
     [stagedTypesPath, finalTypesPath],
     [stagedProvenancePath, finalProvenancePath],
+    ...(threadsBuild
+      ? [
+          [stagedPthreadWasmPath, finalPthreadWasmPath],
+          [stagedPthreadJsPath, finalPthreadJsPath],
+        ]
+      : []),
   ];
   const publishSuffix = path.basename(stagingPath);
   const preparedOutputs = outputs.map(([stagedPath, finalPath], index) => {
@@ -466,6 +641,12 @@ try {
       fs.rmSync(preparedPath, { force: true });
   }
 
+  // A threaded artifact from an earlier build no longer matches these sources
+  // or the provenance just written, so it must not be picked up and pinned.
+  if (!threadsBuild)
+    for (const stalePath of [finalPthreadWasmPath, finalPthreadJsPath])
+      fs.rmSync(stalePath, { force: true });
+
   console.log(
     `Successfully compiled c methods to Wasm from libsodium ${LIBSODIUM_COMMIT}.`,
   );
@@ -4,6 +4,8 @@ export interface LibCrypto extends EmscriptenModule {
   wasmMemory: WebAssembly.Memory;
   /** Web Crypto backed entropy callback supplied by the JavaScript loader. */
   getRandomValue?(): number;
+  /** Workers the threaded artifact starts with (its PTHREAD_POOL_SIZE). */
+  pthreadPoolSize?: number;
 
   _crypto_init(): number;
 
@@ -34,6 +36,14 @@ export interface LibCrypto extends EmscriptenModule {
     public_key: number, // Uint8Array,
     signature: number, // Uint8Array,
   ): number;
+  _verify_batch(
+    COUNT: number,
+    messages: number, // Uint8Array.byteOffset
+    message_lens: number, // Uint32Array.byteOffset
+    public_keys: number, // Uint8Array.byteOffset
+    signatures: number, // Uint8Array.byteOffset
+    results: number, // Uint8Array.byteOffset
+  ): number;
 
   _get_merkle_root(
     LEAVES_LEN: number,
@@ -59,12 +69,142 @@ export interface LibCrypto extends EmscriptenModule {
     proof: number, // Uint8Array.byteOffset
   ): number;
 
+  // SHA-512(0x00 || chunk) for COUNT contiguous chunks, four lanes at a time.
+  _merkle_leaf_hash_batch(
+    COUNT: number,
+    CHUNK_BYTES: number,
+    chunks: number, // Uint8Array.byteOffset
+    leaves_hashed: number, // Uint8Array.byteOffset
+  ): number;
+
+  // Persistent Merkle tree — every level built once, O(log n) proofs by index.
+  _merkle_tree_bytes(LEAVES_LEN: number): number;
+  _merkle_tree_build(
+    tree: number, // Uint8Array.byteOffset (merkle_tree_bytes)
+    LEAVES_LEN: number,
+    leaves_hashed: number, // Uint8Array.byteOffset
+  ): number;
+  _merkle_tree_root(
+    tree: number, // Uint8Array.byteOffset
+    root: number, // Uint8Array.byteOffset
+  ): number;
+  _merkle_tree_proof(
+    tree: number, // Uint8Array.byteOffset
+    index: number,
+    proof: number, // Uint8Array.byteOffset
+  ): number;
+  _merkle_range_proof_bytes(
+    LEAVES_LEN: number,
+    first: number,
+    count: number,
+  ): number;
+  _merkle_tree_range_proof(
+    tree: number, // Uint8Array.byteOffset
+    first: number,
+    count: number,
+    proof: number, // Uint8Array.byteOffset
+  ): number;
+  _verify_merkle_range_proof(
+    LEAVES_LEN: number,
+    first: number,
+    COUNT: number,
+    leaves_hashed: number, // Uint8Array.byteOffset
+    root: number, // Uint8Array.byteOffset
+    PROOF_BYTES: number,
+    proof: number, // Uint8Array.byteOffset
+  ): number;
+
+  // Append-only Merkle accumulator (O(log n) frontier) and receive-side proof
+  // cache; both states are heap structs allocated by JS.
+  _merkle_accumulator_init(
+    acc: number, // Uint8Array.byteOffset (3080-byte state)
+  ): number;
+  _merkle_accumulator_append(
+    acc: number, // Uint8Array.byteOffset
+    leaf_hash: number, // Uint8Array.byteOffset
+  ): number;
+  _merkle_accumulator_root(
+    acc: number, // Uint8Array.byteOffset
+    root: number, // Uint8Array.byteOffset
+  ): number;
+  _merkle_proof_cache_init(
+    cache: number, // Uint8Array.byteOffset (66628-byte state)
+    root: number, // Uint8Array.byteOffset
+  ): number;
+  _merkle_proof_cache_verify(
+    cache: number, // Uint8Array.byteOffset
+    PROOF_LEN: number,
+    element_hash: number, // Uint8Array.byteOffset
+    proof: number, // Uint8Array.byteOffset
+  ): number;
+
+  // Chunk receipt tokens: a batch of (root, index, leaf) triples, one token for
+  // a contiguous range, and the sender's range check against its tree.
+  _chunk_receipt_token_batch(
+    COUNT: number,
+    root: number, // Uint8Array.byteOffset
+    indexes: number, // Uint32Array.byteOffset
+    leaves_hashed: number, // Uint8Array.byteOffset (COUNT * 64)
+    tokens: number, // Uint8Array.byteOffset (COUNT * 64)
+  ): number;
+  _chunk_range_receipt_token(
+    root: number, // Uint8Array.byteOffset
+    first: number,
+    COUNT: number,
+    leaves_hashed: number, // Uint8Array.byteOffset (COUNT * 64)
+    token: number, // Uint8Array.byteOffset
+  ): number;
+  _merkle_tree_verify_range_receipt(
+    tree: number, // Uint8Array.byteOffset
+    first: number,
+    count: number,
+    token: number, // Uint8Array.byteOffset
+  ): number;
+
+  // Send-side chunker: whole-file SHA-512, cell padding and leaf hashes in
+  // one pass; the state is a heap struct allocated by JS.
+  _chunker_init(
+    chunker: number, // Uint8Array.byteOffset (216-byte state)
+    CHUNK_BYTES: number,
+  ): number;
+  _chunker_layout(
+    chunker: number, // Uint8Array.byteOffset
+    COUNT: number,
+    cells: number, // Uint8Array.byteOffset (COUNT * CHUNK_BYTES)
+    starts: number, // Uint32Array.byteOffset
+    lens: number, // Uint32Array.byteOffset
+    leaves_hashed: number, // Uint8Array.byteOffset (COUNT * 64)
+  ): number;
+  _chunker_final(
+    chunker: number, // Uint8Array.byteOffset
+    hash: number, // Uint8Array.byteOffset (64 bytes)
+  ): number;
+
   _argon2(
     MNEMONIC_LEN: number,
     seed: number,
     mnemonic: number,
     salt: number,
   ): number;
+  // Argon2id with caller-chosen (t, m, p) (argon2.c); `memory` is a heap
+  // block of _argon2id_memory_bytes(M_KIB, LANES) bytes, wiped on return.
+  _argon2id_memory_bytes(M_KIB: number, LANES: number): number;
+  _argon2id_hash(
+    out: number, // Uint8Array.byteOffset
+    OUT_LEN: number,
+    password: number, // Uint8Array.byteOffset
+    PASSWORD_LEN: number,
+    salt: number, // Uint8Array.byteOffset
+    SALT_LEN: number,
+    secret: number, // Uint8Array.byteOffset or 0
+    SECRET_LEN: number,
+    ad: number, // Uint8Array.byteOffset or 0
+    AD_LEN: number,
+    T_COST: number,
+    M_KIB: number,
+    LANES: number,
+    memory: number, // Uint8Array.byteOffset
+  ): number;
 
   // Streaming SHA-512 (plain, no domain separation) — state is a heap
   // crypto_hash_sha512_state (208 bytes) allocated by JS.
@@ -105,6 +245,126 @@ export interface LibCrypto extends EmscriptenModule {
     info: number,
     info_len: number,
   ): number;
+  // Skipped message keys (skipped_keys.c): a heap table of
+  // 32 + CAPACITY * 88 bytes allocated by JS; ids are 48 bytes and exported
+  // entries 80.
+  _skipped_keys_init(
+    table: number, // Uint8Array.byteOffset
+    CAPACITY: number,
+    LIMIT: number,
+  ): number;
+  _skipped_keys_rehash(
+    dst: number, // Uint8Array.byteOffset
+    src: number, // Uint8Array.byteOffset, wiped
+  ): number;
+  _skipped_keys_count(table: number): number;
+  _skipped_keys_put(
+    table: number, // Uint8Array.byteOffset
+    id: number, // Uint8Array.byteOffset (48 bytes)
+    message_key: number, // Uint8Array.byteOffset (32 bytes)
+  ): number;
+  _skipped_keys_get(
+    table: number, // Uint8Array.byteOffset
+    id: number, // Uint8Array.byteOffset (48 bytes)
+    message_key: number, // Uint8Array.byteOffset (32 bytes) or 0
+  ): number;
+  _skipped_keys_take(
+    table: number, // Uint8Array.byteOffset
+    id: number, // Uint8Array.byteOffset (48 bytes)
+    message_key: number, // Uint8Array.byteOffset (32 bytes) or 0
+  ): number;
+  _skipped_keys_export(
+    table: number, // Uint8Array.byteOffset
+    entries: number, // Uint8Array.byteOffset (count * 80 bytes)
+  ): number;
+  _skipped_keys_import(
+    table: number, // Uint8Array.byteOffset
+    COUNT: number,
+    entries: number, // Uint8Array.byteOffset (COUNT * 80 bytes)
+  ): number;
+  // Double Ratchet engine: the state is a heap ratchet_state (1056 bytes)
+  // allocated by JS and crossed only as the 217-byte serialized form.
+  _ratchet_state_import(
+    state: number, // Uint8Array.byteOffset (1056-byte state)
+    serialized: number, // Uint8Array.byteOffset (217 bytes)
+  ): number;
+  _ratchet_state_export(
+    serialized: number, // Uint8Array.byteOffset (217 bytes)
+    state: number, // Uint8Array.byteOffset
+  ): number;
+  _ratchet_init(
+    state: number, // Uint8Array.byteOffset
+    root_seed: number, // Uint8Array.byteOffset (32 bytes)
+    remote_dh_pub: number, // Uint8Array.byteOffset (32 bytes) or 0
+  ): number;
+  _ratchet_prime_responder(
+    state: number, // Uint8Array.byteOffset
+    initiator_dh_pub: number, // Uint8Array.byteOffset (32 bytes)
+  ): number;
+  _ratchet_encrypt_step(
+    state: number, // Uint8Array.byteOffset
+    message_key: number, // Uint8Array.byteOffset (32 bytes)
+    header: number, // Uint8Array.byteOffset (48 bytes)
+  ): number;
+  _ratchet_decrypt_step(
+    state: number, // Uint8Array.byteOffset
+    message_key: number, // Uint8Array.byteOffset (32 bytes)
+    header: number, // Uint8Array.byteOffset (48 bytes)
+    table: number, // skipped_keys table or 0
+    skipped: number, // Uint8Array.byteOffset (SKIPPED_CAP * 72)
+    SKIPPED_CAP: number,
+    skipped_len: number, // Uint32Array.byteOffset
+  ): number;
+  // v4 handshake key schedule (handshake.c): 3DH, hybrid root and PQ-healing
+  // root/binding in one call. Returns -2 for a small-order peer key.
+  _handshake_key_schedule(
+    root_key: number, // Uint8Array.byteOffset (32 bytes)
+    pq_healing_root: number, // Uint8Array.byteOffset (32 bytes)
+    binding: number, // Uint8Array.byteOffset (32 bytes)
+    identity_sec: number, // Uint8Array.byteOffset (32 bytes)
+    peer_identity_pub: number, // Uint8Array.byteOffset (32 bytes)
+    ephemeral_sec: number, // Uint8Array.byteOffset (32 bytes)
+    peer_ephemeral_pub: number, // Uint8Array.byteOffset (32 bytes)
+    am_initiator: number,
+    pake_isk: number, // Uint8Array.byteOffset (64 bytes) or 0
+    kem_secret: number, // Uint8Array.byteOffset (32 bytes)
+    hybrid_info: number, // Uint8Array.byteOffset
+    HYBRID_INFO_LEN: number,
+    binding_input: number, // Uint8Array.byteOffset
+    BINDING_INPUT_LEN: number,
+  ): number;
+  // Scratch arena (arena.c): a 16-byte header plus CAPACITY bytes allocated
+  // by JS, used in LIFO frames. _arena_alloc returns 0 outside a frame or when
+  // full; _arena_pop wipes everything above the mark.
+  _arena_bytes(CAPACITY: number): number;
+  _arena_init(arena: number, CAPACITY: number): number;
+  _arena_push(arena: number): number;
+  _arena_alloc(arena: number, LEN: number): number;
+  _arena_pop(arena: number, MARK: number): number;
+  // Secure slab allocator (slab.c): eight size classes in one block of
+  // _slab_bytes(CELL_SLOTS) bytes allocated by JS. _slab_alloc returns 0 on a
+  // miss; _slab_free wipes the slot and returns 1 for a pointer outside the
+  // slab and -1 for one that is not a live slot.
+  _slab_bytes(CELL_SLOTS: number): number;
+  _slab_init(slab: number, CELL_SLOTS: number): number;
+  _slab_alloc(slab: number, LEN: number): number;
+  _slab_free(slab: number, p: number): number;
+  _slab_stats(
+    slab: number,
+    stats: number, // Uint32Array.byteOffset (8 classes * 6 counters)
+  ): number;
+  // Task pool (pool.c) behind the batch exports. On the threaded artifact
+  // _pool_init hands THREADS - 1 of the module's workers to the pool; on the
+  // others it is a no-op and _pool_threads stays 1.
+  _pool_init(THREADS: number): number;
+  _pool_threads(): number;
+  // Call statistics (stats.c). _libcrypto_stats_bytes is 0 and
+  // _libcrypto_stats_snapshot -1 on artifacts built without them.
+  _libcrypto_stats_bytes(): number;
+  _libcrypto_stats_snapshot(
+    out: number, // Uint8Array.byteOffset (_libcrypto_stats_bytes())
+    OUT_LEN: number,
+  ): number;
   _encrypt_chachapoly_symmetric(
     out: number,
     data: number,
@@ -123,12 +383,59 @@ export interface LibCrypto extends EmscriptenModule {
     aad: number,
     aad_len: number,
   ): number;
+  _seal_message_chunk(
+    message: number, // WIRE_CHUNK_FRAME_LEN out
+    header: number, // CHUNK_AAD_HEADER_LEN clear header, nonce excluded
+    merkle_root: number,
+    metadata: number,
+    proof: number,
+    chunk: number,
+    message_key: number,
+  ): number;
   _receive_message_with_key(
     decrypted: number,
     message: number,
     merkle_root: number,
     message_key: number,
   ): number;
+  _receive_message_with_key_fused(
+    decrypted: number,
+    message: number,
+    merkle_root: number,
+    message_key: number,
+  ): number;
+  _receive_message_with_proof_cache(
+    decrypted: number,
+    message: number,
+    proof_cache: number,
+    message_key: number,
+  ): number;
+  _receive_message_batch(
+    COUNT: number,
+    decrypted: number, // COUNT * DECRYPTED_LEN
+    frames: number, // Uint8Array.byteOffset
+    FRAMES_LEN: number,
+    frame_offsets: number, // Uint32Array.byteOffset
+    merkle_roots: number, // COUNT * 64
+    proof_cache: number, // merkle_proof_cache_STATEBYTES, or 0
+    message_keys: number, // COUNT * 32
+    status: number, // Int32Array.byteOffset
+  ): number;
+  _ingress_ring_bytes(SLOTS: number): number;
+  _ingress_ring_init(
+    ring: number, // Uint8Array.byteOffset (ingress_ring_bytes)
+    SLOTS: number,
+  ): number;
+  _ingress_ring_claim(ring: number): number;
+  _ingress_ring_slot(ring: number, slot: number): number;
+  _ingress_ring_release(ring: number, slot: number): number;
+  _receive_message_in_slot(
+    ring: number,
+    slot: number,
+    merkle_root: number,
+    proof_cache: number, // merkle_proof_cache_STATEBYTES, or 0
+    message_key: number,
+  ): number;
 
   // ML-KEM (FIPS 203), deterministic entry points for all standardized
   // parameter sets. JavaScript supplies cryptographically secure coins;
@@ -147,6 +454,74 @@ export interface LibCrypto extends EmscriptenModule {
     coins32: number,
   ): number;
   _mlkem1024_decaps(ss: number, ct: number, sk: number): number;
+  // Up to four independent items per call, packed back to back; item i equals
+  // the single-item result for its coins (see mlkem_batch.h).
+  _mlkem512_keypair_batch(
+    pk: number,
+    sk: number,
+    coins64: number,
+    COUNT: number,
+  ): number;
+  _mlkem512_encaps_batch(
+    ct: number,
+    ss: number,
+    pk: number,
+    coins32: number,
+    COUNT: number,
+  ): number;
+  _mlkem768_keypair_batch(
+    pk: number,
+    sk: number,
+    coins64: number,
+    COUNT: number,
+  ): number;
+  _mlkem768_encaps_batch(
+    ct: number,
+    ss: number,
+    pk: number,
+    coins32: number,
+    COUNT: number,
+  ): number;
+  _mlkem1024_keypair_batch(
+    pk: number,
+    sk: number,
+    coins64: number,
+    COUNT: number,
+  ): number;
+  _mlkem1024_encaps_batch(
+    ct: number,
+    ss: number,
+    pk: number,
+    coins32: number,
+    COUNT: number,
+  ): number;
+  // A public key expanded once into _mlkemNNN_expanded_bytes() bytes of
+  // module memory; encapsulating against it equals _mlkemNNN_encaps on the
+  // original key (see mlkem_expanded.h). The caller wipes it before freeing.
+  _mlkem512_expanded_bytes(): number;
+  _mlkem512_expand(expanded: number, pk: number): number;
+  _mlkem512_encaps_expanded(
+    ct: number,
+    ss: number,
+    expanded: number,
+    coins32: number,
+  ): number;
+  _mlkem768_expanded_bytes(): number;
+  _mlkem768_expand(expanded: number, pk: number): number;
+  _mlkem768_encaps_expanded(
+    ct: number,
+    ss: number,
+    expanded: number,
+    coins32: number,
+  ): number;
+  _mlkem1024_expanded_bytes(): number;
+  _mlkem1024_expand(expanded: number, pk: number): number;
+  _mlkem1024_encaps_expanded(
+    ct: number,
+    ss: number,
+    expanded: number,
+    coins32: number,
+  ): number;
 }
 
 declare const libcrypto: EmscriptenModuleFactory<LibCrypto>;
@@ -0,0 +1,65 @@
+const fs = require("fs");
+const path = require("path");
+const { execFileSync } = require("child_process");
+
+const { libsodiumRepositoryPath } = require("./paths");
+
+const LIBSODIUM_COMMIT = "2ce4d906a68eae82b27b4867f3d4172ec508cb27";
+const LIBSODIUM_TREE = "2dabe17c708edd7334e3316b5094b753859395d9";
+
+const git = (args) =>
+  execFileSync("git", ["-C", libsodiumRepositoryPath, ...args], {
+    maxBuffer: 64 * 1024 * 1024,
+    stdio: ["ignore", "pipe", "inherit"],
+  });
+
+const assertEqual = (actual, expected, description) => {
+  if (actual !== expected)
+    throw new Error(
+      `${description} mismatch: expected ${expected}, received ${actual}`,
+    );
+};
+
+// The pinned commit as a tar archive, once the submodule has shown that it
+// resolves to the pinned tree. Both the WASM build (emscripten.js) and the
+// host build (native.js) compile from these bytes.
+const libsodiumArchive = () => {
+  const resolve = (object) =>
+    git(["rev-parse", `${LIBSODIUM_COMMIT}^{${object}}`])
+      .toString()
+      .trim();
+  assertEqual(resolve("commit"), LIBSODIUM_COMMIT, "libsodium commit");
+  assertEqual(resolve("tree"), LIBSODIUM_TREE, "libsodium tree");
+
+  return git(["archive", "--format=tar", LIBSODIUM_COMMIT]);
+};
+
+const extractLibsodium = (archive, sourcePath) => {
+  fs.mkdirSync(sourcePath, { recursive: true });
+  execFileSync("tar", ["-xf", "-", "-C", sourcePath], {
+    input: archive,
+    stdio: ["pipe", "inherit", "inherit"],
+  });
+
+  const commonHeader = fs.readFileSync(
+    path.join(
+      sourcePath,
+      "src",
+      "libsodium",
+      "include",
+      "sodium",
+      "private",
+      "common.h",
+    ),
+    "utf8",
+  );
+  if (!commonHeader.includes("!defined(DEV_MODE) && 0"))
+    throw new Error("pinned libsodium export is not a stable source tree");
+};
+
+module.exports = {
+  LIBSODIUM_COMMIT,
+  LIBSODIUM_TREE,
+  libsodiumArchive,
+  extractLibsodium,
+};
@@ -0,0 +1,167 @@
+// Host build of libcrypto and its micro-benchmarks (bench/native).
+//
+// Compiles the same sources as emscripten.js, libcrypto.c and the three
+// ML-KEM units, with the host's C compiler into build/native/libcrypto_bench,
+// then runs it. Arguments are passed through (see --help); --build-only stops
+// after compiling, for profiling the binary with perf or a debugger.
+//
+//   CC, CFLAGS                     compiler and flags (cc, -O3 -g)
+//   P2PARTY_NATIVE_SODIUM=system   link the host's libsodium (pkg-config,
+//                                  1.0.19 or newer) instead of building the
+//                                  pinned submodule commit
+const fs = require("fs");
+const os = require("os");
+const path = require("path");
+const { execFileSync } = require("child_process");
+
+const { methodsPath } = require("./paths");
+const {
+  LIBSODIUM_COMMIT,
+  libsodiumArchive,
+  extractLibsodium,
+} = require("./libsodium");
+
+const cryptographyPath = path.dirname(methodsPath);
+const mlkemPaths = [512, 768, 1024].map((parameterSet) =>
+  path.join(cryptographyPath, `mlkem${parameterSet}.c`),
+);
+const mlkemIncludePath = path.join(
+  cryptographyPath,
+  "vendor",
+  "mlkem-native",
+  "mlkem",
+);
+const benchSourcePath = path.join(
+  process.cwd(),
+  "bench",
+  "native",
+  "libcrypto_bench.c",
+);
+const buildPath = path.join(process.cwd(), "build", "native");
+const benchPath = path.join(buildPath, "libcrypto_bench");
+// Built once per pinned commit and reused by later runs.
+const libsodiumInstallPath = path.join(
+  buildPath,
+  `libsodium-${LIBSODIUM_COMMIT.slice(0, 12)}`,
+);
+
+const compiler = process.env.CC || "cc";
+const cflags = (process.env.CFLAGS || "-O3 -g").split(/\s+/).filter(Boolean);
+const systemSodium = process.env.P2PARTY_NATIVE_SODIUM === "system";
+const buildOnly = process.argv.includes("--build-only");
+const args = process.argv.slice(2).filter((arg) => arg !== "--build-only");
+
+const run = (command, commandArgs, options = {}) =>
+  execFileSync(command, commandArgs, {
+    cwd: options.cwd ?? process.cwd(),
+    env: options.env ?? process.env,
+    stdio: options.capture ? ["ignore", "pipe", "inherit"] : "inherit",
+    encoding: options.capture ? "utf8" : undefined,
+  });
+
+const capture = (command, commandArgs) =>
+  run(command, commandArgs, { capture: true }).trim();
+
+// Configured like the WASM build's libsodium (see emscripten.js), so the rows
+// compare the same code; libsodium still picks its SSE/AVX implementations at
+// run time where the host has them.
+const buildLibsodium = () => {
+  const libraryPath = path.join(libsodiumInstallPath, "lib", "libsodium.a");
+  if (fs.existsSync(libraryPath)) return;
+
+  const sourcePath = fs.mkdtempSync(
+    path.join(os.tmpdir(), "p2party-libsodium-native-"),
+  );
+  try {
+    extractLibsodium(libsodiumArchive(), sourcePath);
+
+    const env = { ...process.env, CC: compiler, CFLAGS: "-O3" };
+    run(
+      "./configure",
+      [
+        "--disable-shared",
+        "--enable-static",
+        "--disable-dependency-tracking",
+        "--without-pthreads",
+        "--disable-ssp",
+        "--disable-asm",
+        `--prefix=${libsodiumInstallPath}`,
+      ],
+      { cwd: sourcePath, env },
+    );
+    run("make", [`-j${os.availableParallelism()}`, "install"], {
+      cwd: sourcePath,
+      env,
+    });
+  } finally {
+    fs.rmSync(sourcePath, { recursive: true, force: true });
+  }
+
+  if (!fs.existsSync(libraryPath))
+    throw new Error(`Missing configured libsodium output: ${libraryPath}`);
+};
+
+// crypto_kdf_hkdf_sha512_*, which hkdf_sha512_* wrap, arrived in 1.0.19.
+const sodiumFlags = () => {
+  if (systemSodium) {
+    try {
+      run("pkg-config", ["--atleast-version=1.0.19", "libsodium"]);
+    } catch {
+      throw new Error("P2PARTY_NATIVE_SODIUM=system needs libsodium >= 1.0.19");
+    }
+
+    return {
+      cflags: capture("pkg-config", ["--cflags", "libsodium"])
+        .split(/\s+/)
+        .filter(Boolean),
+      libs: capture("pkg-config", ["--libs", "libsodium"])
+        .split(/\s+/)
+        .filter(Boolean),
+    };
+  }
+
+  buildLibsodium();
+
+  return {
+    cflags: [`-I${path.join(libsodiumInstallPath, "include")}`],
+    libs: [path.join(libsodiumInstallPath, "lib", "libsodium.a")],
+  };
+};
+
+const gitCommit = () => {
+  try {
+    return capture("git", ["rev-parse", "HEAD"]);
+  } catch {
+    return "";
+  }
+};
+
+fs.mkdirSync(buildPath, { recursive: true });
+
+const sodium = sodiumFlags();
+run(compiler, [
+  ...cflags,
+  ...sodium.cflags,
+  `-I${cryptographyPath}`,
+  `-I${mlkemIncludePath}`,
+  "-o",
+  benchPath,
+  benchSourcePath,
+  ...mlkemPaths,
+  ...sodium.libs,
+]);
+// stderr: the report may be going to stdout.
+console.error(`Built ${path.relative(process.cwd(), benchPath)}.`);
+
+if (!buildOnly) {
+  const { version } = JSON.parse(
+    fs.readFileSync(path.join(process.cwd(), "package.json"), "utf8"),
+  );
+  run(benchPath, [
+    "--release",
+    version,
+    "--commit",
+    gitCommit(),
+    ...args,
+  ]);
+}
@@ -1,34 +1,38 @@
 #!/usr/bin/env node
 // ============================================================================
-// Update the SRI integrity hash in wasmLoader.ts after emscripten rebuilds
-// the WASM binary. Runs automatically as part of prebuild / predist.
+// Update the SRI integrity hashes in wasmLoader.ts after emscripten rebuilds
+// the scalar and SIMD WASM binaries. Runs automatically as part of prebuild /
+// predist.
 // ============================================================================
-import { readFileSync, writeFileSync } from "fs";
+import { existsSync, readFileSync, writeFileSync } from "fs";
 import { createHash } from "crypto";
 import { resolve, dirname } from "path";
 import { fileURLToPath } from "url";
 
 const __dirname = dirname(fileURLToPath(import.meta.url));
-const wasmPath = resolve(
-  __dirname,
-  "..",
-  "src",
-  "cryptography",
-  "libcrypto.wasm",
-);
-const loaderPath = resolve(
-  __dirname,
-  "..",
-  "src",
-  "cryptography",
-  "wasmLoader.ts",
-);
+const wasmDirectory = resolve(__dirname, "..", "src", "cryptography");
+const loaderPath = resolve(wasmDirectory, "wasmLoader.ts");
 
-const wasmBytes = readFileSync(wasmPath);
-const sha384 = createHash("sha384").update(wasmBytes).digest("base64");
-const newIntegrity = `sha384-${sha384}`;
+// Each artifact's digest lives in its own request object in wasmLoader.ts.
+// The threaded pair only exists after a P2PARTY_WASM_THREADS=1 build. Without
+// it their literals keep a placeholder no response can match, so a threaded
+// load fails its SRI check and wasmLoader.ts falls back to the other two.
+const artifacts = [
+  { file: "libcrypto.wasm", request: "cdnRequest" },
+  { file: "libcrypto.simd.wasm", request: "simdCdnRequest" },
+  {
+    file: "libcrypto.pthread.wasm",
+    request: "pthreadCdnRequest",
+    optional: true,
+  },
+  {
+    file: "libcrypto.pthread.js",
+    request: "pthreadGlueCdnRequest",
+    optional: true,
+  },
+];
 
-const source = readFileSync(loaderPath, "utf-8");
+let source = readFileSync(loaderPath, "utf-8");
 
 // Replace only the quoted digest, never the whitespace around it.
 //
@@ -37,19 +41,27 @@ const source = readFileSync(loaderPath, "utf-8");
 // Move the constant and the two tools start overwriting each other: the build
 // writes six spaces, format:check demands four, and CI runs release:pack
 // immediately before check. Touching just the literal has no opinion about
-// layout, so Prettier stays the sole authority on formatting.
-const literal = /"sha384-[A-Za-z0-9+/=]+"/g;
-const matches = source.match(literal) ?? [];
-if (matches.length !== 1) {
-  console.error(
-    `Expected exactly one SRI literal in wasmLoader.ts, found ${matches.length}`,
+// layout, so Prettier stays the sole authority on formatting. The literal is
+// found through its object's name, so the two digests cannot be swapped.
+for (const { file, request, optional } of artifacts) {
+  if (optional && !existsSync(resolve(wasmDirectory, file))) continue;
+  const wasmBytes = readFileSync(resolve(wasmDirectory, file));
+  const sha384 = createHash("sha384").update(wasmBytes).digest("base64");
+  const newIntegrity = `sha384-${sha384}`;
+  const literal = new RegExp(
+    `(const ${request} = \\{\\s*integrity:\\s*)"sha384-[A-Za-z0-9+/=]+"`,
+    "g",
   );
-  process.exit(1);
+  const matches = source.match(literal) ?? [];
+  if (matches.length !== 1) {
+    console.error(
+      `Expected exactly one ${request} SRI literal in wasmLoader.ts, found ${matches.length}`,
+    );
+    process.exit(1);
+  }
+
+  source = source.replace(literal, `$1"${newIntegrity}"`);
+  console.log(`Updated wasmLoader.ts ${file} integrity → ${newIntegrity}`);
 }
 
-writeFileSync(
-  loaderPath,
-  source.replace(literal, `"${newIntegrity}"`),
-  "utf-8",
-);
-console.log(`Updated wasmLoader.ts integrity → ${newIntegrity}`);
+writeFileSync(loaderPath, source, "utf-8");
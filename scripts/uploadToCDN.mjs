@@ -72,6 +72,11 @@ const assets = [
     keyName: "libcrypto.wasm",
     contentType: "application/wasm",
   },
+  {
+    source: path.join("lib", "libcrypto.simd.wasm"),
+    keyName: "libcrypto.simd.wasm",
+    contentType: "application/wasm",
+  },
 ];
 
 const isNotFound = (error) =>
@@ -1,12 +1,14 @@
 import { handleOpenChannel } from "../../handlers/handleOpenChannel";
 import { handleConnectToPeer } from "../../handlers/handleConnectToPeer";
 import { teardownCoverEdge } from "../../handlers/coverEdge";
+import { freeReceiveProofCaches } from "../../handlers/receiveProofCache";
 
 import { getDBPeerIsBlacklisted } from "../../db/api";
 
 import { findRoomPeerConnectionIndex } from "./roomPeer";
 import { getRoomPeerMutex } from "./negotiationLock";
 import { isIdentityInitiator } from "../../utils/identityRole";
+import { retireCryptoStats } from "../../utils/debug";
 
 import type { BaseQueryFn } from "@reduxjs/toolkit/query";
 import type {
@@ -128,6 +130,10 @@ const webrtcBaseQuery: BaseQueryFn<
       teardownCoverEdge(epc);
       clearConnectionHandlers(epc);
       if (epc.connectionState !== "closed") epc.close();
+      epc.ingressRing?.free();
+      freeReceiveProofCaches(epc);
+      if (epc.receiveMessageModule)
+        retireCryptoStats(epc.receiveMessageModule);
       peerConnections.splice(connectionIndex, 1);
     }
 
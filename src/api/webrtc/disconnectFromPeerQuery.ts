@@ -8,7 +8,9 @@ import { clearHandshakeChannel } from "../../handlers/handleHandshake";
 import { destroyPqHealingOrchestrator } from "../../handlers/pqHealingOrchestrator";
 import { releaseScheduledReceipts } from "../../handlers/coverTransfer";
 import { teardownCoverEdge } from "../../handlers/coverEdge";
+import { freeReceiveProofCaches } from "../../handlers/receiveProofCache";
 import { rejectRatchetGate } from "../../handlers/ratchetGate";
+import { retireCryptoStats } from "../../utils/debug";
 import { releaseRoomPeerMutex } from "./negotiationLock";
 import { discardPendingIceCandidates } from "./pendingIceCandidates";
 
@@ -105,6 +107,10 @@ const webrtcDisconnectPeerQuery: BaseQueryFn<
     connection.onicegatheringstatechange = null;
     connection.oniceconnectionstatechange = null;
     if (connection.connectionState !== "closed") connection.close();
+    connection.ingressRing?.free();
+    freeReceiveProofCaches(connection);
+    if (connection.receiveMessageModule)
+      retireCryptoStats(connection.receiveMessageModule);
     peerConnections.splice(i, 1);
   }
 
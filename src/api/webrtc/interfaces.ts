@@ -1,7 +1,9 @@
 import type { LibCrypto } from "../../cryptography/libcrypto";
+import type { MerkleProofCache } from "../../cryptography/merkle";
 import type { RatchetState } from "../../cryptography/ratchet";
 import type { RatchetGateLease } from "../../handlers/ratchetGate";
 import type { CoverRuntime } from "../../handlers/coverRuntime";
+import type { IngressRing } from "../../handlers/messageChunkCrypto";
 import type { SparsePqHealingState } from "../../handlers/pqHealingRuntime";
 
 export interface IRTCPeerConnection extends RTCPeerConnection {
@@ -12,6 +14,12 @@ export interface IRTCPeerConnection extends RTCPeerConnection {
   makingOffer: boolean;
   ignoreOffer: boolean;
   receiveMessageModule: LibCrypto;
+  /** Fixed receive slots in `receiveMessageModule`'s heap; frames are opened
+   *  in place there. Absent edges fall back to per-frame buffers. */
+  ingressRing?: IngressRing;
+  /** Per inbound transfer root (hex), the Merkle proof cache its chunks are
+   *  verified against in `receiveMessageModule` (receiveProofCache.ts). */
+  proofCaches?: Map<string, MerkleProofCache>;
   iceCandidates: RTCIceCandidateInit[];
   /** Persistent control channel for this room/peer transport. */
   mainChannel?: IRTCDataChannel;
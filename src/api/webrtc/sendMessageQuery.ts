@@ -3,9 +3,12 @@ import {
   MessageDeliveryError,
 } from "../../handlers/handleSendMessage";
 
+import { sharedModule } from "../../cryptography/sharedModule";
+import { attachSlab } from "../../cryptography/slab";
 import { wasmLoader } from "../../cryptography/wasmLoader";
 import cryptoMemory from "../../cryptography/memory";
 import { CHUNK_LEN } from "../../utils/constants";
+import { retireCryptoStats } from "../../utils/debug";
 import { planMessageChunkCount } from "../../utils/splitToChunks";
 
 import type { BaseQueryFn } from "@reduxjs/toolkit/query";
@@ -22,9 +25,13 @@ export interface RTCChannelMessageParamsExtension extends RTCSendMessageParams {
 }
 
 /**
- * Every logical send owns independent fixed WASM memories. Large-file hashing,
- * per-message reconciliation, and reconnect waits therefore never hold a
- * process-wide crypto mutex or block sends in another room.
+ * Every logical send owns an independent fixed WASM memory for its AEAD, so
+ * per-message reconciliation and reconnect waits never hold a process-wide
+ * crypto mutex or block sends in another room. Staging (chunker and root) and
+ * the persistent Merkle tree run on the realm's shared module instead: each
+ * call is synchronous and each send keeps its own allocations there, and after
+ * setWasmThreads that module is the threaded artifact, so leaf hashing and
+ * tree levels fan out over its pool.
  */
 const webrtcMessageQuery: BaseQueryFn<
   RTCChannelMessageParamsExtension,
@@ -49,16 +56,17 @@ const webrtcMessageQuery: BaseQueryFn<
   const effectivePercentageFilledChunk = percentageFilledChunk ?? 0.9;
   const totalSize =
     typeof data === "string" ? new TextEncoder().encode(data).length : data.size;
-  const totalChunks = planMessageChunkCount(
+  // Rejects bad chunking options and oversize payloads before any module is
+  // loaded; splitToChunks plans the same count again.
+  planMessageChunkCount(
     totalSize,
     effectiveMinChunks,
     effectiveChunkSize,
     effectivePercentageFilledChunk,
   );
   const encryptionModule = await wasmLoader(cryptoMemory.protocolV3Memory());
-  const merkleModule = await wasmLoader(
-    cryptoMemory.getMerkleProofMemory(totalChunks),
-  );
+  attachSlab(encryptionModule);
+  const merkleModule = await sharedModule();
 
   // MessageDeliveryError must be RETURNED, not thrown. RTK Query serializes an
   // error that escapes a queryFn — the caller then receives a plain object, so
@@ -71,6 +79,10 @@ const webrtcMessageQuery: BaseQueryFn<
   } catch (error) {
     if (error instanceof MessageDeliveryError) return { error };
     throw error;
+  } finally {
+    // The encryption module is dropped once the send settles; the shared
+    // module lives on, and the send freed its tree and chunker there.
+    retireCryptoStats(encryptionModule);
   }
 
   async function sendOrThrow() {
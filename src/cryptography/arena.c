@@ -0,0 +1,75 @@
+#include "arena.h"
+
+size_t
+arena_bytes(const unsigned int CAPACITY)
+{
+  if (CAPACITY == 0 || CAPACITY > ARENA_MAX_CAPACITY
+      || CAPACITY % ARENA_ALIGN != 0)
+    return 0;
+
+  return sizeof(arena) + CAPACITY;
+}
+
+int
+arena_init(arena *a, const unsigned int CAPACITY)
+{
+  if (!a || arena_bytes(CAPACITY) == 0) return -1;
+
+  a->capacity = CAPACITY;
+  a->top = 0;
+  a->high_water = 0;
+  a->frames = 0;
+  sodium_memzero(a->data, CAPACITY);
+
+  return 0;
+}
+
+unsigned int
+arena_push(arena *a)
+{
+  if (!a) return 0;
+  a->frames++;
+
+  return a->top;
+}
+
+uint8_t *
+arena_alloc(arena *a, const unsigned int LEN)
+{
+  size_t pad;
+  size_t end;
+
+  if (!a || a->frames == 0 || LEN == 0) return NULL;
+
+  /* Align the address rather than the offset: the block itself is only as
+   * aligned as the heap allocator made it. */
+  pad = (ARENA_ALIGN - ((uintptr_t)(a->data + a->top) & (ARENA_ALIGN - 1)))
+        & (ARENA_ALIGN - 1);
+  end = (size_t)a->top + pad + LEN;
+  if (end > a->capacity) return NULL;
+
+  a->top = (uint32_t)end;
+  if (a->top > a->high_water) a->high_water = a->top;
+
+  return a->data + end - LEN;
+}
+
+int
+arena_pop(arena *a, const unsigned int MARK)
+{
+  if (!a) return -1;
+  if (a->frames == 0 || MARK > a->top)
+  {
+    sodium_memzero(a->data, a->high_water);
+    a->top = 0;
+    a->frames = 0;
+
+    return -1;
+  }
+
+  sodium_memzero(a->data + MARK, a->top - MARK);
+  a->top = MARK;
+  a->frames--;
+
+  return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef arena_H
+#define arena_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sodium.h>
+
+/* Scratch arena (see arena.c), the C side of scratch.ts. A bump allocator
+ * over one block of arena_bytes(CAPACITY), used in LIFO frames: a frame
+ * records the top with arena_push, operations take aligned scratch with
+ * arena_alloc, and arena_pop wipes everything above the mark and rewinds to
+ * it. Nothing is freed individually and the block never grows, so frames
+ * cost two calls and never fragment or resize the heap. */
+#define ARENA_ALIGN 16U
+#define ARENA_MAX_CAPACITY (64U * 1024U * 1024U)
+
+typedef struct
+{
+  uint32_t capacity;
+  uint32_t top;
+  uint32_t high_water;
+  uint32_t frames;
+  uint8_t data[];
+} arena;
+_Static_assert(sizeof(arena) == 16, "arena header must stay 16 bytes");
+
+size_t arena_bytes(const unsigned int CAPACITY);
+
+/* CAPACITY is a multiple of ARENA_ALIGN up to ARENA_MAX_CAPACITY. The data
+ * is zeroed. */
+int arena_init(arena *a, const unsigned int CAPACITY);
+
+/* Opens a frame and returns its mark, the current top. */
+unsigned int arena_push(arena *a);
+
+/* LEN bytes aligned to ARENA_ALIGN, valid until the enclosing frame pops, or
+ * NULL when outside a frame or the arena is full; the caller then falls back
+ * to the heap. The bytes are zero. */
+uint8_t *arena_alloc(arena *a, const unsigned int LEN);
+
+/* Wipes [MARK, top) and rewinds the top to MARK. -1 if MARK is not the top
+ * of an open frame, in which case the whole arena is wiped and reset. */
+int arena_pop(arena *a, const unsigned int MARK);
+
+#endif
@@ -12,3 +12,456 @@ argon2(const unsigned int MNEMONIC_LEN,
                                 crypto_pwhash_argon2id_MEMLIMIT_INTERACTIVE,
                                 crypto_pwhash_argon2id_ALG_ARGON2ID13);
 }
+
+/* ---------------- Argon2id (RFC 9106) ----------------
+ * Memory is LANES rows of `lane_len` blocks, each row four segments long.
+ * The first pass fills the first two slices with data-independent
+ * addressing (Argon2i) and everything after with data-dependent addressing
+ * (Argon2d). A segment only references blocks of finished slices of other
+ * lanes, so the LANES segments of one slice can be filled in any order or
+ * at the same time: the threaded build runs them as one pool run (pool.c)
+ * that ends before the next slice, the single-threaded build in turn. */
+
+#define ARGON2ID_QWORDS (ARGON2ID_BLOCK_BYTES / 8U)
+#define ARGON2ID_SYNC_POINTS 4U
+#define ARGON2ID_VERSION 0x13U
+#define ARGON2ID_TYPE 2U
+#define ARGON2ID_PREHASH_LEN 64U
+#define ARGON2ID_ALIGN 64U
+
+typedef struct
+{
+  uint64_t v[ARGON2ID_QWORDS];
+} argon2id_block;
+
+typedef struct
+{
+  argon2id_block *blocks;
+  uint32_t passes;
+  uint32_t lanes;
+  uint32_t lane_len;
+  uint32_t segment_len;
+  uint32_t block_count;
+} argon2id_instance;
+
+typedef struct
+{
+  const argon2id_instance *instance;
+  uint32_t pass;
+  uint32_t slice;
+  uint32_t lane;
+} argon2id_position;
+
+static inline void
+argon2id_store32_le(uint8_t dst[4], const uint32_t w)
+{
+  dst[0] = (uint8_t)w;
+  dst[1] = (uint8_t)(w >> 8);
+  dst[2] = (uint8_t)(w >> 16);
+  dst[3] = (uint8_t)(w >> 24);
+}
+
+static inline uint64_t
+argon2id_load64_le(const uint8_t src[8])
+{
+  uint64_t w = 0;
+  size_t i;
+
+  for (i = 8; i-- > 0;) w = (w << 8) | src[i];
+
+  return w;
+}
+
+static inline void
+argon2id_store64_le(uint8_t dst[8], const uint64_t w)
+{
+  size_t i;
+
+  for (i = 0; i < 8; i++) dst[i] = (uint8_t)(w >> (8 * i));
+}
+
+static inline uint64_t
+argon2id_rotr64(const uint64_t w, const unsigned int c)
+{
+  return (w >> c) | (w << (64 - c));
+}
+
+/* BLAKE2b's G with the multiplication-hardened additions of BlaMka. */
+static inline uint64_t
+argon2id_blamka(const uint64_t x, const uint64_t y)
+{
+  return x + y + 2 * (uint64_t)(uint32_t)x * (uint64_t)(uint32_t)y;
+}
+
+#define ARGON2ID_G(a, b, c, d)                                                 \
+  do                                                                           \
+  {                                                                            \
+    a = argon2id_blamka(a, b);                                                 \
+    d = argon2id_rotr64(d ^ a, 32);                                            \
+    c = argon2id_blamka(c, d);                                                 \
+    b = argon2id_rotr64(b ^ c, 24);                                            \
+    a = argon2id_blamka(a, b);                                                 \
+    d = argon2id_rotr64(d ^ a, 16);                                            \
+    c = argon2id_blamka(c, d);                                                 \
+    b = argon2id_rotr64(b ^ c, 63);                                            \
+  } while (0)
+
+#define ARGON2ID_ROUND(v0, v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12,  \
+                       v13, v14, v15)                                          \
+  do                                                                           \
+  {                                                                            \
+    ARGON2ID_G(v0, v4, v8, v12);                                               \
+    ARGON2ID_G(v1, v5, v9, v13);                                               \
+    ARGON2ID_G(v2, v6, v10, v14);                                              \
+    ARGON2ID_G(v3, v7, v11, v15);                                              \
+    ARGON2ID_G(v0, v5, v10, v15);                                              \
+    ARGON2ID_G(v1, v6, v11, v12);                                              \
+    ARGON2ID_G(v2, v7, v8, v13);                                               \
+    ARGON2ID_G(v3, v4, v9, v14);                                               \
+  } while (0)
+
+/* next = P(prev ^ ref) ^ prev ^ ref, XORed into next's old contents from the
+ * second pass on (v1.3). P runs the BLAKE2b round over the eight rows of
+ * sixteen words, then over the eight columns of word pairs. */
+static void
+argon2id_compress(argon2id_block *next, const argon2id_block *prev,
+                  const argon2id_block *ref, const int with_xor)
+{
+  argon2id_block r, q;
+  uint64_t *v = q.v;
+  unsigned int i, k;
+
+  for (k = 0; k < ARGON2ID_QWORDS; k++) r.v[k] = prev->v[k] ^ ref->v[k];
+  q = r;
+
+  for (i = 0; i < 128; i += 16)
+    ARGON2ID_ROUND(v[i], v[i + 1], v[i + 2], v[i + 3], v[i + 4], v[i + 5],
+                   v[i + 6], v[i + 7], v[i + 8], v[i + 9], v[i + 10],
+                   v[i + 11], v[i + 12], v[i + 13], v[i + 14], v[i + 15]);
+  for (i = 0; i < 16; i += 2)
+    ARGON2ID_ROUND(v[i], v[i + 1], v[i + 16], v[i + 17], v[i + 32],
+                   v[i + 33], v[i + 48], v[i + 49], v[i + 64], v[i + 65],
+                   v[i + 80], v[i + 81], v[i + 96], v[i + 97], v[i + 112],
+                   v[i + 113]);
+
+  if (with_xor)
+    for (k = 0; k < ARGON2ID_QWORDS; k++) next->v[k] ^= q.v[k] ^ r.v[k];
+  else
+    for (k = 0; k < ARGON2ID_QWORDS; k++) next->v[k] = q.v[k] ^ r.v[k];
+
+  sodium_memzero(&r, sizeof r);
+  sodium_memzero(&q, sizeof q);
+}
+
+/* H'(in) = BLAKE2b(LE32(OUT_LEN) || in) up to 64 bytes, otherwise a chain of
+ * 64-byte BLAKE2b outputs that contribute their first 32 bytes each. */
+static int
+argon2id_hash_long(uint8_t *out, const size_t OUT_LEN, const uint8_t *in,
+                   const size_t IN_LEN)
+{
+  crypto_generichash_blake2b_state state;
+  uint8_t len[4];
+  uint8_t v[crypto_generichash_blake2b_BYTES_MAX];
+  uint8_t w[crypto_generichash_blake2b_BYTES_MAX];
+  size_t done;
+  int res = -1;
+
+  argon2id_store32_le(len, (uint32_t)OUT_LEN);
+  if (crypto_generichash_blake2b_init(&state, NULL, 0,
+                                      OUT_LEN < sizeof v ? OUT_LEN : sizeof v)
+          != 0
+      || crypto_generichash_blake2b_update(&state, len, sizeof len) != 0
+      || crypto_generichash_blake2b_update(&state, in, IN_LEN) != 0)
+    goto out;
+
+  if (OUT_LEN <= sizeof v)
+  {
+    res = crypto_generichash_blake2b_final(&state, out, OUT_LEN);
+    goto out;
+  }
+
+  if (crypto_generichash_blake2b_final(&state, v, sizeof v) != 0) goto out;
+  memcpy(out, v, sizeof v / 2);
+  for (done = sizeof v / 2; OUT_LEN - done > sizeof v; done += sizeof v / 2)
+  {
+    memcpy(w, v, sizeof v);
+    if (crypto_generichash_blake2b(v, sizeof v, w, sizeof w, NULL, 0) != 0)
+      goto out;
+    memcpy(out + done, v, sizeof v / 2);
+  }
+  memcpy(w, v, sizeof v);
+  res = crypto_generichash_blake2b(out + done, OUT_LEN - done, w, sizeof w,
+                                   NULL, 0);
+
+out:
+  sodium_memzero(&state, sizeof state);
+  sodium_memzero(v, sizeof v);
+  sodium_memzero(w, sizeof w);
+
+  return res;
+}
+
+static void
+argon2id_block_from_bytes(argon2id_block *block,
+                          const uint8_t bytes[ARGON2ID_BLOCK_BYTES])
+{
+  unsigned int k;
+
+  for (k = 0; k < ARGON2ID_QWORDS; k++)
+    block->v[k] = argon2id_load64_le(bytes + 8 * k);
+}
+
+/* Argon2i address block for the next 128 references of a segment. */
+static void
+argon2id_next_addresses(argon2id_block *addresses, argon2id_block *input)
+{
+  static const argon2id_block zero;
+
+  input->v[6]++;
+  argon2id_compress(addresses, &zero, input, 0);
+  argon2id_compress(addresses, &zero, addresses, 0);
+}
+
+/* RFC 9106 section 3.4.1.2: the index of the block referenced by block
+ * `index` of the segment, given J1 and whether it is in the same lane. */
+static uint32_t
+argon2id_reference_index(const argon2id_position *pos, const uint32_t index,
+                         const uint32_t j1, const int same_lane)
+{
+  const argon2id_instance *instance = pos->instance;
+  uint32_t area, start = 0;
+  uint64_t relative;
+
+  if (pos->pass == 0)
+  {
+    if (pos->slice == 0)
+      area = index - 1;
+    else if (same_lane)
+      area = pos->slice * instance->segment_len + index - 1;
+    else
+      area = pos->slice * instance->segment_len - (index == 0 ? 1 : 0);
+  }
+  else
+  {
+    if (same_lane)
+      area = instance->lane_len - instance->segment_len + index - 1;
+    else
+      area = instance->lane_len - instance->segment_len
+             - (index == 0 ? 1 : 0);
+    if (pos->slice != ARGON2ID_SYNC_POINTS - 1)
+      start = (pos->slice + 1) * instance->segment_len;
+  }
+
+  relative = ((uint64_t)j1 * j1) >> 32;
+  relative = area - 1 - (((uint64_t)area * relative) >> 32);
+
+  return (uint32_t)((start + relative) % instance->lane_len);
+}
+
+static void
+argon2id_fill_segment(const argon2id_position *pos)
+{
+  const argon2id_instance *instance = pos->instance;
+  const int data_independent = pos->pass == 0 && pos->slice < 2;
+  argon2id_block addresses, input;
+  argon2id_block *lane
+      = instance->blocks + (size_t)pos->lane * instance->lane_len;
+  uint32_t index = 0, offset, prev, ref_lane, ref_index;
+  uint64_t pseudo_rand;
+
+  if (data_independent)
+  {
+    memset(&input, 0, sizeof input);
+    input.v[0] = pos->pass;
+    input.v[1] = pos->lane;
+    input.v[2] = pos->slice;
+    input.v[3] = instance->block_count;
+    input.v[4] = instance->passes;
+    input.v[5] = ARGON2ID_TYPE;
+  }
+
+  /* The first two blocks of every lane come from H0. */
+  if (pos->pass == 0 && pos->slice == 0)
+  {
+    index = 2;
+    if (data_independent) argon2id_next_addresses(&addresses, &input);
+  }
+
+  offset = pos->slice * instance->segment_len + index;
+  prev = offset == 0 ? instance->lane_len - 1 : offset - 1;
+  for (; index < instance->segment_len; index++, offset++, prev = offset - 1)
+  {
+    if (data_independent)
+    {
+      if (index % ARGON2ID_QWORDS == 0)
+        argon2id_next_addresses(&addresses, &input);
+      pseudo_rand = addresses.v[index % ARGON2ID_QWORDS];
+    }
+    else
+    {
+      pseudo_rand = lane[prev].v[0];
+    }
+
+    ref_lane = (uint32_t)((pseudo_rand >> 32) % instance->lanes);
+    if (pos->pass == 0 && pos->slice == 0) ref_lane = pos->lane;
+    ref_index = argon2id_reference_index(pos, index, (uint32_t)pseudo_rand,
+                                         ref_lane == pos->lane);
+
+    argon2id_compress(
+        &lane[offset], &lane[prev],
+        &instance->blocks[(size_t)ref_lane * instance->lane_len + ref_index],
+        pos->pass != 0);
+  }
+
+  sodium_memzero(&addresses, sizeof addresses);
+  sodium_memzero(&input, sizeof input);
+}
+
+static int
+argon2id_fill_lane(void *ctx, const uint32_t lane)
+{
+  argon2id_fill_segment(&((const argon2id_position *)ctx)[lane]);
+
+  return 0;
+}
+
+/* One slice of every lane, as one pool run (pool.c): the lanes share the
+ * pool's threads, and whatever the workers do not take runs on the calling
+ * thread, so the result never depends on how many threads were available. */
+static void
+argon2id_fill_slice(const argon2id_instance *instance, const uint32_t pass,
+                    const uint32_t slice)
+{
+  argon2id_position pos[ARGON2ID_MAX_LANES];
+  uint32_t l;
+
+  for (l = 0; l < instance->lanes; l++)
+  {
+    pos[l].instance = instance;
+    pos[l].pass = pass;
+    pos[l].slice = slice;
+    pos[l].lane = l;
+  }
+
+  pool_run(argon2id_fill_lane, pos, instance->lanes);
+}
+
+size_t
+argon2id_memory_bytes(const unsigned int M_KIB, const unsigned int LANES)
+{
+  size_t blocks;
+
+  if (LANES == 0 || LANES > ARGON2ID_MAX_LANES
+      || M_KIB < 2 * ARGON2ID_SYNC_POINTS * LANES)
+    return 0;
+  blocks = M_KIB / (ARGON2ID_SYNC_POINTS * LANES) * ARGON2ID_SYNC_POINTS
+           * LANES;
+  if (blocks > (SIZE_MAX - ARGON2ID_ALIGN) / ARGON2ID_BLOCK_BYTES) return 0;
+
+  return blocks * ARGON2ID_BLOCK_BYTES + ARGON2ID_ALIGN - 1;
+}
+
+int
+argon2id_hash(uint8_t *out, const unsigned int OUT_LEN,
+              const uint8_t *password, const unsigned int PASSWORD_LEN,
+              const uint8_t *salt, const unsigned int SALT_LEN,
+              const uint8_t *secret, const unsigned int SECRET_LEN,
+              const uint8_t *ad, const unsigned int AD_LEN,
+              const unsigned int T_COST, const unsigned int M_KIB,
+              const unsigned int LANES, uint8_t *memory)
+{
+  const size_t memory_bytes = argon2id_memory_bytes(M_KIB, LANES);
+  crypto_generichash_blake2b_state state;
+  uint8_t prehash[ARGON2ID_PREHASH_LEN + 8];
+  uint8_t word[4];
+  uint8_t bytes[ARGON2ID_BLOCK_BYTES];
+  argon2id_instance instance;
+  argon2id_block final;
+  uint32_t header[6], l, k, pass, slice;
+  const uint8_t *fields[4] = { password, salt, secret, ad };
+  const uint32_t field_lens[4]
+      = { PASSWORD_LEN, SALT_LEN, SECRET_LEN, AD_LEN };
+  int res = -1;
+
+  if (!out || OUT_LEN < ARGON2ID_MIN_OUT_LEN || OUT_LEN > ARGON2ID_MAX_OUT_LEN)
+    return -1;
+  sodium_memzero(out, OUT_LEN);
+  if (memory_bytes == 0 || !memory || T_COST == 0 || !salt
+      || SALT_LEN < ARGON2ID_MIN_SALT_LEN || (PASSWORD_LEN && !password)
+      || (SECRET_LEN && !secret) || (AD_LEN && !ad))
+    return -1;
+
+  instance.blocks = (argon2id_block *)(((uintptr_t)memory + ARGON2ID_ALIGN - 1)
+                                       & ~(uintptr_t)(ARGON2ID_ALIGN - 1));
+  instance.passes = T_COST;
+  instance.lanes = LANES;
+  instance.block_count = (uint32_t)((memory_bytes - (ARGON2ID_ALIGN - 1))
+                                    / ARGON2ID_BLOCK_BYTES);
+  instance.lane_len = instance.block_count / LANES;
+  instance.segment_len = instance.lane_len / ARGON2ID_SYNC_POINTS;
+
+  /* H0 = H(p, T, m, t, v, y, then each of P, S, K, X length-prefixed). */
+  header[0] = LANES;
+  header[1] = OUT_LEN;
+  header[2] = M_KIB;
+  header[3] = T_COST;
+  header[4] = ARGON2ID_VERSION;
+  header[5] = ARGON2ID_TYPE;
+  if (crypto_generichash_blake2b_init(&state, NULL, 0, ARGON2ID_PREHASH_LEN)
+      != 0)
+    goto out;
+  for (k = 0; k < 6; k++)
+  {
+    argon2id_store32_le(word, header[k]);
+    crypto_generichash_blake2b_update(&state, word, sizeof word);
+  }
+  for (k = 0; k < 4; k++)
+  {
+    argon2id_store32_le(word, field_lens[k]);
+    crypto_generichash_blake2b_update(&state, word, sizeof word);
+    if (field_lens[k])
+      crypto_generichash_blake2b_update(&state, fields[k], field_lens[k]);
+  }
+  if (crypto_generichash_blake2b_final(&state, prehash, ARGON2ID_PREHASH_LEN)
+      != 0)
+    goto out;
+
+  /* B[l][0..1] = H'(H0 || LE32(0..1) || LE32(l)). */
+  for (l = 0; l < LANES; l++)
+    for (k = 0; k < 2; k++)
+    {
+      argon2id_store32_le(prehash + ARGON2ID_PREHASH_LEN, k);
+      argon2id_store32_le(prehash + ARGON2ID_PREHASH_LEN + 4, l);
+      if (argon2id_hash_long(bytes, sizeof bytes, prehash, sizeof prehash)
+          != 0)
+        goto out;
+      argon2id_block_from_bytes(
+          &instance.blocks[(size_t)l * instance.lane_len + k], bytes);
+    }
+
+  for (pass = 0; pass < T_COST; pass++)
+    for (slice = 0; slice < ARGON2ID_SYNC_POINTS; slice++)
+      argon2id_fill_slice(&instance, pass, slice);
+
+  /* Tag = H'(XOR of the last block of every lane). */
+  final = instance.blocks[instance.lane_len - 1];
+  for (l = 1; l < LANES; l++)
+    for (k = 0; k < ARGON2ID_QWORDS; k++)
+      final.v[k]
+          ^= instance.blocks[(size_t)l * instance.lane_len
+                             + instance.lane_len - 1]
+                 .v[k];
+  for (k = 0; k < ARGON2ID_QWORDS; k++)
+    argon2id_store64_le(bytes + 8 * k, final.v[k]);
+  res = argon2id_hash_long(out, OUT_LEN, bytes, sizeof bytes);
+
+out:
+  sodium_memzero(memory, memory_bytes);
+  sodium_memzero(&state, sizeof state);
+  sodium_memzero(prehash, sizeof prehash);
+  sodium_memzero(bytes, sizeof bytes);
+  sodium_memzero(&final, sizeof final);
+  if (res != 0) sodium_memzero(out, OUT_LEN);
+
+  return res;
+}
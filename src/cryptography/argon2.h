@@ -1,11 +1,47 @@
 #ifndef p2party_argon2_H
 #define p2party_argon2_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
 #include <sodium.h>
 
+#include "pool.h"
+
 int argon2(const unsigned int MNEMONIC_LEN,
            uint8_t seed[crypto_sign_ed25519_SEEDBYTES],
            const char mnemonic[MNEMONIC_LEN],
            const uint8_t salt[crypto_pwhash_argon2id_SALTBYTES]);
 
+/* Argon2id v1.3 (RFC 9106) with caller-chosen (t, m, p), see argon2.c. The
+ * p lanes of each slice are independent, so the threaded build fills them in
+ * parallel on the pool (pool.h); the single-threaded build fills them in turn
+ * and its output is identical. With p = 1 and no secret or associated data
+ * the tag equals libsodium's crypto_pwhash_argon2id for the same t and m. */
+#define ARGON2ID_BLOCK_BYTES 1024U
+#define ARGON2ID_MAX_LANES 16U
+#define ARGON2ID_MIN_SALT_LEN 8U
+#define ARGON2ID_MIN_OUT_LEN 4U
+#define ARGON2ID_MAX_OUT_LEN 1024U
+
+/* Bytes of `memory` argon2id_hash needs for M_KIB KiB over LANES lanes: M_KIB
+ * rounded down to a multiple of 4 * LANES blocks, plus alignment slack. 0 if
+ * the parameters are out of range. */
+size_t argon2id_memory_bytes(const unsigned int M_KIB,
+                             const unsigned int LANES);
+
+/* out = Argon2id(password, salt, secret, ad; T_COST passes over M_KIB KiB in
+ * LANES lanes). `memory` holds argon2id_memory_bytes(M_KIB, LANES) bytes from
+ * the caller and is wiped before returning; secret and ad may be NULL when
+ * their lengths are 0. Returns 0 or -1 on bad parameters, in which case
+ * `out` is zeroed. */
+int argon2id_hash(uint8_t *out, const unsigned int OUT_LEN,
+                  const uint8_t *password, const unsigned int PASSWORD_LEN,
+                  const uint8_t *salt, const unsigned int SALT_LEN,
+                  const uint8_t *secret, const unsigned int SECRET_LEN,
+                  const uint8_t *ad, const unsigned int AD_LEN,
+                  const unsigned int T_COST, const unsigned int M_KIB,
+                  const unsigned int LANES, uint8_t *memory);
+
 #endif
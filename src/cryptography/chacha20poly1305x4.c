@@ -0,0 +1,586 @@
+#include "chacha20poly1305x4.h"
+
+#define POLY1305_BLOCK 16U
+
+#if CHACHA20POLY1305X4_SIMD
+
+/* ChaCha20 (RFC 8439) four blocks at a time: word i of the state holds that
+ * word for four consecutive block counters, so a v128 register carries one
+ * state word of every block and each quarter round is plain lane-wise
+ * arithmetic. Same vector-extension approach as sha512x4.c. */
+typedef uint32_t chacha20x4_word __attribute__((vector_size(16)));
+
+/* Poly1305 limbs for four interleaved accumulators: 26-bit limbs widened to
+ * 64 bits so the limb products need no per-lane carries. */
+typedef uint64_t poly1305x4_word __attribute__((vector_size(32)));
+
+#define CHACHA20X4_BLOCKS 4U
+#define CHACHA20X4_BYTES (CHACHA20X4_BLOCKS * 64U)
+#define POLY1305_MASK 0x3ffffffU
+
+static inline uint32_t
+chacha20poly1305x4_load32_le(const uint8_t src[4])
+{
+  return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16)
+         | ((uint32_t)src[3] << 24);
+}
+
+static inline void
+chacha20poly1305x4_store32_le(uint8_t dst[4], const uint32_t w)
+{
+  dst[0] = (uint8_t)w;
+  dst[1] = (uint8_t)(w >> 8);
+  dst[2] = (uint8_t)(w >> 16);
+  dst[3] = (uint8_t)(w >> 24);
+}
+
+#define ROTL32X4(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define QUARTERROUNDX4(a, b, c, d)                                            \
+  do                                                                          \
+  {                                                                           \
+    a += b;                                                                   \
+    d = ROTL32X4(d ^ a, 16);                                                  \
+    c += d;                                                                   \
+    b = ROTL32X4(b ^ c, 12);                                                  \
+    a += b;                                                                   \
+    d = ROTL32X4(d ^ a, 8);                                                   \
+    c += d;                                                                   \
+    b = ROTL32X4(b ^ c, 7);                                                   \
+  } while (0)
+
+/* Keystream blocks counter .. counter + 3 into out, block after block. */
+static void
+chacha20x4_blocks(uint8_t out[CHACHA20X4_BYTES], const uint32_t key[8],
+                  const uint32_t counter, const uint32_t nonce[3])
+{
+  chacha20x4_word in[16], x[16];
+  size_t i, l;
+
+  in[0] = (chacha20x4_word){ 0x61707865, 0x61707865, 0x61707865, 0x61707865 };
+  in[1] = (chacha20x4_word){ 0x3320646e, 0x3320646e, 0x3320646e, 0x3320646e };
+  in[2] = (chacha20x4_word){ 0x79622d32, 0x79622d32, 0x79622d32, 0x79622d32 };
+  in[3] = (chacha20x4_word){ 0x6b206574, 0x6b206574, 0x6b206574, 0x6b206574 };
+  for (i = 0; i < 8; i++)
+    in[4 + i] = (chacha20x4_word){ key[i], key[i], key[i], key[i] };
+  in[12] = (chacha20x4_word){ counter, counter + 1, counter + 2, counter + 3 };
+  for (i = 0; i < 3; i++)
+    in[13 + i] = (chacha20x4_word){ nonce[i], nonce[i], nonce[i], nonce[i] };
+
+  for (i = 0; i < 16; i++) x[i] = in[i];
+
+  for (i = 0; i < 10; i++)
+  {
+    QUARTERROUNDX4(x[0], x[4], x[8], x[12]);
+    QUARTERROUNDX4(x[1], x[5], x[9], x[13]);
+    QUARTERROUNDX4(x[2], x[6], x[10], x[14]);
+    QUARTERROUNDX4(x[3], x[7], x[11], x[15]);
+    QUARTERROUNDX4(x[0], x[5], x[10], x[15]);
+    QUARTERROUNDX4(x[1], x[6], x[11], x[12]);
+    QUARTERROUNDX4(x[2], x[7], x[8], x[13]);
+    QUARTERROUNDX4(x[3], x[4], x[9], x[14]);
+  }
+
+  for (i = 0; i < 16; i++) x[i] += in[i];
+
+  for (l = 0; l < CHACHA20X4_BLOCKS; l++)
+  {
+    for (i = 0; i < 16; i++)
+      chacha20poly1305x4_store32_le(&out[64 * l + 4 * i], x[i][l]);
+  }
+
+  sodium_memzero(x, sizeof x);
+  sodium_memzero(in, sizeof in);
+}
+
+/* out = in ^ keystream from block `counter` on; out may equal in. */
+static void
+chacha20x4_xor(uint8_t *out, const uint8_t *in, size_t len,
+               const uint32_t key[8], uint32_t counter,
+               const uint32_t nonce[3])
+{
+  uint8_t ks[CHACHA20X4_BYTES];
+  size_t i, take;
+
+  while (len > 0)
+  {
+    chacha20x4_blocks(ks, key, counter, nonce);
+    take = len < CHACHA20X4_BYTES ? len : CHACHA20X4_BYTES;
+    for (i = 0; i < take; i++) out[i] = in[i] ^ ks[i];
+
+    out += take;
+    in += take;
+    len -= take;
+    counter += CHACHA20X4_BLOCKS;
+  }
+
+  sodium_memzero(ks, sizeof ks);
+}
+
+static void
+poly1305_load_block(uint32_t limbs[5], const uint8_t m[POLY1305_BLOCK])
+{
+  const uint32_t t0 = chacha20poly1305x4_load32_le(&m[0]);
+  const uint32_t t1 = chacha20poly1305x4_load32_le(&m[4]);
+  const uint32_t t2 = chacha20poly1305x4_load32_le(&m[8]);
+  const uint32_t t3 = chacha20poly1305x4_load32_le(&m[12]);
+
+  limbs[0] = t0 & POLY1305_MASK;
+  limbs[1] = ((t0 >> 26) | (t1 << 6)) & POLY1305_MASK;
+  limbs[2] = ((t1 >> 20) | (t2 << 12)) & POLY1305_MASK;
+  limbs[3] = ((t2 >> 14) | (t3 << 18)) & POLY1305_MASK;
+  limbs[4] = (t3 >> 8) | (1U << 24);
+}
+
+/* out = a * r mod 2^130 - 5, partially reduced (limbs just over 26 bits). */
+static void
+poly1305_mul(uint32_t out[5], const uint32_t a[5], const uint32_t r[5])
+{
+  const uint64_t s1 = (uint64_t)r[1] * 5, s2 = (uint64_t)r[2] * 5,
+                 s3 = (uint64_t)r[3] * 5, s4 = (uint64_t)r[4] * 5;
+  uint64_t d0, d1, d2, d3, d4;
+  uint32_t c;
+
+  d0 = (uint64_t)a[0] * r[0] + a[1] * s4 + a[2] * s3 + a[3] * s2 + a[4] * s1;
+  d1 = (uint64_t)a[0] * r[1] + (uint64_t)a[1] * r[0] + a[2] * s4 + a[3] * s3
+       + a[4] * s2;
+  d2 = (uint64_t)a[0] * r[2] + (uint64_t)a[1] * r[1] + (uint64_t)a[2] * r[0]
+       + a[3] * s4 + a[4] * s3;
+  d3 = (uint64_t)a[0] * r[3] + (uint64_t)a[1] * r[2] + (uint64_t)a[2] * r[1]
+       + (uint64_t)a[3] * r[0] + a[4] * s4;
+  d4 = (uint64_t)a[0] * r[4] + (uint64_t)a[1] * r[3] + (uint64_t)a[2] * r[2]
+       + (uint64_t)a[3] * r[1] + (uint64_t)a[4] * r[0];
+
+  c = (uint32_t)(d0 >> 26);
+  out[0] = (uint32_t)d0 & POLY1305_MASK;
+  d1 += c;
+  c = (uint32_t)(d1 >> 26);
+  out[1] = (uint32_t)d1 & POLY1305_MASK;
+  d2 += c;
+  c = (uint32_t)(d2 >> 26);
+  out[2] = (uint32_t)d2 & POLY1305_MASK;
+  d3 += c;
+  c = (uint32_t)(d3 >> 26);
+  out[3] = (uint32_t)d3 & POLY1305_MASK;
+  d4 += c;
+  c = (uint32_t)(d4 >> 26);
+  out[4] = (uint32_t)d4 & POLY1305_MASK;
+  out[0] += c * 5;
+  c = out[0] >> 26;
+  out[0] &= POLY1305_MASK;
+  out[1] += c;
+}
+
+static void
+poly1305x4_init(poly1305x4_state *state, const uint8_t key[32])
+{
+  state->r[0] = chacha20poly1305x4_load32_le(&key[0]) & 0x3ffffff;
+  state->r[1] = (chacha20poly1305x4_load32_le(&key[3]) >> 2) & 0x3ffff03;
+  state->r[2] = (chacha20poly1305x4_load32_le(&key[6]) >> 4) & 0x3ffc0ff;
+  state->r[3] = (chacha20poly1305x4_load32_le(&key[9]) >> 6) & 0x3f03fff;
+  state->r[4] = (chacha20poly1305x4_load32_le(&key[12]) >> 8) & 0x00fffff;
+
+  poly1305_mul(state->r2, state->r, state->r);
+  poly1305_mul(state->r3, state->r2, state->r);
+  poly1305_mul(state->r4, state->r2, state->r2);
+
+  memset(state->h, 0, sizeof state->h);
+  for (size_t i = 0; i < 4; i++)
+    state->pad[i] = chacha20poly1305x4_load32_le(&key[16 + 4 * i]);
+}
+
+/* H = H * R lane-wise, where lane j multiplies by its own R[.][j]. */
+static void
+poly1305x4_mul(poly1305x4_word h[5], const poly1305x4_word r[5])
+{
+  const poly1305x4_word s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5,
+                        s4 = r[4] * 5;
+  poly1305x4_word d0, d1, d2, d3, d4, c;
+
+  d0 = h[0] * r[0] + h[1] * s4 + h[2] * s3 + h[3] * s2 + h[4] * s1;
+  d1 = h[0] * r[1] + h[1] * r[0] + h[2] * s4 + h[3] * s3 + h[4] * s2;
+  d2 = h[0] * r[2] + h[1] * r[1] + h[2] * r[0] + h[3] * s4 + h[4] * s3;
+  d3 = h[0] * r[3] + h[1] * r[2] + h[2] * r[1] + h[3] * r[0] + h[4] * s4;
+  d4 = h[0] * r[4] + h[1] * r[3] + h[2] * r[2] + h[3] * r[1] + h[4] * r[0];
+
+  c = d0 >> 26;
+  h[0] = d0 & POLY1305_MASK;
+  d1 += c;
+  c = d1 >> 26;
+  h[1] = d1 & POLY1305_MASK;
+  d2 += c;
+  c = d2 >> 26;
+  h[2] = d2 & POLY1305_MASK;
+  d3 += c;
+  c = d3 >> 26;
+  h[3] = d3 & POLY1305_MASK;
+  d4 += c;
+  c = d4 >> 26;
+  h[4] = d4 & POLY1305_MASK;
+  h[0] += c * 5;
+  c = h[0] >> 26;
+  h[0] &= POLY1305_MASK;
+  h[1] += c;
+}
+
+static void
+poly1305x4_add_blocks(poly1305x4_word h[5], const uint8_t m[4 * 16])
+{
+  uint32_t limbs[4][5];
+  size_t i;
+
+  for (i = 0; i < 4; i++) poly1305_load_block(limbs[i], &m[16 * i]);
+  for (i = 0; i < 5; i++)
+    h[i] += (poly1305x4_word){ limbs[0][i], limbs[1][i], limbs[2][i],
+                               limbs[3][i] };
+}
+
+/* Absorbs BLOCKS full 16-byte blocks. Runs of eight or more go through the
+ * four-lane path, where lane j accumulates blocks j, j + 4, ... under r^4 and
+ * the lanes are folded back with r^4, r^3, r^2 and r; what is left over takes
+ * the scalar Horner step. */
+static void
+poly1305x4_blocks(poly1305x4_state *state, const uint8_t *m, size_t blocks)
+{
+  uint32_t limbs[5];
+  size_t i;
+
+  if (blocks >= 8)
+  {
+    poly1305x4_word h[5], r4[5], fold[5];
+    const size_t groups = blocks / 4;
+
+    for (i = 0; i < 5; i++)
+    {
+      h[i] = (poly1305x4_word){ state->h[i], 0, 0, 0 };
+      r4[i] = (poly1305x4_word){ state->r4[i], state->r4[i], state->r4[i],
+                                 state->r4[i] };
+      fold[i] = (poly1305x4_word){ state->r4[i], state->r3[i], state->r2[i],
+                                   state->r[i] };
+    }
+
+    poly1305x4_add_blocks(h, m);
+    for (size_t g = 1; g < groups; g++)
+    {
+      poly1305x4_mul(h, r4);
+      poly1305x4_add_blocks(h, &m[64 * g]);
+    }
+    poly1305x4_mul(h, fold);
+
+    for (i = 0; i < 5; i++)
+      state->h[i] = (uint32_t)(h[i][0] + h[i][1] + h[i][2] + h[i][3]);
+    /* Lane sums are below 2^28; carry them back under 26 bits. */
+    poly1305_mul(state->h, state->h, (const uint32_t[5]){ 1, 0, 0, 0, 0 });
+
+    m += 64 * groups;
+    blocks -= 4 * groups;
+    sodium_memzero(h, sizeof h);
+  }
+
+  for (; blocks > 0; blocks--, m += POLY1305_BLOCK)
+  {
+    poly1305_load_block(limbs, m);
+    for (i = 0; i < 5; i++) state->h[i] += limbs[i];
+    poly1305_mul(state->h, state->h, state->r);
+  }
+}
+
+/* The AEAD MAC input pads each segment with zeros to a block boundary. */
+static void
+poly1305x4_update_padded(poly1305x4_state *state, const uint8_t *m,
+                         const size_t len)
+{
+  uint8_t block[POLY1305_BLOCK] = { 0 };
+  const size_t full = len / POLY1305_BLOCK;
+
+  poly1305x4_blocks(state, m, full);
+  if (len % POLY1305_BLOCK == 0) return;
+
+  memcpy(block, &m[full * POLY1305_BLOCK], len % POLY1305_BLOCK);
+  poly1305x4_blocks(state, block, 1);
+  sodium_memzero(block, sizeof block);
+}
+
+static void
+poly1305x4_final(poly1305x4_state *state,
+                 uint8_t mac[crypto_aead_chacha20poly1305_ietf_ABYTES])
+{
+  uint32_t h0 = state->h[0], h1 = state->h[1], h2 = state->h[2],
+           h3 = state->h[3], h4 = state->h[4];
+  uint32_t g0, g1, g2, g3, g4, c, mask;
+  uint64_t f;
+
+  c = h1 >> 26;
+  h1 &= POLY1305_MASK;
+  h2 += c;
+  c = h2 >> 26;
+  h2 &= POLY1305_MASK;
+  h3 += c;
+  c = h3 >> 26;
+  h3 &= POLY1305_MASK;
+  h4 += c;
+  c = h4 >> 26;
+  h4 &= POLY1305_MASK;
+  h0 += c * 5;
+  c = h0 >> 26;
+  h0 &= POLY1305_MASK;
+  h1 += c;
+
+  /* h - p, selected in constant time when h >= p. */
+  g0 = h0 + 5;
+  c = g0 >> 26;
+  g0 &= POLY1305_MASK;
+  g1 = h1 + c;
+  c = g1 >> 26;
+  g1 &= POLY1305_MASK;
+  g2 = h2 + c;
+  c = g2 >> 26;
+  g2 &= POLY1305_MASK;
+  g3 = h3 + c;
+  c = g3 >> 26;
+  g3 &= POLY1305_MASK;
+  g4 = h4 + c - (1U << 26);
+
+  mask = (g4 >> 31) - 1;
+  h0 = (h0 & ~mask) | (g0 & mask);
+  h1 = (h1 & ~mask) | (g1 & mask);
+  h2 = (h2 & ~mask) | (g2 & mask);
+  h3 = (h3 & ~mask) | (g3 & mask);
+  h4 = (h4 & ~mask) | (g4 & mask);
+
+  h0 = h0 | (h1 << 26);
+  h1 = (h1 >> 6) | (h2 << 20);
+  h2 = (h2 >> 12) | (h3 << 14);
+  h3 = (h3 >> 18) | (h4 << 8);
+
+  f = (uint64_t)h0 + state->pad[0];
+  chacha20poly1305x4_store32_le(&mac[0], (uint32_t)f);
+  f = (uint64_t)h1 + state->pad[1] + (f >> 32);
+  chacha20poly1305x4_store32_le(&mac[4], (uint32_t)f);
+  f = (uint64_t)h2 + state->pad[2] + (f >> 32);
+  chacha20poly1305x4_store32_le(&mac[8], (uint32_t)f);
+  f = (uint64_t)h3 + state->pad[3] + (f >> 32);
+  chacha20poly1305x4_store32_le(&mac[12], (uint32_t)f);
+
+  sodium_memzero(state, sizeof *state);
+}
+
+/* RFC 8439 section 2.8: the one-time Poly1305 key is keystream block 0, the
+ * payload is XORed from block 1, and the MAC covers
+ * ad || pad16 || c || pad16 || le64(adlen) || le64(clen). */
+static void
+chacha20poly1305x4_mac_init(poly1305x4_state *state, const uint8_t *ad,
+                            const unsigned long long adlen,
+                            const uint32_t key[8], const uint32_t nonce[3])
+{
+  uint8_t block0[CHACHA20X4_BYTES];
+
+  chacha20x4_blocks(block0, key, 0, nonce);
+  poly1305x4_init(state, block0);
+  sodium_memzero(block0, sizeof block0);
+
+  if (adlen > 0) poly1305x4_update_padded(state, ad, (size_t)adlen);
+}
+
+static void
+chacha20poly1305x4_mac_final(
+    poly1305x4_state *state,
+    uint8_t mac[crypto_aead_chacha20poly1305_ietf_ABYTES],
+    const unsigned long long clen, const unsigned long long adlen)
+{
+  uint8_t lens[POLY1305_BLOCK];
+
+  for (size_t i = 0; i < 8; i++)
+  {
+    lens[i] = (uint8_t)(adlen >> (8 * i));
+    lens[8 + i] = (uint8_t)(clen >> (8 * i));
+  }
+  poly1305x4_blocks(state, lens, 1);
+  poly1305x4_final(state, mac);
+}
+
+static void
+chacha20poly1305x4_mac(uint8_t mac[crypto_aead_chacha20poly1305_ietf_ABYTES],
+                       const uint8_t *c, const unsigned long long clen,
+                       const uint8_t *ad, const unsigned long long adlen,
+                       const uint32_t key[8], const uint32_t nonce[3])
+{
+  poly1305x4_state state;
+
+  chacha20poly1305x4_mac_init(&state, ad, adlen, key, nonce);
+  if (clen > 0) poly1305x4_update_padded(&state, c, (size_t)clen);
+  chacha20poly1305x4_mac_final(&state, mac, clen, adlen);
+}
+
+static void
+chacha20poly1305x4_load_key(uint32_t key[8], uint32_t nonce[3],
+                            const uint8_t *k, const uint8_t *npub)
+{
+  size_t i;
+
+  for (i = 0; i < 8; i++) key[i] = chacha20poly1305x4_load32_le(&k[4 * i]);
+  for (i = 0; i < 3; i++)
+    nonce[i] = chacha20poly1305x4_load32_le(&npub[4 * i]);
+}
+
+#endif
+
+int
+chacha20poly1305x4_ietf_encrypt(
+    uint8_t *c, unsigned long long *clen_p, const uint8_t *m,
+    const unsigned long long mlen, const uint8_t *ad,
+    const unsigned long long adlen, const uint8_t *nsec,
+    const uint8_t npub[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
+    const uint8_t k[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+#if CHACHA20POLY1305X4_SIMD
+  (void)nsec;
+  if (clen_p) *clen_p = 0;
+  if (mlen > crypto_aead_chacha20poly1305_ietf_MESSAGEBYTES_MAX) return -1;
+
+  uint32_t key[8], nonce[3];
+
+  chacha20poly1305x4_load_key(key, nonce, k, npub);
+  chacha20x4_xor(c, m, (size_t)mlen, key, 1, nonce);
+  chacha20poly1305x4_mac(&c[mlen], c, mlen, ad, adlen, key, nonce);
+  sodium_memzero(key, sizeof key);
+
+  if (clen_p) *clen_p = mlen + crypto_aead_chacha20poly1305_ietf_ABYTES;
+  return 0;
+#else
+  return crypto_aead_chacha20poly1305_ietf_encrypt(c, clen_p, m, mlen, ad,
+                                                   adlen, nsec, npub, k);
+#endif
+}
+
+int
+chacha20poly1305x4_ietf_decrypt(
+    uint8_t *m, unsigned long long *mlen_p, uint8_t *nsec, const uint8_t *c,
+    const unsigned long long clen, const uint8_t *ad,
+    const unsigned long long adlen,
+    const uint8_t npub[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
+    const uint8_t k[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+#if CHACHA20POLY1305X4_SIMD
+  (void)nsec;
+  if (mlen_p) *mlen_p = 0;
+  if (clen < crypto_aead_chacha20poly1305_ietf_ABYTES) return -1;
+
+  const unsigned long long mlen
+      = clen - crypto_aead_chacha20poly1305_ietf_ABYTES;
+  uint8_t mac[crypto_aead_chacha20poly1305_ietf_ABYTES];
+  uint32_t key[8], nonce[3];
+  int ret;
+
+  chacha20poly1305x4_load_key(key, nonce, k, npub);
+  chacha20poly1305x4_mac(mac, c, mlen, ad, adlen, key, nonce);
+  ret = crypto_verify_16(mac, &c[mlen]);
+  sodium_memzero(mac, sizeof mac);
+
+  /* Like libsodium: nothing is decrypted under a bad tag, and m is zeroed. */
+  if (ret != 0)
+  {
+    if (m) memset(m, 0, (size_t)mlen);
+    sodium_memzero(key, sizeof key);
+    return -1;
+  }
+
+  if (m) chacha20x4_xor(m, c, (size_t)mlen, key, 1, nonce);
+  sodium_memzero(key, sizeof key);
+
+  if (mlen_p) *mlen_p = mlen;
+  return 0;
+#else
+  return crypto_aead_chacha20poly1305_ietf_decrypt(m, mlen_p, nsec, c, clen, ad,
+                                                   adlen, npub, k);
+#endif
+}
+
+int
+chacha20poly1305x4_ietf_decrypt_init(
+    chacha20poly1305x4_ietf_stream *stream, const uint8_t *ad,
+    const unsigned long long adlen,
+    const uint8_t npub[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
+    const uint8_t k[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  if (!stream || !npub || !k || (adlen > 0 && !ad)) return -1;
+
+  stream->counter = 1;
+  stream->adlen = adlen;
+  stream->clen = 0;
+
+#if CHACHA20POLY1305X4_SIMD
+  chacha20poly1305x4_load_key(stream->key, stream->nonce, k, npub);
+  chacha20poly1305x4_mac_init(&stream->mac, ad, adlen, stream->key,
+                              stream->nonce);
+#else
+  static const uint8_t zeros[POLY1305_BLOCK] = { 0 };
+  uint8_t block0[crypto_onetimeauth_poly1305_KEYBYTES];
+
+  memcpy(stream->key, k, sizeof stream->key);
+  memcpy(stream->nonce, npub, sizeof stream->nonce);
+  crypto_stream_chacha20_ietf(block0, sizeof block0, npub, k);
+  crypto_onetimeauth_poly1305_init(&stream->mac, block0);
+  sodium_memzero(block0, sizeof block0);
+
+  crypto_onetimeauth_poly1305_update(&stream->mac, ad, adlen);
+  crypto_onetimeauth_poly1305_update(
+      &stream->mac, zeros, (POLY1305_BLOCK - adlen) % POLY1305_BLOCK);
+#endif
+
+  return 0;
+}
+
+void
+chacha20poly1305x4_ietf_decrypt_update(
+    chacha20poly1305x4_ietf_stream *stream, uint8_t *m, const uint8_t *c,
+    const size_t len)
+{
+  if (len == 0) return;
+
+#if CHACHA20POLY1305X4_SIMD
+  poly1305x4_update_padded(&stream->mac, c, len);
+  chacha20x4_xor(m, c, len, stream->key, stream->counter, stream->nonce);
+#else
+  crypto_onetimeauth_poly1305_update(&stream->mac, c, len);
+  crypto_stream_chacha20_ietf_xor_ic(m, c, len, stream->nonce, stream->counter,
+                                     stream->key);
+#endif
+
+  stream->counter += (uint32_t)(len / 64);
+  stream->clen += len;
+}
+
+int
+chacha20poly1305x4_ietf_decrypt_final(
+    chacha20poly1305x4_ietf_stream *stream,
+    const uint8_t mac[crypto_aead_chacha20poly1305_ietf_ABYTES])
+{
+  uint8_t computed[crypto_aead_chacha20poly1305_ietf_ABYTES];
+  int ret;
+
+#if CHACHA20POLY1305X4_SIMD
+  chacha20poly1305x4_mac_final(&stream->mac, computed, stream->clen,
+                               stream->adlen);
+#else
+  static const uint8_t zeros[POLY1305_BLOCK] = { 0 };
+  uint8_t lens[POLY1305_BLOCK];
+
+  crypto_onetimeauth_poly1305_update(
+      &stream->mac, zeros,
+      (POLY1305_BLOCK - stream->clen % POLY1305_BLOCK)
+          % POLY1305_BLOCK);
+  for (size_t i = 0; i < 8; i++)
+  {
+    lens[i] = (uint8_t)(stream->adlen >> (8 * i));
+    lens[8 + i] = (uint8_t)(stream->clen >> (8 * i));
+  }
+  crypto_onetimeauth_poly1305_update(&stream->mac, lens, sizeof lens);
+  crypto_onetimeauth_poly1305_final(&stream->mac, computed);
+#endif
+
+  ret = crypto_verify_16(computed, mac);
+  sodium_memzero(computed, sizeof computed);
+  sodium_memzero(stream, sizeof *stream);
+
+  return ret == 0 ? 0 : -1;
+}
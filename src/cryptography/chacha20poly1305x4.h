@@ -0,0 +1,87 @@
+#ifndef chacha20poly1305x4_H
+#define chacha20poly1305x4_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sodium.h>
+
+/* ChaCha20-Poly1305-IETF with a four-block ChaCha20 kernel and a four-way
+ * Poly1305 (see chacha20poly1305x4.c). Signatures, in-place behaviour and
+ * output are those of crypto_aead_chacha20poly1305_ietf_encrypt/_decrypt, so
+ * call sites only swap the name. Targets without SIMD (the scalar WASM
+ * artifact) forward to libsodium. */
+#if defined(__wasm_simd128__) || defined(__SSE2__) || defined(__ARM_NEON)
+#define CHACHA20POLY1305X4_SIMD 1
+#else
+#define CHACHA20POLY1305X4_SIMD 0
+#endif
+
+#if CHACHA20POLY1305X4_SIMD
+/* Poly1305 (poly1305-donna 26-bit limbs) with r, r^2, r^3 and r^4 kept so
+ * four blocks can be absorbed per step (see poly1305x4_blocks). */
+typedef struct
+{
+  uint32_t r[5];
+  uint32_t r2[5];
+  uint32_t r3[5];
+  uint32_t r4[5];
+  uint32_t h[5];
+  uint32_t pad[4];
+} poly1305x4_state;
+#endif
+
+/* Incremental ChaCha20-Poly1305-IETF decryption, for callers that consume the
+ * plaintext tile by tile while it is still in cache. Every update MACs its
+ * ciphertext span and then decrypts it (m may equal c); all but the last must
+ * be a multiple of 64 bytes. Nothing is authentic until _final returns 0: the
+ * caller owns the plaintext written so far and must wipe it otherwise. */
+typedef struct
+{
+#if CHACHA20POLY1305X4_SIMD
+  poly1305x4_state mac;
+  uint32_t key[8];
+  uint32_t nonce[3];
+#else
+  crypto_onetimeauth_poly1305_state mac;
+  uint8_t key[crypto_aead_chacha20poly1305_ietf_KEYBYTES];
+  uint8_t nonce[crypto_aead_chacha20poly1305_ietf_NPUBBYTES];
+#endif
+  uint32_t counter;
+  uint64_t adlen;
+  uint64_t clen;
+} chacha20poly1305x4_ietf_stream;
+
+int chacha20poly1305x4_ietf_encrypt(
+    uint8_t *c, unsigned long long *clen_p, const uint8_t *m,
+    const unsigned long long mlen, const uint8_t *ad,
+    const unsigned long long adlen, const uint8_t *nsec,
+    const uint8_t npub[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
+    const uint8_t k[crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
+
+int chacha20poly1305x4_ietf_decrypt(
+    uint8_t *m, unsigned long long *mlen_p, uint8_t *nsec, const uint8_t *c,
+    const unsigned long long clen, const uint8_t *ad,
+    const unsigned long long adlen,
+    const uint8_t npub[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
+    const uint8_t k[crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
+
+/* Derives the one-time Poly1305 key and absorbs the padded AD. */
+int chacha20poly1305x4_ietf_decrypt_init(
+    chacha20poly1305x4_ietf_stream *stream, const uint8_t *ad,
+    const unsigned long long adlen,
+    const uint8_t npub[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
+    const uint8_t k[crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
+
+void chacha20poly1305x4_ietf_decrypt_update(
+    chacha20poly1305x4_ietf_stream *stream, uint8_t *m, const uint8_t *c,
+    const size_t len);
+
+/* Compares the tag in constant time: 0 if it matches, -1 otherwise. The
+ * stream is wiped either way. */
+int chacha20poly1305x4_ietf_decrypt_final(
+    chacha20poly1305x4_ietf_stream *stream,
+    const uint8_t mac[crypto_aead_chacha20poly1305_ietf_ABYTES]);
+
+#endif
@@ -0,0 +1,61 @@
+#include "chunker.h"
+
+int
+chunker_init(chunker_state *chunker, const unsigned int CHUNK_BYTES)
+{
+  if (!chunker || CHUNK_BYTES == 0) return -1;
+
+  chunker->chunk_len = CHUNK_BYTES;
+
+  return crypto_hash_sha512_init(&chunker->file) == 0 ? 0 : -2;
+}
+
+int
+chunker_layout(chunker_state *chunker, const unsigned int COUNT,
+               uint8_t *cells, const uint32_t starts[COUNT],
+               const uint32_t lens[COUNT],
+               uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES])
+{
+  if (COUNT == 0) return 0;
+  if (!chunker || !cells || !starts || !lens || !leaves_hashed) return -1;
+  if (COUNT > CHUNKER_MAX_CELLS) return -1;
+
+  const size_t chunk_len = chunker->chunk_len;
+  size_t i;
+
+  // Validate every span before touching the hash, so a rejected call leaves
+  // the state usable.
+  for (i = 0; i < COUNT; i++)
+  {
+    if (starts[i] > chunk_len || lens[i] > chunk_len - starts[i]) return -1;
+  }
+
+  for (i = 0; i < COUNT; i++)
+  {
+    uint8_t *cell = &cells[i * chunk_len];
+    const size_t end = (size_t)starts[i] + lens[i];
+
+    if (crypto_hash_sha512_update(&chunker->file, &cell[starts[i]], lens[i])
+        != 0)
+      return -2;
+
+    randombytes_buf(cell, starts[i]);
+    randombytes_buf(&cell[end], chunk_len - end);
+  }
+
+  if (merkle_leaf_hash_batch(COUNT, chunk_len, cells, leaves_hashed) != 0)
+    return -2;
+
+  return 0;
+}
+
+int
+chunker_final(chunker_state *chunker, uint8_t hash[crypto_hash_sha512_BYTES])
+{
+  if (!chunker || !hash) return -1;
+
+  const int res = crypto_hash_sha512_final(&chunker->file, hash);
+  sodium_memzero(chunker, sizeof *chunker);
+
+  return res == 0 ? 0 : -2;
+}
@@ -0,0 +1,45 @@
+#ifndef chunker_H
+#define chunker_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sodium.h>
+
+#include "merkle.h"
+
+/* Send-side chunker (see chunker.c): one pass over the file produces the
+ * whole-file SHA-512, the padded cell bodies and their Merkle leaf hashes.
+ * Cells are laid out in groups of CHUNKER_LANES so the leaves take the
+ * four-lane SHA-512 kernel; a call takes up to one group per pool thread, so
+ * the threaded build hashes the groups in parallel. Byte-matched to
+ * chunker_STATEBYTES in interfaces.ts. */
+#define CHUNKER_LANES SHA512X4_LANES
+#define CHUNKER_MAX_CELLS (CHUNKER_LANES * POOL_MAX_THREADS)
+
+typedef struct
+{
+  crypto_hash_sha512_state file;
+  uint32_t chunk_len;
+} chunker_state;
+_Static_assert(sizeof(chunker_state) == 216,
+               "chunker_state layout must match interfaces.ts");
+
+int chunker_init(chunker_state *chunker, const unsigned int CHUNK_BYTES);
+
+/* cells holds COUNT cells of CHUNK_BYTES, at most CHUNKER_MAX_CELLS; the
+ * caller has already copied the next lens[i] file bytes to
+ * cells[i * CHUNK_BYTES + starts[i]]. Those bytes are absorbed into the file
+ * hash in cell order, everything around them is filled with random padding
+ * and the COUNT leaf hashes are written to leaves_hashed. */
+int chunker_layout(chunker_state *chunker, const unsigned int COUNT,
+                   uint8_t *cells, const uint32_t starts[COUNT],
+                   const uint32_t lens[COUNT],
+                   uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES]);
+
+/* Whole-file SHA-512; the state is wiped. */
+int chunker_final(chunker_state *chunker,
+                  uint8_t hash[crypto_hash_sha512_BYTES]);
+
+#endif
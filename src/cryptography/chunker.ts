@@ -0,0 +1,140 @@
+import { chunker_STATEBYTES, crypto_hash_sha512_BYTES } from "./interfaces";
+
+import type { LibCrypto } from "./libcrypto";
+
+// Matches CHUNKER_LANES in chunker.h: cells are leaf-hashed in groups of four
+// so the leaves take the four-lane SHA-512 kernel.
+export const CHUNKER_LANES = 4;
+
+/**
+ * Single-pass send-side chunker (see `chunker_*` in chunker.c). The caller
+ * copies each cell's file bytes straight into `cells` at its start index;
+ * `layout` then absorbs them into the whole-file SHA-512, fills the rest of
+ * every cell with random padding and returns the leaf hashes. The file is read
+ * once and no per-chunk WebCrypto digest is awaited.
+ */
+export interface Chunker {
+  /**
+   * Cells per `layout` call: one group of CHUNKER_LANES per thread of the
+   * module's task pool, so a threaded module hashes the groups in parallel.
+   */
+  readonly capacity: number;
+  /**
+   * `capacity` cells of `chunkSize` bytes, a fresh view on the WASM heap. Take
+   * it again after any other call into the module, which may grow the heap.
+   */
+  readonly cells: Uint8Array;
+  layout(starts: ArrayLike<number>, lens: ArrayLike<number>): Uint8Array;
+  final(): Uint8Array;
+  free(): void;
+}
+
+/**
+ * @function
+ * createChunker
+ *
+ * @description
+ * Starts a chunker for cells of `chunkSize` bytes in `module`'s heap.
+ * `capacity` is CHUNKER_LANES times the module's pool threads.
+ *
+ * @returns {Chunker}
+ */
+export const createChunker = (
+  module: LibCrypto,
+  chunkSize: number,
+): Chunker => {
+  const capacity = CHUNKER_LANES * module._pool_threads();
+  const statePtr = module._malloc(chunker_STATEBYTES);
+  const cellsPtr = module._malloc(capacity * chunkSize);
+  const spansPtr = module._malloc(2 * capacity * 4);
+  const outPtr = module._malloc(capacity * crypto_hash_sha512_BYTES);
+  let freed = false;
+
+  const free = (): void => {
+    if (freed) return;
+    freed = true;
+    // The cells held plaintext file bytes.
+    new Uint8Array(
+      module.wasmMemory.buffer,
+      cellsPtr,
+      capacity * chunkSize,
+    ).fill(0);
+    module._free(outPtr);
+    module._free(spansPtr);
+    module._free(cellsPtr);
+    module._free(statePtr);
+  };
+
+  if (module._chunker_init(statePtr, chunkSize) !== 0) {
+    free();
+    throw new Error("Could not initialize chunker.");
+  }
+
+  // The realm's shared module may grow its heap between calls, which detaches
+  // an unshared buffer, so every view is taken from the current one.
+  return {
+    capacity,
+
+    get cells(): Uint8Array {
+      return new Uint8Array(
+        module.wasmMemory.buffer,
+        cellsPtr,
+        capacity * chunkSize,
+      );
+    },
+
+    layout: (
+      starts: ArrayLike<number>,
+      lens: ArrayLike<number>,
+    ): Uint8Array => {
+      if (freed) throw new Error("Chunker has been freed.");
+      const count = starts.length;
+      if (count < 1 || count > capacity || lens.length !== count)
+        throw new Error("Invalid chunker cell count.");
+
+      const spans = new Uint32Array(
+        module.wasmMemory.buffer,
+        spansPtr,
+        2 * capacity,
+      );
+      for (let i = 0; i < count; i++) {
+        spans[i] = starts[i];
+        spans[capacity + i] = lens[i];
+      }
+      const result = module._chunker_layout(
+        statePtr,
+        count,
+        cellsPtr,
+        spansPtr,
+        spansPtr + capacity * 4,
+        outPtr,
+      );
+      if (result === -1) throw new Error("Chunk span out of cell bounds.");
+      if (result !== 0) throw new Error("Could not calculate hash.");
+
+      return Uint8Array.from(
+        new Uint8Array(
+          module.wasmMemory.buffer,
+          outPtr,
+          count * crypto_hash_sha512_BYTES,
+        ),
+      );
+    },
+
+    final: (): Uint8Array => {
+      if (freed) throw new Error("Chunker has been freed.");
+      if (module._chunker_final(statePtr, outPtr) !== 0)
+        throw new Error("Could not calculate hash.");
+
+      return Uint8Array.from(
+        new Uint8Array(
+          module.wasmMemory.buffer,
+          outPtr,
+          crypto_hash_sha512_BYTES,
+        ),
+      );
+    },
+
+    free,
+  };
+};
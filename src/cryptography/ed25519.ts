@@ -1,7 +1,5 @@
-import memory from "./memory";
-
-// import libcrypto from "./libcrypto";
-import { wasmLoader } from "./wasmLoader";
+import { sharedModule } from "./sharedModule";
+import { withScratch } from "./scratch";
 
 import {
   crypto_sign_ed25519_PUBLICKEYBYTES,
@@ -10,119 +8,58 @@ import {
   crypto_sign_ed25519_BYTES,
 } from "./interfaces";
 
-import { zeroFree } from "../utils/zeroFree";
-
 import { fillRandomBytesInto } from "./random";
 
 import type { SignKeyPair } from "./interfaces";
 import type { LibCrypto } from "./libcrypto";
 
 export const newKeyPair = async (module?: LibCrypto): Promise<SignKeyPair> => {
-  const wasmMemory = module?.wasmMemory ?? memory.newKeyPairMemory();
-
-  // const cryptoModule = module ?? (await libcrypto({ wasmMemory }));
-  const cryptoModule = module ?? (await wasmLoader(wasmMemory));
-
-  const ptr1 = cryptoModule._malloc(crypto_sign_ed25519_PUBLICKEYBYTES);
-  const publicKey = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    crypto_sign_ed25519_PUBLICKEYBYTES,
-  );
-
-  const ptr2 = cryptoModule._malloc(crypto_sign_ed25519_SECRETKEYBYTES);
-  const secretKey = new Uint8Array(
-    wasmMemory.buffer,
-    ptr2,
-    crypto_sign_ed25519_SECRETKEYBYTES,
-  );
+  const cryptoModule = module ?? (await sharedModule());
 
-  const ptr3 = cryptoModule._malloc(crypto_sign_ed25519_SEEDBYTES);
-  const seedBytes = new Uint8Array(
-    wasmMemory.buffer,
-    ptr3,
-    crypto_sign_ed25519_SEEDBYTES,
-  );
-  try {
-    fillRandomBytesInto(seedBytes);
+  return withScratch(cryptoModule, (frame) => {
+    const pk = frame.alloc(crypto_sign_ed25519_PUBLICKEYBYTES);
+    const sk = frame.alloc(crypto_sign_ed25519_SECRETKEYBYTES);
+    const seed = frame.alloc(crypto_sign_ed25519_SEEDBYTES);
+    fillRandomBytesInto(frame.view(seed, crypto_sign_ed25519_SEEDBYTES));
 
-    const result = cryptoModule._keypair_from_seed(
-      publicKey.byteOffset,
-      secretKey.byteOffset,
-      seedBytes.byteOffset,
-    );
+    const result = cryptoModule._keypair_from_seed(pk, sk, seed);
     if (result !== 0) throw new Error("An unexpected error occured.");
 
     return {
-      publicKey: Uint8Array.from(publicKey),
-      secretKey: Uint8Array.from(secretKey),
+      publicKey: Uint8Array.from(
+        frame.view(pk, crypto_sign_ed25519_PUBLICKEYBYTES),
+      ),
+      secretKey: Uint8Array.from(
+        frame.view(sk, crypto_sign_ed25519_SECRETKEYBYTES),
+      ),
     };
-  } finally {
-    cryptoModule._free(ptr1);
-    zeroFree(cryptoModule, secretKey);
-    zeroFree(cryptoModule, seedBytes);
-  }
+  });
 };
 
 export const keyPairFromSeed = async (
   seed: Uint8Array,
   module?: LibCrypto,
 ): Promise<SignKeyPair> => {
-  const wasmMemory = module?.wasmMemory ?? memory.keyPairFromSeedMemory();
-
-  // const cryptoModule = module ?? (await libcrypto({ wasmMemory }));
-  const cryptoModule = module ?? (await wasmLoader(wasmMemory));
-
-  const ptr1 = cryptoModule._malloc(crypto_sign_ed25519_PUBLICKEYBYTES);
-  const publicKey = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    crypto_sign_ed25519_PUBLICKEYBYTES,
-  );
-
-  const ptr2 = cryptoModule._malloc(crypto_sign_ed25519_SECRETKEYBYTES);
-  const secretKey = new Uint8Array(
-    wasmMemory.buffer,
-    ptr2,
-    crypto_sign_ed25519_SECRETKEYBYTES,
-  );
+  const cryptoModule = module ?? (await sharedModule());
 
-  const ptr3 = cryptoModule._malloc(crypto_sign_ed25519_SEEDBYTES);
-  const seedBytes = new Uint8Array(
-    wasmMemory.buffer,
-    ptr3,
-    crypto_sign_ed25519_SEEDBYTES,
-  );
-  seedBytes.set(seed);
+  return withScratch(cryptoModule, (frame) => {
+    const pk = frame.alloc(crypto_sign_ed25519_PUBLICKEYBYTES);
+    const sk = frame.alloc(crypto_sign_ed25519_SECRETKEYBYTES);
+    const seedPtr = frame.alloc(crypto_sign_ed25519_SEEDBYTES);
+    frame.view(seedPtr, crypto_sign_ed25519_SEEDBYTES).set(seed);
 
-  const result = cryptoModule._keypair_from_seed(
-    publicKey.byteOffset,
-    secretKey.byteOffset,
-    seedBytes.byteOffset,
-  );
-
-  zeroFree(cryptoModule, seedBytes);
-
-  switch (result) {
-    case 0: {
-      const keyPair = {
-        publicKey: Uint8Array.from(publicKey),
-        secretKey: Uint8Array.from(secretKey),
-      };
-
-      cryptoModule._free(ptr1);
-      zeroFree(cryptoModule, secretKey);
-
-      return keyPair;
-    }
-
-    default: {
-      cryptoModule._free(ptr1);
-      zeroFree(cryptoModule, secretKey);
+    const result = cryptoModule._keypair_from_seed(pk, sk, seedPtr);
+    if (result !== 0) throw new Error("An unexpected error occured.");
 
-      throw new Error("An unexpected error occured.");
-    }
-  }
+    return {
+      publicKey: Uint8Array.from(
+        frame.view(pk, crypto_sign_ed25519_PUBLICKEYBYTES),
+      ),
+      secretKey: Uint8Array.from(
+        frame.view(sk, crypto_sign_ed25519_SECRETKEYBYTES),
+      ),
+    };
+  });
 };
 
 export const keyPairFromSecretKey = async (
@@ -133,40 +70,22 @@ export const keyPairFromSecretKey = async (
     throw new Error(
       `Ed25519 secret key must be ${String(crypto_sign_ed25519_SECRETKEYBYTES)} bytes`,
     );
-  const wasmMemory = module?.wasmMemory ?? memory.keyPairFromSecretKeyMemory();
-
-  // const cryptoModule = module ?? (await libcrypto({ wasmMemory }));
-  const cryptoModule = module ?? (await wasmLoader(wasmMemory));
+  const cryptoModule = module ?? (await sharedModule());
 
-  const ptr1 = cryptoModule._malloc(crypto_sign_ed25519_PUBLICKEYBYTES);
-  const pk = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    crypto_sign_ed25519_PUBLICKEYBYTES,
-  );
+  return withScratch(cryptoModule, (frame) => {
+    const pk = frame.alloc(crypto_sign_ed25519_PUBLICKEYBYTES);
+    const sk = frame.put(secretKey);
 
-  const ptr2 = cryptoModule._malloc(crypto_sign_ed25519_SECRETKEYBYTES);
-  const sk = new Uint8Array(
-    wasmMemory.buffer,
-    ptr2,
-    crypto_sign_ed25519_SECRETKEYBYTES,
-  );
-  sk.set(secretKey);
-
-  try {
-    const result = cryptoModule._keypair_from_secret_key(
-      pk.byteOffset,
-      sk.byteOffset,
-    );
+    const result = cryptoModule._keypair_from_secret_key(pk, sk);
     if (result !== 0) throw new Error("Could not derive Ed25519 public key");
+
     return {
-      publicKey: Uint8Array.from(pk),
+      publicKey: Uint8Array.from(
+        frame.view(pk, crypto_sign_ed25519_PUBLICKEYBYTES),
+      ),
       secretKey,
     };
-  } finally {
-    cryptoModule._free(ptr1);
-    zeroFree(cryptoModule, sk);
-  }
+  });
 };
 
 /**
@@ -182,52 +101,18 @@ export const sign = async (
     throw new Error(
       `Ed25519 secret key must be ${String(crypto_sign_ed25519_SECRETKEYBYTES)} bytes`,
     );
-  const messageLen = message.length;
-
-  const wasmMemory = module ? module.wasmMemory : memory.signMemory(messageLen);
+  const cryptoModule = module ?? (await sharedModule());
 
-  // const cryptoModule = module ?? (await libcrypto({ wasmMemory }));
-  const cryptoModule = module ?? (await wasmLoader(wasmMemory));
+  return withScratch(cryptoModule, (frame) => {
+    const data = frame.put(message);
+    const signature = frame.alloc(crypto_sign_ed25519_BYTES);
+    const sk = frame.put(secretKey);
 
-  const ptr1 = cryptoModule._malloc(
-    Math.max(messageLen * Uint8Array.BYTES_PER_ELEMENT, 1),
-  );
-  const dataArray = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    messageLen * Uint8Array.BYTES_PER_ELEMENT,
-  );
-  dataArray.set(message);
-
-  const ptr2 = cryptoModule._malloc(crypto_sign_ed25519_BYTES);
-  const signature = new Uint8Array(
-    wasmMemory.buffer,
-    ptr2,
-    crypto_sign_ed25519_BYTES,
-  );
-
-  const ptr3 = cryptoModule._malloc(crypto_sign_ed25519_SECRETKEYBYTES);
-  const sk = new Uint8Array(
-    wasmMemory.buffer,
-    ptr3,
-    crypto_sign_ed25519_SECRETKEYBYTES,
-  );
-  sk.set(secretKey);
-
-  try {
-    const result = cryptoModule._sign(
-      messageLen,
-      dataArray.byteOffset,
-      sk.byteOffset,
-      signature.byteOffset,
-    );
+    const result = cryptoModule._sign(message.length, data, sk, signature);
     if (result !== 0) throw new Error("Could not sign with Ed25519");
-    return Uint8Array.from(signature);
-  } finally {
-    cryptoModule._free(ptr1);
-    cryptoModule._free(ptr2);
-    zeroFree(cryptoModule, sk);
-  }
+
+    return Uint8Array.from(frame.view(signature, crypto_sign_ed25519_BYTES));
+  });
 };
 
 export const verify = async (
@@ -236,47 +121,87 @@ export const verify = async (
   publicKey: Uint8Array,
   module?: LibCrypto,
 ): Promise<boolean> => {
-  const len = message.length;
+  const cryptoModule = module ?? (await sharedModule());
 
-  const wasmMemory = module ? module.wasmMemory : memory.verifyMemory(len);
+  return withScratch(cryptoModule, (frame) => {
+    const data = frame.put(message);
+    const sig = frame.alloc(crypto_sign_ed25519_BYTES);
+    const key = frame.alloc(crypto_sign_ed25519_PUBLICKEYBYTES);
+    frame.view(sig, crypto_sign_ed25519_BYTES).set(signature);
+    frame.view(key, crypto_sign_ed25519_PUBLICKEYBYTES).set(publicKey);
 
-  // const cryptoModule = module ?? (await libcrypto({ wasmMemory }));
-  const cryptoModule = module ?? (await wasmLoader(wasmMemory));
+    return cryptoModule._verify(message.length, data, key, sig) === 0;
+  });
+};
 
-  const ptr1 = cryptoModule._malloc(len * Uint8Array.BYTES_PER_ELEMENT);
-  const dataArray = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    len * Uint8Array.BYTES_PER_ELEMENT,
-  );
-  dataArray.set(message);
+export interface SignedMessage {
+  message: Uint8Array;
+  signature: Uint8Array;
+  publicKey: Uint8Array;
+}
 
-  const ptr2 = cryptoModule._malloc(crypto_sign_ed25519_BYTES);
-  const sig = new Uint8Array(
-    wasmMemory.buffer,
-    ptr2,
-    crypto_sign_ed25519_BYTES,
-  );
-  sig.set(signature);
+/**
+ * @function
+ * Verifies many signatures with one call into `verify_batch`, which checks up
+ * to sixteen of them with a single randomized multi-scalar multiplication and
+ * only verifies them one by one when that check fails. Returns one result per
+ * entry, in order; each is what `verify` returns for the same entry.
+ */
+export const verifyBatch = async (
+  entries: readonly SignedMessage[],
+  module?: LibCrypto,
+): Promise<boolean[]> => {
+  const count = entries.length;
+  if (count === 0) return [];
+
+  let messagesLen = 0;
+  for (const entry of entries) {
+    if (
+      entry.signature.length !== crypto_sign_ed25519_BYTES ||
+      entry.publicKey.length !== crypto_sign_ed25519_PUBLICKEYBYTES
+    )
+      throw new Error("Invalid Ed25519 signature or public key length");
+    messagesLen += entry.message.length;
+  }
 
-  const ptr3 = cryptoModule._malloc(crypto_sign_ed25519_PUBLICKEYBYTES);
-  const key = new Uint8Array(
-    wasmMemory.buffer,
-    ptr3,
-    crypto_sign_ed25519_PUBLICKEYBYTES,
-  );
-  key.set(publicKey);
+  const cryptoModule = module ?? (await sharedModule());
 
-  const result = cryptoModule._verify(
-    len,
-    dataArray.byteOffset,
-    key.byteOffset,
-    sig.byteOffset,
-  );
+  return withScratch(cryptoModule, (frame) => {
+    const ptr1 = frame.alloc(messagesLen);
+    const ptr2 = frame.alloc(count * Uint32Array.BYTES_PER_ELEMENT);
+    const ptr3 = frame.alloc(count * crypto_sign_ed25519_PUBLICKEYBYTES);
+    const ptr4 = frame.alloc(count * crypto_sign_ed25519_BYTES);
+    const ptr5 = frame.alloc(count);
 
-  cryptoModule._free(ptr1);
-  cryptoModule._free(ptr2);
-  cryptoModule._free(ptr3);
+    const messages = frame.view(ptr1, messagesLen);
+    const messageLens = new Uint32Array(
+      cryptoModule.wasmMemory.buffer,
+      ptr2,
+      count,
+    );
+    const keys = frame.view(ptr3, count * crypto_sign_ed25519_PUBLICKEYBYTES);
+    const sigs = frame.view(ptr4, count * crypto_sign_ed25519_BYTES);
+
+    let offset = 0;
+    entries.forEach((entry, i) => {
+      messages.set(entry.message, offset);
+      offset += entry.message.length;
+      messageLens[i] = entry.message.length;
+      keys.set(entry.publicKey, i * crypto_sign_ed25519_PUBLICKEYBYTES);
+      sigs.set(entry.signature, i * crypto_sign_ed25519_BYTES);
+    });
+
+    const result = cryptoModule._verify_batch(
+      count,
+      ptr1,
+      ptr2,
+      ptr3,
+      ptr4,
+      ptr5,
+    );
+    if (result !== 0 && result !== -1)
+      throw new Error("Could not verify Ed25519 signatures");
 
-  return result === 0;
+    return Array.from(frame.view(ptr5, count), (ok) => ok === 1);
+  });
 };
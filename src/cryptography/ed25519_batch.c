@@ -0,0 +1,713 @@
+#include "ed25519_batch.h"
+
+/* Variable-time Edwards25519 arithmetic for batch verification. Everything it
+ * touches is public (keys, signatures, messages) except the z_i, which only
+ * need to be unpredictable to the signers, so there is no need for the
+ * constant-time code libsodium keeps internal. Field elements are ref10's
+ * ten signed limbs of alternately 26 and 25 bits, so a product stays within
+ * 64-bit WASM multiplies; points use extended coordinates and the ref10
+ * formulas. The multi-scalar multiplication is Straus' method over width-5
+ * signed sliding windows: one chain of doublings for the whole batch, and an
+ * addition per non-zero digit from a table of odd multiples of each point. */
+
+typedef int32_t ed25519_fe[10];
+
+typedef struct
+{
+  ed25519_fe X, Y, Z;
+} ed25519_ge_p2;
+
+typedef struct
+{
+  ed25519_fe X, Y, Z, T;
+} ed25519_ge_p3;
+
+typedef struct
+{
+  ed25519_fe X, Y, Z, T;
+} ed25519_ge_p1p1;
+
+typedef struct
+{
+  ed25519_fe YplusX, YminusX, Z, T2d;
+} ed25519_ge_cached;
+
+/* Odd multiples P, 3P, ..., 15P of each point. */
+#define ED25519_BATCH_TABLE 8
+#define ED25519_BATCH_POINTS (2 * ED25519_BATCH_MAX + 1)
+
+static const ed25519_fe ed25519_d = { -10913610, 13857413, -15372611,
+                                      6949391,   114729,   -8787816,
+                                      -6275908,  -3247719, -18696448,
+                                      -12055116 };
+
+static const ed25519_fe ed25519_d2 = { -21827239, -5839606, -30745221,
+                                       13898782,  229458,   15978800,
+                                       -12551817, -6495438, 29715968,
+                                       9444199 };
+
+static const ed25519_fe ed25519_sqrtm1 = { -32595792, -7943725, 9377950,
+                                           3500415,   12389472, -272473,
+                                           -25146209, -2005654, 326686,
+                                           11406482 };
+
+/* Encoding of the base point, y = 4/5. */
+static const uint8_t ed25519_basepoint[32] = {
+  0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+  0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+  0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+};
+
+/* The group order L, little-endian. */
+static const uint8_t ed25519_order[32] = {
+  0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7,
+  0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+};
+
+/* Bit offset of each limb; limb i is 26 bits wide if i is even, else 25. */
+static const unsigned char ed25519_fe_offset[10] = { 0,   26,  51,  77,  102,
+                                                     128, 153, 179, 204, 230 };
+
+static void
+ed25519_fe_0(ed25519_fe h)
+{
+  memset(h, 0, sizeof(ed25519_fe));
+}
+
+static void
+ed25519_fe_1(ed25519_fe h)
+{
+  ed25519_fe_0(h);
+  h[0] = 1;
+}
+
+static void
+ed25519_fe_copy(ed25519_fe h, const ed25519_fe f)
+{
+  memcpy(h, f, sizeof(ed25519_fe));
+}
+
+static void
+ed25519_fe_add(ed25519_fe h, const ed25519_fe f, const ed25519_fe g)
+{
+  unsigned int i;
+
+  for (i = 0; i < 10; i++) h[i] = f[i] + g[i];
+}
+
+static void
+ed25519_fe_sub(ed25519_fe h, const ed25519_fe f, const ed25519_fe g)
+{
+  unsigned int i;
+
+  for (i = 0; i < 10; i++) h[i] = f[i] - g[i];
+}
+
+static void
+ed25519_fe_neg(ed25519_fe h, const ed25519_fe f)
+{
+  unsigned int i;
+
+  for (i = 0; i < 10; i++) h[i] = -f[i];
+}
+
+/* ref10's carry order, rounding each limb to within half its width. */
+static void
+ed25519_fe_carry(ed25519_fe h, int64_t t[10])
+{
+  static const unsigned char order[12] = { 0, 4, 1, 5, 2, 6, 3, 7, 4, 8, 9, 0 };
+  unsigned int k, i, bits;
+  int64_t c;
+
+  for (k = 0; k < 12; k++)
+  {
+    i = order[k];
+    bits = (i & 1) ? 25 : 26;
+    c = (t[i] + ((int64_t)1 << (bits - 1))) >> bits;
+    t[i] -= c * ((int64_t)1 << bits);
+    if (i == 9)
+      t[0] += 19 * c;
+    else
+      t[i + 1] += c;
+  }
+  for (i = 0; i < 10; i++) h[i] = (int32_t)t[i];
+}
+
+/* Limb i times limb j lands on limb i + j, doubled when both are odd (their
+ * offsets round up twice) and times 19 past 2^255. */
+static void
+ed25519_fe_mul(ed25519_fe h, const ed25519_fe f, const ed25519_fe g)
+{
+  const int64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+  const int64_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+  const int64_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+  const int64_t g5 = g[5], g6 = g[6], g7 = g[7], g8 = g[8], g9 = g[9];
+  const int64_t f1_2 = 2 * f1, f3_2 = 2 * f3, f5_2 = 2 * f5;
+  const int64_t f7_2 = 2 * f7, f9_2 = 2 * f9;
+  const int64_t g1_19 = 19 * g1, g2_19 = 19 * g2, g3_19 = 19 * g3;
+  const int64_t g4_19 = 19 * g4, g5_19 = 19 * g5, g6_19 = 19 * g6;
+  const int64_t g7_19 = 19 * g7, g8_19 = 19 * g8, g9_19 = 19 * g9;
+  int64_t t[10];
+
+  t[0] = f0 * g0 + f1_2 * g9_19 + f2 * g8_19 + f3_2 * g7_19 + f4 * g6_19
+       + f5_2 * g5_19 + f6 * g4_19 + f7_2 * g3_19 + f8 * g2_19 + f9_2 * g1_19;
+  t[1] = f0 * g1 + f1 * g0 + f2 * g9_19 + f3 * g8_19 + f4 * g7_19 + f5 * g6_19
+       + f6 * g5_19 + f7 * g4_19 + f8 * g3_19 + f9 * g2_19;
+  t[2] = f0 * g2 + f1_2 * g1 + f2 * g0 + f3_2 * g9_19 + f4 * g8_19
+       + f5_2 * g7_19 + f6 * g6_19 + f7_2 * g5_19 + f8 * g4_19 + f9_2 * g3_19;
+  t[3] = f0 * g3 + f1 * g2 + f2 * g1 + f3 * g0 + f4 * g9_19 + f5 * g8_19
+       + f6 * g7_19 + f7 * g6_19 + f8 * g5_19 + f9 * g4_19;
+  t[4] = f0 * g4 + f1_2 * g3 + f2 * g2 + f3_2 * g1 + f4 * g0 + f5_2 * g9_19
+       + f6 * g8_19 + f7_2 * g7_19 + f8 * g6_19 + f9_2 * g5_19;
+  t[5] = f0 * g5 + f1 * g4 + f2 * g3 + f3 * g2 + f4 * g1 + f5 * g0 + f6 * g9_19
+       + f7 * g8_19 + f8 * g7_19 + f9 * g6_19;
+  t[6] = f0 * g6 + f1_2 * g5 + f2 * g4 + f3_2 * g3 + f4 * g2 + f5_2 * g1
+       + f6 * g0 + f7_2 * g9_19 + f8 * g8_19 + f9_2 * g7_19;
+  t[7] = f0 * g7 + f1 * g6 + f2 * g5 + f3 * g4 + f4 * g3 + f5 * g2 + f6 * g1
+       + f7 * g0 + f8 * g9_19 + f9 * g8_19;
+  t[8] = f0 * g8 + f1_2 * g7 + f2 * g6 + f3_2 * g5 + f4 * g4 + f5_2 * g3
+       + f6 * g2 + f7_2 * g1 + f8 * g0 + f9_2 * g9_19;
+  t[9] = f0 * g9 + f1 * g8 + f2 * g7 + f3 * g6 + f4 * g5 + f5 * g4 + f6 * g3
+       + f7 * g2 + f8 * g1 + f9 * g0;
+
+  ed25519_fe_carry(h, t);
+}
+
+/* f * f with the symmetric products folded. */
+static void
+ed25519_fe_sq(ed25519_fe h, const ed25519_fe f)
+{
+  const int64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+  const int64_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+  const int64_t f0_2 = 2 * f0, f1_2 = 2 * f1, f2_2 = 2 * f2, f3_2 = 2 * f3;
+  const int64_t f4_2 = 2 * f4, f5_2 = 2 * f5, f6_2 = 2 * f6, f7_2 = 2 * f7;
+  const int64_t f8_2 = 2 * f8, f1_4 = 4 * f1, f3_4 = 4 * f3, f6_19 = 19 * f6;
+  const int64_t f7_19 = 19 * f7, f8_19 = 19 * f8, f9_19 = 19 * f9;
+  const int64_t f5_38 = 38 * f5, f7_38 = 38 * f7, f9_38 = 38 * f9;
+  int64_t t[10];
+
+  t[0] = f0 * f0 + f1_2 * f9_38 + f2_2 * f8_19 + f3_2 * f7_38 + f4_2 * f6_19
+       + f5 * f5_38;
+  t[1] = f0_2 * f1 + f2_2 * f9_19 + f3_2 * f8_19 + f4_2 * f7_19 + f5_2 * f6_19;
+  t[2] = f0_2 * f2 + f1_2 * f1 + f3_2 * f9_38 + f4_2 * f8_19 + f5_2 * f7_38
+       + f6 * f6_19;
+  t[3] = f0_2 * f3 + f1_2 * f2 + f4_2 * f9_19 + f5_2 * f8_19 + f6_2 * f7_19;
+  t[4] = f0_2 * f4 + f1_4 * f3 + f2 * f2 + f5_2 * f9_38 + f6_2 * f8_19
+       + f7 * f7_38;
+  t[5] = f0_2 * f5 + f1_2 * f4 + f2_2 * f3 + f6_2 * f9_19 + f7_2 * f8_19;
+  t[6] = f0_2 * f6 + f1_4 * f5 + f2_2 * f4 + f3_2 * f3 + f7_2 * f9_38
+       + f8 * f8_19;
+  t[7] = f0_2 * f7 + f1_2 * f6 + f2_2 * f5 + f3_2 * f4 + f8_2 * f9_19;
+  t[8] = f0_2 * f8 + f1_4 * f7 + f2_2 * f6 + f3_4 * f5 + f4 * f4 + f9 * f9_38;
+  t[9] = f0_2 * f9 + f1_2 * f8 + f2_2 * f7 + f3_2 * f6 + f4_2 * f5;
+
+  ed25519_fe_carry(h, t);
+}
+
+static void
+ed25519_fe_sqn(ed25519_fe h, const ed25519_fe f, unsigned int n)
+{
+  ed25519_fe_sq(h, f);
+  while (--n > 0) ed25519_fe_sq(h, h);
+}
+
+/* z^(2^252 - 3), ref10's addition chain. */
+static void
+ed25519_fe_pow22523(ed25519_fe out, const ed25519_fe z)
+{
+  ed25519_fe t0, t1, t2;
+
+  ed25519_fe_sq(t0, z);
+  ed25519_fe_sqn(t1, t0, 2);
+  ed25519_fe_mul(t1, z, t1);
+  ed25519_fe_mul(t0, t0, t1);
+  ed25519_fe_sq(t0, t0);
+  ed25519_fe_mul(t0, t1, t0);     /* 2^5 - 1 */
+  ed25519_fe_sqn(t1, t0, 5);
+  ed25519_fe_mul(t0, t1, t0);     /* 2^10 - 1 */
+  ed25519_fe_sqn(t1, t0, 10);
+  ed25519_fe_mul(t1, t1, t0);     /* 2^20 - 1 */
+  ed25519_fe_sqn(t2, t1, 20);
+  ed25519_fe_mul(t1, t2, t1);     /* 2^40 - 1 */
+  ed25519_fe_sqn(t1, t1, 10);
+  ed25519_fe_mul(t0, t1, t0);     /* 2^50 - 1 */
+  ed25519_fe_sqn(t1, t0, 50);
+  ed25519_fe_mul(t1, t1, t0);     /* 2^100 - 1 */
+  ed25519_fe_sqn(t2, t1, 100);
+  ed25519_fe_mul(t1, t2, t1);     /* 2^200 - 1 */
+  ed25519_fe_sqn(t1, t1, 50);
+  ed25519_fe_mul(t0, t1, t0);     /* 2^250 - 1 */
+  ed25519_fe_sqn(t0, t0, 2);
+  ed25519_fe_mul(out, t0, z);     /* 2^252 - 3 */
+}
+
+/* Bits 0..254 of s; bit 255 is the caller's. */
+static void
+ed25519_fe_frombytes(ed25519_fe h, const uint8_t s[32])
+{
+  unsigned int i, j, at;
+  uint64_t w;
+
+  for (i = 0; i < 10; i++)
+  {
+    at = ed25519_fe_offset[i] / 8;
+    w = 0;
+    for (j = 0; j < 8 && at + j < 32; j++) w |= (uint64_t)s[at + j] << (8 * j);
+    w >>= ed25519_fe_offset[i] % 8;
+    h[i] = (int32_t)(w & ((1U << ((i & 1) ? 25 : 26)) - 1));
+  }
+}
+
+/* The canonical encoding of h mod p, as ref10 computes it. */
+static void
+ed25519_fe_tobytes(uint8_t s[32], const ed25519_fe f)
+{
+  int64_t t[10];
+  int32_t q;
+  unsigned int i, bits;
+  ed25519_fe h;
+
+  for (i = 0; i < 10; i++) t[i] = f[i];
+  ed25519_fe_carry(h, t);
+
+  q = (19 * h[9] + ((int32_t)1 << 24)) >> 25;
+  for (i = 0; i < 10; i++) q = (h[i] + q) >> ((i & 1) ? 25 : 26);
+  h[0] += 19 * q;
+  for (i = 0; i < 10; i++)
+  {
+    bits = (i & 1) ? 25 : 26;
+    q = h[i] >> bits;
+    h[i] -= q * ((int32_t)1 << bits);
+    if (i < 9) h[i + 1] += q;
+  }
+
+  memset(s, 0, 32);
+  for (i = 0; i < 10; i++)
+  {
+    const uint64_t w = (uint64_t)(uint32_t)h[i] << (ed25519_fe_offset[i] % 8);
+    unsigned int at = ed25519_fe_offset[i] / 8, j;
+
+    for (j = 0; j < 5 && at + j < 32; j++) s[at + j] |= (uint8_t)(w >> (8 * j));
+  }
+}
+
+static int
+ed25519_fe_iszero(const ed25519_fe f)
+{
+  uint8_t s[32];
+  uint8_t c = 0;
+  unsigned int i;
+
+  ed25519_fe_tobytes(s, f);
+  for (i = 0; i < 32; i++) c |= s[i];
+
+  return c == 0;
+}
+
+static int
+ed25519_fe_isnegative(const ed25519_fe f)
+{
+  uint8_t s[32];
+
+  ed25519_fe_tobytes(s, f);
+
+  return s[0] & 1;
+}
+
+static void
+ed25519_ge_p1p1_to_p2(ed25519_ge_p2 *r, const ed25519_ge_p1p1 *p)
+{
+  ed25519_fe_mul(r->X, p->X, p->T);
+  ed25519_fe_mul(r->Y, p->Y, p->Z);
+  ed25519_fe_mul(r->Z, p->Z, p->T);
+}
+
+static void
+ed25519_ge_p1p1_to_p3(ed25519_ge_p3 *r, const ed25519_ge_p1p1 *p)
+{
+  ed25519_fe_mul(r->X, p->X, p->T);
+  ed25519_fe_mul(r->Y, p->Y, p->Z);
+  ed25519_fe_mul(r->Z, p->Z, p->T);
+  ed25519_fe_mul(r->T, p->X, p->Y);
+}
+
+static void
+ed25519_ge_p3_to_cached(ed25519_ge_cached *r, const ed25519_ge_p3 *p)
+{
+  ed25519_fe_add(r->YplusX, p->Y, p->X);
+  ed25519_fe_sub(r->YminusX, p->Y, p->X);
+  ed25519_fe_copy(r->Z, p->Z);
+  ed25519_fe_mul(r->T2d, p->T, ed25519_d2);
+}
+
+static void
+ed25519_ge_p2_dbl(ed25519_ge_p1p1 *r, const ed25519_fe X, const ed25519_fe Y,
+                  const ed25519_fe Z)
+{
+  ed25519_fe t0;
+
+  ed25519_fe_sq(r->X, X);
+  ed25519_fe_sq(r->Z, Y);
+  ed25519_fe_sq(r->T, Z);
+  ed25519_fe_add(r->T, r->T, r->T);
+  ed25519_fe_add(r->Y, X, Y);
+  ed25519_fe_sq(t0, r->Y);
+  ed25519_fe_add(r->Y, r->Z, r->X);
+  ed25519_fe_sub(r->Z, r->Z, r->X);
+  ed25519_fe_sub(r->X, t0, r->Y);
+  ed25519_fe_sub(r->T, r->T, r->Z);
+}
+
+/* r = p + q, or p - q when `subtract` is set. */
+static void
+ed25519_ge_add(ed25519_ge_p1p1 *r, const ed25519_ge_p3 *p,
+               const ed25519_ge_cached *q, const int subtract)
+{
+  ed25519_fe t0;
+
+  ed25519_fe_add(r->X, p->Y, p->X);
+  ed25519_fe_sub(r->Y, p->Y, p->X);
+  ed25519_fe_mul(r->Z, r->X, subtract ? q->YminusX : q->YplusX);
+  ed25519_fe_mul(r->Y, r->Y, subtract ? q->YplusX : q->YminusX);
+  ed25519_fe_mul(r->T, q->T2d, p->T);
+  ed25519_fe_mul(r->X, p->Z, q->Z);
+  ed25519_fe_add(t0, r->X, r->X);
+  ed25519_fe_sub(r->X, r->Z, r->Y);
+  ed25519_fe_add(r->Y, r->Z, r->Y);
+  if (subtract)
+  {
+    ed25519_fe_sub(r->Z, t0, r->T);
+    ed25519_fe_add(r->T, t0, r->T);
+  }
+  else
+  {
+    ed25519_fe_add(r->Z, t0, r->T);
+    ed25519_fe_sub(r->T, t0, r->T);
+  }
+}
+
+static int
+ed25519_ge_is_identity(const ed25519_fe X, const ed25519_fe Y,
+                       const ed25519_fe Z)
+{
+  ed25519_fe t;
+
+  ed25519_fe_sub(t, Y, Z);
+
+  return ed25519_fe_iszero(X) && ed25519_fe_iszero(t);
+}
+
+/* libsodium's ge25519_is_canonical: the encoded y is below p. */
+static int
+ed25519_ge_is_canonical(const uint8_t s[32])
+{
+  unsigned int i;
+
+  if ((s[31] & 0x7f) != 0x7f) return 1;
+  for (i = 30; i > 0; i--)
+    if (s[i] != 0xff) return 1;
+
+  return s[0] < 0xed;
+}
+
+/* Decodes a canonical encoding; fails if y is not on the curve. */
+static int
+ed25519_ge_frombytes(ed25519_ge_p3 *h, const uint8_t s[32])
+{
+  ed25519_fe u, v, v3, vxx, check;
+
+  ed25519_fe_frombytes(h->Y, s);
+  ed25519_fe_1(h->Z);
+  ed25519_fe_sq(u, h->Y);
+  ed25519_fe_mul(v, u, ed25519_d);
+  ed25519_fe_sub(u, u, h->Z);       /* u = y^2 - 1 */
+  ed25519_fe_add(v, v, h->Z);       /* v = d y^2 + 1 */
+
+  ed25519_fe_sq(v3, v);
+  ed25519_fe_mul(v3, v3, v);        /* v^3 */
+  ed25519_fe_sq(h->X, v3);
+  ed25519_fe_mul(h->X, h->X, v);
+  ed25519_fe_mul(h->X, h->X, u);    /* u v^7 */
+  ed25519_fe_pow22523(h->X, h->X);
+  ed25519_fe_mul(h->X, h->X, v3);
+  ed25519_fe_mul(h->X, h->X, u);    /* u v^3 (u v^7)^((p - 5) / 8) */
+
+  ed25519_fe_sq(vxx, h->X);
+  ed25519_fe_mul(vxx, vxx, v);
+  ed25519_fe_sub(check, vxx, u);
+  if (!ed25519_fe_iszero(check))
+  {
+    ed25519_fe_add(check, vxx, u);
+    if (!ed25519_fe_iszero(check)) return -1;
+    ed25519_fe_mul(h->X, h->X, ed25519_sqrtm1);
+  }
+  if (ed25519_fe_isnegative(h->X) != (s[31] >> 7)) ed25519_fe_neg(h->X, h->X);
+  ed25519_fe_mul(h->T, h->X, h->Y);
+
+  return 0;
+}
+
+static int
+ed25519_ge_has_small_order(const ed25519_ge_p3 *p)
+{
+  ed25519_ge_p1p1 t;
+  ed25519_ge_p2 r;
+  unsigned int i;
+
+  ed25519_ge_p2_dbl(&t, p->X, p->Y, p->Z);
+  for (i = 1; i < 3; i++)
+  {
+    ed25519_ge_p1p1_to_p2(&r, &t);
+    ed25519_ge_p2_dbl(&t, r.X, r.Y, r.Z);
+  }
+  ed25519_ge_p1p1_to_p2(&r, &t);
+
+  return ed25519_ge_is_identity(r.X, r.Y, r.Z);
+}
+
+/* A key or R that crypto_sign_ed25519_verify_detached would accept. */
+static int
+ed25519_ge_frombytes_checked(ed25519_ge_p3 *h, const uint8_t s[32])
+{
+  if (!ed25519_ge_is_canonical(s) || ed25519_ge_frombytes(h, s) != 0
+      || ed25519_ge_has_small_order(h))
+    return -1;
+
+  return 0;
+}
+
+static int
+ed25519_sc_is_canonical(const uint8_t s[32])
+{
+  int i;
+
+  for (i = 31; i >= 0; i--)
+    if (s[i] != ed25519_order[i]) return s[i] < ed25519_order[i];
+
+  return 0;
+}
+
+/* ref10's slide: signed digits in [-15, 15], odd, at least five apart. */
+static void
+ed25519_sc_slide(signed char r[256], const uint8_t a[32])
+{
+  int i, b, k;
+
+  for (i = 0; i < 256; i++) r[i] = 1 & (a[i >> 3] >> (i & 7));
+
+  for (i = 0; i < 256; i++)
+  {
+    if (!r[i]) continue;
+    for (b = 1; b <= 6 && i + b < 256; b++)
+    {
+      if (!r[i + b]) continue;
+      if (r[i] + (r[i + b] << b) <= 15)
+      {
+        r[i] += r[i + b] << b;
+        r[i + b] = 0;
+      }
+      else if (r[i] - (r[i + b] << b) >= -15)
+      {
+        r[i] -= r[i + b] << b;
+        for (k = i + b; k < 256; k++)
+        {
+          if (!r[k])
+          {
+            r[k] = 1;
+            break;
+          }
+          r[k] = 0;
+        }
+      }
+      else
+        break;
+    }
+  }
+}
+
+static void
+ed25519_ge_table(ed25519_ge_cached table[ED25519_BATCH_TABLE],
+                 const ed25519_ge_p3 *p)
+{
+  ed25519_ge_p1p1 t;
+  ed25519_ge_p3 p2, u;
+  unsigned int i;
+
+  ed25519_ge_p3_to_cached(&table[0], p);
+  ed25519_ge_p2_dbl(&t, p->X, p->Y, p->Z);
+  ed25519_ge_p1p1_to_p3(&p2, &t);
+  for (i = 1; i < ED25519_BATCH_TABLE; i++)
+  {
+    ed25519_ge_add(&t, &p2, &table[i - 1], 0);
+    ed25519_ge_p1p1_to_p3(&u, &t);
+    ed25519_ge_p3_to_cached(&table[i], &u);
+  }
+}
+
+/* Whether sum([scalars[k]] points[k]) is the identity. */
+static int
+ed25519_msm_is_identity(const unsigned int N,
+                        uint8_t scalars[ED25519_BATCH_POINTS][32],
+                        const ed25519_ge_p3 points[ED25519_BATCH_POINTS])
+{
+  ed25519_ge_cached table[ED25519_BATCH_POINTS][ED25519_BATCH_TABLE];
+  signed char digits[ED25519_BATCH_POINTS][256];
+  ed25519_ge_p1p1 t;
+  ed25519_ge_p2 r;
+  ed25519_ge_p3 u;
+  unsigned int k;
+  int i, top = -1;
+
+  for (k = 0; k < N; k++)
+  {
+    ed25519_sc_slide(digits[k], scalars[k]);
+    ed25519_ge_table(table[k], &points[k]);
+    for (i = 255; i > top; i--)
+      if (digits[k][i]) top = i;
+  }
+
+  ed25519_fe_0(r.X);
+  ed25519_fe_1(r.Y);
+  ed25519_fe_1(r.Z);
+  for (i = top; i >= 0; i--)
+  {
+    ed25519_ge_p2_dbl(&t, r.X, r.Y, r.Z);
+    for (k = 0; k < N; k++)
+    {
+      const signed char d = digits[k][i];
+
+      if (d == 0) continue;
+      ed25519_ge_p1p1_to_p3(&u, &t);
+      ed25519_ge_add(&t, &u, &table[k][(d > 0 ? d : -d) / 2], d < 0);
+    }
+    ed25519_ge_p1p1_to_p2(&r, &t);
+  }
+
+  return ed25519_ge_is_identity(r.X, r.Y, r.Z);
+}
+
+/* One batch of at most ED25519_BATCH_MAX signatures; `offsets` locates each
+ * message in `messages`. */
+static void
+ed25519_verify_batch_chunk(const unsigned int COUNT, const uint8_t *messages,
+                           const size_t offsets[ED25519_BATCH_MAX],
+                           const uint32_t *message_lens,
+                           const uint8_t *public_keys,
+                           const uint8_t *signatures, uint8_t *results)
+{
+  /* The base point, then R_i and A_i of every signature left in the batch. */
+  ed25519_ge_p3 points[ED25519_BATCH_POINTS];
+  uint8_t scalars[ED25519_BATCH_POINTS][32];
+  unsigned int in_batch[ED25519_BATCH_MAX];
+  uint8_t hash[crypto_hash_sha512_BYTES];
+  uint8_t h[crypto_core_ed25519_SCALARBYTES];
+  uint8_t zs[crypto_core_ed25519_SCALARBYTES];
+  uint8_t sum[crypto_core_ed25519_SCALARBYTES] = { 0 };
+  crypto_hash_sha512_state state;
+  unsigned int i, n = 0, N;
+
+  for (i = 0; i < COUNT; i++)
+  {
+    const uint8_t *sig = signatures + i * crypto_sign_ed25519_BYTES;
+    const uint8_t *pk = public_keys + i * crypto_sign_ed25519_PUBLICKEYBYTES;
+    uint8_t *z = scalars[1 + 2 * n];
+
+    results[i] = 0;
+    if ((sig[63] & 240) && !ed25519_sc_is_canonical(sig + 32)) continue;
+    if (ed25519_ge_frombytes_checked(&points[1 + 2 * n], sig) != 0
+        || ed25519_ge_frombytes_checked(&points[2 + 2 * n], pk) != 0)
+      continue;
+
+    crypto_hash_sha512_init(&state);
+    crypto_hash_sha512_update(&state, sig, 32);
+    crypto_hash_sha512_update(&state, pk, crypto_sign_ed25519_PUBLICKEYBYTES);
+    crypto_hash_sha512_update(&state, messages + offsets[i], message_lens[i]);
+    crypto_hash_sha512_final(&state, hash);
+    crypto_core_ed25519_scalar_reduce(h, hash);
+
+    /* z_i odd, so no single small-order defect vanishes from the sum. */
+    memset(z, 0, 32);
+    randombytes_buf(z, 16);
+    z[0] |= 1;
+    crypto_core_ed25519_scalar_mul(scalars[2 + 2 * n], z, h);
+    crypto_core_ed25519_scalar_mul(zs, z, sig + 32);
+    crypto_core_ed25519_scalar_add(sum, sum, zs);
+    in_batch[n++] = i;
+  }
+
+  if (n == 1)
+  {
+    i = in_batch[0];
+    results[i] = crypto_sign_ed25519_verify_detached(
+                     signatures + i * crypto_sign_ed25519_BYTES,
+                     messages + offsets[i], message_lens[i],
+                     public_keys + i * crypto_sign_ed25519_PUBLICKEYBYTES)
+                 == 0;
+  }
+  else if (n > 1)
+  {
+    N = 1 + 2 * n;
+    crypto_core_ed25519_scalar_negate(scalars[0], sum);
+    if (ed25519_ge_frombytes(&points[0], ed25519_basepoint) == 0
+        && ed25519_msm_is_identity(N, scalars, points))
+    {
+      for (i = 0; i < n; i++) results[in_batch[i]] = 1;
+    }
+    else
+    {
+      /* Some signature is bad: find it (them) one by one. */
+      for (i = 0; i < n; i++)
+      {
+        const unsigned int j = in_batch[i];
+
+        results[j]
+            = crypto_sign_ed25519_verify_detached(
+                  signatures + j * crypto_sign_ed25519_BYTES,
+                  messages + offsets[j], message_lens[j],
+                  public_keys + j * crypto_sign_ed25519_PUBLICKEYBYTES)
+              == 0;
+      }
+    }
+  }
+
+  sodium_memzero(scalars, sizeof scalars);
+  sodium_memzero(zs, sizeof zs);
+  sodium_memzero(sum, sizeof sum);
+}
+
+int
+verify_batch(const unsigned int COUNT, const uint8_t *messages,
+             const uint32_t message_lens[COUNT],
+             const uint8_t public_keys[COUNT * 32],
+             const uint8_t signatures[COUNT * 64], uint8_t results[COUNT])
+{
+  size_t offsets[ED25519_BATCH_MAX];
+  size_t offset = 0;
+  unsigned int start, i, take;
+
+  if (COUNT == 0) return 0;
+  if (!message_lens || !public_keys || !signatures || !results) return -2;
+
+  for (start = 0; start < COUNT; start += take)
+  {
+    take = COUNT - start < ED25519_BATCH_MAX ? COUNT - start
+                                             : ED25519_BATCH_MAX;
+    for (i = 0; i < take; i++)
+    {
+      offsets[i] = offset;
+      offset += message_lens[start + i];
+    }
+    if (offset != 0 && !messages) return -2;
+
+    ed25519_verify_batch_chunk(
+        take, messages, offsets, message_lens + start,
+        public_keys + start * crypto_sign_ed25519_PUBLICKEYBYTES,
+        signatures + start * crypto_sign_ed25519_BYTES, results + start);
+  }
+
+  for (i = 0; i < COUNT; i++)
+    if (!results[i]) return -1;
+
+  return 0;
+}
@@ -0,0 +1,36 @@
+#ifndef ed25519_batch_H
+#define ed25519_batch_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sodium.h>
+
+/* Randomized batch verification of Ed25519 signatures (see ed25519_batch.c).
+ * Up to ED25519_BATCH_MAX signatures share one multi-scalar multiplication
+ * that checks
+ *
+ *   [-sum(z_i s_i)] B + sum([z_i] R_i) + sum([z_i h_i] A_i) == identity
+ *
+ * with secret random 128-bit z_i. If it does not hold, every signature of the
+ * batch is verified alone to find the bad ones. */
+#define ED25519_BATCH_MAX 16U
+
+/* Verifies COUNT signatures (any number; they are taken ED25519_BATCH_MAX at a
+ * time). Message i is the next message_lens[i] bytes of `messages`, public key
+ * i is public_keys[32 * i] and signature i is signatures[64 * i]. results[i]
+ * is set to 1 if signature i verifies under crypto_sign_ed25519_verify_detached
+ * and to 0 otherwise. Returns 0 if all of them verify, -1 if at least one does
+ * not and -2 on bad arguments.
+ *
+ * Every signature that crypto_sign_ed25519_verify_detached rejects is rejected
+ * here too, up to one corner case of every randomized cofactorless batch: two
+ * or more signatures in one batch whose only defect is a small-order component
+ * of R or A may cancel each other. Producing those takes the signer's secret
+ * key, so it lets a signer make its own signatures ambiguous, not forge. */
+int verify_batch(const unsigned int COUNT, const uint8_t *messages,
+                 const uint32_t message_lens[COUNT],
+                 const uint8_t public_keys[COUNT * 32],
+                 const uint8_t signatures[COUNT * 64], uint8_t results[COUNT]);
+
+#endif
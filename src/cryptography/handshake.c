@@ -0,0 +1,118 @@
+#include "handshake.h"
+
+/* HKDF labels, byte-matched to THREE_DH_INFO in x3dh.ts and the PQ-healing
+ * labels of the v4 handshake (without the NUL). */
+static const uint8_t handshake_3dh_info[] = "p2party-interactive-3dh-v2";
+static const uint8_t handshake_pq_extract_label[]
+    = "p2party-v4-pq-healing-extract-v1";
+static const uint8_t handshake_pq_root_label[]
+    = "p2party-v4-pq-healing-root-v1";
+
+#define HANDSHAKE_PQ_ROOT_INFO_LEN                                             \
+  (sizeof handshake_pq_root_label - 1 + HANDSHAKE_BINDING_LEN)
+
+/* Both salts of the HKDF-SHA512 extracts below are HashLen zeros. */
+static const uint8_t handshake_zero_salt[crypto_auth_hmacsha512_BYTES];
+
+int
+handshake_key_schedule(
+    uint8_t root_key[HANDSHAKE_KEY_LEN],
+    uint8_t pq_healing_root[HANDSHAKE_KEY_LEN],
+    uint8_t binding[HANDSHAKE_BINDING_LEN],
+    const uint8_t identity_sec[crypto_scalarmult_curve25519_SCALARBYTES],
+    const uint8_t peer_identity_pub[crypto_scalarmult_curve25519_BYTES],
+    const uint8_t ephemeral_sec[crypto_scalarmult_curve25519_SCALARBYTES],
+    const uint8_t peer_ephemeral_pub[crypto_scalarmult_curve25519_BYTES],
+    const unsigned int am_initiator, const uint8_t *pake_isk,
+    const uint8_t kem_secret[HANDSHAKE_KEM_SECRET_LEN],
+    const uint8_t *hybrid_info, const unsigned int HYBRID_INFO_LEN,
+    const uint8_t *binding_input, const unsigned int BINDING_INPUT_LEN)
+{
+  /* DH(IK_a, EK_b) || DH(EK_a, IK_b) || DH(EK_a, EK_b), a = initiator. */
+  uint8_t dh[3 * crypto_scalarmult_curve25519_BYTES];
+  uint8_t ikm[HANDSHAKE_PAKE_ISK_LEN + HANDSHAKE_KEY_LEN
+              + HANDSHAKE_KEM_SECRET_LEN];
+  uint8_t prk[crypto_auth_hmacsha512_BYTES];
+  uint8_t pq_info[HANDSHAKE_PQ_ROOT_INFO_LEN];
+  const size_t isk_len = pake_isk ? HANDSHAKE_PAKE_ISK_LEN : 0;
+  int res = -1;
+
+  if (!root_key || !pq_healing_root || !binding) return -1;
+  sodium_memzero(root_key, HANDSHAKE_KEY_LEN);
+  sodium_memzero(pq_healing_root, HANDSHAKE_KEY_LEN);
+  sodium_memzero(binding, HANDSHAKE_BINDING_LEN);
+  if (!identity_sec || !peer_identity_pub || !ephemeral_sec
+      || !peer_ephemeral_pub || !kem_secret || (HYBRID_INFO_LEN && !hybrid_info)
+      || (BINDING_INPUT_LEN && !binding_input))
+    return -1;
+
+  /* Interactive 3DH: the responder swaps the two identity-mixed DHs so both
+   * roles concatenate the same shared values. */
+  res = -2;
+  if (x25519_dh(dh + 2 * crypto_scalarmult_curve25519_BYTES, ephemeral_sec,
+                peer_ephemeral_pub)
+          != 0
+      || x25519_dh(dh, am_initiator ? identity_sec : ephemeral_sec,
+                   am_initiator ? peer_ephemeral_pub : peer_identity_pub)
+             != 0
+      || x25519_dh(dh + crypto_scalarmult_curve25519_BYTES,
+                   am_initiator ? ephemeral_sec : identity_sec,
+                   am_initiator ? peer_identity_pub : peer_ephemeral_pub)
+             != 0)
+    goto out;
+
+  /* Hybrid combiner IKM: [CPace ISK ||] 3DH secret || ML-KEM secret. */
+  res = -1;
+  if (isk_len) memcpy(ikm, pake_isk, isk_len);
+  if (hkdf_sha512_extract(prk, handshake_zero_salt, sizeof handshake_zero_salt,
+                          dh, sizeof dh)
+          != 0
+      || hkdf_sha512_expand(ikm + isk_len, HANDSHAKE_KEY_LEN, prk,
+                            handshake_3dh_info, sizeof handshake_3dh_info - 1)
+             != 0)
+    goto out;
+  memcpy(ikm + isk_len + HANDSHAKE_KEY_LEN, kem_secret,
+         HANDSHAKE_KEM_SECRET_LEN);
+
+  if (hkdf_sha512_extract(prk, handshake_zero_salt, sizeof handshake_zero_salt,
+                          ikm,
+                          isk_len + HANDSHAKE_KEY_LEN
+                              + HANDSHAKE_KEM_SECRET_LEN)
+          != 0
+      || hkdf_sha512_expand(root_key, HANDSHAKE_KEY_LEN, prk, hybrid_info,
+                            HYBRID_INFO_LEN)
+             != 0)
+    goto out;
+
+  /* Sparse PQ healing: a public edge binding and a root separated from the
+   * Double Ratchet seed. */
+  if (crypto_hash_sha256(binding, binding_input, BINDING_INPUT_LEN) != 0)
+    goto out;
+  memcpy(pq_info, handshake_pq_root_label,
+         sizeof handshake_pq_root_label - 1);
+  memcpy(pq_info + sizeof handshake_pq_root_label - 1, binding,
+         HANDSHAKE_BINDING_LEN);
+  if (hkdf_sha512_extract(prk, handshake_pq_extract_label,
+                          sizeof handshake_pq_extract_label - 1, root_key,
+                          HANDSHAKE_KEY_LEN)
+          != 0
+      || hkdf_sha512_expand(pq_healing_root, HANDSHAKE_KEY_LEN, prk, pq_info,
+                            sizeof pq_info)
+             != 0)
+    goto out;
+
+  res = 0;
+
+out:
+  sodium_memzero(dh, sizeof dh);
+  sodium_memzero(ikm, sizeof ikm);
+  sodium_memzero(prk, sizeof prk);
+  if (res != 0)
+  {
+    sodium_memzero(root_key, HANDSHAKE_KEY_LEN);
+    sodium_memzero(pq_healing_root, HANDSHAKE_KEY_LEN);
+    sodium_memzero(binding, HANDSHAKE_BINDING_LEN);
+  }
+
+  return res;
+}
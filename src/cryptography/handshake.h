@@ -0,0 +1,41 @@
+#ifndef handshake_H
+#define handshake_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sodium.h>
+
+#include "pake_ratchet.h"
+
+/* Protocol-v4 handshake key schedule (see handshake.c), the C side of
+ * handshakeKeys.ts. One call runs interactive 3DH, the hybrid combiner
+ * and the PQ-healing derivation of performHandshakeCore; every DH output,
+ * PRK and combiner input stays in C and is wiped before it returns. */
+#define HANDSHAKE_KEY_LEN 32U
+#define HANDSHAKE_PAKE_ISK_LEN crypto_hash_sha512_BYTES /* 64 */
+#define HANDSHAKE_KEM_SECRET_LEN 32U
+#define HANDSHAKE_BINDING_LEN crypto_hash_sha256_BYTES /* 32 */
+
+/* root_key = HKDF-SHA512(salt = 0^64, ikm = [pake_isk ||] 3DH || kem_secret,
+ * info = hybrid_info), where 3DH is deriveInteractive3dhSecret's output for
+ * the given role. binding = SHA-256(binding_input), and pq_healing_root =
+ * HKDF-SHA512(salt = PQ healing extract label, ikm = root_key, info = PQ
+ * healing root label || binding). pake_isk is the 64-byte CPace ISK in PIN
+ * mode and NULL otherwise. Returns 0, -1 on bad arguments and -2 if a peer
+ * key is of small order; on failure every output is zero. */
+int handshake_key_schedule(
+    uint8_t root_key[HANDSHAKE_KEY_LEN],
+    uint8_t pq_healing_root[HANDSHAKE_KEY_LEN],
+    uint8_t binding[HANDSHAKE_BINDING_LEN],
+    const uint8_t identity_sec[crypto_scalarmult_curve25519_SCALARBYTES],
+    const uint8_t peer_identity_pub[crypto_scalarmult_curve25519_BYTES],
+    const uint8_t ephemeral_sec[crypto_scalarmult_curve25519_SCALARBYTES],
+    const uint8_t peer_ephemeral_pub[crypto_scalarmult_curve25519_BYTES],
+    const unsigned int am_initiator, const uint8_t *pake_isk,
+    const uint8_t kem_secret[HANDSHAKE_KEM_SECRET_LEN],
+    const uint8_t *hybrid_info, const unsigned int HYBRID_INFO_LEN,
+    const uint8_t *binding_input, const unsigned int BINDING_INPUT_LEN);
+
+#endif
@@ -0,0 +1,160 @@
+import {
+  crypto_scalarmult_curve25519_BYTES,
+  crypto_scalarmult_curve25519_SCALARBYTES,
+} from "./interfaces";
+import { zeroFree } from "../utils/zeroFree";
+
+import type { LibCrypto } from "./libcrypto";
+
+const KEY_LEN = 32;
+const PAKE_ISK_LEN = 64;
+const KEM_SECRET_LEN = 32;
+const BINDING_LEN = 32;
+
+export interface HandshakeKeyScheduleParams {
+  identitySecret: Uint8Array;
+  peerIdentityPub: Uint8Array;
+  ephemeralSecret: Uint8Array;
+  peerEphemeralPub: Uint8Array;
+  amInitiator: boolean;
+  /** 64-byte CPace ISK in PIN mode, null otherwise. */
+  pakeIsk: Uint8Array | null;
+  kemSecret: Uint8Array;
+  /** Hybrid-root HKDF info: suite domain ‖ CI ‖ identities ‖ KEM transcript. */
+  hybridInfo: Uint8Array;
+  /** Public PQ-healing binding transcript, hashed with SHA-256 in C. */
+  bindingInput: Uint8Array;
+}
+
+export interface HandshakeKeys {
+  /** 32-byte hybrid root: ratchet seed and key-confirmation MAC key. */
+  rootKey: Uint8Array;
+  pqHealingRoot: Uint8Array;
+  pqHealingBinding: Uint8Array;
+}
+
+const assertLength = (label: string, bytes: Uint8Array, len: number): void => {
+  if (bytes.length !== len)
+    throw new Error(
+      `handshake key schedule: ${label} must be ${String(len)} bytes`,
+    );
+};
+
+/**
+ * The whole v4 handshake key schedule in one `handshake_key_schedule` call:
+ * interactive 3DH (as `deriveInteractive3dhSecret`), the hybrid combiner
+ * HKDF over [CPace ISK ‖] 3DH ‖ ML-KEM, and the PQ-healing binding and root.
+ * The DH outputs, 3DH secret, combiner IKM and PRKs never leave C; the staged
+ * secret inputs and the outputs' heap copies are zero-freed here.
+ */
+export const deriveHandshakeKeys = (
+  params: HandshakeKeyScheduleParams,
+  module: LibCrypto,
+): HandshakeKeys => {
+  const {
+    identitySecret,
+    peerIdentityPub,
+    ephemeralSecret,
+    peerEphemeralPub,
+    amInitiator,
+    pakeIsk,
+    kemSecret,
+    hybridInfo,
+    bindingInput,
+  } = params;
+
+  assertLength(
+    "identity secret",
+    identitySecret,
+    crypto_scalarmult_curve25519_SCALARBYTES,
+  );
+  assertLength(
+    "ephemeral secret",
+    ephemeralSecret,
+    crypto_scalarmult_curve25519_SCALARBYTES,
+  );
+  assertLength(
+    "peer identity pub",
+    peerIdentityPub,
+    crypto_scalarmult_curve25519_BYTES,
+  );
+  assertLength(
+    "peer ephemeral pub",
+    peerEphemeralPub,
+    crypto_scalarmult_curve25519_BYTES,
+  );
+  if (pakeIsk) assertLength("CPace ISK", pakeIsk, PAKE_ISK_LEN);
+  assertLength("ML-KEM shared secret", kemSecret, KEM_SECRET_LEN);
+
+  // identity sec ‖ ephemeral sec ‖ ML-KEM secret ‖ CPace ISK
+  const secretsLen = 2 * KEY_LEN + KEM_SECRET_LEN + PAKE_ISK_LEN;
+  const secretsPtr = module._malloc(secretsLen);
+  const publicsPtr = module._malloc(2 * crypto_scalarmult_curve25519_BYTES);
+  const outPtr = module._malloc(2 * KEY_LEN + BINDING_LEN);
+  const infoPtr = module._malloc(Math.max(hybridInfo.length, 1));
+  const bindingPtr = module._malloc(Math.max(bindingInput.length, 1));
+  const secrets = new Uint8Array(
+    module.wasmMemory.buffer,
+    secretsPtr,
+    secretsLen,
+  );
+  const out = new Uint8Array(
+    module.wasmMemory.buffer,
+    outPtr,
+    2 * KEY_LEN + BINDING_LEN,
+  );
+
+  try {
+    secrets.set(identitySecret, 0);
+    secrets.set(ephemeralSecret, KEY_LEN);
+    secrets.set(kemSecret, 2 * KEY_LEN);
+    if (pakeIsk) secrets.set(pakeIsk, 2 * KEY_LEN + KEM_SECRET_LEN);
+    const publics = new Uint8Array(
+      module.wasmMemory.buffer,
+      publicsPtr,
+      2 * crypto_scalarmult_curve25519_BYTES,
+    );
+    publics.set(peerIdentityPub, 0);
+    publics.set(peerEphemeralPub, crypto_scalarmult_curve25519_BYTES);
+    new Uint8Array(module.wasmMemory.buffer, infoPtr, hybridInfo.length).set(
+      hybridInfo,
+    );
+    new Uint8Array(
+      module.wasmMemory.buffer,
+      bindingPtr,
+      bindingInput.length,
+    ).set(bindingInput);
+
+    const r = module._handshake_key_schedule(
+      outPtr,
+      outPtr + KEY_LEN,
+      outPtr + 2 * KEY_LEN,
+      secretsPtr,
+      publicsPtr,
+      secretsPtr + KEY_LEN,
+      publicsPtr + crypto_scalarmult_curve25519_BYTES,
+      amInitiator ? 1 : 0,
+      pakeIsk ? secretsPtr + 2 * KEY_LEN + KEM_SECRET_LEN : 0,
+      secretsPtr + 2 * KEY_LEN,
+      infoPtr,
+      hybridInfo.length,
+      bindingPtr,
+      bindingInput.length,
+    );
+    if (r === -2)
+      throw new Error("handshake key schedule: peer key is of small order");
+    if (r !== 0) throw new Error("handshake key schedule failed");
+
+    return {
+      rootKey: out.slice(0, KEY_LEN),
+      pqHealingRoot: out.slice(KEY_LEN, 2 * KEY_LEN),
+      pqHealingBinding: out.slice(2 * KEY_LEN),
+    };
+  } finally {
+    zeroFree(module, secrets);
+    zeroFree(module, out);
+    module._free(publicsPtr);
+    module._free(infoPtr);
+    module._free(bindingPtr);
+  }
+};
@@ -12,7 +12,7 @@ import type { LibCrypto } from "./libcrypto";
  * HASH_WINDOW_BYTES slice at a time (O(1) memory — the whole file is never
  * resident) and feed each slice to the WASM streaming hash in
  * HASH_WASM_CHUNK_BYTES sub-chunks (the WASM heap buffer is tiny and fixed,
- * since the merkle module's memory cannot grow). The result is byte-identical
+ * so it fits a fixed-size module's memory). The result is byte-identical
  * to `crypto.subtle.digest("SHA-512", <whole file>)` (plain SHA-512, no domain
  * separation), so it drops in for the previous whole-file-in-RAM digest.
  *
@@ -1,4 +1,4 @@
-import { sign, verify } from "./ed25519";
+import { sign, verify, verifyBatch } from "./ed25519";
 import { IDENTITY_CROSS_SIGN_DOMAIN_BYTES } from "../utils/constants";
 
 import type { LibCrypto } from "./libcrypto";
@@ -40,3 +40,24 @@ export const verifyIdentityCrossSig = async (
   module?: LibCrypto,
 ): Promise<boolean> =>
   verify(identityCrossSignMessage(x25519Pub), crossSig, ed25519Pub, module);
+
+/**
+ * Verify many peers' cross-signatures in one batch (e.g. a room's roster on
+ * join). Results are in order and match `verifyIdentityCrossSig` per entry.
+ */
+export const verifyIdentityCrossSigs = async (
+  entries: readonly {
+    x25519Pub: Uint8Array;
+    crossSig: Uint8Array;
+    ed25519Pub: Uint8Array;
+  }[],
+  module?: LibCrypto,
+): Promise<boolean[]> =>
+  verifyBatch(
+    entries.map(({ x25519Pub, crossSig, ed25519Pub }) => ({
+      message: identityCrossSignMessage(x25519Pub),
+      signature: crossSig,
+      publicKey: ed25519Pub,
+    })),
+    module,
+  );
@@ -6,6 +6,26 @@ export const crypto_hash_sha512_BYTES = 64 * Uint8Array.BYTES_PER_ELEMENT;
 // (16) + uint8_t buf[128] (128) = 208 bytes; the JS side mallocs this for the
 // streaming-hash state passed to _sha512_init/update/final.
 export const crypto_hash_sha512_STATEBYTES = 208;
+// sizeof(merkle_accumulator) = uint64_t leaves_len (8) + 48 frontier nodes
+// (48 * 64) = 3080 bytes; sizeof(merkle_proof_cache) = root (64) + uint32_t
+// used (4) + 1024 slot depths (1024) + 1024 nodes (1024 * 64) = 66628 bytes.
+// Both are pinned by _Static_assert in merkle.h.
+export const merkle_accumulator_STATEBYTES = 3080;
+export const merkle_proof_cache_STATEBYTES = 66628;
+// sizeof(chunker_state) = crypto_hash_sha512_state (208) + uint32_t chunk_len
+// (4) + tail padding (4) = 216 bytes, pinned by _Static_assert in chunker.h.
+export const chunker_STATEBYTES = 216;
+// sizeof(ratchet_state) = two crypto_auth_hmacsha512_state chain pads
+// (2 * 416) + three uint64_t counters (24) + six 32-byte keys (192) + uint32_t
+// flags (4) + tail padding (4) = 1056 bytes, pinned by _Static_assert in
+// ratchet.h.
+export const ratchet_STATEBYTES = 1056;
+// sizeof(skipped_keys) = SipHash key (16) + three uint32_t (12) + two uint16_t
+// list ends (4) = 32 bytes, followed by CAPACITY slots of a 48-byte id, 32-byte
+// message key, two uint16_t links and uint32_t used = 88 bytes each; pinned by
+// _Static_assert in skipped_keys.h.
+export const skipped_keys_STATEBYTES = 32;
+export const skipped_keys_SLOTBYTES = 88;
 export const crypto_sign_ed25519_BYTES = 64 * Uint8Array.BYTES_PER_ELEMENT;
 export const crypto_sign_ed25519_SEEDBYTES = 32 * Uint8Array.BYTES_PER_ELEMENT;
 export const crypto_sign_ed25519_PUBLICKEYBYTES =
@@ -1,6 +1,8 @@
 #include <sodium.h>
 #include <stdlib.h>
 
+#include "./stats.h"
+
 int
 crypto_init(void)
 {
@@ -13,8 +15,19 @@ crypto_init_or_abort(void)
   if (crypto_init() != 0) abort();
 }
 
+#include "./pool.c"
 #include "./argon2.c"
 #include "./ed25519.c"
+#include "./ed25519_batch.c"
+#include "./sha512x4.c"
 #include "./merkle.c"
+#include "./chunker.c"
+#include "./chacha20poly1305x4.c"
 #include "./pake_ratchet.c"
+#include "./skipped_keys.c"
+#include "./ratchet.c"
+#include "./handshake.c"
+#include "./arena.c"
+#include "./slab.c"
 #include "./utils.c"
+#include "./stats.c"
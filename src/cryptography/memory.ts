@@ -1,13 +1,9 @@
 import {
   crypto_hash_sha512_BYTES,
-  crypto_sign_ed25519_PUBLICKEYBYTES,
-  crypto_sign_ed25519_SECRETKEYBYTES,
   crypto_sign_ed25519_SEEDBYTES,
-  crypto_sign_ed25519_BYTES,
-  crypto_scalarmult_curve25519_BYTES,
-  crypto_scalarmult_curve25519_SCALARBYTES,
   crypto_pwhash_argon2id_SALTBYTES,
 } from "./interfaces";
+import { SLAB_RESERVE_BYTES } from "./slab";
 
 /**
  * Webassembly Memory is separated into 64kb contiguous memory "pages".
@@ -40,94 +36,50 @@ const memoryLenToPages = (
   return ceil < minPages ? minPages : ceil;
 };
 
-const newKeyPairMemory = (): WebAssembly.Memory => {
-  const memoryLen =
-    (crypto_sign_ed25519_PUBLICKEYBYTES + crypto_sign_ed25519_SECRETKEYBYTES) *
-    Uint8Array.BYTES_PER_ELEMENT;
-  const pages = memoryLenToPages(memoryLen);
-
-  return new WebAssembly.Memory({ initial: pages, maximum: pages });
-};
-
-const identityX25519KeypairMemory = (): WebAssembly.Memory => {
-  const memoryLen =
-    (crypto_scalarmult_curve25519_BYTES +
-      crypto_scalarmult_curve25519_SCALARBYTES) *
-    Uint8Array.BYTES_PER_ELEMENT;
-  const pages = memoryLenToPages(memoryLen);
-
-  return new WebAssembly.Memory({ initial: pages, maximum: pages });
-};
-
-const keyPairFromSeedMemory = (): WebAssembly.Memory => {
-  const memoryLen =
-    (crypto_sign_ed25519_PUBLICKEYBYTES +
-      crypto_sign_ed25519_SECRETKEYBYTES +
-      crypto_sign_ed25519_SEEDBYTES) *
-    Uint8Array.BYTES_PER_ELEMENT;
-  const pages = memoryLenToPages(memoryLen);
-
-  return new WebAssembly.Memory({ initial: pages, maximum: pages });
-};
-
-const keyPairFromSecretKeyMemory = (): WebAssembly.Memory => {
-  const memoryLen =
-    (crypto_sign_ed25519_PUBLICKEYBYTES + crypto_sign_ed25519_SECRETKEYBYTES) *
-    Uint8Array.BYTES_PER_ELEMENT;
-  const pages = memoryLenToPages(memoryLen);
-
-  return new WebAssembly.Memory({ initial: pages, maximum: pages });
-};
-
-const signMemory = (messageLen: number): WebAssembly.Memory => {
-  const memoryLen =
-    (messageLen +
-      crypto_sign_ed25519_BYTES +
-      crypto_sign_ed25519_SECRETKEYBYTES +
-      crypto_hash_sha512_BYTES) *
-    Uint8Array.BYTES_PER_ELEMENT;
-  const pages = memoryLenToPages(memoryLen);
-
-  return new WebAssembly.Memory({ initial: pages, maximum: pages });
-};
-
-const verifyMemory = (messageLen: number): WebAssembly.Memory => {
-  const memoryLen =
-    (messageLen +
-      crypto_sign_ed25519_BYTES +
-      crypto_sign_ed25519_PUBLICKEYBYTES) *
-    Uint8Array.BYTES_PER_ELEMENT;
-  const pages = memoryLenToPages(memoryLen);
-
-  return new WebAssembly.Memory({ initial: pages, maximum: pages });
-};
-
 /**
  * Protocol-v3 crypto runs on a fixed 2 MiB heap. Chunk AEAD allocates and frees
- * only transient plaintext/ciphertext/AAD buffers; handshake and ratchet
- * primitives use the same bounded profile. Fixed growth makes allocator
- * mistakes fail closed.
+ * only transient plaintext/ciphertext/AAD buffers; a receive module also holds
+ * one ingress ring (INGRESS_RING_SLOTS wire cells, ~256 KiB). Handshake and
+ * ratchet primitives use the same bounded profile. Fixed growth makes allocator
+ * mistakes fail closed. The module's secure slab (slab.ts), which serves those
+ * transient buffers, is reserved on top, as are `reserveBytes` of long-lived
+ * state a caller keeps in the module (a receive edge's proof caches).
  */
-const protocolV3Memory = (): WebAssembly.Memory => {
-  const pages = memoryLenToPages(0);
+const protocolV3Memory = (reserveBytes = 0): WebAssembly.Memory => {
+  const pages =
+    memoryLenToPages(0) +
+    Math.ceil((SLAB_RESERVE_BYTES + reserveBytes) / (64 * 1024));
   return new WebAssembly.Memory({ initial: pages, maximum: pages });
 };
 
-const getMerkleRootMemory = (leavesLen: number): WebAssembly.Memory => {
-  const memoryLen = (2 * leavesLen + 3) * crypto_hash_sha512_BYTES;
-  const memoryPages = memoryLenToPages(memoryLen);
-
-  return new WebAssembly.Memory({
-    initial: memoryPages,
-    maximum: memoryPages,
+/**
+ * The realm's shared instance (sharedModule.ts) starts at the same 2 MiB and
+ * may grow up to MAXIMUM_MEMORY (1 GiB) when a large Merkle tree or batch
+ * spills past its scratch arena. Growth never shrinks, so Argon2's tens of MiB
+ * keep their own operation-sized memories, except a multi-lane Argon2id on the
+ * threaded module, whose lanes need its workers (mnemonic.ts). `shared` is for the threaded
+ * artifact (wasmLoaderThreaded), whose memory has to be a SharedArrayBuffer;
+ * its worker stacks come out of the same room to grow.
+ */
+const sharedMemory = (shared = false): WebAssembly.Memory =>
+  new WebAssembly.Memory({
+    initial: memoryLenToPages(0),
+    maximum: 16384,
+    shared,
   });
-};
 
+/**
+ * Also sized for a persistent Merkle tree (createMerkleTree): its staged leaves
+ * plus every level, which is at most 2n nodes and one promoted node per level.
+ */
 const getMerkleProofMemory = (leavesLen: number): WebAssembly.Memory => {
-  const memoryLen =
+  const memoryLen = Math.max(
     leavesLen * crypto_hash_sha512_BYTES +
-    leavesLen * (crypto_hash_sha512_BYTES + 1) +
-    3 * crypto_hash_sha512_BYTES;
+      leavesLen * (crypto_hash_sha512_BYTES + 1) +
+      3 * crypto_hash_sha512_BYTES,
+    (3 * leavesLen + 64) * crypto_hash_sha512_BYTES +
+      64 * (crypto_hash_sha512_BYTES + 1),
+  );
   const memoryPages = memoryLenToPages(memoryLen);
 
   return new WebAssembly.Memory({
@@ -136,22 +88,34 @@ const getMerkleProofMemory = (leavesLen: number): WebAssembly.Memory => {
   });
 };
 
-const verifyMerkleProofMemory = (proofLen: number): WebAssembly.Memory => {
+const argon2Memory = (mnemonicLen: number): WebAssembly.Memory => {
   const memoryLen =
-    proofLen * Uint8Array.BYTES_PER_ELEMENT + 4 * crypto_hash_sha512_BYTES;
-
-  const memoryPages = memoryLenToPages(memoryLen);
+    (75 * 1024 * 1024 +
+      mnemonicLen +
+      crypto_sign_ed25519_SEEDBYTES +
+      crypto_pwhash_argon2id_SALTBYTES) *
+    Uint8Array.BYTES_PER_ELEMENT;
+  const pages = memoryLenToPages(memoryLen);
 
-  return new WebAssembly.Memory({
-    initial: memoryPages,
-    maximum: memoryPages,
-  });
+  return new WebAssembly.Memory({ initial: pages, maximum: pages });
 };
 
-const argon2Memory = (mnemonicLen: number): WebAssembly.Memory => {
+/**
+ * Argon2id with a caller-chosen profile: argon2id_memory_bytes(m, p) of block
+ * memory (m KiB rounded down to a multiple of 4p blocks, plus 63 bytes of
+ * alignment slack) next to the password, salt and output.
+ */
+const argon2idMemory = (
+  memLimitKiB: number,
+  parallelism: number,
+  passwordLen: number,
+): WebAssembly.Memory => {
+  const blocks =
+    Math.floor(memLimitKiB / (4 * parallelism)) * 4 * parallelism;
   const memoryLen =
-    (75 * 1024 * 1024 +
-      mnemonicLen +
+    (blocks * 1024 +
+      63 +
+      passwordLen +
       crypto_sign_ed25519_SEEDBYTES +
       crypto_pwhash_argon2id_SALTBYTES) *
     Uint8Array.BYTES_PER_ELEMENT;
@@ -161,15 +125,9 @@ const argon2Memory = (mnemonicLen: number): WebAssembly.Memory => {
 };
 
 export default {
-  newKeyPairMemory,
-  identityX25519KeypairMemory,
-  keyPairFromSeedMemory,
-  keyPairFromSecretKeyMemory,
-  signMemory,
-  verifyMemory,
   protocolV3Memory,
-  getMerkleRootMemory,
+  sharedMemory,
   getMerkleProofMemory,
-  verifyMerkleProofMemory,
   argon2Memory,
+  argon2idMemory,
 };
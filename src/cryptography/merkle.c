@@ -6,6 +6,7 @@
  * leaf. Lone odd nodes are PROMOTED unchanged to the next level instead of being
  * hashed with themselves (H(x||x)), which otherwise lets distinct leaf multisets
  * collide to the same root. */
+#define MERKLE_LEAF_DOMAIN 0x00
 #define MERKLE_NODE_DOMAIN 0x01
 
 static int
@@ -21,38 +22,98 @@ hash_node(uint8_t out[crypto_hash_sha512_BYTES],
   return crypto_hash_sha512(out, buf, sizeof(buf));
 }
 
+/* Input bytes per pool task (pool.c) when a batch is spread over threads:
+ * about 128 tree nodes or four 64 KiB leaves, enough that hashing outweighs
+ * taking the task. */
+#define MERKLE_POOL_GRAIN_BYTES (16U * 1024U)
+
+typedef struct
+{
+  size_t count;
+  size_t len;
+  size_t grain;
+  uint8_t prefix;
+  const uint8_t *in;
+  uint8_t *out;
+} merkle_hash_job;
+
+static int
+merkle_hash_task(void *ctx, const uint32_t index)
+{
+  const merkle_hash_job *job = ctx;
+  const size_t first = (size_t)index * job->grain;
+  const size_t n
+      = job->count - first < job->grain ? job->count - first : job->grain;
+
+  return sha512_prefixed_batch(n, job->len, job->prefix,
+                               &job->in[first * job->len],
+                               &job->out[first * crypto_hash_sha512_BYTES]);
+}
+
+/* sha512_prefixed_batch over the pool, in tasks of a whole number of
+ * four-lane groups. The tasks finish in any order, so out must not overlap
+ * in; the in-place fold of get_merkle_root stays on sha512_prefixed_batch
+ * (getMerkleRoot in merkle.ts uses merkle_tree_build on a threaded module). */
+static int
+sha512_prefixed_batch_pooled(const size_t COUNT, const size_t LEN,
+                             const uint8_t prefix, const uint8_t *in,
+                             uint8_t *out)
+{
+  size_t grain = MERKLE_POOL_GRAIN_BYTES / (LEN + 1);
+
+  grain -= grain % SHA512X4_LANES;
+  if (grain < SHA512X4_LANES) grain = SHA512X4_LANES;
+  if (COUNT <= grain || pool_threads() == 1)
+    return sha512_prefixed_batch(COUNT, LEN, prefix, in, out);
+
+  merkle_hash_job job
+      = { .count = COUNT, .len = LEN, .grain = grain, .prefix = prefix,
+          .in = in, .out = out };
+
+  return pool_run(merkle_hash_task, &job,
+                  (uint32_t)((COUNT + grain - 1) / grain));
+}
+
+/* Hashes a whole level into its parent level: every pair is independent and
+ * fixed-size (0x01 || L || R), so they go through the four-lane SHA-512 kernel
+ * in groups of four, spread over the pool when parent is a separate level.
+ * A lone odd node is promoted unchanged. parent may equal level (in-place
+ * fold). */
+static int
+hash_level(uint8_t *parent, const uint8_t *level, const size_t width)
+{
+  const size_t pairs = width / 2;
+  const int res
+      = parent == level
+            ? sha512_prefixed_batch(pairs, 2 * crypto_hash_sha512_BYTES,
+                                    MERKLE_NODE_DOMAIN, level, parent)
+            : sha512_prefixed_batch_pooled(pairs,
+                                           2 * crypto_hash_sha512_BYTES,
+                                           MERKLE_NODE_DOMAIN, level, parent);
+
+  if (res != 0) return -1;
+
+  if (width % 2 != 0)
+  {
+    memcpy(&parent[pairs * crypto_hash_sha512_BYTES],
+           &level[(width - 1) * crypto_hash_sha512_BYTES],
+           crypto_hash_sha512_BYTES);
+  }
+
+  return 0;
+}
+
 int
 get_merkle_root(const unsigned int LEAVES_LEN,
                 uint8_t leaves_hashed[LEAVES_LEN * crypto_hash_sha512_BYTES],
                 uint8_t root[crypto_hash_sha512_BYTES])
 {
-  size_t i, j;
-  int res;
   unsigned int leaves = LEAVES_LEN;
 
-  // For every branch level.
+  // For every branch level, writing the parents in place.
   while (leaves > 1)
   {
-    bool odd_leaves = leaves % 2 != 0;
-
-    // For every two leaves (writing the parent in place at index j <= i).
-    for (i = 0, j = 0; i < leaves; i += 2, j++)
-    {
-      if (odd_leaves && i + 1 == leaves)
-      {
-        // Lone odd node: promote unchanged (no self-hash).
-        memcpy(&leaves_hashed[j * crypto_hash_sha512_BYTES],
-               &leaves_hashed[i * crypto_hash_sha512_BYTES],
-               crypto_hash_sha512_BYTES);
-      }
-      else
-      {
-        res = hash_node(&leaves_hashed[j * crypto_hash_sha512_BYTES],
-                        &leaves_hashed[i * crypto_hash_sha512_BYTES],
-                        &leaves_hashed[(i + 1) * crypto_hash_sha512_BYTES]);
-        if (res != 0) return -2;
-      }
-    }
+    if (hash_level(leaves_hashed, leaves_hashed, leaves) != 0) return -2;
 
     leaves = (leaves + 1) / 2; // ceil
   }
@@ -62,6 +123,24 @@ get_merkle_root(const unsigned int LEAVES_LEN,
   return 0;
 }
 
+/* Leaf hashes SHA-512(0x00 || chunk) for COUNT contiguous chunks of
+ * CHUNK_BYTES each, four at a time through the four-lane kernel and spread
+ * over the pool on the threaded build. */
+int
+merkle_leaf_hash_batch(const unsigned int COUNT, const unsigned int CHUNK_BYTES,
+                       const uint8_t chunks[COUNT * CHUNK_BYTES],
+                       uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES])
+{
+  if (COUNT == 0) return 0;
+  if (!chunks || !leaves_hashed) return -1;
+
+  return sha512_prefixed_batch_pooled(COUNT, CHUNK_BYTES, MERKLE_LEAF_DOMAIN,
+                                      chunks, leaves_hashed)
+                 == 0
+             ? 0
+             : -2;
+}
+
 // The result is the proof length in bytes.
 int
 get_merkle_proof(const unsigned int LEAVES_LEN,
@@ -70,7 +149,7 @@ get_merkle_proof(const unsigned int LEAVES_LEN,
                  uint8_t proof[LEAVES_LEN * (crypto_hash_sha512_BYTES + 1)])
 {
   int res, index = -1;
-  size_t i, j, k;
+  size_t i, k;
 
   for (i = 0; i < LEAVES_LEN; i++)
   {
@@ -94,51 +173,25 @@ get_merkle_proof(const unsigned int LEAVES_LEN,
   {
     bool odd_leaves = leaves % 2 != 0;
 
-    for (i = 0, j = 0; i < leaves; i += 2, j++)
+    // A lone odd node is promoted unchanged, so it contributes no artifact.
+    if (!(odd_leaves && element_of_interest + 1 == leaves))
     {
-      if (odd_leaves && i + 1 == leaves)
-      {
-        // Lone odd node: promoted unchanged, so it contributes no artifact.
-        if (i == element_of_interest) element_of_interest = j;
+      size_t sibling = element_of_interest ^ 1;
 
-        memcpy(&leaves_hashed[j * crypto_hash_sha512_BYTES],
-               &leaves_hashed[i * crypto_hash_sha512_BYTES],
-               crypto_hash_sha512_BYTES);
-      }
-      else
-      {
-        if (i == element_of_interest)
-        {
-          // Sibling is on the right.
-          memcpy(&proof[k * (crypto_hash_sha512_BYTES + 1)],
-                 &leaves_hashed[(i + 1) * crypto_hash_sha512_BYTES],
-                 crypto_hash_sha512_BYTES);
-          proof[k * (crypto_hash_sha512_BYTES + 1) + crypto_hash_sha512_BYTES]
-              = 1;
-
-          k++;
-          element_of_interest = j;
-        }
-        else if (i + 1 == element_of_interest)
-        {
-          // Sibling is on the left.
-          memcpy(&proof[k * (crypto_hash_sha512_BYTES + 1)],
-                 &leaves_hashed[i * crypto_hash_sha512_BYTES],
-                 crypto_hash_sha512_BYTES);
-          proof[k * (crypto_hash_sha512_BYTES + 1) + crypto_hash_sha512_BYTES]
-              = 0;
+      memcpy(&proof[k * (crypto_hash_sha512_BYTES + 1)],
+             &leaves_hashed[sibling * crypto_hash_sha512_BYTES],
+             crypto_hash_sha512_BYTES);
+      // 1 = sibling is on the right, 0 = on the left.
+      proof[k * (crypto_hash_sha512_BYTES + 1) + crypto_hash_sha512_BYTES]
+          = sibling > element_of_interest ? 1 : 0;
 
-          k++;
-          element_of_interest = j;
-        }
-
-        res = hash_node(&leaves_hashed[j * crypto_hash_sha512_BYTES],
-                        &leaves_hashed[i * crypto_hash_sha512_BYTES],
-                        &leaves_hashed[(i + 1) * crypto_hash_sha512_BYTES]);
-        if (res != 0) return -3;
-      }
+      k++;
     }
 
+    element_of_interest /= 2;
+
+    if (hash_level(leaves_hashed, leaves_hashed, leaves) != 0) return -3;
+
     leaves = (leaves + 1) / 2; // ceil
   }
 
@@ -237,3 +290,615 @@ verify_merkle_proof(
 
   return 0;
 }
+
+/* ---------------- Persistent tree ----------------
+ * Same shape as get_merkle_root (pairwise 0x01 node hashes, lone odd node
+ * promoted unchanged), but every level is kept:
+ *   nodes = level0 (leaves) || level1 || ... || root.
+ * A level of width w starts right after the previous one and its parent level
+ * has width ceil(w / 2), so level offsets are recomputed on the fly instead of
+ * being stored. */
+
+static size_t
+merkle_tree_nodes_len(const unsigned int LEAVES_LEN)
+{
+  size_t nodes = 0;
+  size_t width = LEAVES_LEN;
+
+  while (width > 1)
+  {
+    nodes += width;
+    width = (width + 1) / 2;
+  }
+
+  return nodes + 1; // root
+}
+
+// Bytes JS must allocate for a tree of LEAVES_LEN leaves; 0 if unsupported.
+size_t
+merkle_tree_bytes(const unsigned int LEAVES_LEN)
+{
+  if (LEAVES_LEN == 0) return 0;
+
+  uint64_t bytes = (uint64_t)merkle_tree_nodes_len(LEAVES_LEN)
+                       * crypto_hash_sha512_BYTES
+                   + sizeof(merkle_tree);
+  if (bytes > INT32_MAX) return 0;
+
+  return (size_t)bytes;
+}
+
+int
+merkle_tree_build(
+    merkle_tree *tree, const unsigned int LEAVES_LEN,
+    const uint8_t leaves_hashed[LEAVES_LEN * crypto_hash_sha512_BYTES])
+{
+  if (!tree || !leaves_hashed || merkle_tree_bytes(LEAVES_LEN) == 0) return -1;
+
+  size_t width = LEAVES_LEN;
+  uint8_t *level = tree->nodes;
+
+  tree->leaves_len = LEAVES_LEN;
+  tree->nodes_len = (uint32_t)merkle_tree_nodes_len(LEAVES_LEN);
+  memcpy(level, leaves_hashed, width * crypto_hash_sha512_BYTES);
+
+  while (width > 1)
+  {
+    uint8_t *parent = level + width * crypto_hash_sha512_BYTES;
+
+    if (hash_level(parent, level, width) != 0) return -2;
+
+    level = parent;
+    width = (width + 1) / 2;
+  }
+
+  return 0;
+}
+
+int
+merkle_tree_root(const merkle_tree *tree,
+                 uint8_t root[crypto_hash_sha512_BYTES])
+{
+  if (!tree || !root || tree->nodes_len == 0) return -1;
+
+  memcpy(root,
+         &tree->nodes[(size_t)(tree->nodes_len - 1) * crypto_hash_sha512_BYTES],
+         crypto_hash_sha512_BYTES);
+
+  return 0;
+}
+
+/* Proof for the leaf at `index`, byte-identical to get_merkle_proof for the
+ * same tree: one (sibling || position) artifact per level where the node is
+ * not a promoted lone odd node, position 1 = sibling on the right. `proof`
+ * must hold ceil(log2(leaves_len)) artifacts. The result is the proof length
+ * in bytes. */
+int
+merkle_tree_proof(const merkle_tree *tree, const unsigned int index,
+                  uint8_t *proof)
+{
+  if (!tree || !proof) return -1;
+  if (index >= tree->leaves_len) return -2;
+
+  size_t k = 0;
+  size_t node = index;
+  size_t width = tree->leaves_len;
+  const uint8_t *level = tree->nodes;
+
+  while (width > 1)
+  {
+    if (!(width % 2 != 0 && node + 1 == width))
+    {
+      size_t sibling = node ^ 1;
+
+      memcpy(&proof[k * (crypto_hash_sha512_BYTES + 1)],
+             &level[sibling * crypto_hash_sha512_BYTES],
+             crypto_hash_sha512_BYTES);
+      proof[k * (crypto_hash_sha512_BYTES + 1) + crypto_hash_sha512_BYTES]
+          = sibling > node ? 1 : 0;
+      k++;
+    }
+
+    level += width * crypto_hash_sha512_BYTES;
+    node /= 2;
+    width = (width + 1) / 2;
+  }
+
+  return k * (crypto_hash_sha512_BYTES + 1);
+}
+
+/* ---------------- Append-only accumulator ----------------
+ * Pairing left to right with lone odd nodes promoted gives, for any n, the
+ * perfect subtrees of n's binary decomposition (largest first), folded right
+ * to left: root = H(P_k, H(P_j, ... P_0)). frontier[h] holds the root of the
+ * pending perfect subtree of 2^h leaves iff bit h of leaves_len is set, so an
+ * append is a binary-counter carry and the root matches get_merkle_root
+ * exactly without ever holding the leaves. */
+
+int
+merkle_accumulator_init(merkle_accumulator *acc)
+{
+  if (!acc) return -1;
+
+  sodium_memzero(acc, sizeof(*acc));
+
+  return 0;
+}
+
+int
+merkle_accumulator_append(merkle_accumulator *acc,
+                          const uint8_t leaf_hash[crypto_hash_sha512_BYTES])
+{
+  if (!acc || !leaf_hash) return -1;
+  if (acc->leaves_len >= (1ULL << MERKLE_ACCUMULATOR_MAX_HEIGHT) - 1)
+    return -2;
+
+  size_t h;
+  uint8_t carry[crypto_hash_sha512_BYTES];
+  memcpy(carry, leaf_hash, crypto_hash_sha512_BYTES);
+
+  for (h = 0; (acc->leaves_len >> h) & 1; h++)
+  {
+    if (hash_node(carry, &acc->frontier[h * crypto_hash_sha512_BYTES], carry)
+        != 0)
+      return -3;
+  }
+
+  memcpy(&acc->frontier[h * crypto_hash_sha512_BYTES], carry,
+         crypto_hash_sha512_BYTES);
+  acc->leaves_len++;
+
+  return 0;
+}
+
+// Non-destructive: more leaves may still be appended afterwards.
+int
+merkle_accumulator_root(const merkle_accumulator *acc,
+                        uint8_t root[crypto_hash_sha512_BYTES])
+{
+  if (!acc || !root) return -1;
+  if (acc->leaves_len == 0) return -2;
+
+  size_t h;
+  bool folded = false;
+
+  for (h = 0; h < MERKLE_ACCUMULATOR_MAX_HEIGHT; h++)
+  {
+    if (!((acc->leaves_len >> h) & 1)) continue;
+
+    if (!folded)
+    {
+      memcpy(root, &acc->frontier[h * crypto_hash_sha512_BYTES],
+             crypto_hash_sha512_BYTES);
+      folded = true;
+    }
+    else if (hash_node(root, &acc->frontier[h * crypto_hash_sha512_BYTES],
+                       root)
+             != 0)
+    {
+      return -3;
+    }
+  }
+
+  return 0;
+}
+
+/* ---------------- Receive-side proof cache ----------------
+ * Nodes are stored with their depth below the root, counted in proof artifacts
+ * (a node's path to the root is unique, so this is the same from any leaf).
+ * Only nodes within MERKLE_PROOF_CACHE_DEPTH of the root are kept: those are
+ * the ones shared by many leaves. A fold that reaches a cached node stops
+ * there — that node is already known to hash up to the root, and reaching it
+ * from a different path would be a SHA-512 collision. */
+
+static size_t
+merkle_proof_cache_slot(const uint8_t node[crypto_hash_sha512_BYTES])
+{
+  uint32_t h = (uint32_t)node[0] | ((uint32_t)node[1] << 8)
+               | ((uint32_t)node[2] << 16) | ((uint32_t)node[3] << 24);
+
+  return h % MERKLE_PROOF_CACHE_SLOTS;
+}
+
+// Returns the cached depth of `node`, or 0 if it is not cached.
+static unsigned int
+merkle_proof_cache_lookup(const merkle_proof_cache *cache,
+                          const uint8_t node[crypto_hash_sha512_BYTES])
+{
+  size_t i, slot = merkle_proof_cache_slot(node);
+
+  for (i = 0; i < MERKLE_PROOF_CACHE_SLOTS; i++)
+  {
+    if (cache->depth[slot] == 0) return 0;
+    if (memcmp(&cache->nodes[slot * crypto_hash_sha512_BYTES], node,
+               crypto_hash_sha512_BYTES)
+        == 0)
+      return cache->depth[slot];
+
+    slot = (slot + 1) % MERKLE_PROOF_CACHE_SLOTS;
+  }
+
+  return 0;
+}
+
+static void
+merkle_proof_cache_insert(merkle_proof_cache *cache,
+                          const uint8_t node[crypto_hash_sha512_BYTES],
+                          unsigned int depth)
+{
+  // Keep probe chains short: a full table only stops caching, never verifying.
+  if (cache->used >= MERKLE_PROOF_CACHE_SLOTS * 3 / 4) return;
+
+  size_t slot = merkle_proof_cache_slot(node);
+
+  while (cache->depth[slot] != 0)
+  {
+    if (memcmp(&cache->nodes[slot * crypto_hash_sha512_BYTES], node,
+               crypto_hash_sha512_BYTES)
+        == 0)
+      return;
+
+    slot = (slot + 1) % MERKLE_PROOF_CACHE_SLOTS;
+  }
+
+  memcpy(&cache->nodes[slot * crypto_hash_sha512_BYTES], node,
+         crypto_hash_sha512_BYTES);
+  cache->depth[slot] = (uint8_t)depth;
+  cache->used++;
+}
+
+int
+merkle_proof_cache_init(merkle_proof_cache *cache,
+                        const uint8_t root[crypto_hash_sha512_BYTES])
+{
+  if (!cache || !root) return -1;
+
+  sodium_memzero(cache, sizeof(*cache));
+  memcpy(cache->root, root, crypto_hash_sha512_BYTES);
+
+  return 0;
+}
+
+/* Same contract as verify_merkle_proof (0 = included, 1 = not included,
+ * -3 = bad position byte, -4 = hash failure), but against cache->root and
+ * without rehashing any already-verified upper node. element_hash is not
+ * modified. */
+int
+merkle_proof_cache_verify(
+    merkle_proof_cache *cache, const unsigned int PROOF_ARTIFACTS_LEN,
+    const uint8_t element_hash[crypto_hash_sha512_BYTES],
+    const uint8_t proof[PROOF_ARTIFACTS_LEN * (crypto_hash_sha512_BYTES + 1)])
+{
+  if (!cache || !element_hash || !proof) return -1;
+
+  // Single-leaf tree: root == element (proof carries the element hash).
+  if (PROOF_ARTIFACTS_LEN == 1
+      && memcmp(cache->root, element_hash, crypto_hash_sha512_BYTES) == 0)
+  {
+    return 0;
+  }
+
+  if (PROOF_ARTIFACTS_LEN > MERKLE_ACCUMULATOR_MAX_HEIGHT) return 1;
+
+  size_t i;
+  unsigned int position, top_depth = 0;
+  uint8_t path[MERKLE_ACCUMULATOR_MAX_HEIGHT][crypto_hash_sha512_BYTES];
+  const uint8_t *node = element_hash;
+
+  for (i = 0; i < PROOF_ARTIFACTS_LEN; i++)
+  {
+    position
+        = proof[i * (crypto_hash_sha512_BYTES + 1) + crypto_hash_sha512_BYTES];
+    if (position != 0 && position != 1) return -3;
+  }
+
+  for (i = 0; i < PROOF_ARTIFACTS_LEN; i++)
+  {
+    if (i > 0 && (top_depth = merkle_proof_cache_lookup(cache, node)) != 0)
+      break;
+
+    position
+        = proof[i * (crypto_hash_sha512_BYTES + 1) + crypto_hash_sha512_BYTES];
+    if ((position == 0
+             ? hash_node(path[i], &proof[i * (crypto_hash_sha512_BYTES + 1)],
+                         node)
+             : hash_node(path[i], node,
+                         &proof[i * (crypto_hash_sha512_BYTES + 1)]))
+        != 0)
+      return -4;
+
+    node = path[i];
+  }
+
+  // path[0..i) are the computed nodes; node == path[i - 1].
+  if (top_depth == 0)
+  {
+    if (memcmp(node, cache->root, crypto_hash_sha512_BYTES) != 0) return 1;
+  }
+
+  /* Depth of path[j]: the root sits at depth 0, a cached node at its stored
+   * depth, and each step down the path adds one. */
+  size_t j, computed = i;
+  for (j = 0; j < computed; j++)
+  {
+    unsigned int depth = top_depth + (unsigned int)(computed - 1 - j);
+    if (depth >= 1 && depth <= MERKLE_PROOF_CACHE_DEPTH)
+      merkle_proof_cache_insert(cache, path[j], depth);
+  }
+
+  return 0;
+}
+
+/* ---------------- Range multiproof ----------------
+ * One proof for the contiguous leaves [first, first + count). Walking up the
+ * tree, the covered nodes stay contiguous; at each level only the left
+ * neighbour of an odd-positioned first node and the right neighbour of an
+ * even-positioned last node are outside the range (a last node without a right
+ * neighbour is a promoted lone odd node). Those siblings are emitted bottom-up,
+ * left before right, as bare 64-byte hashes: their positions follow from
+ * (leaves_len, first, count), so no position bytes are carried and upper
+ * siblings shared by the whole range appear once. */
+
+static bool
+merkle_range_valid(const unsigned int LEAVES_LEN, const unsigned int first,
+                   const unsigned int count)
+{
+  return LEAVES_LEN > 0 && count > 0 && first < LEAVES_LEN
+         && count <= LEAVES_LEN - first;
+}
+
+// Proof size in bytes for the range, or 0 if the range is invalid.
+size_t
+merkle_range_proof_bytes(const unsigned int LEAVES_LEN,
+                         const unsigned int first, const unsigned int count)
+{
+  if (!merkle_range_valid(LEAVES_LEN, first, count)) return 0;
+
+  size_t siblings = 0;
+  size_t lo = first, hi = (size_t)first + count - 1;
+  size_t width = LEAVES_LEN;
+
+  while (width > 1)
+  {
+    if (lo % 2 != 0) siblings++;
+    if (hi % 2 == 0 && hi + 1 < width) siblings++;
+
+    lo /= 2;
+    hi /= 2;
+    width = (width + 1) / 2;
+  }
+
+  return siblings * crypto_hash_sha512_BYTES;
+}
+
+/* Writes the range proof into `proof` (merkle_range_proof_bytes long) and
+ * returns its length in bytes; -1 = bad args, -2 = range outside the tree. */
+int
+merkle_tree_range_proof(const merkle_tree *tree, const unsigned int first,
+                        const unsigned int count, uint8_t *proof)
+{
+  if (!tree || !proof) return -1;
+  if (!merkle_range_valid(tree->leaves_len, first, count)) return -2;
+
+  size_t k = 0;
+  size_t lo = first, hi = (size_t)first + count - 1;
+  size_t width = tree->leaves_len;
+  const uint8_t *level = tree->nodes;
+
+  while (width > 1)
+  {
+    if (lo % 2 != 0)
+    {
+      memcpy(&proof[k++ * crypto_hash_sha512_BYTES],
+             &level[(lo - 1) * crypto_hash_sha512_BYTES],
+             crypto_hash_sha512_BYTES);
+    }
+    if (hi % 2 == 0 && hi + 1 < width)
+    {
+      memcpy(&proof[k++ * crypto_hash_sha512_BYTES],
+             &level[(hi + 1) * crypto_hash_sha512_BYTES],
+             crypto_hash_sha512_BYTES);
+    }
+
+    level += width * crypto_hash_sha512_BYTES;
+    lo /= 2;
+    hi /= 2;
+    width = (width + 1) / 2;
+  }
+
+  return k * crypto_hash_sha512_BYTES;
+}
+
+/* Folds the COUNT leaf hashes of [first, first + COUNT) with the range proof
+ * and compares the result with `root`. Like verify_merkle_proof it works in
+ * place: leaves_hashed is overwritten with intermediate nodes.
+ * 0 = all leaves included, 1 = not included, -1 = bad args,
+ * -2 = proof length does not match the range, -4 = hash failure. */
+int
+verify_merkle_range_proof(
+    const unsigned int LEAVES_LEN, const unsigned int first,
+    const unsigned int COUNT,
+    uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES],
+    const uint8_t root[crypto_hash_sha512_BYTES],
+    const unsigned int PROOF_BYTES, const uint8_t *proof)
+{
+  if (!leaves_hashed || !root || (PROOF_BYTES > 0 && !proof)) return -1;
+  if (!merkle_range_valid(LEAVES_LEN, first, COUNT)) return -1;
+  if (PROOF_BYTES != merkle_range_proof_bytes(LEAVES_LEN, first, COUNT))
+    return -2;
+
+  size_t i, j, k = 0;
+  size_t lo = first, hi = (size_t)first + COUNT - 1;
+  size_t width = LEAVES_LEN;
+  uint8_t *nodes = leaves_hashed; // nodes[0..hi - lo] cover [lo, hi]
+
+  while (width > 1)
+  {
+    size_t covered = hi - lo + 1;
+
+    i = 0;
+    j = 0;
+    if (lo % 2 != 0)
+    {
+      if (hash_node(&nodes[0], &proof[k++ * crypto_hash_sha512_BYTES],
+                    &nodes[0])
+          != 0)
+        return -4;
+      i = 1;
+      j = 1;
+    }
+
+    for (; i < covered; i += 2, j++)
+    {
+      if (i + 1 < covered)
+      {
+        if (hash_node(&nodes[j * crypto_hash_sha512_BYTES],
+                      &nodes[i * crypto_hash_sha512_BYTES],
+                      &nodes[(i + 1) * crypto_hash_sha512_BYTES])
+            != 0)
+          return -4;
+      }
+      else if (hi + 1 < width)
+      {
+        if (hash_node(&nodes[j * crypto_hash_sha512_BYTES],
+                      &nodes[i * crypto_hash_sha512_BYTES],
+                      &proof[k++ * crypto_hash_sha512_BYTES])
+            != 0)
+          return -4;
+      }
+      else
+      {
+        // Lone odd node: promoted unchanged.
+        memmove(&nodes[j * crypto_hash_sha512_BYTES],
+                &nodes[i * crypto_hash_sha512_BYTES], crypto_hash_sha512_BYTES);
+      }
+    }
+
+    lo /= 2;
+    hi /= 2;
+    width = (width + 1) / 2;
+  }
+
+  return memcmp(nodes, root, crypto_hash_sha512_BYTES) == 0 ? 0 : 1;
+}
+
+/* Chunk receipts: SHA-512(domain || root || u64be index || leaf) for one chunk
+ * and SHA-512(domain || root || u64be first || u64be count || leaves) for a
+ * contiguous run. The domains are NUL-terminated exactly like
+ * CHUNK_RECEIPT_DOMAIN and CHUNK_RANGE_RECEIPT_DOMAIN in receiptToken.ts. */
+static const uint8_t chunk_receipt_domain[]
+    = "p2party/protocol-v3/chunk-receipt/v1";
+static const uint8_t chunk_range_receipt_domain[]
+    = "p2party/protocol-v4/chunk-range-receipt/v1";
+
+#define CHUNK_RECEIPT_ROW_LEN                                                  \
+  (sizeof chunk_receipt_domain - 1 + crypto_hash_sha512_BYTES + 8              \
+   + crypto_hash_sha512_BYTES)
+
+static void
+receipt_store64_be(uint8_t dst[8], const uint64_t v)
+{
+  size_t i;
+
+  for (i = 0; i < 8; i++) dst[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+int
+chunk_receipt_token_batch(
+    const unsigned int COUNT, const uint8_t root[crypto_hash_sha512_BYTES],
+    const uint32_t indexes[COUNT],
+    const uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES],
+    uint8_t tokens[COUNT * crypto_hash_sha512_BYTES])
+{
+  if (COUNT == 0) return 0;
+  if (!root || !indexes || !leaves_hashed || !tokens) return -1;
+
+  // Every input has the same length, so groups of four go through the
+  // four-lane kernel; the domain's first byte rides as the batch prefix.
+  uint8_t rows[SHA512X4_LANES][CHUNK_RECEIPT_ROW_LEN];
+  const size_t domain_len = sizeof chunk_receipt_domain - 1;
+  size_t i, l, n;
+
+  for (i = 0; i < COUNT; i += n)
+  {
+    n = COUNT - i < SHA512X4_LANES ? COUNT - i : SHA512X4_LANES;
+
+    for (l = 0; l < n; l++)
+    {
+      uint8_t *row = rows[l];
+
+      memcpy(row, &chunk_receipt_domain[1], domain_len);
+      memcpy(&row[domain_len], root, crypto_hash_sha512_BYTES);
+      receipt_store64_be(&row[domain_len + crypto_hash_sha512_BYTES],
+                         indexes[i + l]);
+      memcpy(&row[domain_len + crypto_hash_sha512_BYTES + 8],
+             &leaves_hashed[(i + l) * crypto_hash_sha512_BYTES],
+             crypto_hash_sha512_BYTES);
+    }
+
+    if (sha512_prefixed_batch(n, CHUNK_RECEIPT_ROW_LEN,
+                              chunk_receipt_domain[0], rows[0],
+                              &tokens[i * crypto_hash_sha512_BYTES])
+        != 0)
+      return -2;
+  }
+
+  return 0;
+}
+
+int
+chunk_range_receipt_token(
+    const uint8_t root[crypto_hash_sha512_BYTES], const unsigned int first,
+    const unsigned int COUNT,
+    const uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES],
+    uint8_t token[crypto_hash_sha512_BYTES])
+{
+  if (!root || !leaves_hashed || !token) return -1;
+  if (COUNT == 0 || COUNT > CHUNK_RANGE_RECEIPT_MAX_CHUNKS) return -1;
+
+  crypto_hash_sha512_state state;
+  uint8_t range[16];
+
+  receipt_store64_be(range, first);
+  receipt_store64_be(&range[8], COUNT);
+
+  if (crypto_hash_sha512_init(&state) != 0
+      || crypto_hash_sha512_update(&state, chunk_range_receipt_domain,
+                                   sizeof chunk_range_receipt_domain)
+             != 0
+      || crypto_hash_sha512_update(&state, root, crypto_hash_sha512_BYTES)
+             != 0
+      || crypto_hash_sha512_update(&state, range, sizeof range) != 0
+      || crypto_hash_sha512_update(&state, leaves_hashed,
+                                   (size_t)COUNT * crypto_hash_sha512_BYTES)
+             != 0
+      || crypto_hash_sha512_final(&state, token) != 0)
+    return -2;
+
+  return 0;
+}
+
+/* Recomputes the range receipt from the tree's own leaves and root, so the
+ * sender needs nothing from storage.
+ * 0 = valid, 1 = token mismatch, -1 = bad args or range, -2 = hash failure. */
+int
+merkle_tree_verify_range_receipt(const merkle_tree *tree,
+                                 const unsigned int first,
+                                 const unsigned int count,
+                                 const uint8_t token[crypto_hash_sha512_BYTES])
+{
+  if (!tree || !token) return -1;
+  if (!merkle_range_valid(tree->leaves_len, first, count)) return -1;
+
+  uint8_t root[crypto_hash_sha512_BYTES];
+  uint8_t expected[crypto_hash_sha512_BYTES];
+  int res;
+
+  if (merkle_tree_root(tree, root) != 0) return -1;
+  res = chunk_range_receipt_token(
+      root, first, count,
+      &tree->nodes[(size_t)first * crypto_hash_sha512_BYTES], expected);
+  if (res != 0) return res;
+
+  return sodium_memcmp(expected, token, crypto_hash_sha512_BYTES) == 0 ? 0 : 1;
+}
@@ -8,11 +8,19 @@
 
 #include <sodium.h>
 
+#include "pool.h"
+#include "sha512x4.h"
+
 int
 get_merkle_root(const unsigned int LEAVES_LEN,
                 uint8_t leaves_hashed[LEAVES_LEN * crypto_hash_sha512_BYTES],
                 uint8_t root[crypto_hash_sha512_BYTES]);
 
+int merkle_leaf_hash_batch(
+    const unsigned int COUNT, const unsigned int CHUNK_BYTES,
+    const uint8_t chunks[COUNT * CHUNK_BYTES],
+    uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES]);
+
 int
 get_merkle_proof(const unsigned int LEAVES_LEN,
                  uint8_t leaves_hashed[LEAVES_LEN * crypto_hash_sha512_BYTES],
@@ -31,4 +39,108 @@ int verify_merkle_proof(
     const uint8_t root[crypto_hash_sha512_BYTES],
     const uint8_t proof[PROOF_ARTIFACTS_LEN * (crypto_hash_sha512_BYTES + 1)]);
 
+/* Persistent Merkle tree (see merkle.c). Every level is hashed once into one
+ * flat, level-ordered node array — leaves first, root last — so a proof for
+ * any leaf index is O(log n) copies with no rehashing. JS allocates
+ * merkle_tree_bytes(LEAVES_LEN) bytes on the heap and passes the pointer. */
+typedef struct
+{
+  uint32_t leaves_len;
+  uint32_t nodes_len;
+  uint8_t nodes[];
+} merkle_tree;
+
+size_t merkle_tree_bytes(const unsigned int LEAVES_LEN);
+
+int merkle_tree_build(
+    merkle_tree *tree, const unsigned int LEAVES_LEN,
+    const uint8_t leaves_hashed[LEAVES_LEN * crypto_hash_sha512_BYTES]);
+
+int merkle_tree_root(const merkle_tree *tree,
+                     uint8_t root[crypto_hash_sha512_BYTES]);
+
+int merkle_tree_proof(const merkle_tree *tree, const unsigned int index,
+                      uint8_t *proof);
+
+/* Append-only accumulator (see merkle.c): only the O(log n) frontier of
+ * perfect-subtree roots is kept, so leaves can be fed one at a time as they are
+ * produced. Byte-matched to merkle_accumulator_STATEBYTES in interfaces.ts. */
+#define MERKLE_ACCUMULATOR_MAX_HEIGHT 48U
+typedef struct
+{
+  uint64_t leaves_len;
+  uint8_t frontier[MERKLE_ACCUMULATOR_MAX_HEIGHT * crypto_hash_sha512_BYTES];
+} merkle_accumulator;
+_Static_assert(sizeof(merkle_accumulator) == 3080,
+               "merkle_accumulator layout must match interfaces.ts");
+
+int merkle_accumulator_init(merkle_accumulator *acc);
+int merkle_accumulator_append(merkle_accumulator *acc,
+                              const uint8_t leaf_hash[crypto_hash_sha512_BYTES]);
+int merkle_accumulator_root(const merkle_accumulator *acc,
+                            uint8_t root[crypto_hash_sha512_BYTES]);
+
+/* Receive-side proof cache (see merkle.c): a bounded set of tree nodes already
+ * verified against `root`, so later proofs stop folding at the first verified
+ * node instead of rehashing the shared upper levels. Byte-matched to
+ * merkle_proof_cache_STATEBYTES in interfaces.ts. */
+#define MERKLE_PROOF_CACHE_SLOTS 1024U
+#define MERKLE_PROOF_CACHE_DEPTH 9U
+typedef struct
+{
+  uint8_t root[crypto_hash_sha512_BYTES];
+  uint32_t used;
+  uint8_t depth[MERKLE_PROOF_CACHE_SLOTS]; // 0 = empty slot
+  uint8_t nodes[MERKLE_PROOF_CACHE_SLOTS * crypto_hash_sha512_BYTES];
+} merkle_proof_cache;
+_Static_assert(sizeof(merkle_proof_cache) == 66628,
+               "merkle_proof_cache layout must match interfaces.ts");
+
+int merkle_proof_cache_init(merkle_proof_cache *cache,
+                            const uint8_t root[crypto_hash_sha512_BYTES]);
+int merkle_proof_cache_verify(
+    merkle_proof_cache *cache, const unsigned int PROOF_ARTIFACTS_LEN,
+    const uint8_t element_hash[crypto_hash_sha512_BYTES],
+    const uint8_t proof[PROOF_ARTIFACTS_LEN * (crypto_hash_sha512_BYTES + 1)]);
+
+/* Range multiproof (see merkle.c): one proof for the contiguous leaves
+ * [first, first + count), sharing every sibling the range has in common.
+ * Siblings are bare 64-byte hashes; their positions are implied by
+ * (leaves_len, first, count). */
+size_t merkle_range_proof_bytes(const unsigned int LEAVES_LEN,
+                                const unsigned int first,
+                                const unsigned int count);
+
+int merkle_tree_range_proof(const merkle_tree *tree, const unsigned int first,
+                            const unsigned int count, uint8_t *proof);
+
+int verify_merkle_range_proof(
+    const unsigned int LEAVES_LEN, const unsigned int first,
+    const unsigned int COUNT,
+    uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES],
+    const uint8_t root[crypto_hash_sha512_BYTES],
+    const unsigned int PROOF_BYTES, const uint8_t *proof);
+
+/* Chunk receipt tokens (see merkle.c), byte-identical to receiptToken.ts. The
+ * batch hashes COUNT (root, index, leaf) triples four at a time; tokens may
+ * equal leaves_hashed. A range receipt acknowledges the contiguous chunks
+ * [first, first + COUNT) with one token bound to the root and the range. */
+#define CHUNK_RANGE_RECEIPT_MAX_CHUNKS 1024U
+
+int chunk_receipt_token_batch(
+    const unsigned int COUNT, const uint8_t root[crypto_hash_sha512_BYTES],
+    const uint32_t indexes[COUNT],
+    const uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES],
+    uint8_t tokens[COUNT * crypto_hash_sha512_BYTES]);
+
+int chunk_range_receipt_token(
+    const uint8_t root[crypto_hash_sha512_BYTES], const unsigned int first,
+    const unsigned int COUNT,
+    const uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES],
+    uint8_t token[crypto_hash_sha512_BYTES]);
+
+int merkle_tree_verify_range_receipt(
+    const merkle_tree *tree, const unsigned int first,
+    const unsigned int count, const uint8_t token[crypto_hash_sha512_BYTES]);
+
 #endif
@@ -1,9 +1,11 @@
-import cryptoMemory from "./memory";
-
-// import libcrypto from "./libcrypto";
-import { wasmLoader } from "./wasmLoader";
-
-import { crypto_hash_sha512_BYTES } from "./interfaces";
+import { sharedModule } from "./sharedModule";
+import { withScratch } from "./scratch";
+
+import {
+  crypto_hash_sha512_BYTES,
+  merkle_accumulator_STATEBYTES,
+  merkle_proof_cache_STATEBYTES,
+} from "./interfaces";
 import { hashMerkleLeaf, hashMerkleLeafWasm } from "../utils/leafHash";
 
 import type { LibCrypto } from "./libcrypto";
@@ -30,64 +32,54 @@ export const getMerkleRoot = async (
     return treeHashes;
   }
 
-  const wasmMemory =
-    module?.wasmMemory ?? cryptoMemory.getMerkleRootMemory(treeLen);
-  const cryptoModule = module ?? (await wasmLoader(wasmMemory));
-  // (await libcrypto({
-  //   wasmMemory,
-  // }));
-
-  const ptr1 = cryptoModule._malloc(treeLen * crypto_hash_sha512_BYTES);
-  const leavesHashed = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    treeLen * crypto_hash_sha512_BYTES,
-  );
-  leavesHashed.set(treeHashes);
-
-  const ptr2 = cryptoModule._malloc(crypto_hash_sha512_BYTES);
-  const rootWasm = new Uint8Array(
-    wasmMemory.buffer,
-    ptr2,
-    crypto_hash_sha512_BYTES,
-  );
-
-  const result = cryptoModule._get_merkle_root(
-    treeLen,
-    leavesHashed.byteOffset,
-    rootWasm.byteOffset,
-  );
-
-  cryptoModule._free(ptr1);
-
-  switch (result) {
-    case 0: {
-      const root = Uint8Array.from([...rootWasm]);
-      cryptoModule._free(ptr2);
-
-      return root;
-    }
+  const cryptoModule = module ?? (await sharedModule());
+
+  return withScratch(cryptoModule, (frame) => {
+    const leavesHashed = frame.put(treeHashes);
+    const rootWasm = frame.alloc(crypto_hash_sha512_BYTES);
+
+    // get_merkle_root folds every level in place, which cannot be split over
+    // threads. On a threaded module the levels are hashed out of place by
+    // merkle_tree_build, which spreads each one over the pool, and the root
+    // is read from there.
+    const foldOutOfPlace = (): number => {
+      const treeBytes = cryptoModule._merkle_tree_bytes(treeLen);
+      if (treeBytes <= 0) throw new Error("Merkle tree is too large.");
+
+      const treePtr = frame.alloc(treeBytes);
+      const built = cryptoModule._merkle_tree_build(
+        treePtr,
+        treeLen,
+        leavesHashed,
+      );
+      if (built !== 0) return built;
 
-    case -1: {
-      cryptoModule._free(ptr2);
+      return cryptoModule._merkle_tree_root(treePtr, rootWasm);
+    };
 
-      throw new Error(
-        "Could not allocate memory for hash concatenation helper array.",
-      );
-    }
+    const result =
+      cryptoModule._pool_threads() > 1
+        ? foldOutOfPlace()
+        : cryptoModule._get_merkle_root(treeLen, leavesHashed, rootWasm);
 
-    case -2: {
-      cryptoModule._free(ptr2);
+    switch (result) {
+      case 0:
+        return Uint8Array.from(
+          frame.view(rootWasm, crypto_hash_sha512_BYTES),
+        );
 
-      throw new Error("Could not calculate hash.");
-    }
+      case -1:
+        throw new Error(
+          "Could not allocate memory for hash concatenation helper array.",
+        );
 
-    default: {
-      cryptoModule._free(ptr2);
+      case -2:
+        throw new Error("Could not calculate hash.");
 
-      throw new Error("Unexpected error occured.");
+      default:
+        throw new Error("Unexpected error occured.");
     }
-  }
+  });
 };
 
 /**
@@ -145,103 +137,44 @@ export const getMerkleProof = async (
     }
   }
 
-  const wasmMemory =
-    module?.wasmMemory ?? cryptoMemory.getMerkleProofMemory(treeLen);
-  const cryptoModule = module ?? (await wasmLoader(wasmMemory));
-  // (await libcrypto({
-  //   wasmMemory,
-  // }));
-
-  const ptr1 = cryptoModule._malloc(treeLen * crypto_hash_sha512_BYTES);
-  const leavesHashed = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    treeLen * crypto_hash_sha512_BYTES,
-  );
-  leavesHashed.set(treeHashes);
+  const cryptoModule = module ?? (await sharedModule());
 
-  const ptr2 = cryptoModule._malloc(crypto_hash_sha512_BYTES);
-  const element = new Uint8Array(
-    wasmMemory.buffer,
-    ptr2,
-    crypto_hash_sha512_BYTES,
-  );
-  // const digest = await window.crypto.subtle.digest("SHA-512", element);
-  // hash = await sha512(element);
-  // elementHash.set(new Uint8Array(digest));
-  element.set(elementHash);
+  return withScratch(cryptoModule, (frame) => {
+    const leavesHashed = frame.put(treeHashes);
+    const element = frame.put(elementHash, crypto_hash_sha512_BYTES);
+    const proofLen = treeLen * (crypto_hash_sha512_BYTES + 1);
+    const proof = frame.alloc(proofLen);
 
-  const proofLen = treeLen * (crypto_hash_sha512_BYTES + 1);
-  // Math.ceil(Math.log2(treeLen)) * (crypto_hash_sha512_BYTES + 1);
-  const ptr3 = cryptoModule._malloc(proofLen);
-  const proof = new Uint8Array(wasmMemory.buffer, ptr3, proofLen);
-
-  const result = cryptoModule._get_merkle_proof(
-    treeLen,
-    // proofLen,
-    leavesHashed.byteOffset,
-    element.byteOffset,
-    proof.byteOffset,
-  );
+    const result = cryptoModule._get_merkle_proof(
+      treeLen,
+      leavesHashed,
+      element,
+      proof,
+    );
 
-  cryptoModule._free(ptr1);
-  cryptoModule._free(ptr2);
-
-  switch (result) {
-    case -1: {
-      cryptoModule._free(ptr3);
-
-      throw new Error("Element not in tree.");
-    }
+    switch (result) {
+      case -1:
+        throw new Error("Element not in tree.");
 
-    case -2: {
-      cryptoModule._free(ptr3);
+      case -2:
+        throw new Error(
+          "Could not allocate memory for hash concatenation helper array.",
+        );
 
-      throw new Error(
-        "Could not allocate memory for hash concatenation helper array.",
-      );
-    }
+      case -3:
+        throw new Error("Could not calculate hash.");
 
-    case -3: {
-      cryptoModule._free(ptr3);
+      default: {
+        if (result <= 0) throw new Error("An unexpected error occured");
 
-      throw new Error("Could not calculate hash.");
-    }
+        const proofArray = Uint8Array.from(frame.view(proof, result));
 
-    default: {
-      if (result > 0) {
-        if (proofFixedLen && proofFixedLen >= result) {
-          const proofArray = globalThis.crypto.getRandomValues(
-            new Uint8Array(proofFixedLen),
-          );
-
-          let offset = 0;
-          const proofLenBytes = 4;
-          const proofLenView = new DataView(
-            proofArray.buffer,
-            offset,
-            proofLenBytes,
-          );
-          proofLenView.setUint32(0, result, false); // Big-endian
-          offset += proofLenBytes;
-
-          proofArray.set(proof.slice(0, result), offset);
-          cryptoModule._free(ptr3);
-
-          return proofArray;
-        } else {
-          const proofArray = Uint8Array.from([...proof.slice(0, result)]);
-          cryptoModule._free(ptr3);
-
-          return proofArray;
-        }
-      } else {
-        cryptoModule._free(ptr3);
-
-        throw new Error("An unexpected error occured");
+        return proofFixedLen && proofFixedLen >= result
+          ? proofWithFixedLen(proofArray, proofFixedLen)
+          : proofArray;
       }
     }
-  }
+  });
 };
 
 /**
@@ -263,75 +196,42 @@ export const getMerkleRootFromProof = async (
     throw new Error("Proof length not multiple of hash length + 1.");
   const proofArtifactsLen = proofLen / (crypto_hash_sha512_BYTES + 1);
 
-  const wasmMemory = cryptoMemory.verifyMerkleProofMemory(proofLen);
-  const cryptoModule = await wasmLoader(wasmMemory);
-  // const cryptoModule = await libcrypto({
-  //   wasmMemory,
-  // });
+  const itemHash = await hashMerkleLeaf(item);
+  const cryptoModule = await sharedModule();
 
-  const ptr1 = cryptoModule._malloc(crypto_hash_sha512_BYTES);
-  const elementHash = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    crypto_hash_sha512_BYTES,
-  );
-  elementHash.set(await hashMerkleLeaf(item));
+  return withScratch(cryptoModule, (frame) => {
+    const elementHash = frame.put(itemHash);
+    const proofArray = frame.put(proof);
+    const rootArray = frame.alloc(crypto_hash_sha512_BYTES);
 
-  const ptr2 = cryptoModule._malloc(proofLen);
-  const proofArray = new Uint8Array(wasmMemory.buffer, ptr2, proofLen);
-  proofArray.set(proof);
+    const result = cryptoModule._get_merkle_root_from_proof(
+      proofArtifactsLen,
+      elementHash,
+      proofArray,
+      rootArray,
+    );
 
-  const ptr3 = cryptoModule._malloc(crypto_hash_sha512_BYTES);
-  const rootArray = new Uint8Array(
-    wasmMemory.buffer,
-    ptr3,
-    crypto_hash_sha512_BYTES,
-  );
+    switch (result) {
+      case 0:
+        return Uint8Array.from(
+          frame.view(rootArray, crypto_hash_sha512_BYTES),
+        );
 
-  const result = cryptoModule._get_merkle_root_from_proof(
-    proofArtifactsLen,
-    elementHash.byteOffset,
-    proofArray.byteOffset,
-    rootArray.byteOffset,
-  );
+      case -1:
+        throw new Error(
+          "Could not allocate memory for hash concatenation helper array.",
+        );
 
-  cryptoModule._free(ptr1);
-  cryptoModule._free(ptr2);
+      case -2:
+        throw new Error("Proof artifact position is neither left nor right.");
 
-  switch (result) {
-    case 0: {
-      const proof = Uint8Array.from([...rootArray]);
-      cryptoModule._free(ptr3);
+      case -3:
+        throw new Error("Could not calculate hash.");
 
-      return proof;
+      default:
+        throw new Error("Unexpected error occured.");
     }
-
-    case -1: {
-      cryptoModule._free(ptr3);
-
-      throw new Error(
-        "Could not allocate memory for hash concatenation helper array.",
-      );
-    }
-
-    case -2: {
-      cryptoModule._free(ptr3);
-
-      throw new Error("Proof artifact position is neither left nor right.");
-    }
-
-    case -3: {
-      cryptoModule._free(ptr3);
-
-      throw new Error("Could not calculate hash.");
-    }
-
-    default: {
-      cryptoModule._free(ptr3);
-
-      throw new Error("Unexpected error occured.");
-    }
-  }
+  });
 };
 
 /**
@@ -353,45 +253,19 @@ export const verifyMerkleProof = async (
 
   const proofArtifactsLen = proofLen / (crypto_hash_sha512_BYTES + 1);
 
-  const wasmMemory =
-    module?.wasmMemory ?? cryptoMemory.verifyMerkleProofMemory(proofLen);
-  const cryptoModule = module ?? (await wasmLoader(wasmMemory));
-  // (await libcrypto({
-  //   wasmMemory,
-  // }));
-
-  const ptr1 = cryptoModule._malloc(crypto_hash_sha512_BYTES);
-  const elementHash = new Uint8Array(
-    wasmMemory.buffer,
-    ptr1,
-    crypto_hash_sha512_BYTES,
-  );
+  const cryptoModule = module ?? (await sharedModule());
   // Receive-side leaf hash in libsodium (C), not browser crypto.
-  elementHash.set(hashMerkleLeafWasm(item, cryptoModule));
-
-  const ptr2 = cryptoModule._malloc(crypto_hash_sha512_BYTES);
-  const rootArray = new Uint8Array(
-    wasmMemory.buffer,
-    ptr2,
-    crypto_hash_sha512_BYTES,
-  );
-  rootArray.set(root);
-
-  const ptr3 = cryptoModule._malloc(proofLen);
-  const proofArray = new Uint8Array(wasmMemory.buffer, ptr3, proofLen);
-  proofArray.set(proof);
-
-  const result = cryptoModule._verify_merkle_proof(
-    proofArtifactsLen,
-    elementHash.byteOffset,
-    rootArray.byteOffset,
-    proofArray.byteOffset,
+  const itemHash = hashMerkleLeafWasm(item, cryptoModule);
+
+  const result = withScratch(cryptoModule, (frame) =>
+    cryptoModule._verify_merkle_proof(
+      proofArtifactsLen,
+      frame.put(itemHash),
+      frame.put(root, crypto_hash_sha512_BYTES),
+      frame.put(proof),
+    ),
   );
 
-  cryptoModule._free(ptr1);
-  cryptoModule._free(ptr2);
-  cryptoModule._free(ptr3);
-
   switch (result) {
     case 0:
       return true;
@@ -415,3 +289,465 @@ export const verifyMerkleProof = async (
       throw new Error("Unexpected error occured.");
   }
 };
+
+/**
+ * @function
+ * getMerkleRangeProofLen
+ *
+ * @description
+ * Size in bytes of the range multiproof for the leaves [first, first + count)
+ * of a tree with `leavesLen` leaves (see `merkle_range_proof_bytes`). Only the
+ * siblings at the two edges of the range are carried, bare 64-byte hashes
+ * bottom-up, left before right, so the size is at most 2 * depth * 64 however
+ * many leaves the range covers.
+ *
+ * @returns {number}
+ */
+export const getMerkleRangeProofLen = (
+  leavesLen: number,
+  first: number,
+  count: number,
+): number => {
+  if (
+    !Number.isInteger(leavesLen) ||
+    !Number.isInteger(first) ||
+    !Number.isInteger(count) ||
+    leavesLen < 1 ||
+    first < 0 ||
+    count < 1 ||
+    first + count > leavesLen
+  )
+    throw new Error("Range not in tree.");
+
+  let siblings = 0;
+  let lo = first;
+  let hi = first + count - 1;
+  for (let width = leavesLen; width > 1; width = Math.ceil(width / 2)) {
+    if (lo % 2 !== 0) siblings++;
+    if (hi % 2 === 0 && hi + 1 < width) siblings++;
+    lo = Math.floor(lo / 2);
+    hi = Math.floor(hi / 2);
+  }
+
+  return siblings * crypto_hash_sha512_BYTES;
+};
+
+/**
+ * @function
+ * verifyMerkleRangeProof
+ *
+ * @description
+ * Checks that the hashed leaves cover [first, first + count) of the tree with
+ * `root`, using a proof from `MerkleTree.getRangeProof`.
+ *
+ * @param {Uint8Array} leafHashes: The range's leaf hashes, concatenated.
+ *
+ * @returns {Promise<boolean>}
+ */
+export const verifyMerkleRangeProof = async (
+  leafHashes: Uint8Array,
+  first: number,
+  leavesLen: number,
+  root: Uint8Array,
+  proof: Uint8Array,
+  module?: LibCrypto,
+): Promise<boolean> => {
+  if (
+    leafHashes.length === 0 ||
+    leafHashes.length % crypto_hash_sha512_BYTES !== 0
+  )
+    throw new Error("Hashes were not passed");
+
+  const count = leafHashes.length / crypto_hash_sha512_BYTES;
+  if (proof.length !== getMerkleRangeProofLen(leavesLen, first, count))
+    return false;
+
+  const cryptoModule = module ?? (await sharedModule());
+
+  const result = withScratch(cryptoModule, (frame) =>
+    cryptoModule._verify_merkle_range_proof(
+      leavesLen,
+      first,
+      count,
+      frame.put(leafHashes),
+      frame.put(root, crypto_hash_sha512_BYTES),
+      proof.length,
+      frame.put(proof),
+    ),
+  );
+
+  switch (result) {
+    case 0:
+      return true;
+
+    case 1:
+      return false;
+
+    case -4:
+      throw new Error("Could not calculate hash.");
+
+    default:
+      throw new Error("Unexpected error occured.");
+  }
+};
+
+/**
+ * A Merkle tree whose every level is hashed once into WASM memory (see
+ * `merkle_tree_build` in merkle.c). Proofs are looked up by leaf index and cost
+ * O(log n) copies, where `getMerkleProof` rescans and rehashes the whole tree
+ * for each one. The tree holds heap memory in its module until `free()`.
+ */
+export interface MerkleTree {
+  readonly leavesLen: number;
+  readonly root: Uint8Array;
+  getProof(index: number, proofFixedLen?: number): Uint8Array;
+  getRangeProof(first: number, count: number): Uint8Array;
+  /** Checks a range receipt for [first, first + count) against the leaves. */
+  verifyRangeReceipt(first: number, count: number, token: Uint8Array): boolean;
+  free(): void;
+}
+
+const proofWithFixedLen = (
+  proof: Uint8Array,
+  proofFixedLen: number,
+): Uint8Array => {
+  const proofArray = globalThis.crypto.getRandomValues(
+    new Uint8Array(proofFixedLen),
+  );
+
+  const proofLenBytes = 4;
+  const proofLenView = new DataView(proofArray.buffer, 0, proofLenBytes);
+  proofLenView.setUint32(0, proof.length, false); // Big-endian
+  proofArray.set(proof, proofLenBytes);
+
+  return proofArray;
+};
+
+/**
+ * @function
+ * createMerkleTree
+ *
+ * @description
+ * Builds a persistent Merkle tree over the hashed leaves. Roots and proofs are
+ * byte-identical to `getMerkleRoot` and `getMerkleProof`.
+ *
+ * @param {Uint8Array} treeHashes: The leaves, hashed and concatenated.
+ *
+ * @returns {Promise<MerkleTree>}
+ */
+export const createMerkleTree = async (
+  treeHashes: Uint8Array,
+  module?: LibCrypto,
+): Promise<MerkleTree> => {
+  if (treeHashes.length % crypto_hash_sha512_BYTES !== 0) {
+    throw new Error("Hashes were not passed");
+  }
+
+  const leavesLen = treeHashes.length / crypto_hash_sha512_BYTES;
+  if (leavesLen === 0) {
+    throw new Error("Cannot build Merkle tree with no leaves.");
+  }
+
+  const cryptoModule = module ?? (await sharedModule());
+  const wasmMemory = cryptoModule.wasmMemory;
+
+  const treeBytes = cryptoModule._merkle_tree_bytes(leavesLen);
+  if (treeBytes <= 0) throw new Error("Merkle tree is too large.");
+
+  let depth = 0;
+  for (let width = leavesLen; width > 1; width = Math.ceil(width / 2))
+    depth++;
+  const proofLen = Math.max(1, depth) * (crypto_hash_sha512_BYTES + 1);
+
+  const ptr1 = cryptoModule._malloc(treeHashes.length);
+  new Uint8Array(wasmMemory.buffer, ptr1, treeHashes.length).set(treeHashes);
+
+  const treePtr = cryptoModule._malloc(treeBytes);
+  const built = cryptoModule._merkle_tree_build(treePtr, leavesLen, ptr1);
+  cryptoModule._free(ptr1);
+
+  if (built !== 0) {
+    cryptoModule._free(treePtr);
+
+    throw new Error(
+      built === -2 ? "Could not calculate hash." : "Unexpected error occured.",
+    );
+  }
+
+  const ptr2 = cryptoModule._malloc(crypto_hash_sha512_BYTES);
+  cryptoModule._merkle_tree_root(treePtr, ptr2);
+  const root = Uint8Array.from(
+    new Uint8Array(wasmMemory.buffer, ptr2, crypto_hash_sha512_BYTES),
+  );
+  cryptoModule._free(ptr2);
+
+  const ptr3 = cryptoModule._malloc(proofLen);
+  let freed = false;
+
+  return {
+    leavesLen,
+    root,
+
+    getProof: (index: number, proofFixedLen?: number): Uint8Array => {
+      if (freed) throw new Error("Merkle tree has been freed.");
+      if (!Number.isInteger(index) || index < 0 || index >= leavesLen)
+        throw new Error("Element not in tree.");
+
+      if (leavesLen === 1) {
+        // Single-leaf tree: same root == element proof as getMerkleProof.
+        const proof = new Uint8Array(crypto_hash_sha512_BYTES + 1);
+        proof.set(root);
+
+        return proofFixedLen ? proofWithFixedLen(proof, proofFixedLen) : proof;
+      }
+
+      const result = cryptoModule._merkle_tree_proof(treePtr, index, ptr3);
+      if (result <= 0) throw new Error("An unexpected error occured");
+
+      const proof = Uint8Array.from(
+        new Uint8Array(wasmMemory.buffer, ptr3, result),
+      );
+
+      return proofFixedLen && proofFixedLen >= result
+        ? proofWithFixedLen(proof, proofFixedLen)
+        : proof;
+    },
+
+    getRangeProof: (first: number, count: number): Uint8Array => {
+      if (freed) throw new Error("Merkle tree has been freed.");
+
+      const proofBytes = getMerkleRangeProofLen(leavesLen, first, count);
+      if (proofBytes === 0) return new Uint8Array();
+
+      const ptr4 = cryptoModule._malloc(proofBytes);
+      const result = cryptoModule._merkle_tree_range_proof(
+        treePtr,
+        first,
+        count,
+        ptr4,
+      );
+      const proof =
+        result === proofBytes
+          ? Uint8Array.from(new Uint8Array(wasmMemory.buffer, ptr4, result))
+          : undefined;
+      cryptoModule._free(ptr4);
+
+      if (!proof) throw new Error("An unexpected error occured");
+
+      return proof;
+    },
+
+    verifyRangeReceipt: (
+      first: number,
+      count: number,
+      token: Uint8Array,
+    ): boolean => {
+      if (freed) throw new Error("Merkle tree has been freed.");
+      if (token.length !== crypto_hash_sha512_BYTES) return false;
+      // merkle.c takes unsigned int bounds; a wider value would wrap there.
+      if (
+        !Number.isInteger(first) ||
+        !Number.isInteger(count) ||
+        first < 0 ||
+        count < 1 ||
+        first + count > leavesLen
+      )
+        return false;
+
+      // ptr3 holds at least one proof artifact (65 bytes).
+      new Uint8Array(wasmMemory.buffer, ptr3, crypto_hash_sha512_BYTES).set(
+        token,
+      );
+      const result = cryptoModule._merkle_tree_verify_range_receipt(
+        treePtr,
+        first,
+        count,
+        ptr3,
+      );
+      if (result === -2) throw new Error("Could not calculate hash.");
+
+      return result === 0;
+    },
+
+    free: (): void => {
+      if (freed) return;
+      freed = true;
+      cryptoModule._free(ptr3);
+      cryptoModule._free(treePtr);
+    },
+  };
+};
+
+/**
+ * Append-only Merkle root builder (see `merkle_accumulator_*` in merkle.c).
+ * Keeps only the O(log n) frontier in WASM memory, so leaves can be fed as the
+ * chunker produces them. `root()` equals `getMerkleRoot` over the same leaves.
+ */
+export interface MerkleAccumulator {
+  readonly leavesLen: number;
+  append(leafHash: Uint8Array): void;
+  root(): Uint8Array;
+  free(): void;
+}
+
+/**
+ * @function
+ * createMerkleAccumulator
+ *
+ * @description
+ * Starts an empty accumulator in `module`'s heap.
+ *
+ * @returns {MerkleAccumulator}
+ */
+export const createMerkleAccumulator = (
+  module: LibCrypto,
+): MerkleAccumulator => {
+  const statePtr = module._malloc(merkle_accumulator_STATEBYTES);
+  const hashPtr = module._malloc(crypto_hash_sha512_BYTES);
+  module._merkle_accumulator_init(statePtr);
+
+  let leavesLen = 0;
+  let freed = false;
+
+  return {
+    get leavesLen() {
+      return leavesLen;
+    },
+
+    append: (leafHash: Uint8Array): void => {
+      if (freed) throw new Error("Merkle accumulator has been freed.");
+      if (leafHash.length !== crypto_hash_sha512_BYTES)
+        throw new Error("Hashes were not passed");
+
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        hashPtr,
+        crypto_hash_sha512_BYTES,
+      ).set(leafHash);
+      const result = module._merkle_accumulator_append(statePtr, hashPtr);
+      if (result === -2) throw new Error("Merkle accumulator is full.");
+      if (result !== 0) throw new Error("Could not calculate hash.");
+
+      leavesLen++;
+    },
+
+    root: (): Uint8Array => {
+      if (freed) throw new Error("Merkle accumulator has been freed.");
+
+      const result = module._merkle_accumulator_root(statePtr, hashPtr);
+      if (result === -2)
+        throw new Error("Cannot calculate Merkle root of tree with no leaves.");
+      if (result !== 0) throw new Error("Could not calculate hash.");
+
+      return Uint8Array.from(
+        new Uint8Array(
+          module.wasmMemory.buffer,
+          hashPtr,
+          crypto_hash_sha512_BYTES,
+        ),
+      );
+    },
+
+    free: (): void => {
+      if (freed) return;
+      freed = true;
+      module._free(hashPtr);
+      module._free(statePtr);
+    },
+  };
+};
+
+/**
+ * Receive-side Merkle verifier for one transfer root (see
+ * `merkle_proof_cache_*` in merkle.c). Upper nodes verified for earlier chunks
+ * are remembered, so later proofs stop folding as soon as they reach one.
+ * `ptr` is the C state for `_receive_message_with_proof_cache`.
+ */
+export interface MerkleProofCache {
+  readonly ptr: number;
+  verify(leafHash: Uint8Array, proof: Uint8Array): boolean;
+  free(): void;
+}
+
+/**
+ * @function
+ * createMerkleProofCache
+ *
+ * @description
+ * Allocates an empty proof cache bound to `root` in `module`'s heap.
+ *
+ * @returns {MerkleProofCache}
+ */
+export const createMerkleProofCache = (
+  root: Uint8Array,
+  module: LibCrypto,
+): MerkleProofCache => {
+  if (root.length !== crypto_hash_sha512_BYTES)
+    throw new Error("Merkle root must be 64 bytes.");
+
+  const statePtr = module._malloc(merkle_proof_cache_STATEBYTES);
+  const rootPtr = module._malloc(crypto_hash_sha512_BYTES);
+  new Uint8Array(
+    module.wasmMemory.buffer,
+    rootPtr,
+    crypto_hash_sha512_BYTES,
+  ).set(root);
+  module._merkle_proof_cache_init(statePtr, rootPtr);
+  module._free(rootPtr);
+
+  let freed = false;
+
+  return {
+    ptr: statePtr,
+
+    verify: (leafHash: Uint8Array, proof: Uint8Array): boolean => {
+      if (freed) throw new Error("Merkle proof cache has been freed.");
+      if (leafHash.length !== crypto_hash_sha512_BYTES)
+        throw new Error("Hashes were not passed");
+      if (proof.length % (crypto_hash_sha512_BYTES + 1) !== 0)
+        throw new Error("Proof length not multiple of hash length + 1.");
+
+      const ptr1 = module._malloc(crypto_hash_sha512_BYTES);
+      const ptr2 = module._malloc(Math.max(proof.length, 1));
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        ptr1,
+        crypto_hash_sha512_BYTES,
+      ).set(leafHash);
+      new Uint8Array(module.wasmMemory.buffer, ptr2, proof.length).set(proof);
+
+      const result = module._merkle_proof_cache_verify(
+        statePtr,
+        proof.length / (crypto_hash_sha512_BYTES + 1),
+        ptr1,
+        ptr2,
+      );
+
+      module._free(ptr1);
+      module._free(ptr2);
+
+      switch (result) {
+        case 0:
+          return true;
+
+        case 1:
+          return false;
+
+        case -3:
+          throw new Error("Proof artifact position is neither left nor right.");
+
+        case -4:
+          throw new Error("Could not calculate hash.");
+
+        default:
+          throw new Error("Unexpected error occured.");
+      }
+    },
+
+    free: (): void => {
+      if (freed) return;
+      freed = true;
+      module._free(statePtr);
+    },
+  };
+};
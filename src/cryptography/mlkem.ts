@@ -1,3 +1,4 @@
+import { uint8ArrayToHex } from "../utils/uint8array";
 import { zeroFree } from "../utils/zeroFree";
 
 import { fillRandomBytesInto } from "./random";
@@ -21,10 +22,21 @@ export const ML_KEM_1024_CIPHERTEXT_BYTES = 1568;
 export const ML_KEM_SHARED_SECRET_BYTES = 32;
 export const ML_KEM_KEYPAIR_RANDOM_BYTES = 64;
 export const ML_KEM_ENCAPS_RANDOM_BYTES = 32;
+/** Items per batch call, P2PARTY_MLKEMNNN_BATCH_MAX in mlkemNNN.h. */
+export const ML_KEM_BATCH_MAX = 4;
 
 type MlKemKeyPairExport<P extends MlKemParameterSet> = `_mlkem${P}_keypair`;
 type MlKemEncapsExport<P extends MlKemParameterSet> = `_mlkem${P}_encaps`;
 type MlKemDecapsExport<P extends MlKemParameterSet> = `_mlkem${P}_decaps`;
+type MlKemKeyPairBatchExport<P extends MlKemParameterSet> =
+  `_mlkem${P}_keypair_batch`;
+type MlKemEncapsBatchExport<P extends MlKemParameterSet> =
+  `_mlkem${P}_encaps_batch`;
+type MlKemExpandedBytesExport<P extends MlKemParameterSet> =
+  `_mlkem${P}_expanded_bytes`;
+type MlKemExpandExport<P extends MlKemParameterSet> = `_mlkem${P}_expand`;
+type MlKemEncapsExpandedExport<P extends MlKemParameterSet> =
+  `_mlkem${P}_encaps_expanded`;
 
 /**
  * Complete runtime description of one FIPS 203 parameter set.
@@ -47,6 +59,11 @@ export interface MlKemSuiteDescriptor<
     readonly keypair: MlKemKeyPairExport<P>;
     readonly encaps: MlKemEncapsExport<P>;
     readonly decaps: MlKemDecapsExport<P>;
+    readonly keypairBatch: MlKemKeyPairBatchExport<P>;
+    readonly encapsBatch: MlKemEncapsBatchExport<P>;
+    readonly expandedBytes: MlKemExpandedBytesExport<P>;
+    readonly expand: MlKemExpandExport<P>;
+    readonly encapsExpanded: MlKemEncapsExpandedExport<P>;
   };
 }
 
@@ -71,6 +88,11 @@ export const ML_KEM_512_SUITE = freezeSuite({
     keypair: "_mlkem512_keypair",
     encaps: "_mlkem512_encaps",
     decaps: "_mlkem512_decaps",
+    keypairBatch: "_mlkem512_keypair_batch",
+    encapsBatch: "_mlkem512_encaps_batch",
+    expandedBytes: "_mlkem512_expanded_bytes",
+    expand: "_mlkem512_expand",
+    encapsExpanded: "_mlkem512_encaps_expanded",
   },
 } satisfies MlKemSuiteDescriptor<512>);
 
@@ -87,6 +109,11 @@ export const ML_KEM_768_SUITE = freezeSuite({
     keypair: "_mlkem768_keypair",
     encaps: "_mlkem768_encaps",
     decaps: "_mlkem768_decaps",
+    keypairBatch: "_mlkem768_keypair_batch",
+    encapsBatch: "_mlkem768_encaps_batch",
+    expandedBytes: "_mlkem768_expanded_bytes",
+    expand: "_mlkem768_expand",
+    encapsExpanded: "_mlkem768_encaps_expanded",
   },
 } satisfies MlKemSuiteDescriptor<768>);
 
@@ -103,6 +130,11 @@ export const ML_KEM_1024_SUITE = freezeSuite({
     keypair: "_mlkem1024_keypair",
     encaps: "_mlkem1024_encaps",
     decaps: "_mlkem1024_decaps",
+    keypairBatch: "_mlkem1024_keypair_batch",
+    encapsBatch: "_mlkem1024_encaps_batch",
+    expandedBytes: "_mlkem1024_expanded_bytes",
+    expand: "_mlkem1024_expand",
+    encapsExpanded: "_mlkem1024_encaps_expanded",
   },
 } satisfies MlKemSuiteDescriptor<1024>);
 
@@ -141,6 +173,27 @@ type MlKemDecapsFunction = (
   ciphertext: number,
   secretKey: number,
 ) => number;
+type MlKemKeyPairBatchFunction = (
+  publicKeys: number,
+  secretKeys: number,
+  coins64: number,
+  count: number,
+) => number;
+type MlKemEncapsBatchFunction = (
+  ciphertexts: number,
+  sharedSecrets: number,
+  publicKeys: number,
+  coins32: number,
+  count: number,
+) => number;
+type MlKemExpandedBytesFunction = () => number;
+type MlKemExpandFunction = (expanded: number, publicKey: number) => number;
+type MlKemEncapsExpandedFunction = (
+  ciphertext: number,
+  sharedSecret: number,
+  expanded: number,
+  coins32: number,
+) => number;
 
 /**
  * The deterministic ABI exported by the pinned, portable mlkem-native build.
@@ -156,6 +209,21 @@ export interface MlKemModule extends LibCrypto {
   _mlkem1024_keypair: MlKemKeyPairFunction;
   _mlkem1024_encaps: MlKemEncapsFunction;
   _mlkem1024_decaps: MlKemDecapsFunction;
+  _mlkem512_keypair_batch: MlKemKeyPairBatchFunction;
+  _mlkem512_encaps_batch: MlKemEncapsBatchFunction;
+  _mlkem768_keypair_batch: MlKemKeyPairBatchFunction;
+  _mlkem768_encaps_batch: MlKemEncapsBatchFunction;
+  _mlkem1024_keypair_batch: MlKemKeyPairBatchFunction;
+  _mlkem1024_encaps_batch: MlKemEncapsBatchFunction;
+  _mlkem512_expanded_bytes: MlKemExpandedBytesFunction;
+  _mlkem512_expand: MlKemExpandFunction;
+  _mlkem512_encaps_expanded: MlKemEncapsExpandedFunction;
+  _mlkem768_expanded_bytes: MlKemExpandedBytesFunction;
+  _mlkem768_expand: MlKemExpandFunction;
+  _mlkem768_encaps_expanded: MlKemEncapsExpandedFunction;
+  _mlkem1024_expanded_bytes: MlKemExpandedBytesFunction;
+  _mlkem1024_expand: MlKemExpandFunction;
+  _mlkem1024_encaps_expanded: MlKemEncapsExpandedFunction;
 }
 
 /** Compatibility type for protocol-v3 code while suite negotiation lands. */
@@ -211,6 +279,36 @@ export interface MlKemBackend<P extends MlKemParameterSet = MlKemParameterSet> {
   ): Promise<MlKemDecapsulation>;
 }
 
+/**
+ * A peer public key expanded once in WASM memory (see mlkem_expanded.h):
+ * H(pk), the parsed t-hat and the matrix A. Encapsulating against it skips the
+ * matrix expansion that dominates an encapsulation. The key holds byteLength
+ * bytes of module memory until free().
+ */
+export interface MlKemExpandedPublicKey {
+  /** A copy of the public key it was expanded from. */
+  readonly publicKey: Uint8Array;
+  /** Bytes of WASM memory held, for cache accounting. */
+  readonly byteLength: number;
+  readonly freed: boolean;
+  /** Idempotently wipes and frees the WASM memory. */
+  free(): void;
+}
+
+/**
+ * An ML-KEM backend that can also encapsulate against expanded public keys.
+ * Every backend from createMlKemBackend is one.
+ */
+export interface MlKemExpandingBackend<
+  P extends MlKemParameterSet = MlKemParameterSet,
+> extends MlKemBackend<P> {
+  expandPublicKey(publicKey: Uint8Array): Promise<MlKemExpandedPublicKey>;
+  /** Same result as encapsulate(expanded.publicKey), with fresh coins. */
+  encapsulateExpanded(
+    expanded: MlKemExpandedPublicKey,
+  ): Promise<MlKemEncapsulation>;
+}
+
 /** Compatibility aliases for the currently shipped ML-KEM-768 handshake. */
 export type MlKem768KeyPair = MlKemKeyPair;
 export type MlKem768Encapsulation = MlKemEncapsulation;
@@ -314,10 +412,50 @@ const makeDecapsulation = (sharedSecret: Uint8Array): MlKemDecapsulation => {
   };
 };
 
+/** WASM pointer of each live expanded key, keyed by the object handed out. */
+const expandedPointers = new WeakMap<
+  MlKemExpandedPublicKey,
+  {
+    readonly module: LibCrypto;
+    readonly parameterSet: MlKemParameterSet;
+    readonly pointer: number;
+  }
+>();
+
+const makeExpandedPublicKey = (
+  module: LibCrypto,
+  parameterSet: MlKemParameterSet,
+  publicKey: Uint8Array,
+  pointer: number,
+  byteLength: number,
+): MlKemExpandedPublicKey => {
+  let freed = false;
+  const expanded: MlKemExpandedPublicKey = {
+    publicKey,
+    byteLength,
+    get freed(): boolean {
+      return freed;
+    },
+    free(): void {
+      if (freed) return;
+      expandedPointers.delete(expanded);
+      secretFree(module, pointer, byteLength);
+      freed = true;
+    },
+  };
+  expandedPointers.set(expanded, { module, parameterSet, pointer });
+  return expanded;
+};
+
 interface SelectedMlKemExports {
   readonly keypair: MlKemKeyPairFunction;
   readonly encaps: MlKemEncapsFunction;
   readonly decaps: MlKemDecapsFunction;
+  readonly keypairBatch: MlKemKeyPairBatchFunction;
+  readonly encapsBatch: MlKemEncapsBatchFunction;
+  readonly expandedBytes: MlKemExpandedBytesFunction;
+  readonly expand: MlKemExpandFunction;
+  readonly encapsExpanded: MlKemEncapsExpandedFunction;
 }
 
 const requireMlKemExports = (
@@ -326,9 +464,16 @@ const requireMlKemExports = (
 ): SelectedMlKemExports => {
   const candidate = module as unknown as Record<string, unknown>;
   const names = suite.wasmExports;
-  const missing = [names.keypair, names.encaps, names.decaps].filter(
-    (name) => typeof candidate[name] !== "function",
-  );
+  const missing = [
+    names.keypair,
+    names.encaps,
+    names.decaps,
+    names.keypairBatch,
+    names.encapsBatch,
+    names.expandedBytes,
+    names.expand,
+    names.encapsExpanded,
+  ].filter((name) => typeof candidate[name] !== "function");
   if (missing.length !== 0)
     throw new Error(
       `${suite.standardName} WASM exports are unavailable; ` +
@@ -338,22 +483,159 @@ const requireMlKemExports = (
     keypair: (candidate[names.keypair] as MlKemKeyPairFunction).bind(module),
     encaps: (candidate[names.encaps] as MlKemEncapsFunction).bind(module),
     decaps: (candidate[names.decaps] as MlKemDecapsFunction).bind(module),
+    keypairBatch: (
+      candidate[names.keypairBatch] as MlKemKeyPairBatchFunction
+    ).bind(module),
+    encapsBatch: (
+      candidate[names.encapsBatch] as MlKemEncapsBatchFunction
+    ).bind(module),
+    expandedBytes: (
+      candidate[names.expandedBytes] as MlKemExpandedBytesFunction
+    ).bind(module),
+    expand: (candidate[names.expand] as MlKemExpandFunction).bind(module),
+    encapsExpanded: (
+      candidate[names.encapsExpanded] as MlKemEncapsExpandedFunction
+    ).bind(module),
   };
 };
 
-class WasmMlKemBackend<P extends MlKemParameterSet> implements MlKemBackend<P> {
+interface PendingRequest<T> {
+  readonly resolve: (value: T) => void;
+  readonly reject: (reason: unknown) => void;
+}
+
+interface PendingEncapsulation extends PendingRequest<MlKemEncapsulation> {
+  readonly publicKey: Uint8Array;
+}
+
+interface MlKemBatchQueue {
+  readonly keyPairs: Array<PendingRequest<MlKemKeyPair>>;
+  readonly encapsulations: PendingEncapsulation[];
+  scheduled: boolean;
+}
+
+/**
+ * Key generations and encapsulations requested for one parameter set in the
+ * same turn, e.g. by every edge of a room advancing its epoch together. Each
+ * edge has its own module (handleConnectToPeer), so the queue is per realm,
+ * not per module: both operations are stateless, take their coins from JS and
+ * return copied-out bytes, so the batch runs on the module of the backend that
+ * scheduled the flush. It is flushed from a microtask in batch calls of up to
+ * ML_KEM_BATCH_MAX items.
+ */
+const batchQueues = new Map<MlKemParameterSet, MlKemBatchQueue>();
+
+const getBatchQueue = (parameterSet: MlKemParameterSet): MlKemBatchQueue => {
+  let queue = batchQueues.get(parameterSet);
+  if (queue === undefined) {
+    queue = { keyPairs: [], encapsulations: [], scheduled: false };
+    batchQueues.set(parameterSet, queue);
+  }
+  return queue;
+};
+
+class WasmMlKemBackend<P extends MlKemParameterSet>
+  implements MlKemExpandingBackend<P>
+{
   readonly #module: LibCrypto;
   readonly #exports: SelectedMlKemExports;
+  readonly #queue: MlKemBatchQueue;
   readonly suite: Readonly<MlKemSuiteDescriptor<P>>;
 
   constructor(module: LibCrypto, suite: Readonly<MlKemSuiteDescriptor<P>>) {
     this.#module = module;
     this.suite = suite;
     this.#exports = requireMlKemExports(module, suite);
+    this.#queue = getBatchQueue(suite.parameterSet);
   }
 
-  async generateKeyPair(): Promise<MlKemKeyPair> {
-    await Promise.resolve();
+  /**
+   * Queued with every other key generation of this turn in the realm; each
+   * key pair still uses its own 64 bytes of fresh randomness.
+   */
+  generateKeyPair(): Promise<MlKemKeyPair> {
+    return new Promise((resolve, reject) => {
+      this.#queue.keyPairs.push({ resolve, reject });
+      this.#schedule();
+    });
+  }
+
+  /**
+   * Queued with every other encapsulation of this turn in the realm; each one
+   * still uses its own 32 bytes of fresh randomness.
+   */
+  encapsulate(publicKey: Uint8Array): Promise<MlKemEncapsulation> {
+    return new Promise((resolve, reject) => {
+      requireExactBytes(
+        publicKey,
+        `${this.suite.standardName} public key`,
+        this.suite.publicKeyBytes,
+      );
+      this.#queue.encapsulations.push({
+        publicKey: Uint8Array.from(publicKey),
+        resolve,
+        reject,
+      });
+      this.#schedule();
+    });
+  }
+
+  #schedule(): void {
+    const queue = this.#queue;
+    if (queue.scheduled) return;
+    queue.scheduled = true;
+    queueMicrotask(() => {
+      queue.scheduled = false;
+      const keyPairs = queue.keyPairs.splice(0);
+      const encapsulations = queue.encapsulations.splice(0);
+      for (let i = 0; i < keyPairs.length; i += ML_KEM_BATCH_MAX)
+        this.#settleKeyPairs(keyPairs.slice(i, i + ML_KEM_BATCH_MAX));
+      for (let i = 0; i < encapsulations.length; i += ML_KEM_BATCH_MAX)
+        this.#settleEncapsulations(
+          encapsulations.slice(i, i + ML_KEM_BATCH_MAX),
+        );
+    });
+  }
+
+  #settleKeyPairs(requests: Array<PendingRequest<MlKemKeyPair>>): void {
+    try {
+      const keyPairs = this.#keyPairBatch(requests.length);
+      requests.forEach((request, i) => {
+        request.resolve(keyPairs[i]);
+      });
+    } catch (error) {
+      for (const request of requests) request.reject(error);
+    }
+  }
+
+  #settleEncapsulations(requests: PendingEncapsulation[]): void {
+    try {
+      const encapsulations = this.#encapsBatch(
+        requests.map((request) => request.publicKey),
+      );
+      requests.forEach((request, i) => {
+        request.resolve(encapsulations[i]);
+      });
+      return;
+    } catch (error) {
+      if (requests.length === 1) {
+        requests[0].reject(error);
+        return;
+      }
+    }
+
+    // One key failing the modulus check fails the whole call; retry one by
+    // one so only its own caller sees the error.
+    for (const request of requests) {
+      try {
+        request.resolve(this.#encapsBatch([request.publicKey])[0]);
+      } catch (error) {
+        request.reject(error);
+      }
+    }
+  }
+
+  #keyPairBatch(count: number): MlKemKeyPair[] {
     const module = this.#module;
     const suite = this.suite;
     let publicKeyPtr: number | undefined;
@@ -364,47 +646,156 @@ class WasmMlKemBackend<P extends MlKemParameterSet> implements MlKemBackend<P> {
       publicKeyPtr = checkedMalloc(
         module,
         suite,
-        suite.publicKeyBytes,
+        count * suite.publicKeyBytes,
         "public key",
       );
       secretKeyPtr = checkedMalloc(
         module,
         suite,
-        suite.secretKeyBytes,
+        count * suite.secretKeyBytes,
         "secret key",
       );
       coinsPtr = checkedMalloc(
         module,
         suite,
-        suite.keyPairRandomBytes,
+        count * suite.keyPairRandomBytes,
         "key-generation randomness",
       );
 
-      const coins = heapView(module, coinsPtr, suite.keyPairRandomBytes);
+      const coins = heapView(
+        module,
+        coinsPtr,
+        count * suite.keyPairRandomBytes,
+      );
       fillRandomBytesInto(coins);
 
-      const result = this.#exports.keypair(
+      const result = this.#exports.keypairBatch(
         publicKeyPtr,
         secretKeyPtr,
         coinsPtr,
+        count,
       );
       if (result !== 0)
         throw new Error(
           `${suite.standardName} key generation failed (${String(result)})`,
         );
 
-      return makeKeyPair(
-        Uint8Array.from(heapView(module, publicKeyPtr, suite.publicKeyBytes)),
-        Uint8Array.from(heapView(module, secretKeyPtr, suite.secretKeyBytes)),
+      const keyPairs: MlKemKeyPair[] = [];
+      for (let i = 0; i < count; i++)
+        keyPairs.push(
+          makeKeyPair(
+            Uint8Array.from(
+              heapView(
+                module,
+                publicKeyPtr + i * suite.publicKeyBytes,
+                suite.publicKeyBytes,
+              ),
+            ),
+            Uint8Array.from(
+              heapView(
+                module,
+                secretKeyPtr + i * suite.secretKeyBytes,
+                suite.secretKeyBytes,
+              ),
+            ),
+          ),
+        );
+      return keyPairs;
+    } finally {
+      publicFree(module, publicKeyPtr);
+      secretFree(module, secretKeyPtr, count * suite.secretKeyBytes);
+      secretFree(module, coinsPtr, count * suite.keyPairRandomBytes);
+    }
+  }
+
+  #encapsBatch(publicKeys: Uint8Array[]): MlKemEncapsulation[] {
+    const module = this.#module;
+    const suite = this.suite;
+    const count = publicKeys.length;
+    let ciphertextPtr: number | undefined;
+    let sharedSecretPtr: number | undefined;
+    let publicKeyPtr: number | undefined;
+    let coinsPtr: number | undefined;
+
+    try {
+      ciphertextPtr = checkedMalloc(
+        module,
+        suite,
+        count * suite.ciphertextBytes,
+        "ciphertext",
+      );
+      sharedSecretPtr = checkedMalloc(
+        module,
+        suite,
+        count * suite.sharedSecretBytes,
+        "shared secret",
+      );
+      publicKeyPtr = checkedMalloc(
+        module,
+        suite,
+        count * suite.publicKeyBytes,
+        "public key",
+      );
+      coinsPtr = checkedMalloc(
+        module,
+        suite,
+        count * suite.encapsRandomBytes,
+        "encapsulation randomness",
+      );
+
+      for (let i = 0; i < count; i++)
+        heapView(
+          module,
+          publicKeyPtr + i * suite.publicKeyBytes,
+          suite.publicKeyBytes,
+        ).set(publicKeys[i]);
+      const coins = heapView(module, coinsPtr, count * suite.encapsRandomBytes);
+      fillRandomBytesInto(coins);
+
+      const result = this.#exports.encapsBatch(
+        ciphertextPtr,
+        sharedSecretPtr,
+        publicKeyPtr,
+        coinsPtr,
+        count,
       );
+      if (result !== 0)
+        throw new Error(
+          `${suite.standardName} encapsulation failed (${String(result)})`,
+        );
+
+      const encapsulations: MlKemEncapsulation[] = [];
+      for (let i = 0; i < count; i++)
+        encapsulations.push(
+          makeEncapsulation(
+            Uint8Array.from(
+              heapView(
+                module,
+                ciphertextPtr + i * suite.ciphertextBytes,
+                suite.ciphertextBytes,
+              ),
+            ),
+            Uint8Array.from(
+              heapView(
+                module,
+                sharedSecretPtr + i * suite.sharedSecretBytes,
+                suite.sharedSecretBytes,
+              ),
+            ),
+          ),
+        );
+      return encapsulations;
     } finally {
+      publicFree(module, ciphertextPtr);
+      secretFree(module, sharedSecretPtr, count * suite.sharedSecretBytes);
       publicFree(module, publicKeyPtr);
-      secretFree(module, secretKeyPtr, suite.secretKeyBytes);
-      secretFree(module, coinsPtr, suite.keyPairRandomBytes);
+      secretFree(module, coinsPtr, count * suite.encapsRandomBytes);
     }
   }
 
-  async encapsulate(publicKey: Uint8Array): Promise<MlKemEncapsulation> {
+  async expandPublicKey(
+    publicKey: Uint8Array,
+  ): Promise<MlKemExpandedPublicKey> {
     await Promise.resolve();
     const module = this.#module;
     const suite = this.suite;
@@ -414,9 +805,65 @@ class WasmMlKemBackend<P extends MlKemParameterSet> implements MlKemBackend<P> {
       suite.publicKeyBytes,
     );
 
+    const byteLength = this.#exports.expandedBytes();
+    let expandedPtr: number | undefined;
+    let publicKeyPtr: number | undefined;
+
+    try {
+      expandedPtr = checkedMalloc(
+        module,
+        suite,
+        byteLength,
+        "expanded public key",
+      );
+      publicKeyPtr = checkedMalloc(
+        module,
+        suite,
+        suite.publicKeyBytes,
+        "public key",
+      );
+
+      heapView(module, publicKeyPtr, suite.publicKeyBytes).set(publicKey);
+
+      const result = this.#exports.expand(expandedPtr, publicKeyPtr);
+      if (result !== 0)
+        throw new Error(
+          `${suite.standardName} key expansion failed (${String(result)})`,
+        );
+
+      const expanded = makeExpandedPublicKey(
+        module,
+        suite.parameterSet,
+        Uint8Array.from(publicKey),
+        expandedPtr,
+        byteLength,
+      );
+      expandedPtr = undefined;
+      return expanded;
+    } finally {
+      secretFree(module, expandedPtr, byteLength);
+      publicFree(module, publicKeyPtr);
+    }
+  }
+
+  async encapsulateExpanded(
+    expanded: MlKemExpandedPublicKey,
+  ): Promise<MlKemEncapsulation> {
+    await Promise.resolve();
+    const module = this.#module;
+    const suite = this.suite;
+    const live = expandedPointers.get(expanded);
+    if (
+      live === undefined ||
+      live.module !== module ||
+      live.parameterSet !== suite.parameterSet
+    )
+      throw new Error(
+        `${suite.standardName} expanded public key is freed or foreign`,
+      );
+
     let ciphertextPtr: number | undefined;
     let sharedSecretPtr: number | undefined;
-    let publicKeyPtr: number | undefined;
     let coinsPtr: number | undefined;
 
     try {
@@ -432,12 +879,6 @@ class WasmMlKemBackend<P extends MlKemParameterSet> implements MlKemBackend<P> {
         suite.sharedSecretBytes,
         "shared secret",
       );
-      publicKeyPtr = checkedMalloc(
-        module,
-        suite,
-        suite.publicKeyBytes,
-        "public key",
-      );
       coinsPtr = checkedMalloc(
         module,
         suite,
@@ -445,14 +886,12 @@ class WasmMlKemBackend<P extends MlKemParameterSet> implements MlKemBackend<P> {
         "encapsulation randomness",
       );
 
-      heapView(module, publicKeyPtr, suite.publicKeyBytes).set(publicKey);
-      const coins = heapView(module, coinsPtr, suite.encapsRandomBytes);
-      fillRandomBytesInto(coins);
+      fillRandomBytesInto(heapView(module, coinsPtr, suite.encapsRandomBytes));
 
-      const result = this.#exports.encaps(
+      const result = this.#exports.encapsExpanded(
         ciphertextPtr,
         sharedSecretPtr,
-        publicKeyPtr,
+        live.pointer,
         coinsPtr,
       );
       if (result !== 0)
@@ -469,7 +908,6 @@ class WasmMlKemBackend<P extends MlKemParameterSet> implements MlKemBackend<P> {
     } finally {
       publicFree(module, ciphertextPtr);
       secretFree(module, sharedSecretPtr, suite.sharedSecretBytes);
-      publicFree(module, publicKeyPtr);
       secretFree(module, coinsPtr, suite.encapsRandomBytes);
     }
   }
@@ -545,7 +983,7 @@ class WasmMlKemBackend<P extends MlKemParameterSet> implements MlKemBackend<P> {
 export const createMlKemBackend = <P extends MlKemParameterSet>(
   module: LibCrypto,
   suite: Readonly<MlKemSuiteDescriptor<P>>,
-): MlKemBackend<P> => {
+): MlKemExpandingBackend<P> => {
   const canonicalSuite = getMlKemSuite(suite.parameterSet);
   if (suite !== canonicalSuite)
     throw new TypeError(
@@ -559,3 +997,102 @@ export const createMlKemBackend = <P extends MlKemParameterSet>(
  */
 export const createMlKem768Backend = (module: LibCrypto): MlKem768Backend =>
   createMlKemBackend(module, ML_KEM_768_SUITE);
+
+interface MlKemExpandedKeyCacheEntry {
+  readonly expanded: MlKemExpandedPublicKey;
+  /** Encapsulations in flight; an evicted key is freed when none remain. */
+  users: number;
+  evicted: boolean;
+}
+
+/**
+ * The expanded public keys of one room's peers, bounded by the WASM memory
+ * they hold and evicted least recently used first. encapsulate() expands a key
+ * the first time it sees it and reuses the expansion after that. A key larger
+ * than the whole budget is expanded, used once and freed.
+ */
+export class MlKemExpandedKeyCache<
+  P extends MlKemParameterSet = MlKemParameterSet,
+> {
+  readonly #backend: MlKemExpandingBackend<P>;
+  readonly #entries = new Map<string, MlKemExpandedKeyCacheEntry>();
+  #bytes = 0;
+  readonly maxBytes: number;
+
+  constructor(backend: MlKemExpandingBackend<P>, maxBytes: number) {
+    if (!Number.isSafeInteger(maxBytes) || maxBytes < 0)
+      throw new RangeError("maxBytes must be a non-negative safe integer");
+    this.#backend = backend;
+    this.maxBytes = maxBytes;
+  }
+
+  /** WASM bytes held by the cached keys. */
+  get bytes(): number {
+    return this.#bytes;
+  }
+
+  get size(): number {
+    return this.#entries.size;
+  }
+
+  async encapsulate(publicKey: Uint8Array): Promise<MlKemEncapsulation> {
+    const suite = this.#backend.suite;
+    requireExactBytes(
+      publicKey,
+      `${suite.standardName} public key`,
+      suite.publicKeyBytes,
+    );
+    const id = uint8ArrayToHex(publicKey);
+
+    let entry = this.#entries.get(id);
+    if (entry === undefined) {
+      const expanded = await this.#backend.expandPublicKey(publicKey);
+      // A concurrent call may have expanded the same key meanwhile.
+      entry = this.#entries.get(id);
+      if (entry === undefined) {
+        entry = { expanded, users: 0, evicted: false };
+        this.#bytes += expanded.byteLength;
+      } else {
+        expanded.free();
+      }
+    }
+    this.#entries.delete(id);
+    this.#entries.set(id, entry);
+    entry.users++;
+
+    try {
+      for (const oldest of this.#entries.keys()) {
+        if (this.#bytes <= this.maxBytes) break;
+        if (oldest !== id) this.#evict(oldest);
+      }
+      if (this.#bytes > this.maxBytes) this.#evict(id);
+
+      return await this.#backend.encapsulateExpanded(entry.expanded);
+    } finally {
+      entry.users--;
+      if (entry.evicted && entry.users === 0) entry.expanded.free();
+    }
+  }
+
+  /** Drops one peer's key, e.g. when the peer leaves the room. */
+  delete(publicKey: Uint8Array): boolean {
+    const id = uint8ArrayToHex(publicKey);
+    if (!this.#entries.has(id)) return false;
+    this.#evict(id);
+    return true;
+  }
+
+  /** Drops every key, e.g. when the room closes. */
+  clear(): void {
+    for (const id of [...this.#entries.keys()]) this.#evict(id);
+  }
+
+  #evict(id: string): void {
+    const entry = this.#entries.get(id);
+    if (entry === undefined) return;
+    this.#entries.delete(id);
+    this.#bytes -= entry.expanded.byteLength;
+    entry.evicted = true;
+    if (entry.users === 0) entry.expanded.free();
+  }
+}
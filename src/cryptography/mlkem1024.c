@@ -11,7 +11,8 @@
  * this compilation unit emits only ML-KEM-1024-specific code.
  *
  * WebCrypto supplies entropy to the caller-facing TypeScript layer. Keep the
- * randomized upstream API out of the binary and select portable C for WASM.
+ * randomized upstream API out of the binary. Portable C for scalar WASM, the
+ * mlkem_simd.h backend (base multiplication only here) for SIMD128.
  */
 #define MLK_CONFIG_PARAMETER_SET 1024
 #define MLK_CONFIG_NAMESPACE_PREFIX p2party_mlkem
@@ -19,7 +20,20 @@
 #define MLK_CONFIG_MULTILEVEL_NO_SHARED
 #define MLK_CONFIG_NO_RANDOMIZED_API
 #define MLK_CONFIG_NO_SUPERCOP
+#if defined(__wasm_simd128__)
+/* The -msimd128 artifact: NTT, base multiplication, rejection sampling and
+ * compression from mlkem_simd.h, the x4 Keccak permutation from
+ * mlkem_keccakx4.h (paths relative to the vendored common.h). Leaving NO_ASM
+ * unset makes sys.h assume inline assembly, so keep the value barrier in
+ * plain C. */
+#define MLK_CONFIG_USE_NATIVE_BACKEND_ARITH
+#define MLK_CONFIG_ARITH_BACKEND_FILE "../../../../mlkem_simd.h"
+#define MLK_CONFIG_USE_NATIVE_BACKEND_FIPS202
+#define MLK_CONFIG_FIPS202_BACKEND_FILE "../../../../mlkem_keccakx4.h"
+#define MLK_CONFIG_NO_ASM_VALUE_BARRIER
+#else
 #define MLK_CONFIG_NO_ASM
+#endif
 #define MLK_CONFIG_CUSTOM_ZEROIZE
 
 static void
@@ -44,6 +58,9 @@ _Static_assert(MLKEM1024_CIPHERTEXTBYTES == P2PARTY_MLKEM1024_CIPHERTEXTBYTES,
 _Static_assert(MLKEM_BYTES == P2PARTY_MLKEM1024_BYTES,
                "ML-KEM shared-secret size mismatch");
 
+#include "./mlkem_batch.h"
+#include "./mlkem_expanded.h"
+
 #include "./vendor/mlkem-native/mlkem/mlkem_native.c"
 
 int
@@ -70,3 +87,39 @@ mlkem1024_decaps(uint8_t ss[P2PARTY_MLKEM1024_BYTES],
 {
   return p2party_mlkem1024_dec(ss, ct, sk);
 }
+
+int
+mlkem1024_keypair_batch(uint8_t *pk, uint8_t *sk, const uint8_t *coins,
+                        const unsigned int COUNT)
+{
+  return mlk_batch_keypair(pk, sk, coins, COUNT);
+}
+
+int
+mlkem1024_encaps_batch(uint8_t *ct, uint8_t *ss, const uint8_t *pk,
+                       const uint8_t *coins, const unsigned int COUNT)
+{
+  return mlk_batch_encaps(ct, ss, pk, coins, COUNT);
+}
+
+size_t
+mlkem1024_expanded_bytes(void)
+{
+  return MLK_EXPANDED_BYTES;
+}
+
+int
+mlkem1024_expand(uint8_t *expanded,
+                 const uint8_t pk[P2PARTY_MLKEM1024_PUBLICKEYBYTES])
+{
+  return mlk_expand_pk(expanded, pk);
+}
+
+int
+mlkem1024_encaps_expanded(
+    uint8_t ct[P2PARTY_MLKEM1024_CIPHERTEXTBYTES],
+    uint8_t ss[P2PARTY_MLKEM1024_BYTES], const uint8_t *expanded,
+    const uint8_t coins[P2PARTY_MLKEM1024_ENCAPSCOINBYTES])
+{
+  return mlk_encaps_expanded(ct, ss, expanded, coins);
+}
@@ -12,7 +12,10 @@
  *
  * WebCrypto supplies the entropy to the caller-facing TypeScript layer. Keep
  * the randomized upstream API out of the binary so there is no second RNG
- * path, and select the portable C backend because the target is WebAssembly.
+ * path. The target is WebAssembly, which upstream has no backend for: the
+ * scalar artifact runs the portable C, the SIMD one the arithmetic backend in
+ * mlkem_simd.h and the x4 Keccak in mlkem_keccakx4.h. Both compute identical
+ * results.
  */
 #define MLK_CONFIG_PARAMETER_SET 768
 #define MLK_CONFIG_NAMESPACE_PREFIX p2party_mlkem
@@ -20,11 +23,24 @@
 #define MLK_CONFIG_MULTILEVEL_WITH_SHARED
 #define MLK_CONFIG_NO_RANDOMIZED_API
 #define MLK_CONFIG_NO_SUPERCOP
+#if defined(__wasm_simd128__)
+/* The -msimd128 artifact: NTT, base multiplication, rejection sampling and
+ * compression from mlkem_simd.h, the x4 Keccak permutation from
+ * mlkem_keccakx4.h (paths relative to the vendored common.h). Leaving NO_ASM
+ * unset makes sys.h assume inline assembly, so keep the value barrier in
+ * plain C. */
+#define MLK_CONFIG_USE_NATIVE_BACKEND_ARITH
+#define MLK_CONFIG_ARITH_BACKEND_FILE "../../../../mlkem_simd.h"
+#define MLK_CONFIG_USE_NATIVE_BACKEND_FIPS202
+#define MLK_CONFIG_FIPS202_BACKEND_FILE "../../../../mlkem_keccakx4.h"
+#define MLK_CONFIG_NO_ASM_VALUE_BARRIER
+#else
 #define MLK_CONFIG_NO_ASM
+#endif
 #define MLK_CONFIG_CUSTOM_ZEROIZE
 
 /*
- * MLK_CONFIG_NO_ASM requires a consumer-provided secure erase. Volatile byte
+ * Upstream's secure erase needs inline assembly; provide one. Volatile byte
  * stores prevent the compiler from proving that these writes are dead.
  */
 static void
@@ -49,6 +65,9 @@ _Static_assert(MLKEM768_CIPHERTEXTBYTES == P2PARTY_MLKEM768_CIPHERTEXTBYTES,
 _Static_assert(MLKEM_BYTES == P2PARTY_MLKEM768_BYTES,
                "ML-KEM shared-secret size mismatch");
 
+#include "./mlkem_batch.h"
+#include "./mlkem_expanded.h"
+
 #include "./vendor/mlkem-native/mlkem/mlkem_native.c"
 
 int
@@ -75,3 +94,39 @@ mlkem768_decaps(uint8_t ss[P2PARTY_MLKEM768_BYTES],
 {
   return p2party_mlkem768_dec(ss, ct, sk);
 }
+
+int
+mlkem768_keypair_batch(uint8_t *pk, uint8_t *sk, const uint8_t *coins,
+                       const unsigned int COUNT)
+{
+  return mlk_batch_keypair(pk, sk, coins, COUNT);
+}
+
+int
+mlkem768_encaps_batch(uint8_t *ct, uint8_t *ss, const uint8_t *pk,
+                      const uint8_t *coins, const unsigned int COUNT)
+{
+  return mlk_batch_encaps(ct, ss, pk, coins, COUNT);
+}
+
+size_t
+mlkem768_expanded_bytes(void)
+{
+  return MLK_EXPANDED_BYTES;
+}
+
+int
+mlkem768_expand(uint8_t *expanded,
+                const uint8_t pk[P2PARTY_MLKEM768_PUBLICKEYBYTES])
+{
+  return mlk_expand_pk(expanded, pk);
+}
+
+int
+mlkem768_encaps_expanded(uint8_t ct[P2PARTY_MLKEM768_CIPHERTEXTBYTES],
+                         uint8_t ss[P2PARTY_MLKEM768_BYTES],
+                         const uint8_t *expanded,
+                         const uint8_t coins[P2PARTY_MLKEM768_ENCAPSCOINBYTES])
+{
+  return mlk_encaps_expanded(ct, ss, expanded, coins);
+}
@@ -1,6 +1,7 @@
 #ifndef P2PARTY_MLKEM768_H
 #define P2PARTY_MLKEM768_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define P2PARTY_MLKEM768_PUBLICKEYBYTES 1184
@@ -9,6 +10,7 @@
 #define P2PARTY_MLKEM768_BYTES 32
 #define P2PARTY_MLKEM768_KEYPAIRCOINBYTES 64
 #define P2PARTY_MLKEM768_ENCAPSCOINBYTES 32
+#define P2PARTY_MLKEM768_BATCH_MAX 4
 
 /*
  * Deterministic ML-KEM-768 boundary. The caller must supply cryptographically
@@ -28,4 +30,35 @@ int mlkem768_decaps(uint8_t ss[P2PARTY_MLKEM768_BYTES],
                     const uint8_t ct[P2PARTY_MLKEM768_CIPHERTEXTBYTES],
                     const uint8_t sk[P2PARTY_MLKEM768_SECRETKEYBYTES]);
 
+/*
+ * COUNT (1 to P2PARTY_MLKEM768_BATCH_MAX) independent key generations or
+ * encapsulations in one call, sharing the four Keccak lanes for H and G (see
+ * mlkem_batch.h). Keys, ciphertexts, secrets and coins are packed back to
+ * back; item i is exactly what the single-item call returns for its coins. On
+ * failure every output is zeroed.
+ */
+int mlkem768_keypair_batch(uint8_t *pk, uint8_t *sk, const uint8_t *coins,
+                           const unsigned int COUNT);
+
+int mlkem768_encaps_batch(uint8_t *ct, uint8_t *ss, const uint8_t *pk,
+                          const uint8_t *coins, const unsigned int COUNT);
+
+/*
+ * A public key expanded once for repeated encapsulation (see mlkem_expanded.h):
+ * mlkem768_expanded_bytes() bytes of caller memory, of any alignment, holding
+ * H(pk), t-hat and the matrix A. Expanding a key that fails the modulus check
+ * fails and leaves the memory zeroed. mlkem768_encaps_expanded returns exactly
+ * what mlkem768_encaps returns for the original key and the same coins. The
+ * caller wipes the memory when done.
+ */
+size_t mlkem768_expanded_bytes(void);
+
+int mlkem768_expand(uint8_t *expanded,
+                    const uint8_t pk[P2PARTY_MLKEM768_PUBLICKEYBYTES]);
+
+int mlkem768_encaps_expanded(
+    uint8_t ct[P2PARTY_MLKEM768_CIPHERTEXTBYTES],
+    uint8_t ss[P2PARTY_MLKEM768_BYTES], const uint8_t *expanded,
+    const uint8_t coins[P2PARTY_MLKEM768_ENCAPSCOINBYTES]);
+
 #endif /* P2PARTY_MLKEM768_H */
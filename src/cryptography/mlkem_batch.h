@@ -0,0 +1,181 @@
+#ifndef mlkem_batch_H
+#define mlkem_batch_H
+
+/*
+ * Batched key generation and encapsulation over the vendored mlkem-native,
+ * included by mlkem512/768/1024.c ahead of mlkem_native.c so the internal
+ * (namespaced) FIPS 203 building blocks of that parameter set are declared.
+ *
+ * Up to MLK_BATCH_MAX independent items share the four Keccak lanes for the
+ * hashes FIPS 203 computes outside K-PKE: H(pk) for every key generation and
+ * encapsulation, and G(m || H(pk)) for every encapsulation. K-PKE itself runs
+ * per item; its matrix expansion and noise sampling already take the x4
+ * SHAKE lanes upstream. Each item uses its own coins exactly as the
+ * single-item call does, so item i is byte-identical to mlkemNNN_keypair or
+ * mlkemNNN_encaps on its coins. A single item takes that call directly, since
+ * a lone item would leave three lanes idle.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./vendor/mlkem-native/mlkem/src/common.h"
+#include "./vendor/mlkem-native/mlkem/src/fips202/fips202.h"
+#include "./vendor/mlkem-native/mlkem/src/fips202/keccakf1600.h"
+#include "./vendor/mlkem-native/mlkem/src/indcpa.h"
+#include "./vendor/mlkem-native/mlkem/src/kem.h"
+
+#if defined(MLK_CONFIG_KEYGEN_PCT)
+#error mlkem_batch.h does not run the key-generation PCT
+#endif
+
+#define MLK_BATCH_MAX 4U
+
+/* SHA3 at RATE over the four lanes' equally long inputs, one x4 permutation
+ * per block. OUTLEN must not exceed RATE. */
+static void
+mlk_batch_sha3x4(uint8_t *const out[MLK_KECCAK_WAY], const unsigned int OUTLEN,
+                 const uint8_t *const in[MLK_KECCAK_WAY], size_t inlen,
+                 const unsigned int RATE)
+{
+  MLK_ALIGN uint64_t state[MLK_KECCAK_LANES * MLK_KECCAK_WAY];
+  const uint8_t pad = 0x06, end = 0x80;
+  size_t off = 0;
+
+  mlk_memset(state, 0, sizeof state);
+
+  for (; inlen - off >= RATE; off += RATE)
+  {
+    mlk_keccakf1600x4_xor_bytes(state, in[0] + off, in[1] + off, in[2] + off,
+                                in[3] + off, 0, RATE);
+    mlk_keccakf1600x4_permute(state);
+  }
+  if (inlen > off)
+    mlk_keccakf1600x4_xor_bytes(state, in[0] + off, in[1] + off, in[2] + off,
+                                in[3] + off, 0, (unsigned int)(inlen - off));
+  mlk_keccakf1600x4_xor_bytes(state, &pad, &pad, &pad, &pad,
+                              (unsigned int)(inlen - off), 1);
+  mlk_keccakf1600x4_xor_bytes(state, &end, &end, &end, &end, RATE - 1, 1);
+  mlk_keccakf1600x4_permute(state);
+
+  mlk_keccakf1600x4_extract_bytes(state, out[0], out[1], out[2], out[3], 0,
+                                  OUTLEN);
+  mlk_zeroize(state, sizeof state);
+}
+
+/* Lane l hashes item l, or repeats item 0 into spare when COUNT <= l. */
+static void
+mlk_batch_lanes(uint8_t *out[MLK_KECCAK_WAY],
+                const uint8_t *in[MLK_KECCAK_WAY], uint8_t *out0,
+                const size_t OUTSTRIDE, const uint8_t *in0,
+                const size_t INSTRIDE, uint8_t *spare,
+                const unsigned int COUNT)
+{
+  unsigned int l;
+
+  for (l = 0; l < MLK_KECCAK_WAY; l++)
+  {
+    out[l] = l < COUNT ? out0 + l * OUTSTRIDE : spare;
+    in[l] = l < COUNT ? in0 + l * INSTRIDE : in0;
+  }
+}
+
+static int
+mlk_batch_keypair(uint8_t *pk, uint8_t *sk, const uint8_t *coins,
+                  const unsigned int COUNT)
+{
+  uint8_t spare[MLKEM_SYMBYTES];
+  uint8_t *out[MLK_KECCAK_WAY];
+  const uint8_t *in[MLK_KECCAK_WAY];
+  unsigned int i;
+  int ret = 0;
+
+  if (COUNT == 0 || COUNT > MLK_BATCH_MAX) return MLK_ERR_FAIL;
+  if (COUNT == 1) return mlk_kem_keypair_derand(pk, sk, coins, NULL);
+
+  for (i = 0; i < COUNT; i++)
+  {
+    uint8_t *pk_i = pk + i * MLKEM_INDCCA_PUBLICKEYBYTES;
+    uint8_t *sk_i = sk + i * MLKEM_INDCCA_SECRETKEYBYTES;
+
+    ret = mlk_indcpa_keypair_derand(pk_i, sk_i, coins + i * 2 * MLKEM_SYMBYTES,
+                                    NULL);
+    if (ret != 0) goto cleanup;
+    mlk_memcpy(sk_i + MLKEM_INDCPA_SECRETKEYBYTES, pk_i,
+               MLKEM_INDCCA_PUBLICKEYBYTES);
+    mlk_memcpy(sk_i + MLKEM_INDCCA_SECRETKEYBYTES - MLKEM_SYMBYTES,
+               coins + i * 2 * MLKEM_SYMBYTES + MLKEM_SYMBYTES, MLKEM_SYMBYTES);
+  }
+
+  mlk_batch_lanes(out, in,
+                  sk + MLKEM_INDCCA_SECRETKEYBYTES - 2 * MLKEM_SYMBYTES,
+                  MLKEM_INDCCA_SECRETKEYBYTES, pk, MLKEM_INDCCA_PUBLICKEYBYTES,
+                  spare, COUNT);
+  mlk_batch_sha3x4(out, MLKEM_SYMBYTES, in, MLKEM_INDCCA_PUBLICKEYBYTES,
+                   SHA3_256_RATE);
+
+cleanup:
+  if (ret != 0)
+  {
+    mlk_zeroize(pk, COUNT * MLKEM_INDCCA_PUBLICKEYBYTES);
+    mlk_zeroize(sk, COUNT * MLKEM_INDCCA_SECRETKEYBYTES);
+  }
+
+  return ret;
+}
+
+static int
+mlk_batch_encaps(uint8_t *ct, uint8_t *ss, const uint8_t *pk,
+                 const uint8_t *coins, const unsigned int COUNT)
+{
+  MLK_ALIGN uint8_t buf[MLK_BATCH_MAX][2 * MLKEM_SYMBYTES];
+  MLK_ALIGN uint8_t kr[MLK_BATCH_MAX][2 * MLKEM_SYMBYTES];
+  uint8_t spare[2 * MLKEM_SYMBYTES];
+  uint8_t *out[MLK_KECCAK_WAY];
+  const uint8_t *in[MLK_KECCAK_WAY];
+  unsigned int i;
+  int ret = 0;
+
+  if (COUNT == 0 || COUNT > MLK_BATCH_MAX) return MLK_ERR_FAIL;
+  if (COUNT == 1) return mlk_kem_enc_derand(ct, ss, pk, coins, NULL);
+
+  /* Every key passes the modulus check before any work is done. */
+  for (i = 0; i < COUNT; i++)
+  {
+    ret = mlk_kem_check_pk(pk + i * MLKEM_INDCCA_PUBLICKEYBYTES, NULL);
+    if (ret != 0) goto cleanup;
+    mlk_memcpy(buf[i], coins + i * MLKEM_SYMBYTES, MLKEM_SYMBYTES);
+  }
+
+  mlk_batch_lanes(out, in, buf[0] + MLKEM_SYMBYTES, sizeof buf[0], pk,
+                  MLKEM_INDCCA_PUBLICKEYBYTES, spare, COUNT);
+  mlk_batch_sha3x4(out, MLKEM_SYMBYTES, in, MLKEM_INDCCA_PUBLICKEYBYTES,
+                   SHA3_256_RATE);
+  mlk_batch_lanes(out, in, kr[0], sizeof kr[0], buf[0], sizeof buf[0], spare,
+                  COUNT);
+  mlk_batch_sha3x4(out, 2 * MLKEM_SYMBYTES, in, 2 * MLKEM_SYMBYTES,
+                   SHA3_512_RATE);
+
+  for (i = 0; i < COUNT; i++)
+  {
+    ret = mlk_indcpa_enc(ct + i * MLKEM_INDCCA_CIPHERTEXTBYTES, buf[i],
+                         pk + i * MLKEM_INDCCA_PUBLICKEYBYTES,
+                         kr[i] + MLKEM_SYMBYTES, NULL);
+    if (ret != 0) goto cleanup;
+    mlk_memcpy(ss + i * MLKEM_SSBYTES, kr[i], MLKEM_SSBYTES);
+  }
+
+cleanup:
+  if (ret != 0)
+  {
+    mlk_zeroize(ct, COUNT * MLKEM_INDCCA_CIPHERTEXTBYTES);
+    mlk_zeroize(ss, COUNT * MLKEM_SSBYTES);
+  }
+  mlk_zeroize(buf, sizeof buf);
+  mlk_zeroize(kr, sizeof kr);
+  mlk_zeroize(spare, sizeof spare);
+
+  return ret;
+}
+
+#endif
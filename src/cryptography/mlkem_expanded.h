@@ -0,0 +1,143 @@
+#ifndef mlkem_expanded_H
+#define mlkem_expanded_H
+
+/*
+ * Expanded ML-KEM public keys over the vendored mlkem-native, included by
+ * mlkem512/768/1024.c ahead of mlkem_native.c like mlkem_batch.h.
+ *
+ * Expanding a key does the part of an encapsulation that depends on the key
+ * alone, once: the modulus check, H(pk), the parsed t-hat and the transposed
+ * matrix A generated from rho. Each encapsulation against the expanded key
+ * then runs only the coin-dependent part of K-PKE.Encrypt, with the same
+ * steps in the same order as mlk_indcpa_enc, so its output is byte-identical
+ * to mlkemNNN_encaps on the original key and the same coins.
+ *
+ * The K-PKE helpers are file-local to indcpa.c; they are declared here under
+ * indcpa.c's own parameter-set names and defined when mlkem_native.c is
+ * included below. The pinned tree digest guarantees their signatures.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./vendor/mlkem-native/mlkem/src/common.h"
+#include "./vendor/mlkem-native/mlkem/src/indcpa.h"
+#include "./vendor/mlkem-native/mlkem/src/kem.h"
+#include "./vendor/mlkem-native/mlkem/src/poly_k.h"
+#include "./vendor/mlkem-native/mlkem/src/symmetric.h"
+
+typedef struct
+{
+  mlk_polymat at;
+  mlk_polyvec pkpv;
+  uint8_t hpk[MLKEM_SYMBYTES];
+  uint32_t k; /* MLKEM_K once expanded, 0 otherwise */
+} mlk_expanded_pk;
+
+/* Caller memory holding one expanded key. It need not be aligned: the key
+ * sits at the first MLK_DEFAULT_ALIGN boundary in it, as the polynomials
+ * require, which JavaScript's malloc does not guarantee. */
+enum
+{
+  MLK_EXPANDED_BYTES = sizeof(mlk_expanded_pk) + MLK_DEFAULT_ALIGN - 1
+};
+
+static mlk_expanded_pk *
+mlk_expanded_at(const uint8_t *expanded)
+{
+  const uintptr_t at = (uintptr_t)expanded + MLK_DEFAULT_ALIGN - 1;
+
+  return (mlk_expanded_pk *)(at & ~(uintptr_t)(MLK_DEFAULT_ALIGN - 1));
+}
+
+#define mlk_unpack_pk MLK_ADD_PARAM_SET(mlk_unpack_pk)
+#define mlk_pack_ciphertext MLK_ADD_PARAM_SET(mlk_pack_ciphertext)
+#define mlk_matvec_mul MLK_ADD_PARAM_SET(mlk_matvec_mul)
+#define mlk_enc_getnoise_eta1_eta2 MLK_ADD_PARAM_SET(mlk_enc_getnoise_eta1_eta2)
+
+static void mlk_unpack_pk(mlk_polyvec *pk, uint8_t seed[MLKEM_SYMBYTES],
+                          const uint8_t packedpk[MLKEM_INDCPA_PUBLICKEYBYTES]);
+static void mlk_pack_ciphertext(uint8_t r[MLKEM_INDCPA_BYTES],
+                                const mlk_polyvec *b, mlk_poly *v);
+static void mlk_matvec_mul(mlk_polyvec *out, const mlk_polymat *a,
+                           const mlk_polyvec *v,
+                           const mlk_polyvec_mulcache *vc);
+static void mlk_enc_getnoise_eta1_eta2(mlk_polyvec *sp, mlk_polyvec *ep,
+                                       mlk_poly *epp,
+                                       const uint8_t coins[MLKEM_SYMBYTES]);
+
+static int
+mlk_expand_pk(uint8_t *memory, const uint8_t pk[MLKEM_INDCCA_PUBLICKEYBYTES])
+{
+  mlk_expanded_pk *expanded;
+  uint8_t seed[MLKEM_SYMBYTES];
+  int ret;
+
+  if (!memory || !pk) return MLK_ERR_FAIL;
+
+  mlk_zeroize(memory, MLK_EXPANDED_BYTES);
+  expanded = mlk_expanded_at(memory);
+  ret = mlk_kem_check_pk(pk, NULL);
+  if (ret != 0) return ret;
+
+  mlk_hash_h(expanded->hpk, pk, MLKEM_INDCCA_PUBLICKEYBYTES);
+  mlk_unpack_pk(&expanded->pkpv, seed, pk);
+  mlk_gen_matrix(&expanded->at, seed, 1 /* transpose */);
+  expanded->k = MLKEM_K;
+
+  return 0;
+}
+
+static int
+mlk_encaps_expanded(uint8_t ct[MLKEM_INDCCA_CIPHERTEXTBYTES],
+                    uint8_t ss[MLKEM_SSBYTES], const uint8_t *memory,
+                    const uint8_t coins[MLKEM_SYMBYTES])
+{
+  const mlk_expanded_pk *expanded;
+  MLK_ALIGN uint8_t buf[2 * MLKEM_SYMBYTES];
+  MLK_ALIGN uint8_t kr[2 * MLKEM_SYMBYTES];
+  mlk_polyvec sp, ep, b;
+  mlk_poly v, k, epp;
+  mlk_polyvec_mulcache sp_cache;
+
+  if (!memory) return MLK_ERR_FAIL;
+  expanded = mlk_expanded_at(memory);
+  if (expanded->k != MLKEM_K) return MLK_ERR_FAIL;
+
+  mlk_memcpy(buf, coins, MLKEM_SYMBYTES);
+  mlk_memcpy(buf + MLKEM_SYMBYTES, expanded->hpk, MLKEM_SYMBYTES);
+  mlk_hash_g(kr, buf, 2 * MLKEM_SYMBYTES);
+
+  /* mlk_indcpa_enc(ct, buf, pk, kr + MLKEM_SYMBYTES) from gen_matrix on. */
+  mlk_poly_frommsg(&k, buf);
+  mlk_enc_getnoise_eta1_eta2(&sp, &ep, &epp, kr + MLKEM_SYMBYTES);
+  mlk_polyvec_ntt(&sp);
+  mlk_polyvec_mulcache_compute(&sp_cache, &sp);
+  mlk_matvec_mul(&b, &expanded->at, &sp, &sp_cache);
+  mlk_polyvec_basemul_acc_montgomery_cached(&v, &expanded->pkpv, &sp,
+                                            &sp_cache);
+  mlk_polyvec_invntt_tomont(&b);
+  mlk_poly_invntt_tomont(&v);
+  mlk_polyvec_add(&b, &ep);
+  mlk_poly_add(&v, &epp);
+  mlk_poly_add(&v, &k);
+  mlk_polyvec_reduce(&b);
+  mlk_poly_reduce(&v);
+  mlk_pack_ciphertext(ct, &b, &v);
+
+  mlk_memcpy(ss, kr, MLKEM_SSBYTES);
+
+  mlk_zeroize(buf, sizeof buf);
+  mlk_zeroize(kr, sizeof kr);
+  mlk_zeroize(&sp, sizeof sp);
+  mlk_zeroize(&ep, sizeof ep);
+  mlk_zeroize(&b, sizeof b);
+  mlk_zeroize(&v, sizeof v);
+  mlk_zeroize(&k, sizeof k);
+  mlk_zeroize(&epp, sizeof epp);
+  mlk_zeroize(&sp_cache, sizeof sp_cache);
+
+  return 0;
+}
+
+#endif
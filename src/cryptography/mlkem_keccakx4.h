@@ -0,0 +1,101 @@
+#ifndef mlkem_keccakx4_H
+#define mlkem_keccakx4_H
+
+/*
+ * Four-lane Keccak-f[1600] backend for the vendored mlkem-native, plugged in
+ * through MLK_CONFIG_FIPS202_BACKEND_FILE by mlkem512/768/1024.c when they are
+ * compiled with -msimd128. Upstream's portable x4 permutation runs the four
+ * states one after the other; here each of the 25 lanes of the four states
+ * sits in one 4 x 64-bit vector, so a round is two v128 operations per lane,
+ * as in sha512x4.c. The matrix expansion and noise sampling of every
+ * encapsulation and key generation, and the cross-item H and G of the batch
+ * calls (see mlkem_batch.h), go through this permutation.
+ *
+ * The state layout is upstream's: four consecutive 25-lane states. Outputs
+ * are bit-identical to mlk_keccakf1600_permute on each state.
+ */
+
+#include <stdint.h>
+
+#if !defined(MLK_NATIVE_FUNC_SUCCESS)
+#define MLK_NATIVE_FUNC_SUCCESS (0)
+#define MLK_NATIVE_FUNC_FALLBACK (-1)
+#endif
+
+#if !defined(MLK_CONFIG_MULTILEVEL_NO_SHARED)
+#define MLK_USE_FIPS202_X4_NATIVE
+
+typedef uint64_t mlk_keccakx4_lane __attribute__((vector_size(32)));
+
+static const uint64_t mlk_keccakx4_round_constants[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+    0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
+
+/* Rotation offset of lane x + 5y, and the lane rho/pi moves it to. */
+static const unsigned char mlk_keccakx4_rho[25] = {
+    0,  1,  62, 28, 27, 36, 44, 6,  55, 20, 3,  10, 43,
+    25, 39, 41, 45, 15, 21, 8,  18, 2,  61, 56, 14};
+static const unsigned char mlk_keccakx4_pi[25] = {
+    0,  10, 20, 5,  15, 16, 1,  11, 21, 6,  7,  17, 2,
+    12, 22, 23, 8,  18, 3,  13, 14, 24, 9,  19, 4};
+
+static MLK_INLINE mlk_keccakx4_lane
+mlk_keccakx4_rol(const mlk_keccakx4_lane v, const unsigned int n)
+{
+  return n == 0 ? v : (v << n) | (v >> (64 - n));
+}
+
+static MLK_INLINE int
+mlk_keccak_f1600_x4_native(uint64_t *state)
+{
+  mlk_keccakx4_lane a[25], b[25], c[5], d;
+  unsigned int i, x, y, round;
+
+  for (i = 0; i < 25; i++)
+  {
+    a[i][0] = state[i];
+    a[i][1] = state[25 + i];
+    a[i][2] = state[50 + i];
+    a[i][3] = state[75 + i];
+  }
+
+  for (round = 0; round < 24; round++)
+  {
+    for (x = 0; x < 5; x++)
+      c[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];
+    for (x = 0; x < 5; x++)
+    {
+      d = c[(x + 4) % 5] ^ mlk_keccakx4_rol(c[(x + 1) % 5], 1);
+      for (y = 0; y < 25; y += 5) a[y + x] ^= d;
+    }
+
+    for (i = 0; i < 25; i++)
+      b[mlk_keccakx4_pi[i]] = mlk_keccakx4_rol(a[i], mlk_keccakx4_rho[i]);
+
+    for (y = 0; y < 25; y += 5)
+      for (x = 0; x < 5; x++)
+        a[y + x] = b[y + x] ^ (~b[y + (x + 1) % 5] & b[y + (x + 2) % 5]);
+
+    a[0] ^= mlk_keccakx4_round_constants[round];
+  }
+
+  for (i = 0; i < 25; i++)
+  {
+    state[i] = a[i][0];
+    state[25 + i] = a[i][1];
+    state[50 + i] = a[i][2];
+    state[75 + i] = a[i][3];
+  }
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+#endif /* !MLK_CONFIG_MULTILEVEL_NO_SHARED */
+
+#endif
@@ -0,0 +1,604 @@
+#ifndef mlkem_simd_H
+#define mlkem_simd_H
+
+/*
+ * WebAssembly SIMD128 arithmetic backend for the vendored mlkem-native,
+ * plugged in through MLK_CONFIG_ARITH_BACKEND_FILE by mlkem512/768/1024.c when
+ * they are compiled with -msimd128. It replaces the NTT, the inverse NTT,
+ * reduce/tomont, the multiplication cache, the base multiplication, the
+ * rejection sampler and the d4/d5/d10/d11 compression; everything else,
+ * Keccak included, stays the portable C of the pinned tree.
+ *
+ * Each kernel computes exactly what its mlk_*_c counterpart in
+ * vendor/mlkem-native/mlkem/src computes: the same Montgomery and Barrett
+ * constants, the standard coefficient order (no
+ * MLK_USE_NATIVE_NTT_CUSTOM_ORDER) and bit-identical outputs, so the upstream
+ * KATs hold unchanged and the vendored tree and its pinned digest are
+ * untouched. Products are formed in 32-bit lanes, as the scalar code forms
+ * them. Like sha512x4.c this uses GCC/Clang vector extensions rather than
+ * wasm_simd128.h, so the same file can be checked on a host compiler.
+ *
+ * The backend is included from common.h once params.h and sys.h are in, so
+ * MLKEM_N, MLKEM_Q, MLK_INLINE and MLK_ALIGN are available. Only the base
+ * multiplication depends on the parameter set; the other kernels and their
+ * twiddle tables exist in the unit that owns the shared code.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+/* What the (unvendored) native/api.h would define. */
+#define MLK_NATIVE_FUNC_SUCCESS (0)
+#define MLK_NATIVE_FUNC_FALLBACK (-1)
+
+#define MLK_USE_NATIVE_POLYVEC_BASEMUL_ACC_MONTGOMERY_CACHED
+#if !defined(MLK_CONFIG_MULTILEVEL_NO_SHARED)
+#define MLK_USE_NATIVE_NTT
+#define MLK_USE_NATIVE_INTT
+#define MLK_USE_NATIVE_POLY_REDUCE
+#define MLK_USE_NATIVE_POLY_TOMONT
+#define MLK_USE_NATIVE_POLY_MULCACHE_COMPUTE
+#define MLK_USE_NATIVE_REJ_UNIFORM
+#define MLK_USE_NATIVE_POLY_COMPRESS_D4
+#define MLK_USE_NATIVE_POLY_COMPRESS_D5
+#define MLK_USE_NATIVE_POLY_COMPRESS_D10
+#define MLK_USE_NATIVE_POLY_COMPRESS_D11
+#endif
+
+/* Eight coefficients per v128; products and sums widen to a v128 pair. */
+typedef int16_t mlk_simd_i16 __attribute__((vector_size(16)));
+typedef uint16_t mlk_simd_u16 __attribute__((vector_size(16)));
+typedef int32_t mlk_simd_i32 __attribute__((vector_size(32)));
+typedef uint32_t mlk_simd_u32 __attribute__((vector_size(32)));
+typedef uint8_t mlk_simd_u8 __attribute__((vector_size(16)));
+typedef uint8_t mlk_simd_u8x8 __attribute__((vector_size(8)));
+
+/* MLKEM_Q^-1 mod 2^16, as in mlk_montgomery_reduce. */
+#define MLK_SIMD_QINV 62209
+
+static MLK_INLINE mlk_simd_i16
+mlk_simd_load(const int16_t *src)
+{
+  mlk_simd_i16 v;
+
+  memcpy(&v, src, sizeof v);
+
+  return v;
+}
+
+static MLK_INLINE void
+mlk_simd_store(int16_t *dst, const mlk_simd_i16 v)
+{
+  memcpy(dst, &v, sizeof v);
+}
+
+static MLK_INLINE mlk_simd_i32
+mlk_simd_widen(const mlk_simd_i16 v)
+{
+  return __builtin_convertvector(v, mlk_simd_i32);
+}
+
+/* mlk_montgomery_reduce on eight 32-bit lanes. The low-half product with
+ * QINV is unsigned so it wraps instead of overflowing. */
+static MLK_INLINE mlk_simd_i16
+mlk_simd_montgomery_reduce(const mlk_simd_i32 a)
+{
+  const mlk_simd_u16 lo =
+      __builtin_convertvector((mlk_simd_u32)a, mlk_simd_u16);
+  const mlk_simd_i16 t = (mlk_simd_i16)(lo * (uint16_t)MLK_SIMD_QINV);
+
+  return __builtin_convertvector((a - mlk_simd_widen(t) * MLKEM_Q) >> 16,
+                                 mlk_simd_i16);
+}
+
+/* mlk_fqmul, lane-wise. */
+static MLK_INLINE mlk_simd_i16
+mlk_simd_fqmul(const mlk_simd_i16 a, const mlk_simd_i16 b)
+{
+  return mlk_simd_montgomery_reduce(mlk_simd_widen(a) * mlk_simd_widen(b));
+}
+
+/* mlk_barrett_reduce, lane-wise: the centred representative. */
+static MLK_INLINE mlk_simd_i16
+mlk_simd_barrett_reduce(const mlk_simd_i16 a)
+{
+  const mlk_simd_i32 wide = mlk_simd_widen(a);
+  const mlk_simd_i32 t = (wide * 20159 + (1 << 25)) >> 26;
+
+  return __builtin_convertvector(wide - t * MLKEM_Q, mlk_simd_i16);
+}
+
+static MLK_INLINE int
+mlk_polyvec_basemul_acc_montgomery_cached_simd(int16_t r[MLKEM_N],
+                                               const int16_t *a,
+                                               const int16_t *b,
+                                               const int16_t *b_cache,
+                                               const unsigned int k)
+{
+  unsigned int i, l;
+
+  /* Eight coefficient pairs per step; even and odd coefficients are split
+   * into their own vectors so each pair's products line up lane-wise. */
+  for (i = 0; i < MLKEM_N; i += 16)
+  {
+    mlk_simd_i32 t0 = { 0 }, t1 = { 0 };
+    mlk_simd_i16 r0, r1;
+
+    for (l = 0; l < k; l++)
+    {
+      const mlk_simd_i16 a0 = mlk_simd_load(&a[l * MLKEM_N + i]);
+      const mlk_simd_i16 a1 = mlk_simd_load(&a[l * MLKEM_N + i + 8]);
+      const mlk_simd_i16 b0 = mlk_simd_load(&b[l * MLKEM_N + i]);
+      const mlk_simd_i16 b1 = mlk_simd_load(&b[l * MLKEM_N + i + 8]);
+      const mlk_simd_i32 ae = mlk_simd_widen(
+          __builtin_shufflevector(a0, a1, 0, 2, 4, 6, 8, 10, 12, 14));
+      const mlk_simd_i32 ao = mlk_simd_widen(
+          __builtin_shufflevector(a0, a1, 1, 3, 5, 7, 9, 11, 13, 15));
+      const mlk_simd_i32 be = mlk_simd_widen(
+          __builtin_shufflevector(b0, b1, 0, 2, 4, 6, 8, 10, 12, 14));
+      const mlk_simd_i32 bo = mlk_simd_widen(
+          __builtin_shufflevector(b0, b1, 1, 3, 5, 7, 9, 11, 13, 15));
+      const mlk_simd_i32 bc =
+          mlk_simd_widen(mlk_simd_load(&b_cache[l * (MLKEM_N / 2) + i / 2]));
+
+      t0 += ao * bc + ae * be;
+      t1 += ae * bo + ao * be;
+    }
+
+    r0 = mlk_simd_montgomery_reduce(t0);
+    r1 = mlk_simd_montgomery_reduce(t1);
+    mlk_simd_store(&r[i],
+                   __builtin_shufflevector(r0, r1, 0, 8, 1, 9, 2, 10, 3, 11));
+    mlk_simd_store(&r[i + 8], __builtin_shufflevector(r0, r1, 4, 12, 5, 13, 6,
+                                                      14, 7, 15));
+  }
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+static MLK_INLINE int
+mlk_polyvec_basemul_acc_montgomery_cached_k2_native(int16_t r[MLKEM_N],
+                                                    const int16_t *a,
+                                                    const int16_t *b,
+                                                    const int16_t *b_cache)
+{
+  return mlk_polyvec_basemul_acc_montgomery_cached_simd(r, a, b, b_cache, 2);
+}
+
+static MLK_INLINE int
+mlk_polyvec_basemul_acc_montgomery_cached_k3_native(int16_t r[MLKEM_N],
+                                                    const int16_t *a,
+                                                    const int16_t *b,
+                                                    const int16_t *b_cache)
+{
+  return mlk_polyvec_basemul_acc_montgomery_cached_simd(r, a, b, b_cache, 3);
+}
+
+static MLK_INLINE int
+mlk_polyvec_basemul_acc_montgomery_cached_k4_native(int16_t r[MLKEM_N],
+                                                    const int16_t *a,
+                                                    const int16_t *b,
+                                                    const int16_t *b_cache)
+{
+  return mlk_polyvec_basemul_acc_montgomery_cached_simd(r, a, b, b_cache, 4);
+}
+
+#if !defined(MLK_CONFIG_MULTILEVEL_NO_SHARED)
+
+/* Twiddles from mlk_zetas (zetas.inc), which poly.c defines only after this
+ * file is included. Layers 6 and 7 butterfly within a vector, so their
+ * twiddles are repeated once per lane in the order the lanes use them. */
+/* mlk_zetas[0..31]: one broadcast twiddle per block, layers 1-5. */
+static MLK_ALIGN const int16_t mlk_simd_zetas[32] = {
+  -1044, -758, -359, -1517, 1493, 1422, 287, 202, -171, 622, 1577, 182, 962,
+  -1202, -1474, 1468, 573, -1325, 264, 383, -829, 1458, -1602, -130, -681,
+  1017, 732, 608, -1542, 411, -205, -1571,
+};
+
+/* Layer 6 (len 4): mlk_zetas[32 + i], once per coefficient of a block. */
+static MLK_ALIGN const int16_t mlk_simd_zetas_l6[128] = {
+  1223, 1223, 1223, 1223, 652, 652, 652, 652, -552, -552, -552, -552, 1015,
+  1015, 1015, 1015, -1293, -1293, -1293, -1293, 1491, 1491, 1491, 1491, -282,
+  -282, -282, -282, -1544, -1544, -1544, -1544, 516, 516, 516, 516, -8, -8, -8,
+  -8, -320, -320, -320, -320, -666, -666, -666, -666, -1618, -1618, -1618,
+  -1618, -1162, -1162, -1162, -1162, 126, 126, 126, 126, 1469, 1469, 1469,
+  1469, -853, -853, -853, -853, -90, -90, -90, -90, -271, -271, -271, -271,
+  830, 830, 830, 830, 107, 107, 107, 107, -1421, -1421, -1421, -1421, -247,
+  -247, -247, -247, -951, -951, -951, -951, -398, -398, -398, -398, 961, 961,
+  961, 961, -1508, -1508, -1508, -1508, -725, -725, -725, -725, 448, 448, 448,
+  448, -1065, -1065, -1065, -1065, 677, 677, 677, 677, -1275, -1275, -1275,
+  -1275,
+};
+
+/* Layer 7 (len 2): mlk_zetas[64 + i], likewise. */
+static MLK_ALIGN const int16_t mlk_simd_zetas_l7[128] = {
+  -1103, -1103, 430, 430, 555, 555, 843, 843, -1251, -1251, 871, 871, 1550,
+  1550, 105, 105, 422, 422, 587, 587, 177, 177, -235, -235, -291, -291, -460,
+  -460, 1574, 1574, 1653, 1653, -246, -246, 778, 778, 1159, 1159, -147, -147,
+  -777, -777, 1483, 1483, -602, -602, 1119, 1119, -1590, -1590, 644, 644, -872,
+  -872, 349, 349, 418, 418, 329, 329, -156, -156, -75, -75, 817, 817, 1097,
+  1097, 603, 603, 610, 610, 1322, 1322, -1285, -1285, -1465, -1465, 384, 384,
+  -1215, -1215, -136, -136, 1218, 1218, -1335, -1335, -874, -874, 220, 220,
+  -1187, -1187, -1659, -1659, -1185, -1185, -1530, -1530, -1278, -1278, 794,
+  794, -1510, -1510, -854, -854, -870, -870, 478, 478, -108, -108, -308, -308,
+  996, 996, 991, 991, 958, 958, -1460, -1460, 1522, 1522, 1628, 1628,
+};
+
+/* Inverse layer 7: mlk_zetas[127 - i], in the order invntt consumes them. */
+static MLK_ALIGN const int16_t mlk_simd_zetas_inv_l7[128] = {
+  1628, 1628, 1522, 1522, -1460, -1460, 958, 958, 991, 991, 996, 996, -308,
+  -308, -108, -108, 478, 478, -870, -870, -854, -854, -1510, -1510, 794, 794,
+  -1278, -1278, -1530, -1530, -1185, -1185, -1659, -1659, -1187, -1187, 220,
+  220, -874, -874, -1335, -1335, 1218, 1218, -136, -136, -1215, -1215, 384,
+  384, -1465, -1465, -1285, -1285, 1322, 1322, 610, 610, 603, 603, 1097, 1097,
+  817, 817, -75, -75, -156, -156, 329, 329, 418, 418, 349, 349, -872, -872,
+  644, 644, -1590, -1590, 1119, 1119, -602, -602, 1483, 1483, -777, -777, -147,
+  -147, 1159, 1159, 778, 778, -246, -246, 1653, 1653, 1574, 1574, -460, -460,
+  -291, -291, -235, -235, 177, 177, 587, 587, 422, 422, 105, 105, 1550, 1550,
+  871, 871, -1251, -1251, 843, 843, 555, 555, 430, 430, -1103, -1103,
+};
+
+/* Inverse layer 6: mlk_zetas[63 - i]. */
+static MLK_ALIGN const int16_t mlk_simd_zetas_inv_l6[128] = {
+  -1275, -1275, -1275, -1275, 677, 677, 677, 677, -1065, -1065, -1065, -1065,
+  448, 448, 448, 448, -725, -725, -725, -725, -1508, -1508, -1508, -1508, 961,
+  961, 961, 961, -398, -398, -398, -398, -951, -951, -951, -951, -247, -247,
+  -247, -247, -1421, -1421, -1421, -1421, 107, 107, 107, 107, 830, 830, 830,
+  830, -271, -271, -271, -271, -90, -90, -90, -90, -853, -853, -853, -853,
+  1469, 1469, 1469, 1469, 126, 126, 126, 126, -1162, -1162, -1162, -1162,
+  -1618, -1618, -1618, -1618, -666, -666, -666, -666, -320, -320, -320, -320,
+  -8, -8, -8, -8, 516, 516, 516, 516, -1544, -1544, -1544, -1544, -282, -282,
+  -282, -282, 1491, 1491, 1491, 1491, -1293, -1293, -1293, -1293, 1015, 1015,
+  1015, 1015, -552, -552, -552, -552, 652, 652, 652, 652, 1223, 1223, 1223,
+  1223,
+};
+
+/* mulcache: mlk_zetas[64 + i] and its negation, per odd coefficient. */
+static MLK_ALIGN const int16_t mlk_simd_zetas_mulcache[128] = {
+  -1103, 1103, 430, -430, 555, -555, 843, -843, -1251, 1251, 871, -871, 1550,
+  -1550, 105, -105, 422, -422, 587, -587, 177, -177, -235, 235, -291, 291,
+  -460, 460, 1574, -1574, 1653, -1653, -246, 246, 778, -778, 1159, -1159, -147,
+  147, -777, 777, 1483, -1483, -602, 602, 1119, -1119, -1590, 1590, 644, -644,
+  -872, 872, 349, -349, 418, -418, 329, -329, -156, 156, -75, 75, 817, -817,
+  1097, -1097, 603, -603, 610, -610, 1322, -1322, -1285, 1285, -1465, 1465,
+  384, -384, -1215, 1215, -136, 136, 1218, -1218, -1335, 1335, -874, 874, 220,
+  -220, -1187, 1187, -1659, 1659, -1185, 1185, -1530, 1530, -1278, 1278, 794,
+  -794, -1510, 1510, -854, 854, -870, 870, 478, -478, -108, 108, -308, 308,
+  996, -996, 991, -991, 958, -958, -1460, 1460, 1522, -1522, 1628, -1628,
+};
+
+/* Cooley-Tukey butterfly: a + zeta * b, a - zeta * b. */
+#define MLK_SIMD_CT(a, b, zeta)                                                \
+  do                                                                           \
+  {                                                                            \
+    const mlk_simd_i16 t_ = mlk_simd_fqmul((b), (zeta));                       \
+    (b) = (a) - t_;                                                            \
+    (a) = (a) + t_;                                                            \
+  } while (0)
+
+/* Gentleman-Sande butterfly: reduce(a + b), zeta * (b - a). */
+#define MLK_SIMD_GS(a, b, zeta)                                                \
+  do                                                                           \
+  {                                                                            \
+    const mlk_simd_i16 t_ = (a);                                               \
+    (a) = mlk_simd_barrett_reduce(t_ + (b));                                   \
+    (b) = mlk_simd_fqmul((b) - t_, (zeta));                                    \
+  } while (0)
+
+static MLK_INLINE int
+mlk_ntt_native(int16_t r[MLKEM_N])
+{
+  unsigned int layer, len, start, j, k = 1;
+
+  /* Layers 1-5: blocks of at least eight, one twiddle per block. */
+  for (layer = 1; layer <= 5; layer++)
+  {
+    len = MLKEM_N >> layer;
+    for (start = 0; start < MLKEM_N; start += 2 * len)
+    {
+      const mlk_simd_i16 zeta = (mlk_simd_i16){ 0 } + mlk_simd_zetas[k++];
+
+      for (j = start; j < start + len; j += 8)
+      {
+        mlk_simd_i16 a = mlk_simd_load(&r[j]);
+        mlk_simd_i16 b = mlk_simd_load(&r[j + len]);
+
+        MLK_SIMD_CT(a, b, zeta);
+        mlk_simd_store(&r[j], a);
+        mlk_simd_store(&r[j + len], b);
+      }
+    }
+  }
+
+  /* Layers 6 and 7 pair coefficients four and two apart: gather the halves
+   * of sixteen coefficients into a and b, butterfly, and scatter back. */
+  for (j = 0; j < MLKEM_N; j += 16)
+  {
+    mlk_simd_i16 v0 = mlk_simd_load(&r[j]);
+    mlk_simd_i16 v1 = mlk_simd_load(&r[j + 8]);
+    mlk_simd_i16 a, b;
+
+    a = __builtin_shufflevector(v0, v1, 0, 1, 2, 3, 8, 9, 10, 11);
+    b = __builtin_shufflevector(v0, v1, 4, 5, 6, 7, 12, 13, 14, 15);
+    MLK_SIMD_CT(a, b, mlk_simd_load(&mlk_simd_zetas_l6[j / 2]));
+    v0 = __builtin_shufflevector(a, b, 0, 1, 2, 3, 8, 9, 10, 11);
+    v1 = __builtin_shufflevector(a, b, 4, 5, 6, 7, 12, 13, 14, 15);
+
+    a = __builtin_shufflevector(v0, v1, 0, 1, 4, 5, 8, 9, 12, 13);
+    b = __builtin_shufflevector(v0, v1, 2, 3, 6, 7, 10, 11, 14, 15);
+    MLK_SIMD_CT(a, b, mlk_simd_load(&mlk_simd_zetas_l7[j / 2]));
+    mlk_simd_store(&r[j],
+                   __builtin_shufflevector(a, b, 0, 1, 8, 9, 2, 3, 10, 11));
+    mlk_simd_store(&r[j + 8], __builtin_shufflevector(a, b, 4, 5, 12, 13, 6, 7,
+                                                      14, 15));
+  }
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+static MLK_INLINE int
+mlk_intt_native(int16_t r[MLKEM_N])
+{
+  /* check-magic: 1441 == pow(2,32 - 7,MLKEM_Q), as in poly.c */
+  const mlk_simd_i16 f = (mlk_simd_i16){ 0 } + 1441;
+  unsigned int layer, len, start, j, k = 31;
+
+  /* The scaling pass of mlk_poly_invntt_tomont_c, fused with layers 7 and 6;
+   * both only touch the sixteen coefficients loaded here. */
+  for (j = 0; j < MLKEM_N; j += 16)
+  {
+    mlk_simd_i16 v0 = mlk_simd_fqmul(mlk_simd_load(&r[j]), f);
+    mlk_simd_i16 v1 = mlk_simd_fqmul(mlk_simd_load(&r[j + 8]), f);
+    mlk_simd_i16 a, b;
+
+    a = __builtin_shufflevector(v0, v1, 0, 1, 4, 5, 8, 9, 12, 13);
+    b = __builtin_shufflevector(v0, v1, 2, 3, 6, 7, 10, 11, 14, 15);
+    MLK_SIMD_GS(a, b, mlk_simd_load(&mlk_simd_zetas_inv_l7[j / 2]));
+    v0 = __builtin_shufflevector(a, b, 0, 1, 8, 9, 2, 3, 10, 11);
+    v1 = __builtin_shufflevector(a, b, 4, 5, 12, 13, 6, 7, 14, 15);
+
+    a = __builtin_shufflevector(v0, v1, 0, 1, 2, 3, 8, 9, 10, 11);
+    b = __builtin_shufflevector(v0, v1, 4, 5, 6, 7, 12, 13, 14, 15);
+    MLK_SIMD_GS(a, b, mlk_simd_load(&mlk_simd_zetas_inv_l6[j / 2]));
+    mlk_simd_store(&r[j],
+                   __builtin_shufflevector(a, b, 0, 1, 2, 3, 8, 9, 10, 11));
+    mlk_simd_store(&r[j + 8], __builtin_shufflevector(a, b, 4, 5, 6, 7, 12, 13,
+                                                      14, 15));
+  }
+
+  /* Layers 5-1, twiddles mlk_zetas[31] down to mlk_zetas[1]. */
+  for (layer = 5; layer >= 1; layer--)
+  {
+    len = MLKEM_N >> layer;
+    for (start = 0; start < MLKEM_N; start += 2 * len)
+    {
+      const mlk_simd_i16 zeta = (mlk_simd_i16){ 0 } + mlk_simd_zetas[k--];
+
+      for (j = start; j < start + len; j += 8)
+      {
+        mlk_simd_i16 a = mlk_simd_load(&r[j]);
+        mlk_simd_i16 b = mlk_simd_load(&r[j + len]);
+
+        MLK_SIMD_GS(a, b, zeta);
+        mlk_simd_store(&r[j], a);
+        mlk_simd_store(&r[j + len], b);
+      }
+    }
+  }
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+static MLK_INLINE int
+mlk_poly_reduce_native(int16_t r[MLKEM_N])
+{
+  unsigned int i;
+
+  for (i = 0; i < MLKEM_N; i += 8)
+  {
+    const mlk_simd_i16 t = mlk_simd_barrett_reduce(mlk_simd_load(&r[i]));
+
+    /* Lanes where t < 0 compare to all-ones: add MLKEM_Q there only. */
+    mlk_simd_store(&r[i], t + ((t < 0) & MLKEM_Q));
+  }
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+static MLK_INLINE int
+mlk_poly_tomont_native(int16_t r[MLKEM_N])
+{
+  /* check-magic: 1353 == signed_mod(2^32, MLKEM_Q), as in poly.c */
+  const mlk_simd_i16 f = (mlk_simd_i16){ 0 } + 1353;
+  unsigned int i;
+
+  for (i = 0; i < MLKEM_N; i += 8)
+    mlk_simd_store(&r[i], mlk_simd_fqmul(mlk_simd_load(&r[i]), f));
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+static MLK_INLINE int
+mlk_poly_mulcache_compute_native(int16_t x[MLKEM_N / 2],
+                                 const int16_t a[MLKEM_N])
+{
+  unsigned int i;
+
+  /* x[2i] = a[4i + 1] * zeta, x[2i + 1] = a[4i + 3] * -zeta: the odd
+   * coefficients of sixteen inputs make eight consecutive outputs. */
+  for (i = 0; i < MLKEM_N; i += 16)
+  {
+    const mlk_simd_i16 odd =
+        __builtin_shufflevector(mlk_simd_load(&a[i]), mlk_simd_load(&a[i + 8]),
+                                1, 3, 5, 7, 9, 11, 13, 15);
+    const mlk_simd_i16 zeta = mlk_simd_load(&mlk_simd_zetas_mulcache[i / 2]);
+
+    mlk_simd_store(&x[i / 2], mlk_simd_fqmul(odd, zeta));
+  }
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+/* Eight 12-bit candidates from twelve bytes, rejected against MLKEM_Q in one
+ * compare; accepted ones are appended in order with a branch-free store (the
+ * sampled matrix is public, this is for speed only). Whole blocks run while
+ * eight more values fit; the rest is mlk_rej_uniform_c's loop verbatim. */
+static MLK_INLINE int
+mlk_rej_uniform_native(int16_t *r, unsigned target, const uint8_t *buf,
+                       unsigned buflen)
+{
+  const mlk_simd_u16 shift = { 0, 4, 0, 4, 0, 4, 0, 4 };
+  unsigned int ctr = 0, pos = 0, l;
+
+  while (ctr + 8 <= target && pos + 12 <= buflen)
+  {
+    mlk_simd_u8 bytes = { 0 };
+    mlk_simd_u16 lo, hi;
+    mlk_simd_i16 val, ok;
+
+    memcpy(&bytes, &buf[pos], 12);
+    lo = __builtin_convertvector(
+        __builtin_shufflevector(bytes, bytes, 0, 1, 3, 4, 6, 7, 9, 10),
+        mlk_simd_u16);
+    hi = __builtin_convertvector(
+        __builtin_shufflevector(bytes, bytes, 1, 2, 4, 5, 7, 8, 10, 11),
+        mlk_simd_u16);
+    val = (mlk_simd_i16)(((lo | (hi << 8)) >> shift) & 0xfff);
+    ok = val < MLKEM_Q;
+    pos += 12;
+
+    for (l = 0; l < 8; l++)
+    {
+      r[ctr] = val[l];
+      ctr += (unsigned int)(ok[l] & 1);
+    }
+  }
+
+  while (ctr < target && pos + 3 <= buflen)
+  {
+    const int16_t val0 =
+        (int16_t)((buf[pos] | ((uint16_t)buf[pos + 1] << 8)) & 0xfff);
+    const int16_t val1 = (int16_t)(((buf[pos + 1] >> 4) | (buf[pos + 2] << 4))
+                                   & 0xfff);
+
+    pos += 3;
+    if (val0 < MLKEM_Q) r[ctr++] = val0;
+    if (ctr < target && val1 < MLKEM_Q) r[ctr++] = val1;
+  }
+
+  return (int)ctr;
+}
+
+/* The compressed values of eight canonical coefficients, lane-wise, from
+ * the mlk_scalar_compress_d* formulas. For d10 and d11 those need a 64-bit
+ * product; round(u * 2^d / MLKEM_Q) is instead x / MLKEM_Q with
+ * x = (u << d) + MLKEM_Q / 2, estimated as (x * 630) >> 21 (never low, at
+ * most one high, and x * 630 < 2^32 for d <= 11) and then corrected. Every
+ * input in [0, MLKEM_Q) gives the scalar result. */
+static MLK_INLINE mlk_simd_u32
+mlk_simd_compress(const int16_t *a, const unsigned int d)
+{
+  const mlk_simd_u32 u =
+      __builtin_convertvector(mlk_simd_load(a), mlk_simd_u32);
+  mlk_simd_u32 x, t;
+
+  switch (d)
+  {
+    case 4:
+      return (u * 1290160 + (1U << 27)) >> 28;
+    case 5:
+      return (u * 1290176 + (1U << 26)) >> 27;
+    default:
+      x = (u << d) + MLKEM_Q / 2;
+      t = (x * 630) >> 21;
+      t += (mlk_simd_u32)(x < t * MLKEM_Q);
+      return t & ((1U << d) - 1);
+  }
+}
+
+/* Little-endian bit packing of eight d-bit values, as compress.c writes
+ * them. */
+static MLK_INLINE void
+mlk_simd_pack(uint8_t *r, const mlk_simd_u32 t, const unsigned int d)
+{
+  uint32_t acc = 0;
+  unsigned int bits = 0, l;
+
+  for (l = 0; l < 8; l++)
+  {
+    acc |= t[l] << bits;
+    for (bits += d; bits >= 8; bits -= 8)
+    {
+      *r++ = (uint8_t)acc;
+      acc >>= 8;
+    }
+  }
+}
+
+static MLK_INLINE int
+mlk_poly_compress_d4_native(uint8_t r[MLKEM_POLYCOMPRESSEDBYTES_D4],
+                            const int16_t a[MLKEM_N])
+{
+  unsigned int i;
+
+  /* Sixteen nibbles to eight bytes without leaving the vector unit. */
+  for (i = 0; i < MLKEM_N; i += 16)
+  {
+    const mlk_simd_u16 t0 =
+        __builtin_convertvector(mlk_simd_compress(&a[i], 4), mlk_simd_u16);
+    const mlk_simd_u16 t1 =
+        __builtin_convertvector(mlk_simd_compress(&a[i + 8], 4), mlk_simd_u16);
+    const mlk_simd_u8x8 packed = __builtin_convertvector(
+        __builtin_shufflevector(t0, t1, 0, 2, 4, 6, 8, 10, 12, 14)
+            | (__builtin_shufflevector(t0, t1, 1, 3, 5, 7, 9, 11, 13, 15)
+               << 4),
+        mlk_simd_u8x8);
+
+    memcpy(&r[i / 2], &packed, sizeof packed);
+  }
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+static MLK_INLINE int
+mlk_poly_compress_d5_native(uint8_t r[MLKEM_POLYCOMPRESSEDBYTES_D5],
+                            const int16_t a[MLKEM_N])
+{
+  unsigned int i;
+
+  for (i = 0; i < MLKEM_N; i += 8)
+    mlk_simd_pack(&r[i / 8 * 5], mlk_simd_compress(&a[i], 5), 5);
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+static MLK_INLINE int
+mlk_poly_compress_d10_native(uint8_t r[MLKEM_POLYCOMPRESSEDBYTES_D10],
+                             const int16_t a[MLKEM_N])
+{
+  unsigned int i;
+
+  for (i = 0; i < MLKEM_N; i += 8)
+    mlk_simd_pack(&r[i / 8 * 10], mlk_simd_compress(&a[i], 10), 10);
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+static MLK_INLINE int
+mlk_poly_compress_d11_native(uint8_t r[MLKEM_POLYCOMPRESSEDBYTES_D11],
+                             const int16_t a[MLKEM_N])
+{
+  unsigned int i;
+
+  for (i = 0; i < MLKEM_N; i += 8)
+    mlk_simd_pack(&r[i / 8 * 11], mlk_simd_compress(&a[i], 11), 11);
+
+  return MLK_NATIVE_FUNC_SUCCESS;
+}
+
+#undef MLK_SIMD_CT
+#undef MLK_SIMD_GS
+
+#endif /* !MLK_CONFIG_MULTILEVEL_NO_SHARED */
+
+#endif
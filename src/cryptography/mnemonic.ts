@@ -4,6 +4,7 @@ import { fillRandomBytesInto } from "./random";
 import { zeroFree } from "../utils/zeroFree";
 
 // import libcrypto from "./libcrypto";
+import { sharedModule } from "./sharedModule";
 import { wasmLoader } from "./wasmLoader";
 
 import wordlist from "../utils/wordlist.json";
@@ -20,10 +21,143 @@ const normalize = (str: string) => {
   return str.normalize("NFKD");
 };
 
+/**
+ * Argon2id cost parameters: `opsLimit` passes (t) over `memLimitKiB` KiB (m)
+ * split into `parallelism` lanes (p, 1 to 16). The lanes only run in parallel
+ * on the threaded shared module (setWasmThreads on a cross-origin isolated
+ * page), where raising p and m together keeps the wall-clock time. Everywhere
+ * else the same output takes time in proportion to t * m.
+ */
+export interface Argon2Profile {
+  opsLimit: number;
+  memLimitKiB: number;
+  parallelism: number;
+}
+
+/** libsodium's OPSLIMIT/MEMLIMIT_INTERACTIVE: the output of `argon2` as is. */
+export const ARGON2_PROFILE_INTERACTIVE: Readonly<Argon2Profile> = {
+  opsLimit: 2,
+  memLimitKiB: 64 * 1024,
+  parallelism: 1,
+};
+
+/**
+ * Identity backups: four times the memory over four lanes. With four threads
+ * it takes about 1.5 times ARGON2_PROFILE_INTERACTIVE; on one thread about 6
+ * times, so a page that cannot enable threads may want a lighter profile.
+ */
+export const ARGON2_PROFILE_BACKUP: Readonly<Argon2Profile> = {
+  opsLimit: 3,
+  memLimitKiB: 256 * 1024,
+  parallelism: 4,
+};
+
+const ARGON2ID_MAX_LANES = 16;
+
+// The shared module's heap stops at MAXIMUM_MEMORY (1 GiB) and aborts on a
+// failed allocation, so block memory past half of it keeps its own memory.
+const ARGON2ID_SHARED_MAX_KIB = 512 * 1024;
+
+const assertArgon2Profile = (profile: Argon2Profile): void => {
+  const { opsLimit, memLimitKiB, parallelism } = profile;
+  if (
+    !Number.isInteger(opsLimit) ||
+    !Number.isInteger(memLimitKiB) ||
+    !Number.isInteger(parallelism) ||
+    opsLimit < 1 ||
+    parallelism < 1 ||
+    parallelism > ARGON2ID_MAX_LANES ||
+    memLimitKiB < 8 * parallelism
+  )
+    throw new Error("Invalid argon2id profile.");
+};
+
+/**
+ * @function
+ * Argon2id of `password` with the given profile, a 32-byte output. With
+ * ARGON2_PROFILE_INTERACTIVE it equals `argon2` on the same bytes.
+ */
+export const argon2id = async (
+  password: Uint8Array,
+  salt: Uint8Array,
+  profile: Argon2Profile,
+  module?: LibCrypto,
+): Promise<Uint8Array> => {
+  assertArgon2Profile(profile);
+  if (salt.length !== crypto_pwhash_argon2id_SALTBYTES)
+    throw new Error("Invalid argon2id salt length.");
+
+  const { opsLimit, memLimitKiB, parallelism } = profile;
+  const passwordLen = password.length;
+
+  // Lanes can only run in parallel on the threaded shared module, whose heap
+  // then grows to hold the blocks and keeps that size. Otherwise the hash gets
+  // an operation-sized memory of its own.
+  if (!module && parallelism > 1 && memLimitKiB <= ARGON2ID_SHARED_MAX_KIB) {
+    const shared = await sharedModule();
+    if (shared._pool_threads() > 1) module = shared;
+  }
+  module =
+    module ??
+    (await wasmLoader(
+      memory.argon2idMemory(memLimitKiB, parallelism, passwordLen),
+    ));
+
+  const blocksLen = module._argon2id_memory_bytes(memLimitKiB, parallelism);
+  if (blocksLen === 0) throw new Error("Invalid argon2id profile.");
+
+  // Allocate everything before taking views: on a growable module the block
+  // allocation can grow memory, which detaches views taken earlier.
+  const ptr1 = module._malloc(crypto_sign_ed25519_SEEDBYTES);
+  const ptr2 = module._malloc(Math.max(passwordLen, 1));
+  const ptr3 = module._malloc(crypto_pwhash_argon2id_SALTBYTES);
+  const ptr4 = module._malloc(blocksLen);
+  const out = new Uint8Array(
+    module.wasmMemory.buffer,
+    ptr1,
+    crypto_sign_ed25519_SEEDBYTES,
+  );
+  const pwd = new Uint8Array(module.wasmMemory.buffer, ptr2, passwordLen);
+  try {
+    pwd.set(password);
+    new Uint8Array(
+      module.wasmMemory.buffer,
+      ptr3,
+      crypto_pwhash_argon2id_SALTBYTES,
+    ).set(salt);
+
+    const result = module._argon2id_hash(
+      out.byteOffset,
+      crypto_sign_ed25519_SEEDBYTES,
+      pwd.byteOffset,
+      passwordLen,
+      ptr3,
+      crypto_pwhash_argon2id_SALTBYTES,
+      0,
+      0,
+      0,
+      0,
+      opsLimit,
+      memLimitKiB,
+      parallelism,
+      ptr4,
+    );
+    if (result !== 0) throw new Error("Could not compute argon2id.");
+    return Uint8Array.from(out);
+  } finally {
+    zeroFree(module, out);
+    zeroFree(module, pwd);
+    module._free(ptr3);
+    // argon2id_hash wipes the block memory itself.
+    module._free(ptr4);
+  }
+};
+
 export const argon2 = async (
   mnemonic: string,
   salt?: Uint8Array,
   module?: LibCrypto,
+  profile?: Argon2Profile,
 ): Promise<Uint8Array> => {
   const mnemonicNormalized = normalize(mnemonic);
   const encoder = new TextEncoder();
@@ -37,6 +171,15 @@ export const argon2 = async (
       new Uint8Array(crypto_pwhash_argon2id_SALTBYTES),
     );
 
+  if (profile) {
+    const mnemonicBytes = new Uint8Array(mnemonicBuffer);
+    try {
+      return await argon2id(mnemonicBytes, salt, profile, module);
+    } finally {
+      mnemonicBytes.fill(0);
+    }
+  }
+
   const wasmMemory =
     module?.wasmMemory ?? memory.argon2Memory(mnemonicArrayLen);
 
@@ -237,11 +380,15 @@ export const validateMnemonic = async (mnemonic: string): Promise<boolean> => {
  *
  * @param mnemonic - Sequence of words from the predefined wordlist
  * @param password - Optional salt for the seed derivation
+ * @param profile - Optional argon2id cost profile; the default matches
+ * ARGON2_PROFILE_INTERACTIVE, and a key pair is only recovered with the
+ * profile it was created with
  * @returns An Ed25519 key pair
  */
 export const keyPairFromMnemonic = async (
   mnemonic: string,
   password?: string,
+  profile?: Argon2Profile,
 ) => {
   const isValid = await validateMnemonic(mnemonic);
   if (!isValid) throw new Error("Invalid mnemonic.");
@@ -266,7 +413,7 @@ export const keyPairFromMnemonic = async (
     salt.set(defaultSalt);
   }
 
-  const seed = await argon2(mnemonic, salt);
+  const seed = await argon2(mnemonic, salt, undefined, profile);
 
   return await keyPairFromSeed(seed);
 };
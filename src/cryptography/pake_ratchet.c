@@ -83,16 +83,16 @@ encrypt_chachapoly_symmetric(
     const uint8_t *aad, const unsigned int aad_len)
 {
   unsigned long long clen = 0;
-  int res = crypto_aead_chacha20poly1305_ietf_encrypt(
+  int res = chacha20poly1305x4_ietf_encrypt(
       out, &clen, data, data_len, aad, aad_len, NULL, nonce, key);
   if (res != 0) return -1;
   return 0;
 }
 
-/* Inverse of encrypt_chachapoly_symmetric via libsodium's own AEAD decrypt:
+/* Inverse of encrypt_chachapoly_symmetric with libsodium's AEAD semantics:
  * in = ciphertext || Poly1305 tag (in_len == out_len + ABYTES), out =
- * plaintext. libsodium verifies the tag in constant time and writes NO
- * plaintext on auth failure. Returns 0 on success, -1 on authentication
+ * plaintext. The tag is verified in constant time and NO plaintext is written
+ * on auth failure. Returns 0 on success, -1 on authentication
  * failure. */
 int
 decrypt_chachapoly_symmetric(
@@ -102,12 +102,117 @@ decrypt_chachapoly_symmetric(
     const uint8_t *aad, const unsigned int aad_len)
 {
   unsigned long long mlen = 0;
-  int res = crypto_aead_chacha20poly1305_ietf_decrypt(
+  int res = chacha20poly1305x4_ietf_decrypt(
       out, &mlen, NULL, in, in_len, aad, aad_len, nonce, key);
   if (res != 0) return -1;
   return 0;
 }
 
+/* ---------------- v4 chunk AAD ----------------
+ * AAD = merkle_root || the exact clear header excluding its nonce
+ *   (type || DH_pub || N || PN || pqEpoch).
+ * seal_message_chunk and receive_message both build it here, so the two sides
+ * cannot drift apart. */
+#define CHUNK_AAD_LEN (crypto_hash_sha512_BYTES + CHUNK_AAD_HEADER_LEN) /* 121 */
+
+static void
+chunk_aad(uint8_t aad[CHUNK_AAD_LEN],
+          const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+          const uint8_t header[CHUNK_AAD_HEADER_LEN])
+{
+  memcpy(aad, merkle_root, crypto_hash_sha512_BYTES);
+  memcpy(aad + crypto_hash_sha512_BYTES, header, CHUNK_AAD_HEADER_LEN);
+}
+
+/* ---------------- v4 send path ----------------
+ * Writes one finished wire cell:
+ *   message = header(57) || nonce(12) || AEAD(metadata || proof || chunk)
+ * The nonce is fresh and random per call. The plaintext is assembled directly
+ * in the ciphertext region and sealed in place, so the cell costs no scratch
+ * beyond the AAD. On failure the cell is wiped. */
+int
+seal_message_chunk(
+    uint8_t message[WIRE_CHUNK_FRAME_LEN],
+    const uint8_t header[CHUNK_AAD_HEADER_LEN],
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    const uint8_t metadata[METADATA_LEN], const uint8_t proof[PROOF_LEN],
+    const uint8_t chunk[CHUNK_LEN],
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  if (!message || !header || !merkle_root || !metadata || !proof || !chunk
+      || !message_key)
+    return -1;
+
+  uint8_t aad[CHUNK_AAD_LEN];
+  chunk_aad(aad, merkle_root, header);
+
+  uint8_t *nonce = message + CHUNK_AAD_HEADER_LEN;
+  uint8_t *plaintext = message + MESSAGE_START;
+
+  memcpy(message, header, CHUNK_AAD_HEADER_LEN);
+  randombytes_buf(nonce, RATCHET_NONCE_LEN);
+  memcpy(plaintext, metadata, METADATA_LEN);
+  memcpy(plaintext + METADATA_LEN, proof, PROOF_LEN);
+  memcpy(plaintext + METADATA_LEN + PROOF_LEN, chunk, CHUNK_LEN);
+
+  unsigned long long clen = 0;
+  int res = chacha20poly1305x4_ietf_encrypt(plaintext, &clen, plaintext,
+                                            DECRYPTED_LEN, aad, sizeof aad,
+                                            NULL, nonce, message_key);
+  if (res != 0)
+  {
+    sodium_memzero(message, WIRE_CHUNK_FRAME_LEN);
+    return -2;
+  }
+
+  return 0;
+}
+
+/* Number of (position, hash) artifacts in the authenticated plaintext's
+ * length-prefixed proof, or -1 when the prefix is malformed. */
+static int
+chunk_proof_artifacts(const uint8_t decrypted[DECRYPTED_LEN],
+                      size_t *artifacts)
+{
+  uint32_t proofLen = ((uint32_t)decrypted[METADATA_LEN] << 24)
+                      | ((uint32_t)decrypted[METADATA_LEN + 1] << 16)
+                      | ((uint32_t)decrypted[METADATA_LEN + 2] << 8)
+                      | (uint32_t)decrypted[METADATA_LEN + 3];
+  if (proofLen % (crypto_hash_sha512_BYTES + 1) != 0 || proofLen > PROOF_LEN)
+    return -1;
+
+  *artifacts = proofLen / (crypto_hash_sha512_BYTES + 1);
+  return 0;
+}
+
+/* Verifies the chunk's leaf hash against the root (through the proof cache
+ * when there is one) and writes it over the proof prefix as the receipt.
+ * Returns 0, or -6 on a Merkle mismatch. */
+static int
+chunk_verify_leaf(uint8_t decrypted[DECRYPTED_LEN], const size_t artifacts,
+                  const uint8_t leaf[crypto_hash_sha512_BYTES],
+                  const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+                  merkle_proof_cache *proof_cache)
+{
+  int vmp;
+  if (proof_cache)
+  {
+    vmp = merkle_proof_cache_verify(proof_cache, artifacts, leaf,
+                                    &decrypted[METADATA_LEN + 4]);
+  }
+  else
+  {
+    uint8_t fold[crypto_hash_sha512_BYTES];
+    memcpy(fold, leaf, crypto_hash_sha512_BYTES);
+    vmp = verify_merkle_proof(artifacts, fold, merkle_root,
+                              &decrypted[METADATA_LEN + 4]);
+  }
+  if (vmp != 0) return -6;
+
+  memcpy(&decrypted[METADATA_LEN], leaf, crypto_hash_sha512_BYTES);
+  return 0;
+}
+
 /* ---------------- v4 receive path (no signature) ----------------
  * Frame:
  *   [type(1) | DH_pub(32) | N(8) | PN(8) | pqEpoch(8) | nonce(12)
@@ -116,16 +221,19 @@ decrypt_chachapoly_symmetric(
  *   merkle_root || type || DH_pub || N || PN || pqEpoch.
  * The clear header excluding its random nonce is therefore authenticated
  * byte-for-byte, matching messageChunkCrypto.ts. Then verify the Merkle proof,
- * derive the leaf receipt, and return it in the decrypted buffer. */
-int
-receive_message_with_key(
-    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
-    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
-    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+ * derive the leaf receipt, and return it in the decrypted buffer. With a proof
+ * cache the root is the cache's and already-verified upper nodes are not
+ * rehashed; the result is otherwise identical. */
+static int
+receive_message(uint8_t decrypted[DECRYPTED_LEN],
+                const uint8_t message[MESSAGE_LEN],
+                const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+                merkle_proof_cache *proof_cache,
+                const uint8_t message_key
+                    [crypto_aead_chacha20poly1305_ietf_KEYBYTES])
 {
-  uint8_t aad[crypto_hash_sha512_BYTES + CHUNK_AAD_HEADER_LEN];
-  memcpy(aad, merkle_root, crypto_hash_sha512_BYTES);
-  memcpy(aad + crypto_hash_sha512_BYTES, message, CHUNK_AAD_HEADER_LEN);
+  uint8_t aad[CHUNK_AAD_LEN];
+  chunk_aad(aad, merkle_root, message);
 
   /* Nonce = the fresh, random 12-byte per-chunk nonce carried in the CLEARTEXT
    * frame header (right after pqEpoch, before the ciphertext).
@@ -135,22 +243,15 @@ receive_message_with_key(
   const uint8_t *nonce = message + CHUNK_AAD_HEADER_LEN;
 
   unsigned long long DATA_LEN = DECRYPTED_LEN;
-  int d = crypto_aead_chacha20poly1305_ietf_decrypt(
+  int d = chacha20poly1305x4_ietf_decrypt(
       decrypted, &DATA_LEN, NULL, message + MESSAGE_START,
       (unsigned long long)(DECRYPTED_LEN
                            + crypto_aead_chacha20poly1305_ietf_ABYTES),
       aad, sizeof aad, nonce, message_key);
   if (d != 0) return -2;
 
-  /* Verify the authenticated plaintext's Merkle proof and derive its receipt.
-   */
-  uint32_t proofLen = ((uint32_t)decrypted[METADATA_LEN] << 24)
-                      | ((uint32_t)decrypted[METADATA_LEN + 1] << 16)
-                      | ((uint32_t)decrypted[METADATA_LEN + 2] << 8)
-                      | (uint32_t)decrypted[METADATA_LEN + 3];
-  if (proofLen % (crypto_hash_sha512_BYTES + 1) != 0 || proofLen > PROOF_LEN)
-    return -3;
-  size_t proofArtifactsLen = proofLen / (crypto_hash_sha512_BYTES + 1);
+  size_t proofArtifactsLen;
+  if (chunk_proof_artifacts(decrypted, &proofArtifactsLen) != 0) return -3;
 
   uint8_t leaf[crypto_hash_sha512_BYTES];
   crypto_hash_sha512_state leaf_state;
@@ -164,12 +265,290 @@ receive_message_with_key(
   if (h == 0) h = crypto_hash_sha512_final(&leaf_state, leaf);
   if (h != 0) return -5;
 
-  uint8_t fold[crypto_hash_sha512_BYTES];
-  memcpy(fold, leaf, crypto_hash_sha512_BYTES);
-  int vmp = verify_merkle_proof(proofArtifactsLen, fold, merkle_root,
-                                &decrypted[METADATA_LEN + 4]);
-  if (vmp != 0) return -6;
+  return chunk_verify_leaf(decrypted, proofArtifactsLen, leaf, merkle_root,
+                           proof_cache);
+}
+
+/* Plaintext tile of receive_message_fused: small enough that the leaf hash
+ * reads it back from L1 right after ChaCha20 wrote it, and a multiple of the
+ * 64-byte ChaCha20 block so the stream's block counter carries across. */
+#define RECEIVE_TILE_LEN 4096U
+
+/* receive_message in one pass over the frame: each tile is MACed, decrypted
+ * and, where it overlaps the chunk, fed to the leaf hash while cache-hot,
+ * instead of a decrypt pass followed by a hash pass. Nothing is released until
+ * the tag checks out; on failure the plaintext written so far is wiped, so
+ * status codes and outputs are exactly receive_message's. */
+static int
+receive_message_fused(uint8_t decrypted[DECRYPTED_LEN],
+                      const uint8_t message[MESSAGE_LEN],
+                      const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+                      merkle_proof_cache *proof_cache,
+                      const uint8_t message_key
+                          [crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  uint8_t aad[CHUNK_AAD_LEN];
+  chunk_aad(aad, merkle_root, message);
+
+  const uint8_t *nonce = message + CHUNK_AAD_HEADER_LEN;
+  const uint8_t *ciphertext = message + MESSAGE_START;
+  const size_t chunk_start = METADATA_LEN + PROOF_LEN;
+
+  chacha20poly1305x4_ietf_stream stream;
+  if (chacha20poly1305x4_ietf_decrypt_init(&stream, aad, sizeof aad, nonce,
+                                           message_key)
+      != 0)
+    return -2;
+
+  uint8_t leaf[crypto_hash_sha512_BYTES];
+  crypto_hash_sha512_state leaf_state;
+  const uint8_t leaf_domain = 0x00;
+  int h = crypto_hash_sha512_init(&leaf_state);
+  if (h == 0) h = crypto_hash_sha512_update(&leaf_state, &leaf_domain, 1);
+
+  size_t off, take, from;
+  for (off = 0; off < DECRYPTED_LEN; off += take)
+  {
+    take = DECRYPTED_LEN - off < RECEIVE_TILE_LEN ? DECRYPTED_LEN - off
+                                                  : RECEIVE_TILE_LEN;
+    chacha20poly1305x4_ietf_decrypt_update(&stream, &decrypted[off],
+                                           &ciphertext[off], take);
+
+    from = off > chunk_start ? off : chunk_start;
+    if (h == 0 && from < off + take)
+      h = crypto_hash_sha512_update(&leaf_state, &decrypted[from],
+                                    off + take - from);
+  }
+  if (h == 0) h = crypto_hash_sha512_final(&leaf_state, leaf);
+
+  if (chacha20poly1305x4_ietf_decrypt_final(&stream,
+                                            &ciphertext[DECRYPTED_LEN])
+      != 0)
+  {
+    sodium_memzero(decrypted, DECRYPTED_LEN);
+    sodium_memzero(&leaf_state, sizeof leaf_state);
+    sodium_memzero(leaf, sizeof leaf);
+    return -2;
+  }
+
+  size_t proofArtifactsLen;
+  if (chunk_proof_artifacts(decrypted, &proofArtifactsLen) != 0) return -3;
+  if (h != 0) return -5;
+
+  return chunk_verify_leaf(decrypted, proofArtifactsLen, leaf, merkle_root,
+                           proof_cache);
+}
+
+int
+receive_message_with_key(
+    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  return receive_message(decrypted, message, merkle_root, NULL, message_key);
+}
+
+/* receive_message_with_key through the fused single-pass kernel. Same
+ * arguments, status codes and output. */
+int
+receive_message_with_key_fused(
+    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  return receive_message_fused(decrypted, message, merkle_root, NULL,
+                               message_key);
+}
+
+/* receive_message_with_key against a per-transfer proof cache
+ * (merkle_proof_cache_init with the transfer's root). Same status codes. */
+int
+receive_message_with_proof_cache(
+    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
+    merkle_proof_cache *proof_cache,
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  if (!proof_cache) return -1;
+
+  return receive_message(decrypted, message, proof_cache->root, proof_cache,
+                         message_key);
+}
+
+typedef struct
+{
+  uint8_t *decrypted;
+  const uint8_t *frames;
+  unsigned int frames_len;
+  const uint32_t *frame_offsets;
+  const uint8_t *merkle_roots;
+  merkle_proof_cache *proof_cache;
+  const uint8_t *message_keys;
+  int32_t *status;
+} receive_batch_job;
+
+static int
+receive_batch_task(void *ctx, const uint32_t i)
+{
+  const receive_batch_job *job = ctx;
+  uint8_t *out = &job->decrypted[i * (size_t)DECRYPTED_LEN];
+
+  if ((uint64_t)job->frame_offsets[i] + WIRE_CHUNK_FRAME_LEN > job->frames_len
+      || (job->proof_cache
+          && sodium_memcmp(job->proof_cache->root,
+                           &job->merkle_roots[i * crypto_hash_sha512_BYTES],
+                           crypto_hash_sha512_BYTES)
+                 != 0))
+  {
+    job->status[i] = -1;
+  }
+  else
+  {
+    job->status[i] = receive_message(
+        out, &job->frames[job->frame_offsets[i]],
+        &job->merkle_roots[i * crypto_hash_sha512_BYTES], job->proof_cache,
+        &job->message_keys[i * crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
+  }
+
+  if (job->status[i] != 0) sodium_memzero(out, DECRYPTED_LEN);
 
-  memcpy(&decrypted[METADATA_LEN], leaf, crypto_hash_sha512_BYTES);
   return 0;
 }
+
+/* receive_message_with_key over COUNT frames in one call. Frame i starts at
+ * frames[frame_offsets[i]] inside the FRAMES_LEN-byte buffer and is opened
+ * with merkle_roots[i * 64] and message_keys[i * 32]; its plaintext goes to
+ * decrypted[i * DECRYPTED_LEN] and its receive_message_with_key status to
+ * status[i] (-1 for an offset outside the buffer, or a root other than a
+ * non-NULL proof_cache's). A failed frame's slot is wiped, so no unverified
+ * plaintext is left behind. The frames are independent, so the threaded build
+ * opens them across the pool; with a proof_cache every frame updates it, so
+ * they are opened in order on the calling thread instead. Returns the number
+ * of frames that passed, or -1 on bad arguments. */
+int
+receive_message_batch(const unsigned int COUNT, uint8_t *decrypted,
+                      const uint8_t *frames, const unsigned int FRAMES_LEN,
+                      const uint32_t *frame_offsets,
+                      const uint8_t *merkle_roots,
+                      merkle_proof_cache *proof_cache,
+                      const uint8_t *message_keys, int32_t *status)
+{
+  if (COUNT == 0) return 0;
+  if (!decrypted || !frames || !frame_offsets || !merkle_roots
+      || !message_keys || !status)
+    return -1;
+
+  receive_batch_job job = { .decrypted = decrypted,
+                            .frames = frames,
+                            .frames_len = FRAMES_LEN,
+                            .frame_offsets = frame_offsets,
+                            .merkle_roots = merkle_roots,
+                            .proof_cache = proof_cache,
+                            .message_keys = message_keys,
+                            .status = status };
+  size_t i;
+  int passed = 0;
+
+  if (proof_cache)
+    for (i = 0; i < COUNT; i++) receive_batch_task(&job, (uint32_t)i);
+  else
+    pool_run(receive_batch_task, &job, COUNT);
+  for (i = 0; i < COUNT; i++)
+    if (status[i] == 0) passed++;
+
+  return passed;
+}
+
+/* ---------------- Ingress ring ---------------- */
+
+size_t
+ingress_ring_bytes(const unsigned int SLOTS)
+{
+  if (SLOTS == 0 || SLOTS > INGRESS_RING_MAX_SLOTS) return 0;
+
+  return sizeof(ingress_ring) + (size_t)SLOTS * WIRE_CHUNK_FRAME_LEN;
+}
+
+int
+ingress_ring_init(ingress_ring *ring, const unsigned int SLOTS)
+{
+  if (!ring || SLOTS == 0 || SLOTS > INGRESS_RING_MAX_SLOTS) return -1;
+
+  memset(ring, 0, ingress_ring_bytes(SLOTS));
+  ring->slots_len = SLOTS;
+
+  return 0;
+}
+
+/* Claims the next free slot after the last one handed out, so a slot that was
+ * just released is the last to be reused. Returns the slot index, or -1 when
+ * every slot is held. */
+int
+ingress_ring_claim(ingress_ring *ring)
+{
+  if (!ring) return -1;
+
+  uint32_t i;
+
+  for (i = 0; i < ring->slots_len; i++)
+  {
+    uint32_t slot = (ring->next + i) % ring->slots_len;
+    if (ring->claimed[slot]) continue;
+
+    ring->claimed[slot] = 1;
+    ring->next = (slot + 1) % ring->slots_len;
+    return (int)slot;
+  }
+
+  return -1;
+}
+
+uint8_t *
+ingress_ring_slot(ingress_ring *ring, const unsigned int slot)
+{
+  if (!ring || slot >= ring->slots_len || !ring->claimed[slot]) return NULL;
+
+  return &ring->cells[(size_t)slot * WIRE_CHUNK_FRAME_LEN];
+}
+
+/* Wipes the slot's cell (plaintext included) and hands it back. */
+int
+ingress_ring_release(ingress_ring *ring, const unsigned int slot)
+{
+  uint8_t *cell = ingress_ring_slot(ring, slot);
+  if (!cell) return -1;
+
+  sodium_memzero(cell, WIRE_CHUNK_FRAME_LEN);
+  ring->claimed[slot] = 0;
+
+  return 0;
+}
+
+/* receive_message_with_key on a claimed slot, in place: the ciphertext at
+ * MESSAGE_START is decrypted over itself (libsodium allows m == c) and the
+ * receipt leaf is written over the proof, so no second buffer is touched. The
+ * AAD and nonce are read from the cleartext header before that. proof_cache is
+ * NULL or a cache initialised with merkle_root, as in
+ * receive_message_with_proof_cache. Same status codes, plus -1 for a slot that
+ * is not claimed or a cache bound to another root. On failure the cell is
+ * wiped but stays claimed until ingress_ring_release. */
+int
+receive_message_in_slot(
+    ingress_ring *ring, const unsigned int slot,
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    merkle_proof_cache *proof_cache,
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  uint8_t *cell = ingress_ring_slot(ring, slot);
+  if (!cell || !merkle_root || !message_key) return -1;
+  if (proof_cache
+      && sodium_memcmp(proof_cache->root, merkle_root,
+                       crypto_hash_sha512_BYTES)
+             != 0)
+    return -1;
+
+  int r = receive_message(&cell[MESSAGE_START], cell, merkle_root,
+                          proof_cache, message_key);
+  if (r != 0) sodium_memzero(cell, WIRE_CHUNK_FRAME_LEN);
+
+  return r;
+}
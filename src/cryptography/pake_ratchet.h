@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "chacha20poly1305x4.h"
+#include "pool.h"
 #include "utils.h"
 
 #include <sodium.h>
@@ -43,9 +45,61 @@ int decrypt_chachapoly_symmetric(
     const uint8_t nonce[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
     const uint8_t *aad, const unsigned int aad_len);
 
+int seal_message_chunk(
+    uint8_t message[WIRE_CHUNK_FRAME_LEN],
+    const uint8_t header[CHUNK_AAD_HEADER_LEN],
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    const uint8_t metadata[METADATA_LEN], const uint8_t proof[PROOF_LEN],
+    const uint8_t chunk[CHUNK_LEN],
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
+
 int receive_message_with_key(
     uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
     const uint8_t merkle_root[crypto_hash_sha512_BYTES],
     const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
 
+/* receive_message_with_key in one tiled pass: decryption and the leaf hash
+ * share each cache-hot tile. Same status codes and output. */
+int receive_message_with_key_fused(
+    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
+
+int receive_message_with_proof_cache(
+    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
+    merkle_proof_cache *proof_cache,
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
+
+int receive_message_batch(const unsigned int COUNT, uint8_t *decrypted,
+                          const uint8_t *frames, const unsigned int FRAMES_LEN,
+                          const uint32_t *frame_offsets,
+                          const uint8_t *merkle_roots,
+                          merkle_proof_cache *proof_cache,
+                          const uint8_t *message_keys, int32_t *status);
+
+/* Receive-side ingress ring (see pake_ratchet.c): SLOTS wire-cell slots in one
+ * heap block of ingress_ring_bytes(SLOTS). A frame is copied straight into a
+ * claimed slot and receive_message_in_slot opens it in place, so the verified
+ * plaintext is the DECRYPTED_LEN window at slot + MESSAGE_START. */
+#define INGRESS_RING_MAX_SLOTS 32U
+typedef struct
+{
+  uint32_t slots_len;
+  uint32_t next;
+  uint8_t claimed[INGRESS_RING_MAX_SLOTS];
+  uint8_t cells[];
+} ingress_ring;
+
+size_t ingress_ring_bytes(const unsigned int SLOTS);
+int ingress_ring_init(ingress_ring *ring, const unsigned int SLOTS);
+int ingress_ring_claim(ingress_ring *ring);
+uint8_t *ingress_ring_slot(ingress_ring *ring, const unsigned int slot);
+int ingress_ring_release(ingress_ring *ring, const unsigned int slot);
+
+int receive_message_in_slot(
+    ingress_ring *ring, const unsigned int slot,
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    merkle_proof_cache *proof_cache,
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES]);
+
 #endif
@@ -0,0 +1,261 @@
+#include "pool.h"
+
+static int
+pool_run_serial(pool_task task, void *ctx, const uint32_t COUNT)
+{
+  uint32_t i;
+  int status;
+
+  for (i = 0; i < COUNT; i++)
+  {
+    status = task(ctx, i);
+    if (status != 0) return status;
+  }
+
+  return 0;
+}
+
+#if POOL_THREADED
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Worker stacks come from the heap; the batch tasks keep a few KiB on it. */
+#define POOL_STACK_BYTES (128U * 1024U)
+
+/* A thread's share of the current run, [lo, hi) packed as lo | hi << 32, so
+ * the owner taking lo and a thief cutting hi are each one compare-exchange on
+ * the same word. Padded to its own cache line. */
+typedef struct
+{
+  _Atomic uint64_t range;
+  uint8_t pad[56];
+} pool_share;
+
+static struct
+{
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t idle;
+  unsigned int workers;
+  unsigned int busy;
+  unsigned int running;
+  uint64_t generation;
+  uint64_t joined[POOL_MAX_THREADS];
+  pool_task task;
+  void *ctx;
+  unsigned int shares;
+  _Atomic int status;
+  pool_share share[POOL_MAX_THREADS];
+} pool = { .lock = PTHREAD_MUTEX_INITIALIZER,
+           .wake = PTHREAD_COND_INITIALIZER,
+           .idle = PTHREAD_COND_INITIALIZER };
+
+/* Set on workers and on a caller while it runs its share: a nested run
+ * stays on its thread instead of waiting for workers that are all busy. */
+static _Thread_local int pool_inside;
+
+static int
+pool_take(pool_share *share, uint32_t *index)
+{
+  uint64_t range = atomic_load(&share->range);
+
+  for (;;)
+  {
+    if ((uint32_t)range >= (uint32_t)(range >> 32)) return 0;
+    if (atomic_compare_exchange_weak(&share->range, &range, range + 1))
+    {
+      *index = (uint32_t)range;
+      return 1;
+    }
+  }
+}
+
+/* Moves the back half of the fullest other share into share SELF. 0 once
+ * every share is empty; indices another thread has taken are its own to
+ * finish, which the caller waits for through `busy`. */
+static int
+pool_steal(const unsigned int SELF)
+{
+  for (;;)
+  {
+    uint64_t seen = 0;
+    uint32_t most = 0;
+    unsigned int victim = SELF;
+    unsigned int s;
+
+    for (s = 0; s < pool.shares; s++)
+    {
+      if (s == SELF) continue;
+
+      uint64_t range = atomic_load(&pool.share[s].range);
+      uint32_t lo = (uint32_t)range;
+      uint32_t hi = (uint32_t)(range >> 32);
+      if (hi > lo && hi - lo > most)
+      {
+        most = hi - lo;
+        victim = s;
+        seen = range;
+      }
+    }
+    if (most == 0) return 0;
+
+    uint32_t lo = (uint32_t)seen;
+    uint32_t hi = (uint32_t)(seen >> 32);
+    uint32_t mid = hi - (most + 1) / 2;
+
+    if (atomic_compare_exchange_strong(&pool.share[victim].range, &seen,
+                                       lo | (uint64_t)mid << 32))
+    {
+      atomic_store(&pool.share[SELF].range, mid | (uint64_t)hi << 32);
+      return 1;
+    }
+  }
+}
+
+static void
+pool_work(const unsigned int SELF)
+{
+  uint32_t index;
+
+  while (atomic_load(&pool.status) == 0)
+  {
+    if (!pool_take(&pool.share[SELF], &index))
+    {
+      if (!pool_steal(SELF)) return;
+      continue;
+    }
+
+    int status = pool.task(pool.ctx, index);
+    if (status != 0)
+    {
+      int expected = 0;
+      atomic_compare_exchange_strong(&pool.status, &expected, status);
+    }
+  }
+}
+
+static void *
+pool_worker(void *arg)
+{
+  const unsigned int self = (unsigned int)(uintptr_t)arg;
+
+  pool_inside = 1;
+  pthread_mutex_lock(&pool.lock);
+  uint64_t seen = pool.joined[self];
+
+  for (;;)
+  {
+    while (pool.generation == seen) pthread_cond_wait(&pool.wake, &pool.lock);
+    seen = pool.generation;
+    pthread_mutex_unlock(&pool.lock);
+
+    pool_work(self);
+
+    pthread_mutex_lock(&pool.lock);
+    if (--pool.busy == 0) pthread_cond_signal(&pool.idle);
+  }
+
+  return NULL;
+}
+#endif
+
+int
+pool_init(const unsigned int THREADS)
+{
+  if (THREADS == 0 || THREADS > POOL_MAX_THREADS) return -1;
+
+#if POOL_THREADED
+  int res = 0;
+  pthread_attr_t attr;
+
+  if (pthread_attr_init(&attr) != 0) return -2;
+  pthread_attr_setstacksize(&attr, POOL_STACK_BYTES);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  pthread_mutex_lock(&pool.lock);
+  while (pool.workers + 1 < THREADS)
+  {
+    pthread_t thread;
+    const unsigned int self = pool.workers + 1;
+
+    // A worker joins the runs that start after it exists, not the current one.
+    pool.joined[self] = pool.generation;
+    if (pthread_create(&thread, &attr, pool_worker, (void *)(uintptr_t)self)
+        != 0)
+    {
+      res = -2;
+      break;
+    }
+    pool.workers++;
+  }
+  pthread_mutex_unlock(&pool.lock);
+  pthread_attr_destroy(&attr);
+
+  return res;
+#else
+  return 0;
+#endif
+}
+
+unsigned int
+pool_threads(void)
+{
+#if POOL_THREADED
+  pthread_mutex_lock(&pool.lock);
+  const unsigned int threads = pool.workers + 1;
+  pthread_mutex_unlock(&pool.lock);
+
+  return threads;
+#else
+  return 1;
+#endif
+}
+
+int
+pool_run(pool_task task, void *ctx, const uint32_t COUNT)
+{
+  if (!task) return -1;
+
+#if POOL_THREADED
+  if (COUNT < 2 || pool_inside) return pool_run_serial(task, ctx, COUNT);
+
+  pthread_mutex_lock(&pool.lock);
+  if (pool.workers == 0 || pool.running)
+  {
+    pthread_mutex_unlock(&pool.lock);
+    return pool_run_serial(task, ctx, COUNT);
+  }
+
+  unsigned int s;
+
+  pool.running = 1;
+  pool.task = task;
+  pool.ctx = ctx;
+  pool.shares = pool.workers + 1;
+  atomic_store(&pool.status, 0);
+  for (s = 0; s < pool.shares; s++)
+  {
+    uint64_t lo = (uint64_t)COUNT * s / pool.shares;
+    uint64_t hi = (uint64_t)COUNT * (s + 1) / pool.shares;
+    atomic_store(&pool.share[s].range, lo | hi << 32);
+  }
+  pool.busy = pool.workers;
+  pool.generation++;
+  pthread_cond_broadcast(&pool.wake);
+  pthread_mutex_unlock(&pool.lock);
+
+  pool_inside = 1;
+  pool_work(0);
+  pool_inside = 0;
+
+  pthread_mutex_lock(&pool.lock);
+  while (pool.busy != 0) pthread_cond_wait(&pool.idle, &pool.lock);
+  pool.running = 0;
+  const int status = atomic_load(&pool.status);
+  pthread_mutex_unlock(&pool.lock);
+
+  return status;
+#else
+  return pool_run_serial(task, ctx, COUNT);
+#endif
+}
@@ -0,0 +1,48 @@
+#ifndef pool_H
+#define pool_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Work-stealing task pool (see pool.c), the C side of the threaded artifact
+ * in wasmLoader.ts. pool_run(task, ctx, COUNT) calls task(ctx, i) once for
+ * every i in [0, COUNT): the range is split evenly over the calling thread
+ * and the pool's workers, each takes indices from the front of its own share,
+ * and a thread whose share runs out steals the back half of the fullest one,
+ * so one slow index (a big Argon2 lane, a frame that fails late) does not
+ * leave the other cores idle. Tasks must be independent of each other.
+ *
+ * Only the -pthread build (__EMSCRIPTEN_PTHREADS__) has workers. Everywhere
+ * else pool_run is a plain loop on the calling thread, with the same results
+ * in the same memory. */
+#ifdef __EMSCRIPTEN_PTHREADS__
+#define POOL_THREADED 1
+#else
+#define POOL_THREADED 0
+#endif
+
+/* Workers besides the calling thread. PTHREAD_POOL_SIZE is a runtime value
+ * (Module.pthreadPoolSize); loadThreadedWasm in wasmLoader.ts caps it at this
+ * and passes pool_init one thread more, so pool_init never waits on a new Web
+ * Worker. */
+#define POOL_MAX_WORKERS 7U
+#define POOL_MAX_THREADS (POOL_MAX_WORKERS + 1U)
+
+/* Returns 0 to go on, anything else to stop the run: indices nobody has
+ * taken yet are skipped and pool_run returns the first such status. */
+typedef int (*pool_task)(void *ctx, const uint32_t index);
+
+/* Starts workers until THREADS threads, the caller included, share each run;
+ * THREADS is 1..POOL_MAX_THREADS. Workers are never stopped, so a later call
+ * can only add to them. Without threads this succeeds and keeps one. */
+int pool_init(const unsigned int THREADS);
+
+/* Threads that share a run, the caller included: 1 until pool_init. */
+unsigned int pool_threads(void);
+
+/* Runs task over [0, COUNT) and returns once every index has finished: 0, or
+ * the first non-zero status a task returned. A run started from inside a task
+ * runs on that thread alone. */
+int pool_run(pool_task task, void *ctx, const uint32_t COUNT);
+
+#endif
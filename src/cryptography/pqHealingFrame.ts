@@ -22,6 +22,7 @@ import {
   RATCHET_PN_LEN,
   WIRE_CHUNK_FRAME_LEN,
 } from "../utils/constants";
+import { secureMalloc } from "./slab";
 import { zeroFree } from "../utils/zeroFree";
 
 import type { LibCrypto } from "./libcrypto";
@@ -246,11 +247,11 @@ const aeadSeal = (
 ): Uint8Array => {
   const outputLength =
     plaintext.length + crypto_aead_chacha20poly1305_ietf_ABYTES;
-  const keyPtr = module._malloc(key.length);
-  const noncePtr = module._malloc(nonce.length);
-  const plaintextPtr = module._malloc(plaintext.length);
-  const aadPtr = module._malloc(aad.length);
-  const outputPtr = module._malloc(outputLength);
+  const keyPtr = secureMalloc(module, key.length);
+  const noncePtr = secureMalloc(module, nonce.length);
+  const plaintextPtr = secureMalloc(module, plaintext.length);
+  const aadPtr = secureMalloc(module, aad.length);
+  const outputPtr = secureMalloc(module, outputLength);
   try {
     new Uint8Array(module.wasmMemory.buffer, keyPtr, key.length).set(key);
     new Uint8Array(module.wasmMemory.buffer, noncePtr, nonce.length).set(nonce);
@@ -279,12 +280,18 @@ const aeadSeal = (
       module,
       new Uint8Array(module.wasmMemory.buffer, keyPtr, key.length),
     );
-    module._free(noncePtr);
+    zeroFree(
+      module,
+      new Uint8Array(module.wasmMemory.buffer, noncePtr, nonce.length),
+    );
     zeroFree(
       module,
       new Uint8Array(module.wasmMemory.buffer, plaintextPtr, plaintext.length),
     );
-    module._free(aadPtr);
+    zeroFree(
+      module,
+      new Uint8Array(module.wasmMemory.buffer, aadPtr, aad.length),
+    );
     zeroFree(
       module,
       new Uint8Array(module.wasmMemory.buffer, outputPtr, outputLength),
@@ -301,11 +308,11 @@ const aeadOpen = (
 ): Uint8Array => {
   const plaintextLength =
     ciphertext.length - crypto_aead_chacha20poly1305_ietf_ABYTES;
-  const keyPtr = module._malloc(key.length);
-  const noncePtr = module._malloc(nonce.length);
-  const ciphertextPtr = module._malloc(ciphertext.length);
-  const aadPtr = module._malloc(aad.length);
-  const plaintextPtr = module._malloc(plaintextLength);
+  const keyPtr = secureMalloc(module, key.length);
+  const noncePtr = secureMalloc(module, nonce.length);
+  const ciphertextPtr = secureMalloc(module, ciphertext.length);
+  const aadPtr = secureMalloc(module, aad.length);
+  const plaintextPtr = secureMalloc(module, plaintextLength);
   try {
     new Uint8Array(module.wasmMemory.buffer, keyPtr, key.length).set(key);
     new Uint8Array(module.wasmMemory.buffer, noncePtr, nonce.length).set(nonce);
@@ -341,9 +348,22 @@ const aeadOpen = (
       module,
       new Uint8Array(module.wasmMemory.buffer, keyPtr, key.length),
     );
-    module._free(noncePtr);
-    module._free(ciphertextPtr);
-    module._free(aadPtr);
+    zeroFree(
+      module,
+      new Uint8Array(module.wasmMemory.buffer, noncePtr, nonce.length),
+    );
+    zeroFree(
+      module,
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        ciphertextPtr,
+        ciphertext.length,
+      ),
+    );
+    zeroFree(
+      module,
+      new Uint8Array(module.wasmMemory.buffer, aadPtr, aad.length),
+    );
     zeroFree(
       module,
       new Uint8Array(module.wasmMemory.buffer, plaintextPtr, plaintextLength),
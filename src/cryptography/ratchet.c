@@ -0,0 +1,370 @@
+#include "ratchet.h"
+
+/* HKDF info / HMAC message labels, byte-matched to KDF_RK_LABEL, KDF_CK_LABEL
+ * and KDF_MK_LABEL in constants.ts (without the NUL). */
+static const uint8_t ratchet_rk_label[] = "p2party-rk-v1";
+static const uint8_t ratchet_ck_label[] = "p2party-ck-v1";
+static const uint8_t ratchet_mk_label[] = "p2party-mk-v1";
+
+static inline void
+ratchet_store64_be(uint8_t dst[8], const uint64_t w)
+{
+  size_t i;
+
+  for (i = 0; i < 8; i++) dst[i] = (uint8_t)(w >> (56 - 8 * i));
+}
+
+static inline uint64_t
+ratchet_load64_be(const uint8_t src[8])
+{
+  uint64_t w = 0;
+  size_t i;
+
+  for (i = 0; i < 8; i++) w = (w << 8) | src[i];
+
+  return w;
+}
+
+/* Keys the chain's HMAC once; every later derivation from this chain key
+ * starts from a copy of the pads. */
+static int
+ratchet_chain_set(uint8_t chain_key[RATCHET_KEY_LEN],
+                  crypto_auth_hmacsha512_state *pads,
+                  const uint8_t next[RATCHET_KEY_LEN])
+{
+  if (chain_key != next) memcpy(chain_key, next, RATCHET_KEY_LEN);
+
+  return crypto_auth_hmacsha512_init(pads, chain_key, RATCHET_KEY_LEN) == 0
+             ? 0
+             : -5;
+}
+
+/* KDF_CK: message key = HMAC(ck, MK label)[0..32], next chain key = HMAC(ck,
+ * CK label)[0..32]. Both derivations resume from the cached pads, and the
+ * consumed chain key is overwritten by its successor. */
+static int
+ratchet_chain_step(uint8_t chain_key[RATCHET_KEY_LEN],
+                   crypto_auth_hmacsha512_state *pads,
+                   uint8_t message_key[RATCHET_KEY_LEN])
+{
+  crypto_auth_hmacsha512_state mac;
+  uint8_t full[crypto_auth_hmacsha512_BYTES];
+  int res = -5;
+
+  memcpy(&mac, pads, sizeof mac);
+  if (crypto_auth_hmacsha512_update(&mac, ratchet_mk_label,
+                                    sizeof ratchet_mk_label - 1)
+          != 0
+      || crypto_auth_hmacsha512_final(&mac, full) != 0)
+    goto out;
+  memcpy(message_key, full, RATCHET_KEY_LEN);
+
+  memcpy(&mac, pads, sizeof mac);
+  if (crypto_auth_hmacsha512_update(&mac, ratchet_ck_label,
+                                    sizeof ratchet_ck_label - 1)
+          != 0
+      || crypto_auth_hmacsha512_final(&mac, full) != 0)
+    goto out;
+
+  res = ratchet_chain_set(chain_key, pads, full);
+
+out:
+  sodium_memzero(&mac, sizeof mac);
+  sodium_memzero(full, sizeof full);
+
+  return res;
+}
+
+/* KDF_RK: HKDF-Extract(salt = root, ikm = DH(self sec, remote pub)), Expand
+ * to 64 bytes: the new root and a chain key, which is keyed into pads. */
+static int
+ratchet_root_step(ratchet_state *state, uint8_t chain_key[RATCHET_KEY_LEN],
+                  crypto_auth_hmacsha512_state *pads)
+{
+  uint8_t dh[crypto_scalarmult_curve25519_BYTES];
+  uint8_t prk[crypto_auth_hmacsha512_BYTES];
+  uint8_t okm[2 * RATCHET_KEY_LEN];
+  int res = -5;
+
+  if (x25519_dh(dh, state->dh_self_sec, state->dh_remote_pub) != 0
+      || hkdf_sha512_extract(prk, state->root_key, RATCHET_KEY_LEN, dh,
+                             sizeof dh)
+             != 0
+      || hkdf_sha512_expand(okm, sizeof okm, prk, ratchet_rk_label,
+                            sizeof ratchet_rk_label - 1)
+             != 0)
+    goto out;
+
+  memcpy(state->root_key, okm, RATCHET_KEY_LEN);
+  res = ratchet_chain_set(chain_key, pads, okm + RATCHET_KEY_LEN);
+
+out:
+  sodium_memzero(dh, sizeof dh);
+  sodium_memzero(prk, sizeof prk);
+  sodium_memzero(okm, sizeof okm);
+
+  return res;
+}
+
+/* The peer moved to remote_pub: open the receiving chain from DH(old self,
+ * remote), rotate our DH keypair, then open the sending chain from DH(new
+ * self, remote). The retired DH secret is overwritten by the new one. */
+static int
+ratchet_dh_step(ratchet_state *state,
+                const uint8_t remote_pub[RATCHET_DHPUB_LEN])
+{
+  state->PN = state->Ns;
+  state->Ns = 0;
+  state->Nr = 0;
+  memcpy(state->dh_remote_pub, remote_pub, RATCHET_DHPUB_LEN);
+  state->flags |= RATCHET_FLAG_REMOTE_DH;
+
+  if (ratchet_root_step(state, state->receiving_chain_key,
+                        &state->receiving_pads)
+      != 0)
+    return -5;
+  state->flags |= RATCHET_FLAG_RECEIVING_CHAIN;
+
+  if (x25519_keypair(state->dh_self_pub, state->dh_self_sec) != 0) return -5;
+
+  if (ratchet_root_step(state, state->sending_chain_key, &state->sending_pads)
+      != 0)
+    return -5;
+  state->flags |= RATCHET_FLAG_SENDING_CHAIN;
+
+  return 0;
+}
+
+/* Derives the receiving chain's keys for [Nr, until) into the table, or
+ * emits them to skipped. The MAX_SKIP bound holds even when there is no chain
+ * to derive from yet. */
+static int
+ratchet_skip(ratchet_state *state, const uint64_t until, skipped_keys *table,
+             uint8_t *skipped, const unsigned int SKIPPED_CAP,
+             unsigned int *skipped_len)
+{
+  if (until > state->Nr && until - state->Nr > MAX_SKIP) return -2;
+  if (!(state->flags & RATCHET_FLAG_RECEIVING_CHAIN)) return 0;
+
+  uint8_t entry[RATCHET_SKIPPED_ENTRY_LEN];
+  uint8_t id[SKIPPED_KEY_ID_LEN];
+  int res = 0;
+
+  for (; state->Nr < until; state->Nr++)
+  {
+    if (!table && *skipped_len >= SKIPPED_CAP)
+    {
+      res = -1;
+      break;
+    }
+
+    memcpy(entry, state->dh_remote_pub, RATCHET_DHPUB_LEN);
+    ratchet_store64_be(entry + RATCHET_DHPUB_LEN, state->Nr);
+    if (ratchet_chain_step(state->receiving_chain_key, &state->receiving_pads,
+                           entry + RATCHET_DHPUB_LEN + 8)
+        != 0)
+    {
+      res = -5;
+      break;
+    }
+
+    if (table)
+    {
+      // Classical skipped keys are never epoch-bound: the id's epoch is 0.
+      memcpy(id, entry, RATCHET_DHPUB_LEN + 8);
+      memset(id + RATCHET_DHPUB_LEN + 8, 0, 8);
+      if (skipped_keys_put(table, id, entry + RATCHET_DHPUB_LEN + 8) < 0)
+      {
+        res = -1;
+        break;
+      }
+    }
+    else
+    {
+      memcpy(&skipped[*skipped_len * RATCHET_SKIPPED_ENTRY_LEN], entry,
+             RATCHET_SKIPPED_ENTRY_LEN);
+    }
+    (*skipped_len)++;
+  }
+
+  sodium_memzero(entry, sizeof entry);
+
+  return res;
+}
+
+int
+ratchet_state_import(ratchet_state *state,
+                     const uint8_t serialized[RATCHET_SERIALIZED_LEN])
+{
+  if (!state || !serialized) return -1;
+
+  const uint8_t *keys = serialized + 25;
+  const uint32_t flags = serialized[24];
+
+  if (flags
+      & ~(RATCHET_FLAG_SENDING_CHAIN | RATCHET_FLAG_RECEIVING_CHAIN
+          | RATCHET_FLAG_REMOTE_DH))
+    return -1;
+  if ((flags & RATCHET_FLAG_RECEIVING_CHAIN)
+      && !(flags & RATCHET_FLAG_REMOTE_DH))
+    return -1;
+
+  sodium_memzero(state, sizeof *state);
+  state->Ns = ratchet_load64_be(serialized);
+  state->Nr = ratchet_load64_be(serialized + 8);
+  state->PN = ratchet_load64_be(serialized + 16);
+  state->flags = flags;
+  memcpy(state->root_key, keys, RATCHET_KEY_LEN);
+  memcpy(state->dh_self_pub, keys + 3 * RATCHET_KEY_LEN, RATCHET_DHPUB_LEN);
+  memcpy(state->dh_self_sec, keys + 4 * RATCHET_KEY_LEN, RATCHET_KEY_LEN);
+  memcpy(state->dh_remote_pub, keys + 5 * RATCHET_KEY_LEN, RATCHET_DHPUB_LEN);
+
+  if ((flags & RATCHET_FLAG_SENDING_CHAIN)
+      && ratchet_chain_set(state->sending_chain_key, &state->sending_pads,
+                           keys + RATCHET_KEY_LEN)
+             != 0)
+    return -5;
+  if ((flags & RATCHET_FLAG_RECEIVING_CHAIN)
+      && ratchet_chain_set(state->receiving_chain_key, &state->receiving_pads,
+                           keys + 2 * RATCHET_KEY_LEN)
+             != 0)
+    return -5;
+
+  return 0;
+}
+
+int
+ratchet_state_export(uint8_t serialized[RATCHET_SERIALIZED_LEN],
+                     const ratchet_state *state)
+{
+  if (!serialized || !state) return -1;
+
+  uint8_t *keys = serialized + 25;
+
+  sodium_memzero(serialized, RATCHET_SERIALIZED_LEN);
+  ratchet_store64_be(serialized, state->Ns);
+  ratchet_store64_be(serialized + 8, state->Nr);
+  ratchet_store64_be(serialized + 16, state->PN);
+  serialized[24] = (uint8_t)state->flags;
+  memcpy(keys, state->root_key, RATCHET_KEY_LEN);
+  if (state->flags & RATCHET_FLAG_SENDING_CHAIN)
+    memcpy(keys + RATCHET_KEY_LEN, state->sending_chain_key, RATCHET_KEY_LEN);
+  if (state->flags & RATCHET_FLAG_RECEIVING_CHAIN)
+    memcpy(keys + 2 * RATCHET_KEY_LEN, state->receiving_chain_key,
+           RATCHET_KEY_LEN);
+  memcpy(keys + 3 * RATCHET_KEY_LEN, state->dh_self_pub, RATCHET_DHPUB_LEN);
+  memcpy(keys + 4 * RATCHET_KEY_LEN, state->dh_self_sec, RATCHET_KEY_LEN);
+  if (state->flags & RATCHET_FLAG_REMOTE_DH)
+    memcpy(keys + 5 * RATCHET_KEY_LEN, state->dh_remote_pub,
+           RATCHET_DHPUB_LEN);
+
+  return 0;
+}
+
+int
+ratchet_init(ratchet_state *state, const uint8_t root_seed[RATCHET_KEY_LEN],
+             const uint8_t *remote_dh_pub)
+{
+  if (!state || !root_seed) return -1;
+
+  sodium_memzero(state, sizeof *state);
+  memcpy(state->root_key, root_seed, RATCHET_KEY_LEN);
+  if (x25519_keypair(state->dh_self_pub, state->dh_self_sec) != 0) return -5;
+
+  // Responder: both chains stay closed until ratchet_prime_responder or the
+  // first inbound message.
+  if (!remote_dh_pub) return 0;
+
+  memcpy(state->dh_remote_pub, remote_dh_pub, RATCHET_DHPUB_LEN);
+  state->flags = RATCHET_FLAG_REMOTE_DH;
+  if (ratchet_root_step(state, state->sending_chain_key, &state->sending_pads)
+      != 0)
+    return -5;
+  state->flags |= RATCHET_FLAG_SENDING_CHAIN;
+
+  return 0;
+}
+
+int
+ratchet_prime_responder(ratchet_state *state,
+                        const uint8_t initiator_dh_pub[RATCHET_DHPUB_LEN])
+{
+  if (!state || !initiator_dh_pub) return -1;
+  if (state->flags != 0 || state->Ns != 0 || state->Nr != 0 || state->PN != 0)
+    return -1;
+
+  return ratchet_dh_step(state, initiator_dh_pub);
+}
+
+int
+ratchet_encrypt_step(ratchet_state *state,
+                     uint8_t message_key[RATCHET_KEY_LEN],
+                     uint8_t header[RATCHET_HEADER_LEN])
+{
+  if (!state || !message_key || !header) return -1;
+  if (!(state->flags & RATCHET_FLAG_SENDING_CHAIN)) return -1;
+
+  if (ratchet_chain_step(state->sending_chain_key, &state->sending_pads,
+                         message_key)
+      != 0)
+    return -5;
+
+  memcpy(header, state->dh_self_pub, RATCHET_DHPUB_LEN);
+  ratchet_store64_be(header + RATCHET_DHPUB_LEN, state->Ns);
+  ratchet_store64_be(header + RATCHET_DHPUB_LEN + RATCHET_N_LEN, state->PN);
+  state->Ns++;
+
+  return 0;
+}
+
+int
+ratchet_decrypt_step(ratchet_state *state,
+                     uint8_t message_key[RATCHET_KEY_LEN],
+                     const uint8_t header[RATCHET_HEADER_LEN],
+                     skipped_keys *table, uint8_t *skipped,
+                     const unsigned int SKIPPED_CAP, unsigned int *skipped_len)
+{
+  if (!state || !message_key || !header || !skipped_len) return -1;
+  if (!table && SKIPPED_CAP > 0 && !skipped) return -1;
+
+  const uint8_t *dh_pub = header;
+  const uint64_t n = ratchet_load64_be(header + RATCHET_DHPUB_LEN);
+  const uint64_t pn
+      = ratchet_load64_be(header + RATCHET_DHPUB_LEN + RATCHET_N_LEN);
+  int res;
+
+  *skipped_len = 0;
+
+  if (table)
+  {
+    uint8_t id[SKIPPED_KEY_ID_LEN];
+
+    memcpy(id, header, RATCHET_DHPUB_LEN + RATCHET_N_LEN);
+    memset(id + RATCHET_DHPUB_LEN + RATCHET_N_LEN, 0, 8);
+    if (skipped_keys_take(table, id, message_key) == 0) return 1;
+  }
+
+  // Public values, so a plain comparison is fine here.
+  if (!(state->flags & RATCHET_FLAG_REMOTE_DH)
+      || memcmp(dh_pub, state->dh_remote_pub, RATCHET_DHPUB_LEN) != 0)
+  {
+    // Finish the previous chain, then step.
+    res = ratchet_skip(state, pn, table, skipped, SKIPPED_CAP, skipped_len);
+    if (res != 0) return res;
+    if (ratchet_dh_step(state, dh_pub) != 0) return -5;
+  }
+
+  if (n < state->Nr) return -3;
+
+  res = ratchet_skip(state, n, table, skipped, SKIPPED_CAP, skipped_len);
+  if (res != 0) return res;
+  if (!(state->flags & RATCHET_FLAG_RECEIVING_CHAIN)) return -4;
+
+  if (ratchet_chain_step(state->receiving_chain_key, &state->receiving_pads,
+                         message_key)
+      != 0)
+    return -5;
+  state->Nr++;
+
+  return 0;
+}
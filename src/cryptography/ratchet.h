@@ -0,0 +1,98 @@
+#ifndef ratchet_H
+#define ratchet_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sodium.h>
+
+#include "pake_ratchet.h"
+#include "skipped_keys.h"
+#include "utils.h"
+
+/* Double Ratchet engine (see ratchet.c), the C side of ratchet.ts. One call
+ * runs a whole encrypt or decrypt step, DH ratchet and skipped-key derivation
+ * included, on a ratchet_state in WASM memory. Each chain key's HMAC-SHA512
+ * inner/outer pad state is computed once, when the key is set, and shared by
+ * the message-key and next-chain-key derivations. The state crosses the JS
+ * boundary only through ratchet_state_import/_export. */
+#define RATCHET_KEY_LEN 32U
+#define MAX_SKIP 512U
+
+#define RATCHET_FLAG_SENDING_CHAIN 1U
+#define RATCHET_FLAG_RECEIVING_CHAIN 2U
+#define RATCHET_FLAG_REMOTE_DH 4U
+
+/* Ns || Nr || PN (u64 big-endian) || flags || root key || sending chain key
+ * || receiving chain key || DH self pub || DH self sec || DH remote pub.
+ * Absent chains and remote pub are zero and their flag is clear. */
+#define RATCHET_SERIALIZED_LEN (25U + 6U * RATCHET_KEY_LEN) /* 217 */
+
+/* DH pub || N || PN, as in the chunk header. */
+#define RATCHET_HEADER_LEN                                                     \
+  (RATCHET_DHPUB_LEN + RATCHET_N_LEN + RATCHET_PN_LEN) /* 48 */
+
+/* DH pub || n (u64 big-endian) || message key, one per skipped message. */
+#define RATCHET_SKIPPED_ENTRY_LEN                                              \
+  (RATCHET_DHPUB_LEN + 8U + RATCHET_KEY_LEN) /* 72 */
+
+/* Byte-matched to ratchet_STATEBYTES in interfaces.ts. */
+typedef struct
+{
+  crypto_auth_hmacsha512_state sending_pads;
+  crypto_auth_hmacsha512_state receiving_pads;
+  uint64_t Ns;
+  uint64_t Nr;
+  uint64_t PN;
+  uint8_t root_key[RATCHET_KEY_LEN];
+  uint8_t sending_chain_key[RATCHET_KEY_LEN];
+  uint8_t receiving_chain_key[RATCHET_KEY_LEN];
+  uint8_t dh_self_pub[RATCHET_DHPUB_LEN];
+  uint8_t dh_self_sec[RATCHET_KEY_LEN];
+  uint8_t dh_remote_pub[RATCHET_DHPUB_LEN];
+  uint32_t flags;
+} ratchet_state;
+_Static_assert(sizeof(ratchet_state) == 1056,
+               "ratchet_state layout must match interfaces.ts");
+
+/* Rejects unknown flags and a chain without a remote DH pub with -1. */
+int ratchet_state_import(ratchet_state *state,
+                         const uint8_t serialized[RATCHET_SERIALIZED_LEN]);
+int ratchet_state_export(uint8_t serialized[RATCHET_SERIALIZED_LEN],
+                         const ratchet_state *state);
+
+/* Fresh DH keypair; with remote_dh_pub (initiator) the first root step also
+ * opens the sending chain. remote_dh_pub is NULL for the responder. */
+int ratchet_init(ratchet_state *state,
+                 const uint8_t root_seed[RATCHET_KEY_LEN],
+                 const uint8_t *remote_dh_pub);
+
+/* Responder bootstrap: the receive-side DH step on the initiator's
+ * authenticated pub, without deriving a message key. -1 unless pristine. */
+int ratchet_prime_responder(
+    ratchet_state *state,
+    const uint8_t initiator_dh_pub[RATCHET_DHPUB_LEN]);
+
+/* Advances the sending chain. -1 when there is none. */
+int ratchet_encrypt_step(ratchet_state *state,
+                         uint8_t message_key[RATCHET_KEY_LEN],
+                         uint8_t header[RATCHET_HEADER_LEN]);
+
+/* Advances the receiving side for an (unauthenticated) header. With a table,
+ * a key already stored for the header's (DH pub, N) is taken from it first
+ * and 1 is returned with the state untouched; the keys of messages the step
+ * skips are put into the table. Without one the caller has checked its own
+ * store, and the skipped keys are written to skipped, RATCHET_SKIPPED_ENTRY_LEN
+ * bytes each in derivation order. Either way skipped_len is their number.
+ * Returns -1 on bad arguments or when skipped cannot hold them, -2 past
+ * MAX_SKIP, -3 for an already consumed index, -4 without a receiving chain and
+ * -5 when the DH or KDF fails. The state is undefined after an error. */
+int ratchet_decrypt_step(ratchet_state *state,
+                         uint8_t message_key[RATCHET_KEY_LEN],
+                         const uint8_t header[RATCHET_HEADER_LEN],
+                         skipped_keys *table, uint8_t *skipped,
+                         const unsigned int SKIPPED_CAP,
+                         unsigned int *skipped_len);
+
+#endif
@@ -1,28 +1,35 @@
-import { x25519Keypair, x25519Dh } from "./x25519";
-import { hkdfExtract, hkdfExpand } from "./hkdf";
+import { ratchet_STATEBYTES } from "./interfaces";
+import { SkippedKeyTable, toSkippedKeyTable } from "./skippedKeys";
+import { zeroFree } from "../utils/zeroFree";
 import {
-  KDF_RK_LABEL,
-  KDF_CK_LABEL,
-  KDF_MK_LABEL,
   MAX_SKIP,
-  MAX_SKIP_SESSION,
   RATCHET_ROOT_SUITE,
   RATCHET_DHPUB_LEN,
 } from "../utils/constants";
 
 import type { LibCrypto } from "./libcrypto";
+import type { SkippedKeyStore } from "./skippedKeys";
 import type { RatchetRootSuite } from "../utils/constants";
 
-// HKDF `info` strings for the two ratchet chains (SSOT labels, constants.ts).
-const RK_INFO = new TextEncoder().encode(KDF_RK_LABEL);
-const CK_INFO = new TextEncoder().encode(KDF_CK_LABEL);
-const MK_INFO = new TextEncoder().encode(KDF_MK_LABEL);
+// Match ratchet.h: the serialized state is Ns || Nr || PN (u64 BE) || flags ||
+// six 32-byte keys and a header is DH pub || N || PN.
+const RATCHET_KEY_LEN = 32;
+const RATCHET_SERIALIZED_LEN = 217;
+const RATCHET_SERIALIZED_KEYS = 25;
+const RATCHET_HEADER_LEN = 48;
+const RATCHET_FLAG_SENDING_CHAIN = 1;
+const RATCHET_FLAG_RECEIVING_CHAIN = 2;
+const RATCHET_FLAG_REMOTE_DH = 4;
 
 /**
  * Live Double Ratchet state for one `(roomId, peerPublicKey)` edge. Every key
- * field is a plain-JS `Uint8Array` secret (the WASM heap holds no ratchet state
- * — see design §9): `rootKey`, both chain keys, `dhSelfSec`, and each value in
- * `skipped`. Stage 3 wraps these at rest; here they are live plaintext.
+ * field is a plain-JS `Uint8Array` secret: `rootKey`, both chain keys,
+ * `dhSelfSec`, and each value in `skipped`. Stage 3 wraps these at rest; here
+ * they are live plaintext. The C engine (ratchet.c) keeps its own copy in
+ * `engine` from the state's first step on, and each step copies its result
+ * back into these fields. `skipped` is a `SkippedKeyTable` on the WASM heap once the state has been
+ * through `initRatchet` or `ratchetDecrypt`; a state restored without a module
+ * starts with a `Map`, which the first decrypt moves into a table.
  *
  * The ratchet advances **per logical message**, never per chunk. `Ns`/`Nr` are
  * the send/receive message counters in the current chains; `PN` is the length
@@ -41,7 +48,9 @@ export interface RatchetState {
   Ns: number;
   Nr: number;
   PN: number;
-  skipped: Map<string, Uint8Array>;
+  skipped: SkippedKeyStore;
+  /** The engine's resident copy; absent until the first step on a module. */
+  engine?: RatchetEngine;
 }
 
 /**
@@ -98,38 +107,236 @@ const bytesEqual = (a: Uint8Array, b: Uint8Array): boolean => {
   return diff === 0;
 };
 
-// KDF_RK: (rootKey, dhOut) -> (newRootKey, chainKey). HKDF-Extract salted with
-// the current root over the DH output, then Expand to 64 bytes split 32/32.
-// prk/okm are transient secrets and are wiped before this returns.
-const kdfRk = (
-  rootKey: Uint8Array,
-  dhOut: Uint8Array,
+const writeU64 = (view: DataView, offset: number, value: number): void => {
+  view.setUint32(offset, Math.floor(value / 0x100000000));
+  view.setUint32(offset + 4, value >>> 0);
+};
+
+const readU64 = (view: DataView, offset: number): number =>
+  view.getUint32(offset) * 0x100000000 + view.getUint32(offset + 4);
+
+/**
+ * The engine's heap frame: the `ratchet_state`, then the step's `skipped_len`,
+ * message-key and header slots and the serialized state. Skipped keys go to
+ * the state's table.
+ */
+interface RatchetFrame {
+  state: number;
+  skippedLen: number;
+  messageKey: number;
+  header: number;
+  serialized: number;
+}
+
+const RATCHET_SLOTS_LEN =
+  4 + RATCHET_KEY_LEN + RATCHET_HEADER_LEN + RATCHET_SERIALIZED_LEN;
+const RATCHET_FRAME_LEN = ratchet_STATEBYTES + RATCHET_SLOTS_LEN;
+
+/**
+ * A `ratchet_state` resident in `module`'s heap for the lifetime of one
+ * `RatchetState`, so a step neither allocates nor imports the state again
+ * (import recomputes both chains' HMAC pads). Until `synced` is set the JS
+ * fields are the truth and the next step imports them; a failed step clears
+ * it, since ratchet.c leaves the state undefined then. The step slots are
+ * wiped after every step and the whole frame by `free`.
+ */
+export class RatchetEngine {
+  readonly module: LibCrypto;
+  readonly frame: RatchetFrame;
+  synced = false;
+  #freed = false;
+
+  constructor(module: LibCrypto) {
+    const state = module._malloc(RATCHET_FRAME_LEN);
+    new Uint8Array(module.wasmMemory.buffer, state, RATCHET_FRAME_LEN).fill(0);
+    const skippedLen = state + ratchet_STATEBYTES;
+    const messageKey = skippedLen + 4;
+    const header = messageKey + RATCHET_KEY_LEN;
+    const serialized = header + RATCHET_HEADER_LEN;
+    this.module = module;
+    this.frame = { state, skippedLen, messageKey, header, serialized };
+  }
+
+  /** An independent engine holding the same state. */
+  clone(): RatchetEngine {
+    const copy = new RatchetEngine(this.module);
+    new Uint8Array(this.module.wasmMemory.buffer).copyWithin(
+      copy.frame.state,
+      this.frame.state,
+      this.frame.state + ratchet_STATEBYTES,
+    );
+    copy.synced = this.synced;
+    return copy;
+  }
+
+  clearSlots(): void {
+    new Uint8Array(
+      this.module.wasmMemory.buffer,
+      this.frame.skippedLen,
+      RATCHET_SLOTS_LEN,
+    ).fill(0);
+  }
+
+  free(): void {
+    if (this.#freed) return;
+    this.#freed = true;
+    zeroFree(
+      this.module,
+      new Uint8Array(
+        this.module.wasmMemory.buffer,
+        this.frame.state,
+        RATCHET_FRAME_LEN,
+      ),
+    );
+  }
+}
+
+// Hands the live state to the engine through its serialized form; the C side
+// precomputes each open chain's HMAC pads on import.
+const loadRatchet = (
+  state: RatchetState,
+  frame: RatchetFrame,
+  module: LibCrypto,
+): void => {
+  const serialized = new Uint8Array(
+    module.wasmMemory.buffer,
+    frame.serialized,
+    RATCHET_SERIALIZED_LEN,
+  );
+  const view = new DataView(
+    module.wasmMemory.buffer,
+    frame.serialized,
+    RATCHET_SERIALIZED_LEN,
+  );
+  const key = (i: number): number =>
+    RATCHET_SERIALIZED_KEYS + i * RATCHET_KEY_LEN;
+
+  serialized.fill(0);
+  writeU64(view, 0, state.Ns);
+  writeU64(view, 8, state.Nr);
+  writeU64(view, 16, state.PN);
+  serialized[24] =
+    (state.sendingChainKey ? RATCHET_FLAG_SENDING_CHAIN : 0) |
+    (state.receivingChainKey ? RATCHET_FLAG_RECEIVING_CHAIN : 0) |
+    (state.dhRemotePub ? RATCHET_FLAG_REMOTE_DH : 0);
+  serialized.set(state.rootKey, key(0));
+  if (state.sendingChainKey) serialized.set(state.sendingChainKey, key(1));
+  if (state.receivingChainKey) serialized.set(state.receivingChainKey, key(2));
+  serialized.set(state.dhSelfPub, key(3));
+  serialized.set(state.dhSelfSec, key(4));
+  if (state.dhRemotePub) serialized.set(state.dhRemotePub, key(5));
+
+  if (module._ratchet_state_import(frame.state, frame.serialized) !== 0)
+    throw new Error("ratchet: invalid state");
+};
+
+// Runs one step on the state's engine, importing the JS fields first when the
+// engine is new or out of sync. A state moved to another module gets a new
+// engine there.
+const withRatchetEngine = <T>(
+  state: RatchetState,
   module: LibCrypto,
-): { rootKey: Uint8Array; chainKey: Uint8Array } => {
-  const prk = hkdfExtract(rootKey, dhOut, module);
-  const okm = hkdfExpand(prk, RK_INFO, 64, module);
-  prk.fill(0);
-  const newRoot = okm.slice(0, 32);
-  const chainKey = okm.slice(32, 64);
-  okm.fill(0);
-  return { rootKey: newRoot, chainKey };
+  run: (frame: RatchetFrame) => T,
+): T => {
+  if (state.engine?.module !== module) {
+    state.engine?.free();
+    state.engine = new RatchetEngine(module);
+  }
+  const engine = state.engine;
+
+  try {
+    if (!engine.synced) {
+      loadRatchet(state, engine.frame, module);
+      engine.synced = true;
+    }
+    return run(engine.frame);
+  } catch (e) {
+    engine.synced = false;
+    throw e;
+  } finally {
+    engine.clearSlots();
+  }
 };
 
-// KDF_CK: chainKey -> (nextChainKey, messageKey) via two domain-separated
-// HMAC-SHA512s (HKDF-Extract keyed by the chain key over the CK/MK labels),
-// each truncated to 32 bytes. The two full HMAC outputs are wiped here; the
-// caller owns the returned 32-byte halves.
-const kdfCk = (
-  chainKey: Uint8Array,
+// Owned copies of the engine's state after a step.
+const readRatchet = (
+  frame: RatchetFrame,
   module: LibCrypto,
-): { chainKey: Uint8Array; messageKey: Uint8Array } => {
-  const mkFull = hkdfExtract(chainKey, MK_INFO, module);
-  const ckFull = hkdfExtract(chainKey, CK_INFO, module);
-  const messageKey = mkFull.slice(0, 32);
-  const nextChainKey = ckFull.slice(0, 32);
-  mkFull.fill(0);
-  ckFull.fill(0);
-  return { chainKey: nextChainKey, messageKey };
+  rootSuite: RatchetRootSuite,
+): RatchetState => {
+  if (module._ratchet_state_export(frame.serialized, frame.state) !== 0)
+    throw new Error("ratchet: invalid state");
+
+  const serialized = new Uint8Array(
+    module.wasmMemory.buffer,
+    frame.serialized,
+    RATCHET_SERIALIZED_LEN,
+  );
+  const view = new DataView(
+    module.wasmMemory.buffer,
+    frame.serialized,
+    RATCHET_SERIALIZED_LEN,
+  );
+  const flags = serialized[24];
+  const key = (i: number): Uint8Array =>
+    serialized.slice(
+      RATCHET_SERIALIZED_KEYS + i * RATCHET_KEY_LEN,
+      RATCHET_SERIALIZED_KEYS + (i + 1) * RATCHET_KEY_LEN,
+    );
+
+  return {
+    rootSuite,
+    rootKey: key(0),
+    sendingChainKey: flags & RATCHET_FLAG_SENDING_CHAIN ? key(1) : null,
+    receivingChainKey: flags & RATCHET_FLAG_RECEIVING_CHAIN ? key(2) : null,
+    dhSelfPub: key(3),
+    dhSelfSec: key(4),
+    dhRemotePub: flags & RATCHET_FLAG_REMOTE_DH ? key(5) : null,
+    Ns: readU64(view, 0),
+    Nr: readU64(view, 8),
+    PN: readU64(view, 16),
+    skipped: new SkippedKeyTable(module),
+  };
+};
+
+// A field the step left unchanged keeps its buffer (the fresh copy is wiped if
+// secret); a superseded secret is wiped before it is replaced.
+const succeed = <T extends Uint8Array | null>(
+  live: Uint8Array | null,
+  next: T,
+  secret: boolean,
+): Uint8Array | T => {
+  if (live && next && bytesEqual(live, next)) {
+    if (secret) next.fill(0);
+    return live;
+  }
+  if (secret) live?.fill(0);
+  return next;
+};
+
+const storeRatchet = (
+  state: RatchetState,
+  frame: RatchetFrame,
+  module: LibCrypto,
+): void => {
+  const next = readRatchet(frame, module, state.rootSuite);
+  state.rootKey = succeed(state.rootKey, next.rootKey, true);
+  state.sendingChainKey = succeed(
+    state.sendingChainKey,
+    next.sendingChainKey,
+    true,
+  );
+  state.receivingChainKey = succeed(
+    state.receivingChainKey,
+    next.receivingChainKey,
+    true,
+  );
+  state.dhSelfPub = succeed(state.dhSelfPub, next.dhSelfPub, false);
+  state.dhSelfSec = succeed(state.dhSelfSec, next.dhSelfSec, true);
+  state.dhRemotePub = succeed(state.dhRemotePub, next.dhRemotePub, false);
+  state.Ns = next.Ns;
+  state.Nr = next.Nr;
+  state.PN = next.PN;
 };
 
 /**
@@ -155,35 +362,43 @@ export const initRatchet = (
   module: LibCrypto,
   rootSuite: RatchetRootSuite = RATCHET_ROOT_SUITE,
 ): RatchetState => {
-  const kp = x25519Keypair(module);
-  const state: RatchetState = {
-    rootSuite,
-    rootKey: Uint8Array.from(rootSeed),
-    sendingChainKey: null,
-    receivingChainKey: null,
-    dhSelfPub: kp.publicKey,
-    dhSelfSec: kp.secretKey,
-    dhRemotePub: null,
-    Ns: 0,
-    Nr: 0,
-    PN: 0,
-    skipped: new Map(),
-  };
-
-  if (amInitiator) {
-    if (!remoteDhPub)
-      throw new Error("ratchet: initiator requires remoteDhPub");
-    state.dhRemotePub = Uint8Array.from(remoteDhPub);
-    const dhOut = x25519Dh(state.dhSelfSec, state.dhRemotePub, module);
-    const rk = kdfRk(state.rootKey, dhOut, module);
-    dhOut.fill(0);
-    state.rootKey.fill(0); // wipe the seed copy now superseded by the first root
-    state.rootKey = rk.rootKey;
-    state.sendingChainKey = rk.chainKey;
+  if (amInitiator && !remoteDhPub)
+    throw new Error("ratchet: initiator requires remoteDhPub");
+
+  const engine = new RatchetEngine(module);
+  try {
+    const frame = engine.frame;
+    // The message-key and header slots carry the seed and the remote pub in.
+    new Uint8Array(
+      module.wasmMemory.buffer,
+      frame.messageKey,
+      RATCHET_KEY_LEN,
+    ).set(rootSeed);
+    if (amInitiator)
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        frame.header,
+        RATCHET_DHPUB_LEN,
+      ).set(remoteDhPub!);
+
+    if (
+      module._ratchet_init(
+        frame.state,
+        frame.messageKey,
+        amInitiator ? frame.header : 0,
+      ) !== 0
+    )
+      throw new Error("ratchet: init failed");
+
+    const state = readRatchet(frame, module, rootSuite);
+    engine.clearSlots();
+    engine.synced = true;
+    state.engine = engine;
+    return state;
+  } catch (e) {
+    engine.free();
+    throw e;
   }
-  // Responder: chains stay null until primeResponderRatchet or first inbound.
-
-  return state;
 };
 
 /**
@@ -196,103 +411,43 @@ export const ratchetEncrypt = (
   module: LibCrypto,
 ): { messageKey: Uint8Array; header: RatchetHeader } => {
   if (!state.sendingChainKey) throw new Error("ratchet: no sending chain");
-  const { chainKey, messageKey } = kdfCk(state.sendingChainKey, module);
-  const header: RatchetHeader = {
-    dhPub: Uint8Array.from(state.dhSelfPub),
-    N: state.Ns,
-    PN: state.PN,
-  };
-  state.sendingChainKey.fill(0);
-  state.sendingChainKey = chainKey;
-  state.Ns += 1;
-  return { messageKey, header };
-};
-
-// Pop a previously-stored key for an out-of-order/replayed message, keyed by
-// (header.dhPub, header.N). Consumed keys are removed so they can't be reused.
-const trySkipped = (
-  state: RatchetState,
-  header: RatchetHeader,
-): Uint8Array | null => {
-  const key = `${toHex(header.dhPub)}:${header.N}`;
-  const mk = state.skipped.get(key);
-  if (mk) {
-    state.skipped.delete(key);
-    return mk;
-  }
-  return null;
-};
 
-// Derive-and-stash the message keys for indices [Nr, until) of the current
-// receiving chain so later out-of-order deliveries can be served. Anti-DoS:
-// skipping more than MAX_SKIP keys in one call throws rather than looping.
-const skipMessageKeys = (
-  state: RatchetState,
-  until: number,
-  module: LibCrypto,
-): void => {
-  if (state.Nr + MAX_SKIP < until)
-    throw new Error("ratchet: MAX_SKIP exceeded");
-  if (!state.receivingChainKey) return;
-  while (state.Nr < until) {
-    const { chainKey, messageKey } = kdfCk(state.receivingChainKey, module);
-    state.receivingChainKey.fill(0);
-    state.receivingChainKey = chainKey;
-    state.skipped.set(`${toHex(state.dhRemotePub!)}:${state.Nr}`, messageKey);
-    state.Nr += 1;
-  }
-
-  // Anti-DoS: MAX_SKIP above only bounds derivations within THIS call; bound
-  // the CUMULATIVE size of `state.skipped` across the whole session too, else
-  // a peer that repeatedly forces DH-steps (or gaps) can grow it — and the
-  // persisted IndexedDB row — without ceiling. Evict the OLDEST entries first
-  // (a `Map` preserves insertion order) rather than throwing, so availability
-  // for recent/legitimate reordering is preserved.
-  if (state.skipped.size > MAX_SKIP_SESSION) {
-    for (const k of state.skipped.keys()) {
-      if (state.skipped.size <= MAX_SKIP_SESSION) break;
-      state.skipped.get(k)?.fill(0);
-      state.skipped.delete(k);
-    }
-  }
-};
-
-// A DH-ratchet step: the peer moved to a new DH pub. Finish nothing here (the
-// caller skips the previous chain's tail first), then (1) derive the new
-// receiving chain from DH(oldSelfSec, newRemotePub), (2) rotate our own DH key,
-// (3) derive the new sending chain from DH(newSelfSec, newRemotePub). Retired
-// roots, chain keys and the retired DH secret are wiped.
-const dhRatchet = (
-  state: RatchetState,
-  header: RatchetHeader,
-  module: LibCrypto,
-): void => {
-  state.PN = state.Ns;
-  state.Ns = 0;
-  state.Nr = 0;
-  state.dhRemotePub = Uint8Array.from(header.dhPub);
-
-  let dhOut = x25519Dh(state.dhSelfSec, state.dhRemotePub, module);
-  let rk = kdfRk(state.rootKey, dhOut, module);
-  dhOut.fill(0);
-  state.rootKey.fill(0);
-  state.rootKey = rk.rootKey;
-  state.receivingChainKey?.fill(0);
-  state.receivingChainKey = rk.chainKey;
-
-  const oldSelfSec = state.dhSelfSec;
-  const kp = x25519Keypair(module);
-  state.dhSelfPub = kp.publicKey;
-  state.dhSelfSec = kp.secretKey;
-  oldSelfSec.fill(0);
-
-  dhOut = x25519Dh(state.dhSelfSec, state.dhRemotePub, module);
-  rk = kdfRk(state.rootKey, dhOut, module);
-  dhOut.fill(0);
-  state.rootKey.fill(0);
-  state.rootKey = rk.rootKey;
-  state.sendingChainKey?.fill(0);
-  state.sendingChainKey = rk.chainKey;
+  return withRatchetEngine(state, module, (frame) => {
+    if (
+      module._ratchet_encrypt_step(
+        frame.state,
+        frame.messageKey,
+        frame.header,
+      ) !== 0
+    )
+      throw new Error("ratchet: encrypt step failed");
+    storeRatchet(state, frame, module);
+
+    const header = new Uint8Array(
+      module.wasmMemory.buffer,
+      frame.header,
+      RATCHET_HEADER_LEN,
+    );
+    const view = new DataView(
+      module.wasmMemory.buffer,
+      frame.header,
+      RATCHET_HEADER_LEN,
+    );
+    return {
+      messageKey: Uint8Array.from(
+        new Uint8Array(
+          module.wasmMemory.buffer,
+          frame.messageKey,
+          RATCHET_KEY_LEN,
+        ),
+      ),
+      header: {
+        dhPub: header.slice(0, RATCHET_DHPUB_LEN),
+        N: readU64(view, RATCHET_DHPUB_LEN),
+        PN: readU64(view, RATCHET_DHPUB_LEN + 8),
+      },
+    };
+  });
 };
 
 /**
@@ -300,8 +455,8 @@ const dhRatchet = (
  * initiator's initial DH public key has been authenticated by key confirmation.
  *
  * This is the receive-side DH step that an unprimed responder would otherwise
- * perform on the initiator's first message, deliberately stopped before
- * `kdfCk`: it opens the receiving chain from
+ * perform on the initiator's first message, deliberately stopped before the
+ * chain step: it opens the receiving chain from
  * `DH(initialResponder, initialInitiator)`, rotates the responder DH keypair,
  * and opens the sending chain from `DH(rotatedResponder, initialInitiator)`.
  * Consequently both peers can send message 0 immediately after the handshake,
@@ -325,15 +480,16 @@ export const primeResponderRatchet = (
   )
     throw new Error("ratchet: responder bootstrap requires pristine state");
 
-  dhRatchet(
-    state,
-    {
-      dhPub: initiatorDhPub,
-      N: 0,
-      PN: 0,
-    },
-    module,
-  );
+  withRatchetEngine(state, module, (frame) => {
+    new Uint8Array(
+      module.wasmMemory.buffer,
+      frame.header,
+      RATCHET_DHPUB_LEN,
+    ).set(initiatorDhPub);
+    if (module._ratchet_prime_responder(frame.state, frame.header) !== 0)
+      throw new Error("ratchet: responder bootstrap failed");
+    storeRatchet(state, frame, module);
+  });
 };
 
 /**
@@ -361,8 +517,18 @@ export const primeResponderRatchet = (
  * Against that (untrusted) header, handles three cases: (a) a stored skipped
  * key — out-of-order delivery within an already-seen chain, (b) a new peer DH
  * pub — skip the old chain's tail, then DH-step, (c) a forward message in the
- * current chain — skip any gap, then derive. The consumed chain key is wiped
- * once its successor is derived.
+ * current chain — skip any gap, then derive. All three run as one
+ * `ratchet_decrypt_step` against `state.skipped`, which the engine reads and
+ * fills in place. A step that throws leaves the chain fields untouched, but
+ * keys it derived before failing may already be in the table — one more reason
+ * to step a clone.
+ *
+ * Anti-DoS: the engine's MAX_SKIP only bounds derivations within ONE step; the
+ * table's limit (MAX_SKIP_SESSION) bounds the CUMULATIVE number of skipped
+ * keys across the whole session, else a peer that repeatedly forces DH-steps
+ * (or gaps) could grow it — and the persisted IndexedDB row — without
+ * ceiling. The OLDEST keys are evicted (and wiped) first rather than throwing,
+ * so availability for recent/legitimate reordering is preserved.
  */
 export const ratchetDecrypt = (
   state: RatchetState,
@@ -370,32 +536,75 @@ export const ratchetDecrypt = (
   module: LibCrypto,
 ): Uint8Array => {
   if (
-    !Number.isInteger(header.N) ||
+    header.dhPub.length !== RATCHET_DHPUB_LEN ||
+    !Number.isSafeInteger(header.N) ||
     header.N < 0 ||
-    !Number.isInteger(header.PN) ||
+    !Number.isSafeInteger(header.PN) ||
     header.PN < 0
   )
     throw new Error("invalid ratchet header");
 
-  const skipped = trySkipped(state, header);
-  if (skipped) return skipped;
+  // Keys restored into a plain Map, or a table on another module, move into
+  // a table on this one first.
+  const table =
+    state.skipped instanceof SkippedKeyTable && state.skipped.module === module
+      ? state.skipped
+      : toSkippedKeyTable(state.skipped, module);
+  state.skipped = table;
 
+  // Upper bound on the keys the step can store; anything past MAX_SKIP is
+  // rejected by the engine before it derives a key.
   const isNewDh =
     !state.dhRemotePub || !bytesEqual(header.dhPub, state.dhRemotePub);
-  if (isNewDh) {
-    skipMessageKeys(state, header.PN, module); // finish the previous chain
-    dhRatchet(state, header, module);
-  }
-
-  if (header.N < state.Nr)
-    throw new Error("ratchet: message key already consumed");
-
-  skipMessageKeys(state, header.N, module);
-  const { chainKey, messageKey } = kdfCk(state.receivingChainKey!, module);
-  state.receivingChainKey!.fill(0);
-  state.receivingChainKey = chainKey;
-  state.Nr += 1;
-  return messageKey;
+  const skippedCap = isNewDh
+    ? Math.min(header.PN, MAX_SKIP) + Math.min(header.N, MAX_SKIP)
+    : Math.min(Math.max(header.N - state.Nr, 0), MAX_SKIP);
+  // With nothing stored and nothing to skip the table may still be
+  // unallocated; the engine then runs without one (and a zero-entry buffer).
+  table.reserve(skippedCap);
+
+  return withRatchetEngine(state, module, (frame) => {
+    const wire = new Uint8Array(
+      module.wasmMemory.buffer,
+      frame.header,
+      RATCHET_HEADER_LEN,
+    );
+    const view = new DataView(
+      module.wasmMemory.buffer,
+      frame.header,
+      RATCHET_HEADER_LEN,
+    );
+    wire.set(header.dhPub);
+    writeU64(view, RATCHET_DHPUB_LEN, header.N);
+    writeU64(view, RATCHET_DHPUB_LEN + 8, header.PN);
+
+    const result = module._ratchet_decrypt_step(
+      frame.state,
+      frame.messageKey,
+      frame.header,
+      table.ptr,
+      0,
+      0,
+      frame.skippedLen,
+    );
+    if (result === -2) throw new Error("ratchet: MAX_SKIP exceeded");
+    if (result === -3) throw new Error("ratchet: message key already consumed");
+    if (result === -4) throw new Error("ratchet: no receiving chain");
+    if (result !== 0 && result !== 1)
+      throw new Error("ratchet: decrypt step failed");
+
+    // 1: served from the table, the chains did not move.
+    if (result === 0) storeRatchet(state, frame, module);
+    if (table.size === 0) table.free();
+
+    return Uint8Array.from(
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        frame.messageKey,
+        RATCHET_KEY_LEN,
+      ),
+    );
+  });
 };
 
 const toBuf = (u8: Uint8Array): ArrayBuffer => u8.slice().buffer;
@@ -422,17 +631,29 @@ export const serializeRatchet = (
   PN: state.PN,
   skippedMessageKeys: Array.from(state.skipped.entries()).map(([k, mk]) => {
     const idx = k.lastIndexOf(":");
+    const messageKey = mk.slice().buffer;
+    // A table hands out copies of its keys; this one is done with.
+    if (state.skipped instanceof SkippedKeyTable) mk.fill(0);
     return {
       dhPub: fromHex(k.slice(0, idx)).slice().buffer,
       n: Number(k.slice(idx + 1)),
-      messageKey: mk.slice().buffer,
+      messageKey,
     };
   }),
 });
 
-/** Rebuild a live `RatchetState` from a persisted snapshot. */
-export const deserializeRatchet = (s: RatchetSessionSecrets): RatchetState => {
-  const skipped = new Map<string, Uint8Array>();
+/**
+ * Rebuild a live `RatchetState` from a persisted snapshot. With a module the
+ * skipped keys go straight into a `SkippedKeyTable`, otherwise into a `Map`
+ * until the first `ratchetDecrypt`.
+ */
+export const deserializeRatchet = (
+  s: RatchetSessionSecrets,
+  module?: LibCrypto,
+): RatchetState => {
+  const skipped: SkippedKeyStore = module
+    ? new SkippedKeyTable(module)
+    : new Map<string, Uint8Array>();
   for (const e of s.skippedMessageKeys) {
     const dh = new Uint8Array(e.dhPub);
     skipped.set(`${toHex(dh)}:${e.n}`, new Uint8Array(e.messageKey));
@@ -456,17 +677,34 @@ export const deserializeRatchet = (s: RatchetSessionSecrets): RatchetState => {
   };
 };
 
-/** Deep-clone a live ratchet state into independently owned key buffers. */
-export const cloneRatchet = (state: RatchetState): RatchetState =>
-  deserializeRatchet(serializeRatchet(state));
+/**
+ * Deep-clone a live ratchet state into independently owned key buffers. A
+ * skipped-key table and the engine are copied on their own module, so the
+ * clone's first step does not import the state again.
+ */
+export const cloneRatchet = (state: RatchetState): RatchetState => {
+  const table = state.skipped instanceof SkippedKeyTable ? state.skipped : null;
+  const clone = deserializeRatchet(
+    serializeRatchet(table ? { ...state, skipped: new Map() } : state),
+  );
+  if (table) clone.skipped = table.clone();
+  if (state.engine) clone.engine = state.engine.clone();
+  return clone;
+};
 
-/** Wipe every secret-bearing buffer owned by a ratchet state. */
+/**
+ * Wipe every secret-bearing buffer owned by a ratchet state, the engine's copy
+ * included.
+ */
 export const wipeRatchet = (state: RatchetState): void => {
   state.rootKey.fill(0);
   state.sendingChainKey?.fill(0);
   state.receivingChainKey?.fill(0);
   state.dhSelfSec.fill(0);
-  for (const messageKey of state.skipped.values()) messageKey.fill(0);
+  if (state.skipped instanceof SkippedKeyTable) state.skipped.free();
+  else for (const messageKey of state.skipped.values()) messageKey.fill(0);
+  state.engine?.free();
+  state.engine = undefined;
 };
 
 /**
@@ -488,4 +726,6 @@ export const adoptRatchet = (live: RatchetState, next: RatchetState): void => {
   live.Nr = next.Nr;
   live.PN = next.PN;
   live.skipped = next.skipped;
+  live.engine = next.engine;
+  next.engine = undefined;
 };
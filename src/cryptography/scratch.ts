@@ -0,0 +1,103 @@
+import type { LibCrypto } from "./libcrypto";
+
+/**
+ * Arena capacity of the shared module. Keys, signatures, nonces and the proofs
+ * and roots of a few thousand leaves fit; anything larger spills to the heap
+ * for the length of its frame.
+ */
+export const SCRATCH_ARENA_CAPACITY = 256 * 1024;
+
+const arenas = new WeakMap<LibCrypto, number>();
+
+/**
+ * Give a long-lived module a scratch arena (arena.c). The arena is allocated
+ * once and kept for the module's lifetime. Modules without one still run
+ * frames; their scratch comes from `_malloc` and is wiped and freed on pop.
+ */
+export const attachScratchArena = (
+  module: LibCrypto,
+  capacity = SCRATCH_ARENA_CAPACITY,
+): void => {
+  if (arenas.has(module)) return;
+
+  const bytes = module._arena_bytes(capacity);
+  if (bytes === 0) throw new Error("Invalid scratch arena capacity.");
+
+  const ptr = module._malloc(bytes);
+  if (module._arena_init(ptr, capacity) !== 0) {
+    module._free(ptr);
+
+    throw new Error("Could not initialize scratch arena.");
+  }
+
+  arenas.set(module, ptr);
+};
+
+export interface ScratchFrame {
+  /** Pointer to `len` zeroed bytes that live until the frame pops. */
+  alloc(len: number): number;
+  /**
+   * Copies `bytes` into `len` (default `bytes.length`) bytes of fresh scratch
+   * and returns its pointer; a shorter input leaves the tail zero.
+   */
+  put(bytes: Uint8Array, len?: number): number;
+  /**
+   * A view over the current buffer. A heap spill may grow memory and detach
+   * older views, so take views after the allocations they sit between.
+   */
+  view(ptr: number, len: number): Uint8Array;
+}
+
+/**
+ * Run `operate` in a scratch frame: push, operate, pop-and-wipe. Everything
+ * the frame allocated is zeroed when it pops, whether `operate` returned or
+ * threw, so secrets staged in scratch need no manual wipe. Frames nest; they
+ * must be synchronous, because a frame still open across an `await` could be
+ * popped under another caller's frame on the same module.
+ */
+export const withScratch = <T>(
+  module: LibCrypto,
+  operate: (frame: ScratchFrame) => T,
+): T => {
+  const arena = arenas.get(module) ?? 0;
+  const mark = arena === 0 ? 0 : module._arena_push(arena);
+  const spilled: { ptr: number; len: number }[] = [];
+
+  const frame: ScratchFrame = {
+    alloc: (len: number): number => {
+      const size = Math.max(len, 1);
+      const ptr = arena === 0 ? 0 : module._arena_alloc(arena, size);
+      if (ptr !== 0) return ptr;
+
+      const heapPtr = module._malloc(size);
+      spilled.push({ ptr: heapPtr, len: size });
+      new Uint8Array(module.wasmMemory.buffer, heapPtr, size).fill(0);
+
+      return heapPtr;
+    },
+
+    put: (bytes: Uint8Array, len = bytes.length): number => {
+      const ptr = frame.alloc(len);
+      frame.view(ptr, bytes.length).set(bytes);
+
+      return ptr;
+    },
+
+    view: (ptr: number, len: number): Uint8Array =>
+      new Uint8Array(module.wasmMemory.buffer, ptr, len),
+  };
+
+  try {
+    return operate(frame);
+  } finally {
+    for (let i = spilled.length - 1; i >= 0; i--) {
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        spilled[i].ptr,
+        spilled[i].len,
+      ).fill(0);
+      module._free(spilled[i].ptr);
+    }
+    if (arena !== 0) module._arena_pop(arena, mark);
+  }
+};
@@ -0,0 +1,265 @@
+#include "sha512x4.h"
+
+/* Lane-interleaved SHA-512 (FIPS 180-4), the SHA-2 counterpart of the vendored
+ * fips202x4 Keccak. Word t of the state holds that word for all four messages,
+ * so each round is the scalar round applied lane-wise. The vector type is a
+ * GCC/Clang vector extension: emcc -msimd128 lowers it to v128 pairs and host
+ * compilers to SSE2/NEON, with no per-target intrinsics to keep in sync. */
+typedef uint64_t sha512x4_word __attribute__((vector_size(32)));
+
+typedef struct
+{
+  sha512x4_word h[8];
+  uint8_t buf[SHA512X4_LANES][128];
+  size_t buflen;
+  uint64_t bytes;
+} sha512x4_state;
+
+static const uint64_t sha512x4_K[80] = {
+  0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+  0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+  0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+  0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+  0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+  0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+  0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+  0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+  0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+  0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+  0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+  0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+  0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+  0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+  0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+  0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+  0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+  0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+  0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+  0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+  0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+  0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+  0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+  0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+  0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+  0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+  0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static const uint64_t sha512x4_IV[8] = {
+  0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+  0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+  0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static inline uint64_t
+sha512x4_load64_be(const uint8_t src[8])
+{
+  return ((uint64_t)src[0] << 56) | ((uint64_t)src[1] << 48)
+         | ((uint64_t)src[2] << 40) | ((uint64_t)src[3] << 32)
+         | ((uint64_t)src[4] << 24) | ((uint64_t)src[5] << 16)
+         | ((uint64_t)src[6] << 8) | (uint64_t)src[7];
+}
+
+static inline void
+sha512x4_store64_be(uint8_t dst[8], uint64_t w)
+{
+  size_t i;
+
+  for (i = 0; i < 8; i++) dst[i] = (uint8_t)(w >> (56 - 8 * i));
+}
+
+#define ROTR64X4(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+#define SIG0X4(x) (ROTR64X4(x, 28) ^ ROTR64X4(x, 34) ^ ROTR64X4(x, 39))
+#define SIG1X4(x) (ROTR64X4(x, 14) ^ ROTR64X4(x, 18) ^ ROTR64X4(x, 41))
+#define sig0X4(x) (ROTR64X4(x, 1) ^ ROTR64X4(x, 8) ^ ((x) >> 7))
+#define sig1X4(x) (ROTR64X4(x, 19) ^ ROTR64X4(x, 61) ^ ((x) >> 6))
+
+static void
+sha512x4_compress(sha512x4_word h[8],
+                  const uint8_t *const block[SHA512X4_LANES])
+{
+  sha512x4_word w[16];
+  sha512x4_word a = h[0], b = h[1], c = h[2], d = h[3];
+  sha512x4_word e = h[4], f = h[5], g = h[6], hh = h[7];
+  sha512x4_word t1, t2;
+  size_t i;
+
+  for (i = 0; i < 16; i++)
+  {
+    w[i] = (sha512x4_word){ sha512x4_load64_be(&block[0][8 * i]),
+                            sha512x4_load64_be(&block[1][8 * i]),
+                            sha512x4_load64_be(&block[2][8 * i]),
+                            sha512x4_load64_be(&block[3][8 * i]) };
+  }
+
+  for (i = 0; i < 80; i++)
+  {
+    if (i >= 16)
+    {
+      w[i & 15] += sig1X4(w[(i - 2) & 15]) + w[(i - 7) & 15]
+                   + sig0X4(w[(i - 15) & 15]);
+    }
+
+    t1 = hh + SIG1X4(e) + ((e & f) ^ (~e & g)) + sha512x4_K[i] + w[i & 15];
+    t2 = SIG0X4(a) + ((a & b) ^ (a & c) ^ (b & c));
+    hh = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  h[0] += a;
+  h[1] += b;
+  h[2] += c;
+  h[3] += d;
+  h[4] += e;
+  h[5] += f;
+  h[6] += g;
+  h[7] += hh;
+
+  sodium_memzero(w, sizeof w);
+}
+
+static void
+sha512x4_init(sha512x4_state *state)
+{
+  size_t i;
+
+  for (i = 0; i < 8; i++)
+    state->h[i] = (sha512x4_word){ sha512x4_IV[i], sha512x4_IV[i],
+                                   sha512x4_IV[i], sha512x4_IV[i] };
+  state->buflen = 0;
+  state->bytes = 0;
+}
+
+static void
+sha512x4_update(sha512x4_state *state, const uint8_t *const in[SHA512X4_LANES],
+                const size_t len)
+{
+  size_t l, take, off = 0;
+
+  state->bytes += len;
+
+  if (state->buflen > 0)
+  {
+    take = 128 - state->buflen < len ? 128 - state->buflen : len;
+    for (l = 0; l < SHA512X4_LANES; l++)
+      memcpy(&state->buf[l][state->buflen], in[l], take);
+    state->buflen += take;
+    off = take;
+
+    if (state->buflen < 128) return;
+
+    const uint8_t *const block[SHA512X4_LANES]
+        = { state->buf[0], state->buf[1], state->buf[2], state->buf[3] };
+    sha512x4_compress(state->h, block);
+    state->buflen = 0;
+  }
+
+  for (; len - off >= 128; off += 128)
+  {
+    const uint8_t *const block[SHA512X4_LANES]
+        = { in[0] + off, in[1] + off, in[2] + off, in[3] + off };
+    sha512x4_compress(state->h, block);
+  }
+
+  if (off < len)
+  {
+    for (l = 0; l < SHA512X4_LANES; l++)
+      memcpy(state->buf[l], in[l] + off, len - off);
+    state->buflen = len - off;
+  }
+}
+
+static void
+sha512x4_final(sha512x4_state *state, uint8_t *const out[SHA512X4_LANES])
+{
+  size_t i, l;
+  const uint64_t bits = state->bytes << 3;
+  const uint8_t *const block[SHA512X4_LANES]
+      = { state->buf[0], state->buf[1], state->buf[2], state->buf[3] };
+
+  for (l = 0; l < SHA512X4_LANES; l++)
+  {
+    state->buf[l][state->buflen] = 0x80;
+    memset(&state->buf[l][state->buflen + 1], 0, 127 - state->buflen);
+  }
+
+  // 128-bit big-endian bit length; the high 64 bits are always zero here.
+  if (state->buflen >= 112)
+  {
+    sha512x4_compress(state->h, block);
+    for (l = 0; l < SHA512X4_LANES; l++) memset(state->buf[l], 0, 128);
+  }
+  for (l = 0; l < SHA512X4_LANES; l++)
+    sha512x4_store64_be(&state->buf[l][120], bits);
+  sha512x4_compress(state->h, block);
+
+  for (l = 0; l < SHA512X4_LANES; l++)
+  {
+    for (i = 0; i < 8; i++) sha512x4_store64_be(&out[l][8 * i], state->h[i][l]);
+  }
+
+  sodium_memzero(state, sizeof *state);
+}
+
+int
+sha512x4_prefixed(uint8_t *const out[SHA512X4_LANES], const uint8_t prefix,
+                  const uint8_t *const in[SHA512X4_LANES], const size_t len)
+{
+  if (!out || !in) return -1;
+
+  sha512x4_state state;
+  const uint8_t *const prefixes[SHA512X4_LANES]
+      = { &prefix, &prefix, &prefix, &prefix };
+
+  sha512x4_init(&state);
+  sha512x4_update(&state, prefixes, 1);
+  sha512x4_update(&state, in, len);
+  sha512x4_final(&state, out);
+
+  return 0;
+}
+
+int
+sha512_prefixed_batch(const size_t COUNT, const size_t LEN,
+                      const uint8_t prefix, const uint8_t *in, uint8_t *out)
+{
+  if (COUNT > 0 && (!in || !out)) return -1;
+
+  size_t i = 0;
+
+#if SHA512X4_SIMD
+  for (; i + SHA512X4_LANES <= COUNT; i += SHA512X4_LANES)
+  {
+    uint8_t *const lanes_out[SHA512X4_LANES]
+        = { &out[i * crypto_hash_sha512_BYTES],
+            &out[(i + 1) * crypto_hash_sha512_BYTES],
+            &out[(i + 2) * crypto_hash_sha512_BYTES],
+            &out[(i + 3) * crypto_hash_sha512_BYTES] };
+    const uint8_t *const lanes_in[SHA512X4_LANES]
+        = { &in[i * LEN], &in[(i + 1) * LEN], &in[(i + 2) * LEN],
+            &in[(i + 3) * LEN] };
+
+    if (sha512x4_prefixed(lanes_out, prefix, lanes_in, LEN) != 0) return -2;
+  }
+#endif
+
+  for (; i < COUNT; i++)
+  {
+    crypto_hash_sha512_state state;
+
+    if (crypto_hash_sha512_init(&state) != 0
+        || crypto_hash_sha512_update(&state, &prefix, 1) != 0
+        || crypto_hash_sha512_update(&state, &in[i * LEN], LEN) != 0
+        || crypto_hash_sha512_final(&state, &out[i * crypto_hash_sha512_BYTES])
+               != 0)
+      return -2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef sha512x4_H
+#define sha512x4_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sodium.h>
+
+/* Four-lane SHA-512 (see sha512x4.c): four independent messages of the same
+ * length are hashed together, one 64-bit lane each, so the WASM SIMD128 build
+ * runs every round on two v128 registers per word. Digests are byte-identical
+ * to crypto_hash_sha512. */
+#define SHA512X4_LANES 4U
+
+#if defined(__wasm_simd128__) || defined(__SSE2__) || defined(__ARM_NEON)
+#define SHA512X4_SIMD 1
+#else
+#define SHA512X4_SIMD 0
+#endif
+
+/* SHA-512(prefix || in[l]) for the four lanes; every in[l] is `len` bytes.
+ * Inputs are fully consumed before any digest is written, so out[l] may alias
+ * the inputs. */
+int sha512x4_prefixed(uint8_t *const out[SHA512X4_LANES], const uint8_t prefix,
+                      const uint8_t *const in[SHA512X4_LANES],
+                      const size_t len);
+
+/* SHA-512(prefix || in[i * LEN .. (i + 1) * LEN)) into out[i * 64] for the
+ * COUNT contiguous, equally sized messages. Full groups of four take the
+ * four-lane kernel and the tail (or every message, when the target has no
+ * SIMD) takes libsodium. With LEN >= 64, out may start at in: each digest lands
+ * on bytes that are already hashed, which is how Merkle levels fold in place. */
+int sha512_prefixed_batch(const size_t COUNT, const size_t LEN,
+                          const uint8_t prefix, const uint8_t *in,
+                          uint8_t *out);
+
+#endif
@@ -0,0 +1,32 @@
+import memory from "./memory";
+import { attachScratchArena } from "./scratch";
+import { wasmLoaderThreaded } from "./wasmLoader";
+
+import type { LibCrypto } from "./libcrypto";
+
+let shared: Promise<LibCrypto> | undefined;
+
+/**
+ * The libcrypto instance of this realm (page or worker), shared by every
+ * helper that is called without a module. It is instantiated once and keeps a
+ * scratch arena (scratch.ts), so a one-shot sign, verify or Merkle proof costs
+ * one frame and does not instantiate the module or set up a fresh 2 MiB memory.
+ * After setWasmThreads it is the threaded artifact where the page allows, so
+ * its Merkle leaf and tree batches run on every thread. A failed load is not
+ * cached; the next call retries.
+ */
+export const sharedModule = async (): Promise<LibCrypto> => {
+  shared ??= wasmLoaderThreaded(memory.sharedMemory)
+    .then((module) => {
+      attachScratchArena(module as LibCrypto);
+
+      return module as LibCrypto;
+    })
+    .catch((error: unknown) => {
+      shared = undefined;
+
+      throw error;
+    });
+
+  return await shared;
+};
@@ -0,0 +1,325 @@
+import { skipped_keys_SLOTBYTES, skipped_keys_STATEBYTES } from "./interfaces";
+import { zeroFree } from "../utils/zeroFree";
+import { MAX_SKIP_SESSION, RATCHET_DHPUB_LEN } from "../utils/constants";
+
+import type { LibCrypto } from "./libcrypto";
+
+// Match skipped_keys.h: an id is DH pub || n || PQ epoch (u64 BE) and an
+// exported entry is id || message key.
+const SKIPPED_KEYS_MIN_CAPACITY = 16;
+const SKIPPED_KEYS_MAX_CAPACITY = 4096;
+const SKIPPED_KEY_ID_LEN = RATCHET_DHPUB_LEN + 16;
+const SKIPPED_KEY_ENTRY_LEN = SKIPPED_KEY_ID_LEN + 32;
+const MESSAGE_KEY_LEN = 32;
+const MAX_U64 = (1n << 64n) - 1n;
+
+/**
+ * The part of `Map<string, Uint8Array>` a ratchet's skipped-key store offers.
+ * Keys are `${hex(dhPub)}:${n}`, optionally followed by `:${pqEpoch}`; a plain
+ * `Map` and a `SkippedKeyTable` both satisfy it.
+ */
+export interface SkippedKeyStore {
+  readonly size: number;
+  get(key: string): Uint8Array | undefined;
+  set(key: string, messageKey: Uint8Array): this;
+  has(key: string): boolean;
+  delete(key: string): boolean;
+  keys(): IterableIterator<string>;
+  values(): IterableIterator<Uint8Array>;
+  entries(): IterableIterator<[string, Uint8Array]>;
+}
+
+const toHex = (u8: Uint8Array): string =>
+  Array.from(u8, (b) => b.toString(16).padStart(2, "0")).join("");
+
+const KEY_PATTERN = /^([0-9a-f]{64}):(\d{1,16})(?::(\d{1,20}))?$/;
+
+// Writes the raw id for a store key; epoch-less keys are epoch 0.
+const writeId = (key: string, id: Uint8Array): void => {
+  const match = KEY_PATTERN.exec(key);
+  const n = match ? Number(match[2]) : -1;
+  const epoch = match?.[3] === undefined ? 0n : BigInt(match[3]);
+  if (!match || !Number.isSafeInteger(n) || epoch > MAX_U64)
+    throw new Error("skipped keys: invalid key");
+
+  const view = new DataView(id.buffer, id.byteOffset, SKIPPED_KEY_ID_LEN);
+  for (let i = 0; i < RATCHET_DHPUB_LEN; i++)
+    id[i] = parseInt(match[1].slice(i * 2, i * 2 + 2), 16);
+  view.setUint32(RATCHET_DHPUB_LEN, Math.floor(n / 0x100000000));
+  view.setUint32(RATCHET_DHPUB_LEN + 4, n >>> 0);
+  view.setBigUint64(RATCHET_DHPUB_LEN + 8, epoch);
+};
+
+const readKey = (id: Uint8Array): string => {
+  const view = new DataView(id.buffer, id.byteOffset, SKIPPED_KEY_ID_LEN);
+  const n =
+    view.getUint32(RATCHET_DHPUB_LEN) * 0x100000000 +
+    view.getUint32(RATCHET_DHPUB_LEN + 4);
+  const epoch = view.getBigUint64(RATCHET_DHPUB_LEN + 8);
+  const key = `${toHex(id.subarray(0, RATCHET_DHPUB_LEN))}:${n}`;
+  return epoch === 0n ? key : `${key}:${epoch}`;
+};
+
+const tableBytes = (capacity: number): number =>
+  skipped_keys_STATEBYTES + capacity * skipped_keys_SLOTBYTES;
+
+/**
+ * Skipped message keys in a `skipped_keys` table on the WASM heap (see
+ * skipped_keys.c), so `ratchet_decrypt_step` can look them up and store them
+ * without a round trip through JS. Keys live only in the table: `set` moves
+ * the given buffer in and wipes it, `get` and `values` return copies. Past
+ * `limit` the oldest key is evicted and wiped by the C side.
+ *
+ * The table is allocated on the first insert and doubles (with a rehash) as it
+ * fills; it is freed again once empty. `free` wipes and releases it.
+ */
+export class SkippedKeyTable implements SkippedKeyStore {
+  readonly module: LibCrypto;
+  readonly limit: number;
+  #ptr = 0;
+  #capacity = 0;
+
+  constructor(module: LibCrypto, limit: number = MAX_SKIP_SESSION) {
+    if (
+      !Number.isSafeInteger(limit) ||
+      limit < 1 ||
+      limit > (SKIPPED_KEYS_MAX_CAPACITY / 4) * 3
+    )
+      throw new Error("skipped keys: invalid limit");
+    this.module = module;
+    this.limit = limit;
+  }
+
+  /** The `skipped_keys` table, 0 while nothing is stored. */
+  get ptr(): number {
+    return this.#ptr;
+  }
+
+  get size(): number {
+    return this.#ptr ? this.module._skipped_keys_count(this.#ptr) : 0;
+  }
+
+  /**
+   * Grows the table so `extra` more keys fit without an eviction below
+   * `limit`. The ratchet calls this before handing the table to a step.
+   */
+  reserve(extra: number): void {
+    const wanted = Math.min(this.size + extra, this.limit);
+    if (wanted === 0) return;
+
+    let capacity = Math.max(this.#capacity, SKIPPED_KEYS_MIN_CAPACITY);
+    while ((capacity / 4) * 3 < wanted) capacity *= 2;
+    if (capacity === this.#capacity) return;
+
+    const ptr = this.module._malloc(tableBytes(capacity));
+    if (!ptr) throw new Error("skipped keys: out of memory");
+    if (
+      this.module._skipped_keys_init(
+        ptr,
+        capacity,
+        Math.min(this.limit, (capacity / 4) * 3),
+      ) !== 0 ||
+      (this.#ptr && this.module._skipped_keys_rehash(ptr, this.#ptr) !== 0)
+    ) {
+      zeroFree(
+        this.module,
+        new Uint8Array(
+          this.module.wasmMemory.buffer,
+          ptr,
+          tableBytes(capacity),
+        ),
+      );
+      throw new Error("skipped keys: could not grow table");
+    }
+
+    // The rehash wiped the old table.
+    if (this.#ptr) this.module._free(this.#ptr);
+    this.#ptr = ptr;
+    this.#capacity = capacity;
+  }
+
+  get(key: string): Uint8Array | undefined {
+    if (!this.#ptr) return undefined;
+    return this.#withEntry(key, (id, messageKey) =>
+      this.module._skipped_keys_get(this.#ptr, id, messageKey) === 0
+        ? Uint8Array.from(
+            new Uint8Array(
+              this.module.wasmMemory.buffer,
+              messageKey,
+              MESSAGE_KEY_LEN,
+            ),
+          )
+        : undefined,
+    );
+  }
+
+  has(key: string): boolean {
+    if (!this.#ptr) return false;
+    return this.#withEntry(
+      key,
+      (id) => this.module._skipped_keys_get(this.#ptr, id, 0) === 0,
+    );
+  }
+
+  set(key: string, messageKey: Uint8Array): this {
+    if (messageKey.length !== MESSAGE_KEY_LEN)
+      throw new Error("skipped keys: invalid message key");
+    this.#withEntry(key, (id, mk) => {
+      this.reserve(1);
+      new Uint8Array(this.module.wasmMemory.buffer, mk, MESSAGE_KEY_LEN).set(
+        messageKey,
+      );
+      if (this.module._skipped_keys_put(this.#ptr, id, mk) < 0)
+        throw new Error("skipped keys: could not store key");
+    });
+    messageKey.fill(0);
+    return this;
+  }
+
+  delete(key: string): boolean {
+    if (!this.#ptr) return false;
+    const found = this.#withEntry(
+      key,
+      (id) => this.module._skipped_keys_take(this.#ptr, id, 0) === 0,
+    );
+    if (this.size === 0) this.free();
+    return found;
+  }
+
+  /** `get` and `delete` in one lookup; null when `key` is absent. */
+  take(key: string): Uint8Array | null {
+    if (!this.#ptr) return null;
+    const messageKey = this.#withEntry(key, (id, mk) =>
+      this.module._skipped_keys_take(this.#ptr, id, mk) === 0
+        ? Uint8Array.from(
+            new Uint8Array(this.module.wasmMemory.buffer, mk, MESSAGE_KEY_LEN),
+          )
+        : null,
+    );
+    if (this.size === 0) this.free();
+    return messageKey;
+  }
+
+  *entries(): IterableIterator<[string, Uint8Array]> {
+    yield* this.#export();
+  }
+
+  *keys(): IterableIterator<string> {
+    for (const [key, messageKey] of this.#export()) {
+      messageKey.fill(0);
+      yield key;
+    }
+  }
+
+  *values(): IterableIterator<Uint8Array> {
+    for (const [, messageKey] of this.#export()) yield messageKey;
+  }
+
+  [Symbol.iterator](): IterableIterator<[string, Uint8Array]> {
+    return this.entries();
+  }
+
+  /** An independent table on the same module holding the same keys. */
+  clone(): SkippedKeyTable {
+    const copy = new SkippedKeyTable(this.module, this.limit);
+    if (!this.#ptr) return copy;
+
+    const bytes = tableBytes(this.#capacity);
+    const ptr = this.module._malloc(bytes);
+    if (!ptr) throw new Error("skipped keys: out of memory");
+    new Uint8Array(this.module.wasmMemory.buffer).copyWithin(
+      ptr,
+      this.#ptr,
+      this.#ptr + bytes,
+    );
+    copy.#ptr = ptr;
+    copy.#capacity = this.#capacity;
+    return copy;
+  }
+
+  /** Wipes and releases the table; the store is empty afterwards. */
+  free(): void {
+    if (!this.#ptr) return;
+    zeroFree(
+      this.module,
+      new Uint8Array(
+        this.module.wasmMemory.buffer,
+        this.#ptr,
+        tableBytes(this.#capacity),
+      ),
+    );
+    this.#ptr = 0;
+    this.#capacity = 0;
+  }
+
+  // One wiped heap scratch of id || message key per operation.
+  #withEntry<T>(key: string, run: (id: number, messageKey: number) => T): T {
+    const scratch = this.module._malloc(SKIPPED_KEY_ID_LEN + MESSAGE_KEY_LEN);
+    const view = new Uint8Array(
+      this.module.wasmMemory.buffer,
+      scratch,
+      SKIPPED_KEY_ID_LEN + MESSAGE_KEY_LEN,
+    );
+    try {
+      writeId(key, view.subarray(0, SKIPPED_KEY_ID_LEN));
+      return run(scratch, scratch + SKIPPED_KEY_ID_LEN);
+    } finally {
+      zeroFree(this.module, view);
+    }
+  }
+
+  // Owned copies of every key, oldest first.
+  #export(): Array<[string, Uint8Array]> {
+    const count = this.size;
+    if (count === 0) return [];
+
+    const ptr = this.module._malloc(count * SKIPPED_KEY_ENTRY_LEN);
+    const entries = new Uint8Array(
+      this.module.wasmMemory.buffer,
+      ptr,
+      count * SKIPPED_KEY_ENTRY_LEN,
+    );
+    try {
+      if (this.module._skipped_keys_export(this.#ptr, ptr) !== 0)
+        throw new Error("skipped keys: export failed");
+      const out: Array<[string, Uint8Array]> = [];
+      for (let i = 0; i < count; i++) {
+        const entry = entries.subarray(
+          i * SKIPPED_KEY_ENTRY_LEN,
+          (i + 1) * SKIPPED_KEY_ENTRY_LEN,
+        );
+        out.push([
+          readKey(entry.subarray(0, SKIPPED_KEY_ID_LEN)),
+          entry.slice(SKIPPED_KEY_ID_LEN),
+        ]);
+      }
+      return out;
+    } finally {
+      zeroFree(this.module, entries);
+    }
+  }
+}
+
+/**
+ * Moves the keys of any store into a new table on `module`, oldest first. The
+ * source's buffers are wiped and it is cleared only once every key is in.
+ */
+export const toSkippedKeyTable = (
+  store: SkippedKeyStore,
+  module: LibCrypto,
+  limit: number = MAX_SKIP_SESSION,
+): SkippedKeyTable => {
+  const table = new SkippedKeyTable(module, limit);
+  try {
+    table.reserve(store.size);
+    for (const [key, messageKey] of store.entries())
+      table.set(key, Uint8Array.from(messageKey));
+  } catch (error) {
+    table.free();
+    throw error;
+  }
+
+  for (const messageKey of store.values()) messageKey.fill(0);
+  for (const key of Array.from(store.keys())) store.delete(key);
+  return table;
+};
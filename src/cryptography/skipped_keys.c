@@ -0,0 +1,273 @@
+#include "skipped_keys.h"
+
+size_t
+skipped_keys_bytes(const unsigned int CAPACITY)
+{
+  return sizeof(skipped_keys) + (size_t)CAPACITY * sizeof(skipped_key_slot);
+}
+
+static inline uint32_t
+skipped_keys_home(const skipped_keys *table,
+                  const uint8_t id[SKIPPED_KEY_ID_LEN])
+{
+  uint8_t h[crypto_shorthash_siphash24_BYTES];
+
+  crypto_shorthash_siphash24(h, id, SKIPPED_KEY_ID_LEN, table->hash_key);
+
+  return ((uint32_t)h[0] | ((uint32_t)h[1] << 8) | ((uint32_t)h[2] << 16)
+          | ((uint32_t)h[3] << 24))
+         & (table->capacity - 1);
+}
+
+static inline int
+skipped_keys_id_equal(const uint8_t a[SKIPPED_KEY_ID_LEN],
+                      const uint8_t b[SKIPPED_KEY_ID_LEN])
+{
+  uint8_t d = 0;
+  size_t i;
+
+  for (i = 0; i < SKIPPED_KEY_ID_LEN; i++) d |= a[i] ^ b[i];
+
+  return d == 0;
+}
+
+/* Slot holding id, or SKIPPED_KEYS_NIL. The whole probe run is compared
+ * whether or not the key is found early in it, so the time taken depends on
+ * the run length only. */
+static uint32_t
+skipped_keys_find(const skipped_keys *table,
+                  const uint8_t id[SKIPPED_KEY_ID_LEN])
+{
+  const uint32_t mask = table->capacity - 1;
+  uint32_t i = skipped_keys_home(table, id);
+  uint32_t found = SKIPPED_KEYS_NIL;
+  uint32_t probes;
+
+  for (probes = 0; probes < table->capacity; probes++, i = (i + 1) & mask)
+  {
+    if (!table->slots[i].used) break;
+    if (skipped_keys_id_equal(table->slots[i].id, id)) found = i;
+  }
+
+  return found;
+}
+
+static void
+skipped_keys_link_tail(skipped_keys *table, const uint32_t i)
+{
+  table->slots[i].prev = table->tail;
+  table->slots[i].next = SKIPPED_KEYS_NIL;
+  if (table->tail != SKIPPED_KEYS_NIL)
+    table->slots[table->tail].next = (uint16_t)i;
+  else
+    table->head = (uint16_t)i;
+  table->tail = (uint16_t)i;
+}
+
+/* Points the neighbours of the slot now at index to at it. */
+static void
+skipped_keys_relink(skipped_keys *table, const uint32_t to)
+{
+  const skipped_key_slot *slot = &table->slots[to];
+
+  if (slot->prev != SKIPPED_KEYS_NIL)
+    table->slots[slot->prev].next = (uint16_t)to;
+  else
+    table->head = (uint16_t)to;
+  if (slot->next != SKIPPED_KEYS_NIL)
+    table->slots[slot->next].prev = (uint16_t)to;
+  else
+    table->tail = (uint16_t)to;
+}
+
+static void
+skipped_keys_unlink(skipped_keys *table, const uint32_t i)
+{
+  const skipped_key_slot *slot = &table->slots[i];
+
+  if (slot->prev != SKIPPED_KEYS_NIL)
+    table->slots[slot->prev].next = slot->next;
+  else
+    table->head = slot->next;
+  if (slot->next != SKIPPED_KEYS_NIL)
+    table->slots[slot->next].prev = slot->prev;
+  else
+    table->tail = slot->prev;
+}
+
+/* Backward-shift deletion: every later slot of the probe run whose home is
+ * not cyclically in (i, j] moves into the hole, so lookups never need
+ * tombstones. The slot finally vacated is wiped. */
+static void
+skipped_keys_remove_at(skipped_keys *table, uint32_t i)
+{
+  const uint32_t mask = table->capacity - 1;
+  uint32_t j = i, k;
+
+  skipped_keys_unlink(table, i);
+
+  for (;;)
+  {
+    j = (j + 1) & mask;
+    if (!table->slots[j].used) break;
+
+    k = skipped_keys_home(table, table->slots[j].id);
+    if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) continue;
+
+    memcpy(&table->slots[i], &table->slots[j], sizeof table->slots[i]);
+    skipped_keys_relink(table, i);
+    i = j;
+  }
+
+  sodium_memzero(&table->slots[i], sizeof table->slots[i]);
+  table->count--;
+}
+
+int
+skipped_keys_init(skipped_keys *table, const unsigned int CAPACITY,
+                  const unsigned int LIMIT)
+{
+  if (!table) return -1;
+  if (CAPACITY == 0 || CAPACITY > SKIPPED_KEYS_MAX_CAPACITY
+      || (CAPACITY & (CAPACITY - 1)) != 0)
+    return -1;
+  if (LIMIT == 0 || LIMIT > CAPACITY / 4 * 3) return -1;
+
+  sodium_memzero(table, skipped_keys_bytes(CAPACITY));
+  randombytes_buf(table->hash_key, sizeof table->hash_key);
+  table->capacity = CAPACITY;
+  table->limit = LIMIT;
+  table->head = SKIPPED_KEYS_NIL;
+  table->tail = SKIPPED_KEYS_NIL;
+
+  return 0;
+}
+
+unsigned int
+skipped_keys_count(const skipped_keys *table)
+{
+  return table ? table->count : 0;
+}
+
+int
+skipped_keys_put(skipped_keys *table, const uint8_t id[SKIPPED_KEY_ID_LEN],
+                 const uint8_t message_key[32])
+{
+  if (!table || !id || !message_key || table->capacity == 0) return -1;
+
+  const uint32_t mask = table->capacity - 1;
+  uint32_t i = skipped_keys_find(table, id);
+  int res = 0;
+
+  if (i != SKIPPED_KEYS_NIL)
+  {
+    memcpy(table->slots[i].message_key, message_key, 32);
+    return 2;
+  }
+
+  if (table->count >= table->limit)
+  {
+    skipped_keys_remove_at(table, table->head);
+    res = 1;
+  }
+
+  for (i = skipped_keys_home(table, id); table->slots[i].used;
+       i = (i + 1) & mask)
+    ;
+
+  memcpy(table->slots[i].id, id, SKIPPED_KEY_ID_LEN);
+  memcpy(table->slots[i].message_key, message_key, 32);
+  table->slots[i].used = 1;
+  skipped_keys_link_tail(table, i);
+  table->count++;
+
+  return res;
+}
+
+int
+skipped_keys_get(const skipped_keys *table,
+                 const uint8_t id[SKIPPED_KEY_ID_LEN],
+                 uint8_t message_key[32])
+{
+  if (!table || !id || table->count == 0) return 1;
+
+  const uint32_t i = skipped_keys_find(table, id);
+  if (i == SKIPPED_KEYS_NIL) return 1;
+
+  if (message_key) memcpy(message_key, table->slots[i].message_key, 32);
+
+  return 0;
+}
+
+int
+skipped_keys_take(skipped_keys *table, const uint8_t id[SKIPPED_KEY_ID_LEN],
+                  uint8_t *message_key)
+{
+  if (!table || !id || table->count == 0) return 1;
+
+  const uint32_t i = skipped_keys_find(table, id);
+  if (i == SKIPPED_KEYS_NIL) return 1;
+
+  if (message_key) memcpy(message_key, table->slots[i].message_key, 32);
+  skipped_keys_remove_at(table, i);
+
+  return 0;
+}
+
+int
+skipped_keys_export(const skipped_keys *table, uint8_t *entries)
+{
+  if (!table || (table->count > 0 && !entries)) return -1;
+
+  uint32_t i;
+  size_t off = 0;
+
+  for (i = table->head; i != SKIPPED_KEYS_NIL; i = table->slots[i].next)
+  {
+    memcpy(&entries[off], table->slots[i].id, SKIPPED_KEY_ID_LEN);
+    memcpy(&entries[off + SKIPPED_KEY_ID_LEN], table->slots[i].message_key,
+           32);
+    off += SKIPPED_KEY_ENTRY_LEN;
+  }
+
+  return 0;
+}
+
+int
+skipped_keys_import(skipped_keys *table, const unsigned int COUNT,
+                    const uint8_t *entries)
+{
+  if (!table || (COUNT > 0 && !entries)) return -1;
+
+  size_t i;
+
+  for (i = 0; i < COUNT; i++)
+  {
+    const uint8_t *entry = &entries[i * SKIPPED_KEY_ENTRY_LEN];
+
+    if (skipped_keys_put(table, entry, entry + SKIPPED_KEY_ID_LEN) < 0)
+      return -1;
+  }
+
+  return 0;
+}
+
+int
+skipped_keys_rehash(skipped_keys *dst, skipped_keys *src)
+{
+  if (!dst || !src || dst->capacity == 0) return -1;
+  if (src->count > dst->limit) return -1;
+
+  uint32_t i;
+
+  for (i = src->head; i != SKIPPED_KEYS_NIL; i = src->slots[i].next)
+  {
+    if (skipped_keys_put(dst, src->slots[i].id, src->slots[i].message_key)
+        < 0)
+      return -1;
+  }
+
+  sodium_memzero(src, skipped_keys_bytes(src->capacity));
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+#ifndef skipped_keys_H
+#define skipped_keys_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sodium.h>
+
+#include "utils.h"
+
+/* Skipped message keys (see skipped_keys.c): an open-addressing table keyed
+ * by the raw (DH pub, N, PQ epoch) bytes, in one block of
+ * skipped_keys_bytes(CAPACITY). Slots are fixed size and linear-probed from a
+ * SipHash of the key under a per-table random key; removal shifts the probe
+ * run back instead of leaving tombstones. Live slots are also threaded in
+ * insertion order, so the oldest key is evicted first once LIMIT is reached
+ * and export/rehash keep that order. Every slot is wiped when it is freed. */
+#define SKIPPED_KEYS_MAX_CAPACITY 4096U
+#define SKIPPED_KEYS_NIL 0xffffU
+
+/* A key's id is DH pub || n || PQ epoch (u64 big-endian); an exported entry
+ * is its id || message key. */
+#define SKIPPED_KEY_ID_LEN (RATCHET_DHPUB_LEN + 16U)      /* 48 */
+#define SKIPPED_KEY_ENTRY_LEN (SKIPPED_KEY_ID_LEN + 32U) /* 80 */
+
+typedef struct
+{
+  uint8_t id[SKIPPED_KEY_ID_LEN];
+  uint8_t message_key[32];
+  uint16_t prev;
+  uint16_t next;
+  uint32_t used;
+} skipped_key_slot;
+_Static_assert(sizeof(skipped_key_slot) == 88,
+               "skipped_key_slot layout must match interfaces.ts");
+
+typedef struct
+{
+  uint8_t hash_key[crypto_shorthash_siphash24_KEYBYTES];
+  uint32_t capacity;
+  uint32_t limit;
+  uint32_t count;
+  uint16_t head;
+  uint16_t tail;
+  skipped_key_slot slots[];
+} skipped_keys;
+_Static_assert(sizeof(skipped_keys) == 32,
+               "skipped_keys layout must match interfaces.ts");
+
+size_t skipped_keys_bytes(const unsigned int CAPACITY);
+
+/* CAPACITY is a power of two up to SKIPPED_KEYS_MAX_CAPACITY; LIMIT live keys
+ * may be held, at most three quarters of it. */
+int skipped_keys_init(skipped_keys *table, const unsigned int CAPACITY,
+                      const unsigned int LIMIT);
+
+/* Moves every key of src, oldest first, into an initialized dst with room for
+ * them. src is wiped. */
+int skipped_keys_rehash(skipped_keys *dst, skipped_keys *src);
+
+unsigned int skipped_keys_count(const skipped_keys *table);
+
+/* 0 inserted, 1 inserted after evicting (and wiping) the oldest key, 2 the
+ * key was already present and its message key replaced, -1 bad arguments. */
+int skipped_keys_put(skipped_keys *table, const uint8_t id[SKIPPED_KEY_ID_LEN],
+                     const uint8_t message_key[32]);
+
+/* 0 and the message key when present, 1 when absent. */
+int skipped_keys_get(const skipped_keys *table,
+                     const uint8_t id[SKIPPED_KEY_ID_LEN],
+                     uint8_t message_key[32]);
+
+/* skipped_keys_get that also removes the key; message_key may be NULL. */
+int skipped_keys_take(skipped_keys *table,
+                      const uint8_t id[SKIPPED_KEY_ID_LEN],
+                      uint8_t *message_key);
+
+/* count * SKIPPED_KEY_ENTRY_LEN bytes, oldest first. */
+int skipped_keys_export(const skipped_keys *table, uint8_t *entries);
+
+/* Puts COUNT exported entries in order, evicting past the limit. */
+int skipped_keys_import(skipped_keys *table, const unsigned int COUNT,
+                        const uint8_t *entries);
+
+#endif
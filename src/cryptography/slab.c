@@ -0,0 +1,165 @@
+#include "slab.h"
+
+/* 16 B nonces and tags, 32 B keys, 64 B hashes and roots, 128 B AADs (121 B
+ * chunk AAD, root || key), 256 B headers, 1 KiB and 4 KiB proofs (PROOF_LEN is
+ * 3,124 B) and cells. 78 KiB of small slots plus the cells. */
+static const uint32_t slab_class_size[SLAB_CLASSES]
+    = { 16, 32, 64, 128, 256, 1024, 4096, SLAB_CELL_BYTES };
+static const uint32_t slab_class_slots[SLAB_CLASSES - 1]
+    = { 128, 128, 128, 64, 32, 16, 8 };
+
+static uint32_t
+slab_slots(const unsigned int CELL_SLOTS, const unsigned int c)
+{
+  return c == SLAB_CLASSES - 1 ? CELL_SLOTS : slab_class_slots[c];
+}
+
+static uint8_t *
+slab_data(const slab *s)
+{
+  return (uint8_t *)(s->state + s->total_slots) + s->data_pad;
+}
+
+size_t
+slab_bytes(const unsigned int CELL_SLOTS)
+{
+  size_t slots = 0;
+  size_t data = 0;
+  unsigned int c;
+
+  if (CELL_SLOTS == 0 || CELL_SLOTS > SLAB_MAX_CELL_SLOTS) return 0;
+  for (c = 0; c < SLAB_CLASSES; c++)
+  {
+    slots += slab_slots(CELL_SLOTS, c);
+    data += (size_t)slab_slots(CELL_SLOTS, c) * slab_class_size[c];
+  }
+
+  /* + up to 15 bytes to align the data wherever the block lands. */
+  return sizeof(slab) + slots * sizeof(uint32_t) + 15 + data;
+}
+
+int
+slab_init(slab *s, const unsigned int CELL_SLOTS)
+{
+  uint32_t first = 0;
+  uint32_t offset = 0;
+  uint32_t i;
+  unsigned int c;
+
+  if (!s || slab_bytes(CELL_SLOTS) == 0) return -1;
+
+  s->cell_slots = CELL_SLOTS;
+  s->total_slots = 0;
+  for (c = 0; c < SLAB_CLASSES; c++)
+    s->total_slots += slab_slots(CELL_SLOTS, c);
+  s->data_pad = (uint32_t)((16U - ((uintptr_t)(s->state + s->total_slots)
+                                   & 15U))
+                           & 15U);
+
+  for (c = 0; c < SLAB_CLASSES; c++)
+  {
+    slab_class *k = &s->classes[c];
+
+    k->size = slab_class_size[c];
+    k->slots = slab_slots(CELL_SLOTS, c);
+    k->first = first;
+    k->offset = offset;
+    k->free_head = 0;
+    k->in_use = 0;
+    k->peak = 0;
+    k->allocs = 0;
+    k->misses = 0;
+    for (i = 0; i < k->slots; i++)
+      s->state[first + i] = i + 1 < k->slots ? i + 1 : SLAB_NIL;
+
+    first += k->slots;
+    offset += k->slots * k->size;
+  }
+  s->data_len = offset;
+  sodium_memzero(slab_data(s), s->data_len);
+
+  return 0;
+}
+
+uint8_t *
+slab_alloc(slab *s, const unsigned int LEN)
+{
+  slab_class *k = NULL;
+  uint32_t slot;
+  unsigned int c;
+
+  if (!s || LEN == 0 || LEN > SLAB_CELL_BYTES) return NULL;
+  for (c = 0; c < SLAB_CLASSES; c++)
+    if (LEN <= slab_class_size[c])
+    {
+      k = &s->classes[c];
+      break;
+    }
+
+  if (k->free_head == SLAB_NIL)
+  {
+    k->misses++;
+
+    return NULL;
+  }
+
+  slot = k->free_head;
+  k->free_head = s->state[k->first + slot];
+  s->state[k->first + slot] = SLAB_USED;
+  k->allocs++;
+  if (++k->in_use > k->peak) k->peak = k->in_use;
+
+  return slab_data(s) + k->offset + (size_t)slot * k->size;
+}
+
+int
+slab_free(slab *s, uint8_t *p)
+{
+  const uint8_t *data;
+  slab_class *k;
+  size_t rel;
+  uint32_t slot;
+  unsigned int c;
+
+  if (!s || !p) return -1;
+  data = slab_data(s);
+  if (p < data || p >= data + s->data_len) return 1;
+
+  rel = (size_t)(p - data);
+  for (c = SLAB_CLASSES - 1; s->classes[c].offset > rel; c--)
+    ;
+  k = &s->classes[c];
+  rel -= k->offset;
+  if (rel % k->size != 0) return -1;
+  slot = (uint32_t)(rel / k->size);
+  if (s->state[k->first + slot] != SLAB_USED) return -1;
+
+  sodium_memzero(p, k->size);
+  s->state[k->first + slot] = k->free_head;
+  k->free_head = slot;
+  k->in_use--;
+
+  return 0;
+}
+
+int
+slab_stats(const slab *s, uint32_t stats[SLAB_STATS_LEN])
+{
+  unsigned int c;
+
+  if (!s || !stats) return -1;
+  for (c = 0; c < SLAB_CLASSES; c++)
+  {
+    const slab_class *k = &s->classes[c];
+    uint32_t *out = stats + c * SLAB_STATS_FIELDS;
+
+    out[0] = k->size;
+    out[1] = k->slots;
+    out[2] = k->in_use;
+    out[3] = k->peak;
+    out[4] = k->allocs;
+    out[5] = k->misses;
+  }
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef slab_H
+#define slab_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sodium.h>
+
+/* Secure slab allocator (see slab.c), the C side of slab.ts. One block of
+ * slab_bytes(CELL_SLOTS) holds fixed-size slots in eight size classes tuned
+ * to the protocol's buffers: nonces and tags, keys, hashes and roots, AADs,
+ * proofs and 65 KiB cells. Free slots are threaded through a side table, so
+ * alloc and free are O(1), slots never split or coalesce, and no free-list
+ * link is ever written into freed memory. slab_free wipes the slot before it
+ * is reused. A request that does not fit its class is a miss and the caller
+ * takes it from the heap instead. */
+#define SLAB_CLASSES 8U
+/* A staged seal input (65,558 bytes) or a MESSAGE_LEN cell, rounded up. */
+#define SLAB_CELL_BYTES 66560U
+#define SLAB_MAX_CELL_SLOTS 64U
+/* Per class: slot size, slots, in use, peak in use, allocations, misses. */
+#define SLAB_STATS_FIELDS 6U
+#define SLAB_STATS_LEN (SLAB_CLASSES * SLAB_STATS_FIELDS)
+#define SLAB_NIL 0xffffffffU
+#define SLAB_USED 0xfffffffeU
+
+typedef struct
+{
+  uint32_t size;
+  uint32_t slots;
+  uint32_t first; /* index of the class's first slot in state[] */
+  uint32_t offset; /* of the class's first slot from the data start */
+  uint32_t free_head;
+  uint32_t in_use;
+  uint32_t peak;
+  uint32_t allocs;
+  uint32_t misses;
+} slab_class;
+
+typedef struct
+{
+  uint32_t cell_slots;
+  uint32_t total_slots;
+  uint32_t data_len;
+  uint32_t data_pad; /* from the end of state[] to the 16-byte aligned data */
+  slab_class classes[SLAB_CLASSES];
+  uint32_t state[]; /* per slot: the next free slot, SLAB_NIL or SLAB_USED */
+} slab;
+_Static_assert(sizeof(slab) == 16 + SLAB_CLASSES * 36,
+               "slab header layout changed");
+
+size_t slab_bytes(const unsigned int CELL_SLOTS);
+
+/* CELL_SLOTS is 1 to SLAB_MAX_CELL_SLOTS; the smaller classes have fixed
+ * counts (see slab.c). Every slot starts zeroed. */
+int slab_init(slab *s, const unsigned int CELL_SLOTS);
+
+/* A zeroed slot of the smallest class holding LEN bytes, aligned to 16, or
+ * NULL when LEN is 0, exceeds SLAB_CELL_BYTES, or its class is full. */
+uint8_t *slab_alloc(slab *s, const unsigned int LEN);
+
+/* Wipes the whole slot p and returns it to its class. Returns 1 if p is not
+ * inside the slab (a heap pointer the caller frees), -1 if p is not the start
+ * of a live slot (nothing is changed) and 0 otherwise. */
+int slab_free(slab *s, uint8_t *p);
+
+/* Copies SLAB_STATS_FIELDS counters per class, smallest class first. */
+int slab_stats(const slab *s, uint32_t stats[SLAB_STATS_LEN]);
+
+#endif
@@ -0,0 +1,113 @@
+import type { LibCrypto } from "./libcrypto";
+
+/**
+ * Cell slots of a protocol module's slab: a receive stages a wire cell and its
+ * plaintext, a seal its input and output cell, so four cover one of each in
+ * flight. Batches larger than a cell miss and come from the heap.
+ */
+export const SLAB_CELL_SLOTS = 4;
+
+/**
+ * Heap reserved for that slab on top of the fixed protocol budget (see
+ * protocolV3Memory). slab_bytes(SLAB_CELL_SLOTS) is 348,463 bytes;
+ * attachSlab checks the fit.
+ */
+export const SLAB_RESERVE_BYTES = 384 * 1024;
+
+const SLAB_CLASSES = 8;
+const SLAB_STATS_FIELDS = 6;
+
+export interface SlabClassStats {
+  size: number;
+  slots: number;
+  inUse: number;
+  peak: number;
+  allocs: number;
+  /** Requests that found the class full and went to the heap. */
+  misses: number;
+}
+
+const slabs = new WeakMap<LibCrypto, number>();
+
+/**
+ * Give a long-lived module a secure slab (slab.c). Afterwards `secureMalloc`
+ * serves its keys, nonces, hashes, AADs, proofs and cells from fixed-size
+ * slots, and `zeroFree` returns them to the slab, which wipes them in C.
+ */
+export const attachSlab = (
+  module: LibCrypto,
+  cellSlots = SLAB_CELL_SLOTS,
+): void => {
+  if (slabs.has(module)) return;
+
+  const bytes = module._slab_bytes(cellSlots);
+  if (bytes === 0) throw new Error("Invalid slab cell slot count.");
+  if (cellSlots === SLAB_CELL_SLOTS && bytes > SLAB_RESERVE_BYTES)
+    throw new Error("Slab does not fit its memory reserve.");
+
+  const ptr = module._malloc(bytes);
+  if (module._slab_init(ptr, cellSlots) !== 0) {
+    module._free(ptr);
+
+    throw new Error("Could not initialize slab.");
+  }
+
+  slabs.set(module, ptr);
+};
+
+/**
+ * `len` bytes from the module's slab when it has one and the size class has a
+ * free slot, from `_malloc` otherwise. Release with `zeroFree` either way.
+ */
+export const secureMalloc = (module: LibCrypto, len: number): number => {
+  const slab = slabs.get(module);
+  const ptr = slab === undefined ? 0 : module._slab_alloc(slab, len);
+
+  return ptr !== 0 ? ptr : module._malloc(len);
+};
+
+/**
+ * Return `ptr` to the module's slab, which wipes the whole slot. False when
+ * the module has no slab or `ptr` is a heap pointer; throws for a pointer
+ * into the slab that is not a live slot, which must not reach `_free` either.
+ */
+export const slabFree = (module: LibCrypto, ptr: number): boolean => {
+  const slab = slabs.get(module);
+  if (slab === undefined) return false;
+
+  const result = module._slab_free(slab, ptr);
+  if (result < 0) throw new Error("Pointer is not a live slab slot.");
+
+  return result === 0;
+};
+
+/** Occupancy of the module's slab per size class, or null without one. */
+export const slabStats = (module: LibCrypto): SlabClassStats[] | null => {
+  const slab = slabs.get(module);
+  if (slab === undefined) return null;
+
+  const len = SLAB_CLASSES * SLAB_STATS_FIELDS;
+  const ptr = module._malloc(len * Uint32Array.BYTES_PER_ELEMENT);
+  try {
+    if (module._slab_stats(slab, ptr) !== 0)
+      throw new Error("Could not read slab statistics.");
+    const stats = Uint32Array.from(
+      new Uint32Array(module.wasmMemory.buffer, ptr, len),
+    );
+
+    return Array.from({ length: SLAB_CLASSES }, (_, c) => {
+      const k = stats.subarray(c * SLAB_STATS_FIELDS);
+
+      return {
+        size: k[0],
+        slots: k[1],
+        inUse: k[2],
+        peak: k[3],
+        allocs: k[4],
+        misses: k[5],
+      };
+    });
+  } finally {
+    module._free(ptr);
+  }
+};
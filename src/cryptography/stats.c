@@ -0,0 +1,535 @@
+#include "stats.h"
+
+#ifdef P2PARTY_STATS
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#else
+#include <time.h>
+#endif
+
+typedef struct
+{
+  uint64_t calls;
+  uint64_t bytes;
+  uint64_t ns;
+  uint64_t codes[STATS_CODES];
+  uint64_t latency[STATS_BUCKETS];
+} stats_entry;
+_Static_assert(sizeof(stats_entry) == STATS_FIELDS * sizeof(uint64_t),
+               "stats_entry layout must match stats.ts");
+
+/* Only the calling thread enters an export, pthread build included (the pool
+ * workers run tasks, never exports), so plain increments are enough. */
+static stats_entry stats_table[STATS_EXPORTS];
+
+static uint64_t
+stats_now(void)
+{
+#ifdef __EMSCRIPTEN__
+  /* performance.now(): browsers coarsen it to microseconds or more, so short
+   * calls mostly land in bucket 0 there. */
+  return (uint64_t)(emscripten_get_now() * 1e6);
+#else
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return (uint64_t)t.tv_sec * 1000000000U + (uint64_t)t.tv_nsec;
+#endif
+}
+
+static void
+stats_time(const unsigned int EXPORT, const uint64_t BYTES,
+           const uint64_t START)
+{
+  stats_entry *e = &stats_table[EXPORT];
+  const uint64_t ns = stats_now() - START;
+  uint64_t rest = ns >> 10;
+  unsigned int bucket = 0;
+
+  while (rest != 0 && bucket < STATS_BUCKETS - 1U)
+  {
+    bucket++;
+    rest >>= 1;
+  }
+  e->calls++;
+  e->bytes += BYTES;
+  e->ns += ns;
+  e->latency[bucket]++;
+}
+
+static void
+stats_code(const unsigned int EXPORT, const int code)
+{
+  unsigned int slot = STATS_CODES - 1U;
+
+  if (code == 0 || code == 1)
+    slot = (unsigned int)code;
+  else if (code < 0 && code >= -7)
+    slot = (unsigned int)(1 - code);
+  stats_table[EXPORT].codes[slot]++;
+}
+
+static void
+stats_record(const unsigned int EXPORT, const uint64_t BYTES,
+             const uint64_t START, const int code)
+{
+  stats_time(EXPORT, BYTES, START);
+  stats_code(EXPORT, code);
+}
+
+#undef sign
+#undef verify
+#undef verify_batch
+#undef seal_message_chunk
+#undef receive_message_with_key
+#undef receive_message_with_key_fused
+#undef receive_message_with_proof_cache
+#undef receive_message_batch
+#undef receive_message_in_slot
+#undef encrypt_chachapoly_symmetric
+#undef decrypt_chachapoly_symmetric
+#undef get_merkle_root
+#undef merkle_leaf_hash_batch
+#undef merkle_tree_build
+#undef merkle_tree_proof
+#undef verify_merkle_proof
+#undef merkle_proof_cache_verify
+#undef x25519_dh
+#undef hkdf_sha512_extract
+#undef hkdf_sha512_expand
+#undef ratchet_encrypt_step
+#undef ratchet_decrypt_step
+#undef handshake_key_schedule
+#undef argon2id_hash
+
+/* The exports. Bytes are the message for signatures, the frame for chunk
+ * sealing and receiving, the input for AEAD, hashing and HKDF, and the memory
+ * filled for Argon2id; key agreement and ratchet steps count none. */
+
+int
+sign(const unsigned int DATA_LEN, const uint8_t data[DATA_LEN],
+     const uint8_t secret_key[crypto_sign_ed25519_SECRETKEYBYTES],
+     uint8_t signature[crypto_sign_ed25519_BYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = sign_uninstrumented(DATA_LEN, data, secret_key, signature);
+
+  stats_record(STATS_SIGN, DATA_LEN, start, res);
+
+  return res;
+}
+
+int
+verify(const unsigned int DATA_LEN, const uint8_t data[DATA_LEN],
+       const uint8_t public_key[crypto_sign_ed25519_PUBLICKEYBYTES],
+       const uint8_t signature[crypto_sign_ed25519_BYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = verify_uninstrumented(DATA_LEN, data, public_key, signature);
+
+  stats_record(STATS_VERIFY, DATA_LEN, start, res);
+
+  return res;
+}
+
+int
+verify_batch(const unsigned int COUNT, const uint8_t *messages,
+             const uint32_t message_lens[COUNT],
+             const uint8_t public_keys[COUNT * 32],
+             const uint8_t signatures[COUNT * 64], uint8_t results[COUNT])
+{
+  uint64_t bytes = 0;
+  unsigned int i;
+
+  if (message_lens)
+    for (i = 0; i < COUNT; i++) bytes += message_lens[i];
+
+  const uint64_t start = stats_now();
+  const int res = verify_batch_uninstrumented(COUNT, messages, message_lens,
+                                              public_keys, signatures, results);
+
+  stats_record(STATS_VERIFY_BATCH, bytes, start, res);
+
+  return res;
+}
+
+int
+seal_message_chunk(
+    uint8_t message[WIRE_CHUNK_FRAME_LEN],
+    const uint8_t header[CHUNK_AAD_HEADER_LEN],
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    const uint8_t metadata[METADATA_LEN], const uint8_t proof[PROOF_LEN],
+    const uint8_t chunk[CHUNK_LEN],
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = seal_message_chunk_uninstrumented(
+      message, header, merkle_root, metadata, proof, chunk, message_key);
+
+  stats_record(STATS_SEAL_MESSAGE_CHUNK, WIRE_CHUNK_FRAME_LEN, start, res);
+
+  return res;
+}
+
+int
+receive_message_with_key(
+    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = receive_message_with_key_uninstrumented(
+      decrypted, message, merkle_root, message_key);
+
+  stats_record(STATS_RECEIVE_MESSAGE_WITH_KEY, WIRE_CHUNK_FRAME_LEN, start,
+               res);
+
+  return res;
+}
+
+int
+receive_message_with_key_fused(
+    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = receive_message_with_key_fused_uninstrumented(
+      decrypted, message, merkle_root, message_key);
+
+  stats_record(STATS_RECEIVE_MESSAGE_WITH_KEY_FUSED, WIRE_CHUNK_FRAME_LEN,
+               start, res);
+
+  return res;
+}
+
+int
+receive_message_with_proof_cache(
+    uint8_t decrypted[DECRYPTED_LEN], const uint8_t message[MESSAGE_LEN],
+    merkle_proof_cache *proof_cache,
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = receive_message_with_proof_cache_uninstrumented(
+      decrypted, message, proof_cache, message_key);
+
+  stats_record(STATS_RECEIVE_MESSAGE_WITH_PROOF_CACHE, WIRE_CHUNK_FRAME_LEN,
+               start, res);
+
+  return res;
+}
+
+/* Counts one call, but a code per frame: the call itself returns how many
+ * frames passed. */
+int
+receive_message_batch(const unsigned int COUNT, uint8_t *decrypted,
+                      const uint8_t *frames, const unsigned int FRAMES_LEN,
+                      const uint32_t *frame_offsets,
+                      const uint8_t *merkle_roots,
+                      merkle_proof_cache *proof_cache,
+                      const uint8_t *message_keys, int32_t *status)
+{
+  const uint64_t start = stats_now();
+  const int res = receive_message_batch_uninstrumented(
+      COUNT, decrypted, frames, FRAMES_LEN, frame_offsets, merkle_roots,
+      proof_cache, message_keys, status);
+  unsigned int i;
+
+  stats_time(STATS_RECEIVE_MESSAGE_BATCH, FRAMES_LEN, start);
+  if (res < 0)
+    stats_code(STATS_RECEIVE_MESSAGE_BATCH, res);
+  else
+    for (i = 0; i < COUNT; i++)
+      stats_code(STATS_RECEIVE_MESSAGE_BATCH, status[i]);
+
+  return res;
+}
+
+int
+receive_message_in_slot(
+    ingress_ring *ring, const unsigned int slot,
+    const uint8_t merkle_root[crypto_hash_sha512_BYTES],
+    merkle_proof_cache *proof_cache,
+    const uint8_t message_key[crypto_aead_chacha20poly1305_ietf_KEYBYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = receive_message_in_slot_uninstrumented(
+      ring, slot, merkle_root, proof_cache, message_key);
+
+  stats_record(STATS_RECEIVE_MESSAGE_IN_SLOT, WIRE_CHUNK_FRAME_LEN, start,
+               res);
+
+  return res;
+}
+
+int
+encrypt_chachapoly_symmetric(
+    uint8_t *out, const uint8_t *data, const unsigned int data_len,
+    const uint8_t key[crypto_aead_chacha20poly1305_ietf_KEYBYTES],
+    const uint8_t nonce[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
+    const uint8_t *aad, const unsigned int aad_len)
+{
+  const uint64_t start = stats_now();
+  const int res = encrypt_chachapoly_symmetric_uninstrumented(
+      out, data, data_len, key, nonce, aad, aad_len);
+
+  stats_record(STATS_ENCRYPT_CHACHAPOLY_SYMMETRIC, data_len, start, res);
+
+  return res;
+}
+
+int
+decrypt_chachapoly_symmetric(
+    uint8_t *out, const uint8_t *in, const unsigned int in_len,
+    const uint8_t key[crypto_aead_chacha20poly1305_ietf_KEYBYTES],
+    const uint8_t nonce[crypto_aead_chacha20poly1305_ietf_NPUBBYTES],
+    const uint8_t *aad, const unsigned int aad_len)
+{
+  const uint64_t start = stats_now();
+  const int res = decrypt_chachapoly_symmetric_uninstrumented(
+      out, in, in_len, key, nonce, aad, aad_len);
+
+  stats_record(STATS_DECRYPT_CHACHAPOLY_SYMMETRIC, in_len, start, res);
+
+  return res;
+}
+
+int
+get_merkle_root(const unsigned int LEAVES_LEN,
+                uint8_t leaves_hashed[LEAVES_LEN * crypto_hash_sha512_BYTES],
+                uint8_t root[crypto_hash_sha512_BYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = get_merkle_root_uninstrumented(LEAVES_LEN, leaves_hashed,
+                                                 root);
+
+  stats_record(STATS_GET_MERKLE_ROOT,
+               (uint64_t)LEAVES_LEN * crypto_hash_sha512_BYTES, start, res);
+
+  return res;
+}
+
+int
+merkle_leaf_hash_batch(const unsigned int COUNT, const unsigned int CHUNK_BYTES,
+                       const uint8_t chunks[COUNT * CHUNK_BYTES],
+                       uint8_t leaves_hashed[COUNT * crypto_hash_sha512_BYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = merkle_leaf_hash_batch_uninstrumented(COUNT, CHUNK_BYTES,
+                                                        chunks, leaves_hashed);
+
+  stats_record(STATS_MERKLE_LEAF_HASH_BATCH, (uint64_t)COUNT * CHUNK_BYTES,
+               start, res);
+
+  return res;
+}
+
+int
+merkle_tree_build(
+    merkle_tree *tree, const unsigned int LEAVES_LEN,
+    const uint8_t leaves_hashed[LEAVES_LEN * crypto_hash_sha512_BYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = merkle_tree_build_uninstrumented(tree, LEAVES_LEN,
+                                                   leaves_hashed);
+
+  stats_record(STATS_MERKLE_TREE_BUILD,
+               (uint64_t)LEAVES_LEN * crypto_hash_sha512_BYTES, start, res);
+
+  return res;
+}
+
+/* Returns the proof length on success, counted as code 0. */
+int
+merkle_tree_proof(const merkle_tree *tree, const unsigned int index,
+                  uint8_t *proof)
+{
+  const uint64_t start = stats_now();
+  const int res = merkle_tree_proof_uninstrumented(tree, index, proof);
+
+  stats_record(STATS_MERKLE_TREE_PROOF, 0, start, res < 0 ? res : 0);
+
+  return res;
+}
+
+int
+verify_merkle_proof(
+    const unsigned int PROOF_ARTIFACTS_LEN,
+    uint8_t element_hash[crypto_hash_sha512_BYTES],
+    const uint8_t root[crypto_hash_sha512_BYTES],
+    const uint8_t proof[PROOF_ARTIFACTS_LEN * (crypto_hash_sha512_BYTES + 1)])
+{
+  const uint64_t start = stats_now();
+  const int res = verify_merkle_proof_uninstrumented(
+      PROOF_ARTIFACTS_LEN, element_hash, root, proof);
+
+  stats_record(STATS_VERIFY_MERKLE_PROOF,
+               (uint64_t)PROOF_ARTIFACTS_LEN * (crypto_hash_sha512_BYTES + 1),
+               start, res);
+
+  return res;
+}
+
+int
+merkle_proof_cache_verify(
+    merkle_proof_cache *cache, const unsigned int PROOF_ARTIFACTS_LEN,
+    const uint8_t element_hash[crypto_hash_sha512_BYTES],
+    const uint8_t proof[PROOF_ARTIFACTS_LEN * (crypto_hash_sha512_BYTES + 1)])
+{
+  const uint64_t start = stats_now();
+  const int res = merkle_proof_cache_verify_uninstrumented(
+      cache, PROOF_ARTIFACTS_LEN, element_hash, proof);
+
+  stats_record(STATS_MERKLE_PROOF_CACHE_VERIFY,
+               (uint64_t)PROOF_ARTIFACTS_LEN * (crypto_hash_sha512_BYTES + 1),
+               start, res);
+
+  return res;
+}
+
+int
+x25519_dh(uint8_t shared[crypto_scalarmult_curve25519_BYTES],
+          const uint8_t sk[crypto_scalarmult_curve25519_SCALARBYTES],
+          const uint8_t pk[crypto_scalarmult_curve25519_BYTES])
+{
+  const uint64_t start = stats_now();
+  const int res = x25519_dh_uninstrumented(shared, sk, pk);
+
+  stats_record(STATS_X25519_DH, 0, start, res);
+
+  return res;
+}
+
+int
+hkdf_sha512_extract(uint8_t prk[crypto_auth_hmacsha512_BYTES],
+                    const uint8_t *salt, const unsigned int salt_len,
+                    const uint8_t *ikm, const unsigned int ikm_len)
+{
+  const uint64_t start = stats_now();
+  const int res = hkdf_sha512_extract_uninstrumented(prk, salt, salt_len, ikm,
+                                                     ikm_len);
+
+  stats_record(STATS_HKDF_SHA512_EXTRACT, ikm_len, start, res);
+
+  return res;
+}
+
+int
+hkdf_sha512_expand(uint8_t *out, const unsigned int out_len,
+                   const uint8_t prk[crypto_auth_hmacsha512_BYTES],
+                   const uint8_t *info, const unsigned int info_len)
+{
+  const uint64_t start = stats_now();
+  const int res = hkdf_sha512_expand_uninstrumented(out, out_len, prk, info,
+                                                    info_len);
+
+  stats_record(STATS_HKDF_SHA512_EXPAND, out_len, start, res);
+
+  return res;
+}
+
+int
+ratchet_encrypt_step(ratchet_state *state,
+                     uint8_t message_key[RATCHET_KEY_LEN],
+                     uint8_t header[RATCHET_HEADER_LEN])
+{
+  const uint64_t start = stats_now();
+  const int res = ratchet_encrypt_step_uninstrumented(state, message_key,
+                                                      header);
+
+  stats_record(STATS_RATCHET_ENCRYPT_STEP, 0, start, res);
+
+  return res;
+}
+
+int
+ratchet_decrypt_step(ratchet_state *state,
+                     uint8_t message_key[RATCHET_KEY_LEN],
+                     const uint8_t header[RATCHET_HEADER_LEN],
+                     skipped_keys *table, uint8_t *skipped,
+                     const unsigned int SKIPPED_CAP, unsigned int *skipped_len)
+{
+  const uint64_t start = stats_now();
+  const int res = ratchet_decrypt_step_uninstrumented(
+      state, message_key, header, table, skipped, SKIPPED_CAP, skipped_len);
+
+  stats_record(STATS_RATCHET_DECRYPT_STEP, 0, start, res);
+
+  return res;
+}
+
+int
+handshake_key_schedule(
+    uint8_t root_key[HANDSHAKE_KEY_LEN],
+    uint8_t pq_healing_root[HANDSHAKE_KEY_LEN],
+    uint8_t binding[HANDSHAKE_BINDING_LEN],
+    const uint8_t identity_sec[crypto_scalarmult_curve25519_SCALARBYTES],
+    const uint8_t peer_identity_pub[crypto_scalarmult_curve25519_BYTES],
+    const uint8_t ephemeral_sec[crypto_scalarmult_curve25519_SCALARBYTES],
+    const uint8_t peer_ephemeral_pub[crypto_scalarmult_curve25519_BYTES],
+    const unsigned int am_initiator, const uint8_t *pake_isk,
+    const uint8_t kem_secret[HANDSHAKE_KEM_SECRET_LEN],
+    const uint8_t *hybrid_info, const unsigned int HYBRID_INFO_LEN,
+    const uint8_t *binding_input, const unsigned int BINDING_INPUT_LEN)
+{
+  const uint64_t start = stats_now();
+  const int res = handshake_key_schedule_uninstrumented(
+      root_key, pq_healing_root, binding, identity_sec, peer_identity_pub,
+      ephemeral_sec, peer_ephemeral_pub, am_initiator, pake_isk, kem_secret,
+      hybrid_info, HYBRID_INFO_LEN, binding_input, BINDING_INPUT_LEN);
+
+  stats_record(STATS_HANDSHAKE_KEY_SCHEDULE, 0, start, res);
+
+  return res;
+}
+
+int
+argon2id_hash(uint8_t *out, const unsigned int OUT_LEN,
+              const uint8_t *password, const unsigned int PASSWORD_LEN,
+              const uint8_t *salt, const unsigned int SALT_LEN,
+              const uint8_t *secret, const unsigned int SECRET_LEN,
+              const uint8_t *ad, const unsigned int AD_LEN,
+              const unsigned int T_COST, const unsigned int M_KIB,
+              const unsigned int LANES, uint8_t *memory)
+{
+  const uint64_t start = stats_now();
+  const int res = argon2id_hash_uninstrumented(
+      out, OUT_LEN, password, PASSWORD_LEN, salt, SALT_LEN, secret,
+      SECRET_LEN, ad, AD_LEN, T_COST, M_KIB, LANES, memory);
+
+  stats_record(STATS_ARGON2ID_HASH, (uint64_t)M_KIB * 1024U, start, res);
+
+  return res;
+}
+#endif
+
+size_t
+libcrypto_stats_bytes(void)
+{
+#ifdef P2PARTY_STATS
+  return STATS_HEADER_BYTES + sizeof(stats_table);
+#else
+  return 0;
+#endif
+}
+
+int
+libcrypto_stats_snapshot(uint8_t *out, const unsigned int OUT_LEN)
+{
+#ifdef P2PARTY_STATS
+  const uint32_t header[4] = { STATS_VERSION, STATS_EXPORTS, STATS_CODES,
+                               STATS_BUCKETS };
+
+  if (!out || OUT_LEN < libcrypto_stats_bytes()) return -1;
+  memcpy(out, header, sizeof(header));
+  memcpy(out + STATS_HEADER_BYTES, stats_table, sizeof(stats_table));
+
+  return 0;
+#else
+  (void)out;
+  (void)OUT_LEN;
+
+  return -1;
+#endif
+}
@@ -0,0 +1,93 @@
+#ifndef stats_H
+#define stats_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Opt-in call statistics for the hot exports (see stats.c), read by stats.ts.
+ * Built with P2PARTY_STATS, the exports listed below are compiled under the
+ * name <export>_uninstrumented and stats.c defines each export as a wrapper
+ * that times the call and counts it, the bytes it processed and its return
+ * code. Calls inside the module go to the uninstrumented functions, so only
+ * calls from JavaScript are counted. Built without it, nothing is renamed or
+ * counted: libcrypto_stats_bytes returns 0 and libcrypto_stats_snapshot -1. */
+#define STATS_VERSION 1U
+/* Return codes 0, 1 and -1 to -7 have a slot each; the last takes the rest. */
+#define STATS_CODES 10U
+/* Bucket 0 counts calls under 1,024 ns, bucket i those from 2^(9 + i) ns up
+ * to 2^(10 + i) ns, and the last every call from 2^32 ns (4.3 s) up. */
+#define STATS_BUCKETS 24U
+/* Per export: calls, bytes, total ns, then the code and latency buckets. */
+#define STATS_FIELDS (3U + STATS_CODES + STATS_BUCKETS)
+/* Version, export count, STATS_CODES and STATS_BUCKETS as uint32_t. */
+#define STATS_HEADER_BYTES 16U
+
+/* Snapshot order; stats.ts names them in the same order. */
+enum
+{
+  STATS_SIGN,
+  STATS_VERIFY,
+  STATS_VERIFY_BATCH,
+  STATS_SEAL_MESSAGE_CHUNK,
+  STATS_RECEIVE_MESSAGE_WITH_KEY,
+  STATS_RECEIVE_MESSAGE_WITH_KEY_FUSED,
+  STATS_RECEIVE_MESSAGE_WITH_PROOF_CACHE,
+  STATS_RECEIVE_MESSAGE_BATCH,
+  STATS_RECEIVE_MESSAGE_IN_SLOT,
+  STATS_ENCRYPT_CHACHAPOLY_SYMMETRIC,
+  STATS_DECRYPT_CHACHAPOLY_SYMMETRIC,
+  STATS_GET_MERKLE_ROOT,
+  STATS_MERKLE_LEAF_HASH_BATCH,
+  STATS_MERKLE_TREE_BUILD,
+  STATS_MERKLE_TREE_PROOF,
+  STATS_VERIFY_MERKLE_PROOF,
+  STATS_MERKLE_PROOF_CACHE_VERIFY,
+  STATS_X25519_DH,
+  STATS_HKDF_SHA512_EXTRACT,
+  STATS_HKDF_SHA512_EXPAND,
+  STATS_RATCHET_ENCRYPT_STEP,
+  STATS_RATCHET_DECRYPT_STEP,
+  STATS_HANDSHAKE_KEY_SCHEDULE,
+  STATS_ARGON2ID_HASH,
+  STATS_EXPORTS
+};
+
+/* Snapshot size: the header, then STATS_FIELDS uint64_t per export. */
+size_t libcrypto_stats_bytes(void);
+
+/* Copies the header and every counter, in WASM (little-endian) byte order, to
+ * out. Returns 0, or -1 when OUT_LEN is short or the build has no stats. */
+int libcrypto_stats_snapshot(uint8_t *out, const unsigned int OUT_LEN);
+
+#ifdef P2PARTY_STATS
+#define sign sign_uninstrumented
+#define verify verify_uninstrumented
+#define verify_batch verify_batch_uninstrumented
+#define seal_message_chunk seal_message_chunk_uninstrumented
+#define receive_message_with_key receive_message_with_key_uninstrumented
+#define receive_message_with_key_fused                                        \
+  receive_message_with_key_fused_uninstrumented
+#define receive_message_with_proof_cache                                      \
+  receive_message_with_proof_cache_uninstrumented
+#define receive_message_batch receive_message_batch_uninstrumented
+#define receive_message_in_slot receive_message_in_slot_uninstrumented
+#define encrypt_chachapoly_symmetric                                          \
+  encrypt_chachapoly_symmetric_uninstrumented
+#define decrypt_chachapoly_symmetric                                          \
+  decrypt_chachapoly_symmetric_uninstrumented
+#define get_merkle_root get_merkle_root_uninstrumented
+#define merkle_leaf_hash_batch merkle_leaf_hash_batch_uninstrumented
+#define merkle_tree_build merkle_tree_build_uninstrumented
+#define merkle_tree_proof merkle_tree_proof_uninstrumented
+#define verify_merkle_proof verify_merkle_proof_uninstrumented
+#define merkle_proof_cache_verify merkle_proof_cache_verify_uninstrumented
+#define x25519_dh x25519_dh_uninstrumented
+#define hkdf_sha512_extract hkdf_sha512_extract_uninstrumented
+#define hkdf_sha512_expand hkdf_sha512_expand_uninstrumented
+#define ratchet_encrypt_step ratchet_encrypt_step_uninstrumented
+#define ratchet_decrypt_step ratchet_decrypt_step_uninstrumented
+#define handshake_key_schedule handshake_key_schedule_uninstrumented
+#define argon2id_hash argon2id_hash_uninstrumented
+#endif
+
+#endif
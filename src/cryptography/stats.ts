@@ -0,0 +1,162 @@
+import type { LibCrypto } from "./libcrypto";
+
+/** The counted exports, in stats.h order. */
+export const STATS_EXPORTS = [
+  "sign",
+  "verify",
+  "verify_batch",
+  "seal_message_chunk",
+  "receive_message_with_key",
+  "receive_message_with_key_fused",
+  "receive_message_with_proof_cache",
+  "receive_message_batch",
+  "receive_message_in_slot",
+  "encrypt_chachapoly_symmetric",
+  "decrypt_chachapoly_symmetric",
+  "get_merkle_root",
+  "merkle_leaf_hash_batch",
+  "merkle_tree_build",
+  "merkle_tree_proof",
+  "verify_merkle_proof",
+  "merkle_proof_cache_verify",
+  "x25519_dh",
+  "hkdf_sha512_extract",
+  "hkdf_sha512_expand",
+  "ratchet_encrypt_step",
+  "ratchet_decrypt_step",
+  "handshake_key_schedule",
+  "argon2id_hash",
+] as const;
+
+export type StatsExport = (typeof STATS_EXPORTS)[number];
+
+/** Return codes with a slot of their own, in slot order, then the rest. */
+const STATS_CODE_SLOTS = [
+  "0",
+  "1",
+  "-1",
+  "-2",
+  "-3",
+  "-4",
+  "-5",
+  "-6",
+  "-7",
+  "other",
+] as const;
+
+export type StatsCode = (typeof STATS_CODE_SLOTS)[number];
+
+const STATS_VERSION = 1;
+const STATS_BUCKETS = 24;
+const STATS_FIELDS = 3 + STATS_CODE_SLOTS.length + STATS_BUCKETS;
+const STATS_HEADER_BYTES = 16;
+
+export interface ExportStats {
+  calls: number;
+  /**
+   * Bytes processed: the message for signatures, the frame for chunk sealing
+   * and receiving, the input for AEAD, hashing and HKDF, the memory filled
+   * for Argon2id. Key agreement and ratchet steps count none.
+   */
+  bytes: number;
+  /** Time spent inside the export, over all calls. */
+  totalNs: number;
+  /**
+   * Calls per return code, e.g. `{ "0": 812, "-2": 3 }` when three frames
+   * failed authentication in receive_message_with_key. receive_message_batch
+   * counts each frame's status; merkle_tree_proof counts a proof as "0".
+   */
+  codes: Partial<Record<StatsCode, number>>;
+  /**
+   * Calls per latency bucket: bucket 0 under 1,024 ns, bucket i from
+   * 2^(9 + i) to 2^(10 + i) ns, and the last (23) from 2^32 ns up. In the
+   * browser the clock is performance.now(), so short calls sit in bucket 0.
+   */
+  latency: number[];
+}
+
+export type CryptoStats = Record<StatsExport, ExportStats>;
+
+/**
+ * The module's call statistics since it was instantiated, or null when its
+ * artifact was built without them (production builds, unless built with
+ * P2PARTY_WASM_STATS=1).
+ */
+export const cryptoStats = (module: LibCrypto): CryptoStats | null => {
+  const len = module._libcrypto_stats_bytes();
+  if (len === 0) return null;
+
+  const ptr = module._malloc(len);
+  try {
+    if (module._libcrypto_stats_snapshot(ptr, len) !== 0)
+      throw new Error("Could not read libcrypto statistics.");
+    const header = new Uint32Array(module.wasmMemory.buffer, ptr, 4);
+    if (
+      header[0] !== STATS_VERSION ||
+      header[1] !== STATS_EXPORTS.length ||
+      header[2] !== STATS_CODE_SLOTS.length ||
+      header[3] !== STATS_BUCKETS
+    )
+      throw new Error("Unexpected libcrypto statistics layout.");
+    const counters = Array.from(
+      new BigUint64Array(
+        module.wasmMemory.buffer,
+        ptr + STATS_HEADER_BYTES,
+        STATS_EXPORTS.length * STATS_FIELDS,
+      ),
+      Number,
+    );
+
+    return Object.fromEntries(
+      STATS_EXPORTS.map((name, e) => {
+        const k = counters.slice(e * STATS_FIELDS, (e + 1) * STATS_FIELDS);
+        const codes: Partial<Record<StatsCode, number>> = {};
+        STATS_CODE_SLOTS.forEach((code, slot) => {
+          if (k[3 + slot] !== 0) codes[code] = k[3 + slot];
+        });
+
+        return [
+          name,
+          {
+            calls: k[0],
+            bytes: k[1],
+            totalNs: k[2],
+            codes,
+            latency: k.slice(3 + STATS_CODE_SLOTS.length),
+          },
+        ];
+      }),
+    ) as CryptoStats;
+  } finally {
+    module._free(ptr);
+  }
+};
+
+/** Sum of two snapshots, e.g. of the modules a realm has loaded. */
+export const mergeCryptoStats = (
+  a: CryptoStats | null,
+  b: CryptoStats | null,
+): CryptoStats | null => {
+  if (!a || !b) return a ?? b;
+
+  return Object.fromEntries(
+    STATS_EXPORTS.map((name) => {
+      const codes = { ...a[name].codes };
+      for (const [code, count] of Object.entries(b[name].codes))
+        codes[code as StatsCode] = (codes[code as StatsCode] ?? 0) + count;
+
+      return [
+        name,
+        {
+          calls: a[name].calls + b[name].calls,
+          bytes: a[name].bytes + b[name].bytes,
+          totalNs: a[name].totalNs + b[name].totalNs,
+          codes,
+          latency: a[name].latency.map(
+            (count, bucket) => count + b[name].latency[bucket],
+          ),
+        },
+      ];
+    }),
+  ) as CryptoStats;
+};
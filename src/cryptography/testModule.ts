@@ -1,17 +1,36 @@
-import { readFileSync } from "node:fs";
+import { existsSync, readFileSync } from "node:fs";
 
 import libcrypto from "./libcrypto";
+import memory from "./memory";
 import { secureRandomUint32 } from "./random";
 
 import type { LibCrypto } from "./libcrypto";
 
+/**
+ * The SIMD build when it exists and the runtime validates v128, so the tests
+ * run the same four-lane kernels browsers load; the scalar build otherwise.
+ * P2PARTY_TEST_WASM=scalar pins the scalar build.
+ */
+const testWasmUrl = (): URL => {
+  const simd = new URL("./libcrypto.simd.wasm", import.meta.url);
+  const simdProbe = new Uint8Array([
+    0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1,
+    8, 0, 65, 0, 253, 15, 253, 98, 11,
+  ]);
+  return process.env.P2PARTY_TEST_WASM !== "scalar" &&
+    existsSync(simd) &&
+    WebAssembly.validate(simdProbe)
+    ? simd
+    : new URL("./libcrypto.wasm", import.meta.url);
+};
+
 /**
  * Instantiate the locally-built libcrypto.wasm for unit tests, bypassing the
  * CDN + SRI fetch in wasmLoader.ts. 32 pages == 2 MiB == INITIAL_MEMORY; growth
  * is off so every op fits the largest-single-op budget.
  */
 export const loadTestModule = async (): Promise<LibCrypto> => {
-  const fileBytes = readFileSync(new URL("./libcrypto.wasm", import.meta.url));
+  const fileBytes = readFileSync(testWasmUrl());
   // The emscripten factory's wasmBinary is typed ArrayBuffer; readFileSync
   // returns a Buffer, so copy the bytes into a fresh ArrayBuffer (type-correct
   // for `tsc`, and WebAssembly.instantiate accepts an ArrayBuffer at runtime).
@@ -25,3 +44,40 @@ export const loadTestModule = async (): Promise<LibCrypto> => {
     getRandomValue: secureRandomUint32,
   })) as LibCrypto;
 };
+
+/**
+ * The threaded build (libcrypto.pthread.{js,wasm}, written by
+ * `P2PARTY_WASM_THREADS=1 npm run prebuild`) with `threads` threads in its
+ * task pool, on a shared memory like sharedModule(). Its glue is an ES module
+ * whose workers start with worker_threads here. Null when it has not been
+ * built, so its tests skip; `npm run test:threads` sets
+ * P2PARTY_TEST_THREADS=1, which turns a missing build into a failure.
+ */
+export const loadThreadedTestModule = async (
+  threads: number,
+): Promise<LibCrypto | null> => {
+  const glue = new URL("./libcrypto.pthread.js", import.meta.url);
+  const wasm = new URL("./libcrypto.pthread.wasm", import.meta.url);
+  if (!existsSync(glue) || !existsSync(wasm)) {
+    if (process.env.P2PARTY_TEST_THREADS === "1")
+      throw new Error("libcrypto.pthread.wasm has not been built");
+    return null;
+  }
+
+  const fileBytes = readFileSync(wasm);
+  const wasmBinary = new ArrayBuffer(fileBytes.byteLength);
+  new Uint8Array(wasmBinary).set(fileBytes);
+  const { default: factory } = (await import(glue.href)) as {
+    default: typeof libcrypto;
+  };
+  const module = (await factory({
+    wasmBinary,
+    wasmMemory: memory.sharedMemory(true),
+    getRandomValue: secureRandomUint32,
+    pthreadPoolSize: threads - 1,
+  })) as LibCrypto;
+  if (module._pool_init(threads) !== 0)
+    throw new Error("Could not start the task pool.");
+
+  return module;
+};
@@ -35,6 +35,7 @@ const unsigned int CHUNK_LEN = DECRYPTED_LEN - METADATA_LEN - PROOF_LEN;
 #define FRAME_TYPE_RECEIPT 3U
 #define FRAME_TYPE_COVER 4U
 #define FRAME_TYPE_PQ_CONTROL 5U
+#define FRAME_TYPE_RANGE_RECEIPT 6U
 #define PQ_TAG_LEN 1U
 
 /* v4 large-cell clear header:
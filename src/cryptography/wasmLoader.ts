@@ -1,5 +1,8 @@
 import libcrypto from "./libcrypto";
 import { secureRandomUint32 } from "./random";
+import { trackCryptoStats } from "../utils/debug";
+
+import type { LibCrypto } from "./libcrypto";
 
 if (typeof WebAssembly != "object") {
   throw new Error("no native wasm support detected");
@@ -12,6 +15,10 @@ const defaultWasmUrl = new URL(
 let wasmUrl = defaultWasmUrl;
 let wasmLoadStarted = false;
 let wasmSourcePinned = false;
+let wasmThreads = 1;
+
+/** The calling thread plus pool.c's POOL_MAX_WORKERS. */
+const WASM_MAX_THREADS = 8;
 
 /**
  * The pinned digest of this release's exact WASM, and the single place it is
@@ -24,10 +31,75 @@ const cdnRequest = {
     "sha384-pBMyUqQ3KBztxgeJMgDFZeohfj9QlAFNwt4/gRlqT0vlZ2kbkKxv+q5DwbZOBuUP",
 };
 
+/**
+ * The same for libcrypto.simd.wasm, the -msimd128 build of the same sources.
+ * Its four-lane SHA-512 and ChaCha20-Poly1305 kernels are what make Merkle
+ * hashing and chunk sealing fast; the scalar artifact above is the fallback.
+ */
+const simdCdnRequest = {
+  integrity:
+    "sha384-OLBgp1GsljhM2TJ+sbHjaiH9txEUvgdDTAzHv2P24donTt6/529l+9Ua0vFImLlb",
+};
+
+/**
+ * libcrypto.pthread.wasm and its ES-module glue, built only with
+ * P2PARTY_WASM_THREADS=1 (scripts/emscripten.js), which also writes these two
+ * digests. Until then they are placeholders that no response matches, so a
+ * threaded load fails closed and falls back to the artifacts above.
+ */
+const pthreadCdnRequest = {
+  integrity: "sha384-unbuilt",
+};
+const pthreadGlueCdnRequest = {
+  integrity: "sha384-unbuilt",
+};
+
+interface WasmArtifact {
+  file: string;
+  request: { integrity: string };
+}
+
+const scalarArtifact: WasmArtifact = {
+  file: "libcrypto.wasm",
+  request: cdnRequest,
+};
+const simdArtifact: WasmArtifact = {
+  file: "libcrypto.simd.wasm",
+  request: simdCdnRequest,
+};
+const pthreadArtifact: WasmArtifact = {
+  file: "libcrypto.pthread.wasm",
+  request: pthreadCdnRequest,
+};
+const pthreadGlueArtifact: WasmArtifact = {
+  file: "libcrypto.pthread.js",
+  request: pthreadGlueCdnRequest,
+};
+
+/**
+ * The smallest module using a v128 instruction (i8x16.splat, i8x16.popcnt).
+ * Engines without WebAssembly SIMD fail to validate it, and would equally fail
+ * to compile libcrypto.simd.wasm.
+ */
+const simdProbe = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1,
+  8, 0, 65, 0, 253, 15, 253, 98, 11,
+]);
+
+const supportsSimd = (): boolean => {
+  try {
+    return WebAssembly.validate(simdProbe);
+  } catch {
+    return false;
+  }
+};
+
 /**
  * Point the browser root at a self-hosted copy of this release's exact WASM.
- * The build-pinned SRI is still enforced. Configure once, before connect() or
- * any other operation first loads cryptography.
+ * The build-pinned SRI is still enforced. On SIMD-capable engines
+ * libcrypto.simd.wasm is first looked up next to it, falling back to this URL
+ * when that copy is missing. Configure once, before connect() or any other
+ * operation first loads cryptography.
  */
 export const setWasmSourceUrl = (source: string | URL): void => {
   if (wasmLoadStarted)
@@ -40,6 +112,30 @@ export const setWasmSourceUrl = (source: string | URL): void => {
   wasmSourcePinned = true;
 };
 
+/**
+ * Let the realm's shared module (wasmLoaderThreaded) spread batch work over
+ * `threads` threads, the caller included, with libcrypto.pthread.wasm served
+ * next to the scalar WASM. It only takes effect on cross-origin isolated pages
+ * (COOP + COEP), the one place shared memory exists; everywhere else, and if
+ * the threaded artifact cannot be loaded, the single-threaded ones are used.
+ * Configure once, before cryptography first loads.
+ */
+export const setWasmThreads = (threads: number): void => {
+  if (!Number.isInteger(threads) || threads < 1 || threads > WASM_MAX_THREADS)
+    throw new RangeError(
+      `WASM threads must be an integer from 1 to ${String(WASM_MAX_THREADS)}`,
+    );
+  if (wasmLoadStarted)
+    throw new Error("WASM threads cannot change after cryptography has loaded");
+  wasmThreads = threads;
+};
+
+const supportsThreads = (): boolean =>
+  wasmThreads > 1 &&
+  globalThis.crossOriginIsolated === true &&
+  typeof SharedArrayBuffer === "function" &&
+  supportsSimd();
+
 /**
  * Compiled out of the browser bundle. rollup replaces this with the literal
  * "false" for the browser root, so terser folds the branch and drops
@@ -70,7 +166,9 @@ const isNodeLike = (): boolean =>
  * back into `import("node:fs/promises")`. The variables and ignore comments
  * only help consumers who bundle these sources unminified.
  */
-const readLocalWasm = async (): Promise<ArrayBuffer | null> => {
+const readLocalWasm = async (
+  artifact: WasmArtifact,
+): Promise<ArrayBuffer | null> => {
   const fsSpecifier = "node:fs/promises";
   const cryptoSpecifier = "node:crypto";
   try {
@@ -82,9 +180,13 @@ const readLocalWasm = async (): Promise<ArrayBuffer | null> => {
         /* @vite-ignore */ /* webpackIgnore: true */ cryptoSpecifier
       ) as Promise<typeof import("node:crypto")>,
     ]);
-    const bytes = await readFile(new URL("./libcrypto.wasm", import.meta.url));
+    const bytes = await readFile(
+      artifact === simdArtifact
+        ? new URL("./libcrypto.simd.wasm", import.meta.url)
+        : new URL("./libcrypto.wasm", import.meta.url),
+    );
     const digest = `sha384-${createHash("sha384").update(bytes).digest("base64")}`;
-    if (digest !== cdnRequest.integrity) return null;
+    if (digest !== artifact.request.integrity) return null;
     return bytes.buffer.slice(
       bytes.byteOffset,
       bytes.byteOffset + bytes.byteLength,
@@ -94,8 +196,10 @@ const readLocalWasm = async (): Promise<ArrayBuffer | null> => {
   }
 };
 
-const fetchWasm = async (): Promise<ArrayBuffer> => {
-  const resp = await fetch(wasmUrl, cdnRequest);
+const fetchWasm = async (artifact: WasmArtifact): Promise<ArrayBuffer> => {
+  const url =
+    artifact === scalarArtifact ? wasmUrl : new URL(artifact.file, wasmUrl);
+  const resp = await fetch(url, artifact.request);
   if (!resp.ok)
     throw new Error(
       `Unable to load p2party ${wasmVersion} WASM: HTTP ${String(resp.status)}`,
@@ -103,18 +207,101 @@ const fetchWasm = async (): Promise<ArrayBuffer> => {
   return await resp.arrayBuffer();
 };
 
+// An explicit setWasmSourceUrl() is an instruction, not a hint: honour it
+// even on Node rather than silently preferring the packaged copy.
+const localWasm = async (
+  artifact: WasmArtifact,
+): Promise<ArrayBuffer | null> =>
+  localWasmEnabled && !wasmSourcePinned && isNodeLike()
+    ? await readLocalWasm(artifact)
+    : null;
+
+/**
+ * The SIMD artifact is only an optimisation: any failure to obtain it (an
+ * older self-hosted mirror, a packaging that dropped it) resolves to null so
+ * the scalar artifact loads instead.
+ */
+const loadSimdWasm = async (): Promise<ArrayBuffer | null> =>
+  (await localWasm(simdArtifact)) ??
+  (await fetchWasm(simdArtifact).catch(() => null));
+
+/**
+ * The threaded module, or null on any failure so the caller can load a
+ * single-threaded one instead. The glue is an ES module that every worker
+ * starts from too, so it is fetched under its own pinned SRI and imported from
+ * a blob of those bytes rather than by URL. Its workers are started with the
+ * module, one per thread besides the caller, and pool_init only hands them
+ * to the task pool.
+ */
+const loadThreadedWasm = async (
+  wasmMemory: WebAssembly.Memory,
+): Promise<LibCrypto | null> => {
+  try {
+    const [glue, bytes] = await Promise.all([
+      fetchWasm(pthreadGlueArtifact),
+      fetchWasm(pthreadArtifact),
+    ]);
+    // pool_init may only take workers the module preloaded: pthread_create
+    // on the calling thread cannot wait for a new one to boot.
+    const workers = Math.min(wasmThreads, WASM_MAX_THREADS) - 1;
+    const script = new Blob([glue], { type: "text/javascript" });
+    const scriptUrl = URL.createObjectURL(script);
+    try {
+      const { default: factory } = (await import(
+        /* @vite-ignore */ /* webpackIgnore: true */ scriptUrl
+      )) as { default: typeof libcrypto };
+      const module = await factory({
+        wasmBinary: bytes,
+        wasmMemory,
+        getRandomValue: secureRandomUint32,
+        pthreadPoolSize: workers,
+        mainScriptUrlOrBlob: script,
+      });
+      // A worker that failed to start leaves fewer threads; _pool_threads()
+      // reports how many the module got, and one still runs every task.
+      module._pool_init(workers + 1);
+      trackCryptoStats(module);
+
+      return module;
+    } finally {
+      URL.revokeObjectURL(scriptUrl);
+    }
+  } catch {
+    return null;
+  }
+};
+
+/**
+ * `wasmLoader` for a module whose batches are worth spreading over threads.
+ * Its workers live as long as the module, so this is for the realm's shared
+ * module (sharedModule.ts), not per-operation ones. `wasmMemory` makes the
+ * module's memory: shared for the threaded artifact, unshared for the
+ * single-threaded fallback.
+ */
+export const wasmLoaderThreaded = async (
+  wasmMemory: (shared: boolean) => WebAssembly.Memory,
+) => {
+  wasmLoadStarted = true;
+  const threaded = supportsThreads()
+    ? await loadThreadedWasm(wasmMemory(true))
+    : null;
+
+  return threaded ?? (await wasmLoader(wasmMemory(false)));
+};
+
 export const wasmLoader = async (wasmMemory: WebAssembly.Memory) => {
   wasmLoadStarted = true;
-  // An explicit setWasmSourceUrl() is an instruction, not a hint: honour it
-  // even on Node rather than silently preferring the packaged copy.
   const bytes =
-    (localWasmEnabled && !wasmSourcePinned && isNodeLike()
-      ? await readLocalWasm()
-      : null) ?? (await fetchWasm());
+    (supportsSimd() ? await loadSimdWasm() : null) ??
+    (await localWasm(scalarArtifact)) ??
+    (await fetchWasm(scalarArtifact));
 
-  return await libcrypto({
+  const module = await libcrypto({
     wasmBinary: bytes,
     wasmMemory,
     getRandomValue: secureRandomUint32,
   });
+  trackCryptoStats(module);
+
+  return module;
 };
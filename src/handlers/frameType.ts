@@ -1,6 +1,8 @@
 import {
   FRAME_TYPE_LEN,
+  FRAME_TYPE_RANGE_RECEIPT,
   FRAME_TYPE_RECEIPT,
+  WIRE_RANGE_RECEIPT_FRAME_LEN,
   WIRE_RECEIPT_FRAME_LEN,
 } from "../utils/constants";
 
@@ -19,8 +21,10 @@ export const classifyFrame = (data: Uint8Array): ClassifiedFrame => {
   // A raw 64-byte legacy receipt can happen to begin with 0x03. Never accept
   // that as v3: receipt routing requires tag(1) || token(64), exactly.
   const type =
-    candidate === FRAME_TYPE_RECEIPT &&
-    data.length !== WIRE_RECEIPT_FRAME_LEN
+    (candidate === FRAME_TYPE_RECEIPT &&
+      data.length !== WIRE_RECEIPT_FRAME_LEN) ||
+    (candidate === FRAME_TYPE_RANGE_RECEIPT &&
+      data.length !== WIRE_RANGE_RECEIPT_FRAME_LEN)
       ? -1
       : candidate;
   return {
@@ -18,9 +18,12 @@ import {
 import { defaultRTCConfig, setPeer } from "../reducers/roomSlice";
 
 import cryptoMemory from "../cryptography/memory";
+import { attachSlab } from "../cryptography/slab";
 import { wasmLoader } from "../cryptography/wasmLoader";
 import { resetRatchetGate } from "./ratchetGate";
 import { claimRatchetPersistence } from "./ratchetPersist";
+import { createIngressRing } from "./messageChunkCrypto";
+import { RECEIVE_PROOF_CACHE_RESERVE_BYTES } from "./receiveProofCache";
 import { assertCanonicalEd25519Identity } from "../utils/identityRole";
 import { PROTOCOL_VERSION } from "../utils/constants";
 // import libcrypto from "../cryptography/libcrypto";
@@ -124,10 +127,16 @@ export const handleConnectToPeer = async (
       throw new Error("WebRTC transport was replaced during initialization");
   };
   const initialization = (async (): Promise<void> => {
-    const receiveMessageWasmMemory = cryptoMemory.protocolV3Memory();
+    const receiveMessageWasmMemory = cryptoMemory.protocolV3Memory(
+      RECEIVE_PROOF_CACHE_RESERVE_BYTES,
+    );
+    // One module per edge, so it stays single-threaded: a threaded module's
+    // workers are never stopped. Only sharedModule() takes that artifact.
     const receiveMessageModule = await wasmLoader(receiveMessageWasmMemory);
+    attachSlab(receiveMessageModule);
     assertStillReserved();
     epc.receiveMessageModule = receiveMessageModule;
+    epc.ingressRing = createIngressRing(receiveMessageModule);
 
     if (signalingServer.isConnected) {
       await api.dispatch(
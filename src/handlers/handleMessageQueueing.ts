@@ -1,5 +1,5 @@
 import {
-  handleReceiveMessage,
+  handleReceiveMessages,
   type ReceiveMessageResult,
 } from "./handleReceiveMessage";
 import {
@@ -12,6 +12,7 @@ import { queueScheduledReceipt } from "./coverTransfer";
 import { closeReceiveFile } from "../db/api";
 
 import { uint8ArrayToHex } from "../utils/uint8array";
+import { createChunkReceiptTokens } from "../utils/receiptToken";
 
 import {
   setMessage,
@@ -88,6 +89,13 @@ export const shouldSendImmediateTerminalReceipt = (
 ): boolean => epc?.coverRuntime === undefined;
 
 export const MAX_QUEUED_FRAMES_PER_CHANNEL = 64;
+// Receipts owed by one drain are sent at the latest every this many frames, a
+// quarter of the queue and half the sender's receipt window, so batching them
+// never holds the window shut.
+export const RECEIPT_FLUSH_FRAMES = MAX_QUEUED_FRAMES_PER_CHANNEL / 4;
+// Frames one drain step takes off the queue and hands to the receive handler
+// together, so frames riding a cached message key open in batched C calls.
+export const RECEIVE_DRAIN_FRAMES = RECEIPT_FLUSH_FRAMES;
 export const MAX_QUEUED_BYTES_PER_EDGE = 16 * 1024 * 1024;
 export const MAX_QUEUED_RECEIPTS_PER_CHANNEL = 2_048;
 export const MAX_QUEUED_RECEIPTS_PER_EDGE = 8_192;
@@ -289,34 +297,67 @@ export const enqueueReceipt = (
 
 type PerFrameReceiptResult = Pick<
   ReceiveMessageResult,
-  "chunkHash" | "chunkIndex" | "chunkSize" | "totalSize"
+  "leafHash" | "chunkIndex" | "chunkSize" | "totalSize"
 >;
 
+const isRealReceipt = (result: PerFrameReceiptResult): boolean =>
+  result.totalSize > 0 &&
+  result.leafHash.length === crypto_hash_sha512_BYTES &&
+  result.chunkIndex > -1 &&
+  result.chunkSize > 0;
+
 /**
- * Emit exactly one receipt-shaped frame for every inbound chunk frame. Real
- * cells use their rooted token; cover/dropped cells use an unlinkable random
- * token so an observer cannot infer which slot carried bytes.
+ * Emit exactly one receipt-shaped frame for every inbound chunk frame, in
+ * order. Real cells use their rooted token, derived for the whole batch in one
+ * `chunk_receipt_token_batch` call; cover/dropped cells use an unlinkable
+ * random token so an observer cannot infer which slot carried bytes. Returns
+ * the number of frames sent.
  */
-export const sendReceiveFrameReceipt = (
-  result: PerFrameReceiptResult,
+export const sendReceiveFrameReceipts = (
+  results: readonly PerFrameReceiptResult[],
   channel: IRTCDataChannel | undefined,
-): boolean => {
-  if (
-    result.totalSize > 0 &&
-    result.chunkHash.length === crypto_hash_sha512_BYTES &&
-    result.chunkIndex > -1 &&
-    result.chunkSize > 0
-  )
-    return channel ? sendReceiptFrame(channel, result.chunkHash) : false;
+  merkleRoot: Uint8Array,
+  module: LibCrypto,
+): number => {
+  const real = results.filter(isRealReceipt);
+  const leaves = new Uint8Array(real.length * crypto_hash_sha512_BYTES);
+  real.forEach((result, i) =>
+    leaves.set(result.leafHash, i * crypto_hash_sha512_BYTES),
+  );
+  const tokens = createChunkReceiptTokens(
+    merkleRoot,
+    real.map((result) => result.chunkIndex),
+    leaves,
+    module,
+  );
+
+  let sent = 0;
+  let next = 0;
+  try {
+    for (const result of results) {
+      if (isRealReceipt(result)) {
+        const token = tokens.subarray(
+          next * crypto_hash_sha512_BYTES,
+          ++next * crypto_hash_sha512_BYTES,
+        );
+        if (channel && sendReceiptFrame(channel, token)) sent++;
+        continue;
+      }
 
-  if (channel?.readyState !== "open") return false;
-  const decoyReceipt = new Uint8Array(crypto_hash_sha512_BYTES);
-  crypto.getRandomValues(decoyReceipt);
-  return sendReceiptFrame(channel, decoyReceipt);
+      if (channel?.readyState !== "open") continue;
+      const decoyReceipt = new Uint8Array(crypto_hash_sha512_BYTES);
+      crypto.getRandomValues(decoyReceipt);
+      if (sendReceiptFrame(channel, decoyReceipt)) sent++;
+    }
+  } finally {
+    tokens.fill(0);
+  }
+
+  return sent;
 };
 
-const processMessage = async (
-  data: Uint8Array,
+const processMessages = async (
+  frames: Uint8Array[],
   api: BaseQueryApi,
   roomId: string,
   peerId: string,
@@ -326,6 +367,7 @@ const processMessage = async (
   extChannel: IRTCDataChannel | undefined,
   epc: IRTCPeerConnection | undefined,
   receiveMessageModule: LibCrypto,
+  receipts: PerFrameReceiptResult[],
   signal?: AbortSignal,
 ): Promise<{ receivedFullSize: boolean }> => {
   if (signal?.aborted) return { receivedFullSize: false };
@@ -347,8 +389,8 @@ const processMessage = async (
       )
         return { receivedFullSize: false };
 
-      const receiveResult = await handleReceiveMessage(
-        data,
+      const receiveResults = await handleReceiveMessages(
+        frames,
         roomId,
         channelLabel,
         epc,
@@ -356,94 +398,112 @@ const processMessage = async (
         receiveMessageModule,
         signal,
       );
-      const {
-        date,
-        chunkSize,
-        chunkIndex,
-        receivedFullSize,
-        chunkAlreadyExists,
-        totalSize,
-        messageType,
-        filename,
-        messageHash,
-      } = receiveResult;
-
-      if (signal?.aborted) return { receivedFullSize: false };
-
-      // Immediate mode acks each frame with a 65-byte receipt on its channel.
-      // Scheduled mode never uses immediate receipts: acknowledgement rides a
-      // cover slot instead (a terminal receipt on completion, below).
-      if (!epc?.coverRuntime) sendReceiveFrameReceipt(receiveResult, extChannel);
-
-      const hashHex = uint8ArrayToHex(messageHash);
-
-      if (receivedFullSize) {
-        // Scheduled mode: confirm the whole message with ONE terminal receipt
-        // cover cell (token == transfer root) so the sender's send resolves.
-        // It substitutes into a reverse cover slot, never an immediate frame.
-        if (epc?.coverRuntime)
-          queueScheduledReceipt(epc, merkleRoot, merkleRoot);
-      }
-
-      if (receivedFullSize) {
-        // Flush + close the OPFS write handle before flipping the UI to 100% so
-        // readMessage can open the finished file without hitting the write lock.
-        // No-op for text (no handle) and for a re-observed completion.
-        await closeReceiveFile(merkleRootHex);
-
+      let anyFullSize = false;
+      for (const receiveResult of receiveResults) {
+        const {
+          date,
+          chunkSize,
+          chunkIndex,
+          receivedFullSize,
+          chunkAlreadyExists,
+          totalSize,
+          messageType,
+          filename,
+          messageHash,
+        } = receiveResult;
+
+        if (signal?.aborted) return { receivedFullSize: false };
+
+        // Immediate mode acks each frame with a 65-byte receipt on its channel,
+        // sent with the rest of the drain's receipts; the chunk receipts go out
+        // before a terminal one. Scheduled mode never uses immediate receipts:
+        // acknowledgement rides a cover slot instead (a terminal receipt on
+        // completion, below).
+        if (!epc?.coverRuntime) {
+          receipts.push(receiveResult);
+          if (receipts.length >= RECEIPT_FLUSH_FRAMES || receivedFullSize)
+            sendReceiveFrameReceipts(
+              receipts.splice(0),
+              extChannel,
+              merkleRoot,
+              receiveMessageModule,
+            );
+        }
+
+        const hashHex = uint8ArrayToHex(messageHash);
+
+        if (receivedFullSize) {
+          // Scheduled mode: confirm the whole message with ONE terminal receipt
+          // cover cell (token == transfer root) so the sender's send resolves.
+          // It substitutes into a reverse cover slot, never an immediate frame.
+          if (epc?.coverRuntime)
+            queueScheduledReceipt(epc, merkleRoot, merkleRoot);
+        }
+
+        if (receivedFullSize) {
+          // Flush + close the OPFS write handle before flipping the UI to 100%
+          // so readMessage can open the finished file without hitting the
+          // write lock. No-op for text (no handle) and for a re-observed
+          // completion.
+          await closeReceiveFile(merkleRootHex);
+
+          api.dispatch(
+            setMessageAllChunks({
+              roomId,
+              merkleRootHex,
+              sha512Hex: hashHex,
+              fromPeerId: peerId,
+              totalSize,
+              messageType,
+              filename,
+              channelLabel,
+              timestamp: date.getTime(),
+              alsoSendFinishedMessage: true,
+            }),
+          );
+
+          // Scheduled mode already queued the terminal receipt as a cover cell
+          // above; emitting this immediate 65-byte frame as well would put an
+          // off-schedule, distinctively sized packet on the wire at the exact
+          // instant a real transfer completed — correlated with the event the
+          // cover schedule exists to hide. (It was also inert: the sender never
+          // attaches a message handler to the cover lane it arrives on.)
+          if (shouldSendImmediateTerminalReceipt(epc) && extChannel)
+            sendReceiptFrame(extChannel, messageHash);
+        } else if (chunkSize > 0 && chunkIndex > -1 && !chunkAlreadyExists) {
+          api.dispatch(
+            setMessage({
+              roomId,
+              merkleRootHex,
+              sha512Hex: hashHex,
+              fromPeerId: peerId,
+              chunkSize,
+              totalSize,
+              messageType,
+              filename,
+              channelLabel,
+              timestamp: date.getTime(),
+            }),
+          );
+        }
+
+        // Telemetry: count every frame received (incl. decoys), flag the
+        // reals — lets the UI show total ≫ real (the obfuscation working).
+        // Dispatched AFTER the message is created above so the increment
+        // lands. Progress % stays over the real message (savedSize /
+        // totalSize), unchanged.
         api.dispatch(
-          setMessageAllChunks({
+          incrementMessageStats({
             roomId,
             merkleRootHex,
-            sha512Hex: hashHex,
-            fromPeerId: peerId,
-            totalSize,
-            messageType,
-            filename,
-            channelLabel,
-            timestamp: date.getTime(),
-            alsoSendFinishedMessage: true,
+            real: chunkSize > 0 && chunkIndex > -1 && !chunkAlreadyExists,
           }),
         );
 
-        // Scheduled mode already queued the terminal receipt as a cover cell
-        // above; emitting this immediate 65-byte frame as well would put an
-        // off-schedule, distinctively sized packet on the wire at the exact
-        // instant a real transfer completed — correlated with the event the
-        // cover schedule exists to hide. (It was also inert: the sender never
-        // attaches a message handler to the cover lane it arrives on.)
-        if (shouldSendImmediateTerminalReceipt(epc) && extChannel)
-          sendReceiptFrame(extChannel, messageHash);
-      } else if (chunkSize > 0 && chunkIndex > -1 && !chunkAlreadyExists) {
-        api.dispatch(
-          setMessage({
-            roomId,
-            merkleRootHex,
-            sha512Hex: hashHex,
-            fromPeerId: peerId,
-            chunkSize,
-            totalSize,
-            messageType,
-            filename,
-            channelLabel,
-            timestamp: date.getTime(),
-          }),
-        );
+        if (receivedFullSize) anyFullSize = true;
       }
 
-      // Telemetry: count every frame received (incl. decoys), flag the reals —
-      // lets the UI show total ≫ real (the obfuscation working). Dispatched
-      // AFTER the message is created above so the increment lands. Progress %
-      // stays over the real message (savedSize / totalSize), unchanged.
-      api.dispatch(
-        incrementMessageStats({
-          roomId,
-          merkleRootHex,
-          real: chunkSize > 0 && chunkIndex > -1 && !chunkAlreadyExists,
-        }),
-      );
-
-      return { receivedFullSize };
+      return { receivedFullSize: anyFullSize };
     } catch (error) {
       console.error(error);
 
@@ -472,17 +532,22 @@ const drain = async (
   if (drainingRef.value || drainingRef.released || signal?.aborted) return;
   drainingRef.value = true;
   const lockKey = edgeQueueKey(roomId, peerId);
+  const receipts: PerFrameReceiptResult[] = [];
   try {
     for (;;) {
       if (drainingRef.released || signal?.aborted) break;
-      const chunk = queue.pop();
-      if (!chunk) break;
-      adjustQueuedBytes(queue, roomId, peerId, -chunk.byteLength);
+      // Same order as popping them one by one.
+      const frames = queue
+        .splice(-Math.min(queue.length, RECEIVE_DRAIN_FRAMES))
+        .reverse();
+      if (frames.length === 0) break;
+      for (const frame of frames)
+        adjustQueuedBytes(queue, roomId, peerId, -frame.byteLength);
 
       // const { receivedFullSize } =
       await withProcessingLock(lockKey, async () =>
-        processMessage(
-          chunk,
+        processMessages(
+          frames,
           api,
           roomId,
           peerId,
@@ -492,6 +557,7 @@ const drain = async (
           extChannel,
           epc,
           receiveMessageModule,
+          receipts,
           signal,
         ),
       );
@@ -503,6 +569,19 @@ const drain = async (
       //   break;
       // }
     }
+
+    if (receipts.length > 0 && !drainingRef.released && !signal?.aborted) {
+      try {
+        sendReceiveFrameReceipts(
+          receipts,
+          extChannel,
+          merkleRoot,
+          receiveMessageModule,
+        );
+      } catch (error) {
+        console.error(error);
+      }
+    }
   } finally {
     drainingRef.value = false;
     if (
@@ -1,5 +1,5 @@
 import { debugLog } from "../utils/debug";
-import { handleReadReceipt } from "./handleReadReceipt";
+import { handleRangeReceipt, handleReadReceipt } from "./handleReadReceipt";
 import {
   createReceiptProcessingQueue,
   enqueue,
@@ -18,9 +18,11 @@ import {
 import { buildChannelInput } from "./handshakeCore";
 import { classifyFrame } from "./frameType";
 import {
-  RECEIPT_REPLAY_BATCH_SIZE,
+  encodeRangeReceiptFrame,
+  encodeReceiptFrame,
+  decodeRangeReceiptPayload,
+  sendEncodedFramesPaced,
   sendReceiptFrame,
-  sendReceiptFramesPaced,
 } from "./receiptFrame";
 import {
   getRatchetGate,
@@ -56,7 +58,10 @@ import {
 } from "../db/api";
 
 import { hexToUint8Array } from "../utils/uint8array";
-import { createChunkReceiptToken } from "../utils/receiptToken";
+import {
+  createChunkRangeReceiptToken,
+  createChunkReceiptTokens,
+} from "../utils/receiptToken";
 import { getRoomPin } from "../roomPinVault";
 import { hashRoomPolicyV1 } from "../roomPolicy";
 import {
@@ -66,11 +71,14 @@ import {
 } from "../roomPinAttempts";
 import { decompileChannelMessageLabel } from "../utils/channelLabel";
 import {
+  CHUNK_RANGE_RECEIPT_MAX_CHUNKS,
   FRAME_TYPE_CHUNK,
   FRAME_TYPE_COVER,
   FRAME_TYPE_HANDSHAKE,
   FRAME_TYPE_PQ_CONTROL,
+  FRAME_TYPE_RANGE_RECEIPT,
   FRAME_TYPE_RECEIPT,
+  RECEIPT_TOKEN_LEN,
   WIRE_CHUNK_FRAME_LEN,
 } from "../utils/constants";
 import {
@@ -552,20 +560,38 @@ export const handleOpenChannel = async (
     }
 
     const classified = classifyFrame(data);
-    if (extChannel.label !== "main" && classified.type === FRAME_TYPE_RECEIPT) {
+    if (
+      extChannel.label !== "main" &&
+      (classified.type === FRAME_TYPE_RECEIPT ||
+        classified.type === FRAME_TYPE_RANGE_RECEIPT)
+    ) {
+      // One queue drains both kinds, so the payload length picks the handler:
+      // a 64-byte token or first ‖ count ‖ token for a range.
       const accepted = enqueueReceipt(
         classified.payload,
         receiptQueue,
         async (receipt) => {
           if (!isRatchetGateOpen(roomId, epc.withPeerId, transportGateLease))
             return;
-          await handleReadReceipt(
-            receipt,
-            extChannel.label,
-            extChannel.withPeerId,
-            roomId,
-            api,
-          );
+          if (receipt.length === RECEIPT_TOKEN_LEN) {
+            await handleReadReceipt(
+              receipt,
+              extChannel.label,
+              extChannel.withPeerId,
+              roomId,
+              api,
+            );
+            return;
+          }
+          const range = decodeRangeReceiptPayload(receipt);
+          if (range)
+            await handleRangeReceipt(
+              range,
+              extChannel.label,
+              extChannel.withPeerId,
+              roomId,
+              api,
+            );
         },
       );
       if (!accepted) {
@@ -943,11 +969,11 @@ export const handleOpenChannel = async (
     // "main" carries no merkleRoot, and the sender OPENED this channel (string
     // arg) so `channel` is an RTCDataChannel object only on the receiver's end.
     //
-    // OBJ-4 CAVEAT (known, deferred): this burst emits one receipt per REAL
-    // chunk held (decoys are never stored), so unlike live operation — where
-    // every frame, real or decoy, draws a receipt (1:1) — the reconnect burst's
-    // length reveals the real-chunk count to a passive DTLS traffic-analysis
-    // observer. Same category as the already-deferred obj-4 timing/relay gaps;
+    // OBJ-4 CAVEAT (known, deferred): this burst emits one receipt per run of
+    // REAL chunks held (decoys are never stored), so unlike live operation —
+    // where every frame, real or decoy, draws a receipt (1:1) — the reconnect
+    // burst's shape hints at the real-chunk count to a passive DTLS
+    // traffic-analysis observer. Same category as the already-deferred obj-4 timing/relay gaps;
     // the obj-4 hardening layer should pace these 1:1 with forward frames or pad
     // with decoy receipts. Content stays confidential (DTLS); only a size hint
     // leaks, only on reconnect.
@@ -958,27 +984,86 @@ export const handleOpenChannel = async (
           const stored = await getDBAllChunkLeafHashes(merkleRootHex);
           if (stored.length === 0) return;
 
-          let receiptBatch: Uint8Array[] = [];
-          for (const { chunkIndex, leafHash } of stored) {
-            if (leafHash?.length !== crypto_hash_sha512_BYTES * 2) continue;
-            receiptBatch.push(
-              await createChunkReceiptToken(
-                merkleRoot,
-                chunkIndex,
-                hexToUint8Array(leafHash),
-              ),
+          // Walk the held chunks in index order. Each contiguous run goes out
+          // as one range receipt (capped per frame); lone chunks keep their
+          // per-chunk receipts, whose tokens are computed in one C call.
+          const held = stored
+            .filter(
+              ({ leafHash }) =>
+                leafHash?.length === crypto_hash_sha512_BYTES * 2,
+            )
+            .sort((a, b) => a.chunkIndex - b.chunkIndex);
+          const frames: Uint8Array[] = [];
+          const singles: number[] = [];
+          const singleLeaves: Uint8Array[] = [];
+          const flushSingles = (): void => {
+            if (singles.length === 0) return;
+            const leaves = new Uint8Array(
+              singles.length * crypto_hash_sha512_BYTES,
             );
-            if (receiptBatch.length === RECEIPT_REPLAY_BATCH_SIZE) {
-              if (!(await sendReceiptFramesPaced(extChannel, receiptBatch)))
-                return;
-              receiptBatch = [];
+            singleLeaves.forEach((leaf, i) =>
+              leaves.set(leaf, i * crypto_hash_sha512_BYTES),
+            );
+            const tokens = createChunkReceiptTokens(
+              merkleRoot,
+              singles,
+              leaves,
+              epc.receiveMessageModule,
+            );
+            for (let i = 0; i < singles.length; i++)
+              frames.push(
+                encodeReceiptFrame(
+                  tokens.subarray(
+                    i * crypto_hash_sha512_BYTES,
+                    (i + 1) * crypto_hash_sha512_BYTES,
+                  ),
+                ),
+              );
+            singles.length = 0;
+            singleLeaves.length = 0;
+          };
+
+          for (let start = 0; start < held.length; ) {
+            let end = start + 1;
+            while (
+              end < held.length &&
+              end - start < CHUNK_RANGE_RECEIPT_MAX_CHUNKS &&
+              held[end].chunkIndex === held[end - 1].chunkIndex + 1
+            )
+              end++;
+
+            if (end - start === 1) {
+              singles.push(held[start].chunkIndex);
+              singleLeaves.push(hexToUint8Array(held[start].leafHash));
+              if (singles.length === CHUNK_RANGE_RECEIPT_MAX_CHUNKS)
+                flushSingles();
+            } else {
+              const leaves = new Uint8Array(
+                (end - start) * crypto_hash_sha512_BYTES,
+              );
+              for (let i = start; i < end; i++)
+                leaves.set(
+                  hexToUint8Array(held[i].leafHash),
+                  (i - start) * crypto_hash_sha512_BYTES,
+                );
+              frames.push(
+                encodeRangeReceiptFrame({
+                  first: held[start].chunkIndex,
+                  count: end - start,
+                  token: createChunkRangeReceiptToken(
+                    merkleRoot,
+                    held[start].chunkIndex,
+                    leaves,
+                    epc.receiveMessageModule,
+                  ),
+                }),
+              );
             }
+            start = end;
           }
-          if (
-            receiptBatch.length > 0 &&
-            !(await sendReceiptFramesPaced(extChannel, receiptBatch))
-          )
-            return;
+          flushSingles();
+
+          if (!(await sendEncodedFramesPaced(extChannel, frames))) return;
 
           // If we already hold the whole message, re-emit the final message-hash
           // receipt too, so the sender reaches completion and closes cleanly.
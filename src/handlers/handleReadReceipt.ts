@@ -2,9 +2,15 @@ import { getDBNewChunkByReceipt } from "../db/api";
 
 import { decompileChannelMessageLabel } from "../utils/channelLabel";
 import { uint8ArrayToHex } from "../utils/uint8array";
-import { markChunkAcked, markTransferComplete } from "./reconcile";
+import {
+  getRangeReceiptVerifier,
+  markChunkAcked,
+  markChunkRangeAcked,
+  markTransferComplete,
+} from "./reconcile";
 
 import type { BaseQueryApi } from "@reduxjs/toolkit/query";
+import type { RangeReceipt } from "./receiptFrame";
 import type { State } from "../store";
 
 export type ReadReceiptOutcome =
@@ -19,6 +25,14 @@ export type ReadReceiptOutcome =
       chunkIndex: number;
       newlyAccepted: boolean;
     }
+  | {
+      kind: "range-acked";
+      peerId: string;
+      transferId: string;
+      first: number;
+      count: number;
+      newlyAccepted: number;
+    }
   | {
       kind: "peer-complete";
       peerId: string;
@@ -105,3 +119,48 @@ export const handleReadReceipt = async (
     throw error;
   }
 };
+
+/**
+ * A range receipt acknowledges [first, first + count) with one token. It is
+ * checked in C against the leaves of the transfer's live Merkle tree, so no
+ * staged chunk is read; once the send has finished there is no tree and the
+ * receipt is ignored.
+ */
+export const handleRangeReceipt = async (
+  receipt: RangeReceipt,
+  channel: string,
+  peerId: string,
+  roomId: string,
+  api: BaseQueryApi,
+): Promise<ReadReceiptOutcome> => {
+  const { merkleRootHex } = await decompileChannelMessageLabel(channel);
+
+  const { rooms } = api.getState() as State;
+  const room = rooms.find((candidate) => candidate.id === roomId);
+  if (!room) return { kind: "ignored", peerId };
+
+  const message = room.messages.findLast(
+    (m) => m.merkleRootHex === merkleRootHex,
+  );
+  const transferId = message?.transferId;
+  if (!transferId) return { kind: "ignored", peerId };
+
+  const verify = getRangeReceiptVerifier(transferId);
+  if (!verify?.(receipt.first, receipt.count, receipt.token))
+    return { kind: "ignored", peerId };
+
+  return {
+    kind: "range-acked",
+    peerId,
+    transferId,
+    first: receipt.first,
+    count: receipt.count,
+    newlyAccepted: markChunkRangeAcked(
+      room.id,
+      peerId,
+      transferId,
+      receipt.first,
+      receipt.count,
+    ),
+  };
+};
@@ -2,13 +2,15 @@ import { assertMetadataV1, deserializeMetadata } from "../utils/metadata";
 import { getMimeType, MessageType } from "../utils/messageTypes";
 import { uint8ArrayToHex } from "../utils/uint8array";
 import { isStorableChunkRange } from "../utils/chunkBounds";
-import { createChunkReceiptToken } from "../utils/receiptToken";
 import { MESSAGE_LEN, METADATA_LEN, PROOF_LEN } from "../utils/constants";
 import { crypto_hash_sha512_BYTES } from "../cryptography/interfaces";
 
-import { messageCacheKey } from "./messageChunkCrypto";
+import { discardDecrypted, messageCacheKey } from "./messageChunkCrypto";
 import { parseChunkFrameHeader } from "./chunkFrame";
-import { decryptMessageChunkDurably } from "./ratchetPersist";
+import {
+  decryptCachedMessageChunksDurably,
+  decryptMessageChunkDurably,
+} from "./ratchetPersist";
 import { bindReceiveMessageKey } from "./receiveMessageKeyLifetime";
 
 import { storeReceiveChunk as persistReceiveChunk } from "../db/api";
@@ -16,6 +18,7 @@ import { storeReceiveChunk as persistReceiveChunk } from "../db/api";
 import type { LibCrypto } from "../cryptography/libcrypto";
 import type { IRTCPeerConnection } from "../api/webrtc/interfaces";
 import type { ReceiveChunk, ReceiveChunkStoreResult } from "../db/types";
+import type { DecryptedChunk } from "./messageChunkCrypto";
 import type { PersistRatchetState } from "./ratchetPersist";
 
 export interface ReceiveMessageResult {
@@ -27,8 +30,12 @@ export interface ReceiveMessageResult {
   totalSize: number;
   messageType: number;
   filename: string;
-  /** 64-byte root/index/leaf-bound receipt token (legacy field name). */
-  chunkHash: Uint8Array;
+  /**
+   * The chunk's 64-byte Merkle leaf. The queueing layer turns the leaves of
+   * the frames it drained into root/index/leaf-bound receipt tokens in one
+   * batched call (`sendReceiveFrameReceipts`).
+   */
+  leafHash: Uint8Array;
   messageHash: Uint8Array;
 }
 
@@ -44,7 +51,7 @@ const dropped = (): ReceiveMessageResult => ({
   totalSize: 0,
   messageType: MessageType.Text,
   filename: "",
-  chunkHash: new Uint8Array(),
+  leafHash: new Uint8Array(),
   messageHash: new Uint8Array(),
 });
 
@@ -79,6 +86,62 @@ export const storeReceiveChunkFailClosed = async (
   }
 };
 
+// The per-edge receive-key cache. v4: it IS the PQ runtime's active combined
+// receive-key collection (aliased at handshake activation) so every persisted
+// edge checkpoint carries it. The bare-Map fallback serves runtime-free
+// bootstrap/unit-test edges only.
+//
+// Anti-DoS backstop: a normally closed complete message is retired after its
+// queue drains, but a peer could pin keys with never-completing messages.
+// Bound the per-edge cache BEFORE the durable decrypt (oldest first, Map
+// insertion order) so the staged active-key map can never exceed the
+// encrypted edge checkpoint's key budget.
+const MESSAGE_KEY_CACHE_MAX = 256;
+const boundedReceiveKeyCache = (
+  epc: IRTCPeerConnection,
+): Map<string, Uint8Array> => {
+  if (!epc.messageKeyCache)
+    epc.messageKeyCache =
+      epc.pqHealingState?.activeReceiveKeys ??
+      new Map<string, Uint8Array>();
+  const cache = epc.messageKeyCache;
+
+  if (cache.size >= MESSAGE_KEY_CACHE_MAX) {
+    for (const k of cache.keys()) {
+      if (cache.size < MESSAGE_KEY_CACHE_MAX) break;
+      cache.get(k)?.fill(0);
+      cache.delete(k);
+      if (epc.messageKeyByMerkleRoot) {
+        for (const [root, mappedKey] of epc.messageKeyByMerkleRoot) {
+          if (mappedKey === k) epc.messageKeyByMerkleRoot.delete(root);
+        }
+      }
+    }
+  }
+
+  return cache;
+};
+
+// The per-message cache key (dhPub, N, pqEpoch). It stays live through
+// channel drain: the real cell can complete storage before later valid cover
+// cells arrive. Production identity is epoch-bound; the two-field form is
+// the runtime-free bootstrap path. Undefined means the frame is malformed.
+const frameCacheKey = (
+  epc: IRTCPeerConnection,
+  frame: Uint8Array,
+): string | undefined => {
+  try {
+    const { header, pqEpoch } = parseChunkFrameHeader(frame);
+    return messageCacheKey(
+      header.dhPub,
+      header.N,
+      epc.pqHealingState ? pqEpoch : undefined,
+    );
+  } catch {
+    return undefined;
+  }
+};
+
 // ── protocol-v3 receive (Stage-5 task 3) ─────────────────────────────────────────
 // Decrypt one inbound v3 CHUNK frame off the seeded Double Ratchet (replacing the
 // authenticated v3 receive path), verify its Merkle proof, and store real bytes.
@@ -109,50 +172,9 @@ export const handleReceiveMessage = async (
     console.error("v3 receive: no ratchet state for peer");
     return dropped();
   }
-  // v4: the per-edge cache IS the PQ runtime's active combined receive-key
-  // collection (aliased at handshake activation) so every persisted edge
-  // checkpoint carries it. The bare-Map fallback serves runtime-free
-  // bootstrap/unit-test edges only.
-  if (!epc.messageKeyCache)
-    epc.messageKeyCache =
-      epc.pqHealingState?.activeReceiveKeys ??
-      new Map<string, Uint8Array>();
-  const cache = epc.messageKeyCache;
-
-  // The per-message cache key (dhPub, N, pqEpoch). It stays live through
-  // channel drain: the real cell can complete storage before later valid cover
-  // cells arrive. Production identity is epoch-bound; the two-field form is
-  // the runtime-free bootstrap path.
-  let cacheKey: string | undefined;
-  try {
-    const { header, pqEpoch } = parseChunkFrameHeader(frame);
-    cacheKey = messageCacheKey(
-      header.dhPub,
-      header.N,
-      epc.pqHealingState ? pqEpoch : undefined,
-    );
-  } catch {
-    return dropped();
-  }
-
-  // Anti-DoS backstop: a normally closed complete message is retired after its
-  // queue drains, but a peer could pin keys with never-completing messages.
-  // Bound the per-edge cache BEFORE the durable decrypt (oldest first, Map
-  // insertion order) so the staged active-key map can never exceed the
-  // encrypted edge checkpoint's key budget.
-  const MESSAGE_KEY_CACHE_MAX = 256;
-  if (cache.size >= MESSAGE_KEY_CACHE_MAX) {
-    for (const k of cache.keys()) {
-      if (cache.size < MESSAGE_KEY_CACHE_MAX) break;
-      cache.get(k)?.fill(0);
-      cache.delete(k);
-      if (epc.messageKeyByMerkleRoot) {
-        for (const [root, mappedKey] of epc.messageKeyByMerkleRoot) {
-          if (mappedKey === k) epc.messageKeyByMerkleRoot.delete(root);
-        }
-      }
-    }
-  }
+  const cache = boundedReceiveKeyCache(epc);
+  const cacheKey = frameCacheKey(epc, frame);
+  if (cacheKey === undefined) return dropped();
 
   // 1) Derive/decrypt against a staged clone, then persist and adopt the
   //    authenticated successor before exposing any plaintext. The per-edge lock
@@ -160,10 +182,9 @@ export const handleReceiveMessage = async (
   //    PQ runtime the staged combined key is persisted inside the encrypted
   //    edge checkpoint (same row as the ratchet successor), never in the
   //    classical skipped map.
-  let decrypted: Uint8Array | null;
-  let ok: boolean;
+  let received: DecryptedChunk;
   try {
-    const d = await decryptMessageChunkDurably(
+    received = await decryptMessageChunkDurably(
       epc,
       roomId,
       frame,
@@ -172,16 +193,137 @@ export const handleReceiveMessage = async (
       module,
       dependencies.persistRatchetState,
     );
-    decrypted = d.decrypted;
-    ok = d.ok;
   } catch (error) {
     console.error("Could not durably decrypt message", error);
     return dropped();
   }
 
+  return storeDecryptedChunk(
+    received,
+    cacheKey,
+    roomId,
+    channelLabel,
+    epc,
+    merkleRoot,
+    signal,
+    dependencies,
+  );
+};
+
+/**
+ * `handleReceiveMessage` for the frames one queue drain pulled, in order. Runs
+ * of two or more frames whose per-message key is already cached never step the
+ * ratchet, so they are opened together by `decryptCachedMessageChunksDurably`
+ * (batched `_receive_message_batch` calls under one edge lock); every other
+ * frame still takes the per-frame durable decrypt. The store tail runs per
+ * frame either way, so results match the per-frame handler one for one.
+ */
+export const handleReceiveMessages = async (
+  frames: Uint8Array[],
+  roomId: string,
+  channelLabel: string,
+  epc: IRTCPeerConnection,
+  merkleRoot: Uint8Array,
+  module: LibCrypto,
+  signal?: AbortSignal,
+  dependencies: ReceiveMessageDependencies = {},
+): Promise<ReceiveMessageResult[]> => {
+  if (!epc.ratchetState) {
+    console.error("v3 receive: no ratchet state for peer");
+    return frames.map(() => dropped());
+  }
+  const results: ReceiveMessageResult[] = [];
+  const cache = boundedReceiveKeyCache(epc);
+  const cacheKeys = frames.map((frame) => frameCacheKey(epc, frame));
+  // A first chunk publishes its key, so hits are re-checked per frame.
+  const isHit = (i: number): boolean => {
+    const cacheKey = cacheKeys[i];
+    return cacheKey !== undefined && cache.has(cacheKey);
+  };
+
+  for (let i = 0; i < frames.length; ) {
+    let end = i;
+    while (end < frames.length && isHit(end)) end++;
+
+    if (end - i < 2) {
+      results.push(
+        await handleReceiveMessage(
+          frames[i],
+          roomId,
+          channelLabel,
+          epc,
+          merkleRoot,
+          module,
+          signal,
+          dependencies,
+        ),
+      );
+      i++;
+      continue;
+    }
+
+    if (signal?.aborted) {
+      for (; i < end; i++) results.push(dropped());
+      continue;
+    }
+
+    let opened: DecryptedChunk[];
+    try {
+      opened = await decryptCachedMessageChunksDurably(
+        epc,
+        roomId,
+        frames.slice(i, end),
+        cache,
+        merkleRoot,
+        module,
+        dependencies.persistRatchetState,
+      );
+    } catch (error) {
+      console.error("Could not durably decrypt message", error);
+      for (; i < end; i++) results.push(dropped());
+      continue;
+    }
+
+    try {
+      for (const received of opened) {
+        results.push(
+          await storeDecryptedChunk(
+            received,
+            cacheKeys[i++] as string,
+            roomId,
+            channelLabel,
+            epc,
+            merkleRoot,
+            signal,
+            dependencies,
+          ),
+        );
+      }
+    } finally {
+      // Plaintexts the tail never reached (it threw) are still secret.
+      opened.forEach(discardDecrypted);
+    }
+  }
+
+  return results;
+};
+
+// Steps 2-3 of the receive: check the decrypt, bind the message key to its
+// transfer, split the plaintext, and store the real bytes. Owns `received`.
+const storeDecryptedChunk = async (
+  received: DecryptedChunk,
+  cacheKey: string,
+  roomId: string,
+  channelLabel: string,
+  epc: IRTCPeerConnection,
+  merkleRoot: Uint8Array,
+  signal: AbortSignal | undefined,
+  dependencies: ReceiveMessageDependencies,
+): Promise<ReceiveMessageResult> => {
   // 2) A drop (AEAD auth OR Merkle proof failed inside the C call, or a stale-chain
   //    replay) → emit a decoy receipt, don't store.
-  if (!ok || !decrypted) {
+  const decrypted = received.decrypted;
+  if (!received.ok || !decrypted) {
     console.error("Could not decrypt or verify message");
     return dropped();
   }
@@ -195,8 +337,8 @@ export const handleReceiveMessage = async (
     if (signal?.aborted) return dropped();
 
     // 3) Split the C output: metadata ‖ receiptLeaf ‖ chunk. The C wrote the
-    //    leaf hash SHA-512(0x00 ‖ chunk) over the proof region; that is the
-    //    receipt token, so no second hash is computed here.
+    //    leaf hash SHA-512(0x00 ‖ chunk) over the proof region; the receipt
+    //    token is derived from it, so no second hash is computed here.
     const metadataArray = decrypted.subarray(0, METADATA_LEN);
     const leafHash = decrypted.slice(
       METADATA_LEN,
@@ -222,7 +364,7 @@ export const handleReceiveMessage = async (
       totalSize: metadata.totalSize,
       messageType: metadata.messageType,
       filename: metadata.name,
-      chunkHash: leafHash,
+      leafHash,
       messageHash: metadata.hash,
     });
 
@@ -239,15 +381,7 @@ export const handleReceiveMessage = async (
     )
       return rejectedResult();
 
-    const receiptToken = await createChunkReceiptToken(
-      merkleRoot,
-      metadata.chunkIndex,
-      leafHash,
-    );
-    if (signal?.aborted) {
-      receiptToken.fill(0);
-      return dropped();
-    }
+    if (signal?.aborted) return dropped();
     const mimeType = getMimeType(metadata.messageType);
     // Create this owned plaintext copy only once all fallible preprocessing is
     // done; storeReceiveChunkFailClosed assumes ownership and always wipes it.
@@ -280,16 +414,10 @@ export const handleReceiveMessage = async (
       realChunk,
       dependencies.storeReceiveChunk,
     );
-    if (!progress) {
-      receiptToken.fill(0);
-      return dropped();
-    }
-    if (signal?.aborted) {
-      // The worker write may already have crossed its durability boundary.
-      // cancelReceiveTransfer queues a locked delete after this handler exits.
-      receiptToken.fill(0);
-      return dropped();
-    }
+    if (!progress) return dropped();
+    // The worker write may already have crossed its durability boundary.
+    // cancelReceiveTransfer queues a locked delete after this handler exits.
+    if (signal?.aborted) return dropped();
 
     // `complete` comes from the same transaction that inserted/deduplicated
     // the chunk and updated messageData. A duplicate of an incomplete message
@@ -306,15 +434,16 @@ export const handleReceiveMessage = async (
       totalSize: metadata.totalSize,
       messageType: metadata.messageType,
       filename: metadata.name,
-      chunkHash: receiptToken,
+      leafHash,
       messageHash: metadata.hash,
     };
   } catch (error) {
     console.error("Could not parse or store decrypted message", error);
     return dropped();
   } finally {
-    // `receiveWithKey` returned an owned plaintext copy. All returned metadata
-    // and receipt fields are independent slices, so erase the padded body now.
-    decrypted.fill(0);
+    // The plaintext is an owned copy or a view of an ingress ring slot. All
+    // returned metadata and receipt fields are independent slices, so erase
+    // the padded body (and release its slot) now.
+    discardDecrypted(received);
   }
 };
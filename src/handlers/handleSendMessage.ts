@@ -2,20 +2,16 @@ import { debugLog } from "../utils/debug";
 import { handleOpenChannel } from "./handleOpenChannel";
 
 import { fisherYatesShuffle } from "../cryptography/utils";
-import { getMerkleProof } from "../cryptography/merkle";
+import { createMerkleTree } from "../cryptography/merkle";
 import {
   crypto_hash_sha512_BYTES,
   crypto_sign_ed25519_PUBLICKEYBYTES,
 } from "../cryptography/interfaces";
 
-import {
-  concatUint8Arrays,
-  hexToUint8Array,
-  uint8ArrayToHex,
-} from "../utils/uint8array";
+import { hexToUint8Array, uint8ArrayToHex } from "../utils/uint8array";
 import { splitToChunks } from "../utils/splitToChunks";
-import { deserializeMetadata } from "../utils/metadata";
-import { createChunkReceiptToken } from "../utils/receiptToken";
+import { deserializeMetadata, setMetadataHash } from "../utils/metadata";
+import { createChunkReceiptTokenTable } from "../utils/receiptToken";
 import {
   compileChannelMessageLabel,
   decompileChannelMessageLabel,
@@ -27,9 +23,11 @@ import {
   waitForCompletion,
   getAckedChunks,
   getAckedChunkCount,
+  setRangeReceiptVerifier,
+  clearRangeReceiptVerifier,
 } from "./reconcile";
 import { MAX_QUEUED_FRAMES_PER_CHANNEL } from "./handleMessageQueueing";
-import { sealChunk } from "./messageChunkCrypto";
+import { sealMessageChunk } from "./messageChunkCrypto";
 import { getRatchetGate } from "./ratchetGate";
 import { isPqApplicationTrafficBlocked } from "./pqHealingOrchestrator";
 import { enqueueScheduledSend, trackScheduledSend } from "./coverEdge";
@@ -66,6 +64,7 @@ import type {
   IRTCPeerConnection,
 } from "../api/webrtc/interfaces";
 import type { LibCrypto } from "../cryptography/libcrypto";
+import type { MerkleTree } from "../cryptography/merkle";
 import type { PqMessageKeyContext } from "../cryptography/pqMessageKey";
 import type { RatchetHeader } from "../cryptography/ratchet";
 import type { BaseQueryApi } from "@reduxjs/toolkit/query";
@@ -125,18 +124,19 @@ const sendChunks = async (
   // across the initial pass AND every selective-retransmit round — is sealed
   // under this same key with a FRESH random nonce (streaming-safe; no
   // per-message frame cache needed). `pqContext` is the caller-owned copy of
-  // the PQ message context captured with the step; sealChunk combines it with
-  // an owned per-chunk copy of the classical key.
+  // the PQ message context captured with the step; sealMessageChunk combines
+  // it with an owned per-chunk copy of the classical key.
   messageKey: Uint8Array,
   header: RatchetHeader,
   pqContext: PqMessageKeyContext | null,
   chunksLen: number,
-  chunkHashes: Uint8Array,
+  merkleTree: MerkleTree,
   merkleRoot: Uint8Array,
+  // Every chunk's receipt token, in index order (createChunkReceiptTokenTable).
+  receiptTokens: Uint8Array,
   transferId: string,
   hashHex: string,
   encryptionModule: LibCrypto,
-  merkleModule: LibCrypto,
   signal?: AbortSignal,
   // When set (reconcile: selective retransmit / resume), resend ONLY the un-acked
   // real chunks — skip decoys and already-acked reals.
@@ -157,6 +157,7 @@ const sendChunks = async (
 
   const indexes = Array.from({ length: chunksLen }, (_, i) => i);
   const indexesRandomized = fisherYatesShuffle(indexes);
+  const fileHash = hexToUint8Array(hashHex);
 
   for (let i = 0; i < chunksLen; i++) {
     throwIfTransferAborted(signal);
@@ -167,7 +168,10 @@ const sendChunks = async (
     if (!unencryptedChunk)
       throw new Error(`Missing staged outbound chunk ${String(iRandom)}`);
 
+    // Staged cells carry a zeroed file hash; it goes in before sealing and is
+    // written back with the proof below.
     const metadataArray = new Uint8Array(unencryptedChunk.metadata);
+    setMetadataHash(metadataArray, fileHash);
     const metadata = deserializeMetadata(metadataArray);
     if (
       metadata.chunkIndex !== iRandom ||
@@ -203,15 +207,7 @@ const sendChunks = async (
 
     const merkleProof = new Uint8Array(PROOF_LEN);
     if (unencryptedChunk.merkleProof.byteLength === 0) {
-      const m = await getMerkleProof(
-        chunkHashes,
-        hexToUint8Array(unencryptedChunk.leafHash),
-        merkleModule,
-        PROOF_LEN,
-      );
-      throwIfTransferAborted(signal);
-
-      merkleProof.set(m);
+      merkleProof.set(merkleTree.getProof(iRandom, PROOF_LEN));
     } else {
       merkleProof.set(new Uint8Array(unencryptedChunk.merkleProof));
     }
@@ -221,10 +217,9 @@ const sendChunks = async (
       crypto_hash_sha512_BYTES * 2
         ? unencryptedChunk.receiptToken
         : uint8ArrayToHex(
-            await createChunkReceiptToken(
-              merkleRoot,
-              metadata.chunkIndex,
-              hexToUint8Array(unencryptedChunk.leafHash),
+            receiptTokens.subarray(
+              iRandom * crypto_hash_sha512_BYTES,
+              (iRandom + 1) * crypto_hash_sha512_BYTES,
             ),
           );
     throwIfTransferAborted(signal);
@@ -236,6 +231,7 @@ const sendChunks = async (
     if (
       unencryptedChunk.merkleProof.byteLength === 0 ||
       unencryptedChunk.merkleRoot !== merkleRootHex ||
+      unencryptedChunk.hash !== hashHex ||
       unencryptedChunk.receiptToken !== receiptToken
     ) {
       await setDBNewChunk({
@@ -259,11 +255,6 @@ const sendChunks = async (
     )
       throw new Error("Outbound staged chunk has invalid cell length");
 
-    const chunk = await concatUint8Arrays([
-      metadataArray,
-      merkleProof,
-      new Uint8Array(unencryptedChunk.data),
-    ]);
     throwIfTransferAborted(signal);
 
     // protocol-v3: seal the DECRYPTED_LEN plaintext (metadata ‖ proof ‖ chunk)
@@ -300,10 +291,12 @@ const sendChunks = async (
 
     let message: Uint8Array;
     try {
-      message = sealChunk(
+      message = sealMessageChunk(
         messageKey,
         header,
-        chunk,
+        metadataArray,
+        merkleProof,
+        new Uint8Array(unencryptedChunk.data),
         merkleRoot,
         encryptionModule,
         pqContext ?? undefined,
@@ -326,9 +319,9 @@ const sendChunks = async (
       throw error;
     }
   }
-  // protocol-v3: no box wasm scratch to free — `sealChunk` allocates + frees its
-  // own transient buffers per chunk; the message key is owned + wiped by the
-  // caller (sendWithReconcile) after the last retransmit round.
+  // protocol-v3: no box wasm scratch to free — `sealMessageChunk` allocates +
+  // frees its own transient buffers per chunk; the message key is owned + wiped
+  // by the caller (sendWithReconcile) after the last retransmit round.
 };
 
 // Resume-on-reconnect: a FULL peer reconnect (new RTCPeerConnection) destroys the
@@ -738,13 +731,13 @@ const sendWithReconcile = async (
   roomId: string,
   epc: IRTCPeerConnection,
   chunksLen: number,
-  chunkHashes: Uint8Array,
+  merkleTree: MerkleTree,
   merkleRoot: Uint8Array,
+  receiptTokens: Uint8Array,
   transferId: string,
   hashHex: string,
   peerId: string,
   encryptionModule: LibCrypto,
-  merkleModule: LibCrypto,
   peerConnections: IRTCPeerConnection[],
   dataChannels: IRTCDataChannel[],
   signal?: AbortSignal,
@@ -832,12 +825,12 @@ const sendWithReconcile = async (
       header,
       pqContext,
       chunksLen,
-      chunkHashes,
+      merkleTree,
       merkleRoot,
+      receiptTokens,
       transferId,
       hashHex,
       encryptionModule,
-      merkleModule,
       signal,
       undefined,
       () => getAckedChunkCount(roomId, peerId, transferId),
@@ -934,12 +927,12 @@ const sendWithReconcile = async (
         header,
         pqContext,
         chunksLen,
-        chunkHashes,
+        merkleTree,
         merkleRoot,
+        receiptTokens,
         transferId,
         hashHex,
         encryptionModule,
-        merkleModule,
         signal,
         getAckedChunks(roomId, peerId, transferId),
         () => getAckedChunkCount(roomId, peerId, transferId),
@@ -974,31 +967,25 @@ const makeScheduledSlotSealer =
   (
     transferId: string,
     hashHex: string,
-    chunkHashes: Uint8Array,
+    merkleTree: MerkleTree,
     merkleRoot: Uint8Array,
     merkleRootHex: string,
+    receiptTokens: Uint8Array,
     messageKey: Uint8Array,
     header: RatchetHeader,
     pqContext: PqMessageKeyContext | null,
     encryptionModule: LibCrypto,
-    merkleModule: LibCrypto,
   ) =>
   async (chunkIndex: number): Promise<Uint8Array | null> => {
     const unencryptedChunk = await getDBNewChunk(transferId, chunkIndex);
     if (!unencryptedChunk) return null;
     const metadataArray = new Uint8Array(unencryptedChunk.metadata);
+    setMetadataHash(metadataArray, hexToUint8Array(hashHex));
     const metadata = deserializeMetadata(metadataArray);
 
     const merkleProof = new Uint8Array(PROOF_LEN);
     if (unencryptedChunk.merkleProof.byteLength === 0) {
-      merkleProof.set(
-        await getMerkleProof(
-          chunkHashes,
-          hexToUint8Array(unencryptedChunk.leafHash),
-          merkleModule,
-          PROOF_LEN,
-        ),
-      );
+      merkleProof.set(merkleTree.getProof(chunkIndex, PROOF_LEN));
     } else {
       merkleProof.set(new Uint8Array(unencryptedChunk.merkleProof));
     }
@@ -1007,15 +994,15 @@ const makeScheduledSlotSealer =
       unencryptedChunk.receiptToken.length === crypto_hash_sha512_BYTES * 2
         ? unencryptedChunk.receiptToken
         : uint8ArrayToHex(
-            await createChunkReceiptToken(
-              merkleRoot,
-              metadata.chunkIndex,
-              hexToUint8Array(unencryptedChunk.leafHash),
+            receiptTokens.subarray(
+              chunkIndex * crypto_hash_sha512_BYTES,
+              (chunkIndex + 1) * crypto_hash_sha512_BYTES,
             ),
           );
     if (
       unencryptedChunk.merkleProof.byteLength === 0 ||
       unencryptedChunk.merkleRoot !== merkleRootHex ||
+      unencryptedChunk.hash !== hashHex ||
       unencryptedChunk.receiptToken !== receiptToken
     ) {
       await setDBNewChunk({
@@ -1031,15 +1018,12 @@ const makeScheduledSlotSealer =
       });
     }
 
-    const chunk = await concatUint8Arrays([
+    return sealMessageChunk(
+      messageKey,
+      header,
       metadataArray,
       merkleProof,
       new Uint8Array(unencryptedChunk.data),
-    ]);
-    return sealChunk(
-      messageKey,
-      header,
-      chunk,
       merkleRoot,
       encryptionModule,
       pqContext ?? undefined,
@@ -1058,13 +1042,13 @@ const sendScheduled = async (
   channelLabel: string,
   targets: readonly PeerSendTarget[],
   totalChunks: number,
-  chunkHashes: Uint8Array,
+  merkleTree: MerkleTree,
   merkleRoot: Uint8Array,
   merkleRootHex: string,
+  receiptTokens: Uint8Array,
   transferId: string,
   hashHex: string,
   encryptionModule: LibCrypto,
-  merkleModule: LibCrypto,
   signal?: AbortSignal,
   onTransferStarted?: () => void,
 ): Promise<PeerSendFanoutResult> => {
@@ -1088,9 +1072,9 @@ const sendScheduled = async (
       const stepped = await ratchetEncryptDurably(epc, roomId, encryptionModule);
       const channelMessageLabel = await compileChannelMessageLabel(channelLabel, merkleRootHex);
       const sealer = makeScheduledSlotSealer(
-        transferId, hashHex, chunkHashes, merkleRoot, merkleRootHex,
-        stepped.messageKey, stepped.header, stepped.pqContext,
-        encryptionModule, merkleModule,
+        transferId, hashHex, merkleTree, merkleRoot, merkleRootHex,
+        receiptTokens, stepped.messageKey, stepped.header, stepped.pqContext,
+        encryptionModule,
       );
       const enqueued = enqueueScheduledSend({
         epc,
@@ -1144,6 +1128,7 @@ export const handleSendMessage = async (
   let merkleRootForFailureCleanup = "";
   let localMessageCommitted = false;
   let wireWorkStarted = false;
+  let freeMerkleTree: (() => void) | undefined;
   try {
     throwIfTransferAborted(transfer.signal);
     const { rooms } = api.getState() as State;
@@ -1185,6 +1170,22 @@ export const handleSendMessage = async (
         return;
       localMessageCommitted = true;
 
+      // Hash every level once; each chunk's proof is then an O(log n) lookup
+      // by chunk index instead of a full-tree rescan and rehash.
+      const merkleTree = await createMerkleTree(chunkHashes, merkleModule);
+      freeMerkleTree = merkleTree.free;
+      setRangeReceiptVerifier(
+        transfer.transferId,
+        merkleTree.verifyRangeReceipt,
+      );
+      // Every chunk's receipt token in a few batched calls, instead of one
+      // call per chunk as each is first sent.
+      const receiptTokens = createChunkReceiptTokenTable(
+        merkleRoot,
+        chunkHashes,
+        encryptionModule,
+      );
+
       const channelMessageLabel = await compileChannelMessageLabel(
         label,
         merkleRootHex,
@@ -1209,13 +1210,13 @@ export const handleSendMessage = async (
             label,
             targets,
             totalChunks,
-            chunkHashes,
+            merkleTree,
             merkleRoot,
             merkleRootHex,
+            receiptTokens,
             transfer.transferId,
             hashHex,
             encryptionModule,
-            merkleModule,
             transfer.signal,
             () => {
               wireWorkStarted = true;
@@ -1235,13 +1236,13 @@ export const handleSendMessage = async (
                 roomId,
                 epc,
                 totalChunks,
-                chunkHashes,
+                merkleTree,
                 merkleRoot,
+                receiptTokens,
                 transfer.transferId,
                 hashHex,
                 peerId,
                 encryptionModule,
-                merkleModule,
                 peerConnections,
                 dataChannels,
                 transfer.signal,
@@ -1299,6 +1300,8 @@ export const handleSendMessage = async (
     throw error;
   } finally {
     await deleteDBNewChunk({ transferId: transfer.transferId });
+    clearRangeReceiptVerifier(transfer.transferId);
+    freeMerkleTree?.();
     transfer.finish();
   }
 };
@@ -4,7 +4,7 @@ import {
   cpaceStart,
   cpaceFinish,
 } from "../cryptography/cpace";
-import { deriveInteractive3dhSecret } from "../cryptography/x3dh";
+import { deriveHandshakeKeys } from "../cryptography/handshakeKeys";
 import { x25519Keypair } from "../cryptography/x25519";
 import {
   initRatchet,
@@ -12,7 +12,6 @@ import {
   wipeRatchet,
 } from "../cryptography/ratchet";
 import { verifyIdentityCrossSig } from "../cryptography/identityCrossSig";
-import { hkdfExpand, hkdfExtract } from "../cryptography/hkdf";
 import {
   createMlKemBackend,
   getMlKemSuite,
@@ -123,13 +122,8 @@ const hybridKdfDomain = (
       ? `p2party-v4-hybrid-root-cpace21-3dh-ml-kem-${String(parameterSet)}-v4`
       : `p2party-v4-hybrid-root-3dh-ml-kem-${String(parameterSet)}-v4`,
   );
-const HS_HYBRID_KDF_SALT = new Uint8Array(64);
-const PQ_HEALING_ROOT_SALT = new TextEncoder().encode(
-  "p2party-v4-pq-healing-extract-v1",
-);
-const PQ_HEALING_ROOT_INFO = new TextEncoder().encode(
-  "p2party-v4-pq-healing-root-v1",
-);
+// The combiner's zero salt and the PQ-healing extract/root labels live in
+// handshake.c with the rest of the key schedule.
 const PQ_HEALING_BINDING_DOMAIN = new TextEncoder().encode(
   "p2party-v4-pq-healing-binding-v1\u0000",
 );
@@ -395,12 +389,8 @@ export const performHandshakeCore = async (
   const mlKemCiphertextSelf = new Uint8Array(layout.suite.ciphertextBytes);
   let mlKemKeyPair: MlKemKeyPair | null = null;
   let mlKemShared: MlKemEncapsulation | MlKemDecapsulation | null = null;
-  let identitySecret: Uint8Array | undefined;
   let pakeSecret: Uint8Array | undefined;
-  let hybridIkm: Uint8Array | undefined;
-  let hybridPrk: Uint8Array | undefined;
   let secret: Uint8Array | undefined;
-  let pqHealingPrk: Uint8Array | undefined;
   let pqHealingRoot: Uint8Array | undefined;
   let pqHealingBinding: Uint8Array | undefined;
   // Owned here until the success return transfers it to the caller. In
@@ -548,20 +538,6 @@ export const performHandshakeCore = async (
       mlKemKeyPair.destroy();
     }
 
-    // Identity possession is mandatory in BOTH modes. Merely verifying the
-    // static cross-signature is insufficient: an attacker could replay a
-    // victim's public X25519 credential without owning its secret. Interactive
-    // 3DH makes the root depend on both presented identity secrets and both
-    // fresh ephemeral secrets.
-    identitySecret = deriveInteractive3dhSecret(
-      idSelfSec,
-      peerX25519Pub,
-      ek.secretKey,
-      ekPeer,
-      amInitiator,
-      module,
-    );
-
     // Ordered fields (I = initiator, R = responder). Both legs build the
     // byte-identical values regardless of which side computed each field. All
     // four fixed PQ fields, including canonical zero fields, enter key
@@ -616,6 +592,12 @@ export const performHandshakeCore = async (
       );
     }
 
+    // Identity possession is mandatory in BOTH modes. Merely verifying the
+    // static cross-signature is insufficient: an attacker could replay a
+    // victim's public X25519 credential without owning its secret. Interactive
+    // 3DH makes the root depend on both presented identity secrets and both
+    // fresh ephemeral secrets.
+    //
     // Fixed-order, transcript-bound application-handshake combiner. PIN mode
     // adds (rather than replaces) CPace-ISK || 3DH || ML-KEM; no-PIN remains
     // 3DH || ML-KEM. This is deliberately NOT labelled X-Wing: X-Wing is a
@@ -623,15 +605,17 @@ export const performHandshakeCore = async (
     // binds identity possession, CPace policy, DTLS, and key confirmation.
     // Separate mode/version domains prevent the variable-length IKM layouts
     // from ever being interpreted as one another.
-    const hybridDomain = hybridKdfDomain(mode, layout.suite.parameterSet);
-    hybridIkm = await concatUint8Arrays(
-      mode === "pin"
-        ? [pakeSecret!, identitySecret, mlKemShared.sharedSecret]
-        : [identitySecret, mlKemShared.sharedSecret],
-    );
-    hybridPrk = hkdfExtract(HS_HYBRID_KDF_SALT, hybridIkm, module);
+    //
+    // Protocol v4 derives a separate sparse-healing root and a public,
+    // session-unique edge binding. The binding commits to the authenticated
+    // room/channel input plus both ordered HELLO flights; it is not a secret.
+    // The root is domain-separated from the Double-Ratchet seed even though
+    // both ultimately rely on the same hybrid handshake master.
+    //
+    // All three run in one C call (handshake.c); the DH outputs, 3DH secret,
+    // combiner IKM and PRKs are wiped there and never reach JavaScript.
     const hybridInfo = await concatUint8Arrays([
-      hybridDomain,
+      hybridKdfDomain(mode, layout.suite.parameterSet),
       channelInput,
       x25519IdentityPubI,
       x25519IdentityCrossSigI,
@@ -640,13 +624,6 @@ export const performHandshakeCore = async (
       mlKemPublicKeyI,
       mlKemCiphertextR,
     ]);
-    secret = hkdfExpand(hybridPrk, hybridInfo, 32, module);
-
-    // Protocol v4 derives a separate sparse-healing root and a public,
-    // session-unique edge binding. The binding commits to the authenticated
-    // room/channel input plus both ordered HELLO flights; it is not a secret.
-    // The root is domain-separated from the Double-Ratchet seed even though
-    // both ultimately rely on the same hybrid handshake master.
     const pqBindingInput = await concatUint8Arrays([
       PQ_HEALING_BINDING_DOMAIN,
       channelInput,
@@ -662,33 +639,30 @@ export const performHandshakeCore = async (
       mlKemCiphertextR,
     ]);
     try {
-      pqHealingBinding = new Uint8Array(
-        await crypto.subtle.digest(
-          "SHA-256",
-          pqBindingInput.slice().buffer as ArrayBuffer,
-        ),
-      );
+      ({
+        rootKey: secret,
+        pqHealingRoot,
+        pqHealingBinding,
+      } = deriveHandshakeKeys(
+        {
+          identitySecret: idSelfSec,
+          peerIdentityPub: peerX25519Pub,
+          ephemeralSecret: ek.secretKey,
+          peerEphemeralPub: ekPeer,
+          amInitiator,
+          pakeIsk: mode === "pin" ? pakeSecret! : null,
+          kemSecret: mlKemShared.sharedSecret,
+          hybridInfo,
+          bindingInput: pqBindingInput,
+        },
+        module,
+      ));
     } finally {
       pqBindingInput.fill(0);
     }
-    pqHealingPrk = hkdfExtract(PQ_HEALING_ROOT_SALT, secret, module);
-    const pqRootInfo = await concatUint8Arrays([
-      PQ_HEALING_ROOT_INFO,
-      pqHealingBinding,
-    ]);
-    try {
-      pqHealingRoot = hkdfExpand(pqHealingPrk, pqRootInfo, 32, module);
-    } finally {
-      pqRootInfo.fill(0);
-      pqHealingPrk.fill(0);
-      pqHealingPrk = undefined;
-    }
 
     // Wipe the component secrets immediately after the hybrid root exists.
-    identitySecret.fill(0);
     pakeSecret?.fill(0);
-    hybridIkm.fill(0);
-    hybridPrk.fill(0);
     mlKemShared.destroy();
 
     const buildConfirmationInput = (
@@ -864,11 +838,7 @@ export const performHandshakeCore = async (
     // persistence/session construction.
     ek.secretKey.fill(0);
     cpaceScalar?.fill(0);
-    identitySecret?.fill(0);
     pakeSecret?.fill(0);
-    hybridIkm?.fill(0);
-    hybridPrk?.fill(0);
-    pqHealingPrk?.fill(0);
     pqHealingRoot?.fill(0);
     pqHealingBinding?.fill(0);
     mlKemShared?.destroy();
@@ -5,11 +5,18 @@ import {
   wipeRatchet,
 } from "../cryptography/ratchet";
 import { packChunkFrameHeader, parseChunkFrameHeader } from "./chunkFrame";
+import { secureMalloc } from "../cryptography/slab";
 import { zeroFree } from "../utils/zeroFree";
 import {
   CHUNK_AAD_HEADER_LEN,
+  CHUNK_LEN,
   MESSAGE_LEN,
+  MESSAGE_START,
+  METADATA_LEN,
+  PROOF_LEN,
   DECRYPTED_LEN,
+  RATCHET_NONCE_LEN,
+  WIRE_CHUNK_FRAME_LEN,
 } from "../utils/constants";
 import {
   combinePqMessageKey,
@@ -18,13 +25,12 @@ import {
 } from "../cryptography/pqMessageKey";
 import {
   crypto_aead_chacha20poly1305_ietf_KEYBYTES,
-  crypto_aead_chacha20poly1305_ietf_NPUBBYTES,
-  crypto_aead_chacha20poly1305_ietf_ABYTES,
   crypto_hash_sha512_BYTES,
 } from "../cryptography/interfaces";
 
 import type { RatchetState, RatchetHeader } from "../cryptography/ratchet";
 import type { LibCrypto } from "../cryptography/libcrypto";
+import type { MerkleProofCache } from "../cryptography/merkle";
 import type { PqMessageKeyContext } from "../cryptography/pqMessageKey";
 
 // ── v4 per-message ratchet + PQ key combiner + per-chunk AEAD ────────────────
@@ -39,18 +45,17 @@ import type { PqMessageKeyContext } from "../cryptography/pqMessageKey";
 // `merkleRoot(64) ‖ type(1) ‖ dhPub(32) ‖ N(8) ‖ PN(8) ‖ pqEpoch(8)`.
 // The complete clear header excluding the fresh random nonce is authenticated.
 //
-// SEND builds the AAD + seals in TS (`buildAad`/`aeadSeal`/`sealChunk`). RECEIVE
-// is done ENTIRELY in one C call: `decryptMessageChunk` derives the per-message
-// key off the ratchet (the only state C needs, passed in as an arg) and hands the
-// raw frame + key + expected root to `_receive_message_with_key`, which
-// AEAD-decrypts, hashes the leaf, verifies the Merkle proof, and writes the
-// receipt — all in libsodium, in place, no TS↔WASM back-and-forth (DRY/KISS: the
-// C receive path is the SSOT for receive crypto).
+// SEND is one C call: `sealMessageChunk` packs the clear header in TS and hands
+// it with the root, metadata, proof and chunk to `_seal_message_chunk`, which
+// picks the nonce, builds the AAD and seals the cell in place. RECEIVE is one C
+// call too: `decryptMessageChunk` derives the per-message key off the ratchet
+// (the only state C needs, passed in as an arg) and hands the raw frame + key +
+// expected root to `_receive_message_with_key`, which AEAD-decrypts, hashes the
+// leaf, verifies the Merkle proof, and writes the receipt — all in libsodium, in
+// place, no TS↔WASM back-and-forth. Both sides build the AAD with the same C
+// helper (`chunk_aad`), so send/receive parity is structural.
 
 const AEAD_KEY_LEN = crypto_aead_chacha20poly1305_ietf_KEYBYTES; // 32
-const AEAD_NONCE_LEN = crypto_aead_chacha20poly1305_ietf_NPUBBYTES; // 12
-const AEAD_TAG_LEN = crypto_aead_chacha20poly1305_ietf_ABYTES; // 16
-const AAD_LEN = crypto_hash_sha512_BYTES + CHUNK_AAD_HEADER_LEN; // 121
 const MAX_U64 = (1n << 64n) - 1n;
 
 const toHex = (u8: Uint8Array): string =>
@@ -75,93 +80,131 @@ export const messageCacheKey = (
   return `${prefix}:${pqEpoch.toString(10)}`;
 };
 
-// AAD = merkleRoot || the exact on-wire clear header excluding its nonce.
-// Copying the serialized bytes (rather than re-encoding fields) makes TS/C
-// parity structural: C memcpy's the same prefix from the received frame.
-const buildAad = (
-  merkleRoot: Uint8Array,
-  frameHeader: Uint8Array,
-): Uint8Array => {
-  if (frameHeader.length < CHUNK_AAD_HEADER_LEN)
-    throw new Error("messageChunkCrypto: incomplete chunk frame header");
-  const aad = new Uint8Array(AAD_LEN);
-  aad.set(merkleRoot, 0);
-  aad.set(
-    frameHeader.subarray(0, CHUNK_AAD_HEADER_LEN),
-    crypto_hash_sha512_BYTES,
-  );
-  return aad;
-};
+// Slots per ingress ring. The receive queue opens one frame at a time per edge
+// (under the edge processing lock), so a few slots cover a plaintext held
+// across its storage await while the next frame is opened.
+export const INGRESS_RING_SLOTS = 4;
 
-const randomNonce = (): Uint8Array => {
-  const nonce = new Uint8Array(AEAD_NONCE_LEN);
-  crypto.getRandomValues(nonce);
-  return nonce;
-};
+/**
+ * A fixed set of WIRE_CHUNK_FRAME_LEN slots owned by the receive module's heap
+ * (`ingress_ring` in pake_ratchet.c). A frame is copied straight into a
+ * claimed slot and opened in place, and the verified plaintext is handed out
+ * as a view of the slot, so receive needs no second plaintext buffer and no
+ * copy back to JS. Releasing a slot wipes it.
+ */
+export interface IngressRing {
+  readonly slots: number;
+  /** Copy `frame` into a free slot; null when every slot is held. */
+  claim: (frame: Uint8Array) => number | null;
+  /** `_receive_message_in_slot` status (see `receiveWithKey`). */
+  open: (
+    slot: number,
+    merkleRoot: Uint8Array,
+    key: Uint8Array,
+    proofCache?: MerkleProofCache,
+  ) => number;
+  /** The DECRYPTED_LEN plaintext window of an opened slot. */
+  plaintext: (slot: number) => Uint8Array;
+  release: (slot: number) => void;
+  free: () => void;
+}
 
 /**
- * AEAD seal: `out = ChaCha20(key,nonce) XOR data ‖ Poly1305(aad, ciphertext)`,
- * length `data.length + 16`. Thin wrapper over the exported
- * `_encrypt_chachapoly_symmetric`; secret scratch (key, data, out) is zeroed
- * before free.
+ * createIngressRing
+ *
+ * @description
+ * Allocates an ingress ring of `slots` cells, plus the root/key scratch its
+ * opens share, in `module`'s heap.
+ *
+ * @returns {IngressRing}
  */
-const aeadSeal = (
+export const createIngressRing = (
   module: LibCrypto,
-  key: Uint8Array,
-  nonce: Uint8Array,
-  data: Uint8Array,
-  aad: Uint8Array,
-): Uint8Array => {
-  const dataAlloc = Math.max(data.length, 1);
-  const aadAlloc = Math.max(aad.length, 1);
-  const outLen = data.length + AEAD_TAG_LEN;
-
-  const keyPtr = module._malloc(AEAD_KEY_LEN);
-  const noncePtr = module._malloc(AEAD_NONCE_LEN);
-  const dataPtr = module._malloc(dataAlloc);
-  const aadPtr = module._malloc(aadAlloc);
-  const outPtr = module._malloc(outLen);
-
-  new Uint8Array(module.wasmMemory.buffer, keyPtr, AEAD_KEY_LEN).set(key);
-  new Uint8Array(module.wasmMemory.buffer, noncePtr, AEAD_NONCE_LEN).set(nonce);
-  if (data.length)
-    new Uint8Array(module.wasmMemory.buffer, dataPtr, data.length).set(data);
-  if (aad.length)
-    new Uint8Array(module.wasmMemory.buffer, aadPtr, aad.length).set(aad);
-
-  const r = module._encrypt_chachapoly_symmetric(
-    outPtr,
-    dataPtr,
-    data.length,
-    keyPtr,
-    noncePtr,
-    aadPtr,
-    aad.length,
-  );
-
-  const out =
-    r === 0
-      ? Uint8Array.from(
-          new Uint8Array(module.wasmMemory.buffer, outPtr, outLen),
-        )
-      : null;
-
-  // key, data (plaintext) and out (holds plaintext on the decrypt path) are
-  // secret — zero them before returning the heap to the allocator.
-  zeroFree(
-    module,
-    new Uint8Array(module.wasmMemory.buffer, keyPtr, AEAD_KEY_LEN),
-  );
-  module._free(noncePtr);
-  zeroFree(
-    module,
-    new Uint8Array(module.wasmMemory.buffer, dataPtr, dataAlloc),
-  );
-  module._free(aadPtr);
-  zeroFree(module, new Uint8Array(module.wasmMemory.buffer, outPtr, outLen));
+  slots: number = INGRESS_RING_SLOTS,
+): IngressRing => {
+  const ringLen = module._ingress_ring_bytes(slots);
+  if (ringLen === 0) throw new Error("messageChunkCrypto: invalid ring size");
+
+  const ringPtr = module._malloc(ringLen);
+  module._ingress_ring_init(ringPtr, slots);
+  const rootPtr = module._malloc(crypto_hash_sha512_BYTES + AEAD_KEY_LEN);
+  const keyPtr = rootPtr + crypto_hash_sha512_BYTES;
+
+  let freed = false;
+  const slotPtr = (slot: number): number => {
+    if (freed) throw new Error("messageChunkCrypto: ingress ring freed");
+    const ptr = module._ingress_ring_slot(ringPtr, slot);
+    if (ptr === 0) throw new Error("messageChunkCrypto: slot not claimed");
+    return ptr;
+  };
 
-  if (!out) throw new Error("messageChunkCrypto: AEAD encrypt failed");
-  return out;
+  return {
+    slots,
+
+    claim: (frame: Uint8Array): number | null => {
+      if (freed) throw new Error("messageChunkCrypto: ingress ring freed");
+      const slot = module._ingress_ring_claim(ringPtr);
+      if (slot < 0) return null;
+
+      // Short frames leave the cell's zeroed tail in place; the AEAD rejects
+      // them like the copy path does.
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        slotPtr(slot),
+        WIRE_CHUNK_FRAME_LEN,
+      ).set(frame.subarray(0, WIRE_CHUNK_FRAME_LEN));
+      return slot;
+    },
+
+    open: (
+      slot: number,
+      merkleRoot: Uint8Array,
+      key: Uint8Array,
+      proofCache?: MerkleProofCache,
+    ): number => {
+      slotPtr(slot);
+      const scratch = new Uint8Array(
+        module.wasmMemory.buffer,
+        rootPtr,
+        crypto_hash_sha512_BYTES + AEAD_KEY_LEN,
+      );
+      scratch.set(merkleRoot, 0);
+      scratch.set(key, crypto_hash_sha512_BYTES);
+      try {
+        return module._receive_message_in_slot(
+          ringPtr,
+          slot,
+          rootPtr,
+          proofCache?.ptr ?? 0,
+          keyPtr,
+        );
+      } finally {
+        scratch.fill(0);
+      }
+    },
+
+    plaintext: (slot: number): Uint8Array =>
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        slotPtr(slot) + MESSAGE_START,
+        DECRYPTED_LEN,
+      ),
+
+    release: (slot: number): void => {
+      if (freed) return;
+      module._ingress_ring_release(ringPtr, slot);
+    },
+
+    free: (): void => {
+      if (freed) return;
+      freed = true;
+      zeroFree(
+        module,
+        new Uint8Array(module.wasmMemory.buffer, ringPtr, ringLen),
+      );
+      module._free(rootPtr);
+    },
+  };
 };
 
 /**
@@ -178,17 +221,39 @@ const aeadSeal = (
  *   code  0  → decrypt + Merkle both passed
  *   code -2  → AEAD auth failed (forgery/replay) → caller ROLLS the ratchet back
  *   code <0  → AEAD passed but Merkle/proof bad → caller COMMITS the ratchet, drops
+ *
+ * With a `ring` that has a free slot the frame is opened in place there
+ * instead, and `decrypted` is a view of the slot that stays valid until
+ * `release` is called. With a `proofCache` bound to `merkleRoot` the proof is
+ * checked against it (`_receive_message_with_proof_cache`), so upper nodes
+ * verified for earlier chunks of the transfer are not hashed again.
  */
 const receiveWithKey = (
   module: LibCrypto,
   frame: Uint8Array,
   merkleRoot: Uint8Array,
   key: Uint8Array,
-): { code: number; decrypted: Uint8Array | null } => {
-  const msgPtr = module._malloc(MESSAGE_LEN);
-  const decPtr = module._malloc(DECRYPTED_LEN);
-  const rootPtr = module._malloc(crypto_hash_sha512_BYTES);
-  const keyPtr = module._malloc(AEAD_KEY_LEN);
+  ring?: IngressRing,
+  proofCache?: MerkleProofCache,
+): { code: number; decrypted: Uint8Array | null; release?: () => void } => {
+  const slot = ring ? ring.claim(frame) : null;
+  if (ring && slot !== null) {
+    const code = ring.open(slot, merkleRoot, key, proofCache);
+    if (code !== 0) {
+      ring.release(slot);
+      return { code, decrypted: null };
+    }
+    return {
+      code,
+      decrypted: ring.plaintext(slot),
+      release: () => ring.release(slot),
+    };
+  }
+
+  const msgPtr = secureMalloc(module, MESSAGE_LEN);
+  const decPtr = secureMalloc(module, DECRYPTED_LEN);
+  const rootPtr = secureMalloc(module, crypto_hash_sha512_BYTES);
+  const keyPtr = secureMalloc(module, AEAD_KEY_LEN);
 
   // The C signature reads a full MESSAGE_LEN buffer; the wire frame is shorter
   // (WIRE_CHUNK_FRAME_LEN) so zero the tail, then copy the frame in.
@@ -207,18 +272,24 @@ const receiveWithKey = (
   ).set(merkleRoot);
   new Uint8Array(module.wasmMemory.buffer, keyPtr, AEAD_KEY_LEN).set(key);
 
-  const code = module._receive_message_with_key(
-    decPtr,
-    msgPtr,
-    rootPtr,
-    keyPtr,
-  );
+  const code = proofCache
+    ? module._receive_message_with_proof_cache(
+        decPtr,
+        msgPtr,
+        proofCache.ptr,
+        keyPtr,
+      )
+    : module._receive_message_with_key(decPtr, msgPtr, rootPtr, keyPtr);
 
   const decrypted = code === 0 ? Uint8Array.from(dec) : null;
 
-  // key + decrypted (holds the plaintext) are secret — wipe before free.
-  module._free(msgPtr);
-  module._free(rootPtr);
+  // key + decrypted (holds the plaintext) are secret — wipe before free. The
+  // public cell and root are released the same way so slab slots go back.
+  zeroFree(module, msg);
+  zeroFree(
+    module,
+    new Uint8Array(module.wasmMemory.buffer, rootPtr, crypto_hash_sha512_BYTES),
+  );
   zeroFree(
     module,
     new Uint8Array(module.wasmMemory.buffer, keyPtr, AEAD_KEY_LEN),
@@ -228,13 +299,175 @@ const receiveWithKey = (
   return { code, decrypted };
 };
 
+// Frames per `_receive_message_batch` call. Each frame stages its wire cell and
+// its plaintext (~128 KiB together), so four keep a batch well inside the
+// fixed 2 MiB protocol heap next to the 512 KiB stack.
+const RECEIVE_BATCH_FRAMES = 4;
+
+/**
+ * `receiveWithKey` for many frames: each group of up to RECEIVE_BATCH_FRAMES
+ * frames is staged into one heap block and opened by ONE
+ * `_receive_message_batch` call, which writes every plaintext and a per-frame
+ * status vector (same codes as `receiveWithKey`). `keys[i]` opens `frames[i]`.
+ * A `proofCache` is shared by every frame, as in `receiveWithKey`.
+ */
+const receiveBatchWithKeys = (
+  module: LibCrypto,
+  frames: Uint8Array[],
+  merkleRoot: Uint8Array,
+  keys: Uint8Array[],
+  proofCache?: MerkleProofCache,
+): { code: number; decrypted: Uint8Array | null }[] => {
+  const results: { code: number; decrypted: Uint8Array | null }[] = [];
+  if (frames.length === 0) return results;
+
+  const batch = Math.min(RECEIVE_BATCH_FRAMES, frames.length);
+  // block = frames ‖ plaintexts ‖ roots ‖ keys ‖ offsets(u32) ‖ status(i32)
+  const framesLen = batch * WIRE_CHUNK_FRAME_LEN;
+  const decOff = framesLen;
+  const rootsOff = decOff + batch * DECRYPTED_LEN;
+  const keysOff = rootsOff + batch * crypto_hash_sha512_BYTES;
+  const offsetsOff = keysOff + batch * AEAD_KEY_LEN;
+  const statusOff = offsetsOff + batch * 4;
+  const blockLen = statusOff + batch * 4;
+
+  const ptr = module._malloc(blockLen);
+  try {
+    for (let first = 0; first < frames.length; first += batch) {
+      const count = Math.min(batch, frames.length - first);
+      const block = new Uint8Array(module.wasmMemory.buffer, ptr, blockLen);
+      const view = new DataView(module.wasmMemory.buffer, ptr, blockLen);
+      // Zero short frames' tails and any stale plaintext from a prior group.
+      block.fill(0, 0, rootsOff);
+      for (let i = 0; i < count; i++) {
+        block.set(
+          frames[first + i].subarray(0, WIRE_CHUNK_FRAME_LEN),
+          i * WIRE_CHUNK_FRAME_LEN,
+        );
+        block.set(merkleRoot, rootsOff + i * crypto_hash_sha512_BYTES);
+        block.set(keys[first + i], keysOff + i * AEAD_KEY_LEN);
+        view.setUint32(offsetsOff + i * 4, i * WIRE_CHUNK_FRAME_LEN, true);
+      }
+
+      module._receive_message_batch(
+        count,
+        ptr + decOff,
+        ptr,
+        framesLen,
+        ptr + offsetsOff,
+        ptr + rootsOff,
+        proofCache?.ptr ?? 0,
+        ptr + keysOff,
+        ptr + statusOff,
+      );
+
+      for (let i = 0; i < count; i++) {
+        const code = view.getInt32(statusOff + i * 4, true);
+        results.push({
+          code,
+          decrypted:
+            code === 0
+              ? block.slice(
+                  decOff + i * DECRYPTED_LEN,
+                  decOff + (i + 1) * DECRYPTED_LEN,
+                )
+              : null,
+        });
+      }
+    }
+  } finally {
+    // Keys and plaintexts are secret — wipe the whole block before free.
+    zeroFree(module, new Uint8Array(module.wasmMemory.buffer, ptr, blockLen));
+  }
+
+  return results;
+};
+
+// The PQ epoch/ratchet header bytes C authenticates. The nonce is chosen by C,
+// so the packed header carries a zero placeholder that is cut off here.
+const PLACEHOLDER_NONCE = new Uint8Array(RATCHET_NONCE_LEN);
+const packAadHeader = (header: RatchetHeader, pqEpoch: bigint): Uint8Array =>
+  packChunkFrameHeader(header, PLACEHOLDER_NONCE, pqEpoch).subarray(
+    0,
+    CHUNK_AAD_HEADER_LEN,
+  );
+
+/**
+ * SEAL one chunk cell ENTIRELY in libsodium — the send-side mirror of
+ * `receiveWithKey`. The pieces are staged once into a single heap block and the
+ * C `_seal_message_chunk` writes the finished WIRE_CHUNK_FRAME_LEN cell
+ * (`header ‖ fresh random nonce ‖ AEAD(metadata ‖ proof ‖ chunk)`) into the
+ * output block, building the AAD from the same helper the receive path uses.
+ * Two cell-sized slots per cell (`secureMalloc`); both are wiped on free.
+ */
+const sealWithKey = (
+  module: LibCrypto,
+  aadHeader: Uint8Array,
+  merkleRoot: Uint8Array,
+  metadata: Uint8Array,
+  proof: Uint8Array,
+  chunk: Uint8Array,
+  key: Uint8Array,
+): Uint8Array => {
+  // in = key(32) ‖ header(57) ‖ root(64) ‖ metadata ‖ proof ‖ chunk
+  const headerOff = AEAD_KEY_LEN;
+  const rootOff = headerOff + CHUNK_AAD_HEADER_LEN;
+  const metadataOff = rootOff + crypto_hash_sha512_BYTES;
+  const proofOff = metadataOff + METADATA_LEN;
+  const chunkOff = proofOff + PROOF_LEN;
+  const inLen = chunkOff + CHUNK_LEN;
+
+  const inPtr = secureMalloc(module, inLen);
+  const outPtr = secureMalloc(module, WIRE_CHUNK_FRAME_LEN);
+
+  const staged = new Uint8Array(module.wasmMemory.buffer, inPtr, inLen);
+  staged.set(key, 0);
+  staged.set(aadHeader, headerOff);
+  staged.set(merkleRoot, rootOff);
+  staged.set(metadata, metadataOff);
+  staged.set(proof, proofOff);
+  staged.set(chunk, chunkOff);
+
+  const r = module._seal_message_chunk(
+    outPtr,
+    inPtr + headerOff,
+    inPtr + rootOff,
+    inPtr + metadataOff,
+    inPtr + proofOff,
+    inPtr + chunkOff,
+    inPtr,
+  );
+
+  const out =
+    r === 0
+      ? Uint8Array.from(
+          new Uint8Array(
+            module.wasmMemory.buffer,
+            outPtr,
+            WIRE_CHUNK_FRAME_LEN,
+          ),
+        )
+      : null;
+
+  // The staging block holds the key and the plaintext — zero it before free.
+  zeroFree(module, new Uint8Array(module.wasmMemory.buffer, inPtr, inLen));
+  zeroFree(
+    module,
+    new Uint8Array(module.wasmMemory.buffer, outPtr, WIRE_CHUNK_FRAME_LEN),
+  );
+
+  if (!out) throw new Error("messageChunkCrypto: AEAD encrypt failed");
+  return out;
+};
+
 /**
- * Seal ONE chunk under an already-derived classical `messageKey` + `header`.
- * With a PQ context, an owned copy of the classical key is consumed by the v4
- * combiner and the resulting key is wiped after this one AEAD operation. The
- * caller's classical key remains live across streamed chunks/retransmit rounds.
- * The low-level context-free default emits bootstrap epoch zero and uses the
- * raw classical key for backwards-compatible tests only.
+ * Seal ONE chunk cell under an already-derived classical `messageKey` +
+ * `header`, from its three plaintext parts (METADATA_LEN metadata, PROOF_LEN
+ * proof, CHUNK_LEN chunk). With a PQ context, an owned copy of the classical key
+ * is consumed by the v4 combiner and the resulting key is wiped after this one
+ * AEAD operation. The caller's classical key remains live across streamed
+ * chunks/retransmit rounds. The low-level context-free default emits bootstrap
+ * epoch zero and uses the raw classical key for backwards-compatible tests only.
  *
  * This is the streaming/reconcile-friendly primitive the live send path uses: it
  * seals chunks one-at-a-time as they are read from IndexedDB, so a multi-GB
@@ -243,9 +476,11 @@ const receiveWithKey = (
  * (distinct 96-bit random nonces under one key) and decryptable by the receiver's
  * cached per-message key (a HIT on `(dhPub, N)`), so no frame-cache is needed.
  */
-export const sealChunk = (
+export const sealMessageChunk = (
   messageKey: Uint8Array,
   header: RatchetHeader,
+  metadata: Uint8Array,
+  proof: Uint8Array,
   chunk: Uint8Array,
   merkleRoot: Uint8Array,
   module: LibCrypto,
@@ -253,13 +488,13 @@ export const sealChunk = (
 ): Uint8Array => {
   if (merkleRoot.length !== crypto_hash_sha512_BYTES)
     throw new Error("messageChunkCrypto: merkleRoot must be 64 bytes");
-  const nonce = randomNonce(); // fresh + random per chunk
-  const frameHeader = packChunkFrameHeader(
-    header,
-    nonce,
-    pqContext?.epoch ?? 0n,
-  );
-  const aad = buildAad(merkleRoot, frameHeader);
+  if (
+    metadata.length !== METADATA_LEN ||
+    proof.length !== PROOF_LEN ||
+    chunk.length !== CHUNK_LEN
+  )
+    throw new Error("messageChunkCrypto: invalid chunk cell length");
+  const aadHeader = packAadHeader(header, pqContext?.epoch ?? 0n);
   let combinedKey: Uint8Array | null = null;
   try {
     const aeadKey = pqContext
@@ -270,16 +505,46 @@ export const sealChunk = (
           module,
         ))
       : messageKey;
-    const ciphertext = aeadSeal(module, aeadKey, nonce, chunk, aad);
-    const frame = new Uint8Array(frameHeader.length + ciphertext.length);
-    frame.set(frameHeader, 0);
-    frame.set(ciphertext, frameHeader.length);
-    return frame;
+    return sealWithKey(
+      module,
+      aadHeader,
+      merkleRoot,
+      metadata,
+      proof,
+      chunk,
+      aeadKey,
+    );
   } finally {
     combinedKey?.fill(0);
   }
 };
 
+/**
+ * `sealMessageChunk` over an already-concatenated DECRYPTED_LEN plaintext
+ * (`metadata ‖ proof ‖ chunk`).
+ */
+export const sealChunk = (
+  messageKey: Uint8Array,
+  header: RatchetHeader,
+  plaintext: Uint8Array,
+  merkleRoot: Uint8Array,
+  module: LibCrypto,
+  pqContext?: PqMessageKeyContext,
+): Uint8Array => {
+  if (plaintext.length !== DECRYPTED_LEN)
+    throw new Error("messageChunkCrypto: invalid chunk cell length");
+  return sealMessageChunk(
+    messageKey,
+    header,
+    plaintext.subarray(0, METADATA_LEN),
+    plaintext.subarray(METADATA_LEN, METADATA_LEN + PROOF_LEN),
+    plaintext.subarray(METADATA_LEN + PROOF_LEN),
+    merkleRoot,
+    module,
+    pqContext,
+  );
+};
+
 export interface DecryptedChunk {
   /** The DECRYPTED_LEN plaintext `metadata ‖ receiptLeaf ‖ chunk` written by the C
    *  receive, or `null` when the chunk was dropped (AEAD or Merkle failure). */
@@ -291,8 +556,22 @@ export interface DecryptedChunk {
    *  whose AEAD authenticated). The caller persists `state` when true — even if
    *  `ok` is false, since the DH step is real once the AEAD authenticates. */
   stateAdvanced: boolean;
+  /** Set when `decrypted` is a view of an ingress ring slot: wipes and frees
+   *  the slot. Use `discardDecrypted` rather than calling it directly. */
+  release?: () => void;
 }
 
+/**
+ * Wipe a decrypted chunk's plaintext and, when it lives in an ingress ring
+ * slot, hand the slot back. Safe to call more than once.
+ */
+export const discardDecrypted = (chunk: DecryptedChunk): void => {
+  chunk.decrypted?.fill(0);
+  const release = chunk.release;
+  chunk.release = undefined;
+  release?.();
+};
+
 /**
  * Resolve an authenticated, currently acceptable PQ epoch. Returning null
  * rejects unknown/stale/future epochs before a Double-Ratchet clone is touched.
@@ -313,6 +592,48 @@ const resolvedContextMatches = (
   context.binding instanceof Uint8Array &&
   context.binding.length === PQ_MESSAGE_KEY_BINDING_BYTES;
 
+/**
+ * Parse a frame and authorize its PQ epoch — everything `decryptMessageChunk`
+ * checks before it looks at the key cache. Null means drop the frame.
+ */
+const admitFrame = (
+  state: RatchetState,
+  frame: Uint8Array,
+  pqContextResolver?: PqMessageKeyContextResolver,
+): {
+  header: RatchetHeader;
+  pqContext: PqMessageKeyContext | null;
+  cacheK: string;
+} | null => {
+  const { header, pqEpoch } = parseChunkFrameHeader(frame);
+
+  let pqContext: PqMessageKeyContext | null = null;
+  if (pqContextResolver) {
+    try {
+      pqContext = pqContextResolver(pqEpoch);
+    } catch {
+      return null;
+    }
+    if (
+      !pqContext ||
+      !resolvedContextMatches(pqContext, pqEpoch, state.rootSuite)
+    )
+      return null;
+  } else if (pqEpoch !== 0n) {
+    // Context-free operation is a bootstrap-only low-level compatibility path.
+    // Never interpret a nonzero wire epoch as a raw classical key.
+    return null;
+  }
+
+  const cacheK = messageCacheKey(
+    header.dhPub,
+    header.N,
+    pqContextResolver ? pqEpoch : undefined,
+  );
+
+  return { header, pqContext, cacheK };
+};
+
 /**
  * RECEIVE one chunk frame: derive the per-message key off the ratchet (in TS —
  * the ratchet state is a TS object), then do ALL the crypto in ONE C call
@@ -337,6 +658,11 @@ const resolvedContextMatches = (
  * Cache lifecycle: the caller evicts a message's key (via `messageCacheKey`) when
  * the message completes (all leaves present) or on a TTL, so a peer can't pin keys
  * with never-completing messages.
+ *
+ * With an ingress `ring` the plaintext is a view of a ring slot and the result
+ * carries `release`; the caller must call `discardDecrypted` when done. A
+ * `proofCache` (one per inbound transfer, bound to `merkleRoot`) is handed to
+ * `receiveWithKey`.
  */
 export const decryptMessageChunk = (
   state: RatchetState,
@@ -345,49 +671,32 @@ export const decryptMessageChunk = (
   merkleRoot: Uint8Array,
   module: LibCrypto,
   pqContextResolver?: PqMessageKeyContextResolver,
+  ring?: IngressRing,
+  proofCache?: MerkleProofCache,
 ): DecryptedChunk => {
   if (merkleRoot.length !== crypto_hash_sha512_BYTES)
     throw new Error("messageChunkCrypto: merkleRoot must be 64 bytes");
 
-  const { header, pqEpoch } = parseChunkFrameHeader(frame);
-
-  let pqContext: PqMessageKeyContext | null = null;
-  if (pqContextResolver) {
-    try {
-      pqContext = pqContextResolver(pqEpoch);
-    } catch {
-      return { decrypted: null, ok: false, stateAdvanced: false };
-    }
-    if (
-      !pqContext ||
-      !resolvedContextMatches(pqContext, pqEpoch, state.rootSuite)
-    )
-      return { decrypted: null, ok: false, stateAdvanced: false };
-  } else if (pqEpoch !== 0n) {
-    // Context-free operation is a bootstrap-only low-level compatibility path.
-    // Never interpret a nonzero wire epoch as a raw classical key.
-    return { decrypted: null, ok: false, stateAdvanced: false };
-  }
-
-  const cacheK = messageCacheKey(
-    header.dhPub,
-    header.N,
-    pqContextResolver ? pqEpoch : undefined,
-  );
+  const admitted = admitFrame(state, frame, pqContextResolver);
+  if (!admitted) return { decrypted: null, ok: false, stateAdvanced: false };
+  const { header, pqContext, cacheK } = admitted;
 
   // HIT — reuse the per-message key; the ratchet is NOT touched.
   const cached = cache.get(cacheK);
   if (cached) {
-    const { code, decrypted } = receiveWithKey(
+    const { code, decrypted, release } = receiveWithKey(
       module,
       frame,
       merkleRoot,
       cached,
+      ring,
+      proofCache,
     );
     return {
       decrypted: code === 0 ? decrypted : null,
       ok: code === 0,
       stateAdvanced: false,
+      release,
     };
   }
 
@@ -405,11 +714,13 @@ export const decryptMessageChunk = (
     return { decrypted: null, ok: false, stateAdvanced: false };
   }
 
-  const { code, decrypted } = receiveWithKey(
+  const { code, decrypted, release } = receiveWithKey(
     module,
     frame,
     merkleRoot,
     messageKey,
+    ring,
+    proofCache,
   );
 
   if (code === -2) {
@@ -427,9 +738,77 @@ export const decryptMessageChunk = (
     decrypted: code === 0 ? decrypted : null,
     ok: code === 0,
     stateAdvanced: true,
+    release,
   };
 };
 
+/**
+ * `decryptMessageChunk` over many frames. A frame whose per-message key is not
+ * cached yet goes through `decryptMessageChunk` on its own (it may step the
+ * ratchet and cache the key). Every frame whose key is already cached is opened
+ * in batches by ONE `_receive_message_batch` call per batch, so a burst of
+ * cells for one message costs a few WASM transitions instead of one per frame.
+ * Results are returned in frame order. A `proofCache` is used for every frame.
+ */
+export const decryptMessageChunks = (
+  state: RatchetState,
+  frames: Uint8Array[],
+  cache: Map<string, Uint8Array>,
+  merkleRoot: Uint8Array,
+  module: LibCrypto,
+  pqContextResolver?: PqMessageKeyContextResolver,
+  proofCache?: MerkleProofCache,
+): DecryptedChunk[] => {
+  if (merkleRoot.length !== crypto_hash_sha512_BYTES)
+    throw new Error("messageChunkCrypto: merkleRoot must be 64 bytes");
+
+  const results: DecryptedChunk[] = new Array<DecryptedChunk>(frames.length);
+  const hitIndexes: number[] = [];
+  const hitKeys: Uint8Array[] = [];
+
+  for (let i = 0; i < frames.length; i++) {
+    const admitted = admitFrame(state, frames[i], pqContextResolver);
+    if (!admitted) {
+      results[i] = { decrypted: null, ok: false, stateAdvanced: false };
+      continue;
+    }
+
+    const cached = cache.get(admitted.cacheK);
+    if (cached) {
+      hitIndexes.push(i);
+      hitKeys.push(cached);
+    } else {
+      results[i] = decryptMessageChunk(
+        state,
+        frames[i],
+        cache,
+        merkleRoot,
+        module,
+        pqContextResolver,
+        undefined,
+        proofCache,
+      );
+    }
+  }
+
+  const opened = receiveBatchWithKeys(
+    module,
+    hitIndexes.map((i) => frames[i]),
+    merkleRoot,
+    hitKeys,
+    proofCache,
+  );
+  opened.forEach(({ code, decrypted }, j) => {
+    results[hitIndexes[j]] = {
+      decrypted: code === 0 ? decrypted : null,
+      ok: code === 0,
+      stateAdvanced: false,
+    };
+  });
+
+  return results;
+};
+
 // Derive the message key on a clone. Isolated so a `ratchetDecrypt` throw (e.g.
 // an already-consumed same-chain replay, `header.N < Nr`) never leaves a
 // half-mutated live state — the clone is thrown away with the exception.
@@ -7,8 +7,14 @@ import {
 } from "../cryptography/ratchet";
 import { deleteRatchetSession, setRatchetSession } from "../db/api";
 import { MAX_SKIP_SESSION } from "../utils/constants";
-import { decryptMessageChunk, messageCacheKey } from "./messageChunkCrypto";
+import {
+  decryptMessageChunk,
+  decryptMessageChunks,
+  discardDecrypted,
+  messageCacheKey,
+} from "./messageChunkCrypto";
 import { parseChunkFrameHeader } from "./chunkFrame";
+import { receiveProofCache } from "./receiveProofCache";
 
 import type { LibCrypto } from "../cryptography/libcrypto";
 import type { IRTCPeerConnection } from "../api/webrtc/interfaces";
@@ -403,7 +409,12 @@ export const ratchetEncryptDurably = async (
     epc,
     roomId,
     (candidate) => {
-      const stepped = ratchetEncrypt(candidate, module);
+      // Step where the edge's ratchet engine already lives (the receive module
+      // after the handshake), so sends do not move it to a per-send heap.
+      const stepped = ratchetEncrypt(
+        candidate,
+        candidate.engine?.module ?? module,
+      );
       const pq = epc.pqHealingState;
       let pqContext: PqMessageKeyContext | null = null;
       if (pq) {
@@ -438,7 +449,9 @@ export const ratchetEncryptDurably = async (
  * Decrypt one inbound chunk with a staged state/cache. An authenticated ratchet
  * advance becomes visible only after its snapshot is durable; persistence
  * failure rejects without advancing live state, caching a key, or exposing the
- * decrypted bytes. Cache hits do not advance or persist the ratchet.
+ * decrypted bytes. Cache hits do not advance or persist the ratchet. With an
+ * `epc.ingressRing` the plaintext is a ring slot view; release it with
+ * `discardDecrypted`. Proofs are checked against the transfer's proof cache.
  */
 export const decryptMessageChunkDurably = async (
   epc: IRTCPeerConnection,
@@ -471,6 +484,8 @@ export const decryptMessageChunkDurably = async (
           ? (epoch: bigint): PqMessageKeyContext | null =>
               pq.resolveMessageContext(epoch)
           : undefined,
+        epc.ingressRing,
+        receiveProofCache(epc, merkleRoot, module),
       );
 
       if (!decrypted.stateAdvanced)
@@ -478,7 +493,7 @@ export const decryptMessageChunkDurably = async (
 
       const stagedMessageKey = stagedCache.get(cacheKey);
       if (!stagedMessageKey || cache.has(cacheKey)) {
-        decrypted.decrypted?.fill(0);
+        discardDecrypted(decrypted);
         throw new Error("ratchet persistence: invalid staged receive cache");
       }
 
@@ -500,7 +515,7 @@ export const decryptMessageChunkDurably = async (
           },
           rollback: () => {
             stagedMessageKey.fill(0);
-            decrypted.decrypted?.fill(0);
+            discardDecrypted(decrypted);
           },
         };
       }
@@ -526,13 +541,68 @@ export const decryptMessageChunkDurably = async (
         rollback: () => {
           durableMessageKey.fill(0);
           stagedMessageKey.fill(0);
-          decrypted.decrypted?.fill(0);
+          discardDecrypted(decrypted);
         },
       };
     },
     persist,
   );
 
+/**
+ * Open frames whose per-message key is already in `cache` in one pass under the
+ * edge lock: `decryptMessageChunks` stages them into batched
+ * `_receive_message_batch` calls. Cache hits never step the ratchet, so there
+ * is nothing to persist. A frame whose key is not cached (retired since the
+ * caller checked) is dropped here rather than stepped outside
+ * `decryptMessageChunkDurably`. Plaintexts are owned copies.
+ */
+export const decryptCachedMessageChunksDurably = async (
+  epc: IRTCPeerConnection,
+  roomId: string,
+  frames: Uint8Array[],
+  cache: Map<string, Uint8Array>,
+  merkleRoot: Uint8Array,
+  module: LibCrypto,
+  persist: PersistRatchetState = persistRatchetState,
+): Promise<DecryptedChunk[]> =>
+  mutateRatchetDurably(
+    epc,
+    roomId,
+    (candidate) => {
+      const pq = epc.pqHealingState;
+      const hits = frames.map((frame) => {
+        const { header, pqEpoch } = parseChunkFrameHeader(frame);
+        return cache.has(
+          messageCacheKey(header.dhPub, header.N, pq ? pqEpoch : undefined),
+        );
+      });
+      const opened = decryptMessageChunks(
+        candidate,
+        frames.filter((_, i) => hits[i]),
+        cache,
+        merkleRoot,
+        module,
+        pq
+          ? (epoch: bigint): PqMessageKeyContext | null =>
+              pq.resolveMessageContext(epoch)
+          : undefined,
+        receiveProofCache(epc, merkleRoot, module),
+      );
+
+      let next = 0;
+      return {
+        value: hits.map(
+          (hit): DecryptedChunk =>
+            hit
+              ? opened[next++]
+              : { decrypted: null, ok: false, stateAdvanced: false },
+        ),
+        advanced: false,
+      };
+    },
+    persist,
+  );
+
 /**
  * Durably retire the active receive key after the atomic chunk manifest reports
  * completion, then erase the RAM cache copy. If persistence fails, both copies
@@ -1,8 +1,12 @@
 import {
   CHANNEL_OPEN_POLL_MS,
+  CHUNK_RANGE_RECEIPT_MAX_CHUNKS,
+  FRAME_TYPE_RANGE_RECEIPT,
   FRAME_TYPE_RECEIPT,
   MAX_BUFFERED_AMOUNT,
+  RANGE_RECEIPT_HEADER_LEN,
   RECEIPT_TOKEN_LEN,
+  WIRE_RANGE_RECEIPT_FRAME_LEN,
   WIRE_RECEIPT_FRAME_LEN,
 } from "../utils/constants";
 
@@ -31,6 +35,64 @@ export const decodeReceiptFrame = (
     ? frame.subarray(1)
     : undefined;
 
+export interface RangeReceipt {
+  first: number;
+  count: number;
+  token: Uint8Array;
+}
+
+/** Encode a range receipt: tag(1) || first(8 BE) || count(8 BE) || token(64). */
+export const encodeRangeReceiptFrame = ({
+  first,
+  count,
+  token,
+}: RangeReceipt): Uint8Array => {
+  if (token.length !== RECEIPT_TOKEN_LEN)
+    throw new Error("Receipt token must be exactly 64 bytes");
+  if (
+    !Number.isSafeInteger(first) ||
+    first < 0 ||
+    !Number.isInteger(count) ||
+    count < 1 ||
+    count > CHUNK_RANGE_RECEIPT_MAX_CHUNKS
+  )
+    throw new Error("Invalid range receipt");
+
+  const frame = new Uint8Array(WIRE_RANGE_RECEIPT_FRAME_LEN);
+  const view = new DataView(frame.buffer);
+  frame[0] = FRAME_TYPE_RANGE_RECEIPT;
+  view.setBigUint64(1, BigInt(first), false);
+  view.setBigUint64(9, BigInt(count), false);
+  frame.set(token, 1 + RANGE_RECEIPT_HEADER_LEN);
+  return frame;
+};
+
+/**
+ * Parse the payload after the tag (first ‖ count ‖ token). Anything past the
+ * safe-integer range or the per-frame cap is rejected here, before a lookup.
+ */
+export const decodeRangeReceiptPayload = (
+  payload: Uint8Array,
+): RangeReceipt | undefined => {
+  if (payload.length !== WIRE_RANGE_RECEIPT_FRAME_LEN - 1) return undefined;
+
+  const view = new DataView(payload.buffer, payload.byteOffset, 16);
+  const first = view.getBigUint64(0, false);
+  const count = view.getBigUint64(8, false);
+  if (
+    first > BigInt(Number.MAX_SAFE_INTEGER) ||
+    count < 1n ||
+    count > BigInt(CHUNK_RANGE_RECEIPT_MAX_CHUNKS)
+  )
+    return undefined;
+
+  return {
+    first: Number(first),
+    count: Number(count),
+    token: payload.subarray(RANGE_RECEIPT_HEADER_LEN),
+  };
+};
+
 export const sendReceiptFrame = (
   channel: Pick<ReceiptSendChannel, "readyState" | "send">,
   token: Uint8Array,
@@ -44,15 +106,15 @@ export const RECEIPT_REPLAY_BATCH_SIZE = 32;
 export const RECEIPT_REPLAY_PAUSE_MS = 10;
 
 /**
- * Replay a reconnect have-set without filling SCTP or monopolising the event
- * loop. The caller may then send the terminal receipt on the same channel.
+ * Replay already-encoded receipt and range-receipt frames without filling SCTP
+ * or monopolising the event loop.
  */
-export const sendReceiptFramesPaced = async (
+export const sendEncodedFramesPaced = async (
   channel: ReceiptSendChannel,
-  tokens: Iterable<Uint8Array>,
+  frames: Iterable<Uint8Array>,
 ): Promise<boolean> => {
   let inBatch = 0;
-  for (const token of tokens) {
+  for (const frame of frames) {
     while (
       channel.readyState === "open" &&
       channel.bufferedAmount >= MAX_BUFFERED_AMOUNT
@@ -61,7 +123,7 @@ export const sendReceiptFramesPaced = async (
     }
     if (channel.readyState !== "open") return false;
 
-    channel.send(encodeReceiptFrame(token).buffer as ArrayBuffer);
+    channel.send(frame.buffer as ArrayBuffer);
     inBatch++;
     if (inBatch === RECEIPT_REPLAY_BATCH_SIZE) {
       inBatch = 0;
@@ -72,3 +134,17 @@ export const sendReceiptFramesPaced = async (
   }
   return channel.readyState === "open";
 };
+
+/**
+ * Replay a reconnect have-set without filling SCTP or monopolising the event
+ * loop. The caller may then send the terminal receipt on the same channel.
+ */
+export const sendReceiptFramesPaced = async (
+  channel: ReceiptSendChannel,
+  tokens: Iterable<Uint8Array>,
+): Promise<boolean> => {
+  const frames = function* (): Generator<Uint8Array> {
+    for (const token of tokens) yield encodeReceiptFrame(token);
+  };
+  return sendEncodedFramesPaced(channel, frames());
+};
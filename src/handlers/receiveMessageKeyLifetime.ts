@@ -1,4 +1,5 @@
 import { forgetReceiveMessageKeyDurably } from "./ratchetPersist";
+import { forgetReceiveProofCache } from "./receiveProofCache";
 
 import type { IRTCPeerConnection } from "../api/webrtc/interfaces";
 import type { MessageData } from "../db/types";
@@ -35,6 +36,7 @@ const isComplete = (progress: ReceiveProgress | undefined): boolean =>
 /**
  * Durably retire the key mapped to one transfer. The root binding is removed
  * only after persistence succeeds, so failure leaves an idempotent retry path.
+ * The transfer's proof cache is freed up front; it is never persisted.
  */
 export const forgetMappedReceiveMessageKey = async (
   epc: IRTCPeerConnection,
@@ -47,6 +49,7 @@ export const forgetMappedReceiveMessageKey = async (
   if (existing) return existing;
 
   const retirement = (async (): Promise<boolean> => {
+    forgetReceiveProofCache(epc, merkleRootHex);
     const cacheKey = epc.messageKeyByMerkleRoot?.get(merkleRootHex);
     const cache = epc.messageKeyCache;
     if (!cacheKey || !cache) return false;
@@ -0,0 +1,61 @@
+import { createMerkleProofCache } from "../cryptography/merkle";
+import { merkle_proof_cache_STATEBYTES } from "../cryptography/interfaces";
+import { uint8ArrayToHex } from "../utils/uint8array";
+
+import type { LibCrypto } from "../cryptography/libcrypto";
+import type { MerkleProofCache } from "../cryptography/merkle";
+import type { IRTCPeerConnection } from "../api/webrtc/interfaces";
+
+/**
+ * Inbound transfers per edge that keep a Merkle proof cache. A transfer past
+ * the cap takes the oldest one's slot; the evicted transfer rebuilds its cache
+ * on its next chunk, so the cap bounds memory, never verification.
+ */
+export const RECEIVE_PROOF_CACHE_MAX = 2;
+
+/** Heap the receive module reserves for its proof caches (protocolV3Memory). */
+export const RECEIVE_PROOF_CACHE_RESERVE_BYTES =
+  RECEIVE_PROOF_CACHE_MAX * merkle_proof_cache_STATEBYTES;
+
+/**
+ * The proof cache of the inbound transfer with root `merkleRoot`, created in
+ * `module` on its first chunk. Call it inside the edge's ratchet lock and do
+ * not hold the result across an await: a later transfer may evict it.
+ */
+export const receiveProofCache = (
+  epc: IRTCPeerConnection,
+  merkleRoot: Uint8Array,
+  module: LibCrypto,
+): MerkleProofCache => {
+  const merkleRootHex = uint8ArrayToHex(merkleRoot);
+  epc.proofCaches ??= new Map<string, MerkleProofCache>();
+  const existing = epc.proofCaches.get(merkleRootHex);
+  if (existing) return existing;
+
+  for (const [root, cache] of epc.proofCaches) {
+    if (epc.proofCaches.size < RECEIVE_PROOF_CACHE_MAX) break;
+    cache.free();
+    epc.proofCaches.delete(root);
+  }
+
+  const cache = createMerkleProofCache(merkleRoot, module);
+  epc.proofCaches.set(merkleRootHex, cache);
+  return cache;
+};
+
+/** Free the proof cache of one transfer once it completes or is cancelled. */
+export const forgetReceiveProofCache = (
+  epc: IRTCPeerConnection,
+  merkleRootHex: string,
+): void => {
+  epc.proofCaches?.get(merkleRootHex)?.free();
+  epc.proofCaches?.delete(merkleRootHex);
+};
+
+/** Free every proof cache of an edge that is being torn down. */
+export const freeReceiveProofCaches = (epc: IRTCPeerConnection): void => {
+  if (!epc.proofCaches) return;
+  for (const cache of epc.proofCaches.values()) cache.free();
+  epc.proofCaches.clear();
+  epc.proofCaches = undefined;
+};
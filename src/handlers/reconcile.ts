@@ -40,6 +40,49 @@ export const markChunkAcked = (
   return acked.size !== previousSize;
 };
 
+// A verified range receipt acknowledges every chunk in [first, first + count).
+// Returns how many of them are new to this edge.
+export const markChunkRangeAcked = (
+  roomId: string,
+  peerId: string,
+  transferId: string,
+  first: number,
+  count: number,
+): number => {
+  const acked = edge(roomId, peerId, transferId).acked;
+  const previousSize = acked.size;
+  for (let chunkIndex = first; chunkIndex < first + count; chunkIndex++)
+    acked.add(chunkIndex);
+  return acked.size - previousSize;
+};
+
+// Range receipts are checked against the sender's own leaves, which only live
+// in the transfer's Merkle tree while it is being sent. sendMessage registers
+// the tree's check here for that window; a range receipt for any other
+// transfer has nothing to verify against and is ignored.
+export type RangeReceiptVerifier = (
+  first: number,
+  count: number,
+  token: Uint8Array,
+) => boolean;
+
+const rangeReceiptVerifiers = new Map<string, RangeReceiptVerifier>();
+
+export const setRangeReceiptVerifier = (
+  transferId: string,
+  verify: RangeReceiptVerifier,
+): void => {
+  rangeReceiptVerifiers.set(transferId, verify);
+};
+
+export const getRangeReceiptVerifier = (
+  transferId: string,
+): RangeReceiptVerifier | undefined => rangeReceiptVerifiers.get(transferId);
+
+export const clearRangeReceiptVerifier = (transferId: string): void => {
+  rangeReceiptVerifiers.delete(transferId);
+};
+
 // A defensive copy — the caller (sendChunks reconcile filter) must not mutate
 // the live set, which keeps growing as more receipts arrive.
 export const getAckedChunks = (
@@ -9,10 +9,15 @@ import {
   generateSessionIdentity,
   restoreSession,
 } from "./session";
-import { generateMnemonic, keyPairFromMnemonic } from "./cryptography/mnemonic";
+import {
+  ARGON2_PROFILE_BACKUP,
+  ARGON2_PROFILE_INTERACTIVE,
+  generateMnemonic,
+  keyPairFromMnemonic,
+} from "./cryptography/mnemonic";
 import { crypto_hash_sha512_BYTES } from "./cryptography/interfaces";
-import { setWasmSourceUrl } from "./cryptography/wasmLoader";
-import { setDebugLogging } from "./utils/debug";
+import { setWasmSourceUrl, setWasmThreads } from "./cryptography/wasmLoader";
+import { getCryptoStats, setDebugLogging } from "./utils/debug";
 
 import {
   deleteDBAddressBookEntry,
@@ -1297,6 +1302,7 @@ export const p2party = {
   restoreSession,
   generateSessionIdentity,
   setWasmSourceUrl,
+  setWasmThreads,
   DEFAULT_ROOM_POLICY_V1,
   encodeRoomPolicyV1,
   decodeRoomPolicyV1,
@@ -1309,6 +1315,8 @@ export const p2party = {
   newKeyPair,
   generateMnemonic,
   keyPairFromMnemonic,
+  ARGON2_PROFILE_INTERACTIVE,
+  ARGON2_PROFILE_BACKUP,
   MIN_CHUNKS: 1,
   MIN_CHUNK_SIZE: CHUNK_SIZE_FLOOR + 1,
   MAX_CHUNK_SIZE: CHUNK_LEN,
@@ -1325,6 +1333,7 @@ export const p2party = {
   waitForPeers,
   onMessage,
   setDebugLogging,
+  getCryptoStats,
   MIN_PERCENTAGE_FILLED_CHUNK: 0.1,
   // 100%-full cells make identical content roots deterministic. Keep at least
   // 1% RNG padding as the fresh wire/storage transfer namespace; this is not a
@@ -1380,12 +1389,14 @@ export {
   restoreSession,
   generateSessionIdentity,
   setWasmSourceUrl,
+  setWasmThreads,
   MessageDeliveryError,
   joinRoom,
   waitForRoom,
   waitForPeers,
   onMessage,
   setDebugLogging,
+  getCryptoStats,
 };
 
 export {
@@ -1412,6 +1423,14 @@ export {
 
 export type { TransferAck } from "./handlers/reconcile";
 
+export type { Argon2Profile } from "./cryptography/mnemonic";
+
+export type {
+  CryptoStats,
+  ExportStats,
+  StatsExport,
+} from "./cryptography/stats";
+
 export type {
   RoomAuthMode,
   RoomCoverMode,
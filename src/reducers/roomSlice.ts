@@ -634,6 +634,14 @@ const roomSlice = createSlice({
               merkleRootHex;
           }
 
+          // The sender's chunker only knows the file hash after its pass.
+          if (
+            sha512Hex.length === crypto_hash_sha512_BYTES * 2 &&
+            state[roomIndex].messages[messageIndex].sha512Hex === ""
+          ) {
+            state[roomIndex].messages[messageIndex].sha512Hex = sha512Hex;
+          }
+
           if (
             totalSize > 0 &&
             state[roomIndex].messages[messageIndex].totalSize !== totalSize
@@ -15,7 +15,8 @@ import {
   serializeRatchet,
   wipeRatchet,
 } from "./cryptography/ratchet";
-import { getMerkleProof, getMerkleRoot } from "./cryptography/merkle";
+import { createMerkleTree } from "./cryptography/merkle";
+import { cryptoStats } from "./cryptography/stats";
 import {
   crypto_hash_sha512_BYTES,
   crypto_sign_ed25519_BYTES,
@@ -29,10 +30,13 @@ import {
   performHandshakeCore,
   type HandshakeTransport,
 } from "./handlers/handshakeCore";
-import { decryptMessageChunk, sealChunk } from "./handlers/messageChunkCrypto";
+import {
+  decryptMessageChunks,
+  sealChunk,
+} from "./handlers/messageChunkCrypto";
 import { parseChunkFrameHeader } from "./handlers/chunkFrame";
 import { SparsePqHealingState } from "./handlers/pqHealingRuntime";
-import { hashMerkleLeafWasm } from "./utils/leafHash";
+import { hashMerkleLeavesWasm } from "./utils/leafHash";
 import {
   CHUNK_LEN,
   DECRYPTED_LEN,
@@ -51,6 +55,7 @@ import { MessageType } from "./utils/messageTypes";
 import { AsyncMutex } from "./utils/mutex";
 
 import type { LibCrypto } from "./cryptography/libcrypto";
+import type { CryptoStats } from "./cryptography/stats";
 import type {
   RatchetSessionSecrets,
   RatchetState,
@@ -97,6 +102,11 @@ const SESSION_METADATA_NAME = "p2party-session";
 
 export type { HandshakeTransport };
 export type { RoomPqMode } from "./roomPolicy";
+export type {
+  CryptoStats,
+  ExportStats,
+  StatsExport,
+} from "./cryptography/stats";
 
 /**
  * The wire constants a caller needs to build its own outer framing. The
@@ -196,6 +206,12 @@ export interface P2PartySession {
    * encryption with rollback protection; never send this blob to the peer.
    */
   serialize(): Promise<Uint8Array>;
+  /**
+   * Per-export call counts, bytes, return codes and latency histograms of this
+   * session's crypto module, or null when its artifact was built without them
+   * (production builds, unless built with P2PARTY_WASM_STATS=1).
+   */
+  cryptoStats(): CryptoStats | null;
   destroy(): Promise<void>;
 }
 
@@ -262,6 +278,8 @@ const loadSessionCrypto = async (
       getRandomValue: secureRandomUint32,
     })) as LibCrypto;
   }
+  // Single-threaded like every per-owner module; the threaded artifact's
+  // workers outlive it, so only sharedModule() loads that one.
   return (await wasmLoader(wasmMemory)) as LibCrypto;
 };
 
@@ -409,44 +427,36 @@ const prepareMessage = async (
     }
 
     const contentHash = await sha512(plaintext);
-    const leaves = new Uint8Array(totalChunks * crypto_hash_sha512_BYTES);
-    for (let index = 0; index < chunks.length; index++) {
-      leaves.set(
-        hashMerkleLeafWasm(chunks[index], module),
-        index * crypto_hash_sha512_BYTES,
-      );
-    }
-    // getMerkleRoot returns the input view for a one-leaf tree, so always take
-    // an owned copy before wiping the temporary leaf array below.
-    const root = Uint8Array.from(await getMerkleRoot(leaves, module));
-
-    for (let index = 0; index < chunks.length; index++) {
-      const proof = await getMerkleProof(
-        leaves,
-        hashMerkleLeafWasm(chunks[index], module),
-        module,
-        PROOF_LEN,
-      );
-      const usefulLength = Math.min(
-        CHUNK_LEN,
-        Math.max(0, totalSize - index * CHUNK_LEN),
-      );
-      const metadata = serializeMetadata({
-        schemaVersion: 1,
-        messageType: MessageType.Unknown,
-        hash: contentHash,
-        totalSize,
-        date: new Date(0),
-        name: SESSION_METADATA_NAME,
-        chunkStartIndex: 0,
-        chunkEndIndex: usefulLength,
-        chunkIndex: index,
-      });
-      const chunkPlaintext = new Uint8Array(DECRYPTED_LEN);
-      chunkPlaintext.set(metadata, 0);
-      chunkPlaintext.set(proof, METADATA_LEN);
-      chunkPlaintext.set(chunks[index], METADATA_LEN + PROOF_LEN);
-      plaintexts.push(chunkPlaintext);
+    const leaves = hashMerkleLeavesWasm(chunks, module);
+    const merkleTree = await createMerkleTree(leaves, module);
+    const root = merkleTree.root;
+
+    try {
+      for (let index = 0; index < chunks.length; index++) {
+        const proof = merkleTree.getProof(index, PROOF_LEN);
+        const usefulLength = Math.min(
+          CHUNK_LEN,
+          Math.max(0, totalSize - index * CHUNK_LEN),
+        );
+        const metadata = serializeMetadata({
+          schemaVersion: 1,
+          messageType: MessageType.Unknown,
+          hash: contentHash,
+          totalSize,
+          date: new Date(0),
+          name: SESSION_METADATA_NAME,
+          chunkStartIndex: 0,
+          chunkEndIndex: usefulLength,
+          chunkIndex: index,
+        });
+        const chunkPlaintext = new Uint8Array(DECRYPTED_LEN);
+        chunkPlaintext.set(metadata, 0);
+        chunkPlaintext.set(proof, METADATA_LEN);
+        chunkPlaintext.set(chunks[index], METADATA_LEN + PROOF_LEN);
+        plaintexts.push(chunkPlaintext);
+      }
+    } finally {
+      merkleTree.free();
     }
     contentHash.fill(0);
     leaves.fill(0);
@@ -670,18 +680,22 @@ class Session implements P2PartySession {
       let committed = false;
       try {
         const records: DecryptedRecord[] = [];
-        for (const frame of frames) {
-          const result = decryptMessageChunk(
-            next,
-            frame,
-            stagedCache,
-            root,
-            this.#module,
-            (epoch: bigint) => this.#pq.resolveMessageContext(epoch),
-          );
+        // The first frame steps the ratchet; the rest ride its cached key and
+        // are opened in batched C calls.
+        const results = decryptMessageChunks(
+          next,
+          frames,
+          stagedCache,
+          root,
+          this.#module,
+          (epoch: bigint) => this.#pq.resolveMessageContext(epoch),
+        );
+        for (const result of results) {
+          if (result.decrypted) decryptedBuffers.push(result.decrypted);
+        }
+        for (const result of results) {
           if (!result.ok || !result.decrypted)
             throw new Error("session: encrypted frame authentication failed");
-          decryptedBuffers.push(result.decrypted);
           const metadata = deserializeMetadata(
             result.decrypted.subarray(0, METADATA_LEN),
           );
@@ -755,6 +769,11 @@ class Session implements P2PartySession {
     });
   }
 
+  cryptoStats(): CryptoStats | null {
+    this.#assertLive();
+    return cryptoStats(this.#module);
+  }
+
   async destroy(): Promise<void> {
     await this.#mutex.runExclusive(async () => {
       if (this.#destroyed) return;
@@ -65,6 +65,15 @@ export const FRAME_TYPE_PQ_CONTROL = 5;
 // this exact tagged geometry.
 export const RECEIPT_TOKEN_LEN = crypto_hash_sha512_BYTES;
 export const WIRE_RECEIPT_FRAME_LEN = FRAME_TYPE_LEN + RECEIPT_TOKEN_LEN; // 65
+// A range receipt acknowledges the contiguous chunks [first, first + count)
+// with one token: tag(1) || first(8 BE) || count(8 BE) || token(64). The run
+// is capped at CHUNK_RANGE_RECEIPT_MAX_CHUNKS (merkle.h) so the receiver's
+// leaves fit the fixed WASM heap.
+export const FRAME_TYPE_RANGE_RECEIPT = 6;
+export const RANGE_RECEIPT_HEADER_LEN = 16;
+export const WIRE_RANGE_RECEIPT_FRAME_LEN =
+  FRAME_TYPE_LEN + RANGE_RECEIPT_HEADER_LEN + RECEIPT_TOKEN_LEN; // 81
+export const CHUNK_RANGE_RECEIPT_MAX_CHUNKS = 1024;
 // CPace/channel-input suite marker. 0x01 means the mandatory protocol-v4
 // classical-or-CPace + ML-KEM-768 hybrid bootstrap. It is transcript/KDF
 // context, not the KEM ciphertext and not a negotiation/fallback bit.
@@ -151,10 +160,9 @@ export const isRatchetRootSuite = (value: unknown): value is RatchetRootSuite =>
 
 // Double Ratchet KDF domain-separation labels (protocol-v4). These are the
 // `info` strings for the two HKDF-SHA512 chains of the ratchet, and are SSOT
-// constants that MUST byte-match any C-side kdf_rk/kdf_ck should one be added
-// (the ratchet state machine currently derives them in TS on the compiled
-// crypto_auth_hmacsha512 via hkdf.ts). Same "p2party-*-v1" convention as
-// CPace DSIs above.
+// constants that MUST byte-match the labels in ratchet.c, where the ratchet
+// engine derives both chains. Same "p2party-*-v1" convention as CPace DSIs
+// above.
 //   kdf_rk: (rootKey, DH(...)) -> (newRootKey ‖ chainKey)   [HKDF extract+expand]
 //   kdf_ck: chainKey           -> (nextChainKey, messageKey) [two labelled HMACs]
 export const KDF_RK_LABEL = "p2party-rk-v1";
@@ -206,7 +214,7 @@ export const MAX_RESUME_ATTEMPTS = 3;
 // Streaming send-side hash: read the file from disk one HASH_WINDOW_BYTES slice
 // at a time (O(1) memory — never the whole file) and feed it to the WASM
 // incremental SHA-512 in HASH_WASM_CHUNK_BYTES sub-chunks (the WASM heap buffer
-// is tiny and fixed; the merkle module's memory can't grow). SSOT.
+// is tiny and fixed, so it fits a fixed-size module's memory). SSOT.
 export const HASH_WINDOW_BYTES = 1024 * 1024; // 1 MiB disk read window
 export const HASH_WASM_CHUNK_BYTES = 64 * 1024; // 64 KiB WASM update buffer
 
@@ -19,6 +19,11 @@
  *   localStorage.setItem("p2party:debug", "1")
  */
 
+import { cryptoStats, mergeCryptoStats } from "../cryptography/stats";
+
+import type { LibCrypto } from "../cryptography/libcrypto";
+import type { CryptoStats } from "../cryptography/stats";
+
 let enabled = false;
 
 const readPersistedFlag = (): boolean => {
@@ -44,3 +49,49 @@ export const isDebugLogging = (): boolean => enabled;
 export const debugLog = (...args: unknown[]): void => {
   if (enabled) console.log(...args);
 };
+
+// libcrypto call statistics (cryptography/stats.ts) for the whole realm:
+// every module wasmLoader has loaded that is still alive, plus the totals of
+// those retired when their send or peer finished.
+const liveModules = new Set<WeakRef<LibCrypto>>();
+let retiredStats: CryptoStats | null = null;
+
+/**
+ * Count `module` in getCryptoStats. wasmLoader calls this for every load; a
+ * module built without statistics is not tracked.
+ */
+export const trackCryptoStats = (module: LibCrypto): void => {
+  if (module._libcrypto_stats_bytes() === 0) return;
+  liveModules.add(new WeakRef(module));
+};
+
+/**
+ * Fold a module's statistics into the realm totals before it is dropped; a
+ * module that is collected without this takes its counts with it.
+ */
+export const retireCryptoStats = (module: LibCrypto): void => {
+  for (const ref of liveModules) {
+    const live = ref.deref();
+    if (live === module)
+      retiredStats = mergeCryptoStats(retiredStats, cryptoStats(module));
+    if (!live || live === module) liveModules.delete(ref);
+  }
+};
+
+/**
+ * Calls, bytes, return codes and latency histograms per libcrypto export,
+ * summed over this realm's modules. Compare the time spent here with a
+ * transfer's duration to tell a CPU-bound slowdown from a transport-bound
+ * one. Null unless the WASM was built with statistics (development builds,
+ * or production with P2PARTY_WASM_STATS=1).
+ */
+export const getCryptoStats = (): CryptoStats | null => {
+  let total = retiredStats;
+  for (const ref of liveModules) {
+    const module = ref.deref();
+    if (module) total = mergeCryptoStats(total, cryptoStats(module));
+    else liveModules.delete(ref);
+  }
+
+  return total;
+};
@@ -50,6 +50,60 @@ export const hashMerkleLeafWasm = (
   }
 };
 
+// Chunks per `_merkle_leaf_hash_batch` call: one full group for the four-lane
+// SHA-512 kernel, which also bounds the staging copy to four chunks.
+const LEAF_HASH_BATCH = 4;
+
+/**
+ * Batched `hashMerkleLeafWasm`: the equally sized chunks are hashed four at a
+ * time by the lane-interleaved SHA-512 in C (`merkle_leaf_hash_batch`).
+ * Returns the concatenated leaf hashes, byte-identical to hashing each chunk
+ * with `hashMerkleLeafWasm`.
+ */
+export const hashMerkleLeavesWasm = (
+  chunks: Uint8Array[],
+  module: LibCrypto,
+): Uint8Array => {
+  const leaves = new Uint8Array(chunks.length * crypto_hash_sha512_BYTES);
+  if (chunks.length === 0) return leaves;
+
+  const chunkLen = chunks[0].length;
+  if (chunks.some((chunk) => chunk.length !== chunkLen))
+    throw new Error("hashMerkleLeavesWasm: chunks must have equal lengths");
+
+  const batch = Math.min(LEAF_HASH_BATCH, chunks.length);
+  const chunksPtr = module._malloc(Math.max(1, batch * chunkLen));
+  const outPtr = module._malloc(batch * crypto_hash_sha512_BYTES);
+  try {
+    for (let i = 0; i < chunks.length; i += batch) {
+      const count = Math.min(batch, chunks.length - i);
+      const staged = new Uint8Array(
+        module.wasmMemory.buffer,
+        chunksPtr,
+        count * chunkLen,
+      );
+      for (let j = 0; j < count; j++) staged.set(chunks[i + j], j * chunkLen);
+
+      if (module._merkle_leaf_hash_batch(count, chunkLen, chunksPtr, outPtr))
+        throw new Error("hashMerkleLeavesWasm: merkle_leaf_hash_batch failed");
+
+      leaves.set(
+        new Uint8Array(
+          module.wasmMemory.buffer,
+          outPtr,
+          count * crypto_hash_sha512_BYTES,
+        ),
+        i * crypto_hash_sha512_BYTES,
+      );
+    }
+
+    return leaves;
+  } finally {
+    module._free(chunksPtr);
+    module._free(outPtr);
+  }
+};
+
 export const hashMerkleLeaf = async (
   chunk: Uint8Array,
 ): Promise<Uint8Array> => {
@@ -66,6 +66,19 @@ export const formatSize = (size: number): string => {
   }
 };
 
+/** Where `hash` sits in a serialized metadata block (after version, type). */
+export const METADATA_HASH_OFFSET = 8 + 1;
+
+/**
+ * Writes the file hash into a serialized metadata block in place. Outbound
+ * cells are staged before the file hash is known and get it when sealed.
+ */
+export const setMetadataHash = (buffer: Uint8Array, hash: Uint8Array): void => {
+  if (hash.length !== crypto_hash_sha512_BYTES)
+    throw new Error("Metadata hash must be 64 bytes");
+  buffer.set(hash, METADATA_HASH_OFFSET);
+};
+
 export const serializeMetadata = (metadata: Metadata): Uint8Array => {
   const buffer = new Uint8Array(METADATA_LEN);
   let offset = 0;
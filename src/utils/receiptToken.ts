@@ -1,4 +1,7 @@
 import { crypto_hash_sha512_BYTES } from "../cryptography/interfaces";
+import { CHUNK_RANGE_RECEIPT_MAX_CHUNKS } from "./constants";
+
+import type { LibCrypto } from "../cryptography/libcrypto";
 
 /**
  * Chunk receipts are deliberately not raw Merkle leaf hashes. Binding the
@@ -40,3 +43,171 @@ export const createChunkReceiptToken = async (
     await globalThis.crypto.subtle.digest("SHA-512", input),
   );
 };
+
+/**
+ * One receipt token for the contiguous chunks [first, first + count): binds the
+ * root, the range and every leaf in it, so the sender can check it against its
+ * own tree (`MerkleTree.verifyRangeReceipt`) instead of one frame per chunk.
+ */
+export const CHUNK_RANGE_RECEIPT_DOMAIN = new TextEncoder().encode(
+  "p2party/protocol-v4/chunk-range-receipt/v1\u0000",
+);
+
+/**
+ * Computes the tokens for every (root, chunkIndexes[i], leaf i) triple in one
+ * WASM call (`chunk_receipt_token_batch`), byte-identical to
+ * `createChunkReceiptToken`. `leafHashes` holds the concatenated leaves.
+ */
+export const createChunkReceiptTokens = (
+  merkleRoot: Uint8Array,
+  chunkIndexes: ArrayLike<number>,
+  leafHashes: Uint8Array,
+  module: LibCrypto,
+): Uint8Array => {
+  const count = chunkIndexes.length;
+  if (merkleRoot.length !== crypto_hash_sha512_BYTES)
+    throw new Error("Chunk receipt Merkle root must be 64 bytes");
+  if (leafHashes.length !== count * crypto_hash_sha512_BYTES)
+    throw new Error("Chunk receipt leaf hash must be 64 bytes");
+  for (let i = 0; i < count; i++)
+    if (
+      !Number.isSafeInteger(chunkIndexes[i]) ||
+      chunkIndexes[i] < 0 ||
+      chunkIndexes[i] > 0xffffffff
+    )
+      throw new Error("Chunk receipt index must be a safe unsigned integer");
+  if (count === 0) return new Uint8Array();
+
+  const rootPtr = module._malloc(crypto_hash_sha512_BYTES);
+  const indexesPtr = module._malloc(count * 4);
+  const leavesPtr = module._malloc(leafHashes.length);
+  try {
+    new Uint8Array(
+      module.wasmMemory.buffer,
+      rootPtr,
+      crypto_hash_sha512_BYTES,
+    ).set(merkleRoot);
+    new Uint32Array(module.wasmMemory.buffer, indexesPtr, count).set(
+      chunkIndexes,
+    );
+    new Uint8Array(module.wasmMemory.buffer, leavesPtr, leafHashes.length).set(
+      leafHashes,
+    );
+
+    // Tokens are written over the leaves.
+    if (
+      module._chunk_receipt_token_batch(
+        count,
+        rootPtr,
+        indexesPtr,
+        leavesPtr,
+        leavesPtr,
+      ) !== 0
+    )
+      throw new Error("Could not calculate hash.");
+
+    return Uint8Array.from(
+      new Uint8Array(module.wasmMemory.buffer, leavesPtr, leafHashes.length),
+    );
+  } finally {
+    module._free(leavesPtr);
+    module._free(indexesPtr);
+    module._free(rootPtr);
+  }
+};
+
+// Leaves per createChunkReceiptTokens call in createChunkReceiptTokenTable, so
+// its WASM scratch stays at 136 KiB whatever the transfer size.
+const RECEIPT_TOKEN_TABLE_BATCH = 2048;
+
+/**
+ * The token of every leaf in `leafHashes`, in index order: the sender's whole
+ * receipt table in a few `chunk_receipt_token_batch` calls.
+ */
+export const createChunkReceiptTokenTable = (
+  merkleRoot: Uint8Array,
+  leafHashes: Uint8Array,
+  module: LibCrypto,
+): Uint8Array => {
+  const count = leafHashes.length / crypto_hash_sha512_BYTES;
+  if (!Number.isInteger(count))
+    throw new Error("Chunk receipt leaf hash must be 64 bytes");
+
+  const tokens = new Uint8Array(leafHashes.length);
+  const indexes = new Uint32Array(Math.min(count, RECEIPT_TOKEN_TABLE_BATCH));
+  for (let first = 0; first < count; first += RECEIPT_TOKEN_TABLE_BATCH) {
+    const batch = Math.min(RECEIPT_TOKEN_TABLE_BATCH, count - first);
+    for (let i = 0; i < batch; i++) indexes[i] = first + i;
+    tokens.set(
+      createChunkReceiptTokens(
+        merkleRoot,
+        indexes.subarray(0, batch),
+        leafHashes.subarray(
+          first * crypto_hash_sha512_BYTES,
+          (first + batch) * crypto_hash_sha512_BYTES,
+        ),
+        module,
+      ),
+      first * crypto_hash_sha512_BYTES,
+    );
+  }
+
+  return tokens;
+};
+
+export const createChunkRangeReceiptToken = (
+  merkleRoot: Uint8Array,
+  first: number,
+  leafHashes: Uint8Array,
+  module: LibCrypto,
+): Uint8Array => {
+  const count = leafHashes.length / crypto_hash_sha512_BYTES;
+  if (merkleRoot.length !== crypto_hash_sha512_BYTES)
+    throw new Error("Chunk receipt Merkle root must be 64 bytes");
+  if (
+    !Number.isInteger(count) ||
+    count < 1 ||
+    count > CHUNK_RANGE_RECEIPT_MAX_CHUNKS
+  )
+    throw new Error(
+      `Chunk range receipt must cover 1 to ${String(CHUNK_RANGE_RECEIPT_MAX_CHUNKS)} leaf hashes`,
+    );
+  if (!Number.isSafeInteger(first) || first < 0 || first > 0xffffffff)
+    throw new Error("Chunk receipt index must be a safe unsigned integer");
+
+  const rootPtr = module._malloc(crypto_hash_sha512_BYTES);
+  const leavesPtr = module._malloc(leafHashes.length);
+  try {
+    new Uint8Array(
+      module.wasmMemory.buffer,
+      rootPtr,
+      crypto_hash_sha512_BYTES,
+    ).set(merkleRoot);
+    new Uint8Array(module.wasmMemory.buffer, leavesPtr, leafHashes.length).set(
+      leafHashes,
+    );
+
+    // The token lands on the first leaf, which is already hashed.
+    if (
+      module._chunk_range_receipt_token(
+        rootPtr,
+        first,
+        count,
+        leavesPtr,
+        leavesPtr,
+      ) !== 0
+    )
+      throw new Error("Could not calculate hash.");
+
+    return Uint8Array.from(
+      new Uint8Array(
+        module.wasmMemory.buffer,
+        leavesPtr,
+        crypto_hash_sha512_BYTES,
+      ),
+    );
+  } finally {
+    module._free(leavesPtr);
+    module._free(rootPtr);
+  }
+};
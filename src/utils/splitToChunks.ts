@@ -1,6 +1,5 @@
 import { getMessageType, getMimeType, MessageType } from "./messageTypes";
 import { uint8ArrayToHex } from "./uint8array";
-import { hashMerkleLeaf } from "./leafHash";
 import { deserializeMetadata, serializeMetadata } from "./metadata";
 import {
   CHUNK_LEN,
@@ -21,8 +20,8 @@ import {
 
 import { setMessage, deleteMessage } from "../reducers/roomSlice";
 
-import { getMerkleRoot } from "../cryptography/merkle";
-import { hashFileStreaming } from "../cryptography/hashStream";
+import { createMerkleAccumulator } from "../cryptography/merkle";
+import { createChunker } from "../cryptography/chunker";
 import {
   generateRandomRoomUrl,
   randomNumberInRange,
@@ -174,39 +173,31 @@ export const splitToChunks = async (
 
   const date = new Date();
 
-  // Hash the full content. A string is already in memory (crypto.subtle). A File
-  // is streamed from disk through the WASM incremental SHA-512 (hashFileStreaming)
-  // so the whole file is never resident — this is what makes arbitrarily large
-  // files sendable. Both produce plain SHA-512, so the value is unchanged.
-  let sha512: Uint8Array;
   if (transfer.signal.aborted)
     throw transfer.signal.reason instanceof Error
       ? transfer.signal.reason
       : new Error("Message transfer cancelled");
-  if (typeof message === "string") {
-    const hashArrayBuffer = await window.crypto.subtle.digest(
-      "SHA-512",
-      (file as Uint8Array).buffer as ArrayBuffer,
-    );
-    sha512 = new Uint8Array(hashArrayBuffer);
-  } else {
-    sha512 = await hashFileStreaming(
-      file as File,
-      merkleModule,
-      transfer.signal,
-    );
-  }
-  if (transfer.signal.aborted)
-    throw transfer.signal.reason instanceof Error
-      ? transfer.signal.reason
-      : new Error("Message transfer cancelled");
-  const sha512Hex = uint8ArrayToHex(sha512);
-  transfer.bindHash(sha512Hex);
+
+  // One pass over the content. Each window of chunker.capacity cells reads its
+  // real bytes straight into the WASM chunker, which folds them into the
+  // whole-file SHA-512, pads the cells and hashes their leaves (see chunker.c),
+  // one four-lane group per pool thread. A File is read from disk one window at
+  // a time, so it is never resident.
+  const readWindow = async (
+    start: number,
+    end: number,
+  ): Promise<Uint8Array> =>
+    typeof message === "string"
+      ? (file as Uint8Array).subarray(start, end)
+      : new Uint8Array(await (file as File).slice(start, end).arrayBuffer());
 
   const m = {
     schemaVersion: metadataSchemaVersion,
     messageType,
-    hash: sha512,
+    // The file hash is only known once the pass ends. Staged cells keep it
+    // zeroed and the sender writes it in when it first seals each cell
+    // (setMetadataHash), so every cell is written to staging once.
+    hash: new Uint8Array(crypto_hash_sha512_BYTES),
     name,
     totalSize,
     date,
@@ -214,82 +205,118 @@ export const splitToChunks = async (
 
   let offset = 0;
 
-  const chunk = new Uint8Array(chunkSize);
   const chunkHashes = new Uint8Array(totalChunks * crypto_hash_sha512_BYTES);
   const maxChunkStartIndex = Math.floor(
     chunkSize * (1 - percentageFilledChunk),
   );
   const maxBytesToCopy = Math.ceil(chunkSize * percentageFilledChunk);
-  for (let i = 0; i < totalChunks; i++) {
-    if (transfer.signal.aborted) break;
-
-    window.crypto.getRandomValues(chunk);
-    const chunkStartIndex = await randomNumberInRange(0, maxChunkStartIndex);
-    const remainingBytes = totalSize - offset;
-    const bytesToCopy = Math.min(Math.max(remainingBytes, 0), maxBytesToCopy);
-
-    let chunkEndIndex = chunkStartIndex + bytesToCopy;
-
-    if (remainingBytes > 0) {
-      const blob = file.slice(offset, offset + bytesToCopy);
-      if (typeof message === "string") {
-        chunk.set(blob as Uint8Array, chunkStartIndex);
-      } else {
-        const buffer = await (blob as Blob).arrayBuffer();
+  // The root is folded in as leaves are produced; only the O(log n) frontier is
+  // kept, so there is no second pass over chunkHashes once chunking finishes.
+  const accumulator = createMerkleAccumulator(merkleModule);
+  const chunker = createChunker(merkleModule, chunkSize);
+  let merkleRoot = new Uint8Array();
+  let sha512 = new Uint8Array();
+  try {
+    for (let i = 0; i < totalChunks; i += chunker.capacity) {
+      if (transfer.signal.aborted) break;
+
+      const count = Math.min(chunker.capacity, totalChunks - i);
+      const starts = new Array<number>(count);
+      const lens = new Array<number>(count);
+      let windowLen = 0;
+      for (let j = 0; j < count; j++) {
+        starts[j] = await randomNumberInRange(0, maxChunkStartIndex);
+        lens[j] = Math.min(
+          Math.max(totalSize - offset - windowLen, 0),
+          maxBytesToCopy,
+        );
+        windowLen += lens[j];
+      }
+
+      if (windowLen > 0) {
+        const window = await readWindow(offset, offset + windowLen);
         if (transfer.signal.aborted) break;
-        chunk.set(new Uint8Array(buffer), chunkStartIndex);
+        let w = 0;
+        for (let j = 0; j < count; j++) {
+          chunker.cells.set(
+            window.subarray(w, w + lens[j]),
+            j * chunkSize + starts[j],
+          );
+          w += lens[j];
+        }
+        offset += windowLen;
       }
 
-      offset += bytesToCopy;
-    } else {
-      const start = chunkEndIndex + totalSize + 1;
-      const end = Number.MAX_SAFE_INTEGER - start;
-      const r = await randomNumberInRange(start, end);
-      chunkEndIndex += r;
+      const leaves = chunker.layout(starts, lens);
+      chunkHashes.set(leaves, i * crypto_hash_sha512_BYTES);
+
+      for (let j = 0; j < count; j++) {
+        const chunkIndex = i + j;
+        const chunkStartIndex = starts[j];
+        let chunkEndIndex = chunkStartIndex + lens[j];
+
+        if (lens[j] === 0) {
+          const start = chunkEndIndex + totalSize + 1;
+          const end = Number.MAX_SAFE_INTEGER - start;
+          const r = await randomNumberInRange(start, end);
+          chunkEndIndex += r;
+        }
+
+        const hash = leaves.subarray(
+          j * crypto_hash_sha512_BYTES,
+          (j + 1) * crypto_hash_sha512_BYTES,
+        );
+        accumulator.append(hash);
+
+        const mSerialized = serializeMetadata({
+          ...m,
+          chunkStartIndex,
+          chunkEndIndex,
+          chunkIndex,
+        });
+
+        // A failed staging write is fatal. Sending a partial tree would make
+        // the transfer unrecoverable while presenting misleading progress to
+        // the UI.
+        await setDBNewChunk({
+          transferId: transfer.transferId,
+          hash: "",
+          merkleRoot: "",
+          chunkIndex,
+          leafHash: uint8ArrayToHex(hash),
+          receiptToken: "",
+          data: chunker.cells.slice(j * chunkSize, (j + 1) * chunkSize).buffer,
+          metadata: mSerialized.buffer as ArrayBuffer,
+          merkleProof: new Uint8Array().buffer,
+        });
+
+        api.dispatch(
+          setMessage({
+            roomId: room.id,
+            transferId: transfer.transferId,
+            merkleRootHex: "",
+            sha512Hex: "",
+            fromPeerId: keyPair.peerId,
+            chunkSize: 0,
+            totalSize,
+            chunksCreated: chunkIndex + 1,
+            totalChunks,
+            messageType,
+            filename: name,
+            channelLabel: label,
+            timestamp: date.getTime(),
+          }),
+        );
+      }
     }
 
-    const hash = await hashMerkleLeaf(chunk);
-    const leafHash = uint8ArrayToHex(hash);
-    chunkHashes.set(hash, i * crypto_hash_sha512_BYTES);
-
-    const mSerialized = serializeMetadata({
-      ...m,
-      chunkStartIndex,
-      chunkEndIndex,
-      chunkIndex: i,
-    });
-
-    // A failed staging write is fatal. Sending a partial tree would make the
-    // transfer unrecoverable while presenting misleading progress to the UI.
-    await setDBNewChunk({
-      transferId: transfer.transferId,
-      hash: sha512Hex,
-      merkleRoot: "",
-      chunkIndex: i,
-      leafHash,
-      receiptToken: "",
-      data: chunk.slice().buffer,
-      metadata: mSerialized.buffer as ArrayBuffer,
-      merkleProof: new Uint8Array().buffer,
-    });
-
-    api.dispatch(
-      setMessage({
-        roomId: room.id,
-        transferId: transfer.transferId,
-        merkleRootHex: "",
-        sha512Hex,
-        fromPeerId: keyPair.peerId,
-        chunkSize: 0,
-        totalSize,
-        chunksCreated: i + 1,
-        totalChunks,
-        messageType,
-        filename: name,
-        channelLabel: label,
-        timestamp: date.getTime(),
-      }),
-    );
+    if (!transfer.signal.aborted) {
+      merkleRoot = accumulator.root();
+      sha512 = chunker.final();
+    }
+  } finally {
+    chunker.free();
+    accumulator.free();
   }
 
   if (transfer.signal.aborted) {
@@ -310,8 +337,9 @@ export const splitToChunks = async (
     };
   }
 
-  const merkleRoot = await getMerkleRoot(chunkHashes, merkleModule);
   const merkleRootHex = uint8ArrayToHex(merkleRoot);
+  const sha512Hex = uint8ArrayToHex(sha512);
+  transfer.bindHash(sha512Hex);
 
   try {
     // Persist the sender's real-byte copy exactly once, independent of peer
@@ -1,3 +1,5 @@
+import { slabFree } from "../cryptography/slab";
+
 import type { LibCrypto } from "../cryptography/libcrypto";
 
 /**
@@ -7,8 +9,11 @@ import type { LibCrypto } from "../cryptography/libcrypto";
  * are long-lived and reused, so freed secret key material would otherwise linger
  * in the ArrayBuffer. This mirrors the `sodium_free` discipline used on the C
  * side. Pass the live view over the buffer; its `byteOffset` is the pointer.
+ * Slots from `secureMalloc` go back to the module's slab, which wipes the whole
+ * slot in C.
  */
 export const zeroFree = (module: LibCrypto, view: Uint8Array): void => {
+  if (slabFree(module, view.byteOffset)) return;
   view.fill(0);
   module._free(view.byteOffset);
 };
@@ -0,0 +1,101 @@
+import { describe, expect, test } from "bun:test";
+
+import { argon2id } from "../../src/cryptography/mnemonic";
+import {
+  loadTestModule,
+  loadThreadedTestModule,
+} from "../../src/cryptography/testModule";
+
+const threaded = await loadThreadedTestModule(4);
+
+describe("argon2id_hash", () => {
+  test("matches the RFC 9106 Argon2id test vector (t=3, m=32, p=4)", async () => {
+    const module = await loadTestModule();
+    const fields = [
+      new Uint8Array(32).fill(1), // password
+      new Uint8Array(16).fill(2), // salt
+      new Uint8Array(8).fill(3), // secret
+      new Uint8Array(12).fill(4), // associated data
+    ];
+    const ptrs = fields.map((field) => {
+      const ptr = module._malloc(field.length);
+      new Uint8Array(module.wasmMemory.buffer, ptr, field.length).set(field);
+      return ptr;
+    });
+    const outPtr = module._malloc(32);
+    const memoryLen = module._argon2id_memory_bytes(32, 4);
+    const memoryPtr = module._malloc(memoryLen);
+
+    try {
+      expect(
+        module._argon2id_hash(
+          outPtr,
+          32,
+          ptrs[0],
+          32,
+          ptrs[1],
+          16,
+          ptrs[2],
+          8,
+          ptrs[3],
+          12,
+          3,
+          32,
+          4,
+          memoryPtr,
+        ),
+      ).toBe(0);
+      expect(
+        Buffer.from(
+          new Uint8Array(module.wasmMemory.buffer, outPtr, 32),
+        ).toString("hex"),
+      ).toBe(
+        "0d640df58d78766c08c037a34a8b53c9d01ef0452d75b65eb52520e96b01e659",
+      );
+      // The block memory is wiped before returning.
+      expect(
+        new Uint8Array(module.wasmMemory.buffer, memoryPtr, memoryLen).every(
+          (byte) => byte === 0,
+        ),
+      ).toBe(true);
+    } finally {
+      for (const ptr of [...ptrs, outPtr, memoryPtr]) module._free(ptr);
+    }
+  });
+
+  test("profiles are deterministic and separate the lane count", async () => {
+    const module = await loadTestModule();
+    const password = new TextEncoder().encode("correct horse battery staple");
+    const salt = new Uint8Array(16).fill(7);
+    const oneLane = { opsLimit: 2, memLimitKiB: 256, parallelism: 1 };
+    const fourLanes = { opsLimit: 2, memLimitKiB: 256, parallelism: 4 };
+
+    const a = await argon2id(password, salt, fourLanes, module);
+    const b = await argon2id(password, salt, fourLanes, module);
+    const c = await argon2id(password, salt, oneLane, module);
+    expect(a).toEqual(b);
+    expect(a).not.toEqual(c);
+    expect(a.length).toBe(32);
+
+    await expect(
+      argon2id(password, salt, { ...fourLanes, parallelism: 17 }, module),
+    ).rejects.toThrow("Invalid argon2id profile");
+  });
+
+  test.skipIf(threaded === null)(
+    "the threaded artifact fills the lanes in parallel with the same output",
+    async () => {
+      if (!threaded) return;
+      const password = new TextEncoder().encode("correct horse battery staple");
+      const salt = new Uint8Array(16).fill(7);
+      // 4 MiB over four lanes, so each slice is a real task per thread.
+      const fourLanes = { opsLimit: 2, memLimitKiB: 4 * 1024, parallelism: 4 };
+
+      expect(threaded._pool_threads()).toBe(4);
+      // Without a module: the single-threaded artifact on its own memory.
+      expect(await argon2id(password, salt, fourLanes, threaded)).toEqual(
+        await argon2id(password, salt, fourLanes),
+      );
+    },
+  );
+});
@@ -0,0 +1,80 @@
+import { describe, expect, test } from "bun:test";
+
+import { loadTestModule } from "../../src/cryptography/testModule";
+import { CHUNKER_LANES, createChunker } from "../../src/cryptography/chunker";
+import { hashMerkleLeafWasm } from "../../src/utils/leafHash";
+import { crypto_hash_sha512_BYTES } from "../../src/cryptography/interfaces";
+
+const rand = (n: number): Uint8Array => {
+  const u = new Uint8Array(n);
+  crypto.getRandomValues(u);
+  return u;
+};
+
+describe("createChunker (single-pass file hash, padding and leaves)", () => {
+  test("file hash and leaves match the two-pass results", async () => {
+    const module = await loadTestModule();
+    const chunkSize = 1000;
+    const cellBytes = 900;
+    const file = rand(5 * cellBytes + 37);
+    const chunker = createChunker(module, chunkSize);
+    try {
+      expect(chunker.capacity).toBe(CHUNKER_LANES * module._pool_threads());
+      let offset = 0;
+      for (let cell = 0; cell < 9; cell += chunker.capacity) {
+        const count = Math.min(chunker.capacity, 9 - cell);
+        const starts: number[] = [];
+        const lens: number[] = [];
+        for (let j = 0; j < count; j++) {
+          const len = Math.min(Math.max(file.length - offset, 0), cellBytes);
+          starts.push((cell + j) % (chunkSize - cellBytes));
+          lens.push(len);
+          chunker.cells.set(
+            file.subarray(offset, offset + len),
+            j * chunkSize + starts[j],
+          );
+          offset += len;
+        }
+
+        const leaves = chunker.layout(starts, lens);
+        expect(leaves).toHaveLength(count * crypto_hash_sha512_BYTES);
+        for (let j = 0; j < count; j++) {
+          const body = chunker.cells.slice(j * chunkSize, (j + 1) * chunkSize);
+          expect(
+            Buffer.from(
+              leaves.subarray(
+                j * crypto_hash_sha512_BYTES,
+                (j + 1) * crypto_hash_sha512_BYTES,
+              ),
+            ),
+          ).toEqual(Buffer.from(hashMerkleLeafWasm(body, module)));
+        }
+      }
+
+      const expected = new Uint8Array(
+        await crypto.subtle.digest("SHA-512", file as Uint8Array<ArrayBuffer>),
+      );
+      expect(Buffer.from(chunker.final())).toEqual(Buffer.from(expected));
+    } finally {
+      chunker.free();
+    }
+  });
+
+  test("rejects spans past the cell and use after free", async () => {
+    const module = await loadTestModule();
+    const chunker = createChunker(module, 64);
+    expect(() => chunker.layout([60], [5])).toThrow(
+      "Chunk span out of cell bounds.",
+    );
+    expect(() => chunker.layout([], [])).toThrow(
+      "Invalid chunker cell count.",
+    );
+    const tooMany = new Array<number>(chunker.capacity + 1).fill(0);
+    expect(() => chunker.layout(tooMany, tooMany)).toThrow(
+      "Invalid chunker cell count.",
+    );
+    chunker.free();
+    chunker.free();
+    expect(() => chunker.final()).toThrow("Chunker has been freed.");
+  });
+});
@@ -1,6 +1,12 @@
 import { describe, expect, test } from "bun:test";
 
-import { keyPairFromSecretKey, newKeyPair, sign } from "../../src/cryptography/ed25519";
+import {
+  keyPairFromSecretKey,
+  newKeyPair,
+  sign,
+  verify,
+  verifyBatch,
+} from "../../src/cryptography/ed25519";
 import { loadTestModule } from "../../src/cryptography/testModule";
 
 describe("Ed25519 secret staging", () => {
@@ -70,3 +76,39 @@ describe("Ed25519 secret staging", () => {
     }
   });
 });
+
+describe("Ed25519 batch verification", () => {
+  test("verifyBatch agrees with verify entry by entry", async () => {
+    const module = await loadTestModule();
+    const keyPairs = await Promise.all(
+      Array.from({ length: 3 }, () => newKeyPair(module)),
+    );
+    // 37 entries span three C batches, including a partial one.
+    const entries = await Promise.all(
+      Array.from({ length: 37 }, async (_, i) => {
+        const keyPair = keyPairs[i % keyPairs.length];
+        const message = new Uint8Array(i * 7).fill(i);
+        return {
+          message,
+          signature: await sign(message, keyPair.secretKey, module),
+          publicKey: keyPair.publicKey,
+        };
+      }),
+    );
+
+    expect(await verifyBatch(entries, module)).toEqual(entries.map(() => true));
+
+    entries[3].signature[40] ^= 1;
+    entries[20].message = new Uint8Array([9, 9, 9]);
+    entries[21].publicKey = keyPairs[1].publicKey;
+    entries[36].signature.fill(0);
+    const expected = await Promise.all(
+      entries.map((e) => verify(e.message, e.signature, e.publicKey, module)),
+    );
+    expect(expected.filter((ok) => !ok)).toHaveLength(4);
+    expect(await verifyBatch(entries, module)).toEqual(expected);
+    expect(await verifyBatch([], module)).toEqual([]);
+
+    for (const keyPair of keyPairs) keyPair.secretKey.fill(0);
+  });
+});
@@ -0,0 +1,115 @@
+import { describe, expect, test } from "bun:test";
+
+import { deriveHandshakeKeys } from "../../src/cryptography/handshakeKeys";
+import { hkdfExpand, hkdfExtract } from "../../src/cryptography/hkdf";
+import { loadTestModule } from "../../src/cryptography/testModule";
+import { x25519Keypair } from "../../src/cryptography/x25519";
+import { deriveInteractive3dhSecret } from "../../src/cryptography/x3dh";
+
+const encode = (s: string): Uint8Array => new TextEncoder().encode(s);
+
+describe("handshake_key_schedule", () => {
+  test("matches the step-by-step derivation for both roles", async () => {
+    const module = await loadTestModule();
+    const IKa = x25519Keypair(module);
+    const IKb = x25519Keypair(module);
+    const EKa = x25519Keypair(module);
+    const EKb = x25519Keypair(module);
+    const kemSecret = crypto.getRandomValues(new Uint8Array(32));
+    const hybridInfo = encode("hybrid-info");
+    const bindingInput = encode("binding-input");
+
+    for (const pakeIsk of [null, crypto.getRandomValues(new Uint8Array(64))]) {
+      const initiator = deriveHandshakeKeys(
+        {
+          identitySecret: IKa.secretKey,
+          peerIdentityPub: IKb.publicKey,
+          ephemeralSecret: EKa.secretKey,
+          peerEphemeralPub: EKb.publicKey,
+          amInitiator: true,
+          pakeIsk,
+          kemSecret,
+          hybridInfo,
+          bindingInput,
+        },
+        module,
+      );
+      const responder = deriveHandshakeKeys(
+        {
+          identitySecret: IKb.secretKey,
+          peerIdentityPub: IKa.publicKey,
+          ephemeralSecret: EKb.secretKey,
+          peerEphemeralPub: EKa.publicKey,
+          amInitiator: false,
+          pakeIsk,
+          kemSecret,
+          hybridInfo,
+          bindingInput,
+        },
+        module,
+      );
+      expect(responder).toEqual(initiator);
+
+      const identitySecret = deriveInteractive3dhSecret(
+        IKa.secretKey,
+        IKb.publicKey,
+        EKa.secretKey,
+        EKb.publicKey,
+        true,
+        module,
+      );
+      const ikm = pakeIsk
+        ? new Uint8Array([...pakeIsk, ...identitySecret, ...kemSecret])
+        : new Uint8Array([...identitySecret, ...kemSecret]);
+      const rootKey = hkdfExpand(
+        hkdfExtract(new Uint8Array(64), ikm, module),
+        hybridInfo,
+        32,
+        module,
+      );
+      const binding = new Uint8Array(
+        await crypto.subtle.digest("SHA-256", bindingInput),
+      );
+      const pqHealingRoot = hkdfExpand(
+        hkdfExtract(
+          encode("p2party-v4-pq-healing-extract-v1"),
+          rootKey,
+          module,
+        ),
+        new Uint8Array([
+          ...encode("p2party-v4-pq-healing-root-v1"),
+          ...binding,
+        ]),
+        32,
+        module,
+      );
+      expect(initiator.rootKey).toEqual(rootKey);
+      expect(initiator.pqHealingBinding).toEqual(binding);
+      expect(initiator.pqHealingRoot).toEqual(pqHealingRoot);
+    }
+  });
+
+  test("rejects a small-order peer key", async () => {
+    const module = await loadTestModule();
+    const IKa = x25519Keypair(module);
+    const EKa = x25519Keypair(module);
+    const EKb = x25519Keypair(module);
+
+    expect(() =>
+      deriveHandshakeKeys(
+        {
+          identitySecret: IKa.secretKey,
+          peerIdentityPub: new Uint8Array(32),
+          ephemeralSecret: EKa.secretKey,
+          peerEphemeralPub: EKb.publicKey,
+          amInitiator: true,
+          pakeIsk: null,
+          kemSecret: new Uint8Array(32),
+          hybridInfo: new Uint8Array(0),
+          bindingInput: new Uint8Array(0),
+        },
+        module,
+      ),
+    ).toThrow("small order");
+  });
+});
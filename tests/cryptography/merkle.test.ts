@@ -0,0 +1,204 @@
+import { describe, expect, test } from "bun:test";
+
+import { loadTestModule } from "../../src/cryptography/testModule";
+import {
+  createMerkleAccumulator,
+  createMerkleProofCache,
+  createMerkleTree,
+  getMerkleProof,
+  getMerkleRangeProofLen,
+  getMerkleRoot,
+  verifyMerkleRangeProof,
+} from "../../src/cryptography/merkle";
+import { crypto_hash_sha512_BYTES } from "../../src/cryptography/interfaces";
+import { PROOF_LEN } from "../../src/utils/constants";
+
+const randomLeaves = (leavesLen: number): Uint8Array =>
+  globalThis.crypto.getRandomValues(
+    new Uint8Array(leavesLen * crypto_hash_sha512_BYTES),
+  );
+
+const leafAt = (leaves: Uint8Array, index: number): Uint8Array =>
+  leaves.slice(
+    index * crypto_hash_sha512_BYTES,
+    (index + 1) * crypto_hash_sha512_BYTES,
+  );
+
+describe("createMerkleTree (persistent levels)", () => {
+  test("root and every proof match the rehashing getMerkleRoot/getMerkleProof", async () => {
+    const module = await loadTestModule();
+    for (const leavesLen of [1, 2, 3, 5, 8, 13, 33]) {
+      const leaves = randomLeaves(leavesLen);
+      const tree = await createMerkleTree(leaves, module);
+      try {
+        expect(tree.leavesLen).toBe(leavesLen);
+        expect(Buffer.from(tree.root)).toEqual(
+          Buffer.from(await getMerkleRoot(leaves.slice(), module)),
+        );
+        for (let index = 0; index < leavesLen; index++) {
+          const expected = await getMerkleProof(
+            leaves.slice(),
+            leafAt(leaves, index),
+            module,
+          );
+          expect(Buffer.from(tree.getProof(index))).toEqual(
+            Buffer.from(expected),
+          );
+        }
+      } finally {
+        tree.free();
+      }
+    }
+  });
+
+  test("fixed-length proofs carry the big-endian proof length prefix", async () => {
+    const module = await loadTestModule();
+    const leaves = randomLeaves(7);
+    const tree = await createMerkleTree(leaves, module);
+    try {
+      const raw = tree.getProof(6);
+      const fixed = tree.getProof(6, PROOF_LEN);
+      expect(fixed).toHaveLength(PROOF_LEN);
+      expect(new DataView(fixed.buffer).getUint32(0, false)).toBe(raw.length);
+      expect(Buffer.from(fixed.subarray(4, 4 + raw.length))).toEqual(
+        Buffer.from(raw),
+      );
+    } finally {
+      tree.free();
+    }
+  });
+
+  test("rejects out-of-range indexes and use after free", async () => {
+    const module = await loadTestModule();
+    const tree = await createMerkleTree(randomLeaves(4), module);
+    expect(() => tree.getProof(4)).toThrow("Element not in tree.");
+    expect(() => tree.getProof(-1)).toThrow("Element not in tree.");
+    tree.free();
+    tree.free();
+    expect(() => tree.getProof(0)).toThrow("Merkle tree has been freed.");
+  });
+});
+
+describe("createMerkleAccumulator (streaming root)", () => {
+  test("root after every append matches getMerkleRoot over the prefix", async () => {
+    const module = await loadTestModule();
+    const leaves = randomLeaves(37);
+    const accumulator = createMerkleAccumulator(module);
+    try {
+      expect(() => accumulator.root()).toThrow(
+        "Cannot calculate Merkle root of tree with no leaves.",
+      );
+      for (let index = 0; index < 37; index++) {
+        accumulator.append(leafAt(leaves, index));
+        expect(accumulator.leavesLen).toBe(index + 1);
+        const prefix = leaves.slice(0, (index + 1) * crypto_hash_sha512_BYTES);
+        expect(Buffer.from(accumulator.root())).toEqual(
+          Buffer.from(await getMerkleRoot(prefix, module)),
+        );
+      }
+    } finally {
+      accumulator.free();
+    }
+  });
+});
+
+describe("createMerkleProofCache (receive-side verification)", () => {
+  test("accepts every proof twice and rejects tampering", async () => {
+    const module = await loadTestModule();
+    for (const leavesLen of [2, 5, 16, 33]) {
+      const leaves = randomLeaves(leavesLen);
+      const tree = await createMerkleTree(leaves, module);
+      const cache = createMerkleProofCache(tree.root, module);
+      try {
+        for (let pass = 0; pass < 2; pass++) {
+          for (let index = 0; index < leavesLen; index++) {
+            const proof = tree.getProof(index);
+            expect(cache.verify(leafAt(leaves, index), proof)).toBe(true);
+          }
+        }
+
+        const leaf = leafAt(leaves, leavesLen - 1);
+        leaf[0] ^= 1;
+        expect(cache.verify(leaf, tree.getProof(leavesLen - 1))).toBe(false);
+
+        const proof = tree.getProof(0);
+        proof[3] ^= 1;
+        expect(cache.verify(leafAt(leaves, 0), proof)).toBe(false);
+      } finally {
+        cache.free();
+        tree.free();
+      }
+    }
+  });
+});
+
+describe("MerkleTree.getRangeProof (range multiproof)", () => {
+  test("every range verifies and shares its siblings", async () => {
+    const module = await loadTestModule();
+    for (const leavesLen of [1, 2, 3, 6, 11, 16]) {
+      const leaves = randomLeaves(leavesLen);
+      const tree = await createMerkleTree(leaves, module);
+      try {
+        for (let first = 0; first < leavesLen; first++) {
+          for (let count = 1; first + count <= leavesLen; count++) {
+            const proof = tree.getRangeProof(first, count);
+            expect(proof).toHaveLength(
+              getMerkleRangeProofLen(leavesLen, first, count),
+            );
+            const range = leaves.slice(
+              first * crypto_hash_sha512_BYTES,
+              (first + count) * crypto_hash_sha512_BYTES,
+            );
+            expect(
+              await verifyMerkleRangeProof(
+                range,
+                first,
+                leavesLen,
+                tree.root,
+                proof,
+                module,
+              ),
+            ).toBe(true);
+          }
+        }
+      } finally {
+        tree.free();
+      }
+    }
+  });
+
+  test("is smaller than per-leaf proofs and rejects tampering", async () => {
+    const module = await loadTestModule();
+    const leaves = randomLeaves(64);
+    const tree = await createMerkleTree(leaves, module);
+    try {
+      const proof = tree.getRangeProof(8, 16);
+      let singleProofs = 0;
+      for (let index = 8; index < 24; index++)
+        singleProofs += tree.getProof(index).length;
+      expect(proof.length).toBeLessThan(singleProofs / 16);
+
+      const range = leaves.slice(
+        8 * crypto_hash_sha512_BYTES,
+        24 * crypto_hash_sha512_BYTES,
+      );
+      range[5 * crypto_hash_sha512_BYTES] ^= 1;
+      expect(
+        await verifyMerkleRangeProof(range, 8, 64, tree.root, proof, module),
+      ).toBe(false);
+      expect(
+        await verifyMerkleRangeProof(
+          leaves.slice(0, 16 * crypto_hash_sha512_BYTES),
+          8,
+          64,
+          tree.root,
+          proof,
+          module,
+        ),
+      ).toBe(false);
+      expect(() => tree.getRangeProof(60, 5)).toThrow("Range not in tree.");
+    } finally {
+      tree.free();
+    }
+  });
+});
@@ -1,14 +1,17 @@
 import { describe, expect, test } from "bun:test";
+import { existsSync, readFileSync } from "node:fs";
 
 import {
   createMlKemBackend,
   ML_KEM_1024_SUITE,
+  MlKemExpandedKeyCache,
   ML_KEM_512_SUITE,
   ML_KEM_768_SUITE,
   type MlKemModule,
   type MlKemParameterSet,
   type MlKemSuiteDescriptor,
 } from "../../src/cryptography/mlkem";
+import libcrypto from "../../src/cryptography/libcrypto";
 import { loadTestModule } from "../../src/cryptography/testModule";
 
 const hexToBytes = (hex: string): Uint8Array =>
@@ -124,6 +127,80 @@ const getRawWasmFunction = (
   return candidate as RawWasmFunction;
 };
 
+const scalarUrl = new URL(
+  "../../src/cryptography/libcrypto.wasm",
+  import.meta.url,
+);
+const simdUrl = new URL(
+  "../../src/cryptography/libcrypto.simd.wasm",
+  import.meta.url,
+);
+
+const loadArtifact = async (url: URL): Promise<MlKemModule> => {
+  const fileBytes = readFileSync(url);
+  const wasmBinary = new ArrayBuffer(fileBytes.byteLength);
+  new Uint8Array(wasmBinary).set(fileBytes);
+  return (await libcrypto({
+    wasmBinary,
+    wasmMemory: new WebAssembly.Memory({ initial: 32, maximum: 32 }),
+  })) as unknown as MlKemModule;
+};
+
+// Deterministic keypair and encapsulation from 96 coin bytes, then a
+// decapsulation of the ciphertext with one bit flipped: pk, sk, ct, ss and
+// the implicit-rejection secret.
+const runDerandomized = (
+  module: MlKemModule,
+  suite: Readonly<MlKemSuiteDescriptor>,
+  coins: Uint8Array,
+): Uint8Array[] => {
+  const sizes = [
+    suite.publicKeyBytes,
+    suite.secretKeyBytes,
+    suite.ciphertextBytes,
+    suite.sharedSecretBytes,
+    suite.sharedSecretBytes,
+    suite.keyPairRandomBytes + suite.encapsRandomBytes,
+  ];
+  const ptrs = sizes.map((size) => module._malloc(size));
+  const heap = (i: number): Uint8Array =>
+    new Uint8Array(module.wasmMemory.buffer, ptrs[i], sizes[i]);
+  const [publicKey, secretKey, ciphertext, secret, rejected, coinsPtr] = ptrs;
+  try {
+    heap(5).set(coins);
+    expect(
+      getRawWasmFunction(module, suite.wasmExports.keypair)(
+        publicKey,
+        secretKey,
+        coinsPtr,
+      ),
+    ).toBe(0);
+    expect(
+      getRawWasmFunction(module, suite.wasmExports.encaps)(
+        ciphertext,
+        secret,
+        publicKey,
+        coinsPtr + suite.keyPairRandomBytes,
+      ),
+    ).toBe(0);
+    const outputs = [0, 1, 2, 3].map((i) => Uint8Array.from(heap(i)));
+    heap(2)[0] ^= 1;
+    expect(
+      getRawWasmFunction(module, suite.wasmExports.decaps)(
+        rejected,
+        ciphertext,
+        secretKey,
+      ),
+    ).toBe(0);
+    return [...outputs, Uint8Array.from(heap(4))];
+  } finally {
+    ptrs.forEach((ptr, i) => {
+      heap(i).fill(0);
+      module._free(ptr);
+    });
+  }
+};
+
 for (const { suite, expected, acvp } of SUITE_CASES) {
   describe(`${suite.standardName} WASM backend`, () => {
     test("carries the exact FIPS 203 sizes", () => {
@@ -181,6 +258,269 @@ for (const { suite, expected, acvp } of SUITE_CASES) {
       }
     });
 
+    // The SIMD artifact runs mlkem_simd.h instead of the portable C; every
+    // byte of every output must still agree.
+    test.skipIf(!existsSync(simdUrl))(
+      "SIMD artifact matches the scalar artifact byte for byte",
+      async () => {
+        const scalar = await loadArtifact(scalarUrl);
+        const simd = await loadArtifact(simdUrl);
+        for (let round = 0; round < 8; round++) {
+          const coins = globalThis.crypto.getRandomValues(
+            new Uint8Array(suite.keyPairRandomBytes + suite.encapsRandomBytes),
+          );
+          const expected = runDerandomized(scalar, suite, coins);
+          const actual = runDerandomized(simd, suite, coins);
+          actual.forEach((bytes, i) => expectBytesEqual(bytes, expected[i]));
+        }
+      },
+    );
+
+    test("batch exports match the single-item calls item for item", async () => {
+      const module = (await loadTestModule()) as MlKemModule;
+      const keypair = getRawWasmFunction(module, suite.wasmExports.keypair);
+      const encaps = getRawWasmFunction(module, suite.wasmExports.encaps);
+      const keypairBatch = getRawWasmFunction(
+        module,
+        suite.wasmExports.keypairBatch,
+      );
+      const encapsBatch = getRawWasmFunction(
+        module,
+        suite.wasmExports.encapsBatch,
+      );
+      const sizes = [
+        suite.publicKeyBytes,
+        suite.secretKeyBytes,
+        suite.ciphertextBytes,
+        suite.sharedSecretBytes,
+        suite.keyPairRandomBytes,
+        suite.encapsRandomBytes,
+      ].map((size) => 4 * size);
+      const ptrs = sizes.map((size) => module._malloc(size));
+      const heap = (i: number): Uint8Array =>
+        new Uint8Array(module.wasmMemory.buffer, ptrs[i], sizes[i]);
+      const [pk, sk, ct, ss, keyCoins, encCoins] = ptrs;
+      try {
+        for (let count = 1; count <= 4; count++) {
+          globalThis.crypto.getRandomValues(heap(4));
+          globalThis.crypto.getRandomValues(heap(5));
+          expect(keypairBatch(pk, sk, keyCoins, count)).toBe(0);
+          expect(encapsBatch(ct, ss, pk, encCoins, count)).toBe(0);
+          const batched = [0, 1, 2, 3].map((i) => Uint8Array.from(heap(i)));
+
+          for (let i = 0; i < count; i++) {
+            expect(
+              keypair(pk, sk, keyCoins + i * suite.keyPairRandomBytes),
+            ).toBe(0);
+            expect(
+              encaps(ct, ss, pk, encCoins + i * suite.encapsRandomBytes),
+            ).toBe(0);
+            [
+              suite.publicKeyBytes,
+              suite.secretKeyBytes,
+              suite.ciphertextBytes,
+              suite.sharedSecretBytes,
+            ].forEach((size, j) =>
+              expectBytesEqual(
+                batched[j].subarray(i * size, (i + 1) * size),
+                heap(j).subarray(0, size),
+              ),
+            );
+          }
+        }
+
+        expect(keypairBatch(pk, sk, keyCoins, 0)).not.toBe(0);
+        expect(keypairBatch(pk, sk, keyCoins, 5)).not.toBe(0);
+      } finally {
+        ptrs.forEach((ptr, i) => {
+          heap(i).fill(0);
+          module._free(ptr);
+        });
+      }
+    });
+
+    test("concurrent calls are batched and a bad key fails only its caller", async () => {
+      const backend = createMlKemBackend(await loadTestModule(), suite);
+      const keyPairs = await Promise.all(
+        Array.from({ length: 6 }, () => backend.generateKeyPair()),
+      );
+      // First coefficient 0xfff is not reduced mod q.
+      const badKey = Uint8Array.from(keyPairs[0].publicKey);
+      badKey[0] = 0xff;
+      badKey[1] |= 0x0f;
+
+      const settled = await Promise.allSettled([
+        ...keyPairs.map((keyPair) => backend.encapsulate(keyPair.publicKey)),
+        backend.encapsulate(badKey),
+      ]);
+      expect(settled[6].status).toBe("rejected");
+      for (let i = 0; i < keyPairs.length; i++) {
+        const outcome = settled[i];
+        if (outcome.status !== "fulfilled") throw outcome.reason;
+        const decapsulated = await backend.decapsulate(
+          outcome.value.ciphertext,
+          keyPairs[i].secretKey,
+        );
+        expectBytesEqual(decapsulated.sharedSecret, outcome.value.sharedSecret);
+        decapsulated.destroy();
+        outcome.value.destroy();
+        keyPairs[i].destroy();
+      }
+    });
+
+    test("edges on separate modules share batch calls", async () => {
+      // One module per edge, as handleConnectToPeer creates them.
+      const modules = await Promise.all(
+        Array.from({ length: 4 }, () => loadTestModule()),
+      );
+      const calls: number[] = [];
+      for (const module of modules) {
+        const exports = module as unknown as Record<
+          string,
+          (...args: number[]) => number
+        >;
+        for (const name of [
+          suite.wasmExports.keypairBatch,
+          suite.wasmExports.encapsBatch,
+        ]) {
+          const batch = exports[name];
+          exports[name] = (...args: number[]): number => {
+            calls.push(args[args.length - 1]);
+            return batch(...args);
+          };
+        }
+      }
+      const backends = modules.map((module) =>
+        createMlKemBackend(module, suite),
+      );
+
+      const keyPairs = await Promise.all(
+        backends.map((backend) => backend.generateKeyPair()),
+      );
+      expect(calls).toEqual([4]);
+
+      const encapsulations = await Promise.all(
+        backends.map((backend, i) =>
+          backend.encapsulate(keyPairs[(i + 1) % 4].publicKey),
+        ),
+      );
+      expect(calls).toEqual([4, 4]);
+
+      for (let i = 0; i < 4; i++) {
+        const decapsulated = await backends[(i + 1) % 4].decapsulate(
+          encapsulations[i].ciphertext,
+          keyPairs[(i + 1) % 4].secretKey,
+        );
+        expectBytesEqual(
+          decapsulated.sharedSecret,
+          encapsulations[i].sharedSecret,
+        );
+        decapsulated.destroy();
+        encapsulations[i].destroy();
+      }
+      for (const keyPair of keyPairs) keyPair.destroy();
+    });
+
+    test("expanded keys encapsulate exactly like the original key", async () => {
+      const module = (await loadTestModule()) as MlKemModule;
+      const keypair = getRawWasmFunction(module, suite.wasmExports.keypair);
+      const encaps = getRawWasmFunction(module, suite.wasmExports.encaps);
+      const expandedBytes = getRawWasmFunction(
+        module,
+        suite.wasmExports.expandedBytes,
+      );
+      const expand = getRawWasmFunction(module, suite.wasmExports.expand);
+      const encapsExpanded = getRawWasmFunction(
+        module,
+        suite.wasmExports.encapsExpanded,
+      );
+      // One byte of slack so the key can also start unaligned.
+      const sizes = [
+        suite.publicKeyBytes,
+        suite.secretKeyBytes,
+        suite.ciphertextBytes,
+        suite.sharedSecretBytes,
+        suite.keyPairRandomBytes,
+        suite.encapsRandomBytes,
+        expandedBytes() + 1,
+      ];
+      const ptrs = sizes.map((size) => module._malloc(size));
+      const heap = (i: number): Uint8Array =>
+        new Uint8Array(module.wasmMemory.buffer, ptrs[i], sizes[i]);
+      const [pk, sk, ct, ss, keyCoins, encCoins, memory] = ptrs;
+      try {
+        globalThis.crypto.getRandomValues(heap(4));
+        expect(keypair(pk, sk, keyCoins)).toBe(0);
+
+        for (const offset of [0, 1]) {
+          expect(expand(memory + offset, pk)).toBe(0);
+          for (let i = 0; i < 3; i++) {
+            globalThis.crypto.getRandomValues(heap(5));
+            expect(encaps(ct, ss, pk, encCoins)).toBe(0);
+            const ciphertext = Uint8Array.from(heap(2));
+            const sharedSecret = Uint8Array.from(heap(3));
+            expect(encapsExpanded(ct, ss, memory + offset, encCoins)).toBe(0);
+            expectBytesEqual(heap(2), ciphertext);
+            expectBytesEqual(heap(3), sharedSecret);
+          }
+        }
+
+        // First coefficient 0xfff is not reduced mod q.
+        heap(0)[0] = 0xff;
+        heap(0)[1] |= 0x0f;
+        expect(expand(memory, pk)).not.toBe(0);
+        expect(heap(6).subarray(0, -1).every((byte) => byte === 0)).toBe(true);
+        expect(encapsExpanded(ct, ss, memory, encCoins)).not.toBe(0);
+      } finally {
+        ptrs.forEach((ptr, i) => {
+          heap(i).fill(0);
+          module._free(ptr);
+        });
+      }
+    });
+
+    test("the expanded-key cache reuses keys within its byte budget", async () => {
+      const backend = createMlKemBackend(await loadTestModule(), suite);
+      const keyPairs = await Promise.all(
+        Array.from({ length: 3 }, () => backend.generateKeyPair()),
+      );
+      const probe = await backend.expandPublicKey(keyPairs[0].publicKey);
+      const cache = new MlKemExpandedKeyCache(backend, 2 * probe.byteLength);
+      probe.free();
+      probe.free();
+      expect(probe.freed).toBe(true);
+      await expect(backend.encapsulateExpanded(probe)).rejects.toThrow(
+        "expanded public key is freed or foreign",
+      );
+
+      for (const i of [0, 1, 0, 2, 0, 2]) {
+        const encapsulated = await cache.encapsulate(keyPairs[i].publicKey);
+        const decapsulated = await backend.decapsulate(
+          encapsulated.ciphertext,
+          keyPairs[i].secretKey,
+        );
+        expectBytesEqual(decapsulated.sharedSecret, encapsulated.sharedSecret);
+        decapsulated.destroy();
+        encapsulated.destroy();
+        expect(cache.bytes).toBeLessThanOrEqual(cache.maxBytes);
+      }
+      // Key 1 was least recently used when key 2 arrived.
+      expect(cache.size).toBe(2);
+      expect(cache.delete(keyPairs[1].publicKey)).toBe(false);
+      expect(cache.delete(keyPairs[0].publicKey)).toBe(true);
+      expect(cache.bytes).toBe(probe.byteLength);
+
+      const tiny = new MlKemExpandedKeyCache(backend, 0);
+      (await tiny.encapsulate(keyPairs[0].publicKey)).destroy();
+      expect(tiny.size).toBe(0);
+      expect(tiny.bytes).toBe(0);
+
+      cache.clear();
+      expect(cache.size).toBe(0);
+      expect(cache.bytes).toBe(0);
+      for (const keyPair of keyPairs) keyPair.destroy();
+    });
+
     test("key generation, encapsulation, and decapsulation round trip", async () => {
       const backend = createMlKemBackend(await loadTestModule(), suite);
       const keyPair = await backend.generateKeyPair();
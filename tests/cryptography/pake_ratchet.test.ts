@@ -1,5 +1,5 @@
 import { describe, expect, test, beforeAll } from "bun:test";
-import { readFileSync } from "node:fs";
+import { existsSync, readFileSync } from "node:fs";
 import { hkdfSync } from "node:crypto";
 
 // Bun exposes Web Crypto on globalThis but the emscripten glue probes
@@ -222,6 +222,92 @@ describe("Symmetric AEAD (message-key path)", () => {
   });
 });
 
+describe("SIMD artifact (libcrypto.simd.wasm)", () => {
+  const simdUrl = new URL(
+    "../../src/cryptography/libcrypto.simd.wasm",
+    import.meta.url,
+  );
+
+  // Long enough for the four-way Poly1305 path and a ChaCha20 tail, with an
+  // AAD that is not a multiple of 16.
+  test.skipIf(!existsSync(simdUrl))(
+    "AEAD output matches the scalar artifact and round-trips",
+    async () => {
+      const fileBytes = readFileSync(simdUrl);
+      const wasmBinary = new ArrayBuffer(fileBytes.byteLength);
+      new Uint8Array(wasmBinary).set(fileBytes);
+      const simdMem = new WebAssembly.Memory({
+        initial: PAGES,
+        maximum: PAGES,
+      });
+      const simd = (await libcrypto({
+        wasmBinary,
+        wasmMemory: simdMem,
+      })) as unknown as LibCrypto;
+
+      const key = globalThis.crypto.getRandomValues(new Uint8Array(32));
+      const nonce = globalThis.crypto.getRandomValues(new Uint8Array(12));
+      const aad = globalThis.crypto.getRandomValues(new Uint8Array(121));
+      const pt = globalThis.crypto.getRandomValues(new Uint8Array(4099));
+
+      const seal = (m: LibCrypto, memory: WebAssembly.Memory): Uint8Array => {
+        const at = (bytes: Uint8Array): number => {
+          const ptr = m._malloc(bytes.length);
+          new Uint8Array(memory.buffer, ptr, bytes.length).set(bytes);
+          return ptr;
+        };
+        const ptrs = [at(pt), at(key), at(nonce), at(aad)];
+        const outp = m._malloc(pt.length + 16);
+        expect(
+          m._encrypt_chachapoly_symmetric(
+            outp,
+            ptrs[0],
+            pt.length,
+            ptrs[1],
+            ptrs[2],
+            ptrs[3],
+            aad.length,
+          ),
+        ).toBe(0);
+        const out = new Uint8Array(memory.buffer, outp, pt.length + 16).slice();
+
+        const backp = m._malloc(pt.length);
+        expect(
+          m._decrypt_chachapoly_symmetric(
+            backp,
+            outp,
+            out.length,
+            ptrs[1],
+            ptrs[2],
+            ptrs[3],
+            aad.length,
+          ),
+        ).toBe(0);
+        expect(
+          Buffer.from(new Uint8Array(memory.buffer, backp, pt.length)),
+        ).toEqual(Buffer.from(pt));
+
+        new Uint8Array(memory.buffer, outp + pt.length, 1)[0] ^= 1;
+        expect(
+          m._decrypt_chachapoly_symmetric(
+            backp,
+            outp,
+            out.length,
+            ptrs[1],
+            ptrs[2],
+            ptrs[3],
+            aad.length,
+          ),
+        ).toBe(-1);
+        [...ptrs, outp, backp].forEach((p) => m._free(p));
+        return out;
+      };
+
+      expect(bytesToHex(seal(simd, simdMem))).toBe(bytesToHex(seal(mod, mem)));
+    },
+  );
+});
+
 describe("receive_message_with_key (smoke: exported, links, callable)", () => {
   const MESSAGE_LEN = 64 * 1024;
   test("garbage frame returns a negative error (AEAD auth fails)", () => {
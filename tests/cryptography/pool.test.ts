@@ -0,0 +1,67 @@
+import { describe, expect, test } from "bun:test";
+
+import { createMerkleTree, getMerkleRoot } from "../../src/cryptography/merkle";
+import {
+  loadTestModule,
+  loadThreadedTestModule,
+} from "../../src/cryptography/testModule";
+import { setWasmThreads } from "../../src/cryptography/wasmLoader";
+import { hashMerkleLeavesWasm } from "../../src/utils/leafHash";
+
+const threaded = await loadThreadedTestModule(4);
+
+describe("task pool", () => {
+  test("the single-threaded artifacts run every batch on the caller", async () => {
+    const module = await loadTestModule();
+    expect(module._pool_threads()).toBe(1);
+    expect(module._pool_init(4)).toBe(0);
+    expect(module._pool_threads()).toBe(1);
+    expect(module._pool_init(0)).toBe(-1);
+    expect(module._pool_init(9)).toBe(-1);
+
+    // Enough nodes for several pool tasks per level on a threaded build.
+    const leaves = new Uint8Array(1_000 * 64).map((_, i) => (i * 31) & 0xff);
+    const tree = await createMerkleTree(leaves, module);
+    try {
+      expect(tree.root).toEqual(await getMerkleRoot(leaves.slice(), module));
+    } finally {
+      tree.free();
+    }
+  });
+
+  test.skipIf(threaded === null)(
+    "the threaded artifact pools leaf and tree batches with the serial results",
+    async () => {
+      if (!threaded) return;
+      const serial = await loadTestModule();
+      expect(threaded._pool_threads()).toBe(4);
+
+      // 64 cells are 16 four-lane groups, several tasks per thread.
+      const chunks = Array.from({ length: 64 }, (_, i) =>
+        new Uint8Array(1_000).map((_, j) => (i * 131 + j * 7) & 0xff),
+      );
+      const leaves = hashMerkleLeavesWasm(chunks, threaded);
+      expect(leaves).toEqual(hashMerkleLeavesWasm(chunks, serial));
+
+      const nodes = new Uint8Array(1_000 * 64).map((_, i) => (i * 31) & 0xff);
+      const expected = await getMerkleRoot(nodes.slice(), serial);
+      // Out of place through merkle_tree_build on a threaded module.
+      expect(await getMerkleRoot(nodes.slice(), threaded)).toEqual(expected);
+      const tree = await createMerkleTree(nodes, threaded);
+      const serialTree = await createMerkleTree(nodes, serial);
+      try {
+        expect(tree.root).toEqual(expected);
+        for (const index of [0, 511, 999])
+          expect(tree.getProof(index)).toEqual(serialTree.getProof(index));
+      } finally {
+        tree.free();
+        serialTree.free();
+      }
+    },
+  );
+
+  test("setWasmThreads takes the caller plus up to seven workers", () => {
+    for (const threads of [0, 9, 2.5])
+      expect(() => setWasmThreads(threads)).toThrow(RangeError);
+  });
+});
@@ -7,9 +7,18 @@ import {
   ratchetDecrypt,
   serializeRatchet,
   deserializeRatchet,
+  cloneRatchet,
+  adoptRatchet,
+  wipeRatchet,
 } from "../../src/cryptography/ratchet";
+import { hkdfExtract } from "../../src/cryptography/hkdf";
 import type { RatchetSessionSecrets } from "../../src/cryptography/ratchet";
-import { MAX_SKIP, MAX_SKIP_SESSION } from "../../src/utils/constants";
+import {
+  KDF_CK_LABEL,
+  KDF_MK_LABEL,
+  MAX_SKIP,
+  MAX_SKIP_SESSION,
+} from "../../src/utils/constants";
 
 // True iff the (dhPub, n) pair is present in a serialized skipped-key snapshot
 // — used to probe eviction without depending on the internal Map key encoding.
@@ -168,16 +177,87 @@ describe("ratchet", () => {
     // Fill the cumulative cache to its cap with a sentinel as the oldest
     // insertion. Decrypting m2 derives/stashes m1, forcing exactly one
     // oldest-first eviction while this reference remains observable.
+    const sentinel = `${"a5".repeat(32)}:0`;
     const evictedKeyReference = new Uint8Array(32).fill(0xa5);
-    bob.skipped.set("oldest-sentinel", evictedKeyReference);
+    bob.skipped.set(sentinel, evictedKeyReference);
     for (let i = 1; i < MAX_SKIP_SESSION; i++) {
-      bob.skipped.set(`synthetic:${i}`, new Uint8Array(32).fill(i & 0xff));
+      bob.skipped.set(
+        `${"5a".repeat(32)}:${i}`,
+        new Uint8Array(32).fill(i & 0xff),
+      );
     }
+    // The table owns its keys: the stored buffer is wiped on insert.
+    expect(evictedKeyReference.every((byte) => byte === 0)).toBe(true);
+    expect(bob.skipped.size).toBe(MAX_SKIP_SESSION);
 
     const recovered = ratchetDecrypt(bob, m2.header, module);
     expect(Buffer.from(recovered)).toEqual(Buffer.from(m2.messageKey));
-    expect(bob.skipped.has("oldest-sentinel")).toBe(false);
-    expect(evictedKeyReference.every((byte) => byte === 0)).toBe(true);
+    expect(bob.skipped.has(sentinel)).toBe(false);
+    expect(bob.skipped.size).toBe(MAX_SKIP_SESSION);
+  });
+
+  test("the C chain step matches the labelled HMAC-SHA512 derivation", async () => {
+    const { module, alice } = await pair();
+    const chainKey = Uint8Array.from(alice.sendingChainKey!);
+    const { messageKey } = ratchetEncrypt(alice, module);
+
+    const mk = hkdfExtract(
+      chainKey,
+      new TextEncoder().encode(KDF_MK_LABEL),
+      module,
+    );
+    const ck = hkdfExtract(
+      chainKey,
+      new TextEncoder().encode(KDF_CK_LABEL),
+      module,
+    );
+    expect(Buffer.from(messageKey)).toEqual(Buffer.from(mk.subarray(0, 32)));
+    expect(Buffer.from(alice.sendingChainKey!)).toEqual(
+      Buffer.from(ck.subarray(0, 32)),
+    );
+  });
+
+  test("a rejected step leaves the state untouched", async () => {
+    const { module, alice, bob } = await pair();
+    ratchetDecrypt(bob, ratchetEncrypt(alice, module).header, module);
+    const m1 = ratchetEncrypt(alice, module);
+    const before = serializeRatchet(bob);
+
+    expect(() =>
+      ratchetDecrypt(bob, { ...m1.header, N: MAX_SKIP + 2 }, module),
+    ).toThrow(/MAX_SKIP exceeded/);
+    expect(serializeRatchet(bob)).toEqual(before);
+
+    const k1 = ratchetDecrypt(bob, m1.header, module);
+    expect(Buffer.from(k1)).toEqual(Buffer.from(m1.messageKey));
+  });
+
+  test("a state keeps one engine across steps; a clone copies it and is adopted with it", async () => {
+    const { module, alice, bob } = await pair();
+    const engine = alice.engine;
+    expect(engine?.synced).toBe(true);
+    const m0 = ratchetEncrypt(alice, module);
+    ratchetEncrypt(alice, module);
+    expect(alice.engine).toBe(engine);
+
+    const candidate = cloneRatchet(bob);
+    expect(candidate.engine).not.toBe(bob.engine);
+    const k0 = ratchetDecrypt(candidate, m0.header, module);
+    expect(Buffer.from(k0)).toEqual(Buffer.from(m0.messageKey));
+    const adopted = candidate.engine;
+    adoptRatchet(bob, candidate);
+    expect(bob.engine).toBe(adopted);
+    expect(bob.Nr).toBe(1);
+
+    // A restored state has no engine until its first step imports it.
+    const restored = deserializeRatchet(serializeRatchet(alice), module);
+    expect(restored.engine).toBeUndefined();
+    const m2 = ratchetEncrypt(restored, module);
+    expect(m2.header.N).toBe(2);
+    expect(restored.engine?.synced).toBe(true);
+
+    wipeRatchet(restored);
+    expect(restored.engine).toBeUndefined();
   });
 
   test("a header with a negative or non-integer N/PN is rejected", async () => {
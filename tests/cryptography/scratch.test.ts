@@ -0,0 +1,84 @@
+import { describe, expect, test } from "bun:test";
+
+import { newKeyPair, sign, verify } from "../../src/cryptography/ed25519";
+import {
+  attachScratchArena,
+  withScratch,
+} from "../../src/cryptography/scratch";
+import { loadTestModule } from "../../src/cryptography/testModule";
+
+describe("scratch frames", () => {
+  test("a popped frame wipes its arena scratch and rewinds", async () => {
+    const module = await loadTestModule();
+    attachScratchArena(module, 1024);
+
+    let first = 0;
+    withScratch(module, (frame) => {
+      first = frame.put(new Uint8Array(48).fill(0xaa));
+      const nested = withScratch(module, (inner) =>
+        inner.put(new Uint8Array(16).fill(0xbb)),
+      );
+      expect(nested % 16).toBe(0);
+      expect(new Uint8Array(module.wasmMemory.buffer, nested, 16)).toEqual(
+        new Uint8Array(16),
+      );
+      expect(frame.view(first, 48).every((byte) => byte === 0xaa)).toBe(true);
+    });
+
+    expect(
+      new Uint8Array(module.wasmMemory.buffer, first, 48).every(
+        (byte) => byte === 0,
+      ),
+    ).toBe(true);
+    // The next frame starts where the first one did.
+    expect(withScratch(module, (frame) => frame.alloc(1))).toBe(first);
+  });
+
+  test("scratch past the arena spills to the heap and is wiped before free", async () => {
+    const module = await loadTestModule();
+    attachScratchArena(module, 1024);
+    const originalFree = module._free;
+    const wiped: boolean[] = [];
+    let spilled = 0;
+
+    module._free = (ptr: number): void => {
+      if (ptr === spilled)
+        wiped.push(
+          new Uint8Array(module.wasmMemory.buffer, ptr, 4096).every(
+            (byte) => byte === 0,
+          ),
+        );
+      originalFree(ptr);
+    };
+
+    try {
+      expect(() =>
+        withScratch(module, (frame) => {
+          frame.alloc(512);
+          spilled = frame.put(new Uint8Array(4096).fill(0xcc));
+          throw new Error("operation failed");
+        }),
+      ).toThrow("operation failed");
+      expect(wiped).toEqual([true]);
+    } finally {
+      module._free = originalFree;
+    }
+  });
+
+  test("helpers run the same on a module with an arena", async () => {
+    const module = await loadTestModule();
+    attachScratchArena(module);
+    const message = new Uint8Array(100_000).fill(7);
+    const keyPair = await newKeyPair(module);
+
+    const signature = await sign(message, keyPair.secretKey, module);
+    expect(await verify(message, signature, keyPair.publicKey, module)).toBe(
+      true,
+    );
+    signature[0] ^= 1;
+    expect(await verify(message, signature, keyPair.publicKey, module)).toBe(
+      false,
+    );
+    keyPair.secretKey.fill(0);
+  });
+});
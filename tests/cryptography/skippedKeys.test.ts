@@ -0,0 +1,87 @@
+import { describe, expect, test } from "bun:test";
+
+import { loadTestModule } from "../../src/cryptography/testModule";
+import {
+  SkippedKeyTable,
+  toSkippedKeyTable,
+} from "../../src/cryptography/skippedKeys";
+
+const dh = (byte: number): string =>
+  byte.toString(16).padStart(2, "0").repeat(32);
+
+const mk = (byte: number): Uint8Array => new Uint8Array(32).fill(byte);
+
+describe("SkippedKeyTable (skipped_keys.c)", () => {
+  test("behaves like the Map it replaces, oldest first", async () => {
+    const module = await loadTestModule();
+    const table = new SkippedKeyTable(module);
+    try {
+      expect(table.ptr).toBe(0);
+      for (let n = 0; n < 40; n++) table.set(`${dh(1)}:${n}`, mk(n));
+      table.set(`${dh(2)}:7:42`, mk(0xee));
+
+      expect(table.size).toBe(41);
+      expect(table.has(`${dh(1)}:39`)).toBe(true);
+      expect(table.has(`${dh(1)}:40`)).toBe(false);
+      expect(Buffer.from(table.get(`${dh(1)}:5`)!)).toEqual(
+        Buffer.from(mk(5)),
+      );
+      // The epoch is part of the key.
+      expect(table.has(`${dh(2)}:7`)).toBe(false);
+      expect(table.has(`${dh(2)}:7:42`)).toBe(true);
+
+      expect(table.delete(`${dh(1)}:0`)).toBe(true);
+      expect(table.delete(`${dh(1)}:0`)).toBe(false);
+      const keys = Array.from(table.keys());
+      expect(keys[0]).toBe(`${dh(1)}:1`);
+      expect(keys[keys.length - 1]).toBe(`${dh(2)}:7:42`);
+
+      const copy = table.clone();
+      expect(Buffer.from(copy.take(`${dh(1)}:1`)!)).toEqual(
+        Buffer.from(mk(1)),
+      );
+      expect(copy.size).toBe(39);
+      expect(table.size).toBe(40);
+      copy.free();
+    } finally {
+      table.free();
+    }
+    expect(table.size).toBe(0);
+  });
+
+  test("evicts the oldest key past its limit and rejects malformed keys", async () => {
+    const module = await loadTestModule();
+    const table = new SkippedKeyTable(module, 12);
+    try {
+      for (let n = 0; n < 20; n++) table.set(`${dh(3)}:${n}`, mk(n));
+      expect(table.size).toBe(12);
+      expect(table.has(`${dh(3)}:7`)).toBe(false);
+      expect(table.has(`${dh(3)}:8`)).toBe(true);
+
+      expect(() => table.set("synthetic:1", mk(1))).toThrow(
+        "skipped keys: invalid key",
+      );
+      expect(() => table.set(`${dh(3)}:1`, new Uint8Array(16))).toThrow(
+        "skipped keys: invalid message key",
+      );
+    } finally {
+      table.free();
+    }
+  });
+
+  test("moves a restored Map into a table and wipes it", async () => {
+    const module = await loadTestModule();
+    const stored = mk(9);
+    const map = new Map([[`${dh(4)}:3`, stored]]);
+    const table = toSkippedKeyTable(map, module);
+    try {
+      expect(map.size).toBe(0);
+      expect(stored.every((byte) => byte === 0)).toBe(true);
+      expect(Buffer.from(table.get(`${dh(4)}:3`)!)).toEqual(
+        Buffer.from(mk(9)),
+      );
+    } finally {
+      table.free();
+    }
+  });
+});
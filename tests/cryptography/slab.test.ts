@@ -0,0 +1,67 @@
+import { describe, expect, test } from "bun:test";
+
+import {
+  attachSlab,
+  secureMalloc,
+  slabFree,
+  slabStats,
+} from "../../src/cryptography/slab";
+import { loadTestModule } from "../../src/cryptography/testModule";
+import { zeroFree } from "../../src/utils/zeroFree";
+
+describe("secure slab", () => {
+  test("slots are served per size class and wiped by zeroFree", async () => {
+    const module = await loadTestModule();
+    attachSlab(module);
+
+    const keyPtr = secureMalloc(module, 32);
+    const aadPtr = secureMalloc(module, 121);
+    expect(keyPtr % 16).toBe(0);
+    const key = new Uint8Array(module.wasmMemory.buffer, keyPtr, 32);
+    key.fill(0x42);
+
+    const before = slabStats(module);
+    expect(before?.find((k) => k.size === 32)?.inUse).toBe(1);
+    expect(before?.find((k) => k.size === 128)?.inUse).toBe(1);
+
+    zeroFree(module, key);
+    expect(
+      new Uint8Array(module.wasmMemory.buffer, keyPtr, 32).every(
+        (byte) => byte === 0,
+      ),
+    ).toBe(true);
+    // LIFO reuse: the freed slot is the next one handed out.
+    expect(secureMalloc(module, 20)).toBe(keyPtr);
+
+    expect(() => slabFree(module, aadPtr + 16)).toThrow("live slab slot");
+    expect(slabFree(module, aadPtr)).toBe(true);
+    expect(() => slabFree(module, aadPtr)).toThrow("live slab slot");
+  });
+
+  test("a full class misses to the heap and zeroFree still frees it", async () => {
+    const module = await loadTestModule();
+    attachSlab(module, 1);
+
+    const cell = secureMalloc(module, 65_536);
+    const spilled = secureMalloc(module, 65_536);
+    const stats = slabStats(module)?.at(-1);
+    expect(stats?.inUse).toBe(1);
+    expect(stats?.misses).toBe(1);
+
+    const view = new Uint8Array(module.wasmMemory.buffer, spilled, 65_536);
+    view.fill(0x99);
+    expect(slabFree(module, spilled)).toBe(false);
+    zeroFree(module, view);
+    expect(view.every((byte) => byte === 0)).toBe(true);
+    zeroFree(module, new Uint8Array(module.wasmMemory.buffer, cell, 65_536));
+    expect(slabStats(module)?.at(-1)?.inUse).toBe(0);
+  });
+
+  test("modules without a slab keep using the heap", async () => {
+    const module = await loadTestModule();
+    expect(slabStats(module)).toBeNull();
+    const ptr = secureMalloc(module, 32);
+    expect(slabFree(module, ptr)).toBe(false);
+    zeroFree(module, new Uint8Array(module.wasmMemory.buffer, ptr, 32));
+  });
+});
@@ -0,0 +1,41 @@
+import { describe, expect, test } from "bun:test";
+
+import { newKeyPair, sign, verify } from "../../src/cryptography/ed25519";
+import { cryptoStats, mergeCryptoStats } from "../../src/cryptography/stats";
+import { loadTestModule } from "../../src/cryptography/testModule";
+
+describe("libcrypto statistics", () => {
+  test("count each call from JavaScript with its bytes and return code", async () => {
+    const module = await loadTestModule();
+    // Production artifacts are built without statistics.
+    if (module._libcrypto_stats_bytes() === 0) {
+      expect(cryptoStats(module)).toBeNull();
+      expect(module._libcrypto_stats_snapshot(0, 0)).toBe(-1);
+      return;
+    }
+
+    const { publicKey, secretKey } = await newKeyPair(module);
+    const message = new Uint8Array(100).fill(7);
+    const signature = await sign(message, secretKey, module);
+    expect(await verify(message, signature, publicKey, module)).toBe(true);
+    signature[0] ^= 1;
+    expect(await verify(message, signature, publicKey, module)).toBe(false);
+
+    const stats = cryptoStats(module);
+    if (!stats) throw new Error("expected statistics");
+    expect(stats.sign.calls).toBe(1);
+    expect(stats.sign.bytes).toBe(100);
+    expect(stats.sign.codes).toEqual({ "0": 1 });
+    expect(stats.verify.calls).toBe(2);
+    expect(stats.verify.bytes).toBe(200);
+    expect(stats.verify.codes).toEqual({ "0": 1, "-1": 1 });
+    expect(stats.verify.latency).toHaveLength(24);
+    expect(stats.verify.latency.reduce((a, b) => a + b)).toBe(2);
+    expect(stats.argon2id_hash.calls).toBe(0);
+
+    const twice = mergeCryptoStats(stats, stats);
+    expect(twice?.verify.codes).toEqual({ "0": 2, "-1": 2 });
+    expect(twice?.verify.totalNs).toBe(2 * stats.verify.totalNs);
+    expect(mergeCryptoStats(null, stats)).toBe(stats);
+  });
+});
@@ -4,7 +4,9 @@ import { classifyFrame } from "../../src/handlers/frameType";
 import {
   FRAME_TYPE_HANDSHAKE,
   FRAME_TYPE_CHUNK,
+  FRAME_TYPE_RANGE_RECEIPT,
   FRAME_TYPE_RECEIPT,
+  WIRE_RANGE_RECEIPT_FRAME_LEN,
   WIRE_RECEIPT_FRAME_LEN,
 } from "../../src/utils/constants";
 
@@ -33,6 +35,14 @@ describe("classifyFrame", () => {
     expect(classifyFrame(raw).payload).toHaveLength(0);
   });
 
+  test("accepts a range receipt only at its exact geometry", () => {
+    const range = new Uint8Array(WIRE_RANGE_RECEIPT_FRAME_LEN);
+    range[0] = FRAME_TYPE_RANGE_RECEIPT;
+    expect(classifyFrame(range).type).toBe(FRAME_TYPE_RANGE_RECEIPT);
+    expect(classifyFrame(range).payload).toHaveLength(80);
+    expect(classifyFrame(range.subarray(0, 65)).type).toBe(-1);
+  });
+
   test("payload is a zero-copy view over the same buffer", () => {
     const frame = new Uint8Array([FRAME_TYPE_CHUNK, 42]);
     const { payload } = classifyFrame(frame);
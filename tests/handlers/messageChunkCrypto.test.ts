@@ -1,22 +1,36 @@
 import { describe, expect, spyOn, test } from "bun:test";
 
-import { loadTestModule } from "../../src/cryptography/testModule";
+import {
+  loadTestModule,
+  loadThreadedTestModule,
+} from "../../src/cryptography/testModule";
 import {
   cloneRatchet,
   initRatchet,
   ratchetEncrypt,
 } from "../../src/cryptography/ratchet";
-import { getMerkleRoot, getMerkleProof } from "../../src/cryptography/merkle";
+import {
+  createMerkleProofCache,
+  getMerkleRoot,
+  getMerkleProof,
+} from "../../src/cryptography/merkle";
 import { hashMerkleLeafWasm } from "../../src/utils/leafHash";
 import { serializeMetadata } from "../../src/utils/metadata";
 import { MessageType } from "../../src/utils/messageTypes";
 import { uint8ArrayToHex } from "../../src/utils/uint8array";
 import { parseChunkFrameHeader } from "../../src/handlers/chunkFrame";
-import { handleReceiveMessage } from "../../src/handlers/handleReceiveMessage";
-import { sendReceiveFrameReceipt } from "../../src/handlers/handleMessageQueueing";
+import {
+  handleReceiveMessage,
+  handleReceiveMessages,
+} from "../../src/handlers/handleReceiveMessage";
+import { sendReceiveFrameReceipts } from "../../src/handlers/handleMessageQueueing";
 import {
   sealChunk,
+  sealMessageChunk,
+  createIngressRing,
   decryptMessageChunk,
+  decryptMessageChunks,
+  discardDecrypted,
   messageCacheKey,
 } from "../../src/handlers/messageChunkCrypto";
 import { forgetCompletedReceiveMessageKey } from "../../src/handlers/receiveMessageKeyLifetime";
@@ -32,6 +46,7 @@ import {
   CHUNK_LEN,
   DECRYPTED_LEN,
   RATCHET_ROOT_SUITE_MLKEM768,
+  WIRE_CHUNK_FRAME_LEN,
 } from "../../src/utils/constants";
 import { SparsePqHealingState } from "../../src/handlers/pqHealingRuntime";
 import type { PqMessageKeyContext } from "../../src/cryptography/pqMessageKey";
@@ -131,6 +146,8 @@ const buildRealFirstCoverMessage = async (module: LibCrypto) => {
   return { root, plaintexts };
 };
 
+const threaded = await loadThreadedTestModule(4);
+
 const chunkOf = (decrypted: Uint8Array): Uint8Array =>
   decrypted.slice(METADATA_LEN + PROOF_LEN);
 const receiptOf = (decrypted: Uint8Array): Uint8Array =>
@@ -184,6 +201,315 @@ describe("messageChunkCrypto (single-call C receive)", () => {
     );
   });
 
+  test("sealMessageChunk seals the cell parts in C into an exact wire cell the C receive opens", async () => {
+    const { module, alice, bob } = await pair();
+    const { root, datas, plaintexts } = await buildMessage(module, 2);
+    const { messageKey, header } = ratchetEncrypt(alice, module);
+
+    const frames = plaintexts.map((pt) =>
+      sealMessageChunk(
+        messageKey,
+        header,
+        pt.subarray(0, METADATA_LEN),
+        pt.subarray(METADATA_LEN, METADATA_LEN + PROOF_LEN),
+        pt.subarray(METADATA_LEN + PROOF_LEN),
+        root,
+        module,
+      ),
+    );
+    expect(() =>
+      sealMessageChunk(
+        messageKey,
+        header,
+        plaintexts[0].subarray(0, METADATA_LEN),
+        plaintexts[0].subarray(METADATA_LEN, METADATA_LEN + PROOF_LEN),
+        datas[0].subarray(1),
+        root,
+        module,
+      ),
+    ).toThrow("invalid chunk cell length");
+    messageKey.fill(0);
+
+    expect(frames[0]).toHaveLength(WIRE_CHUNK_FRAME_LEN);
+    const h0 = parseChunkFrameHeader(frames[0]);
+    const h1 = parseChunkFrameHeader(frames[1]);
+    expect(h0.header.N).toBe(header.N);
+    expect(Buffer.from(h0.header.dhPub)).toEqual(Buffer.from(header.dhPub));
+    expect(Buffer.from(h1.nonce)).not.toEqual(Buffer.from(h0.nonce));
+
+    const cache = new Map<string, Uint8Array>();
+    for (let i = 0; i < frames.length; i++) {
+      const d = decryptMessageChunk(bob, frames[i], cache, root, module);
+      expect(d.ok).toBe(true);
+      expect(Buffer.from(chunkOf(d.decrypted!))).toEqual(
+        Buffer.from(datas[i]),
+      );
+    }
+  });
+
+  test("receive_message_with_key_fused returns the same status and bytes as receive_message_with_key, failures included", async () => {
+    const { module, alice } = await pair();
+    const { root, plaintexts } = await buildMessage(module, 3);
+    const { messageKey, header } = ratchetEncrypt(alice, module);
+    const frame = sealMessageChunk(
+      messageKey,
+      header,
+      plaintexts[1].subarray(0, METADATA_LEN),
+      plaintexts[1].subarray(METADATA_LEN, METADATA_LEN + PROOF_LEN),
+      plaintexts[1].subarray(METADATA_LEN + PROOF_LEN),
+      root,
+      module,
+    );
+
+    const framePtr = module._malloc(WIRE_CHUNK_FRAME_LEN);
+    const rootPtr = module._malloc(crypto_hash_sha512_BYTES);
+    const keyPtr = module._malloc(messageKey.length);
+    const outPtr = module._malloc(DECRYPTED_LEN);
+    const heap = () => new Uint8Array(module.wasmMemory.buffer);
+    heap().set(root, rootPtr);
+    heap().set(messageKey, keyPtr);
+    messageKey.fill(0);
+
+    const open = (
+      receive: typeof module._receive_message_with_key,
+      cell: Uint8Array,
+    ) => {
+      heap().set(cell, framePtr);
+      heap().fill(0xa5, outPtr, outPtr + DECRYPTED_LEN);
+      const status = receive(outPtr, framePtr, rootPtr, keyPtr);
+      return {
+        status,
+        bytes: heap().slice(outPtr, outPtr + DECRYPTED_LEN),
+      };
+    };
+
+    try {
+      // Clean, a flipped ciphertext byte late in the chunk, a flipped tag.
+      for (const flip of [-1, 60_000, WIRE_CHUNK_FRAME_LEN - 1]) {
+        const cell = frame.slice();
+        if (flip >= 0) cell[flip] ^= 1;
+        const twoPass = open(module._receive_message_with_key, cell);
+        const fused = open(module._receive_message_with_key_fused, cell);
+        expect(fused.status).toBe(twoPass.status);
+        expect(fused.status).toBe(flip < 0 ? 0 : -2);
+        expect(Buffer.from(fused.bytes)).toEqual(Buffer.from(twoPass.bytes));
+      }
+    } finally {
+      heap().fill(0, keyPtr, keyPtr + 32);
+      heap().fill(0, outPtr, outPtr + DECRYPTED_LEN);
+      [framePtr, rootPtr, keyPtr, outPtr].forEach((ptr) => module._free(ptr));
+    }
+  });
+
+  test("decryptMessageChunks: chunk 0 steps the ratchet, the rest open in batched C calls; a tampered frame fails alone", async () => {
+    const { module, alice, bob } = await pair();
+    const { root, datas, plaintexts } = await buildMessage(module, 6);
+    const { messageKey, header } = ratchetEncrypt(alice, module);
+    const frames = plaintexts.map((pt) =>
+      sealChunk(messageKey, header, pt, root, module),
+    );
+    messageKey.fill(0);
+    frames[4][300] ^= 1;
+
+    const cache = new Map<string, Uint8Array>();
+    const results = decryptMessageChunks(bob, frames, cache, root, module);
+
+    expect(results).toHaveLength(6);
+    expect(results[0].stateAdvanced).toBe(true);
+    expect(bob.Nr).toBe(1);
+    expect(cache.size).toBe(1);
+    for (let i = 0; i < 6; i++) {
+      if (i === 4) {
+        expect(results[i].ok).toBe(false);
+        expect(results[i].decrypted).toBeNull();
+        continue;
+      }
+      expect(results[i].ok).toBe(true);
+      if (i > 0) expect(results[i].stateAdvanced).toBe(false);
+      expect(Buffer.from(chunkOf(results[i].decrypted!))).toEqual(
+        Buffer.from(datas[i]),
+      );
+      expect(Buffer.from(receiptOf(results[i].decrypted!))).toEqual(
+        Buffer.from(hashMerkleLeafWasm(datas[i], module)),
+      );
+    }
+  });
+
+  test.skipIf(threaded === null)(
+    "decryptMessageChunks on the threaded artifact pools each batch and matches the serial build",
+    async () => {
+      if (!threaded) return;
+      const { module, alice, bob } = await pair();
+      const { root, plaintexts } = await buildMessage(module, 9);
+      const { messageKey, header } = ratchetEncrypt(alice, module);
+      const frames = plaintexts.map((pt) =>
+        sealChunk(messageKey, header, pt, root, module),
+      );
+      messageKey.fill(0);
+      frames[6][300] ^= 1;
+
+      const expected = decryptMessageChunks(
+        cloneRatchet(bob),
+        frames,
+        new Map(),
+        root,
+        module,
+      );
+      const results = decryptMessageChunks(
+        cloneRatchet(bob),
+        frames,
+        new Map(),
+        root,
+        threaded,
+      );
+
+      expect(results.map((result) => result.ok)).toEqual(
+        expected.map((result) => result.ok),
+      );
+      expect(results[6].ok).toBe(false);
+      for (let i = 0; i < frames.length; i++) {
+        if (!expected[i].ok) continue;
+        expect(Buffer.from(results[i].decrypted!)).toEqual(
+          Buffer.from(expected[i].decrypted!),
+        );
+      }
+    },
+  );
+
+  test("ingress ring: frames open in place as views of a slot, failures and discards wipe and free the slot, a full ring falls back to copies", async () => {
+    const { module, alice, bob } = await pair();
+    const { root, datas, plaintexts } = await buildMessage(module, 4);
+    const { messageKey, header } = ratchetEncrypt(alice, module);
+    const frames = plaintexts.map((pt) =>
+      sealChunk(messageKey, header, pt, root, module),
+    );
+    messageKey.fill(0);
+
+    const ring = createIngressRing(module, 2);
+    const cache = new Map<string, Uint8Array>();
+    try {
+      const open = (frame: Uint8Array) =>
+        decryptMessageChunk(bob, frame, cache, root, module, undefined, ring);
+
+      const d0 = open(frames[0]);
+      const d1 = open(frames[1]);
+      expect(d0.stateAdvanced).toBe(true);
+      for (const [i, d] of [d0, d1].entries()) {
+        expect(d.ok).toBe(true);
+        expect(d.release).toBeDefined();
+        expect(d.decrypted!.buffer).toBe(module.wasmMemory.buffer);
+        expect(Buffer.from(chunkOf(d.decrypted!))).toEqual(
+          Buffer.from(datas[i]),
+        );
+      }
+
+      // Both slots are held: the next frame takes the owned-copy path.
+      const d2 = open(frames[2]);
+      expect(d2.ok).toBe(true);
+      expect(d2.release).toBeUndefined();
+      expect(d2.decrypted!.buffer).not.toBe(module.wasmMemory.buffer);
+
+      const view = d0.decrypted!;
+      discardDecrypted(d0);
+      discardDecrypted(d0);
+      expect(view.every((b) => b === 0)).toBe(true);
+
+      // A failed open releases its slot straight away.
+      const tampered = Uint8Array.from(frames[3]);
+      tampered[300] ^= 1;
+      const bad = open(tampered);
+      expect(bad.ok).toBe(false);
+      expect(bad.release).toBeUndefined();
+
+      const d3 = open(frames[3]);
+      expect(d3.ok).toBe(true);
+      expect(d3.release).toBeDefined();
+      expect(Buffer.from(chunkOf(d3.decrypted!))).toEqual(
+        Buffer.from(datas[3]),
+      );
+      discardDecrypted(d1);
+      discardDecrypted(d3);
+    } finally {
+      ring.free();
+    }
+  });
+
+  test("a transfer's proof cache verifies in the ring, copy and batch paths; a cache bound to another root fails the frame", async () => {
+    const { module, alice, bob } = await pair();
+    const { root, datas, plaintexts } = await buildMessage(module, 6);
+    const { messageKey, header } = ratchetEncrypt(alice, module);
+    const frames = plaintexts.map((pt) =>
+      sealChunk(messageKey, header, pt, root, module),
+    );
+    messageKey.fill(0);
+
+    const ring = createIngressRing(module, 1);
+    const proofCache = createMerkleProofCache(root, module);
+    const otherCache = createMerkleProofCache(rand(64), module);
+    const cache = new Map<string, Uint8Array>();
+    try {
+      const open = (frame: Uint8Array, proof = proofCache) =>
+        decryptMessageChunk(
+          bob,
+          frame,
+          cache,
+          root,
+          module,
+          undefined,
+          ring,
+          proof,
+        );
+
+      // Slot path, then the copy path while the only slot is held.
+      const d0 = open(frames[0]);
+      const d1 = open(frames[1]);
+      expect(d0.release).toBeDefined();
+      expect(d1.release).toBeUndefined();
+      for (const [i, d] of [d0, d1].entries()) {
+        expect(d.ok).toBe(true);
+        expect(Buffer.from(chunkOf(d.decrypted!))).toEqual(
+          Buffer.from(datas[i]),
+        );
+      }
+      discardDecrypted(d0);
+      discardDecrypted(d1);
+
+      const wrong = open(frames[2], otherCache);
+      expect(wrong.ok).toBe(false);
+
+      const results = decryptMessageChunks(
+        bob,
+        frames.slice(2),
+        cache,
+        root,
+        module,
+        undefined,
+        proofCache,
+      );
+      results.forEach((d, i) => {
+        expect(d.ok).toBe(true);
+        expect(Buffer.from(chunkOf(d.decrypted!))).toEqual(
+          Buffer.from(datas[i + 2]),
+        );
+      });
+      expect(
+        decryptMessageChunks(
+          bob,
+          frames.slice(2, 3),
+          cache,
+          root,
+          module,
+          undefined,
+          otherCache,
+        )[0].ok,
+      ).toBe(false);
+    } finally {
+      proofCache.free();
+      otherCache.free();
+      ring.free();
+    }
+  });
+
   test("v4 combines against an explicit PQ epoch, uses an epoch-bound cache identity, and rejects unknown epochs before ratchet mutation", async () => {
     const { module, alice, bob } = await pair();
     const { root, datas, plaintexts } = await buildMessage(module, 1);
@@ -564,8 +890,10 @@ describe("messageChunkCrypto (single-call C receive)", () => {
           },
         );
         results.push(result);
-        expect(sendReceiveFrameReceipt(result, receiptChannel)).toBe(true);
       }
+      expect(
+        sendReceiveFrameReceipts(results, receiptChannel, root, module),
+      ).toBe(3);
 
       expect(results.map((result) => result.receivedFullSize)).toEqual([
         true,
@@ -578,6 +906,7 @@ describe("messageChunkCrypto (single-call C receive)", () => {
       expect(bob.Nr).toBe(1);
       expect(epc.messageKeyCache.has(cacheKey)).toBe(true);
       expect(epc.messageKeyByMerkleRoot?.get(merkleRootHex)).toBe(cacheKey);
+      expect(epc.proofCaches?.has(merkleRootHex)).toBe(true);
 
       const cachedMessageKey = epc.messageKeyCache.get(cacheKey)!;
       let forgetCalls = 0;
@@ -615,6 +944,7 @@ describe("messageChunkCrypto (single-call C receive)", () => {
         ),
       ).toBe(false);
       expect(forgetCalls).toBe(1);
+      expect(epc.proofCaches?.has(merkleRootHex)).toBe(false);
       expect(cachedMessageKey.every((byte) => byte === 0)).toBe(true);
       expect(epc.messageKeyCache.has(cacheKey)).toBe(false);
       expect(bob.skipped.has(cacheKey)).toBe(false);
@@ -623,6 +953,72 @@ describe("messageChunkCrypto (single-call C receive)", () => {
     }
   });
 
+  test("handleReceiveMessages steps the ratchet durably for a first chunk and opens the key-cache hits after it in one batched call", async () => {
+    const { module, alice, bob } = await pair();
+    const { root, plaintexts } = await buildRealFirstCoverMessage(module);
+    const { messageKey, header } = ratchetEncrypt(alice, module);
+    const frames = plaintexts.map((plaintext) =>
+      sealChunk(messageKey, header, plaintext, root, module),
+    );
+    messageKey.fill(0);
+    const tampered = Uint8Array.from(frames[1]);
+    tampered[300] ^= 1;
+    frames.push(tampered);
+
+    const epc = edge(bob);
+    epc.messageKeyCache = new Map<string, Uint8Array>();
+    let persisted = 0;
+    let stored = 0;
+    const batch = spyOn(module, "_receive_message_batch");
+    const errorLog = spyOn(console, "error").mockImplementation(() => {});
+
+    try {
+      const results = await handleReceiveMessages(
+        frames,
+        "room-1",
+        "chat",
+        epc,
+        root,
+        module,
+        undefined,
+        {
+          persistRatchetState: async () => {
+            persisted += 1;
+          },
+          storeReceiveChunk: async () => {
+            stored += 1;
+            return { stored: true, savedSize: 4, complete: true };
+          },
+        },
+      );
+
+      expect(results.map((result) => result.receivedFullSize)).toEqual([
+        true,
+        false,
+        false,
+        false,
+      ]);
+      expect(results.map((result) => result.chunkIndex)).toEqual([
+        0, -1, -1, -1,
+      ]);
+      // Cover cells carry a leaf; the tampered frame is a plain drop.
+      expect(results.map((result) => result.leafHash.length)).toEqual([
+        crypto_hash_sha512_BYTES,
+        crypto_hash_sha512_BYTES,
+        crypto_hash_sha512_BYTES,
+        0,
+      ]);
+      expect(batch.mock.calls.map((call) => call[0])).toEqual([3]);
+      expect(persisted).toBe(1);
+      expect(stored).toBe(1);
+      expect(bob.Nr).toBe(1);
+      expect(errorLog).toHaveBeenCalledTimes(1);
+    } finally {
+      batch.mockRestore();
+      errorLog.mockRestore();
+    }
+  });
+
   test("concurrent sends serialize into distinct durable ratchet steps", async () => {
     const { module, alice } = await pair();
     const epc = edge(alice);
@@ -1,14 +1,19 @@
 import { describe, expect, test } from "bun:test";
 
 import {
+  decodeRangeReceiptPayload,
   decodeReceiptFrame,
+  encodeRangeReceiptFrame,
   encodeReceiptFrame,
   sendReceiptFrame,
   sendReceiptFramesPaced,
 } from "../../src/handlers/receiptFrame";
 import {
+  CHUNK_RANGE_RECEIPT_MAX_CHUNKS,
+  FRAME_TYPE_RANGE_RECEIPT,
   FRAME_TYPE_RECEIPT,
   MAX_BUFFERED_AMOUNT,
+  WIRE_RANGE_RECEIPT_FRAME_LEN,
   WIRE_RECEIPT_FRAME_LEN,
 } from "../../src/utils/constants";
 
@@ -29,6 +34,30 @@ describe("protocol-v3 receipt wire frames", () => {
     );
   });
 
+  test("range receipts carry first, count and token at a fixed geometry", () => {
+    const token = new Uint8Array(64).fill(0x24);
+    const frame = encodeRangeReceiptFrame({ first: 9, count: 300, token });
+    expect(frame).toHaveLength(WIRE_RANGE_RECEIPT_FRAME_LEN);
+    expect(frame[0]).toBe(FRAME_TYPE_RANGE_RECEIPT);
+
+    const decoded = decodeRangeReceiptPayload(frame.subarray(1));
+    expect(decoded?.first).toBe(9);
+    expect(decoded?.count).toBe(300);
+    expect([...decoded!.token]).toEqual([...token]);
+
+    const oversized = frame.slice(1);
+    new DataView(oversized.buffer).setBigUint64(
+      8,
+      BigInt(CHUNK_RANGE_RECEIPT_MAX_CHUNKS + 1),
+      false,
+    );
+    expect(decodeRangeReceiptPayload(oversized)).toBeUndefined();
+    expect(decodeRangeReceiptPayload(frame.subarray(1, 64))).toBeUndefined();
+    expect(() =>
+      encodeRangeReceiptFrame({ first: 0, count: 0, token }),
+    ).toThrow("Invalid range receipt");
+  });
+
   test("all production send helpers emit exact tagged frames", async () => {
     const sent: ArrayBuffer[] = [];
     const channel = {
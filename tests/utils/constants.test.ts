@@ -8,6 +8,8 @@ import {
   FRAME_TYPE_RECEIPT,
   FRAME_TYPE_COVER,
   FRAME_TYPE_PQ_CONTROL,
+  FRAME_TYPE_RANGE_RECEIPT,
+  CHUNK_RANGE_RECEIPT_MAX_CHUNKS,
   PQ_TAG_LEN,
   PQ_TAG,
   PROTOCOL_VERSION,
@@ -16,15 +18,31 @@ import {
   DECRYPTED_LEN,
   CHUNK_LEN,
   WIRE_CHUNK_FRAME_LEN,
+  MAX_SKIP,
+  KDF_RK_LABEL,
+  KDF_CK_LABEL,
+  KDF_MK_LABEL,
 } from "../../src/utils/constants";
 
 const h = readFileSync(
   new URL("../../src/cryptography/utils.h", import.meta.url),
   "utf8",
 );
-const cDefine = (name: string): number => {
-  const m = h.match(new RegExp(`#define\\s+${name}\\s+(\\d+)`));
-  if (!m) throw new Error(`#define ${name} not found in utils.h`);
+const merkleH = readFileSync(
+  new URL("../../src/cryptography/merkle.h", import.meta.url),
+  "utf8",
+);
+const ratchetH = readFileSync(
+  new URL("../../src/cryptography/ratchet.h", import.meta.url),
+  "utf8",
+);
+const ratchetC = readFileSync(
+  new URL("../../src/cryptography/ratchet.c", import.meta.url),
+  "utf8",
+);
+const cDefine = (name: string, header = h): number => {
+  const m = header.match(new RegExp(`#define\\s+${name}\\s+(\\d+)`));
+  if (!m) throw new Error(`#define ${name} not found in the C header`);
   return Number(m[1]);
 };
 
@@ -37,6 +55,10 @@ describe("protocol-v4 wire constants (C == TS)", () => {
     expect(cDefine("FRAME_TYPE_RECEIPT")).toBe(FRAME_TYPE_RECEIPT);
     expect(cDefine("FRAME_TYPE_COVER")).toBe(FRAME_TYPE_COVER);
     expect(cDefine("FRAME_TYPE_PQ_CONTROL")).toBe(FRAME_TYPE_PQ_CONTROL);
+    expect(cDefine("FRAME_TYPE_RANGE_RECEIPT")).toBe(FRAME_TYPE_RANGE_RECEIPT);
+    expect(cDefine("CHUNK_RANGE_RECEIPT_MAX_CHUNKS", merkleH)).toBe(
+      CHUNK_RANGE_RECEIPT_MAX_CHUNKS,
+    );
     expect(cDefine("PQ_TAG_LEN")).toBe(PQ_TAG_LEN);
     expect(cDefine("PQ_EPOCH_LEN")).toBe(PQ_EPOCH_LEN);
     expect(cDefine("CHUNK_PLAINTEXT_LEN")).toBe(DECRYPTED_LEN);
@@ -50,12 +72,19 @@ describe("protocol-v4 wire constants (C == TS)", () => {
       FRAME_TYPE_RECEIPT,
       FRAME_TYPE_COVER,
       FRAME_TYPE_PQ_CONTROL,
+      FRAME_TYPE_RANGE_RECEIPT,
     ];
-    expect(new Set(tags).size).toBe(5);
+    expect(new Set(tags).size).toBe(6);
     expect(PQ_TAG.length).toBe(PQ_TAG_LEN);
     expect([...PQ_TAG]).toEqual([1]);
   });
 
+  test("the ratchet engine's skip bound and KDF labels match", () => {
+    expect(cDefine("MAX_SKIP", ratchetH)).toBe(MAX_SKIP);
+    for (const label of [KDF_RK_LABEL, KDF_CK_LABEL, KDF_MK_LABEL])
+      expect(ratchetC).toContain(`"${label}"`);
+  });
+
   test("the wider epoch consumes plaintext padding, not outer-cell bytes", () => {
     expect(PROTOCOL_VERSION).toBe(4);
     expect(PQ_EPOCH_LEN).toBe(8);
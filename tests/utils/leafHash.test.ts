@@ -4,7 +4,11 @@ import { describe, expect, test } from "bun:test";
 // but `window` is not, so alias it.
 (globalThis as unknown as { window: typeof globalThis }).window = globalThis;
 
-import { hashMerkleLeaf, hashMerkleLeafWasm } from "../../src/utils/leafHash";
+import {
+  hashMerkleLeaf,
+  hashMerkleLeafWasm,
+  hashMerkleLeavesWasm,
+} from "../../src/utils/leafHash";
 import { loadTestModule } from "../../src/cryptography/testModule";
 
 const rand = (n: number): Uint8Array => {
@@ -49,3 +53,32 @@ describe("hashMerkleLeafWasm (libsodium/C leaf hash)", () => {
     }
   });
 });
+
+describe("hashMerkleLeavesWasm (four-lane SHA-512 batch)", () => {
+  test("matches hashMerkleLeafWasm per chunk, including partial groups", async () => {
+    const module = await loadTestModule();
+    for (const [count, n] of [
+      [1, 0],
+      [3, 127],
+      [4, 128],
+      [7, 1000],
+      [9, 65405],
+    ]) {
+      const chunks = Array.from({ length: count }, () => rand(n));
+      const leaves = hashMerkleLeavesWasm(chunks, module);
+      expect(leaves).toHaveLength(count * 64);
+      for (let i = 0; i < count; i++) {
+        expect(Buffer.from(leaves.subarray(i * 64, (i + 1) * 64))).toEqual(
+          Buffer.from(hashMerkleLeafWasm(chunks[i], module)),
+        );
+      }
+    }
+  });
+
+  test("rejects chunks of different lengths", async () => {
+    const module = await loadTestModule();
+    expect(() => hashMerkleLeavesWasm([rand(8), rand(9)], module)).toThrow(
+      "chunks must have equal lengths",
+    );
+  });
+});
@@ -2,7 +2,12 @@ import { describe, expect, test } from "bun:test";
 
 import { crypto_hash_sha512_BYTES } from "../../src/cryptography/interfaces";
 import { MAX_MESSAGE_SIZE } from "../../src/utils/constants";
-import { assertMetadataV1 } from "../../src/utils/metadata";
+import {
+  assertMetadataV1,
+  deserializeMetadata,
+  serializeMetadata,
+  setMetadataHash,
+} from "../../src/utils/metadata";
 
 import type { Metadata } from "../../src/utils/metadata";
 
@@ -56,3 +61,16 @@ describe("protocol metadata validation", () => {
     ).toThrow("timestamp");
   });
 });
+
+describe("staged metadata", () => {
+  test("setMetadataHash fills in the hash and nothing else", () => {
+    const hash = new Uint8Array(crypto_hash_sha512_BYTES).fill(0xab);
+    const staged = serializeMetadata(validMetadata({ chunkIndex: 7 }));
+    setMetadataHash(staged, hash);
+    expect(staged).toEqual(
+      serializeMetadata(validMetadata({ chunkIndex: 7, hash })),
+    );
+    expect(deserializeMetadata(staged).hash).toEqual(hash);
+    expect(() => setMetadataHash(staged, new Uint8Array(32))).toThrow();
+  });
+});
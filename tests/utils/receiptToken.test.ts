@@ -1,6 +1,13 @@
 import { describe, expect, test } from "bun:test";
 
-import { createChunkReceiptToken } from "../../src/utils/receiptToken";
+import {
+  createChunkRangeReceiptToken,
+  createChunkReceiptToken,
+  createChunkReceiptTokenTable,
+  createChunkReceiptTokens,
+} from "../../src/utils/receiptToken";
+import { createMerkleTree } from "../../src/cryptography/merkle";
+import { loadTestModule } from "../../src/cryptography/testModule";
 
 describe("protocol-v3 chunk receipt tokens", () => {
   test("are deterministic, uniform 64-byte values", async () => {
@@ -70,3 +77,80 @@ describe("protocol-v3 chunk receipt tokens", () => {
     ).rejects.toThrow("leaf hash");
   });
 });
+
+describe("batched and range receipt tokens (C)", () => {
+  test("the batch matches createChunkReceiptToken, including partial groups", async () => {
+    const module = await loadTestModule();
+    const root = crypto.getRandomValues(new Uint8Array(64));
+    for (const count of [1, 3, 4, 9]) {
+      const leaves = crypto.getRandomValues(new Uint8Array(count * 64));
+      const indexes = Array.from({ length: count }, (_, i) => i * 7 + 1);
+      const tokens = createChunkReceiptTokens(root, indexes, leaves, module);
+      for (let i = 0; i < count; i++) {
+        expect(tokens.slice(i * 64, (i + 1) * 64)).toEqual(
+          await createChunkReceiptToken(
+            root,
+            indexes[i],
+            leaves.slice(i * 64, (i + 1) * 64),
+          ),
+        );
+      }
+    }
+    expect(() =>
+      createChunkReceiptTokens(root, [-1], new Uint8Array(64), module),
+    ).toThrow("index");
+  });
+
+  test("the sender's table holds every leaf's token in index order", async () => {
+    const module = await loadTestModule();
+    const root = crypto.getRandomValues(new Uint8Array(64));
+    const count = 2050;
+    const leaves = crypto.getRandomValues(new Uint8Array(count * 64));
+    const table = createChunkReceiptTokenTable(root, leaves, module);
+    for (const i of [0, 1, 2047, 2048, 2049])
+      expect(table.slice(i * 64, (i + 1) * 64)).toEqual(
+        await createChunkReceiptToken(
+          root,
+          i,
+          leaves.slice(i * 64, (i + 1) * 64),
+        ),
+      );
+  });
+
+  test("a range receipt verifies against the sender's tree and nothing else", async () => {
+    const module = await loadTestModule();
+    const leaves = crypto.getRandomValues(new Uint8Array(11 * 64));
+    const tree = await createMerkleTree(leaves, module);
+    try {
+      const range = leaves.slice(3 * 64, 8 * 64);
+      const token = createChunkRangeReceiptToken(tree.root, 3, range, module);
+      expect(tree.verifyRangeReceipt(3, 5, token)).toBe(true);
+      expect(tree.verifyRangeReceipt(3, 4, token)).toBe(false);
+      expect(tree.verifyRangeReceipt(4, 5, token)).toBe(false);
+      expect(tree.verifyRangeReceipt(8, 5, token)).toBe(false);
+      // merkle.c takes 32-bit bounds; a wider first must not wrap into range.
+      expect(tree.verifyRangeReceipt(2 ** 32 + 3, 5, token)).toBe(false);
+
+      const otherRoot = new Uint8Array(tree.root);
+      otherRoot[0] ^= 1;
+      expect(
+        tree.verifyRangeReceipt(
+          3,
+          5,
+          createChunkRangeReceiptToken(otherRoot, 3, range, module),
+        ),
+      ).toBe(false);
+
+      range[70] ^= 1;
+      expect(
+        tree.verifyRangeReceipt(
+          3,
+          5,
+          createChunkRangeReceiptToken(tree.root, 3, range, module),
+        ),
+      ).toBe(false);
+    } finally {
+      tree.free();
+    }
+  });
+});